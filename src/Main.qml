@@ -1,5 +1,6 @@
 import QtQuick
 import QtQuick.Controls
+import QtQuick.Layouts
 
 import TaskManager 1.0
 
@@ -15,7 +16,33 @@ ApplicationWindow {
         id: theme
     }
 
-    TaskListPage {
+    header: TabBar {
+        id: tabs
+
+        TabButton {
+            text: qsTr("Tasks")
+        }
+
+        TabButton {
+            text: qsTr("Plan")
+        }
+
+        TabButton {
+            text: qsTr("Week")
+        }
+    }
+
+    StackLayout {
         anchors.fill: parent
+        currentIndex: tabs.currentIndex
+
+        TaskListPage {
+        }
+
+        GanttPage {
+        }
+
+        AgendaPage {
+        }
     }
 }
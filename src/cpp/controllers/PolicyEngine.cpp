@@ -0,0 +1,244 @@
+#include "PolicyEngine.h"
+#include "TaskModel.h"
+#include "Metrics.h"
+
+namespace
+{
+
+constexpr qint64 MsPerDay = 24 * 60 * 60 * 1000;
+
+}
+
+PolicyRule PolicyRule::deleteCompletedAfter(int days)
+{
+    PolicyRule rule;
+    rule.name = QString("delete-completed-after-%1d").arg(days);
+    rule.completed = true;
+    rule.maxAgeDays = days;
+    rule.action = Delete;
+    return rule;
+}
+
+PolicyRule PolicyRule::agePending(int fromPriority, int toPriority, int days)
+{
+    PolicyRule rule;
+    rule.name = QString("age-pending-%1-to-%2-after-%3d").arg(fromPriority).arg(toPriority).arg(days);
+    rule.completed = false;
+    rule.priority = fromPriority;
+    rule.maxAgeDays = days;
+    rule.action = SetPriority;
+    rule.newPriority = toPriority;
+    return rule;
+}
+
+PolicyEngine::PolicyEngine(TaskModel *taskModel, QObject *parent)
+    : QObject(parent), model(taskModel)
+{
+    connect(&timer, &QTimer::timeout, this, &PolicyEngine::run);
+    if (!model)
+        return;
+
+    connect(model, &TaskModel::rowsInserted, this, [this](const QModelIndex &, int first, int last) {
+        for (int row = first; row <= last; ++row)
+            indexRow(row);
+    });
+    connect(model, &TaskModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &, int first, int last) {
+        for (int row = first; row <= last; ++row)
+            unindex(model->taskId(row));
+    });
+    connect(model, &TaskModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+        if (!roles.isEmpty() && !roles.contains(TaskModel::CompletedRole) && !roles.contains(TaskModel::PriorityRole)
+            && !roles.contains(TaskModel::DeletedRole))
+            return;
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+            indexRow(row);
+    });
+    connect(model, &TaskModel::modelAboutToBeReset, this, [this]() {
+        buckets.clear();
+        indexed.clear();
+    });
+    connect(model, &TaskModel::modelReset, this, &PolicyEngine::rebuildIndex);
+
+    rebuildIndex();
+}
+
+int PolicyEngine::bucketOf(bool completed, int priority)
+{
+    return priority * 2 + (completed ? 1 : 0);
+}
+
+void PolicyEngine::indexRow(int row)
+{
+    const QModelIndex index = model->index(row);
+    const quint64 id = model->taskId(row);
+    if (model->isDeleted(row))
+    {
+        // Tasks in the trash are out of reach of the rules.
+        unindex(id);
+        return;
+    }
+    const bool completed = model->data(index, TaskModel::CompletedRole).toBool();
+
+    // Completed tasks age from their completion, pending ones from their creation.
+    QDateTime since = model->data(index, TaskModel::CreatedAtRole).toDateTime();
+    if (completed)
+    {
+        const QDateTime completedAt = model->data(index, TaskModel::CompletedAtRole).toDateTime();
+        if (completedAt.isValid())
+            since = completedAt;
+    }
+
+    IndexEntry entry;
+    entry.bucket = bucketOf(completed, model->data(index, TaskModel::PriorityRole).toInt());
+    entry.time = since.toMSecsSinceEpoch();
+
+    const auto it = indexed.constFind(id);
+    if (it != indexed.constEnd() && it->bucket == entry.bucket && it->time == entry.time)
+        return;
+
+    unindex(id);
+    indexed.insert(id, entry);
+    buckets[entry.bucket].insert(entry.time, id);
+}
+
+void PolicyEngine::unindex(quint64 id)
+{
+    const auto it = indexed.constFind(id);
+    if (it == indexed.constEnd())
+        return;
+
+    auto bucket = buckets.find(it->bucket);
+    if (bucket != buckets.end())
+    {
+        bucket->remove(it->time, id);
+        if (bucket->isEmpty())
+            buckets.erase(bucket);
+    }
+    indexed.erase(it);
+}
+
+void PolicyEngine::rebuildIndex()
+{
+    buckets.clear();
+    indexed.clear();
+    if (!model)
+        return;
+
+    for (int row = 0; row < model->rowCount(); ++row)
+        indexRow(row);
+}
+
+void PolicyEngine::addRule(const PolicyRule &rule)
+{
+    policyRules.append(rule);
+}
+
+void PolicyEngine::start(int interval)
+{
+    timer.start(interval);
+}
+
+void PolicyEngine::stop()
+{
+    timer.stop();
+}
+
+void PolicyEngine::run()
+{
+    if (running || !model)
+        return;
+
+    running = true;
+    currentRule = 0;
+    pending = PolicyReport();
+    pending.startedAt = QDateTime::currentDateTime();
+    runNow = pending.startedAt.toMSecsSinceEpoch();
+    runTimer.start();
+    emit runningChanged();
+
+    QTimer::singleShot(0, this, &PolicyEngine::processBatch);
+}
+
+void PolicyEngine::processBatch()
+{
+    Metrics::ScopedTimer timer(Metrics::registry().latency[Metrics::PolicyBatch]);
+    QElapsedTimer busy;
+    busy.start();
+
+    // Each batch applies at most batchLimit tasks of one rule with a single bulk update.
+    while (model && currentRule < policyRules.size())
+    {
+        const PolicyRule &rule = policyRules.at(currentRule);
+        const qint64 cutoff = runNow - qint64(rule.maxAgeDays) * MsPerDay;
+        // Tasks already at the target priority must not be picked up again.
+        const bool skipTarget = rule.action == PolicyRule::SetPriority;
+        const int targetBucket = bucketOf(rule.completed, rule.newPriority);
+
+        QList<int> keys;
+        if (rule.priority >= 0)
+            keys.append(bucketOf(rule.completed, rule.priority));
+        else
+        {
+            for (auto it = buckets.cbegin(); it != buckets.cend(); ++it)
+            {
+                if (bool(it.key() & 1) == rule.completed)
+                    keys.append(it.key());
+            }
+        }
+
+        // Oldest entries first; everything up to the cutoff matches.
+        QList<quint64> ids;
+        for (int key : std::as_const(keys))
+        {
+            if (skipTarget && key == targetBucket)
+                continue;
+            const auto bucket = buckets.constFind(key);
+            if (bucket == buckets.constEnd())
+                continue;
+            for (auto it = bucket->cbegin(); it != bucket->cend() && it.key() <= cutoff && ids.size() < batchLimit; ++it)
+                ids.append(it.value());
+        }
+        pending.examined += ids.size();
+
+        if (ids.isEmpty())
+        {
+            ++currentRule;
+            continue;
+        }
+
+        int affected = 0;
+        if (rule.action == PolicyRule::Delete)
+        {
+            // Into the trash, like a delete by the user; purging is left to emptying it.
+            affected = model->trashTasks(ids);
+            pending.deleted += affected;
+        }
+        else
+        {
+            affected = model->setTasksPriority(ids, rule.newPriority);
+            pending.reprioritized += affected;
+        }
+        pending.perRule[rule.name] += affected;
+
+        // A short batch exhausted the rule; a batch without effect would repeat forever.
+        if (ids.size() < batchLimit || affected == 0)
+            ++currentRule;
+        break;
+    }
+
+    pending.busyMs += busy.elapsed();
+    ++pending.batches;
+
+    if (model && currentRule < policyRules.size())
+    {
+        // Yield to pending events before the next batch.
+        QTimer::singleShot(0, this, &PolicyEngine::processBatch);
+        return;
+    }
+
+    pending.elapsedMs = runTimer.elapsed();
+    report = pending;
+    running = false;
+    emit runningChanged();
+    emit runFinished(report);
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+class TaskModel;
+
+
+/**
+ * @file PolicyEngine.h
+ * @brief Retention and priority-aging rules applied to a TaskModel in the background
+ */
+
+/**
+ * @struct PolicyRule
+ * @brief One retention or aging rule
+ *
+ * A rule matches tasks with a given completion status (and optionally a given priority)
+ * whose age exceeds maxAgeDays. The age of a completed task is measured from its
+ * completion time (its creation time if that is unknown), the age of a pending task from
+ * its creation time.
+ */
+struct PolicyRule
+{
+    Q_GADGET
+
+    Q_PROPERTY(QString name MEMBER name)
+    Q_PROPERTY(bool completed MEMBER completed)
+    Q_PROPERTY(int priority MEMBER priority)
+    Q_PROPERTY(int maxAgeDays MEMBER maxAgeDays)
+    Q_PROPERTY(Action action MEMBER action)
+    Q_PROPERTY(int newPriority MEMBER newPriority)
+
+public:
+
+    /**
+     * @enum Action
+     * @brief What to do with matching tasks
+     */
+    enum Action
+    {
+        Delete,     ///< Move the task to the trash
+        SetPriority ///< Change the task's priority to newPriority
+    };
+    Q_ENUM(Action)
+
+    QString name;            ///< Name used in reports
+    bool completed = false;  ///< Status of the tasks the rule applies to
+    int priority = -1;       ///< Priority of the tasks the rule applies to; -1 for any
+    int maxAgeDays = 0;      ///< Age in days after which the rule applies
+    Action action = Delete;  ///< What to do with matching tasks
+    int newPriority = 1;     ///< Target priority for SetPriority
+
+    /**
+     * @brief Rule deleting completed tasks some days after their completion
+     */
+    static PolicyRule deleteCompletedAfter(int days);
+
+    /**
+     * @brief Rule raising the priority of pending tasks older than some days
+     */
+    static PolicyRule agePending(int fromPriority, int toPriority, int days);
+};
+
+/**
+ * @struct PolicyReport
+ * @brief Work done by one run of the policy engine
+ */
+struct PolicyReport
+{
+    Q_GADGET
+
+    Q_PROPERTY(QDateTime startedAt MEMBER startedAt)
+    Q_PROPERTY(qint64 elapsedMs MEMBER elapsedMs)
+    Q_PROPERTY(qint64 busyMs MEMBER busyMs)
+    Q_PROPERTY(int batches MEMBER batches)
+    Q_PROPERTY(int examined MEMBER examined)
+    Q_PROPERTY(int deleted MEMBER deleted)
+    Q_PROPERTY(int reprioritized MEMBER reprioritized)
+
+public:
+    QDateTime startedAt;     ///< When the run started
+    qint64 elapsedMs = 0;    ///< Wall-clock time from start to end of the run
+    qint64 busyMs = 0;       ///< Time spent in batches, i.e. blocking the event loop
+    int batches = 0;         ///< Number of batches the run was split into
+    int examined = 0;        ///< Index entries visited
+    int deleted = 0;         ///< Tasks moved to the trash
+    int reprioritized = 0;   ///< Tasks whose priority changed
+    QHash<QString, int> perRule; ///< Tasks affected per rule name
+};
+
+/**
+ * @class PolicyEngine
+ * @brief Applies retention and aging rules to a TaskModel in small idle batches
+ *
+ * The engine keeps time-ordered indexes of the model's tasks, one per (status, priority)
+ * pair, keyed by the time the task's age is measured from. The indexes are maintained
+ * incrementally from the model's row and data change signals. A rule therefore only
+ * visits the tasks it will act on: the oldest entries of its indexes, up to its cutoff
+ * time. The model is never scanned as a whole.
+ *
+ * A run is started periodically (see setInterval()) or with run(). It is split into
+ * batches of at most batchSize() tasks; each batch is applied with one bulk model
+ * update (TaskModel::trashTasks() or TaskModel::setTasksPriority()) and the next batch
+ * is scheduled behind all pending events, so the GUI stays responsive. When the run is
+ * done, runFinished() reports the work done.
+ *
+ * Example usage:
+ * @code
+ * PolicyEngine *engine = new PolicyEngine(model, this);
+ * engine->addRule(PolicyRule::deleteCompletedAfter(180));
+ * engine->addRule(PolicyRule::agePending(Task::Low, Task::Medium, 14));
+ * connect(engine, &PolicyEngine::runFinished, this, [](const PolicyReport &report) {
+ *     qDebug() << report.deleted << "deleted," << report.reprioritized << "reprioritized";
+ * });
+ * engine->start();
+ * @endcode
+ */
+class PolicyEngine : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * @property running
+     * @brief Whether a run is in progress
+     */
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
+
+    /**
+     * @property lastReport
+     * @brief Report of the last completed run
+     */
+    Q_PROPERTY(PolicyReport lastReport READ lastReport NOTIFY runFinished)
+
+public:
+
+    /**
+     * @brief Default maximum number of tasks handled per batch
+     */
+    static constexpr int DefaultBatchSize = 256;
+
+    /**
+     * @brief Default time between two runs in milliseconds (10 minutes)
+     */
+    static constexpr int DefaultInterval = 10 * 60 * 1000;
+
+    /**
+     * @brief Constructs an engine without rules for the given model
+     * @param model The model to apply rules to
+     * @param parent The parent QObject
+     */
+    explicit PolicyEngine(TaskModel *model, QObject *parent = nullptr);
+
+    /**
+     * @brief Adds a rule; rules are applied in the order they were added
+     */
+    void addRule(const PolicyRule &rule);
+
+    /**
+     * @brief Adds a rule deleting completed tasks some days after their completion
+     */
+    Q_INVOKABLE void addRetentionRule(int days) { addRule(PolicyRule::deleteCompletedAfter(days)); }
+
+    /**
+     * @brief Adds a rule raising the priority of pending tasks older than some days
+     */
+    Q_INVOKABLE void addAgingRule(int fromPriority, int toPriority, int days)
+    {
+        addRule(PolicyRule::agePending(fromPriority, toPriority, days));
+    }
+
+    /**
+     * @brief Removes all rules
+     */
+    Q_INVOKABLE void clearRules() { policyRules.clear(); }
+
+    /**
+     * @brief Gets the rules in application order
+     */
+    QList<PolicyRule> rules() const { return policyRules; }
+
+    int batchSize() const { return batchLimit; }
+    void setBatchSize(int tasks) { batchLimit = qMax(1, tasks); }
+
+    /**
+     * @brief Starts periodic runs
+     * @param interval Time between runs in milliseconds
+     */
+    void start(int interval = DefaultInterval);
+
+    /**
+     * @brief Stops periodic runs; a run in progress is finished
+     */
+    void stop();
+
+    /**
+     * @brief Starts a run now unless one is in progress
+     */
+    Q_INVOKABLE void run();
+
+    bool isRunning() const { return running; }
+    PolicyReport lastReport() const { return report; }
+
+    /**
+     * @brief Gets the number of tasks in the time-ordered indexes
+     */
+    int indexedCount() const { return indexed.size(); }
+
+signals:
+
+    /**
+     * @brief Emitted when a run starts or finishes
+     */
+    void runningChanged();
+
+    /**
+     * @brief Emitted when a run has finished
+     * @param report The work done by the run
+     */
+    void runFinished(const PolicyReport &report);
+
+private:
+
+    /**
+     * Index key of a task: its status and priority select the bucket, its age time the
+     * position within the bucket.
+     */
+    struct IndexEntry
+    {
+        int bucket = 0;
+        qint64 time = 0;
+    };
+
+    QPointer<TaskModel> model;            ///< Model the rules are applied to
+    QList<PolicyRule> policyRules;        ///< Rules in application order
+    QHash<int, QMultiMap<qint64, quint64>> buckets; ///< Task ids by age time, per bucket
+    QHash<quint64, IndexEntry> indexed;   ///< Current index key of every task
+
+    QTimer timer;                         ///< Periodic run timer
+    int batchLimit = DefaultBatchSize;    ///< Maximum tasks per batch
+    bool running = false;                 ///< Whether a run is in progress
+    int currentRule = 0;                  ///< Rule the current run is working on
+    qint64 runNow = 0;                    ///< Reference time of the current run (ms)
+    QElapsedTimer runTimer;               ///< Wall-clock time of the current run
+    PolicyReport pending;                 ///< Report of the current run
+    PolicyReport report;                  ///< Report of the last finished run
+
+    static int bucketOf(bool completed, int priority);
+
+    void indexRow(int row);
+    void unindex(quint64 id);
+    void rebuildIndex();
+    void processBatch();
+};
+
+Q_DECLARE_METATYPE(PolicyRule)
+Q_DECLARE_METATYPE(PolicyReport)
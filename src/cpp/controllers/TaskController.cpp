@@ -1,12 +1,112 @@
 #include "TaskController.h"
+#include "Metrics.h"
+#include "MetricsServer.h"
+#include "ModelMetrics.h"
+#include "StallMonitor.h"
+
+#include <QMetaEnum>
 
 TaskController::TaskController(QObject *parent)
-    : QObject(parent), model(new TaskModel(this))
+    : QObject(parent), model(new TaskModel(this)), activeModel(new ActiveTaskModel(model, this)), audit(new AuditLog(this)),
+      history(new TaskHistory(audit, this)), pastModel(new HistoryModel(history, this)),
+      governor(new MemoryGovernor(this)), policies(new PolicyEngine(model, this)), store(new TaskStore(this)),
+      cache(new FirstPaintCache(this)), search(new GlobalSearchModel(this)), plan(new GanttModel(this)),
+      week(new AgendaModel(this)), library(new TemplateLibrary(this)),
+      pasted(new PasteImportModel(this))
 {
+    audit->attach(model);
+    store->attach(model);
+    connect(store, &TaskStore::adoptingChanged, audit, &AuditLog::setSuspended);
+    plan->attach(model);
+    week->attach(model);
+    library->attach(model);
+    pasted->attach(model);
+    search->addWorkspace(QStringLiteral("Tasks"), model);
+
+    governor->registerCache("task.records", MemoryGovernor::Disposable, model,
+                            [this]() { return model->recordCacheSize(); },
+                            [this]() { return model->releaseRecordCache(); });
+    governor->registerCache("search.index", MemoryGovernor::Rebuildable, model,
+                            [this]() { return model->searchIndexSize(); },
+                            [this]() { return model->releaseSearchIndex(); });
+    governor->registerCache("history.checkpoints", MemoryGovernor::Rebuildable, history,
+                            [this]() { return history->checkpointSize(); },
+                            [this]() { return history->releaseCheckpoints(); });
+    governor->registerCache("search.workspaces", MemoryGovernor::Rebuildable, search,
+                            [this]() { return search->indexSize(); },
+                            [this]() { return search->releaseIndexes(); });
+    connect(governor, &MemoryGovernor::cacheShed, this, &TaskController::countCacheShed);
+    connect(governor, &MemoryGovernor::trimmed, this, &TaskController::countTrim);
+    governor->start();
+    policies->start();
     connect(model, &TaskModel::countChanged, this, &TaskController::onModelCountChanged);
     connect(model, &TaskModel::dataChanged, this, &TaskController::onModelDataChanged);
 }
 
+TaskController::~TaskController()
+{
+    if (!store->directory().isEmpty())
+        store->save(true);
+}
+
+bool TaskController::enableMetrics(quint16 port)
+{
+    if (!metricsServer)
+    {
+        metricsServer = new MetricsServer(this);
+        modelMetrics = new ModelMetrics(model, this);
+        stallMonitor = new StallMonitor(this);
+        stallMonitor->start();
+        connect(governor, &MemoryGovernor::sampled, this, &TaskController::publishMemory);
+        publishMemory();
+    }
+    return metricsServer->listen(port);
+}
+
+void TaskController::publishMemory()
+{
+    Metrics::Registry &metrics = Metrics::registry();
+    for (const MemoryGovernor::CacheInfo &cache : governor->caches())
+    {
+        if (Metrics::Gauge *gauge = metrics.memory.gauge(cache.name.toUtf8()))
+            gauge->set(cache.bytes);
+    }
+    if (Metrics::Gauge *gauge = metrics.memory.gauge("audit.log"))
+        gauge->set(audit->bufferedBytes());
+    if (Metrics::Gauge *gauge = metrics.memory.gauge("resident"))
+        gauge->set(qMax<qint64>(0, governor->residentBytes()));
+}
+
+void TaskController::countCacheShed(const QString &name, qint64 bytes)
+{
+    MemoryGovernor::CachePriority priority = MemoryGovernor::Disposable;
+    for (const MemoryGovernor::CacheInfo &info : governor->caches())
+    {
+        if (info.name == name)
+            priority = info.priority;
+    }
+
+    const QByteArray labels = "cache=\"" + name.toUtf8() + "\",priority=\"" +
+                              QByteArray(QMetaEnum::fromType<MemoryGovernor::CachePriority>().valueToKey(priority)).toLower() +
+                              "\",level=\"" +
+                              QByteArray(QMetaEnum::fromType<MemoryGovernor::Level>().valueToKey(governor->level())).toLower() + '"';
+    Metrics::Registry &metrics = Metrics::registry();
+    if (Metrics::Counter *counter = metrics.cacheSheds.counter(labels))
+        counter->add();
+    if (Metrics::Counter *counter = metrics.cacheShedBytes.counter(labels))
+        counter->add(quint64(qMax<qint64>(0, bytes)));
+}
+
+void TaskController::countTrim(qint64 bytes)
+{
+    const QByteArray labels = "level=\"" +
+                              QByteArray(QMetaEnum::fromType<MemoryGovernor::Level>().valueToKey(governor->level())).toLower() + '"';
+    Metrics::Registry &metrics = Metrics::registry();
+    if (Metrics::Counter *counter = metrics.mallocTrims.counter(labels))
+        counter->add();
+    metrics.mallocTrimmedBytes.add(quint64(qMax<qint64>(0, bytes)));
+}
+
 int TaskController::totalTasks() const
 {
     return model->count();
@@ -15,9 +115,9 @@ int TaskController::totalTasks() const
 int TaskController::completedTasks() const
 {
     int count = 0;
-    for (int i = 0; i < model->count(); ++i)
+    for (int i = 0; i < model->rowCount(); ++i)
     {
-        if (model->data(model->index(i), TaskModel::CompletedRole).toBool())
+        if (!model->isDeleted(i) && model->data(model->index(i), TaskModel::CompletedRole).toBool())
         {
             count++;
         }
@@ -30,15 +130,17 @@ int TaskController::pendingTasks() const
     return totalTasks() - completedTasks();
 }
 
-bool TaskController::createTask(const QString &title, const QString &description, int priority)
+bool TaskController::createTask(const QString &title, const QString &description, int priority, const QString &assignee)
 {
     bool success = model->addTask(title, description);
     if (success && priority >= Task::Low && priority <= Task::High)
     {
         // Set priority on the newly created task
-        int lastIndex = model->count() - 1;
+        int lastIndex = model->rowCount() - 1;
         model->setData(model->index(lastIndex), priority, TaskModel::PriorityRole);
     }
+    if (success && !assignee.trimmed().isEmpty())
+        model->setData(model->index(model->rowCount() - 1), assignee, TaskModel::AssigneeRole);
     return success;
 }
 
@@ -69,9 +171,9 @@ void TaskController::loadSampleData()
 QList<int> TaskController::getTasksByPriority(int priority) const
 {
     QList<int> indices;
-    for (int i = 0; i < model->count(); ++i)
+    for (int i = 0; i < model->rowCount(); ++i)
     {
-        if (model->data(model->index(i), TaskModel::PriorityRole).toInt() == priority)
+        if (!model->isDeleted(i) && model->data(model->index(i), TaskModel::PriorityRole).toInt() == priority)
         {
             indices.append(i);
         }
@@ -82,9 +184,9 @@ QList<int> TaskController::getTasksByPriority(int priority) const
 QList<int> TaskController::getCompletedTasks() const
 {
     QList<int> indices;
-    for (int i = 0; i < model->count(); ++i)
+    for (int i = 0; i < model->rowCount(); ++i)
     {
-        if (model->data(model->index(i), TaskModel::CompletedRole).toBool())
+        if (!model->isDeleted(i) && model->data(model->index(i), TaskModel::CompletedRole).toBool())
         {
             indices.append(i);
         }
@@ -95,9 +197,9 @@ QList<int> TaskController::getCompletedTasks() const
 QList<int> TaskController::getPendingTasks() const
 {
     QList<int> indices;
-    for (int i = 0; i < model->count(); ++i)
+    for (int i = 0; i < model->rowCount(); ++i)
     {
-        if (!model->data(model->index(i), TaskModel::CompletedRole).toBool())
+        if (!model->isDeleted(i) && !model->data(model->index(i), TaskModel::CompletedRole).toBool())
         {
             indices.append(i);
         }
@@ -105,6 +207,11 @@ QList<int> TaskController::getPendingTasks() const
     return indices;
 }
 
+QList<int> TaskController::searchTasks(const QString &text) const
+{
+    return model->findTasks(text);
+}
+
 void TaskController::onModelCountChanged()
 {
     updateStatistics();
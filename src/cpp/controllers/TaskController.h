@@ -3,6 +3,23 @@
 #include <QObject>
 #include <QQmlEngine>
 #include "TaskModel.h"
+#include "ActiveTaskModel.h"
+#include "AuditLog.h"
+#include "HistoryModel.h"
+#include "TaskHistory.h"
+#include "MemoryGovernor.h"
+#include "PolicyEngine.h"
+#include "TaskStore.h"
+#include "FirstPaintCache.h"
+#include "GlobalSearchModel.h"
+#include "GanttModel.h"
+#include "AgendaModel.h"
+#include "TemplateLibrary.h"
+#include "PasteImportModel.h"
+
+class MetricsServer;
+class ModelMetrics;
+class StallMonitor;
 
 
 /**
@@ -60,6 +77,95 @@ class TaskController : public QObject
      */
     Q_PROPERTY(TaskModel *taskModel READ taskModel CONSTANT)
 
+    /**
+     * @property activeTasks
+     * @brief The tasks of taskModel without the deleted ones, for views
+     *
+     * Rows differ from taskModel's rows; map them with ActiveTaskModel::sourceRow()
+     * before passing them to the row-based actions. Read-only (CONSTANT).
+     */
+    Q_PROPERTY(ActiveTaskModel *activeTasks READ activeTasks CONSTANT)
+
+    /**
+     * @property auditLog
+     * @brief The audit log recording field-level changes of the model's tasks
+     *
+     * Attached to the model on construction. Read-only (CONSTANT).
+     */
+    Q_PROPERTY(AuditLog *auditLog READ auditLog CONSTANT)
+
+    /**
+     * @property historyModel
+     * @brief Read-only model showing the task list at a past point in time
+     *
+     * Reconstructed from the audit log; see HistoryModel::showAt(). Read-only (CONSTANT).
+     */
+    Q_PROPERTY(HistoryModel *historyModel READ historyModel CONSTANT)
+
+    /**
+     * @property memoryGovernor
+     * @brief Sheds the model's and history's caches under memory pressure
+     *
+     * Samples memory pressure from construction on. Read-only (CONSTANT).
+     */
+    Q_PROPERTY(MemoryGovernor *memoryGovernor READ memoryGovernor CONSTANT)
+
+    /**
+     * @property policyEngine
+     * @brief Applies retention and priority-aging rules to the model
+     *
+     * Runs periodically; starts without rules. Read-only (CONSTANT).
+     */
+    Q_PROPERTY(PolicyEngine *policyEngine READ policyEngine CONSTANT)
+
+    /**
+     * @property firstPaint
+     * @brief Rows and statistics of the last session, shown until the stored tasks are loaded
+     *
+     * Inactive unless loaded at start-up; see FirstPaintCache. Read-only (CONSTANT).
+     */
+    Q_PROPERTY(FirstPaintCache *firstPaint READ firstPaint CONSTANT)
+
+    /**
+     * @property globalSearch
+     * @brief Search across this task list and the workspaces added to it
+     *
+     * The model's own tasks are the "Tasks" workspace. Read-only (CONSTANT).
+     */
+    Q_PROPERTY(GlobalSearchModel *globalSearch READ globalSearch CONSTANT)
+
+    /**
+     * @property gantt
+     * @brief Schedule of the live tasks by their estimates and dependencies
+     *
+     * Read-only (CONSTANT); see GanttModel.
+     */
+    Q_PROPERTY(GanttModel *gantt READ gantt CONSTANT)
+
+    /**
+     * @property agenda
+     * @brief Pending tasks planned into free calendar time
+     *
+     * Read-only (CONSTANT); empty until AgendaModel::planWeek() is called.
+     */
+    Q_PROPERTY(AgendaModel *agenda READ agenda CONSTANT)
+
+    /**
+     * @property templates
+     * @brief Task templates, instantiated into the model as one set of tasks
+     *
+     * Read-only (CONSTANT); see TemplateLibrary.
+     */
+    Q_PROPERTY(TemplateLibrary *templates READ templates CONSTANT)
+
+    /**
+     * @property pasteImport
+     * @brief Preview of a pasted list of tasks, added to the model in one insertion
+     *
+     * Read-only (CONSTANT); see PasteImportModel.
+     */
+    Q_PROPERTY(PasteImportModel *pasteImport READ pasteImport CONSTANT)
+
     /**
      * @property totalTasks
      * @brief The total number of tasks in the system
@@ -92,6 +198,42 @@ class TaskController : public QObject
 private:
 
     TaskModel *model; ///< Internal TaskModel instance that stores task data
+    ActiveTaskModel *activeModel; ///< Live tasks of the model, for views
+    AuditLog *audit;  ///< Change history of the model's tasks
+    TaskHistory *history; ///< Checkpointed replay of the audit log
+    HistoryModel *pastModel; ///< Past task list shown on request
+    MemoryGovernor *governor; ///< Releases caches under memory pressure
+    PolicyEngine *policies; ///< Retention and aging rules
+    TaskStore *store; ///< Paged snapshot of the model, once opened
+    FirstPaintCache *cache; ///< Visible rows of the last session
+    GlobalSearchModel *search; ///< Search across workspaces
+    GanttModel *plan; ///< Critical path schedule of the model's tasks
+    AgendaModel *week; ///< Pending tasks placed into free time
+    TemplateLibrary *library; ///< Task templates of the user
+    PasteImportModel *pasted; ///< Preview of a pasted list of tasks
+    MetricsServer *metricsServer = nullptr; ///< OpenMetrics endpoint, only when enabled
+    ModelMetrics *modelMetrics = nullptr;   ///< Task counts for the endpoint
+    StallMonitor *stallMonitor = nullptr;   ///< GUI stall detection for the endpoint
+
+    /**
+     * @brief Copies the sizes of the memory governor's caches to the metrics registry
+     *
+     * Uses the sizes the governor measured last, so a sample does not walk the caches.
+     */
+    void publishMemory();
+
+    /**
+     * @brief Counts a cache shed by the memory governor in the metrics registry
+     * @param name Name of the cache
+     * @param bytes Approximate number of bytes released
+     */
+    void countCacheShed(const QString &name, qint64 bytes);
+
+    /**
+     * @brief Counts free memory returned to the system in the metrics registry
+     * @param bytes Decrease of the resident set size
+     */
+    void countTrim(qint64 bytes);
 
     /**
      * @brief Updates all task statistics and emits change signals if needed
@@ -114,6 +256,11 @@ public:
      */
     explicit TaskController(QObject *parent = nullptr);
 
+    /**
+     * @brief Writes unsaved changes of the task store while the model still exists
+     */
+    ~TaskController() override;
+
     /**
      * @brief Gets the underlying TaskModel
      * @return Pointer to the internal TaskModel instance
@@ -124,6 +271,93 @@ public:
      */
     TaskModel *taskModel() const { return model; }
 
+    /**
+     * @brief Gets the view of the live tasks
+     */
+    ActiveTaskModel *activeTasks() const { return activeModel; }
+
+    /**
+     * @brief Gets the audit log of the model's tasks
+     * @return Pointer to the AuditLog, valid for the lifetime of the TaskController
+     */
+    AuditLog *auditLog() const { return audit; }
+
+    /**
+     * @brief Gets the history of the model's tasks
+     * @return Pointer to the TaskHistory, valid for the lifetime of the TaskController
+     */
+    TaskHistory *taskHistory() const { return history; }
+
+    /**
+     * @brief Gets the read-only model of a past task list
+     * @return Pointer to the HistoryModel, valid for the lifetime of the TaskController
+     */
+    HistoryModel *historyModel() const { return pastModel; }
+
+    /**
+     * @brief Gets the memory governor
+     * @return Pointer to the MemoryGovernor, valid for the lifetime of the TaskController
+     */
+    MemoryGovernor *memoryGovernor() const { return governor; }
+
+    /**
+     * @brief Gets the policy engine
+     * @return Pointer to the PolicyEngine, valid for the lifetime of the TaskController
+     */
+    PolicyEngine *policyEngine() const { return policies; }
+
+    /**
+     * @brief Gets the paged store of the model's tasks; see TaskStore::open()
+     */
+    TaskStore *taskStore() const { return store; }
+
+    /**
+     * @brief Gets the cache of the rows visible in the last session
+     */
+    FirstPaintCache *firstPaint() const { return cache; }
+
+    /**
+     * @brief Gets the search across workspaces; see GlobalSearchModel::addWorkspaces()
+     */
+    GlobalSearchModel *globalSearch() const { return search; }
+
+    /**
+     * @brief Gets the schedule of the model's tasks
+     */
+    GanttModel *gantt() const { return plan; }
+
+    /**
+     * @brief Gets the plan of the pending tasks in calendar time
+     */
+    AgendaModel *agenda() const { return week; }
+
+    /**
+     * @brief Gets the task templates; see TemplateLibrary::open()
+     */
+    TemplateLibrary *templates() const { return library; }
+
+    /**
+     * @brief Gets the preview of a pasted list of tasks
+     */
+    PasteImportModel *pasteImport() const { return pasted; }
+
+    /**
+     * @brief Serves the application's metrics in OpenMetrics format on 127.0.0.1
+     * @param port The TCP port; 0 picks a free one
+     * @return true if the endpoint is listening
+     *
+     * Off by default. Once enabled, task counts, GUI stalls and the memory of the
+     * governor's caches are tracked as well; see MetricsServer. The governor's sheds and
+     * trims are counted from the start.
+     */
+    bool enableMetrics(quint16 port);
+
+    /**
+     * @brief Gets the metrics endpoint
+     * @return Pointer to the MetricsServer, or nullptr if metrics are not enabled
+     */
+    MetricsServer *metrics() const { return metricsServer; }
+
     // Statistics
     /**
      * @brief Gets the total number of tasks
@@ -159,6 +393,7 @@ public:
      * @param title The title of the new task (required)
      * @param description Optional description for the task (default: empty)
      * @param priority Priority level for the task (default: 1/Medium)
+     * @param assignee Person the task is assigned to (default: empty, unassigned)
      * @return true if the task was successfully created, false otherwise
      *
      * Creates a new task using the provided parameters and adds it to the model.
@@ -173,18 +408,20 @@ public:
      * controller->createTask("Meeting prep", "Prepare slides for Monday", Task::High);
      * @endcode
      */
-    Q_INVOKABLE bool createTask(const QString &title, const QString &description = QString(), int priority = 1);
+    Q_INVOKABLE bool createTask(const QString &title, const QString &description = QString(), int priority = 1,
+                                const QString &assignee = QString());
 
     /**
      * @brief Deletes a task at the specified index
      * @param index Zero-based index of the task to delete
      * @return true if the task was successfully deleted, false if index is invalid
      *
-     * Removes the task at the given index from the model. The task object will be
-     * destroyed and statistics will be updated automatically.
+     * Moves the task at the given index to the trash of the model, from where it can
+     * be restored. Statistics are updated automatically.
      *
-     * @warning After deletion, all task indices greater than the deleted index
-     * will shift down by one. Update any stored indices accordingly.
+     * @note All task indices greater than the deleted index shift down by one once the
+     * row is removed by background compaction, or right away if the model does not defer
+     * it (see TaskModel::setCompactionDeferred()). Prefer task ids over stored indices.
      */
     Q_INVOKABLE bool deleteTask(int index);
 
@@ -237,9 +474,8 @@ public:
      * Example:
      * @code
      * QList<int> highPriorityIndices = controller->getTasksByPriority(Task::High);
-     * for (int index : highPriorityIndices) {
-     *     Task *task = controller->model()->getTask(index);
-     *     qDebug() << "High priority task:" << task->title();
+     * for (const TaskRecord &task : controller->taskModel()->getTasks(highPriorityIndices)) {
+     *     qDebug() << "High priority task:" << task.getTitle();
      * }
      * @endcode
      */
@@ -269,6 +505,26 @@ public:
      */
     Q_INVOKABLE QList<int> getPendingTasks() const;
 
+    /**
+     * @brief Gets indices of all tasks whose title or description contains the given text
+     * @param text The text to search for, compared case-insensitively
+     * @return List of zero-based indices of matching tasks, in ascending order
+     *
+     * Delegates to TaskModel::findTasks(), which scans pre-folded task texts with
+     * vectorized substring search and splits large models across threads.
+     *
+     * @note The returned indices are valid at the time of the call but may become
+     * invalid if tasks are added/removed/reordered after this call.
+     *
+     * Example:
+     * @code
+     * for (int index : controller->searchTasks("review")) {
+     *     qDebug() << "Match:" << controller->taskModel()->getTask(index).getTitle();
+     * }
+     * @endcode
+     */
+    Q_INVOKABLE QList<int> searchTasks(const QString &text) const;
+
 signals:
 
     /**
@@ -0,0 +1,686 @@
+#include "AuditLog.h"
+#include "TaskModel.h"
+#include "Metrics.h"
+#include "IoQueue.h"
+
+#include <QDebug>
+
+namespace
+{
+
+// Entries with this field id define the next interned actor name instead of
+// describing a task change. They are not counted or indexed.
+constexpr quint8 ActorDefinition = 0xff;
+
+void writeVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80)
+    {
+        out.append(char(quint8(value) | 0x80));
+        value >>= 7;
+    }
+    out.append(char(quint8(value)));
+}
+
+void writeSigned(QByteArray &out, qint64 value)
+{
+    // Zigzag encoding keeps small negative values short.
+    writeVarint(out, (quint64(value) << 1) ^ quint64(value >> 63));
+}
+
+void writeString(QByteArray &out, const QString &text)
+{
+    const QByteArray utf8 = text.toUtf8();
+    writeVarint(out, quint64(utf8.size()));
+    out.append(utf8);
+}
+
+bool readVarint(const QByteArray &in, qint64 &offset, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (offset >= in.size())
+            return false;
+        const quint8 byte = quint8(in.at(offset++));
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool readSigned(const QByteArray &in, qint64 &offset, qint64 &value)
+{
+    quint64 raw = 0;
+    if (!readVarint(in, offset, raw))
+        return false;
+    value = qint64(raw >> 1) ^ -qint64(raw & 1);
+    return true;
+}
+
+bool readString(const QByteArray &in, qint64 &offset, QString &text)
+{
+    quint64 length = 0;
+    if (!readVarint(in, offset, length) || length > quint64(in.size() - offset))
+        return false;
+    text = QString::fromUtf8(in.constData() + offset, qsizetype(length));
+    offset += qint64(length);
+    return true;
+}
+
+QString defaultActor()
+{
+    QString name = qEnvironmentVariable("USER");
+    if (name.isEmpty())
+        name = qEnvironmentVariable("USERNAME");
+    return name.isEmpty() ? QStringLiteral("unknown") : name;
+}
+
+}
+
+AuditLog::AuditLog(QObject *parent)
+    : QObject(parent), pendingActor(defaultActor())
+{
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(0);
+    connect(&flushTimer, &QTimer::timeout, this, &AuditLog::flush);
+}
+
+AuditLog::~AuditLog()
+{
+    write(true);
+}
+
+void AuditLog::attach(TaskModel *taskModel)
+{
+    for (const QMetaObject::Connection &connection : std::as_const(connections))
+        disconnect(connection);
+    connections.clear();
+
+    model = taskModel;
+    if (!model || suspended)
+        return;
+
+    syncSession();
+
+    connections << connect(model, &TaskModel::rowsInserted, this, [this](const QModelIndex &, int first, int last) {
+        for (int row = first; row <= last; ++row)
+        {
+            // Compacted tasks come back from the trash as new rows at the end.
+            const quint64 id = model->taskId(row);
+            if (trashed.contains(id))
+                recordRestored(id, model->getTask(row), true);
+            else
+                recordCreated(id, model->getTask(row));
+        }
+    });
+    connections << connect(model, &TaskModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &, int first, int last) {
+        // Tombstoned rows were recorded as removed when they were deleted.
+        for (int row = first; row <= last; ++row)
+        {
+            if (!model->isDeleted(row))
+                recordRemoved(model->taskId(row));
+        }
+    });
+    connections << connect(model, &TaskModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+        {
+            const QModelIndex index = model->index(row);
+            const quint64 id = model->taskId(row);
+            // Description edits arrive separately through descriptionEdited() with their span.
+            for (int role : roles)
+            {
+                switch (role)
+                {
+                case TaskModel::TitleRole:
+                    recordChange(id, Title, model->data(index, role));
+                    break;
+                case TaskModel::CompletedRole:
+                    recordCompleted(id, model->data(index, role).toBool(),
+                                    model->data(index, TaskModel::CompletedAtRole).toDateTime());
+                    break;
+                case TaskModel::PriorityRole:
+                    recordChange(id, Priority, model->data(index, role));
+                    break;
+                case TaskModel::AssigneeRole:
+                    recordChange(id, Assignee, model->data(index, role));
+                    break;
+                case TaskModel::EstimateRole:
+                    recordChange(id, Estimate, model->data(index, role));
+                    break;
+                case TaskModel::DependenciesRole:
+                    recordChange(id, Dependencies, model->data(index, role));
+                    break;
+                case TaskModel::DeletedRole:
+                    if (model->isDeleted(row))
+                        recordRemoved(id);
+                    else
+                        recordRestored(id, model->getTask(row), false);
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+    });
+    connections << connect(model, &TaskModel::modelAboutToBeReset, this, &AuditLog::recordCleared);
+    connections << connect(model, &TaskModel::descriptionEdited, this, [this](int index, int position, int removed, int added) {
+        recordDescriptionEdit(model->taskId(index), position, removed, model->descriptionText(index, position, added));
+    });
+}
+
+void AuditLog::setSuspended(bool suspend)
+{
+    if (suspended == suspend)
+        return;
+
+    suspended = suspend;
+    attach(model);
+}
+
+void AuditLog::syncSession()
+{
+    QSet<quint64> tasks;
+    tasks.reserve(model->rowCount());
+    for (int row = 0; row < model->rowCount(); ++row)
+    {
+        if (!model->isDeleted(row))
+            tasks.insert(model->taskId(row));
+    }
+    if (entries > 0 && tasks == live)
+        return;
+
+    recordCleared();
+    for (int row = 0; row < model->rowCount(); ++row)
+    {
+        if (!model->isDeleted(row))
+            recordCreated(model->taskId(row), model->getTask(row));
+    }
+}
+
+QString AuditLog::actor() const
+{
+    return currentActor >= 0 && pendingActor.isNull() ? actors.at(currentActor) : pendingActor;
+}
+
+void AuditLog::setActor(const QString &name)
+{
+    if (actor() == name)
+        return;
+
+    // Interning is deferred to the next entry so switching actors back and forth
+    // without changing anything does not grow the log.
+    pendingActor = name.isNull() ? QStringLiteral("") : name;
+    emit actorChanged();
+}
+
+void AuditLog::beginEntry(quint64 taskId, Field field)
+{
+    if (!pendingActor.isNull())
+    {
+        auto it = actorIds.constFind(pendingActor);
+        if (it == actorIds.constEnd())
+        {
+            writeVarint(log, 0);
+            writeVarint(log, 0);
+            writeVarint(log, 0);
+            log.append(char(ActorDefinition));
+            writeString(log, pendingActor);
+            it = actorIds.insert(pendingActor, int(actors.size()));
+            actors.append(pendingActor);
+        }
+        currentActor = it.value();
+        pendingActor = QString();
+    }
+
+    index[taskId].append({base + log.size(), 0});
+    writeVarint(log, taskId);
+    writeVarint(log, quint64(QDateTime::currentMSecsSinceEpoch()));
+    writeVarint(log, quint64(currentActor));
+    log.append(char(field));
+}
+
+void AuditLog::endEntry(quint64 taskId, Field field)
+{
+    Span &span = index[taskId].last();
+    span.length = base + log.size() - span.offset;
+    track(taskId, field);
+    ++entries;
+    if (file.isOpen() && !flushTimer.isActive())
+        flushTimer.start();
+    emit entryRecorded(taskId, field);
+}
+
+void AuditLog::track(quint64 taskId, int field)
+{
+    switch (field)
+    {
+    case Created:
+    case Restored:
+        live.insert(taskId);
+        trashed.remove(taskId);
+        break;
+    case Removed:
+        live.remove(taskId);
+        trashed.insert(taskId);
+        break;
+    case Cleared:
+        live.clear();
+        trashed.clear();
+        break;
+    default:
+        break;
+    }
+}
+
+void AuditLog::writeRecord(const TaskRecord &record)
+{
+    writeString(log, record.getTitle());
+    writeString(log, record.getDescription());
+    writeSigned(log, record.getPriority());
+    log.append(char(record.getCompleted()));
+    writeSigned(log, record.getDateTime().toMSecsSinceEpoch());
+    if (record.getCompleted())
+        writeSigned(log, record.getCompletedAt().isValid() ? record.getCompletedAt().toMSecsSinceEpoch() : 0);
+}
+
+void AuditLog::recordCreated(quint64 taskId, const TaskRecord &record)
+{
+    beginEntry(taskId, Created);
+    writeRecord(record);
+    endEntry(taskId, Created);
+
+    // Creation entries predate assignees and plans; those values get entries of their own.
+    if (!record.getAssignee().isEmpty())
+        recordChange(taskId, Assignee, record.getAssignee());
+    if (record.getEstimate() != 0)
+        recordChange(taskId, Estimate, record.getEstimate());
+    if (!record.getDependencies().isEmpty())
+        recordChange(taskId, Dependencies, QVariant::fromValue(record.getDependencies()));
+}
+
+void AuditLog::recordChange(quint64 taskId, Field field, const QVariant &value)
+{
+    switch (field)
+    {
+    case Title:
+        beginEntry(taskId, field);
+        writeString(log, value.toString());
+        break;
+    case Completed:
+        recordCompleted(taskId, value.toBool(), value.toBool() ? QDateTime::currentDateTime() : QDateTime());
+        return;
+    case Priority:
+        beginEntry(taskId, field);
+        writeSigned(log, value.toInt());
+        break;
+    case Assignee:
+        beginEntry(taskId, field);
+        writeString(log, value.toString());
+        break;
+    case Estimate:
+        beginEntry(taskId, field);
+        writeSigned(log, value.toInt());
+        break;
+    case Dependencies:
+    {
+        const QList<quint64> ids = value.value<QList<quint64>>();
+        beginEntry(taskId, field);
+        writeVarint(log, quint64(ids.size()));
+        for (quint64 id : ids)
+            writeVarint(log, id);
+        break;
+    }
+    default:
+        qWarning() << "AuditLog::recordChange: unsupported field" << field;
+        return;
+    }
+    endEntry(taskId, field);
+}
+
+void AuditLog::recordCompleted(quint64 taskId, bool completed, const QDateTime &completedAt)
+{
+    // The completion time is stored with the entry (0 if unknown) because it is part of
+    // the task's state and may differ from the time the entry is recorded.
+    beginEntry(taskId, Completed);
+    log.append(char(completed));
+    if (completed)
+        writeSigned(log, completedAt.isValid() ? completedAt.toMSecsSinceEpoch() : 0);
+    endEntry(taskId, Completed);
+}
+
+void AuditLog::recordDescriptionEdit(quint64 taskId, int position, int removed, const QString &inserted)
+{
+    beginEntry(taskId, Description);
+    writeVarint(log, quint64(qMax(0, position)));
+    writeVarint(log, quint64(qMax(0, removed)));
+    writeString(log, inserted);
+    endEntry(taskId, Description);
+}
+
+void AuditLog::recordRemoved(quint64 taskId)
+{
+    beginEntry(taskId, Removed);
+    endEntry(taskId, Removed);
+}
+
+void AuditLog::recordRestored(quint64 taskId, const TaskRecord &record, bool appended)
+{
+    // The values are stored again so replaying never depends on entries before the removal;
+    // assignee and plan come back through their own entries as for creations.
+    beginEntry(taskId, Restored);
+    log.append(char(appended));
+    writeRecord(record);
+    endEntry(taskId, Restored);
+
+    if (!record.getAssignee().isEmpty())
+        recordChange(taskId, Assignee, record.getAssignee());
+    if (record.getEstimate() != 0)
+        recordChange(taskId, Estimate, record.getEstimate());
+    if (!record.getDependencies().isEmpty())
+        recordChange(taskId, Dependencies, QVariant::fromValue(record.getDependencies()));
+}
+
+void AuditLog::recordCleared()
+{
+    beginEntry(0, Cleared);
+    endEntry(0, Cleared);
+}
+
+bool AuditLog::decodeRaw(const QByteArray &log, qint64 &offset, AuditEntry &decoded, quint64 &actorId)
+{
+    quint64 id = 0;
+    quint64 timestamp = 0;
+    if (!readVarint(log, offset, id) || !readVarint(log, offset, timestamp) || !readVarint(log, offset, actorId))
+        return false;
+    if (offset >= log.size())
+        return false;
+    const quint8 field = quint8(log.at(offset++));
+
+    decoded = AuditEntry();
+    decoded.taskId = id;
+    decoded.timestamp = QDateTime::fromMSecsSinceEpoch(qint64(timestamp));
+    decoded.field = field;
+
+    QString text;
+    qint64 number = 0;
+    switch (field)
+    {
+    case ActorDefinition:
+        if (!readString(log, offset, text))
+            return false;
+        decoded.value = text;
+        break;
+    case Restored:
+        if (offset >= log.size())
+            return false;
+        decoded.appended = log.at(offset++) != 0;
+        Q_FALLTHROUGH();
+    case Created:
+    {
+        QString description;
+        qint64 created = 0;
+        if (!readString(log, offset, text) || !readString(log, offset, description) || !readSigned(log, offset, number)
+            || offset >= log.size())
+            return false;
+        const bool completed = log.at(offset++) != 0;
+        qint64 completedAt = 0;
+        if (!readSigned(log, offset, created) || (completed && !readSigned(log, offset, completedAt)))
+            return false;
+        decoded.value = QVariant::fromValue(TaskRecord(text, description, int(number), completed,
+                                                       QDateTime::fromMSecsSinceEpoch(created), id)
+                                                .withCompletedAt(completedAt ? QDateTime::fromMSecsSinceEpoch(completedAt) : QDateTime()));
+        break;
+    }
+    case Title:
+    case Assignee:
+        if (!readString(log, offset, text))
+            return false;
+        decoded.value = text;
+        break;
+    case Description:
+    {
+        quint64 position = 0;
+        quint64 removed = 0;
+        if (!readVarint(log, offset, position) || !readVarint(log, offset, removed) || !readString(log, offset, text))
+            return false;
+        decoded.position = int(position);
+        decoded.removed = int(removed);
+        decoded.value = text;
+        break;
+    }
+    case Completed:
+        if (offset >= log.size())
+            return false;
+        decoded.value = log.at(offset++) != 0;
+        if (decoded.value.toBool())
+        {
+            if (!readSigned(log, offset, number))
+                return false;
+            if (number)
+                decoded.completedAt = QDateTime::fromMSecsSinceEpoch(number);
+        }
+        break;
+    case Priority:
+    case Estimate:
+        if (!readSigned(log, offset, number))
+            return false;
+        decoded.value = int(number);
+        break;
+    case Dependencies:
+    {
+        quint64 count = 0;
+        if (!readVarint(log, offset, count) || count > quint64(log.size() - offset))
+            return false;
+        QList<quint64> ids;
+        ids.reserve(qsizetype(count));
+        for (quint64 i = 0; i < count; ++i)
+        {
+            quint64 dependency = 0;
+            if (!readVarint(log, offset, dependency))
+                return false;
+            ids.append(dependency);
+        }
+        decoded.value = QVariant::fromValue(ids);
+        break;
+    }
+    case Removed:
+    case Cleared:
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+bool AuditLog::decode(const QByteArray &log, qint64 &offset, AuditEntry &entry)
+{
+    quint64 actorId = 0;
+    while (offset < log.size())
+    {
+        qint64 next = offset;
+        if (!decodeRaw(log, next, entry, actorId))
+            return false;
+        offset = next;
+        if (entry.field != ActorDefinition)
+            return true;
+    }
+    return false;
+}
+
+bool AuditLog::decodeEntry(const QByteArray &bytes, qint64 &offset, AuditEntry *entry) const
+{
+    AuditEntry decoded;
+    quint64 actorId = 0;
+    if (!decodeRaw(bytes, offset, decoded, actorId))
+        return false;
+
+    if (decoded.field != ActorDefinition)
+    {
+        if (actorId >= quint64(actors.size()))
+            return false;
+        decoded.actor = actors.at(int(actorId));
+    }
+    if (entry)
+        *entry = std::move(decoded);
+    return true;
+}
+
+QList<AuditEntry> AuditLog::history(quint64 taskId) const
+{
+    QList<AuditEntry> result;
+    const auto it = index.constFind(taskId);
+    if (it == index.constEnd())
+        return result;
+
+    // Entries already in the file are read back in one batch.
+    QList<IoRequest> reads;
+    for (const Span &span : *it)
+    {
+        if (span.offset < base)
+            reads.append(IoRequest::read(file.handle(), span.offset, span.length));
+    }
+    if (!reads.isEmpty() && !io->run(reads))
+        qWarning() << "AuditLog::history: cannot read" << file.fileName();
+
+    result.reserve(it->size());
+    qsizetype read = 0;
+    for (const Span &span : *it)
+    {
+        const bool inFile = span.offset < base;
+        const QByteArray &bytes = inFile ? reads.at(read++).data : log;
+        qint64 offset = inFile ? 0 : span.offset - base;
+        AuditEntry entry;
+        if (decodeEntry(bytes, offset, &entry))
+            result.append(std::move(entry));
+    }
+    return result;
+}
+
+QVariantList AuditLog::historyList(quint64 taskId) const
+{
+    QVariantList result;
+    for (const AuditEntry &entry : history(taskId))
+        result.append(QVariant::fromValue(entry));
+    return result;
+}
+
+QByteArray AuditLog::read(qint64 offset, qint64 length) const
+{
+    offset = qBound<qint64>(0, offset, sizeInBytes());
+    length = qBound<qint64>(0, length, sizeInBytes() - offset);
+
+    QByteArray bytes;
+    if (offset < base)
+    {
+        QList<IoRequest> reads{IoRequest::read(file.handle(), offset, qMin(length, base - offset))};
+        if (!io->run(reads))
+        {
+            qWarning() << "AuditLog::read: cannot read" << file.fileName();
+            return reads.first().data;
+        }
+        bytes = reads.first().data;
+    }
+    const qint64 tail = offset + length - qMax(offset, base);
+    if (tail > 0)
+        bytes.append(log.constData() + (qMax(offset, base) - base), tail);
+    return bytes;
+}
+
+qint64 AuditLog::rebuildIndex(const QByteArray &bytes)
+{
+    index.clear();
+    live.clear();
+    trashed.clear();
+    actors.clear();
+    actorIds.clear();
+    entries = 0;
+
+    qint64 offset = 0;
+    while (offset < bytes.size())
+    {
+        const qint64 start = offset;
+        AuditEntry entry;
+        if (!decodeEntry(bytes, offset, &entry))
+            return start;
+
+        if (entry.field == ActorDefinition)
+        {
+            const QString name = entry.value.toString();
+            actorIds.insert(name, int(actors.size()));
+            actors.append(name);
+            continue;
+        }
+        index[entry.taskId].append({start, offset - start});
+        track(entry.taskId, entry.field);
+        ++entries;
+    }
+    return offset;
+}
+
+bool AuditLog::open(const QString &path)
+{
+    const QString name = actor();
+    write(true);
+    file.close();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadWrite))
+    {
+        qWarning() << "AuditLog::open: cannot open" << path << file.errorString();
+        return false;
+    }
+
+    // Indexed through a read-only mapping; the entries are read back when asked for.
+    const qint64 size = file.size();
+    uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+    const QByteArray bytes = mapped ? QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), size) : file.readAll();
+    const qint64 valid = rebuildIndex(bytes);
+    if (mapped)
+        file.unmap(mapped);
+    if (valid < size)
+    {
+        // Cut off a partially written trailing entry.
+        qWarning() << "AuditLog::open: discarding truncated entry at the end of" << path;
+        file.resize(valid);
+    }
+    log.clear();
+    base = valid;
+    if (!io)
+        io = std::make_unique<IoQueue>();
+
+    // Re-intern the current actor against the loaded table on the next entry.
+    pendingActor = name;
+    currentActor = -1;
+    if (model && !suspended)
+        syncSession();
+    emit reloaded();
+    return true;
+}
+
+void AuditLog::flush()
+{
+    write(false);
+}
+
+void AuditLog::write(bool durable)
+{
+    flushTimer.stop();
+    if (!file.isOpen() || (log.isEmpty() && !durable))
+        return;
+
+    // The pending tail goes out through the registered journal buffers, without a copy here,
+    // and leaves memory once it is in the file.
+    Metrics::Registry &metrics = Metrics::registry();
+    Metrics::ScopedTimer timer(metrics.storageWrite);
+    const qint64 written = io->append(file.handle(), base, {log}, durable);
+    if (written < 0)
+    {
+        qWarning() << "AuditLog::flush: write failed" << file.fileName();
+        return;
+    }
+    base += written;
+    log.remove(0, written);
+    metrics.storageBytes.add(quint64(written));
+}
@@ -0,0 +1,352 @@
+#pragma once
+
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+#include <QVariant>
+#include "TaskRecord.h"
+
+#include <memory>
+
+class IoQueue;
+class TaskModel;
+
+
+/**
+ * @file AuditLog.h
+ * @brief Append-only, field-level change history of tasks
+ */
+
+/**
+ * @struct AuditEntry
+ * @brief One decoded entry of a task's audit history
+ *
+ * For description edits, value holds the inserted text and position/removed describe
+ * the replaced span of the previous version (see AuditLog::Description). For creations
+ * and restores, value holds a TaskRecord. For all other fields, value holds the new value
+ * of the field.
+ */
+struct AuditEntry
+{
+    Q_GADGET
+
+    Q_PROPERTY(quint64 taskId MEMBER taskId)
+    Q_PROPERTY(QDateTime timestamp MEMBER timestamp)
+    Q_PROPERTY(QString actor MEMBER actor)
+    Q_PROPERTY(int field MEMBER field)
+    Q_PROPERTY(QVariant value MEMBER value)
+    Q_PROPERTY(int position MEMBER position)
+    Q_PROPERTY(int removed MEMBER removed)
+    Q_PROPERTY(QDateTime completedAt MEMBER completedAt)
+    Q_PROPERTY(bool appended MEMBER appended)
+
+public:
+    quint64 taskId = 0;   ///< Id of the task the entry belongs to
+    QDateTime timestamp;  ///< When the change was recorded
+    QString actor;        ///< Who made the change
+    int field = 0;        ///< AuditLog::Field that changed
+    QVariant value;       ///< New value, inserted text for description edits, or a TaskRecord for creations and restores
+    int position = 0;     ///< Start of the replaced description span
+    int removed = 0;      ///< Length of the replaced description span
+    QDateTime completedAt; ///< Completion timestamp, for Completed entries that complete the task
+    bool appended = false; ///< For Restored entries, whether the task came back at the end of the list
+};
+
+/**
+ * @class AuditLog
+ * @brief Records who changed what and when on each task
+ *
+ * AuditLog observes a TaskModel and appends one compact binary entry per field-level
+ * change to an append-only log: task creation (with the full initial values), title,
+ * completion, priority, assignee, estimate and dependency changes, description edits and removal. Every entry carries
+ * the task id, a millisecond timestamp and the acting user.
+ *
+ * Descriptions are delta-compressed: only the creation entry stores the full text, and
+ * every later version is stored as the edited span (position, removed length, inserted
+ * text) reported by TaskModel::descriptionEdited(). A keystroke in a long description
+ * therefore costs a few bytes instead of a copy of the description. Integers use
+ * variable-length encoding and actor names are interned.
+ *
+ * A per-task index of entry offsets and lengths makes loading the full history of a task
+ * O(history length), independent of the size of the log. Recording an entry only
+ * encodes a few fields into an in-memory buffer; if a log file is open, new entries are
+ * appended to it in batches from the event loop, each batch one IoQueue::append() group
+ * commit, and leave memory once written. Batches are not synced one by one; closing the
+ * file (open() of another file, or destruction) syncs it. Entries in the file are read
+ * back on demand, so memory holds the index and the unwritten tail, not the log.
+ *
+ * Moving a task to the trash is recorded as Removed, and restoring it as Restored with
+ * its current values: the log describes the live task list, without the trash.
+ *
+ * Attaching a model (or opening a file while a model is attached) starts a session: a
+ * Cleared entry followed by a Created entry for every task already in the model. Task
+ * ids are only unique within a session, so replaying the log (see TaskHistory) always
+ * starts each session from an empty task list. A session is only started if the log is
+ * empty or its live tasks are not the model's, compared by id; reopening the log of the
+ * last session over the same tasks appends nothing. While suspended (see setSuspended(),
+ * e.g. while TaskStore loads the stored tasks), changes of the model are not recorded.
+ *
+ * Example usage:
+ * @code
+ * AuditLog *audit = new AuditLog(this);
+ * audit->attach(model);
+ * audit->setActor("alice");
+ * model->toggleCompleted(0);
+ * for (const AuditEntry &entry : audit->history(model->taskId(0)))
+ *     qDebug() << entry.timestamp << entry.actor << entry.field << entry.value;
+ * @endcode
+ */
+class AuditLog : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * @property actor
+     * @brief Name of the user recorded for subsequent changes
+     *
+     * Defaults to the login name of the current user.
+     */
+    Q_PROPERTY(QString actor READ actor WRITE setActor NOTIFY actorChanged)
+
+    /**
+     * @property entryCount
+     * @brief Number of task entries in the log
+     */
+    Q_PROPERTY(int entryCount READ entryCount NOTIFY entryRecorded)
+
+public:
+
+    /**
+     * @enum Field
+     * @brief Kinds of audit entries
+     */
+    enum Field
+    {
+        Created = 0,  ///< Task was added; value is a TaskRecord with the initial values
+        Title,        ///< Title changed; value is the new title
+        Description,  ///< Description edited; value is the inserted text, see position/removed
+        Completed,    ///< Completion status changed; value is the new status
+        Priority,     ///< Priority changed; value is the new priority
+        Removed,      ///< Task was removed
+        Cleared,      ///< All tasks were removed, e.g. at the start of a session; taskId is 0
+        Assignee,     ///< Task was reassigned; value is the new assignee, empty if unassigned
+        Estimate,     ///< Estimate changed; value is the new estimate in hours
+        Dependencies, ///< Prerequisites changed; value is the new list of task ids (QList<quint64>)
+        Restored      ///< Task came back from the trash; value is a TaskRecord with its values, see appended
+    };
+    Q_ENUM(Field)
+
+    /**
+     * @brief Constructs an empty, in-memory audit log
+     * @param parent The parent QObject
+     */
+    explicit AuditLog(QObject *parent = nullptr);
+
+    /**
+     * @brief Writes pending entries to the log file, if one is open, and syncs it
+     */
+    ~AuditLog() override;
+
+    /**
+     * @brief Starts recording the changes of a model
+     * @param model The model to observe; replaces any previously attached model
+     */
+    void attach(TaskModel *model);
+
+    /**
+     * @brief Stops or resumes recording the changes of the attached model
+     * @param suspended Whether changes go unrecorded
+     *
+     * Resuming starts a session if the model no longer matches the log. Connected to
+     * TaskStore::adoptingChanged(), so loading the stored tasks does not log them again.
+     */
+    void setSuspended(bool suspended);
+
+    /**
+     * @brief Whether changes of the attached model go unrecorded, see setSuspended()
+     */
+    bool isSuspended() const { return suspended; }
+
+    /**
+     * @brief Opens a log file, indexing its history and appending new entries to it
+     * @param path Path of the log file; created if it does not exist
+     * @return true if the file could be opened and read
+     *
+     * Entries recorded before the call are discarded in favour of the file's content;
+     * if a model is attached and does not match the log, a new session is started for it.
+     * A truncated trailing entry (e.g. after a crash) is cut off. Emits reloaded().
+     */
+    bool open(const QString &path);
+
+    /**
+     * @brief Appends all pending entries to the log file
+     */
+    void flush();
+
+    /**
+     * @brief Gets the actor recorded for subsequent changes
+     */
+    QString actor() const;
+
+    /**
+     * @brief Sets the actor recorded for subsequent changes
+     */
+    void setActor(const QString &actor);
+
+    /**
+     * @brief Gets the number of task entries in the log
+     */
+    int entryCount() const { return entries; }
+
+    /**
+     * @brief Gets the size of the encoded log in bytes, in the file and in memory
+     */
+    qint64 sizeInBytes() const { return base + log.size(); }
+
+    /**
+     * @brief Gets the size of the entries held in memory until they are written to the file
+     */
+    qsizetype bufferedBytes() const { return log.size(); }
+
+    /**
+     * @brief Reads a range of the encoded log
+     * @param offset Offset of the first byte
+     * @param length Maximum number of bytes
+     * @return The bytes, fewer at the end of the log or if the file cannot be read
+     */
+    QByteArray read(qint64 offset, qint64 length) const;
+
+    /**
+     * @brief Reads the whole encoded log, see read()
+     */
+    QByteArray data() const { return read(0, sizeInBytes()); }
+
+    /**
+     * @struct View
+     * @brief Read-only view of the log that another thread can read without the AuditLog
+     *
+     * The written entries are read from the file, which is only ever appended to; the
+     * entries that are not written yet come along as a copy of the in-memory tail.
+     */
+    struct View
+    {
+        QString path;          ///< Log file; empty if no file is open
+        qint64 persisted = 0;  ///< Number of bytes in the file, the log offset of the tail
+        QByteArray tail;       ///< Entries not in the file yet
+    };
+
+    /**
+     * @brief Gets a view of the log as it is now, see View
+     */
+    View view() const { return {file.isOpen() ? file.fileName() : QString(), base, log}; }
+
+    /**
+     * @brief Decodes the next task entry of an encoded log
+     * @param log The encoded log, see data()
+     * @param offset Offset of the entry; advanced past it on success
+     * @param entry Receives the decoded entry; the actor is left empty
+     * @return false at the end of the log or if the entry is malformed
+     *
+     * Internal actor definitions are skipped. Thread-safe.
+     */
+    static bool decode(const QByteArray &log, qint64 &offset, AuditEntry &entry);
+
+    /**
+     * @brief Loads the full history of a task
+     * @param taskId The stable id of the task
+     * @return All entries of the task in the order they were recorded
+     */
+    QList<AuditEntry> history(quint64 taskId) const;
+
+    /**
+     * @brief Loads the full history of a task for QML
+     * @return A list of AuditEntry values
+     */
+    Q_INVOKABLE QVariantList historyList(quint64 taskId) const;
+
+    // Recording API, used by attach() and available for changes made outside a model
+    void recordCreated(quint64 taskId, const TaskRecord &record);
+    void recordChange(quint64 taskId, Field field, const QVariant &value);
+    void recordCompleted(quint64 taskId, bool completed, const QDateTime &completedAt);
+    void recordDescriptionEdit(quint64 taskId, int position, int removed, const QString &inserted);
+    void recordRemoved(quint64 taskId);
+    void recordRestored(quint64 taskId, const TaskRecord &record, bool appended);
+    void recordCleared();
+
+signals:
+
+    /**
+     * @brief Emitted when the actor changes
+     */
+    void actorChanged();
+
+    /**
+     * @brief Emitted after an entry has been appended
+     */
+    void entryRecorded(quint64 taskId, int field);
+
+    /**
+     * @brief Emitted after open() replaced the log with the content of a file
+     */
+    void reloaded();
+
+private:
+
+    /**
+     * @brief Where an entry is in the log
+     */
+    struct Span
+    {
+        qint64 offset = 0;  ///< Log offset of the entry
+        qint64 length = 0;  ///< Encoded size of the entry
+    };
+
+    QByteArray log;                        ///< Encoded entries from base on; all of them without a file
+    qint64 base = 0;                       ///< Log offset of the first byte of log, the bytes in the file
+    QHash<quint64, QList<Span>> index;     ///< Each task's entries in the log
+    QSet<quint64> live;                    ///< Tasks alive at the end of the log
+    QSet<quint64> trashed;                 ///< Tasks removed in the current session
+    QStringList actors;                    ///< Interned actor names by id
+    QHash<QString, int> actorIds;          ///< Reverse lookup of interned actor names
+    int currentActor = -1;                 ///< Id of the actor for new entries, -1 until first use
+    QString pendingActor;                  ///< Actor name to intern on the next entry
+    int entries = 0;                       ///< Number of task entries
+
+    QFile file;                            ///< Log file, if open()ed
+    std::unique_ptr<IoQueue> io;           ///< Queue appending to and reading the file, set up by open()
+    QTimer flushTimer;                     ///< Coalesces file appends to once per event loop pass
+
+    QPointer<TaskModel> model;             ///< Observed model
+    bool suspended = false;                ///< Whether model changes go unrecorded
+    QList<QMetaObject::Connection> connections; ///< Connections to the observed model
+
+    /**
+     * @brief Appends pending entries to the log file as one group commit
+     * @param durable Whether to sync the file once the entries are written
+     */
+    void write(bool durable);
+
+    void beginEntry(quint64 taskId, Field field);
+    void endEntry(quint64 taskId, Field field);
+    void track(quint64 taskId, int field);
+    void writeRecord(const TaskRecord &record);
+    static bool decodeRaw(const QByteArray &log, qint64 &offset, AuditEntry &entry, quint64 &actorId);
+    bool decodeEntry(const QByteArray &bytes, qint64 &offset, AuditEntry *entry) const;
+
+    /**
+     * @brief Indexes the entries of a log file
+     * @return Length of the entries that could be decoded
+     */
+    qint64 rebuildIndex(const QByteArray &bytes);
+
+    /**
+     * @brief Starts a session unless the log's live tasks are the model's
+     */
+    void syncSession();
+};
+
+Q_DECLARE_METATYPE(AuditEntry)
@@ -0,0 +1,103 @@
+#include "HistoryModel.h"
+#include "TaskModel.h"
+
+HistoryModel::HistoryModel(TaskHistory *taskHistory, QObject *parent)
+    : QAbstractListModel(parent), history(taskHistory)
+{
+}
+
+int HistoryModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return tasks.size();
+}
+
+QVariant HistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= tasks.size())
+        return QVariant();
+
+    const TaskRecord &task = tasks.at(index.row());
+
+    switch (role)
+    {
+    case TaskModel::TitleRole:
+        return task.getTitle();
+    case TaskModel::DescriptionRole:
+        return task.getDescription();
+    case TaskModel::CompletedRole:
+        return task.getCompleted();
+    case TaskModel::CreatedAtRole:
+        return task.getDateTime();
+    case TaskModel::PriorityRole:
+        return task.getPriority();
+    case TaskModel::RecordRole:
+        return QVariant::fromValue(task);
+    case TaskModel::IdRole:
+        return task.getId();
+    case TaskModel::CompletedAtRole:
+        return task.getCompletedAt();
+    case TaskModel::AssigneeRole:
+        return task.getAssignee();
+    case TaskModel::EstimateRole:
+        return task.getEstimate();
+    case TaskModel::DependenciesRole:
+        return QVariant::fromValue(task.getDependencies());
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> HistoryModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[TaskModel::TitleRole] = "title";
+    roles[TaskModel::DescriptionRole] = "description";
+    roles[TaskModel::CompletedRole] = "completed";
+    roles[TaskModel::CreatedAtRole] = "createdAt";
+    roles[TaskModel::PriorityRole] = "priority";
+    roles[TaskModel::RecordRole] = "record";
+    roles[TaskModel::IdRole] = "taskId";
+    roles[TaskModel::CompletedAtRole] = "completedAt";
+    roles[TaskModel::AssigneeRole] = "assignee";
+    roles[TaskModel::EstimateRole] = "estimate";
+    roles[TaskModel::DependenciesRole] = "dependencies";
+    return roles;
+}
+
+void HistoryModel::showAt(const QDateTime &time)
+{
+    if (!history)
+        return;
+
+    const int id = ++request;
+    if (!loading)
+    {
+        loading = true;
+        emit loadingChanged();
+    }
+
+    history->stateAt(time).then(this, [this, id, time](const QList<TaskRecord> &state) {
+        if (id != request)
+            return;
+
+        const int oldCount = tasks.size();
+        beginResetModel();
+        tasks = state;
+        endResetModel();
+
+        shownAt = time.isValid() ? time : QDateTime::currentDateTime();
+        loading = false;
+        emit timestampChanged();
+        emit loadingChanged();
+        if (tasks.size() != oldCount)
+            emit countChanged();
+    });
+}
+
+TaskRecord HistoryModel::getTask(int index) const
+{
+    if (index < 0 || index >= tasks.size())
+        return TaskRecord();
+    return tasks.at(index);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QPointer>
+#include "TaskHistory.h"
+
+
+/**
+ * @file HistoryModel.h
+ * @brief Read-only list model of the task list at a past point in time
+ */
+
+/**
+ * @class HistoryModel
+ * @brief Shows the task list as it was at a given time
+ *
+ * HistoryModel exposes the result of TaskHistory::stateAt() with the same roles as
+ * TaskModel, so the delegates used for the live list can render it unchanged. The model
+ * is read-only and independent of the live TaskModel, which keeps running while a past
+ * state is reconstructed on a worker thread and shown.
+ *
+ * Example usage (QML):
+ * @code
+ * ListView {
+ *     model: taskController.historyModel
+ *     delegate: TaskItem { task: model.record }
+ *     Component.onCompleted: taskController.historyModel.showAt(new Date(2026, 9, 13, 10, 0))
+ * }
+ * @endcode
+ */
+class HistoryModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /**
+     * @property timestamp
+     * @brief The point in time currently shown; invalid until the first showAt() completed
+     */
+    Q_PROPERTY(QDateTime timestamp READ timestamp NOTIFY timestampChanged)
+
+    /**
+     * @property loading
+     * @brief Whether a past state is being reconstructed
+     */
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+
+    /**
+     * @property count
+     * @brief The number of tasks shown
+     */
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+private:
+
+    QPointer<TaskHistory> history; ///< Source of past states
+    QList<TaskRecord> tasks;       ///< Task list currently shown
+    QDateTime shownAt;             ///< Point in time of tasks
+    bool loading = false;          ///< Whether a reconstruction is running
+    int request = 0;               ///< Id of the latest showAt() call, to drop superseded results
+
+public:
+
+    /**
+     * @brief Constructs an empty history model
+     * @param history The history to reconstruct past states from
+     * @param parent The parent QObject
+     */
+    explicit HistoryModel(TaskHistory *history, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * @brief Gets the point in time currently shown
+     */
+    QDateTime timestamp() const { return shownAt; }
+
+    /**
+     * @brief Checks whether a past state is being reconstructed
+     */
+    bool isLoading() const { return loading; }
+
+    /**
+     * @brief Shows the task list as it was at the given time
+     * @param time The point in time; an invalid time shows the latest state
+     *
+     * Returns immediately; the model is reset once the state has been reconstructed.
+     * If called again before that, only the latest request is shown.
+     */
+    Q_INVOKABLE void showAt(const QDateTime &time);
+
+    /**
+     * @brief Gets the task at the specified index
+     * @return The task's record, or a null TaskRecord if the index is invalid
+     */
+    Q_INVOKABLE TaskRecord getTask(int index) const;
+
+signals:
+
+    /**
+     * @brief Emitted when a reconstructed state has been shown
+     */
+    void timestampChanged();
+
+    /**
+     * @brief Emitted when a reconstruction starts or finishes
+     */
+    void loadingChanged();
+
+    /**
+     * @brief Emitted when the number of tasks shown changes
+     */
+    void countChanged();
+};
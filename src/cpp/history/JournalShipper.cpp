@@ -0,0 +1,211 @@
+#include "JournalShipper.h"
+#include "Metrics.h"
+
+#include <QDebug>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QtEndian>
+
+#include <chrono>
+
+QByteArray JournalFrame::encode() const
+{
+    QByteArray out(HeaderSize, Qt::Uninitialized);
+    uchar *header = reinterpret_cast<uchar *>(out.data());
+    header[0] = type;
+    qToBigEndian(quint64(offset), header + 1);
+    qToBigEndian(quint64(sentNs), header + 9);
+    qToBigEndian(quint32(payload.size()), header + 17);
+    out.append(payload);
+    return out;
+}
+
+bool JournalFrame::take(QByteArray &buffer, JournalFrame &frame, bool &error)
+{
+    error = false;
+    if (buffer.size() < HeaderSize)
+        return false;
+
+    const uchar *header = reinterpret_cast<const uchar *>(buffer.constData());
+    const quint8 type = header[0];
+    const quint32 length = qFromBigEndian<quint32>(header + 17);
+    if (type < Data || type > Reset || length > MaxPayload || (type != Data && length > 0))
+    {
+        error = true;
+        return false;
+    }
+    if (buffer.size() - HeaderSize < qsizetype(length))
+        return false;
+
+    frame.type = Type(type);
+    frame.offset = qint64(qFromBigEndian<quint64>(header + 1));
+    frame.sentNs = qint64(qFromBigEndian<quint64>(header + 9));
+    frame.payload = buffer.mid(HeaderSize, length);
+    buffer.remove(0, HeaderSize + length);
+    return true;
+}
+
+qint64 JournalFrame::now()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+JournalShipper::JournalShipper(AuditLog *auditLog, QObject *parent)
+    : QObject(parent), audit(auditLog)
+{
+    shipTimer.setSingleShot(true);
+    shipTimer.setInterval(0);
+    connect(&shipTimer, &QTimer::timeout, this, &JournalShipper::ship);
+
+    heartbeatTimer.setInterval(HeartbeatIntervalMs);
+    connect(&heartbeatTimer, &QTimer::timeout, this, &JournalShipper::heartbeat);
+
+    if (audit)
+    {
+        connect(audit, &AuditLog::entryRecorded, this, [this]() {
+            if (!standbys.isEmpty() && !shipTimer.isActive())
+                shipTimer.start();
+        });
+        connect(audit, &AuditLog::reloaded, this, &JournalShipper::restart);
+    }
+}
+
+JournalShipper::~JournalShipper()
+{
+    close();
+}
+
+bool JournalShipper::listen(const QString &name)
+{
+    close();
+
+    server = new QLocalServer(this);
+    // Only the user running the primary may follow it.
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    QLocalServer::removeServer(name);
+    if (!server->listen(name))
+    {
+        qWarning() << "JournalShipper::listen: cannot listen on" << name << server->errorString();
+        delete server;
+        server = nullptr;
+        return false;
+    }
+
+    connect(server, &QLocalServer::newConnection, this, &JournalShipper::accept);
+    heartbeatTimer.start();
+    return true;
+}
+
+void JournalShipper::close()
+{
+    heartbeatTimer.stop();
+    shipTimer.stop();
+
+    const bool hadStandbys = !standbys.isEmpty();
+    for (const Standby &standby : std::as_const(standbys))
+    {
+        standby.socket->disconnect(this);
+        standby.socket->abort();
+        standby.socket->deleteLater();
+    }
+    standbys.clear();
+
+    delete server;
+    server = nullptr;
+
+    if (hadStandbys)
+        emit standbyCountChanged();
+}
+
+bool JournalShipper::isListening() const
+{
+    return server && server->isListening();
+}
+
+void JournalShipper::accept()
+{
+    while (QLocalSocket *socket = server->nextPendingConnection())
+    {
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() { drop(socket); });
+        connect(socket, &QLocalSocket::bytesWritten, this, [this]() {
+            if (!shipTimer.isActive())
+                shipTimer.start();
+        });
+
+        JournalFrame reset;
+        reset.type = JournalFrame::Reset;
+        reset.sentNs = JournalFrame::now();
+        socket->write(reset.encode());
+        standbys.append({socket, 0});
+        emit standbyCountChanged();
+    }
+    ship();
+}
+
+void JournalShipper::drop(QLocalSocket *socket)
+{
+    for (qsizetype i = 0; i < standbys.size(); ++i)
+    {
+        if (standbys.at(i).socket == socket)
+        {
+            standbys.removeAt(i);
+            socket->deleteLater();
+            emit standbyCountChanged();
+            return;
+        }
+    }
+}
+
+void JournalShipper::restart()
+{
+    JournalFrame reset;
+    reset.type = JournalFrame::Reset;
+    reset.sentNs = JournalFrame::now();
+    const QByteArray frame = reset.encode();
+    for (Standby &standby : standbys)
+    {
+        standby.socket->write(frame);
+        standby.shipped = 0;
+    }
+    ship();
+}
+
+void JournalShipper::ship()
+{
+    if (!audit)
+        return;
+
+    // Frames are cut from the log as they are sent, read back from the file if need be.
+    const qint64 size = audit->sizeInBytes();
+    for (Standby &standby : standbys)
+    {
+        while (standby.shipped < size && standby.socket->bytesToWrite() < MaxUnsentBytes)
+        {
+            JournalFrame data;
+            data.type = JournalFrame::Data;
+            data.offset = standby.shipped;
+            data.sentNs = JournalFrame::now();
+            data.payload = audit->read(standby.shipped, qMin<qint64>(size - standby.shipped, JournalFrame::MaxPayload));
+            if (data.payload.isEmpty())
+                break;
+            standby.socket->write(data.encode());
+            standby.shipped += data.payload.size();
+            Metrics::registry().journalShipped.add(quint64(data.payload.size()));
+        }
+    }
+}
+
+void JournalShipper::heartbeat()
+{
+    if (standbys.isEmpty())
+        return;
+
+    JournalFrame beat;
+    beat.type = JournalFrame::Heartbeat;
+    beat.offset = audit ? audit->sizeInBytes() : 0;
+    beat.sentNs = JournalFrame::now();
+    const QByteArray frame = beat.encode();
+    for (const Standby &standby : std::as_const(standbys))
+        standby.socket->write(frame);
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include "AuditLog.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+
+/**
+ * @file JournalShipper.h
+ * @brief Streams the audit log to standby processes over a local socket
+ */
+
+/**
+ * @struct JournalFrame
+ * @brief Unit of the stream between a JournalShipper and a StandbyReplica
+ *
+ * On the wire a frame is a 21 byte big-endian header (type, offset, sentNs, payload
+ * length) followed by the payload.
+ */
+struct JournalFrame
+{
+    /**
+     * @brief Kinds of frames
+     */
+    enum Type : quint8
+    {
+        Data = 1,   ///< payload holds the log bytes starting at offset
+        Heartbeat,  ///< No payload; offset is the primary's log size
+        Reset       ///< The log restarts; the standby drops what it has
+    };
+
+    static constexpr int HeaderSize = 21;        ///< Encoded size of the header
+    static constexpr quint32 MaxPayload = 1 << 20; ///< Largest payload of a Data frame
+
+    Type type = Heartbeat;  ///< Kind of frame
+    qint64 offset = 0;      ///< Log offset, see Type
+    qint64 sentNs = 0;      ///< Wall clock of the primary when sent, ns since the epoch
+    QByteArray payload;     ///< Log bytes of a Data frame
+
+    /**
+     * @brief Encodes the frame for writing to the socket
+     */
+    QByteArray encode() const;
+
+    /**
+     * @brief Takes the first complete frame off a receive buffer
+     * @param buffer Bytes received so far; the frame is removed from its front
+     * @param frame Receives the frame
+     * @param error Set to true if the buffer does not start with a valid frame
+     * @return true if a frame was taken
+     */
+    static bool take(QByteArray &buffer, JournalFrame &frame, bool &error);
+
+    /**
+     * @brief Gets the wall clock in ns since the epoch, comparable between processes
+     */
+    static qint64 now();
+};
+
+/**
+ * @class JournalShipper
+ * @brief Primary side of log shipping: serves the audit log to hot standbys
+ *
+ * Listens on a QLocalServer (a Unix domain socket, or a named pipe on Windows). Each
+ * standby that connects first gets a Reset and the whole encoded log, then the bytes of
+ * every new entry, coalesced to one write per event loop pass. A Heartbeat goes out every
+ * HeartbeatIntervalMs so a standby can tell a hung primary from an idle one. When the
+ * audit log is reopened, all standbys get a Reset and the new log.
+ *
+ * A standby that does not read fast enough is sent no more than MaxUnsentBytes ahead of
+ * what it has taken; the rest follows as it catches up.
+ *
+ * Example usage:
+ * @code
+ * JournalShipper *shipper = new JournalShipper(controller->auditLog(), this);
+ * if (!shipper->listen("taskmanager-journal"))
+ *     qWarning() << "no standby can follow this instance";
+ * @endcode
+ */
+class JournalShipper : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * @property standbyCount
+     * @brief Number of connected standbys
+     */
+    Q_PROPERTY(int standbyCount READ standbyCount NOTIFY standbyCountChanged)
+
+public:
+
+    /**
+     * @brief Interval between heartbeats, in milliseconds
+     */
+    static constexpr int HeartbeatIntervalMs = 100;
+
+    /**
+     * @brief Bytes queued on a standby's socket beyond which shipping waits
+     */
+    static constexpr qint64 MaxUnsentBytes = 8 * 1024 * 1024;
+
+    /**
+     * @brief Constructs a shipper that is not listening yet
+     * @param auditLog The log to ship
+     * @param parent The parent QObject
+     */
+    explicit JournalShipper(AuditLog *auditLog, QObject *parent = nullptr);
+    ~JournalShipper() override;
+
+    /**
+     * @brief Starts accepting standbys
+     * @param name Name of the local socket; a stale socket left by a dead process is removed
+     * @return true if the server is listening
+     */
+    bool listen(const QString &name);
+
+    /**
+     * @brief Stops listening and disconnects all standbys
+     */
+    void close();
+
+    /**
+     * @brief Whether the shipper is listening
+     */
+    bool isListening() const;
+
+    /**
+     * @brief Gets the number of connected standbys
+     */
+    int standbyCount() const { return int(standbys.size()); }
+
+signals:
+
+    /**
+     * @brief Emitted when a standby connects or disconnects
+     */
+    void standbyCountChanged();
+
+private:
+
+    /**
+     * @struct Standby
+     * @brief A connected standby and how much of the log it was sent
+     */
+    struct Standby
+    {
+        QLocalSocket *socket = nullptr; ///< Connection, owned by the shipper
+        qint64 shipped = 0;             ///< Bytes of the log sent
+    };
+
+    QPointer<AuditLog> audit;           ///< Shipped log
+    QLocalServer *server = nullptr;     ///< Listening socket
+    QList<Standby> standbys;            ///< Connected standbys
+    QTimer shipTimer;                   ///< Coalesces shipping to once per event loop pass
+    QTimer heartbeatTimer;              ///< Sends heartbeats
+
+    void accept();
+    void drop(QLocalSocket *socket);
+    void restart();
+    void ship();
+    void heartbeat();
+};
@@ -0,0 +1,183 @@
+#include "StandbyReplica.h"
+#include "Metrics.h"
+
+#include <QDebug>
+#include <QLocalSocket>
+
+StandbyReplica::StandbyReplica(QObject *parent)
+    : QObject(parent), socket(new QLocalSocket(this))
+{
+    retryTimer.setSingleShot(true);
+    retryTimer.setInterval(RetryIntervalMs);
+    connect(&retryTimer, &QTimer::timeout, this, &StandbyReplica::connectToPrimary);
+
+    watchdog.setSingleShot(true);
+    connect(&watchdog, &QTimer::timeout, this, &StandbyReplica::takeOver);
+
+    connect(socket, &QLocalSocket::connected, this, [this]() {
+        silence.start();
+        watchdog.start(timeout);
+        setState(Following);
+    });
+    connect(socket, &QLocalSocket::readyRead, this, &StandbyReplica::receive);
+    connect(socket, &QLocalSocket::disconnected, this, [this]() {
+        if (current == Following)
+            takeOver();
+    });
+    connect(socket, &QLocalSocket::errorOccurred, this, [this](QLocalSocket::LocalSocketError) {
+        // The primary is not up yet; keep trying until it is.
+        if (current == Waiting)
+            retryTimer.start();
+        else if (current == Following)
+            takeOver();
+    });
+}
+
+StandbyReplica::~StandbyReplica()
+{
+    socket->disconnect(this);
+}
+
+bool StandbyReplica::setJournalFile(const QString &path)
+{
+    mirror.close();
+    mirror.setFileName(path);
+    if (!mirror.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "StandbyReplica::setJournalFile: cannot write" << path << mirror.errorString();
+        return false;
+    }
+    if (!log.isEmpty())
+        mirror.write(log);
+    return true;
+}
+
+void StandbyReplica::follow(const QString &name)
+{
+    if (current != Idle)
+        return;
+
+    serverName = name;
+    setState(Waiting);
+    connectToPrimary();
+}
+
+void StandbyReplica::setState(State state)
+{
+    if (current == state)
+        return;
+    current = state;
+    emit stateChanged();
+}
+
+void StandbyReplica::connectToPrimary()
+{
+    if (current == Waiting && socket->state() == QLocalSocket::UnconnectedState)
+        socket->connectToServer(serverName, QIODevice::ReadOnly);
+}
+
+void StandbyReplica::receive()
+{
+    received.append(socket->readAll());
+    silence.restart();
+    watchdog.start(timeout);
+
+    const qint64 before = decoded;
+    const qint64 entriesBefore = entries;
+    JournalFrame frame;
+    bool error = false;
+    while (JournalFrame::take(received, frame, error))
+    {
+        if (!handle(frame))
+        {
+            error = true;
+            break;
+        }
+    }
+
+    if (error)
+    {
+        // A corrupt stream cannot be resynchronised; start over with a fresh copy.
+        qWarning() << "StandbyReplica: invalid stream from" << serverName << "- reconnecting";
+        watchdog.stop();
+        received.clear();
+        setState(Waiting);
+        socket->abort();
+        retryTimer.start();
+    }
+
+    Metrics::registry().replicationLagBytes.set(lagBytes());
+    if (decoded != before || entries != entriesBefore)
+        emit applied();
+}
+
+bool StandbyReplica::handle(const JournalFrame &frame)
+{
+    switch (frame.type)
+    {
+    case JournalFrame::Reset:
+        log.clear();
+        decoded = 0;
+        entries = 0;
+        primarySize = 0;
+        replay.load({});
+        if (mirror.isOpen())
+            mirror.resize(0);
+        return true;
+
+    case JournalFrame::Heartbeat:
+        primarySize = qMax(primarySize, frame.offset);
+        return true;
+
+    case JournalFrame::Data:
+        break;
+    }
+
+    if (frame.offset != log.size())
+    {
+        qWarning() << "StandbyReplica: expected log offset" << log.size() << "but got" << frame.offset;
+        return false;
+    }
+
+    log.append(frame.payload);
+    primarySize = qMax(primarySize, qint64(log.size()));
+    if (mirror.isOpen() && mirror.write(frame.payload) != frame.payload.size())
+    {
+        qWarning() << "StandbyReplica: cannot write" << mirror.fileName() << mirror.errorString();
+        mirror.close();
+    }
+
+    // A chunk may end inside an entry; the rest of it comes with the next chunk.
+    const qint64 start = decoded;
+    qint64 count = 0;
+    AuditEntry entry;
+    while (AuditLog::decode(log, decoded, entry))
+    {
+        replay.apply(entry);
+        ++count;
+    }
+    entries += count;
+
+    Metrics::Registry &metrics = Metrics::registry();
+    metrics.replicationEntries.add(quint64(count));
+    metrics.replicationBytes.add(quint64(decoded - start));
+    metrics.replicationLag.observe(qMax<qint64>(0, JournalFrame::now() - frame.sentNs));
+    return true;
+}
+
+void StandbyReplica::takeOver()
+{
+    if (current != Following)
+        return;
+
+    detection = silence.elapsed();
+    watchdog.stop();
+    retryTimer.stop();
+    socket->disconnect(this);
+    socket->abort();
+    if (mirror.isOpen())
+        mirror.close();
+
+    setState(TakenOver);
+    emit primaryLost();
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+#include "JournalShipper.h"
+#include "TaskHistory.h"
+
+class QLocalSocket;
+
+
+/**
+ * @file StandbyReplica.h
+ * @brief Hot standby that follows a primary's audit log and takes over when it dies
+ */
+
+/**
+ * @class StandbyReplica
+ * @brief Standby side of log shipping: applies a JournalShipper's stream as it arrives
+ *
+ * follow() connects to the primary's socket, retrying until it is up. Every chunk of the
+ * log is appended to a local copy, optionally mirrored to a journal file, and its entries
+ * are applied at once to a TaskHistory::ReplayState, so the standby's task list is never
+ * more than one chunk behind and taking over needs no replay.
+ *
+ * Once following, the primary is considered dead when its socket closes, which the
+ * kernel does as soon as the process exits, or when no frame arrives for takeoverTimeout
+ * milliseconds, e.g. because the process hangs. The replica then stops, closes the
+ * journal file and emits primaryLost(); the caller promotes itself by loading tasks()
+ * into its model and opening the journal file as its audit log.
+ *
+ * Lag and apply throughput are published in Metrics::Registry (replicationLag,
+ * replicationLagBytes, replicationEntries, replicationBytes).
+ *
+ * Example usage:
+ * @code
+ * StandbyReplica *replica = new StandbyReplica(this);
+ * replica->setJournalFile(standbyDir + "/history.log");
+ * connect(replica, &StandbyReplica::primaryLost, this, [=]() {
+ *     model->addTasks(replica->tasks());
+ *     auditLog->open(standbyDir + "/history.log");
+ * });
+ * replica->follow("taskmanager-journal");
+ * @endcode
+ */
+class StandbyReplica : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * @property state
+     * @brief Whether the replica waits for, follows or has replaced the primary
+     */
+    Q_PROPERTY(State state READ state NOTIFY stateChanged)
+
+    /**
+     * @property taskCount
+     * @brief Number of tasks in the replicated task list
+     */
+    Q_PROPERTY(int taskCount READ taskCount NOTIFY applied)
+
+    /**
+     * @property lagBytes
+     * @brief Bytes of the primary's log not applied yet, as of the last frame
+     */
+    Q_PROPERTY(qint64 lagBytes READ lagBytes NOTIFY applied)
+
+public:
+
+    /**
+     * @enum State
+     * @brief Life cycle of a replica
+     */
+    enum State
+    {
+        Idle,       ///< follow() was not called
+        Waiting,    ///< Connecting to the primary
+        Following,  ///< Receiving and applying the primary's log
+        TakenOver   ///< The primary died; the replica stopped
+    };
+    Q_ENUM(State)
+
+    /**
+     * @brief Default time without frames after which the primary is considered dead, in ms
+     *
+     * Heartbeats come every JournalShipper::HeartbeatIntervalMs, so this tolerates event
+     * loop stalls of the primary of most of a second while still taking over within one.
+     */
+    static constexpr int DefaultTakeoverTimeoutMs = 800;
+
+    /**
+     * @brief Interval between connection attempts while waiting, in ms
+     */
+    static constexpr int RetryIntervalMs = 100;
+
+    /**
+     * @brief Constructs an idle replica
+     * @param parent The parent QObject
+     */
+    explicit StandbyReplica(QObject *parent = nullptr);
+    ~StandbyReplica() override;
+
+    /**
+     * @brief Mirrors the received log to a file, replacing its content
+     * @param path Path of the file; once taken over it can be opened with AuditLog::open()
+     * @return true if the file could be opened
+     */
+    bool setJournalFile(const QString &path);
+
+    /**
+     * @brief Sets the time without frames after which the primary is considered dead
+     */
+    void setTakeoverTimeout(int milliseconds) { timeout = milliseconds; }
+
+    int takeoverTimeout() const { return timeout; }
+
+    /**
+     * @brief Starts following a primary
+     * @param name Name of the primary's socket, see JournalShipper::listen()
+     */
+    void follow(const QString &name);
+
+    State state() const { return current; }
+
+    /**
+     * @brief Gets the replicated task list in model order
+     */
+    QList<TaskRecord> tasks() const { return replay.snapshot(); }
+
+    int taskCount() const { return int(replay.size()); }
+
+    /**
+     * @brief Gets the received log
+     */
+    QByteArray journal() const { return log; }
+
+    /**
+     * @brief Gets the number of bytes of the log applied
+     */
+    qint64 appliedBytes() const { return decoded; }
+
+    /**
+     * @brief Gets the number of entries applied since the last Reset
+     */
+    qint64 appliedEntries() const { return entries; }
+
+    qint64 lagBytes() const { return qMax<qint64>(0, primarySize - decoded); }
+
+    /**
+     * @brief Gets how long it took to notice the primary's death, in ms
+     *
+     * Measured from the last frame received; -1 until taken over.
+     */
+    qint64 detectionTime() const { return detection; }
+
+signals:
+
+    /**
+     * @brief Emitted when state changes
+     */
+    void stateChanged();
+
+    /**
+     * @brief Emitted after the entries of a received chunk were applied
+     */
+    void applied();
+
+    /**
+     * @brief Emitted once when the primary is considered dead; the replica has stopped
+     */
+    void primaryLost();
+
+private:
+
+    QLocalSocket *socket;               ///< Connection to the primary
+    QString serverName;                 ///< Name of the primary's socket
+    State current = Idle;               ///< Life cycle state
+    QByteArray received;                ///< Bytes not forming a whole frame yet
+    QByteArray log;                     ///< Copy of the primary's log
+    qint64 decoded = 0;                 ///< Bytes of log applied
+    qint64 entries = 0;                 ///< Entries applied
+    qint64 primarySize = 0;             ///< Primary's log size as of the last frame
+    TaskHistory::ReplayState replay;    ///< Replicated task list
+    QFile mirror;                       ///< Journal file, if set
+    QTimer retryTimer;                  ///< Connection attempts while waiting
+    QTimer watchdog;                    ///< Fires when the primary goes silent
+    QElapsedTimer silence;              ///< Time since the last frame
+    int timeout = DefaultTakeoverTimeoutMs; ///< Watchdog interval
+    qint64 detection = -1;              ///< See detectionTime()
+
+    void setState(State state);
+    void connectToPrimary();
+    void receive();
+    bool handle(const JournalFrame &frame);
+    void takeOver();
+};
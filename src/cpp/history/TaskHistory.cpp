@@ -0,0 +1,330 @@
+#include "TaskHistory.h"
+#include "Metrics.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <limits>
+
+void TaskHistory::ReplayState::load(const QList<TaskRecord> &records)
+{
+    tasks = records;
+    rows.clear();
+    vacated.clear();
+    rows.reserve(records.size());
+    for (qsizetype row = 0; row < records.size(); ++row)
+        rows.insert(records.at(row).getId(), row);
+}
+
+QList<TaskRecord> TaskHistory::ReplayState::snapshot() const
+{
+    if (rows.size() == tasks.size())
+        return tasks;
+
+    QList<TaskRecord> live;
+    live.reserve(rows.size());
+    for (const TaskRecord &record : tasks)
+    {
+        if (!record.isNull())
+            live.append(record);
+    }
+    return live;
+}
+
+void TaskHistory::ReplayState::apply(const AuditEntry &entry)
+{
+    if (entry.field == AuditLog::Cleared)
+    {
+        tasks.clear();
+        rows.clear();
+        vacated.clear();
+        return;
+    }
+
+    if (entry.field == AuditLog::Restored)
+    {
+        // A task restored in place takes its old row back if this replay saw it removed.
+        const qsizetype row = entry.appended || rows.contains(entry.taskId) ? -1 : vacated.value(entry.taskId, -1);
+        vacated.remove(entry.taskId);
+        if (row >= 0 && row < tasks.size() && tasks.at(row).isNull())
+        {
+            tasks[row] = entry.value.value<TaskRecord>();
+            rows.insert(entry.taskId, row);
+            return;
+        }
+    }
+
+    if (entry.field == AuditLog::Created || entry.field == AuditLog::Restored)
+    {
+        const auto it = rows.constFind(entry.taskId);
+        if (it != rows.constEnd())
+            tasks[*it] = entry.value.value<TaskRecord>();
+        else
+        {
+            rows.insert(entry.taskId, tasks.size());
+            tasks.append(entry.value.value<TaskRecord>());
+        }
+        return;
+    }
+
+    const auto it = rows.constFind(entry.taskId);
+    if (it == rows.constEnd())
+        return;
+    const qsizetype row = *it;
+    const TaskRecord &task = tasks.at(row);
+
+    QString title = task.getTitle();
+    QString description = task.getDescription();
+    int priority = task.getPriority();
+    bool completed = task.getCompleted();
+    QDateTime completedAt = task.getCompletedAt();
+    QString assignee = task.getAssignee();
+    int estimate = task.getEstimate();
+    QList<quint64> dependencies = task.getDependencies();
+
+    switch (entry.field)
+    {
+    case AuditLog::Title:
+        title = entry.value.toString();
+        break;
+    case AuditLog::Description:
+        description.replace(entry.position, entry.removed, entry.value.toString());
+        break;
+    case AuditLog::Completed:
+        completed = entry.value.toBool();
+        completedAt = entry.completedAt;
+        break;
+    case AuditLog::Priority:
+        priority = entry.value.toInt();
+        break;
+    case AuditLog::Assignee:
+        assignee = entry.value.toString();
+        break;
+    case AuditLog::Estimate:
+        estimate = entry.value.toInt();
+        break;
+    case AuditLog::Dependencies:
+        dependencies = entry.value.value<QList<quint64>>();
+        break;
+    case AuditLog::Removed:
+        tasks[row] = TaskRecord();
+        rows.remove(entry.taskId);
+        vacated.insert(entry.taskId, row);
+        return;
+    default:
+        return;
+    }
+    tasks[row] = TaskRecord(title, description, priority, completed, task.getDateTime(), task.getId())
+                     .withCompletedAt(completedAt)
+                     .withAssignee(assignee)
+                     .withEstimate(estimate)
+                     .withDependencies(dependencies);
+}
+
+namespace
+{
+
+/**
+ * Replays consecutive pieces of a log, taking intermediate checkpoints on the way.
+ */
+struct Replay
+{
+    TaskHistory::ReplayState state;          ///< Task list after the applied entries
+    TaskHistory::Checkpoint current;         ///< Position of the last applied entry
+    QList<TaskHistory::Checkpoint> result;   ///< Intermediate checkpoints taken so far
+    qint64 until = 0;                        ///< Last timestamp to apply
+    int interval = 0;                        ///< Minimum entries between checkpoints; 0 for none
+    qint64 applied = 0;                      ///< Entries applied since the last checkpoint
+    bool stopped = false;                    ///< Whether an entry newer than until was reached
+
+    Replay(const TaskHistory::Checkpoint &from, qint64 limit, int checkpointInterval)
+        : until(limit), interval(checkpointInterval)
+    {
+        state.load(from.tasks);
+        current.offset = from.offset;
+        current.timestamp = from.timestamp;
+    }
+
+    /**
+     * Applies the entries of bytes, which hold the log from offset origin on, starting at
+     * the current offset. Returns the log offset after the last applied entry.
+     */
+    qint64 feed(const QByteArray &bytes, qint64 origin)
+    {
+        qint64 offset = current.offset - origin;
+        AuditEntry entry;
+        while (true)
+        {
+            qint64 next = offset;
+            if (!AuditLog::decode(bytes, next, entry))
+                break;
+            const qint64 timestamp = entry.timestamp.toMSecsSinceEpoch();
+            if (timestamp > until)
+            {
+                stopped = true;
+                break;
+            }
+
+            state.apply(entry);
+            offset = next;
+            current.offset = origin + offset;
+            current.timestamp = timestamp;
+            ++applied;
+
+            if (interval > 0 && applied >= qMax<qsizetype>(interval, state.size()))
+            {
+                current.tasks = state.snapshot();
+                result.append(current);
+                applied = 0;
+            }
+        }
+        return current.offset;
+    }
+
+    QList<TaskHistory::Checkpoint> finish()
+    {
+        current.tasks = state.snapshot();
+        result.append(current);
+        return result;
+    }
+};
+
+}
+
+TaskHistory::TaskHistory(AuditLog *auditLog, QObject *parent)
+    : QObject(parent), log(auditLog)
+{
+    if (!log)
+        return;
+
+    sinceCheckpoint = log->entryCount();
+    connect(log, &AuditLog::entryRecorded, this, [this]() {
+        ++sinceCheckpoint;
+        maybeCheckpoint();
+    });
+    connect(log, &AuditLog::reloaded, this, [this]() {
+        ++generation;
+        checkpoints.clear();
+        sinceCheckpoint = log->entryCount();
+        emit checkpointsChanged();
+        maybeCheckpoint();
+    });
+    maybeCheckpoint();
+}
+
+void TaskHistory::setCheckpointInterval(int entries)
+{
+    interval = qMax(1, entries);
+    maybeCheckpoint();
+}
+
+void TaskHistory::maybeCheckpoint()
+{
+    const qsizetype threshold = qMax<qsizetype>(interval, checkpoints.isEmpty() ? 0 : checkpoints.constLast().tasks.size());
+    if (checkpointing || !log || sinceCheckpoint < threshold)
+        return;
+
+    checkpointing = true;
+    sinceCheckpoint = 0;
+
+    const Checkpoint base = checkpoints.isEmpty() ? Checkpoint() : checkpoints.constLast();
+    const AuditLog::View view = log->view();
+    const int jobInterval = interval;
+    const int jobGeneration = generation;
+    QtConcurrent::run([base, view, jobInterval]() {
+        return replay(base, view, std::numeric_limits<qint64>::max(), jobInterval);
+    }).then(this, [this, jobGeneration](const QList<Checkpoint> &result) {
+        checkpointing = false;
+        if (jobGeneration == generation)
+        {
+            for (const Checkpoint &checkpoint : result)
+            {
+                if (checkpoints.isEmpty() || checkpoint.offset > checkpoints.constLast().offset)
+                    checkpoints.append(checkpoint);
+            }
+            emit checkpointsChanged();
+        }
+        maybeCheckpoint();
+    });
+}
+
+qint64 TaskHistory::checkpointSize() const
+{
+    qint64 bytes = 0;
+    for (const Checkpoint &checkpoint : checkpoints)
+        bytes += qint64(sizeof(Checkpoint)) + qint64(checkpoint.tasks.capacity()) * qint64(sizeof(TaskRecord));
+    return bytes;
+}
+
+qint64 TaskHistory::releaseCheckpoints()
+{
+    const qint64 bytes = checkpointSize();
+    checkpoints = QList<Checkpoint>();
+    emit checkpointsChanged();
+    return bytes;
+}
+
+QFuture<QList<TaskRecord>> TaskHistory::stateAt(const QDateTime &time) const
+{
+    const qint64 until = time.isValid() ? time.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+
+    // Latest checkpoint at or before the requested time
+    Checkpoint base;
+    const auto it = std::upper_bound(checkpoints.cbegin(), checkpoints.cend(), until,
+                                     [](qint64 value, const Checkpoint &checkpoint) { return value < checkpoint.timestamp; });
+    if (it != checkpoints.cbegin())
+        base = *std::prev(it);
+
+    const AuditLog::View view = log ? log->view() : AuditLog::View();
+    return QtConcurrent::run([base, view, until]() {
+        return replay(base, view, until).constLast().tasks;
+    });
+}
+
+QList<TaskHistory::Checkpoint> TaskHistory::replay(const Checkpoint &from, const QByteArray &log, qint64 until,
+                                                   int checkpointInterval)
+{
+    Metrics::ScopedTimer timer(Metrics::registry().latency[Metrics::HistoryReplay]);
+    Replay run(from, until, checkpointInterval);
+    run.feed(log, 0);
+    return run.finish();
+}
+
+QList<TaskHistory::Checkpoint> TaskHistory::replay(const Checkpoint &from, const AuditLog::View &log, qint64 until,
+                                                   int checkpointInterval)
+{
+    Metrics::ScopedTimer timer(Metrics::registry().latency[Metrics::HistoryReplay]);
+    Replay run(from, until, checkpointInterval);
+    if (from.offset >= log.persisted)
+    {
+        run.feed(log.tail, log.persisted);
+        return run.finish();
+    }
+
+    QFile file(log.path);
+    const qint64 length = log.persisted - from.offset;
+    uchar *mapped = file.open(QIODevice::ReadOnly) ? file.map(from.offset, length) : nullptr;
+    if (!mapped)
+    {
+        qWarning() << "TaskHistory::replay: cannot map" << log.path << file.errorString();
+        return run.finish();
+    }
+
+    const QByteArray written = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), length);
+    const qint64 reached = run.feed(written, from.offset);
+    if (!run.stopped)
+    {
+        // An entry cut short by a partial write continues in the tail.
+        const qint64 used = reached - from.offset;
+        QByteArray rest(written.constData() + used, length - used);
+        rest.append(log.tail);
+        file.unmap(mapped);
+        run.feed(rest, reached);
+    }
+    else
+        file.unmap(mapped);
+    return run.finish();
+}
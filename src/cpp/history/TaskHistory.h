@@ -0,0 +1,201 @@
+#pragma once
+
+#include <QDateTime>
+#include <QFuture>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include "AuditLog.h"
+#include "TaskRecord.h"
+
+
+/**
+ * @file TaskHistory.h
+ * @brief Reconstruction of past task lists from the audit log
+ */
+
+/**
+ * @class TaskHistory
+ * @brief Answers "what did the task list look like at time T" from an AuditLog
+ *
+ * The audit log is an event source: replaying its entries from the start reproduces
+ * every state the task list has been in. To keep queries fast on long logs, TaskHistory
+ * takes periodic checkpoints of the replayed task list. A query starts from the latest
+ * checkpoint at or before the requested time and replays only the entries after it.
+ *
+ * Checkpoints are built on a worker thread by replaying the log from the previous
+ * checkpoint, so the live model is never blocked. Workers read the written part of the
+ * log from its file, see AuditLog::view(), instead of a copy of the whole log. A new checkpoint is taken after
+ * checkpointInterval() entries, or after as many entries as the checkpointed list has
+ * tasks if that is larger; checkpoints share their unchanged TaskRecord values, so their
+ * memory stays proportional to the log size.
+ *
+ * Entries are assumed to be recorded in timestamp order; replay stops at the first entry
+ * newer than the requested time.
+ *
+ * Example usage:
+ * @code
+ * TaskHistory history(audit);
+ * QFuture<QList<TaskRecord>> future = history.stateAt(QDateTime::fromString("2026-10-13T10:00:00", Qt::ISODate));
+ * future.then(this, [](const QList<TaskRecord> &tasks) { qDebug() << tasks.size(); });
+ * @endcode
+ */
+class TaskHistory : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * @property checkpointCount
+     * @brief Number of checkpoints taken so far
+     */
+    Q_PROPERTY(int checkpointCount READ checkpointCount NOTIFY checkpointsChanged)
+
+public:
+
+    /**
+     * @struct Checkpoint
+     * @brief Replayed task list at a position of the log
+     */
+    struct Checkpoint
+    {
+        qint64 offset = 0;       ///< Log offset right after the last applied entry
+        qint64 timestamp = 0;    ///< Timestamp (ms since epoch) of the last applied entry
+        QList<TaskRecord> tasks; ///< Task list after the last applied entry, in model order
+    };
+
+    /**
+     * @class ReplayState
+     * @brief Task list rebuilt by applying audit entries one at a time
+     *
+     * Removed tasks leave a null record behind so the rows of the remaining tasks stay
+     * valid; they are skipped when taking a snapshot. A task restored in place gets its
+     * row back, unless it was removed before the state was loaded; then it is appended.
+     * Applying an entry is O(1) apart from description edits, which are O(length of the
+     * description).
+     */
+    class ReplayState
+    {
+    public:
+        /**
+         * @brief Starts from a task list, e.g. a checkpoint's
+         */
+        void load(const QList<TaskRecord> &records);
+
+        /**
+         * @brief Applies one entry of the log
+         */
+        void apply(const AuditEntry &entry);
+
+        /**
+         * @brief Gets the current task list in model order
+         */
+        QList<TaskRecord> snapshot() const;
+
+        /**
+         * @brief Gets the number of live tasks
+         */
+        qsizetype size() const { return rows.size(); }
+
+    private:
+        QList<TaskRecord> tasks;          ///< Tasks by row, null where removed
+        QHash<quint64, qsizetype> rows;   ///< Row of each live task
+        QHash<quint64, qsizetype> vacated; ///< Former row of each removed task
+    };
+
+    /**
+     * @brief Default minimum number of entries between two checkpoints
+     */
+    static constexpr int DefaultCheckpointInterval = 4096;
+
+    /**
+     * @brief Constructs a history over the given audit log
+     * @param log The audit log to replay; checkpoints are maintained as it grows
+     * @param parent The parent QObject
+     */
+    explicit TaskHistory(AuditLog *log, QObject *parent = nullptr);
+
+    /**
+     * @brief Gets the minimum number of entries between two checkpoints
+     */
+    int checkpointInterval() const { return interval; }
+
+    /**
+     * @brief Sets the minimum number of entries between two checkpoints
+     */
+    void setCheckpointInterval(int entries);
+
+    /**
+     * @brief Gets the number of checkpoints taken so far
+     */
+    int checkpointCount() const { return checkpoints.size(); }
+
+    /**
+     * @brief Gets the approximate memory held by checkpoints, in bytes
+     *
+     * Task values shared with the live model or other checkpoints are not counted.
+     */
+    qint64 checkpointSize() const;
+
+    /**
+     * @brief Drops all checkpoints to give memory back
+     * @return Approximate number of bytes released
+     *
+     * Queries replay from the start of the log until new checkpoints have been taken.
+     */
+    qint64 releaseCheckpoints();
+
+    /**
+     * @brief Reconstructs the task list at a point in time
+     * @param time The point in time; an invalid time means now
+     * @return Future of the task list, in model order, computed on a worker thread
+     */
+    QFuture<QList<TaskRecord>> stateAt(const QDateTime &time) const;
+
+    /**
+     * @brief Replays a range of an encoded log
+     * @param from State to start from
+     * @param log The encoded log, see AuditLog::data()
+     * @param until Last timestamp (ms since epoch) to apply
+     * @param checkpointInterval Minimum entries between intermediate checkpoints; 0 for none
+     * @return Intermediate checkpoints followed by the final state
+     *
+     * Pure function, safe to call on any thread.
+     */
+    static QList<Checkpoint> replay(const Checkpoint &from, const QByteArray &log, qint64 until,
+                                    int checkpointInterval = 0);
+
+    /**
+     * @brief Replays a range of a log through a view of it
+     * @param from State to start from
+     * @param log The log, see AuditLog::view()
+     * @param until Last timestamp (ms since epoch) to apply
+     * @param checkpointInterval Minimum entries between intermediate checkpoints; 0 for none
+     * @return Intermediate checkpoints followed by the final state
+     *
+     * The written entries after the starting state are mapped read-only from the log
+     * file rather than read into memory. Safe to call on any thread.
+     */
+    static QList<Checkpoint> replay(const Checkpoint &from, const AuditLog::View &log, qint64 until,
+                                    int checkpointInterval = 0);
+
+signals:
+
+    /**
+     * @brief Emitted when checkpoints were added or discarded
+     */
+    void checkpointsChanged();
+
+private:
+
+    QPointer<AuditLog> log;         ///< Replayed audit log
+    QList<Checkpoint> checkpoints;  ///< Checkpoints in log order
+    int interval = DefaultCheckpointInterval; ///< Minimum entries between checkpoints
+    int sinceCheckpoint = 0;        ///< Entries recorded since the last checkpoint job was started
+    bool checkpointing = false;     ///< Whether a checkpoint job is running
+    int generation = 0;             ///< Incremented when the log is reloaded, to drop stale jobs
+
+    /**
+     * @brief Starts a checkpoint job if enough entries were recorded and none is running
+     */
+    void maybeCheckpoint();
+};
@@ -0,0 +1,34 @@
+#include "InputRecorder.h"
+
+InputRecorder::InputRecorder(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void InputRecorder::attach(QWindow *window)
+{
+    detach();
+    current = InputRecording();
+    target = window;
+    if (!target)
+        return;
+
+    current.windowSize = target->size();
+    clock.start();
+    target->installEventFilter(this);
+}
+
+void InputRecorder::detach()
+{
+    if (target)
+        target->removeEventFilter(this);
+    target = nullptr;
+}
+
+bool InputRecorder::eventFilter(QObject *watched, QEvent *event)
+{
+    InputEvent input;
+    if (watched == target && InputEvent::capture(event, clock.elapsed(), input))
+        current.events.append(input);
+    return QObject::eventFilter(watched, event);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QWindow>
+
+#include "InputRecording.h"
+
+
+/**
+ * @file InputRecorder.h
+ * @brief Records the input events delivered to a window
+ */
+
+/**
+ * @class InputRecorder
+ * @brief Captures clicks, drags, wheel scrolls and key presses of a window with timestamps
+ *
+ * Installs an event filter on the window; events are only observed, never consumed. The
+ * recording can be replayed with InputReplayer.
+ *
+ * Example usage:
+ * @code
+ * InputRecorder recorder;
+ * recorder.attach(window);
+ * // ... interact with the window ...
+ * recorder.recording().save("session.json");
+ * @endcode
+ */
+class InputRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InputRecorder(QObject *parent = nullptr);
+
+    /**
+     * @brief Starts a new recording of the window's input
+     * @param window The window to record; the previous window is detached
+     */
+    void attach(QWindow *window);
+
+    /**
+     * @brief Stops recording
+     */
+    void detach();
+
+    /**
+     * @brief Gets the events recorded so far
+     */
+    const InputRecording &recording() const { return current; }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    QPointer<QWindow> target;  ///< Window being recorded
+    QElapsedTimer clock;       ///< Time since attach()
+    InputRecording current;    ///< Events recorded so far
+};
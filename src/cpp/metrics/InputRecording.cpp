@@ -0,0 +1,240 @@
+#include "InputRecording.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QSaveFile>
+#include <QWheelEvent>
+#include <QWindow>
+
+#include <algorithm>
+
+namespace
+{
+
+const char *const TypeNames[] = {"press", "release", "doubleclick", "move", "wheel", "keypress", "keyrelease"};
+
+bool isMouse(InputEvent::Type type)
+{
+    return type == InputEvent::Press || type == InputEvent::Release || type == InputEvent::DoubleClick
+           || type == InputEvent::Move;
+}
+
+}
+
+bool InputEvent::capture(const QEvent *event, qint64 time, InputEvent &result)
+{
+    result = InputEvent();
+    result.time = time;
+
+    switch (event->type())
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    {
+        const auto *mouse = static_cast<const QMouseEvent *>(event);
+        // Hover moves do not drive the UI under test; only drags are recorded.
+        if (event->type() == QEvent::MouseMove && mouse->buttons() == Qt::NoButton)
+            return false;
+
+        result.type = event->type() == QEvent::MouseButtonPress     ? Press
+                      : event->type() == QEvent::MouseButtonRelease ? Release
+                      : event->type() == QEvent::MouseButtonDblClick ? DoubleClick
+                                                                     : Move;
+        result.position = mouse->position();
+        result.button = mouse->button();
+        result.buttons = mouse->buttons();
+        result.modifiers = mouse->modifiers();
+        return true;
+    }
+    case QEvent::Wheel:
+    {
+        const auto *wheel = static_cast<const QWheelEvent *>(event);
+        result.type = Wheel;
+        result.position = wheel->position();
+        result.buttons = wheel->buttons();
+        result.modifiers = wheel->modifiers();
+        result.angleDelta = wheel->angleDelta();
+        result.pixelDelta = wheel->pixelDelta();
+        result.phase = wheel->phase();
+        return true;
+    }
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    {
+        const auto *key = static_cast<const QKeyEvent *>(event);
+        result.type = event->type() == QEvent::KeyPress ? KeyPress : KeyRelease;
+        result.key = key->key();
+        result.text = key->text();
+        result.modifiers = key->modifiers();
+        result.autoRepeat = key->isAutoRepeat();
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+std::unique_ptr<QEvent> InputEvent::create(QWindow *window, ulong timestamp) const
+{
+    const QPointF global = window ? window->mapToGlobal(position) : position;
+    std::unique_ptr<QInputEvent> event;
+
+    switch (type)
+    {
+    case Press:
+    case Release:
+    case DoubleClick:
+    case Move:
+    {
+        const QEvent::Type eventType = type == Press     ? QEvent::MouseButtonPress
+                                       : type == Release ? QEvent::MouseButtonRelease
+                                       : type == DoubleClick ? QEvent::MouseButtonDblClick
+                                                             : QEvent::MouseMove;
+        event = std::make_unique<QMouseEvent>(eventType, position, global, button, buttons, modifiers);
+        break;
+    }
+    case Wheel:
+        event = std::make_unique<QWheelEvent>(position, global, pixelDelta, angleDelta, buttons, modifiers, phase, false);
+        break;
+    case KeyPress:
+    case KeyRelease:
+        event = std::make_unique<QKeyEvent>(type == KeyPress ? QEvent::KeyPress : QEvent::KeyRelease, key, modifiers,
+                                            text, autoRepeat);
+        break;
+    }
+
+    event->setTimestamp(timestamp);
+    return event;
+}
+
+QJsonObject InputEvent::toJson() const
+{
+    QJsonObject object;
+    object["t"] = time;
+    object["type"] = TypeNames[type];
+    if (modifiers != Qt::NoModifier)
+        object["modifiers"] = int(modifiers.toInt());
+
+    if (isMouse(type) || type == Wheel)
+    {
+        object["x"] = position.x();
+        object["y"] = position.y();
+        if (button != Qt::NoButton)
+            object["button"] = int(button);
+        if (buttons != Qt::NoButton)
+            object["buttons"] = int(buttons.toInt());
+    }
+    if (type == Wheel)
+    {
+        object["dx"] = angleDelta.x();
+        object["dy"] = angleDelta.y();
+        if (!pixelDelta.isNull())
+        {
+            object["px"] = pixelDelta.x();
+            object["py"] = pixelDelta.y();
+        }
+        if (phase != Qt::NoScrollPhase)
+            object["phase"] = int(phase);
+    }
+    if (type == KeyPress || type == KeyRelease)
+    {
+        object["key"] = key;
+        if (!text.isEmpty())
+            object["text"] = text;
+        if (autoRepeat)
+            object["repeat"] = true;
+    }
+    return object;
+}
+
+bool InputEvent::fromJson(const QJsonObject &object, InputEvent &result)
+{
+    result = InputEvent();
+    const QString name = object["type"].toString();
+    const auto begin = std::begin(TypeNames);
+    const auto found = std::find_if(begin, std::end(TypeNames), [&name](const char *type) { return name == QLatin1String(type); });
+    if (found == std::end(TypeNames) || !object["t"].isDouble())
+        return false;
+
+    result.type = Type(found - begin);
+    result.time = qint64(object["t"].toDouble());
+    result.modifiers = Qt::KeyboardModifiers::fromInt(object["modifiers"].toInt());
+    result.position = QPointF(object["x"].toDouble(), object["y"].toDouble());
+    result.button = Qt::MouseButton(object["button"].toInt());
+    result.buttons = Qt::MouseButtons::fromInt(object["buttons"].toInt());
+    result.angleDelta = QPoint(object["dx"].toInt(), object["dy"].toInt());
+    result.pixelDelta = QPoint(object["px"].toInt(), object["py"].toInt());
+    result.phase = Qt::ScrollPhase(object["phase"].toInt());
+    result.key = object["key"].toInt();
+    result.text = object["text"].toString();
+    result.autoRepeat = object["repeat"].toBool();
+
+    // A press or release without a button would not be delivered to any item.
+    if ((result.type == Press || result.type == Release || result.type == DoubleClick) && result.button == Qt::NoButton)
+        result.button = Qt::LeftButton;
+    return true;
+}
+
+bool InputRecording::save(const QString &path) const
+{
+    QJsonArray array;
+    for (const InputEvent &event : events)
+        array.append(event.toJson());
+
+    QJsonObject root;
+    root["format"] = "taskmanager-input";
+    root["version"] = Version;
+    root["width"] = windowSize.width();
+    root["height"] = windowSize.height();
+    root["events"] = array;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson());
+    return file.commit();
+}
+
+InputRecording InputRecording::load(const QString &path, QString *error)
+{
+    InputRecording recording;
+    auto fail = [error](const QString &reason) {
+        if (error)
+            *error = reason;
+        return InputRecording();
+    };
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail(file.errorString());
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isObject())
+        return fail(parseError.errorString());
+
+    const QJsonObject root = document.object();
+    if (root["format"].toString() != QLatin1String("taskmanager-input") || root["version"].toInt() > Version)
+        return fail(QStringLiteral("not a supported input recording"));
+
+    recording.windowSize = QSize(root["width"].toInt(), root["height"].toInt());
+    const QJsonArray array = root["events"].toArray();
+    recording.events.reserve(array.size());
+    for (const QJsonValue &value : array)
+    {
+        InputEvent event;
+        if (!InputEvent::fromJson(value.toObject(), event))
+            return fail(QStringLiteral("invalid event %1").arg(recording.events.size()));
+        recording.events.append(event);
+    }
+
+    // Replay relies on time order.
+    std::stable_sort(recording.events.begin(), recording.events.end(),
+                     [](const InputEvent &a, const InputEvent &b) { return a.time < b.time; });
+    return recording;
+}
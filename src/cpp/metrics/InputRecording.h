@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QEvent>
+#include <QJsonObject>
+#include <QList>
+#include <QPointF>
+#include <QSize>
+#include <QString>
+
+#include <memory>
+
+class QWindow;
+
+
+/**
+ * @file InputRecording.h
+ * @brief Recorded window input events and their JSON file format
+ */
+
+/**
+ * @struct InputEvent
+ * @brief One recorded mouse, wheel or key event
+ *
+ * Positions are in window coordinates, times in milliseconds since the recording started.
+ * Only the fields relevant to the event's type are meaningful.
+ */
+struct InputEvent
+{
+    /**
+     * @enum Type
+     * @brief Kind of event
+     */
+    enum Type
+    {
+        Press,
+        Release,
+        DoubleClick,
+        Move,
+        Wheel,
+        KeyPress,
+        KeyRelease
+    };
+
+    Type type = Press;                            ///< Kind of event
+    qint64 time = 0;                              ///< Milliseconds since the recording started
+    QPointF position;                             ///< Mouse/wheel position in window coordinates
+    Qt::MouseButton button = Qt::NoButton;        ///< Button that caused a press/release
+    Qt::MouseButtons buttons = Qt::NoButton;      ///< Buttons held during the event
+    Qt::KeyboardModifiers modifiers = Qt::NoModifier; ///< Modifiers held during the event
+    QPoint angleDelta;                            ///< Wheel rotation in eighths of a degree
+    QPoint pixelDelta;                            ///< Wheel scroll distance from touchpads
+    Qt::ScrollPhase phase = Qt::NoScrollPhase;    ///< Wheel scroll phase (touchpad flicks)
+    int key = 0;                                  ///< Qt::Key of a key event
+    QString text;                                 ///< Text of a key event
+    bool autoRepeat = false;                      ///< Whether a key press is auto-repeated
+
+    /**
+     * @brief Captures an event delivered to a window
+     * @param event The event
+     * @param time Milliseconds since the recording started
+     * @param[out] result The captured event
+     * @return true if the event is of a recorded kind
+     */
+    static bool capture(const QEvent *event, qint64 time, InputEvent &result);
+
+    /**
+     * @brief Creates a Qt event that reproduces this event
+     * @param window The window the event will be sent to, for global positions
+     * @param timestamp Event timestamp in milliseconds; Qt Quick derives flick velocities from it
+     */
+    std::unique_ptr<QEvent> create(QWindow *window, ulong timestamp) const;
+
+    QJsonObject toJson() const;
+    static bool fromJson(const QJsonObject &object, InputEvent &result);
+};
+
+/**
+ * @struct InputRecording
+ * @brief Input events recorded on one window
+ *
+ * Stored as a JSON document:
+ * @code
+ * { "format": "taskmanager-input", "version": 1, "width": 800, "height": 600,
+ *   "events": [ { "t": 120, "type": "wheel", "x": 400, "y": 300, "dy": -120 }, ... ] }
+ * @endcode
+ */
+struct InputRecording
+{
+    static constexpr int Version = 1;
+
+    QSize windowSize;          ///< Window size during recording
+    QList<InputEvent> events;  ///< Events in time order
+
+    /**
+     * @brief Gets the time of the last event in milliseconds
+     */
+    qint64 duration() const { return events.isEmpty() ? 0 : events.constLast().time; }
+
+    /**
+     * @brief Writes the recording to a file
+     * @return true if the file was written
+     */
+    bool save(const QString &path) const;
+
+    /**
+     * @brief Reads a recording from a file
+     * @param path The file to read
+     * @param[out] error Reason of a failure, if not null
+     * @return The recording; empty if the file could not be read
+     */
+    static InputRecording load(const QString &path, QString *error = nullptr);
+};
@@ -0,0 +1,226 @@
+#include "InputReplayer.h"
+
+#include <QCoreApplication>
+#include <QRandomGenerator>
+#include <QTimeZone>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace
+{
+
+const char *const Verbs[] = {"Review", "Write", "Fix", "Plan", "Update", "Test", "Refactor", "Document", "Call", "Prepare"};
+const char *const Objects[] = {"release notes", "login flow", "budget", "onboarding guide", "search index", "dashboard",
+                               "meeting agenda", "unit tests", "backup script", "design mockups", "invoice", "roadmap"};
+const char *const Words[] = {"before", "the", "next", "sprint", "check", "with", "team", "about", "edge", "cases",
+                             "and", "update", "status", "in", "tracker", "once", "done", "follow", "up", "later"};
+
+// Event timestamp of time 0; any fixed value keeps replays reproducible.
+constexpr ulong BaseTimestamp = 1000000;
+
+}
+
+QJsonObject FrameReport::toJson() const
+{
+    QJsonObject object;
+    object["events"] = events;
+    object["durationMs"] = durationMs;
+    object["frames"] = frames;
+    object["p50Ms"] = p50Ms;
+    object["p90Ms"] = p90Ms;
+    object["p99Ms"] = p99Ms;
+    object["maxMs"] = maxMs;
+    object["delegatesCreated"] = delegatesCreated;
+    object["delegatesDestroyed"] = delegatesDestroyed;
+    return object;
+}
+
+double FrameReport::percentile(const QList<double> &sorted, double fraction)
+{
+    if (sorted.isEmpty())
+        return 0;
+    const qsizetype rank = qsizetype(std::ceil(fraction * double(sorted.size())));
+    return sorted.at(qBound<qsizetype>(0, rank - 1, sorted.size() - 1));
+}
+
+InputReplayer::InputReplayer(QQuickWindow *quickWindow, QObject *parent)
+    : QObject(parent), window(quickWindow)
+{
+    stepTimer.setSingleShot(true);
+    stepTimer.setTimerType(Qt::PreciseTimer);
+    connect(&stepTimer, &QTimer::timeout, this, &InputReplayer::step);
+}
+
+void InputReplayer::start()
+{
+    if (running || !window)
+        return;
+
+    if (input.windowSize.isValid())
+        window->resize(input.windowSize);
+
+    running = true;
+    next = 0;
+    created = 0;
+    destroyed = 0;
+    delegates.clear();
+    {
+        QMutexLocker locker(&frameMutex);
+        frameTimes.clear();
+        frameStart.invalidate();
+    }
+    scanDelegates(false);
+
+    // Frame signals come from the render thread with the threaded render loop.
+    connections.append(connect(window, &QQuickWindow::beforeFrameBegin, this, [this]() {
+        QMutexLocker locker(&frameMutex);
+        frameStart.start();
+    }, Qt::DirectConnection));
+    connections.append(connect(window, &QQuickWindow::afterFrameEnd, this, [this]() {
+        QMutexLocker locker(&frameMutex);
+        if (frameStart.isValid())
+            frameTimes.append(double(frameStart.nsecsElapsed()) / 1e6);
+        frameStart.invalidate();
+    }, Qt::DirectConnection));
+    connections.append(connect(window, &QQuickWindow::afterAnimating, this, [this]() { scanDelegates(true); }));
+
+    baseTimestamp = BaseTimestamp;
+    clock.start();
+    step();
+}
+
+void InputReplayer::step()
+{
+    if (!window || next >= input.events.size())
+    {
+        finish();
+        return;
+    }
+
+    const qint64 now = clock.elapsed();
+    while (next < input.events.size() && input.events.at(next).time <= now)
+    {
+        const InputEvent &event = input.events.at(next);
+        const std::unique_ptr<QEvent> qtEvent = event.create(window, baseTimestamp + ulong(event.time));
+        QCoreApplication::sendEvent(window, qtEvent.get());
+        ++next;
+        if (!window)
+            break;
+    }
+
+    // After the last event, keep measuring so animations such as flick deceleration end.
+    stepTimer.start(next < input.events.size() ? int(input.events.at(next).time - now) : settleMs);
+}
+
+void InputReplayer::finish()
+{
+    stepTimer.stop();
+    for (const QMetaObject::Connection &connection : std::as_const(connections))
+        disconnect(connection);
+    connections.clear();
+    if (window)
+        scanDelegates(true);
+
+    QList<double> times;
+    {
+        QMutexLocker locker(&frameMutex);
+        times = frameTimes;
+    }
+    std::sort(times.begin(), times.end());
+
+    result = FrameReport();
+    result.events = next;
+    result.durationMs = clock.elapsed();
+    result.frames = int(times.size());
+    result.p50Ms = FrameReport::percentile(times, 0.50);
+    result.p90Ms = FrameReport::percentile(times, 0.90);
+    result.p99Ms = FrameReport::percentile(times, 0.99);
+    result.maxMs = times.isEmpty() ? 0 : times.constLast();
+    result.delegatesCreated = created;
+    result.delegatesDestroyed = destroyed;
+
+    running = false;
+    emit finished(result);
+}
+
+void InputReplayer::scanDelegates(bool count)
+{
+    if (!window)
+        return;
+
+    QList<QQuickItem *> found;
+    collectDelegates(window->contentItem(), found);
+
+    // Drop destroyed delegates first: a new delegate may reuse a destroyed one's address.
+    for (auto it = delegates.begin(); it != delegates.end();)
+    {
+        if (it.value().isNull())
+        {
+            destroyed += count ? 1 : 0;
+            it = delegates.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (QQuickItem *item : std::as_const(found))
+    {
+        if (!delegates.contains(item))
+        {
+            delegates.insert(item, item);
+            created += count ? 1 : 0;
+        }
+    }
+}
+
+void InputReplayer::collectDelegates(QQuickItem *item, QList<QQuickItem *> &found) const
+{
+    if (!item)
+        return;
+
+    // QML types are named after their file, e.g. "TaskItem_QMLTYPE_12".
+    if (QByteArray(item->metaObject()->className()).startsWith(typePrefix))
+    {
+        found.append(item);
+        return;
+    }
+
+    const QList<QQuickItem *> children = item->childItems();
+    for (QQuickItem *child : children)
+        collectDelegates(child, found);
+}
+
+QList<TaskRecord> InputReplayer::seededTasks(quint32 seed, int count)
+{
+    QRandomGenerator random(seed);
+    // A fixed reference time, so dates (and their rendered text) do not depend on the day of the run.
+    const QDateTime reference(QDate(2024, 1, 1), QTime(9, 0), QTimeZone::UTC);
+
+    QList<TaskRecord> tasks;
+    tasks.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const QString title = QStringLiteral("%1 %2 #%3")
+                                  .arg(QLatin1String(Verbs[random.bounded(int(std::size(Verbs)))]),
+                                       QLatin1String(Objects[random.bounded(int(std::size(Objects)))]))
+                                  .arg(i);
+
+        // Roughly a third of the tasks have no description, the rest up to 40 words.
+        QStringList words;
+        const int wordCount = random.bounded(3) == 0 ? 0 : random.bounded(1, 41);
+        for (int w = 0; w < wordCount; ++w)
+            words.append(QLatin1String(Words[random.bounded(int(std::size(Words)))]));
+
+        const QDateTime createdAt = reference.addSecs(-qint64(random.bounded(365 * 24 * 60)) * 60);
+        const bool completed = random.bounded(10) < 3;
+        TaskRecord record(title, words.join(QLatin1Char(' ')), random.bounded(3), completed, createdAt);
+        if (completed)
+            record = std::move(record).withCompletedAt(createdAt.addSecs(qint64(random.bounded(30 * 24 * 60)) * 60));
+        tasks.append(record);
+    }
+    return tasks;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QTimer>
+
+#include "InputRecording.h"
+#include "TaskRecord.h"
+
+
+/**
+ * @file InputReplayer.h
+ * @brief Replays recorded input into a Qt Quick window and measures its frames
+ */
+
+/**
+ * @struct FrameReport
+ * @brief Frame times and delegate churn of one replay
+ */
+struct FrameReport
+{
+    int events = 0;              ///< Events replayed
+    qint64 durationMs = 0;       ///< Wall-clock time of the replay including the settle time
+    int frames = 0;              ///< Frames rendered
+    double p50Ms = 0;            ///< Median frame time
+    double p90Ms = 0;            ///< 90th percentile frame time
+    double p99Ms = 0;            ///< 99th percentile frame time
+    double maxMs = 0;            ///< Longest frame
+    int delegatesCreated = 0;    ///< Delegates instantiated during the replay
+    int delegatesDestroyed = 0;  ///< Delegates destroyed during the replay
+
+    QJsonObject toJson() const;
+
+    /**
+     * @brief Gets a nearest-rank percentile of sorted values
+     */
+    static double percentile(const QList<double> &sorted, double fraction);
+};
+
+/**
+ * @class InputReplayer
+ * @brief Injects an InputRecording into a QQuickWindow and reports frame statistics
+ *
+ * Events are sent to the window at their recorded times with their recorded timestamps,
+ * so flicks get the recorded velocities. A frame's time is measured from the start of the
+ * frame to its end (QQuickWindow::beforeFrameBegin() to afterFrameEnd()), i.e. the
+ * synchronization and rendering work of the frame rather than the display interval.
+ *
+ * Delegate churn is measured by tracking the items of the window whose QML type name
+ * starts with delegateType(): items that appear after the replay starts count as created,
+ * items that go away as destroyed.
+ *
+ * Combined with a seeded dataset (see seededTasks()) and an offscreen window using the
+ * software renderer, a replay is deterministic in its input and content, so the report can
+ * be compared across builds.
+ */
+class InputReplayer : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Default time to keep measuring after the last event, in milliseconds
+     */
+    static constexpr int DefaultSettleTime = 1000;
+
+    /**
+     * @brief Constructs a replayer for the given window
+     * @param window The window to inject events into
+     * @param parent The parent QObject
+     */
+    explicit InputReplayer(QQuickWindow *window, QObject *parent = nullptr);
+
+    void setRecording(const InputRecording &recording) { input = recording; }
+    const InputRecording &recording() const { return input; }
+
+    QByteArray delegateType() const { return typePrefix; }
+    void setDelegateType(const QByteArray &prefix) { typePrefix = prefix; }
+
+    int settleTime() const { return settleMs; }
+    void setSettleTime(int ms) { settleMs = qMax(0, ms); }
+
+    /**
+     * @brief Starts the replay; finished() is emitted when it is done
+     *
+     * The window is resized to the recorded window size.
+     */
+    void start();
+
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief Gets the report of the last finished replay
+     */
+    FrameReport report() const { return result; }
+
+    /**
+     * @brief Generates a reproducible task list
+     * @param seed Seed of the generator; equal seeds give equal tasks
+     * @param count Number of tasks
+     */
+    static QList<TaskRecord> seededTasks(quint32 seed, int count);
+
+signals:
+
+    /**
+     * @brief Emitted when the replay is done
+     */
+    void finished(const FrameReport &report);
+
+private:
+    QPointer<QQuickWindow> window;        ///< Window under test
+    InputRecording input;                 ///< Events to replay
+    QByteArray typePrefix = "TaskItem";   ///< Type name prefix of the delegates to track
+    int settleMs = DefaultSettleTime;     ///< Measuring time after the last event
+
+    bool running = false;                 ///< Whether a replay is in progress
+    int next = 0;                         ///< Index of the next event to send
+    ulong baseTimestamp = 0;              ///< Event timestamp of time 0
+    QElapsedTimer clock;                  ///< Time since start()
+    QTimer stepTimer;                     ///< Fires when the next event is due
+
+    QMutex frameMutex;                    ///< Guards frameStart and frameTimes (render thread)
+    QElapsedTimer frameStart;             ///< Start of the frame being rendered
+    QList<double> frameTimes;             ///< Frame times in milliseconds
+
+    QHash<QQuickItem *, QPointer<QQuickItem>> delegates; ///< Delegates seen alive
+    int created = 0;                      ///< Delegates created since start()
+    int destroyed = 0;                    ///< Delegates destroyed since start()
+    FrameReport result;                   ///< Report of the last finished replay
+
+    QList<QMetaObject::Connection> connections; ///< Window connections of a running replay
+
+    void step();
+    void finish();
+    void scanDelegates(bool count);
+    void collectDelegates(QQuickItem *item, QList<QQuickItem *> &found) const;
+};
+
+Q_DECLARE_METATYPE(FrameReport)
@@ -0,0 +1,207 @@
+#include "Metrics.h"
+
+#include <QElapsedTimer>
+
+namespace Metrics
+{
+
+namespace
+{
+
+const char *const MutationNames[MutationCount] = {"insert", "remove", "update", "description_edit"};
+const char *const OperationNames[OperationCount] = {"search", "bulk_insert", "bulk_remove", "policy_batch", "history_replay"};
+const char *const CacheNames[CacheCount] = {"record_snapshot", "flat_description", "search_arena"};
+const char *const PriorityNames[4] = {"low", "medium", "high", "other"};
+
+qint64 monotonicNs()
+{
+    static QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed();
+}
+
+QByteArray seconds(quint64 nanoseconds)
+{
+    return QByteArray::number(double(nanoseconds) / 1e9, 'g', 12);
+}
+
+void family(QByteArray &out, const char *name, const char *type, const char *help)
+{
+    out += "# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += "\n# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += '\n';
+}
+
+void sample(QByteArray &out, const char *name, const QByteArray &labels, const QByteArray &value)
+{
+    out += name;
+    if (!labels.isEmpty())
+    {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += value;
+    out += '\n';
+}
+
+void histogram(QByteArray &out, const char *name, const Histogram &histogram, const QByteArray &labels = QByteArray())
+{
+    const QByteArray prefix = labels.isEmpty() ? QByteArray() : labels + ',';
+    const QByteArray bucketName = QByteArray(name) + "_bucket";
+
+    // Read the buckets first: the count is then at least their sum, so a concurrent
+    // observation can never make +Inf smaller than a finite bucket.
+    quint64 cumulative = 0;
+    for (size_t i = 0; i < Histogram::BoundsNs.size(); ++i)
+    {
+        cumulative += histogram.bucket(int(i));
+        sample(out, bucketName.constData(), prefix + "le=\"" + seconds(quint64(Histogram::BoundsNs[i])) + '"',
+               QByteArray::number(cumulative));
+    }
+    cumulative += histogram.bucket(int(Histogram::BoundsNs.size()));
+    const quint64 count = qMax(cumulative, histogram.count());
+    sample(out, bucketName.constData(), prefix + "le=\"+Inf\"", QByteArray::number(count));
+    sample(out, (QByteArray(name) + "_sum").constData(), labels, seconds(histogram.sumNs()));
+    sample(out, (QByteArray(name) + "_count").constData(), labels, QByteArray::number(count));
+}
+
+}
+
+void Histogram::observe(qint64 nanoseconds)
+{
+    nanoseconds = qMax<qint64>(0, nanoseconds);
+    size_t index = 0;
+    while (index < BoundsNs.size() && nanoseconds > BoundsNs[index])
+        ++index;
+
+    buckets[index].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(quint64(nanoseconds), std::memory_order_relaxed);
+    observations.fetch_add(1, std::memory_order_relaxed);
+}
+
+Registry &Registry::instance()
+{
+    static Registry registry;
+    return registry;
+}
+
+QByteArray Registry::render() const
+{
+    QByteArray out;
+    out.reserve(16 * 1024);
+
+    family(out, "taskmanager_tasks", "gauge", "Number of tasks by status and priority.");
+    for (int completed = 0; completed < 2; ++completed)
+    {
+        for (int priority = 0; priority < 4; ++priority)
+        {
+            sample(out, "taskmanager_tasks",
+                   QByteArray("status=\"") + (completed ? "completed" : "pending") + "\",priority=\"" + PriorityNames[priority] + '"',
+                   QByteArray::number(tasks[size_t(completed)][size_t(priority)].value()));
+        }
+    }
+
+    family(out, "taskmanager_mutations", "counter", "Task mutations by kind.");
+    for (int kind = 0; kind < MutationCount; ++kind)
+    {
+        sample(out, "taskmanager_mutations_total", QByteArray("kind=\"") + MutationNames[kind] + '"',
+               QByteArray::number(mutations[size_t(kind)].value()));
+    }
+
+    family(out, "taskmanager_operation_duration_seconds", "histogram", "Duration of model operations.");
+    for (int operation = 0; operation < OperationCount; ++operation)
+    {
+        histogram(out, "taskmanager_operation_duration_seconds", latency[size_t(operation)],
+                  QByteArray("operation=\"") + OperationNames[operation] + '"');
+    }
+
+    family(out, "taskmanager_gui_stalls", "counter", "GUI event loop stalls.");
+    sample(out, "taskmanager_gui_stalls_total", QByteArray(), QByteArray::number(guiStalls.value()));
+
+    family(out, "taskmanager_gui_lag_seconds", "histogram", "Delay of GUI event loop heartbeats.");
+    histogram(out, "taskmanager_gui_lag_seconds", guiLag);
+
+    family(out, "taskmanager_cache_requests", "counter", "Cache lookups by cache and result.");
+    for (int cache = 0; cache < CacheCount; ++cache)
+    {
+        const QByteArray labels = QByteArray("cache=\"") + CacheNames[cache] + "\",result=";
+        sample(out, "taskmanager_cache_requests_total", labels + "\"hit\"", QByteArray::number(cacheHits[size_t(cache)].value()));
+        sample(out, "taskmanager_cache_requests_total", labels + "\"miss\"", QByteArray::number(cacheMisses[size_t(cache)].value()));
+    }
+
+    family(out, "taskmanager_storage_write_duration_seconds", "histogram", "Duration of storage writes.");
+    histogram(out, "taskmanager_storage_write_duration_seconds", storageWrite);
+
+    family(out, "taskmanager_storage_written_bytes", "counter", "Bytes written to storage.");
+    sample(out, "taskmanager_storage_written_bytes_total", QByteArray(), QByteArray::number(storageBytes.value()));
+
+    family(out, "taskmanager_journal_shipped_bytes", "counter", "Journal bytes sent to standbys.");
+    sample(out, "taskmanager_journal_shipped_bytes_total", QByteArray(), QByteArray::number(journalShipped.value()));
+
+    family(out, "taskmanager_replication_lag_seconds", "histogram", "Time from shipping a journal chunk to applying it on the standby.");
+    histogram(out, "taskmanager_replication_lag_seconds", replicationLag);
+
+    family(out, "taskmanager_replication_lag_bytes", "gauge", "Journal bytes received or announced but not applied yet.");
+    sample(out, "taskmanager_replication_lag_bytes", QByteArray(), QByteArray::number(replicationLagBytes.value()));
+
+    family(out, "taskmanager_replication_applied_entries", "counter", "Journal entries applied by the standby.");
+    sample(out, "taskmanager_replication_applied_entries_total", QByteArray(), QByteArray::number(replicationEntries.value()));
+
+    family(out, "taskmanager_replication_applied_bytes", "counter", "Journal bytes applied by the standby.");
+    sample(out, "taskmanager_replication_applied_bytes_total", QByteArray(), QByteArray::number(replicationBytes.value()));
+
+    family(out, "taskmanager_memory_bytes", "gauge", "Approximate memory by subsystem.");
+    const int subsystems = memory.size();
+    for (int i = 0; i < subsystems; ++i)
+    {
+        sample(out, "taskmanager_memory_bytes", "subsystem=\"" + memory.label(i) + '"',
+               QByteArray::number(memory.value(i)));
+    }
+
+    family(out, "taskmanager_memory_sheds", "counter", "Caches shed by the memory governor, by cache, priority and pressure level.");
+    const int sheds = cacheSheds.size();
+    for (int i = 0; i < sheds; ++i)
+        sample(out, "taskmanager_memory_sheds_total", cacheSheds.label(i), QByteArray::number(cacheSheds.value(i)));
+
+    family(out, "taskmanager_memory_shed_bytes", "counter", "Bytes released by shedding caches.");
+    const int shedSizes = cacheShedBytes.size();
+    for (int i = 0; i < shedSizes; ++i)
+    {
+        sample(out, "taskmanager_memory_shed_bytes_total", cacheShedBytes.label(i),
+               QByteArray::number(cacheShedBytes.value(i)));
+    }
+
+    family(out, "taskmanager_malloc_trims", "counter", "Free memory returned to the system, by pressure level.");
+    const int trims = mallocTrims.size();
+    for (int i = 0; i < trims; ++i)
+        sample(out, "taskmanager_malloc_trims_total", mallocTrims.label(i), QByteArray::number(mallocTrims.value(i)));
+
+    family(out, "taskmanager_malloc_trimmed_bytes", "counter", "Resident bytes given back by returning free memory.");
+    sample(out, "taskmanager_malloc_trimmed_bytes_total", QByteArray(), QByteArray::number(mallocTrimmedBytes.value()));
+
+    out += "# EOF\n";
+    return out;
+}
+
+ScopedTimer::ScopedTimer(Histogram &target)
+    : histogram(target), start(monotonicNs())
+{
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    histogram.observe(monotonicNs() - start);
+}
+
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <QByteArray>
+
+#include <array>
+#include <atomic>
+
+
+/**
+ * @file Metrics.h
+ * @brief Lock-free counters, gauges and histograms exported in OpenMetrics format
+ */
+
+namespace Metrics
+{
+
+/**
+ * @class Counter
+ * @brief Monotonically increasing counter
+ */
+class Counter
+{
+    std::atomic<quint64> count{0};
+
+public:
+    void add(quint64 value = 1) { count.fetch_add(value, std::memory_order_relaxed); }
+    quint64 value() const { return count.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @class Gauge
+ * @brief Value that can go up and down
+ */
+class Gauge
+{
+    std::atomic<qint64> current{0};
+
+public:
+    void set(qint64 value) { current.store(value, std::memory_order_relaxed); }
+    void add(qint64 value) { current.fetch_add(value, std::memory_order_relaxed); }
+    qint64 value() const { return current.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @class Histogram
+ * @brief Distribution of durations over fixed buckets from 50 µs to 2.5 s
+ *
+ * Each observation increments one bucket, the count and the sum with relaxed atomics;
+ * buckets are accumulated when the histogram is rendered.
+ */
+class Histogram
+{
+public:
+    static constexpr std::array<qint64, 14> BoundsNs = {
+        50'000, 100'000, 250'000, 500'000, 1'000'000, 2'500'000, 5'000'000,
+        10'000'000, 25'000'000, 50'000'000, 100'000'000, 250'000'000, 1'000'000'000, 2'500'000'000};
+
+    /**
+     * @brief Records a duration
+     * @param nanoseconds The duration in nanoseconds
+     */
+    void observe(qint64 nanoseconds);
+
+    quint64 bucket(int index) const { return buckets[size_t(index)].load(std::memory_order_relaxed); }
+    quint64 count() const { return observations.load(std::memory_order_relaxed); }
+    quint64 sumNs() const { return sum.load(std::memory_order_relaxed); }
+
+private:
+    std::array<std::atomic<quint64>, BoundsNs.size() + 1> buckets{}; ///< Per-bucket counts; the last is +Inf
+    std::atomic<quint64> observations{0};
+    std::atomic<quint64> sum{0};
+};
+
+/**
+ * @class LabeledGauges
+ * @brief Gauges identified by a label value registered at runtime
+ *
+ * Slots are registered by a single thread (the GUI thread). A slot's label is written
+ * before the slot count is published with release ordering, so readers on other threads
+ * only ever see fully initialised slots and never take a lock.
+ */
+template <int Capacity>
+class LabeledGauges
+{
+    std::array<QByteArray, Capacity> labels;
+    std::array<Gauge, Capacity> gauges;
+    std::atomic<int> used{0};
+
+public:
+    /**
+     * @brief Gets the gauge for a label, registering it on first use
+     * @return The gauge, or nullptr if all slots are taken
+     * @note Only call from one thread.
+     */
+    Gauge *gauge(const QByteArray &label)
+    {
+        const int count = used.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; ++i)
+        {
+            if (labels[size_t(i)] == label)
+                return &gauges[size_t(i)];
+        }
+        if (count == Capacity)
+            return nullptr;
+
+        labels[size_t(count)] = label;
+        used.store(count + 1, std::memory_order_release);
+        return &gauges[size_t(count)];
+    }
+
+    int size() const { return used.load(std::memory_order_acquire); }
+    const QByteArray &label(int index) const { return labels[size_t(index)]; }
+    qint64 value(int index) const { return gauges[size_t(index)].value(); }
+};
+
+/**
+ * @class LabeledCounters
+ * @brief Counters identified by a label set registered at runtime
+ *
+ * Like LabeledGauges, but the label is the complete rendered label set (e.g.
+ * cache="search.index",level="high"), so one family can carry several labels.
+ */
+template <int Capacity>
+class LabeledCounters
+{
+    std::array<QByteArray, Capacity> labels;
+    std::array<Counter, Capacity> counters;
+    std::atomic<int> used{0};
+
+public:
+    /**
+     * @brief Gets the counter for a label set, registering it on first use
+     * @return The counter, or nullptr if all slots are taken
+     * @note Only call from one thread.
+     */
+    Counter *counter(const QByteArray &label)
+    {
+        const int count = used.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; ++i)
+        {
+            if (labels[size_t(i)] == label)
+                return &counters[size_t(i)];
+        }
+        if (count == Capacity)
+            return nullptr;
+
+        labels[size_t(count)] = label;
+        used.store(count + 1, std::memory_order_release);
+        return &counters[size_t(count)];
+    }
+
+    int size() const { return used.load(std::memory_order_acquire); }
+    const QByteArray &label(int index) const { return labels[size_t(index)]; }
+    quint64 value(int index) const { return counters[size_t(index)].value(); }
+};
+
+/**
+ * @enum Mutation
+ * @brief Kinds of task mutations
+ */
+enum Mutation
+{
+    Insert,
+    Remove,
+    Update,
+    DescriptionEdit,
+    MutationCount
+};
+
+/**
+ * @enum Operation
+ * @brief Timed operations
+ */
+enum Operation
+{
+    Search,
+    BulkInsert,
+    BulkRemove,
+    PolicyBatch,
+    HistoryReplay,
+    OperationCount
+};
+
+/**
+ * @enum Cache
+ * @brief Caches with hit/miss accounting
+ */
+enum Cache
+{
+    RecordSnapshot,  ///< Task::record()
+    FlatDescription, ///< Task::getDescription()
+    SearchArena,     ///< TextScanner arena reused by a search
+    CacheCount
+};
+
+/**
+ * @class Registry
+ * @brief All metrics of the application
+ *
+ * A fixed set of metrics in one process-wide instance, so instrumented code can update
+ * them without locks or lookups and a scrape can read them from any thread.
+ */
+class Registry
+{
+public:
+    static Registry &instance();
+
+    std::array<std::array<Gauge, 4>, 2> tasks;        ///< Task count by [completed][priority 0..2, other]
+    std::array<Counter, MutationCount> mutations;     ///< Mutations by kind
+    std::array<Histogram, OperationCount> latency;    ///< Operation durations
+    Counter guiStalls;                                ///< Event loop stalls over StallThresholdMs
+    Histogram guiLag;                                 ///< Event loop lag per tick
+    std::array<Counter, CacheCount> cacheHits;        ///< Cache hits by cache
+    std::array<Counter, CacheCount> cacheMisses;      ///< Cache misses by cache
+    Histogram storageWrite;                           ///< Durations of storage writes
+    Counter storageBytes;                             ///< Bytes written to storage
+    Counter journalShipped;                           ///< Journal bytes sent to standbys
+    Histogram replicationLag;                         ///< Time from shipping a journal chunk to applying it
+    Gauge replicationLagBytes;                        ///< Journal bytes the standby has not applied yet
+    Counter replicationEntries;                       ///< Journal entries applied by the standby
+    Counter replicationBytes;                         ///< Journal bytes applied by the standby
+    LabeledGauges<32> memory;                         ///< Approximate memory by subsystem
+    LabeledCounters<64> cacheSheds;                   ///< Caches shed by the memory governor, by cache, priority and level
+    LabeledCounters<64> cacheShedBytes;               ///< Bytes released by shedding, labeled like cacheSheds
+    LabeledCounters<4> mallocTrims;                   ///< Free memory returned to the system, by pressure level
+    Counter mallocTrimmedBytes;                       ///< Resident bytes given back by those trims
+
+    void hit(Cache cache, bool hit) { (hit ? cacheHits : cacheMisses)[cache].add(); }
+
+    /**
+     * @brief Renders all metrics in the OpenMetrics text format
+     *
+     * Reads only atomics, so it can run on any thread concurrently with updates.
+     */
+    QByteArray render() const;
+};
+
+/**
+ * @class ScopedTimer
+ * @brief Observes the lifetime of a scope in a histogram
+ */
+class ScopedTimer
+{
+    Histogram &histogram;
+    qint64 start;
+
+public:
+    explicit ScopedTimer(Histogram &target);
+    ~ScopedTimer();
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+};
+
+inline Registry &registry() { return Registry::instance(); }
+
+}
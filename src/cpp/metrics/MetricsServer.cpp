@@ -0,0 +1,137 @@
+#include "MetricsServer.h"
+#include "Metrics.h"
+
+#include <QDebug>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+namespace
+{
+
+QByteArray response(const QByteArray &status, const QByteArray &contentType, const QByteArray &body)
+{
+    QByteArray out = "HTTP/1.1 " + status + "\r\n"
+                     "Content-Type: " + contentType + "\r\n"
+                     "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                     "Connection: close\r\n\r\n";
+    out += body;
+    return out;
+}
+
+}
+
+MetricsServer::MetricsServer(QObject *parent)
+    : QObject(parent)
+{
+    thread.setObjectName(QStringLiteral("MetricsServer"));
+}
+
+MetricsServer::~MetricsServer()
+{
+    close();
+}
+
+bool MetricsServer::listen(quint16 port)
+{
+    close();
+    thread.start();
+
+    QTcpServer *listener = new QTcpServer;
+    listener->moveToThread(&thread);
+
+    bool ok = false;
+    QMetaObject::invokeMethod(listener, [this, listener, port, &ok]() {
+        ok = listener->listen(QHostAddress::LocalHost, port);
+        if (!ok)
+        {
+            qWarning() << "MetricsServer::listen:" << listener->errorString();
+            delete listener;
+            return;
+        }
+        boundPort = listener->serverPort();
+        connect(listener, &QTcpServer::newConnection, listener, [this, listener]() { accept(listener); });
+    }, Qt::BlockingQueuedConnection);
+
+    if (!ok)
+    {
+        thread.quit();
+        thread.wait();
+        return false;
+    }
+
+    server = listener;
+    return true;
+}
+
+void MetricsServer::close()
+{
+    if (server)
+    {
+        // Connections are children of the server and go with it.
+        QTcpServer *listener = server;
+        server = nullptr;
+        QMetaObject::invokeMethod(listener, [listener]() { delete listener; }, Qt::BlockingQueuedConnection);
+        boundPort = 0;
+    }
+    thread.quit();
+    thread.wait();
+}
+
+void MetricsServer::accept(QTcpServer *listener)
+{
+    // Runs in the server thread.
+    while (QTcpSocket *socket = listener->nextPendingConnection())
+    {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+            if (socket->property("answered").toBool())
+            {
+                socket->readAll();
+                return;
+            }
+
+            QByteArray head = socket->property("head").toByteArray() + socket->readAll();
+            const qsizetype end = head.indexOf("\r\n\r\n");
+            if (end < 0 && head.size() <= MaxRequestSize)
+            {
+                socket->setProperty("head", head);
+                return;
+            }
+
+            head.truncate(end < 0 ? MaxRequestSize : end);
+            socket->setProperty("head", QVariant());
+            socket->setProperty("answered", true);
+            socket->write(end < 0 ? response("431 Request Header Fields Too Large", "text/plain", QByteArray())
+                                  : respond(head));
+            served.fetch_add(1, std::memory_order_relaxed);
+            socket->disconnectFromHost();
+        });
+    }
+}
+
+QByteArray MetricsServer::respond(const QByteArray &request)
+{
+    // Request line: "GET /metrics HTTP/1.1"
+    const qsizetype lineEnd = request.indexOf("\r\n");
+    const QList<QByteArray> line = request.left(lineEnd < 0 ? request.size() : lineEnd).split(' ');
+    if (line.size() != 3 || !line.at(2).startsWith("HTTP/1."))
+        return response("400 Bad Request", "text/plain", QByteArray());
+
+    const QByteArray &method = line.at(0);
+    QByteArray path = line.at(1);
+    const qsizetype query = path.indexOf('?');
+    if (query >= 0)
+        path.truncate(query);
+
+    if (path != "/metrics")
+        return response("404 Not Found", "text/plain", QByteArray());
+    if (method != "GET" && method != "HEAD")
+        return response("405 Method Not Allowed", "text/plain", QByteArray());
+
+    QByteArray out = response("200 OK", "application/openmetrics-text; version=1.0.0; charset=utf-8",
+                              Metrics::registry().render());
+    if (method == "HEAD")
+        out.truncate(out.indexOf("\r\n\r\n") + 4);
+    return out;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QObject>
+#include <QThread>
+
+#include <atomic>
+
+class QTcpServer;
+
+
+/**
+ * @file MetricsServer.h
+ * @brief Localhost HTTP endpoint serving the metrics registry in OpenMetrics format
+ */
+
+/**
+ * @class MetricsServer
+ * @brief Serves GET /metrics on 127.0.0.1 from a thread of its own
+ *
+ * The listening socket and all connections live in a dedicated thread, and a scrape only
+ * renders Metrics::Registry, which reads atomics. Scrapes therefore never wait for the GUI
+ * thread, and a slow or stuck GUI thread does not delay them either.
+ *
+ * The server only binds to the loopback interface and serves nothing but the metrics;
+ * it is off unless listen() is called.
+ *
+ * Example usage:
+ * @code
+ * MetricsServer *server = new MetricsServer(this);
+ * if (server->listen(9464))
+ *     qDebug() << "Metrics on http://127.0.0.1:" << server->port() << "/metrics";
+ * @endcode
+ */
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Default TCP port
+     */
+    static constexpr quint16 DefaultPort = 9464;
+
+    /**
+     * @brief Largest request head accepted, in bytes
+     */
+    static constexpr int MaxRequestSize = 8 * 1024;
+
+    explicit MetricsServer(QObject *parent = nullptr);
+    ~MetricsServer() override;
+
+    /**
+     * @brief Starts listening on 127.0.0.1
+     * @param port The TCP port; 0 picks a free port (see port())
+     * @return true if the server is listening
+     *
+     * Blocks until the server thread has bound the socket.
+     */
+    bool listen(quint16 port = DefaultPort);
+
+    /**
+     * @brief Stops listening and closes all connections
+     */
+    void close();
+
+    bool isListening() const { return server != nullptr; }
+
+    /**
+     * @brief Gets the port the server listens on, 0 if it does not listen
+     */
+    quint16 port() const { return boundPort; }
+
+    /**
+     * @brief Gets the number of requests answered
+     */
+    quint64 scrapes() const { return served.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Builds the HTTP response to a request head
+     * @param request The request line and headers
+     * @return The full response, status line through body
+     */
+    static QByteArray respond(const QByteArray &request);
+
+private:
+    QThread thread;                       ///< Thread owning the listening socket and connections
+    QTcpServer *server = nullptr;         ///< Listening socket, lives in thread
+    quint16 boundPort = 0;                ///< Port listened on
+    std::atomic<quint64> served{0};       ///< Requests answered
+
+    void accept(QTcpServer *listener);
+};
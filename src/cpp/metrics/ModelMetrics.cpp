@@ -0,0 +1,112 @@
+#include "ModelMetrics.h"
+#include "Metrics.h"
+#include "TaskModel.h"
+
+ModelMetrics::ModelMetrics(TaskModel *taskModel, QObject *parent)
+    : QObject(parent), model(taskModel)
+{
+    if (!model)
+        return;
+
+    connect(model, &TaskModel::rowsInserted, this, [this](const QModelIndex &, int first, int last) {
+        Metrics::registry().mutations[Metrics::Insert].add(quint64(last - first + 1));
+        for (int row = first; row <= last; ++row)
+            countRow(row);
+    });
+    connect(model, &TaskModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &, int first, int last) {
+        // Compacting tombstones is not a removal; the delete was counted already.
+        for (int row = first; row <= last; ++row)
+        {
+            if (!model->isDeleted(row))
+                Metrics::registry().mutations[Metrics::Remove].add();
+            uncount(model->taskId(row));
+        }
+    });
+    connect(model, &TaskModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+        // Ranges of DeletedRole changes are all deletes or all restores.
+        const bool deleted = roles.contains(TaskModel::DeletedRole);
+        const Metrics::Mutation mutation = !deleted ? Metrics::Update : model->isDeleted(topLeft.row()) ? Metrics::Remove : Metrics::Insert;
+        Metrics::registry().mutations[mutation].add(quint64(bottomRight.row() - topLeft.row() + 1));
+        if (!roles.isEmpty() && !roles.contains(TaskModel::CompletedRole) && !roles.contains(TaskModel::PriorityRole) && !deleted)
+            return;
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+            countRow(row);
+    });
+    connect(model, &TaskModel::descriptionEdited, this, []() {
+        Metrics::registry().mutations[Metrics::DescriptionEdit].add();
+    });
+    connect(model, &TaskModel::modelAboutToBeReset, this, &ModelMetrics::clear);
+    connect(model, &TaskModel::modelReset, this, &ModelMetrics::recount);
+
+    recount();
+}
+
+ModelMetrics::~ModelMetrics()
+{
+    clear();
+}
+
+int ModelMetrics::keyOf(bool completed, int priority)
+{
+    // Priorities outside Low..High share the "other" gauge.
+    const int column = priority >= 0 && priority < 3 ? priority : 3;
+    return (completed ? 4 : 0) + column;
+}
+
+void ModelMetrics::adjust(int key, int delta)
+{
+    Metrics::registry().tasks[size_t(key / 4)][size_t(key % 4)].add(delta);
+}
+
+void ModelMetrics::countRow(int row)
+{
+    const QModelIndex index = model->index(row);
+    const quint64 id = model->taskId(row);
+    if (model->isDeleted(row))
+    {
+        uncount(id);
+        return;
+    }
+    const int key = keyOf(model->data(index, TaskModel::CompletedRole).toBool(),
+                          model->data(index, TaskModel::PriorityRole).toInt());
+
+    auto it = counted.find(id);
+    if (it == counted.end())
+    {
+        counted.insert(id, key);
+        adjust(key, 1);
+    }
+    else if (*it != key)
+    {
+        adjust(*it, -1);
+        adjust(key, 1);
+        *it = key;
+    }
+}
+
+void ModelMetrics::uncount(quint64 id)
+{
+    const auto it = counted.constFind(id);
+    if (it == counted.constEnd())
+        return;
+
+    adjust(*it, -1);
+    counted.erase(it);
+}
+
+void ModelMetrics::recount()
+{
+    clear();
+    if (!model)
+        return;
+
+    for (int row = 0; row < model->rowCount(); ++row)
+        countRow(row);
+}
+
+void ModelMetrics::clear()
+{
+    for (int key : std::as_const(counted))
+        adjust(key, -1);
+    counted.clear();
+}
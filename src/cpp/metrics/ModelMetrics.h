@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+
+class TaskModel;
+
+
+/**
+ * @file ModelMetrics.h
+ * @brief Publishes task counts and mutation counters of a TaskModel
+ */
+
+/**
+ * @class ModelMetrics
+ * @brief Keeps the task gauges and mutation counters of the metrics registry up to date
+ *
+ * Observes a model's row and data change signals on the GUI thread and maintains the
+ * number of tasks per (status, priority) incrementally, remembering each task's last
+ * counted key. The counts live in atomics of Metrics::Registry, so a scrape never touches
+ * the model. On destruction the model's contribution is withdrawn from the gauges.
+ */
+class ModelMetrics : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Constructs an observer counting the tasks of the given model
+     * @param model The model to observe
+     * @param parent The parent QObject
+     */
+    explicit ModelMetrics(TaskModel *model, QObject *parent = nullptr);
+    ~ModelMetrics() override;
+
+    /**
+     * @brief Gets the number of tasks counted
+     */
+    int countedTasks() const { return counted.size(); }
+
+private:
+    QPointer<TaskModel> model;          ///< Observed model
+    QHash<quint64, int> counted;        ///< Gauge key each task is counted under
+
+    static int keyOf(bool completed, int priority);
+    static void adjust(int key, int delta);
+
+    void countRow(int row);
+    void uncount(quint64 id);
+    void recount();
+    void clear();
+};
@@ -0,0 +1,37 @@
+#include "StallMonitor.h"
+#include "Metrics.h"
+
+StallMonitor::StallMonitor(QObject *parent)
+    : QObject(parent)
+{
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, &QTimer::timeout, this, &StallMonitor::tick);
+}
+
+void StallMonitor::start(int interval)
+{
+    sinceTick.start();
+    timer.start(interval);
+}
+
+void StallMonitor::stop()
+{
+    timer.stop();
+}
+
+void StallMonitor::tick()
+{
+    const qint64 elapsedNs = sinceTick.nsecsElapsed();
+    sinceTick.start();
+
+    const qint64 lagNs = qMax<qint64>(0, elapsedNs - qint64(timer.interval()) * 1000000);
+    Metrics::Registry &metrics = Metrics::registry();
+    metrics.guiLag.observe(lagNs);
+
+    if (lagNs >= qint64(threshold) * 1000000)
+    {
+        ++stallCount;
+        metrics.guiStalls.add();
+        emit stalled(lagNs / 1000000);
+    }
+}
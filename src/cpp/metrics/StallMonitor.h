@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+
+/**
+ * @file StallMonitor.h
+ * @brief Detects stalls of the event loop it runs in
+ */
+
+/**
+ * @class StallMonitor
+ * @brief Heartbeat timer measuring how late the event loop delivers its ticks
+ *
+ * Every tick observes the delay beyond the heartbeat interval in the GUI lag histogram of
+ * Metrics::Registry; a delay of at least stallThreshold() milliseconds counts as a stall.
+ * A stall is only known once the loop runs again, which is exactly when the delay is
+ * measured, so the monitor needs no thread of its own.
+ */
+class StallMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Default heartbeat interval in milliseconds
+     */
+    static constexpr int DefaultInterval = 50;
+
+    /**
+     * @brief Default lag in milliseconds from which a tick counts as a stall
+     */
+    static constexpr int DefaultStallThreshold = 100;
+
+    explicit StallMonitor(QObject *parent = nullptr);
+
+    /**
+     * @brief Starts the heartbeat
+     * @param interval Time between ticks in milliseconds
+     */
+    void start(int interval = DefaultInterval);
+
+    /**
+     * @brief Stops the heartbeat
+     */
+    void stop();
+
+    int stallThreshold() const { return threshold; }
+    void setStallThreshold(int ms) { threshold = qMax(1, ms); }
+
+    /**
+     * @brief Gets the number of stalls seen by this monitor
+     */
+    int stalls() const { return stallCount; }
+
+signals:
+
+    /**
+     * @brief Emitted after a stall
+     * @param lagMs How late the heartbeat was in milliseconds
+     */
+    void stalled(qint64 lagMs);
+
+private:
+    QTimer timer;                           ///< Heartbeat
+    QElapsedTimer sinceTick;                ///< Time since the previous tick
+    int threshold = DefaultStallThreshold;  ///< Stall threshold in milliseconds
+    int stallCount = 0;                     ///< Stalls seen
+
+    void tick();
+};
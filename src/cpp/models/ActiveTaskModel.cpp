@@ -0,0 +1,26 @@
+#include "ActiveTaskModel.h"
+
+ActiveTaskModel::ActiveTaskModel(TaskModel *model, QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    // Only a change of DeletedRole can change whether a row is accepted.
+    setFilterRole(TaskModel::DeletedRole);
+    setSourceModel(model);
+
+    connect(this, &QAbstractItemModel::rowsInserted, this, &ActiveTaskModel::countChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &ActiveTaskModel::countChanged);
+    connect(this, &QAbstractItemModel::modelReset, this, &ActiveTaskModel::countChanged);
+}
+
+int ActiveTaskModel::sourceRow(int row) const
+{
+    const QModelIndex source = mapToSource(index(row, 0));
+    return source.isValid() ? source.row() : -1;
+}
+
+bool ActiveTaskModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    Q_UNUSED(sourceParent)
+    const auto *tasks = static_cast<const TaskModel *>(sourceModel());
+    return !tasks->isDeleted(sourceRow);
+}
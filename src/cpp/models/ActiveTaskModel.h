@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QSortFilterProxyModel>
+#include "TaskModel.h"
+
+
+/**
+ * @file ActiveTaskModel.h
+ * @brief View of a TaskModel without its deleted tasks
+ */
+
+/**
+ * @class ActiveTaskModel
+ * @brief Proxy that hides the tombstoned rows of a TaskModel
+ *
+ * Unless compaction is turned off (see TaskModel::setCompactionDeferred()), TaskModel::removeTask()
+ * keeps the row of a deleted task until it is compacted and only emits dataChanged() for
+ * DeletedRole; this proxy turns that into the row disappearing from attached views. Rows of the proxy are not rows of the source model: map them with
+ * sourceRow() before calling the row-based methods of TaskModel or TaskController.
+ *
+ * Example usage (QML):
+ * @code
+ * ListView {
+ *     model: taskController.activeTasks
+ *     delegate: TaskItem {
+ *         onDeleteRequested: taskController.deleteTask(taskController.activeTasks.sourceRow(index))
+ *     }
+ * }
+ * @endcode
+ */
+class ActiveTaskModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+    /**
+     * @property count
+     * @brief The number of rows shown
+     */
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+
+    /**
+     * @brief Constructs a proxy showing the live tasks of a model
+     * @param model The source model
+     * @param parent The parent QObject
+     */
+    explicit ActiveTaskModel(TaskModel *model, QObject *parent = nullptr);
+
+    /**
+     * @brief Returns the number of rows shown
+     *
+     * This is the getter for the count Q_PROPERTY.
+     */
+    int count() const { return rowCount(); }
+
+    /**
+     * @brief Maps a row of the proxy to the row of the source model
+     * @param row The zero-based row in the proxy
+     * @return The row in the TaskModel, or -1 if row is invalid
+     */
+    Q_INVOKABLE int sourceRow(int row) const;
+
+signals:
+
+    /**
+     * @brief Emitted when rows are shown or hidden
+     */
+    void countChanged();
+
+protected:
+
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+};
@@ -0,0 +1,272 @@
+#include "AgendaModel.h"
+#include "TaskModel.h"
+
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+
+AgendaModel::AgendaModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    replanTimer.setSingleShot(true);
+    replanTimer.setInterval(0);
+    connect(&replanTimer, &QTimer::timeout, this, &AgendaModel::start);
+}
+
+void AgendaModel::attach(TaskModel *taskModel)
+{
+    for (const QMetaObject::Connection &connection : std::as_const(connections))
+        disconnect(connection);
+    connections.clear();
+
+    model = taskModel;
+    start();
+    if (!model)
+        return;
+
+    auto replan = [this] {
+        if (!planner.windows().isEmpty())
+        {
+            const bool wasPlanning = isPlanning();
+            replanTimer.start();
+            if (!wasPlanning)
+                emit planningChanged();
+        }
+    };
+    connections << connect(model, &TaskModel::rowsInserted, this, replan);
+    connections << connect(model, &TaskModel::rowsRemoved, this, replan);
+    connections << connect(model, &TaskModel::modelReset, this, replan);
+    connections << connect(model, &TaskModel::dataChanged, this, [this, replan](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+        for (int role : roles)
+        {
+            switch (role)
+            {
+            case TaskModel::TitleRole:
+                for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+                    retitle(model->taskId(row));
+                break;
+            case TaskModel::CompletedRole:
+            case TaskModel::PriorityRole:
+            case TaskModel::DeletedRole:
+            case TaskModel::EstimateRole:
+            case TaskModel::DependenciesRole:
+                replan();
+                break;
+            default:
+                break;
+            }
+        }
+    });
+}
+
+void AgendaModel::setWindows(const QList<SlotPlanner::Window> &windows)
+{
+    // A running plan is for the old free time; its result is dropped.
+    ++generation;
+    running = false;
+    dirty = false;
+    planner.setWindows(windows);
+    start();
+}
+
+void AgendaModel::planWeek()
+{
+    setWindows(SlotPlanner::workingHours(QDateTime::currentDateTime(), 7,
+                                         QTime(DayStartHour, 0), QTime(DayEndHour, 0)));
+}
+
+void AgendaModel::clear()
+{
+    const bool wasPlanning = isPlanning();
+    ++generation;
+    running = false;
+    dirty = false;
+    replanTimer.stop();
+    planner.setWindows({});
+    adopt(planner);
+    if (wasPlanning)
+        emit planningChanged();
+}
+
+void AgendaModel::setSearchBudget(int msecs)
+{
+    planner.setSearchBudget(msecs);
+}
+
+QList<SlotPlanner::Item> AgendaModel::pendingItems() const
+{
+    QList<SlotPlanner::Item> items;
+    if (!model)
+        return items;
+
+    items.reserve(model->rowCount());
+    for (int row = 0; row < model->rowCount(); ++row)
+    {
+        const Task *task = model->taskById(model->taskId(row));
+        if (task->isDeleted() || task->getCompleted() || task->getEstimate() <= 0)
+            continue;
+        items.append({task->getId(), qint64(task->getEstimate()) * 60, task->getPriority(), task->getDependencies()});
+    }
+    return items;
+}
+
+void AgendaModel::start()
+{
+    if (running)
+    {
+        dirty = true;
+        return;
+    }
+
+    const bool wasPlanning = isPlanning();
+    replanTimer.stop();
+    if (planner.windows().isEmpty())
+    {
+        if (!rows.isEmpty())
+            adopt(planner);
+        if (wasPlanning)
+            emit planningChanged();
+        return;
+    }
+
+    // The worker plans on its own copy; the GUI thread keeps showing the current plan.
+    running = true;
+    const quint64 asked = generation;
+    auto *watcher = new QFutureWatcher<SlotPlanner>(this);
+    connect(watcher, &QFutureWatcher<SlotPlanner>::finished, this, [this, watcher, asked]() {
+        watcher->deleteLater();
+        if (asked != generation)
+            return;
+
+        running = false;
+        adopt(watcher->result());
+        if (dirty)
+        {
+            dirty = false;
+            start();
+        }
+        else
+        {
+            emit planningChanged();
+        }
+        emit planned();
+    });
+    watcher->setFuture(QtConcurrent::run([copy = planner, items = pendingItems()]() mutable {
+        copy.plan(items);
+        return copy;
+    }));
+    if (!wasPlanning)
+        emit planningChanged();
+}
+
+void AgendaModel::adopt(const SlotPlanner &result)
+{
+    const QList<SlotPlanner::Slot> &next = result.slots();
+    auto same = [](const SlotPlanner::Slot &a, const SlotPlanner::Slot &b) {
+        return a.taskId == b.taskId && a.start == b.start && a.end == b.end;
+    };
+
+    // Only the run of rows between the common head and tail is replaced.
+    const int oldCount = int(rows.size());
+    const int newCount = int(next.size());
+    int head = 0;
+    while (head < oldCount && head < newCount && same(rows[head], next[head]))
+        ++head;
+    int tail = 0;
+    while (tail < oldCount - head && tail < newCount - head
+           && same(rows[oldCount - 1 - tail], next[newCount - 1 - tail]))
+        ++tail;
+
+    if (oldCount - tail > head)
+    {
+        beginRemoveRows(QModelIndex(), head, oldCount - tail - 1);
+        rows.remove(head, oldCount - tail - head);
+        endRemoveRows();
+    }
+
+    planner = result;
+    if (newCount - tail > head)
+    {
+        beginInsertRows(QModelIndex(), head, newCount - tail - 1);
+        rows = next;
+        endInsertRows();
+    }
+    else
+    {
+        rows = next;
+    }
+    // Split tasks with slots on both sides of the replaced run may have new part numbers.
+    if (!rows.isEmpty() && (head > 0 || tail > 0))
+        emit dataChanged(index(0), index(count() - 1), {PartRole, PartsRole});
+
+    if (oldCount != newCount)
+        emit countChanged();
+}
+
+void AgendaModel::retitle(quint64 id)
+{
+    for (int row = 0; row < rows.size(); ++row)
+    {
+        if (rows[row].taskId == id)
+            emit dataChanged(index(row), index(row), {TitleRole});
+    }
+}
+
+int AgendaModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return int(rows.size());
+}
+
+QVariant AgendaModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size())
+        return QVariant();
+
+    const SlotPlanner::Slot &slot = rows[index.row()];
+    const Task *task = model ? model->taskById(slot.taskId) : nullptr;
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    case TitleRole:
+        return task ? task->getTitle() : QString();
+    case TaskIdRole:
+        return slot.taskId;
+    case PriorityRole:
+        return task ? task->getPriority() : 0;
+    case StartRole:
+        return SlotPlanner::toDateTime(slot.start);
+    case EndRole:
+        return SlotPlanner::toDateTime(slot.end);
+    case DayRole:
+        return SlotPlanner::toDateTime(slot.start).date().toString(Qt::ISODate);
+    case PartRole:
+    case PartsRole:
+    {
+        const QList<SlotPlanner::Slot> parts = planner.slotsOf(slot.taskId);
+        if (role == PartsRole)
+            return int(parts.size());
+        const auto it = std::find_if(parts.cbegin(), parts.cend(), [&slot](const SlotPlanner::Slot &part) {
+            return part.start == slot.start;
+        });
+        return int(it - parts.cbegin());
+    }
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> AgendaModel::roleNames() const
+{
+    return {
+        {TitleRole, "title"},
+        {TaskIdRole, "taskId"},
+        {PriorityRole, "priority"},
+        {StartRole, "start"},
+        {EndRole, "end"},
+        {DayRole, "day"},
+        {PartRole, "part"},
+        {PartsRole, "parts"},
+    };
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QTimer>
+#include "SlotPlanner.h"
+
+class TaskModel;
+
+
+/**
+ * @file AgendaModel.h
+ * @brief Plan of the pending tasks of a TaskModel in calendar time
+ */
+
+/**
+ * @class AgendaModel
+ * @brief List of the time slots the pending tasks of a TaskModel are planned into
+ *
+ * AgendaModel observes a TaskModel (see attach()) and, once given free time with
+ * planWeek() or setWindows(), places its pending tasks into it with a SlotPlanner: every
+ * live, uncompleted task with an estimate, by priority and after the tasks it waits for.
+ * The estimate of a task is its work in hours.
+ *
+ * Planning runs on the global thread pool on a copy of the planner, so thousands of tasks
+ * never block the GUI thread; the copy with the new plan replaces the model's planner when
+ * it is done. Edits that change the plan, like an estimate, a priority, a dependency or a
+ * completed task, replan in the next event loop pass, together, and incrementally: only
+ * the tasks after the first change in the order of the plan are placed again. An edit made
+ * while a plan is running replans once it is done. The rows that differ from the previous
+ * plan are removed and inserted; the others stay.
+ *
+ * Rows are slots, ordered by start. A task that fits in no window in one piece is split
+ * into several slots; see the part and parts roles. Tasks that fit nowhere are listed by
+ * unplaced().
+ *
+ * Example usage (QML):
+ * @code
+ * ListView {
+ *     model: taskController.agenda
+ *     section.property: "day"
+ *     delegate: Label { text: Qt.formatTime(start, "hh:mm") + " " + title }
+ *     Component.onCompleted: model.planWeek()
+ * }
+ * @endcode
+ */
+class AgendaModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /**
+     * @property count
+     * @brief The number of slots
+     */
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    /**
+     * @property planning
+     * @brief Whether a plan is being computed
+     */
+    Q_PROPERTY(bool planning READ isPlanning NOTIFY planningChanged)
+
+    /**
+     * @property unplacedCount
+     * @brief The number of pending tasks that did not fit into the free time
+     */
+    Q_PROPERTY(int unplacedCount READ unplacedCount NOTIFY planned)
+
+public:
+
+    /**
+     * @brief Roles of the slots
+     */
+    enum Roles
+    {
+        TitleRole = Qt::UserRole + 1,   ///< Task title
+        TaskIdRole,                     ///< Task id
+        PriorityRole,                   ///< Task priority
+        StartRole,                      ///< Start of the slot, local time
+        EndRole,                        ///< End of the slot, local time
+        DayRole,                        ///< Day of the start, as text, for sections
+        PartRole,                       ///< Index of the slot among the slots of its task
+        PartsRole                       ///< Number of slots of its task, 1 unless it is split
+    };
+
+    /**
+     * @brief Working hours used by planWeek()
+     */
+    static constexpr int DayStartHour = 9;
+    static constexpr int DayEndHour = 17;
+
+    /**
+     * @brief Constructs a model without tasks or free time
+     * @param parent The parent QObject
+     */
+    explicit AgendaModel(QObject *parent = nullptr);
+
+    /**
+     * @brief Starts observing a model; its tasks are planned into the current free time
+     * @param model The tasks to plan, or nullptr to detach
+     */
+    void attach(TaskModel *model);
+
+    /**
+     * @brief Replaces the free time and plans the pending tasks from scratch
+     * @param windows Free time, see SlotPlanner::setWindows()
+     */
+    void setWindows(const QList<SlotPlanner::Window> &windows);
+
+    /**
+     * @brief Plans the pending tasks into the working hours of the weekdays of the next seven days
+     */
+    Q_INVOKABLE void planWeek();
+
+    /**
+     * @brief Drops the free time and the plan; edits no longer replan
+     */
+    Q_INVOKABLE void clear();
+
+    /**
+     * @brief Sets the time the local search of a plan may take
+     * @param msecs Milliseconds; 0 keeps the greedy plan
+     */
+    void setSearchBudget(int msecs);
+
+    int count() const { return int(rows.size()); }
+    bool isPlanning() const { return running || replanTimer.isActive(); }
+    int unplacedCount() const { return int(planner.unplaced().size()); }
+
+    /**
+     * @brief Gets the pending tasks that did not fit into the free time
+     */
+    Q_INVOKABLE QList<quint64> unplaced() const { return planner.unplaced(); }
+
+    /**
+     * @brief Gets the planner holding the current plan
+     */
+    const SlotPlanner &currentPlan() const { return planner; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+signals:
+
+    void countChanged();
+    void planningChanged();
+
+    /**
+     * @brief Emitted when a plan is done and its rows are in place
+     */
+    void planned();
+
+private:
+
+    QPointer<TaskModel> model;                      ///< Observed tasks
+    QList<QMetaObject::Connection> connections;     ///< Connections to model, dropped by attach()
+    SlotPlanner planner;                            ///< Current plan and its free time
+    QList<SlotPlanner::Slot> rows;                  ///< Slots of the plan by start
+    QTimer replanTimer;                             ///< Replans the edits of one event loop pass together
+    quint64 generation = 0;                         ///< Incremented for new free time; stale plans are dropped
+    bool running = false;                           ///< Set while a plan is computed
+    bool dirty = false;                             ///< Set when tasks changed while a plan is computed
+
+    /**
+     * @brief Gets the pending tasks of the model as planner items
+     */
+    QList<SlotPlanner::Item> pendingItems() const;
+
+    /**
+     * @brief Plans the pending tasks on the pool, or after the running plan
+     */
+    void start();
+
+    /**
+     * @brief Takes a finished plan and updates the rows that differ
+     */
+    void adopt(const SlotPlanner &result);
+
+    /**
+     * @brief Announces a changed title for the rows of a task
+     */
+    void retitle(quint64 id);
+};
@@ -0,0 +1,87 @@
+#include "AssigneeModel.h"
+#include "TaskModel.h"
+
+AssigneeModel::AssigneeModel(TaskModel *taskModel, quint32 assignee)
+    : QAbstractListModel(taskModel), model(taskModel), person(assignee)
+{
+    connect(model, &TaskModel::dataChanged, this, &AssigneeModel::onSourceDataChanged);
+}
+
+const Task *AssigneeModel::taskAt(int row) const
+{
+    const QList<quint64> &ids = model->assigneePostings(person);
+    if (row < 0 || row >= ids.size())
+        return nullptr;
+
+    return model->taskById(ids[row]);
+}
+
+int AssigneeModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return int(model->assigneePostings(person).size());
+}
+
+QVariant AssigneeModel::data(const QModelIndex &index, int role) const
+{
+    const Task *task = index.isValid() ? taskAt(index.row()) : nullptr;
+    return task ? TaskModel::taskData(task, role) : QVariant();
+}
+
+QHash<int, QByteArray> AssigneeModel::roleNames() const
+{
+    return model->roleNames();
+}
+
+QString AssigneeModel::assignee() const
+{
+    return model->assigneeName(person);
+}
+
+int AssigneeModel::openCount() const
+{
+    return model->assigneeWorkload(person).open;
+}
+
+int AssigneeModel::completedCount() const
+{
+    return model->assigneeWorkload(person).completed;
+}
+
+quint64 AssigneeModel::taskId(int row) const
+{
+    const Task *task = taskAt(row);
+    return task ? task->getId() : 0;
+}
+
+TaskRecord AssigneeModel::getTask(int row) const
+{
+    const Task *task = taskAt(row);
+    return task ? task->record() : TaskRecord();
+}
+
+int AssigneeModel::sourceRow(int row) const
+{
+    const quint64 id = taskId(row);
+    return id != 0 ? model->indexOfTask(id) : -1;
+}
+
+void AssigneeModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    // Row insertions and removals are announced by the model; only value changes arrive here.
+    const QList<quint64> &ids = model->assigneePostings(person);
+    if (ids.isEmpty())
+        return;
+
+    // Only live tasks of the person are in the posting list.
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+    {
+        const quint64 id = model->taskId(row);
+        if (id == 0)
+            continue;
+
+        const int listed = model->assigneePosition(person, id);
+        if (listed < ids.size() && ids[listed] == id)
+            emit dataChanged(index(listed), index(listed), roles);
+    }
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include "TaskRecord.h"
+
+class Task;
+class TaskModel;
+
+
+/**
+ * @file AssigneeModel.h
+ * @brief List model of the tasks of one assignee of a TaskModel
+ */
+
+/**
+ * @class AssigneeModel
+ * @brief Read-only list of the live tasks assigned to one person, oldest task first
+ *
+ * Owned by its TaskModel (see TaskModel::assigneeTasks()), one per person, which
+ * announces all row changes from its assignee index: adding, deleting or restoring a
+ * task inserts or removes one row here, and reassigning a task only touches the models
+ * of its former and new assignee. Rows follow the posting list of the person, i.e. the
+ * ascending task ids. The model exposes the same roles as TaskModel; map rows with
+ * sourceRow() before calling the row-based methods of TaskModel or TaskController.
+ *
+ * openCount and completedCount are the live workload of the person, kept up to date
+ * without scanning the tasks.
+ *
+ * Example usage (QML):
+ * @code
+ * ListView {
+ *     model: taskController.taskModel.assigneeTasks("Ana")
+ *     header: Label { text: qsTr("%1 open").arg(ListView.view.model.openCount) }
+ *     delegate: TaskItem { task: model.record }
+ * }
+ * @endcode
+ */
+class AssigneeModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /**
+     * @property assignee
+     * @brief The person whose tasks are listed; empty for the unassigned tasks
+     */
+    Q_PROPERTY(QString assignee READ assignee CONSTANT)
+
+    /**
+     * @property count
+     * @brief The number of tasks listed
+     */
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    /**
+     * @property openCount
+     * @brief The number of listed tasks that are not completed
+     */
+    Q_PROPERTY(int openCount READ openCount NOTIFY workloadChanged)
+
+    /**
+     * @property completedCount
+     * @brief The number of listed tasks that are completed
+     */
+    Q_PROPERTY(int completedCount READ completedCount NOTIFY workloadChanged)
+
+private:
+    friend class TaskModel;
+
+    TaskModel *model; ///< Owning model, whose tasks are listed
+    quint32 person;   ///< Interned id of the assignee in the model's index
+
+    /**
+     * @brief Constructs the list of a person; called by TaskModel only
+     * @param model The owning model, also the QObject parent
+     * @param person Interned id of the assignee
+     */
+    AssigneeModel(TaskModel *model, quint32 person);
+
+    /**
+     * @brief Gets the task shown in a row, or nullptr if row is invalid
+     */
+    const Task *taskAt(int row) const;
+
+    /**
+     * @brief Forwards a change of the owning model's rows to the rows listing them
+     */
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+
+public:
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * @brief Returns the name of the assignee
+     *
+     * This is the getter for the assignee Q_PROPERTY.
+     */
+    QString assignee() const;
+
+    /**
+     * @brief Returns the number of tasks listed
+     *
+     * This is the getter for the count Q_PROPERTY.
+     */
+    int count() const { return rowCount(); }
+
+    /**
+     * @brief Returns the number of open tasks of the assignee
+     */
+    int openCount() const;
+
+    /**
+     * @brief Returns the number of completed tasks of the assignee
+     */
+    int completedCount() const;
+
+    /**
+     * @brief Gets the stable id of the task in a row
+     * @param row The zero-based row
+     * @return The task id, or 0 if row is invalid
+     */
+    Q_INVOKABLE quint64 taskId(int row) const;
+
+    /**
+     * @brief Retrieves a snapshot of the task in a row
+     * @param row The zero-based row
+     * @return TaskRecord with the task's values, or a null record if row is invalid
+     */
+    Q_INVOKABLE TaskRecord getTask(int row) const;
+
+    /**
+     * @brief Maps a row to the row of the task in the owning model
+     * @param row The zero-based row
+     * @return The row in the TaskModel, or -1 if row is invalid
+     */
+    Q_INVOKABLE int sourceRow(int row) const;
+
+signals:
+
+    /**
+     * @brief Emitted when tasks are added to or removed from the list
+     */
+    void countChanged();
+
+    /**
+     * @brief Emitted when the open or completed count of the assignee changes
+     */
+    void workloadChanged();
+};
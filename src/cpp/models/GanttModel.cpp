@@ -0,0 +1,344 @@
+#include "GanttModel.h"
+#include "TaskModel.h"
+
+#include <QDebug>
+#include <QSet>
+
+#include <algorithm>
+
+namespace
+{
+
+// Roles that change when a task is rescheduled; an estimate only changes with its schedule.
+const QList<int> ScheduleRoles{GanttModel::EstimateRole, GanttModel::EarliestStartRole, GanttModel::EarliestFinishRole,
+                               GanttModel::LatestStartRole, GanttModel::LatestFinishRole,
+                               GanttModel::SlackRole, GanttModel::CriticalRole};
+
+}
+
+GanttModel::GanttModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void GanttModel::attach(TaskModel *taskModel)
+{
+    for (const QMetaObject::Connection &connection : std::as_const(connections))
+        disconnect(connection);
+    connections.clear();
+
+    model = taskModel;
+    rebuild();
+    if (!model)
+        return;
+
+    connections << connect(model, &TaskModel::rowsInserted, this, [this](const QModelIndex &, int first, int last) {
+        addRows(first, last);
+        refresh();
+    });
+    connections << connect(model, &TaskModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &, int first, int last) {
+        // Tombstoned rows were unscheduled when they were deleted.
+        for (int row = first; row <= last; ++row)
+        {
+            if (!model->isDeleted(row))
+                removeId(model->taskId(row));
+        }
+        refresh();
+    });
+    connections << connect(model, &TaskModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+        QList<int> relinked;
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+        {
+            const quint64 id = model->taskId(row);
+            const Task *task = model->taskById(id);
+            if (!task)
+                continue;
+
+            for (int role : roles)
+            {
+                switch (role)
+                {
+                case TaskModel::DeletedRole:
+                    if (task->isDeleted())
+                        removeId(id);
+                    else
+                        addRows(row, row);
+                    break;
+                case TaskModel::EstimateRole:
+                    graph.setDuration(id, task->getEstimate());
+                    break;
+                case TaskModel::DependenciesRole:
+                    if (graph.contains(id))
+                    {
+                        graph.setDependencies(id, task->getDependencies());
+                        relinked.append(rowOfTask(id));
+                    }
+                    break;
+                case TaskModel::TitleRole:
+                case TaskModel::CompletedRole:
+                {
+                    const int listed = rowOfTask(id);
+                    if (listed >= 0)
+                        emit dataChanged(index(listed), index(listed), {role == TaskModel::TitleRole ? TitleRole : CompletedRole});
+                    break;
+                }
+                default:
+                    break;
+                }
+            }
+        }
+
+        refresh();
+        for (int row : std::as_const(relinked))
+            emit dataChanged(index(row), index(row), {LinksRole});
+    });
+    connections << connect(model, &TaskModel::modelReset, this, [this] {
+        rebuild();
+    });
+}
+
+const Task *GanttModel::taskAt(int row) const
+{
+    if (!model || row < 0 || row >= ids.size())
+        return nullptr;
+
+    return model->taskById(ids[row]);
+}
+
+int GanttModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return int(ids.size());
+}
+
+QVariant GanttModel::data(const QModelIndex &index, int role) const
+{
+    const Task *task = index.isValid() ? taskAt(index.row()) : nullptr;
+    if (!task)
+        return QVariant();
+
+    const quint64 id = task->getId();
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    case TitleRole:
+        return task->getTitle();
+    case TaskIdRole:
+        return id;
+    case CompletedRole:
+        return task->getCompleted();
+    case EstimateRole:
+        return task->getEstimate();
+    case EarliestStartRole:
+        return graph.times(id).earliestStart;
+    case EarliestFinishRole:
+        return graph.times(id).earliestFinish;
+    case LatestStartRole:
+        return graph.times(id).latestStart;
+    case LatestFinishRole:
+        return graph.times(id).latestFinish;
+    case SlackRole:
+        return graph.times(id).slack;
+    case CriticalRole:
+        return graph.times(id).critical();
+    case LinksRole:
+    {
+        QVariantList links;
+        for (quint64 pred : graph.predecessors(id))
+            links.append(QVariantMap{{"taskId", pred}, {"finish", graph.times(pred).earliestFinish}});
+        return links;
+    }
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> GanttModel::roleNames() const
+{
+    return {
+        {TitleRole, "title"},
+        {TaskIdRole, "taskId"},
+        {CompletedRole, "completed"},
+        {EstimateRole, "estimate"},
+        {EarliestStartRole, "earliestStart"},
+        {EarliestFinishRole, "earliestFinish"},
+        {LatestStartRole, "latestStart"},
+        {LatestFinishRole, "latestFinish"},
+        {SlackRole, "slack"},
+        {CriticalRole, "critical"},
+        {LinksRole, "links"},
+    };
+}
+
+int GanttModel::rowOfTask(quint64 id) const
+{
+    const auto it = std::lower_bound(ids.cbegin(), ids.cend(), id);
+    return it != ids.cend() && *it == id ? int(it - ids.cbegin()) : -1;
+}
+
+bool GanttModel::setEstimate(quint64 id, int hours)
+{
+    if (!model || !graph.contains(id))
+        return false;
+
+    return model->setData(model->index(model->indexOfTask(id)), hours, TaskModel::EstimateRole);
+}
+
+bool GanttModel::addDependency(quint64 id, quint64 dependency)
+{
+    const Task *task = model && graph.contains(id) && graph.contains(dependency) ? model->taskById(id) : nullptr;
+    if (!task)
+        return false;
+    if (graph.wouldCycle(id, dependency))
+    {
+        qWarning() << "GanttModel::addDependency: task" << id << "cannot wait for" << dependency << "which waits for it";
+        return false;
+    }
+
+    QList<quint64> dependencies = task->getDependencies();
+    if (!dependencies.contains(dependency))
+    {
+        dependencies.append(dependency);
+        return model->setData(model->index(model->indexOfTask(id)), QVariant::fromValue(dependencies), TaskModel::DependenciesRole);
+    }
+    return true;
+}
+
+bool GanttModel::removeDependency(quint64 id, quint64 dependency)
+{
+    const Task *task = model && graph.contains(id) ? model->taskById(id) : nullptr;
+    if (!task)
+        return false;
+
+    QList<quint64> dependencies = task->getDependencies();
+    if (!dependencies.removeOne(dependency))
+        return false;
+    return model->setData(model->index(model->indexOfTask(id)), QVariant::fromValue(dependencies), TaskModel::DependenciesRole);
+}
+
+void GanttModel::rebuild()
+{
+    beginResetModel();
+    ids.clear();
+    graph.clear();
+    if (model)
+    {
+        QList<const Task *> live;
+        for (int row = 0; row < model->rowCount(); ++row)
+        {
+            if (!model->isDeleted(row))
+                live.append(model->taskById(model->taskId(row)));
+        }
+
+        // All tasks first, so no dependency has to wait for a task further down.
+        for (const Task *task : std::as_const(live))
+        {
+            ids.append(task->getId());
+            graph.addTask(task->getId(), task->getEstimate());
+        }
+        for (const Task *task : std::as_const(live))
+        {
+            if (!task->getDependencies().isEmpty())
+                graph.setDependencies(task->getId(), task->getDependencies());
+        }
+        std::sort(ids.begin(), ids.end());
+    }
+    graph.update();
+    endResetModel();
+    emit countChanged();
+
+    if (graph.projectEnd() != end)
+    {
+        end = graph.projectEnd();
+        emit projectEndChanged();
+    }
+}
+
+void GanttModel::addRows(int first, int last)
+{
+    QList<const Task *> added;
+    for (int row = first; row <= last; ++row)
+    {
+        const Task *task = model->taskById(model->taskId(row));
+        if (task && !task->isDeleted() && !graph.contains(task->getId()))
+            added.append(task);
+    }
+    if (added.isEmpty())
+        return;
+
+    if (added.size() == 1)
+    {
+        // New tasks get the highest id, so this is an append unless a task is restored.
+        const quint64 id = added.first()->getId();
+        const int row = int(std::lower_bound(ids.cbegin(), ids.cend(), id) - ids.cbegin());
+        beginInsertRows(QModelIndex(), row, row);
+        ids.insert(row, id);
+        graph.addTask(id, added.first()->getEstimate());
+        graph.setDependencies(id, added.first()->getDependencies());
+        endInsertRows();
+    }
+    else
+    {
+        beginResetModel();
+        for (const Task *task : std::as_const(added))
+        {
+            ids.append(task->getId());
+            graph.addTask(task->getId(), task->getEstimate());
+        }
+        for (const Task *task : std::as_const(added))
+        {
+            if (!task->getDependencies().isEmpty())
+                graph.setDependencies(task->getId(), task->getDependencies());
+        }
+        std::sort(ids.begin(), ids.end());
+        endResetModel();
+    }
+    emit countChanged();
+}
+
+void GanttModel::removeId(quint64 id)
+{
+    const int row = rowOfTask(id);
+    if (row < 0)
+        return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    ids.remove(row);
+    graph.removeTask(id);
+    endRemoveRows();
+    emit countChanged();
+}
+
+void GanttModel::refresh()
+{
+    const QList<quint64> changed = graph.update();
+    const qint64 projectEnd = graph.projectEnd();
+
+    // Latest starts are relative to the project end, so a new end changes them all at once.
+    if (projectEnd != end)
+    {
+        end = projectEnd;
+        if (!ids.isEmpty())
+            emit dataChanged(index(0), index(int(ids.size()) - 1), ScheduleRoles + QList<int>{LinksRole});
+        emit projectEndChanged();
+        return;
+    }
+
+    QSet<int> linked;
+    for (quint64 id : changed)
+    {
+        const int row = rowOfTask(id);
+        if (row >= 0)
+            emit dataChanged(index(row), index(row), ScheduleRoles);
+        for (quint64 succ : graph.successors(id))
+        {
+            const int succRow = rowOfTask(succ);
+            if (succRow >= 0)
+                linked.insert(succRow);
+        }
+    }
+
+    // The links of dependents show where their prerequisites finish.
+    for (int row : std::as_const(linked))
+        emit dataChanged(index(row), index(row), {LinksRole});
+}
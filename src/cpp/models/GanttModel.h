@@ -0,0 +1,183 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include "ScheduleGraph.h"
+
+class Task;
+class TaskModel;
+
+
+/**
+ * @file GanttModel.h
+ * @brief Schedule of the tasks of a TaskModel by their estimates and dependencies
+ */
+
+/**
+ * @class GanttModel
+ * @brief List of the live tasks of a TaskModel with earliest and latest start times
+ *
+ * GanttModel observes a TaskModel (see attach()) and keeps a ScheduleGraph of its live
+ * tasks: the estimate of a task is its duration in hours and its dependencies are the
+ * edges. An edit of an estimate or of dependencies recomputes only the dependents and
+ * prerequisites of the task it touches, and dataChanged() is emitted for the rows whose
+ * times actually changed. When the end of the project moves, the latest starts, slack and
+ * critical flags of all rows change with it; that is one dataChanged() over all rows and
+ * costs nothing until a view reads the rows it shows.
+ *
+ * Rows are the live tasks in ascending id order, i.e. the order they were created in;
+ * times are in hours from the start of the project. A view shows the chart as one bar per
+ * row from earliestStart to earliestFinish, and can draw the links of a row from the
+ * links role. Tasks in the trash are not scheduled; dependencies on them wait for them to
+ * be restored.
+ *
+ * Example usage (QML):
+ * @code
+ * ListView {
+ *     model: taskController.gantt
+ *     delegate: Rectangle {
+ *         x: earliestStart * 8
+ *         width: Math.max(2, estimate * 8)
+ *         color: critical ? "red" : "steelblue"
+ *     }
+ * }
+ * @endcode
+ */
+class GanttModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /**
+     * @property count
+     * @brief The number of scheduled tasks
+     */
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    /**
+     * @property projectEnd
+     * @brief Hours from the start of the project to the earliest finish of its last task
+     */
+    Q_PROPERTY(qint64 projectEnd READ projectEnd NOTIFY projectEndChanged)
+
+public:
+
+    /**
+     * @brief Roles of the scheduled tasks
+     */
+    enum Roles
+    {
+        TitleRole = Qt::UserRole + 1,   ///< Task title
+        TaskIdRole,                     ///< Task id
+        CompletedRole,                  ///< Completion status
+        EstimateRole,                   ///< Estimate in hours, the length of the bar
+        EarliestStartRole,              ///< Earliest start in hours
+        EarliestFinishRole,             ///< Earliest finish in hours
+        LatestStartRole,                ///< Latest start in hours
+        LatestFinishRole,               ///< Latest finish in hours
+        SlackRole,                      ///< Hours the task can slip without delaying the project
+        CriticalRole,                   ///< Whether the task is on the critical path
+        LinksRole                       ///< Connected prerequisites, a list of {taskId, finish} maps
+    };
+
+    /**
+     * @brief Constructs a model without tasks
+     * @param parent The parent QObject
+     */
+    explicit GanttModel(QObject *parent = nullptr);
+
+    /**
+     * @brief Starts observing a model, replacing the rows
+     * @param model The tasks to schedule, or nullptr to detach
+     */
+    void attach(TaskModel *model);
+
+    int count() const { return int(ids.size()); }
+    qint64 projectEnd() const { return end; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * @brief Gets the id of the task in a row
+     * @return The task id, or 0 if row is invalid
+     */
+    Q_INVOKABLE quint64 taskId(int row) const { return ids.value(row); }
+
+    /**
+     * @brief Gets the row of a scheduled task
+     * @return The row, or -1 if the task is not scheduled
+     */
+    Q_INVOKABLE int rowOfTask(quint64 id) const;
+
+    /**
+     * @brief Sets the estimate of a task
+     * @param id The task
+     * @param hours The estimate in hours
+     * @return false if the task is not scheduled
+     */
+    Q_INVOKABLE bool setEstimate(quint64 id, int hours);
+
+    /**
+     * @brief Makes a task wait for another one
+     * @param id The dependent task
+     * @param dependency The task that must be finished first
+     * @return false if a task is not scheduled or the dependency would close a cycle
+     */
+    Q_INVOKABLE bool addDependency(quint64 id, quint64 dependency);
+
+    /**
+     * @brief Removes a dependency of a task
+     * @return false if the task is not scheduled or does not depend on dependency
+     */
+    Q_INVOKABLE bool removeDependency(quint64 id, quint64 dependency);
+
+    /**
+     * @brief Gets the schedule of a task
+     * @return The times, all 0 if the task is not scheduled
+     */
+    ScheduleGraph::Times times(quint64 id) const { return graph.times(id); }
+
+    /**
+     * @brief Gets the tasks on the critical path, ordered by earliest start
+     */
+    Q_INVOKABLE QList<quint64> criticalPath() const { return graph.criticalPath(); }
+
+signals:
+
+    void countChanged();
+    void projectEndChanged();
+
+private:
+
+    QPointer<TaskModel> model;                      ///< Observed tasks
+    QList<QMetaObject::Connection> connections;     ///< Connections to model, dropped by attach()
+    mutable ScheduleGraph graph;                    ///< Schedule of the rows; queries update it
+    QList<quint64> ids;                             ///< Task id by row, ascending
+    qint64 end = 0;                                 ///< Project end as last announced
+
+    /**
+     * @brief Gets the task in a row, or nullptr if row is invalid
+     */
+    const Task *taskAt(int row) const;
+
+    /**
+     * @brief Replaces the rows with the live tasks of the model
+     */
+    void rebuild();
+
+    /**
+     * @brief Schedules the live tasks among inserted rows of the model
+     */
+    void addRows(int first, int last);
+
+    /**
+     * @brief Unschedules a task
+     */
+    void removeId(quint64 id);
+
+    /**
+     * @brief Recomputes the schedule after edits and announces the rows that changed
+     */
+    void refresh();
+};
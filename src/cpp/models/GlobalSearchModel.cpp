@@ -0,0 +1,566 @@
+#include "GlobalSearchModel.h"
+#include "TaskModel.h"
+#include "TaskStore.h"
+#include "TextScanner.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <atomic>
+#include <queue>
+
+/**
+ * @brief Searchable copy of the tasks of a store that is not loaded
+ *
+ * Built by the first search of the store and kept until the store's manifest changes,
+ * which it does on every save. Searches of the same store run one at a time.
+ *
+ * The scanner's arena is saved next to the manifest (see ArenaFile). A later launch
+ * loads it instead of reading every page, and then reads only the pages of the rows
+ * that match; records stay null until they are read.
+ */
+struct GlobalSearchModel::StoreIndex
+{
+    QMutex mutex;                       ///< Held while building or scanning
+    QByteArray manifest;                ///< Manifest the index was built from; empty if not built
+    QList<TaskRecord> records;          ///< Tasks of the store, row by row; null until read
+    TextScanner scanner;                ///< Folded text of the records
+    std::atomic<qint64> bytes{0};       ///< Approximate memory held, readable without the mutex
+};
+
+namespace
+{
+
+/**
+ * Name of the file next to a store's manifest holding its saved search arena.
+ */
+const QString ArenaFile = QStringLiteral("search.arena");
+
+constexpr quint32 ArenaMagic = 0x544d5341; // "TMSA"
+constexpr quint32 ArenaVersion = 1;
+
+/**
+ * Loads the arena saved for a manifest; false if there is none or it is for another one.
+ */
+bool loadArena(const QString &directory, const QByteArray &manifest, TextScanner &scanner)
+{
+    QFile file(directory + QLatin1Char('/') + ArenaFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray savedFor;
+    in >> magic >> version >> savedFor;
+    if (in.status() != QDataStream::Ok || magic != ArenaMagic || version != ArenaVersion || savedFor != manifest)
+        return false;
+
+    if (!scanner.loadArena(in))
+    {
+        qWarning() << "GlobalSearchModel: ignoring damaged" << file.fileName();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Saves the arena of a store's scanner for the manifest it was built from.
+ */
+void saveArena(const QString &directory, const QByteArray &manifest, const TextScanner &scanner)
+{
+    QSaveFile file(directory + QLatin1Char('/') + ArenaFile);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "GlobalSearchModel: cannot write" << file.fileName() << file.errorString();
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << ArenaMagic << ArenaVersion << manifest;
+    scanner.saveArena(out);
+    if (!file.commit())
+        qWarning() << "GlobalSearchModel: cannot write" << file.fileName() << file.errorString();
+}
+
+}
+
+bool GlobalSearchModel::Hit::before(const Hit &other) const
+{
+    if (rank != other.rank)
+        return rank > other.rank;
+    const int byTitle = title.compare(other.title, Qt::CaseInsensitive);
+    if (byTitle != 0)
+        return byTitle < 0;
+    const int byWorkspace = workspace.compare(other.workspace);
+    if (byWorkspace != 0)
+        return byWorkspace < 0;
+    return taskId < other.taskId;
+}
+
+GlobalSearchModel::GlobalSearchModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    mergeTimer.setSingleShot(true);
+    mergeTimer.setInterval(0);
+    connect(&mergeTimer, &QTimer::timeout, this, &GlobalSearchModel::flush);
+}
+
+GlobalSearchModel::~GlobalSearchModel() = default;
+
+void GlobalSearchModel::addWorkspace(const QString &name, TaskModel *model)
+{
+    removeWorkspace(name);
+    Workspace workspace;
+    workspace.name = name;
+    workspace.model = model;
+    spaces.append(workspace);
+}
+
+bool GlobalSearchModel::addWorkspace(const QString &name, const QString &storeDirectory)
+{
+    if (!QFile::exists(storeDirectory + QStringLiteral("/manifest")))
+    {
+        qWarning() << "GlobalSearchModel: no task store in" << storeDirectory;
+        return false;
+    }
+
+    removeWorkspace(name);
+    Workspace workspace;
+    workspace.name = name;
+    workspace.directory = storeDirectory;
+    workspace.index = std::make_shared<StoreIndex>();
+    spaces.append(workspace);
+    return true;
+}
+
+int GlobalSearchModel::addWorkspaces(const QString &directory)
+{
+    int added = 0;
+    const QFileInfoList entries = QDir(directory).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QFileInfo &entry : entries)
+    {
+        if (QFile::exists(entry.absoluteFilePath() + QStringLiteral("/manifest"))
+            && addWorkspace(entry.fileName(), entry.absoluteFilePath()))
+            ++added;
+    }
+    return added;
+}
+
+void GlobalSearchModel::removeWorkspace(const QString &name)
+{
+    const qsizetype removed = spaces.removeIf([&name](const Workspace &workspace) { return workspace.name == name; });
+    if (removed == 0)
+        return;
+
+    for (int row = int(rows.size()) - 1; row >= 0; --row)
+    {
+        if (rows[row].workspace != name)
+            continue;
+        beginRemoveRows(QModelIndex(), row, row);
+        rows.removeAt(row);
+        endRemoveRows();
+    }
+    emit countChanged();
+}
+
+QStringList GlobalSearchModel::workspaces() const
+{
+    QStringList names;
+    for (const Workspace &workspace : spaces)
+        names.append(workspace.name);
+    return names;
+}
+
+void GlobalSearchModel::search(const QString &query)
+{
+    const QString trimmed = query.trimmed();
+    ++generation;
+    arrived.clear();
+    pending = 0;
+    mergeTimer.stop();
+
+    if (!rows.isEmpty())
+    {
+        beginResetModel();
+        rows.clear();
+        endResetModel();
+        emit countChanged();
+    }
+    if (trimmed != text)
+    {
+        text = trimmed;
+        emit queryChanged();
+    }
+
+    const bool wasSearching = searching;
+    searching = !text.isEmpty() && !spaces.isEmpty();
+    if (searching != wasSearching)
+        emit searchingChanged();
+    if (!searching)
+        return;
+
+    const QString needle = text.toCaseFolded();
+    for (const Workspace &workspace : std::as_const(spaces))
+    {
+        if (workspace.index)
+        {
+            // Answered on the pool; the generation tells a stale answer from a current one.
+            auto *watcher = new QFutureWatcher<QList<Hit>>(this);
+            const quint64 asked = generation;
+            const QString name = workspace.name;
+            const std::shared_ptr<StoreIndex> index = workspace.index;
+            connect(watcher, &QFutureWatcher<QList<Hit>>::finished, this, [this, watcher, asked, name, index]() {
+                watcher->deleteLater();
+                if (asked != generation)
+                    return;
+
+                --pending;
+                const bool current = std::any_of(spaces.cbegin(), spaces.cend(), [&](const Workspace &workspace) {
+                    return workspace.index == index;
+                });
+                const QList<Hit> hits = current ? watcher->result() : QList<Hit>();
+                emit workspaceAnswered(name, int(hits.size()));
+                if (!hits.isEmpty())
+                    arrived.append(hits);
+                mergeTimer.start();
+            });
+            ++pending;
+            watcher->setFuture(QtConcurrent::run(&GlobalSearchModel::searchStore, name, workspace.directory, index, text));
+            continue;
+        }
+
+        if (!workspace.model)
+            continue;
+
+        QList<Hit> hits;
+        const QList<int> found = workspace.model->findTasks(text);
+        for (int row : found)
+        {
+            const TaskRecord record = workspace.model->getTask(row);
+            const int score = rank(record, needle);
+            if (score > 0)
+                hits.append({score, record.getTitle(), record.getDescription(), workspace.name, record.getId(), record.getCompleted()});
+        }
+        sortHits(hits);
+        emit workspaceAnswered(workspace.name, int(hits.size()));
+        if (!hits.isEmpty())
+            arrived.append(hits);
+    }
+
+    // Loaded workspaces are shown right away, stored ones as they answer.
+    flush();
+}
+
+QList<GlobalSearchModel::Hit> GlobalSearchModel::searchStore(const QString &name, const QString &directory,
+                                                             const std::shared_ptr<StoreIndex> &index, const QString &text)
+{
+    QFile file(directory + QStringLiteral("/manifest"));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "GlobalSearchModel: cannot read" << file.fileName() << file.errorString();
+        return {};
+    }
+    const QByteArray manifest = file.readAll();
+
+    QMutexLocker lock(&index->mutex);
+    if (index->manifest != manifest && loadArena(directory, manifest, index->scanner))
+    {
+        index->records = QList<TaskRecord>(index->scanner.size());
+        index->manifest = manifest;
+        index->bytes = index->scanner.memoryUsage();
+    }
+    else if (index->manifest != manifest)
+    {
+        QString error;
+        QList<TaskRecord> records = TaskStore::read(directory, &error);
+        if (!error.isEmpty())
+        {
+            qWarning() << "GlobalSearchModel:" << error;
+            return {};
+        }
+
+        index->scanner.clear();
+        qint64 bytes = 0;
+        for (int row = 0; row < records.size(); ++row)
+        {
+            const TaskRecord &record = records[row];
+            index->scanner.insert(row, record.getTitle(), record.getDescription());
+            bytes += 64 + qint64(record.getTitle().size() + record.getDescription().size()) * qint64(sizeof(char16_t));
+        }
+        index->records = std::move(records);
+        index->manifest = manifest;
+        saveArena(directory, manifest, index->scanner);
+        index->bytes = bytes + index->scanner.memoryUsage();
+    }
+
+    const QString needle = text.toCaseFolded();
+    QList<Hit> hits;
+    const qint64 scannerBytes = index->scanner.memoryUsage();
+    const QList<int> found = index->scanner.find(text);
+
+    // With a loaded arena, only the pages of matching rows are read, once.
+    QList<int> unread;
+    for (int row : found)
+    {
+        if (index->records[row].isNull())
+            unread.append(row);
+    }
+    if (!unread.isEmpty())
+    {
+        QString error;
+        const QList<TaskRecord> read = TaskStore::read(directory, unread, &error);
+        if (!error.isEmpty() || read.size() != unread.size())
+        {
+            // Saved between reading the manifest and the pages; the next search starts over.
+            qWarning() << "GlobalSearchModel:" << (error.isEmpty() ? directory + QStringLiteral(": changed while searching") : error);
+            index->manifest.clear();
+            return {};
+        }
+        qint64 bytes = 0;
+        for (qsizetype i = 0; i < unread.size(); ++i)
+        {
+            const TaskRecord &record = read[i];
+            index->records[unread[i]] = record;
+            bytes += 64 + qint64(record.getTitle().size() + record.getDescription().size()) * qint64(sizeof(char16_t));
+        }
+        index->bytes += bytes;
+    }
+
+    for (int row : found)
+    {
+        const TaskRecord &record = index->records[row];
+        const int score = rank(record, needle);
+        if (score > 0)
+            hits.append({score, record.getTitle(), record.getDescription(), name, record.getId(), record.getCompleted()});
+    }
+    // The arena built by the first scan is part of the index from now on.
+    index->bytes += index->scanner.memoryUsage() - scannerBytes;
+    lock.unlock();
+
+    sortHits(hits);
+    return hits;
+}
+
+void GlobalSearchModel::sortHits(QList<Hit> &hits)
+{
+    const auto before = [](const Hit &a, const Hit &b) { return a.before(b); };
+    if (hits.size() > MaxResults)
+    {
+        std::partial_sort(hits.begin(), hits.begin() + MaxResults, hits.end(), before);
+        hits.resize(MaxResults);
+    }
+    else
+    {
+        std::sort(hits.begin(), hits.end(), before);
+    }
+}
+
+void GlobalSearchModel::flush()
+{
+    mergeTimer.stop();
+
+    if (!arrived.isEmpty())
+    {
+        QList<QList<Hit>> lists;
+        lists.reserve(arrived.size() + 1);
+        lists.append(rows);
+        lists.append(arrived);
+        arrived.clear();
+
+        QList<int> sources;
+        const QList<Hit> merged = merge(lists, MaxResults, &sources);
+
+        // The rows kept are a prefix of the current rows; drop the others first.
+        const int kept = int(sources.count(0));
+        if (kept < rows.size())
+        {
+            beginRemoveRows(QModelIndex(), kept, int(rows.size()) - 1);
+            rows.resize(kept);
+            endRemoveRows();
+        }
+
+        // Then insert every run of new hits where the merge put it, so kept rows never move.
+        int row = 0;
+        while (row < merged.size())
+        {
+            if (sources[row] == 0)
+            {
+                ++row;
+                continue;
+            }
+            int end = row;
+            while (end < merged.size() && sources[end] != 0)
+                ++end;
+            beginInsertRows(QModelIndex(), row, end - 1);
+            for (int i = row; i < end; ++i)
+                rows.insert(i, merged[i]);
+            endInsertRows();
+            row = end;
+        }
+        emit countChanged();
+    }
+
+    if (pending == 0 && searching)
+    {
+        searching = false;
+        emit searchingChanged();
+        emit finished();
+    }
+}
+
+QList<GlobalSearchModel::Hit> GlobalSearchModel::merge(const QList<QList<Hit>> &lists, int limit, QList<int> *sources)
+{
+    struct Cursor
+    {
+        int list;       ///< Index of the list
+        int position;   ///< Next hit of the list
+    };
+
+    // Max-heap on "listed first": the top is the next hit of the merge.
+    const auto after = [&lists](const Cursor &a, const Cursor &b) {
+        return lists[b.list][b.position].before(lists[a.list][a.position]);
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(after)> heap(after);
+    for (int list = 0; list < lists.size(); ++list)
+    {
+        if (!lists[list].isEmpty())
+            heap.push({list, 0});
+    }
+
+    QList<Hit> merged;
+    if (sources)
+        sources->clear();
+    while (!heap.empty() && merged.size() < limit)
+    {
+        Cursor cursor = heap.top();
+        heap.pop();
+        merged.append(lists[cursor.list][cursor.position]);
+        if (sources)
+            sources->append(cursor.list);
+        if (++cursor.position < lists[cursor.list].size())
+            heap.push(cursor);
+    }
+    return merged;
+}
+
+int GlobalSearchModel::rank(const TaskRecord &record, const QString &needle)
+{
+    if (needle.isEmpty())
+        return 0;
+
+    int score = 0;
+    const QString title = record.getTitle().toCaseFolded();
+    qsizetype at = title.indexOf(needle);
+    if (at == 0)
+    {
+        score = 300;
+    }
+    else if (at > 0)
+    {
+        score = 100;
+        for (; at > 0; at = title.indexOf(needle, at + 1))
+        {
+            if (!title[at - 1].isLetterOrNumber())
+            {
+                score = 200;
+                break;
+            }
+        }
+    }
+    else if (record.getDescription().toCaseFolded().contains(needle))
+    {
+        score = 50;
+    }
+    else
+    {
+        return 0;
+    }
+
+    score += record.getPriority() * 10;
+    if (record.getCompleted())
+        score -= 40;
+    return std::max(score, 1);
+}
+
+qint64 GlobalSearchModel::indexSize() const
+{
+    qint64 bytes = 0;
+    for (const Workspace &workspace : spaces)
+    {
+        if (workspace.index)
+            bytes += workspace.index->bytes;
+    }
+    return bytes;
+}
+
+qint64 GlobalSearchModel::releaseIndexes()
+{
+    qint64 released = 0;
+    for (const Workspace &workspace : std::as_const(spaces))
+    {
+        StoreIndex *index = workspace.index.get();
+        if (!index || !index->mutex.tryLock())
+            continue;
+
+        released += index->bytes;
+        index->records = QList<TaskRecord>();
+        index->scanner = TextScanner();
+        index->manifest.clear();
+        index->bytes = 0;
+        index->mutex.unlock();
+    }
+    return released;
+}
+
+int GlobalSearchModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return int(rows.size());
+}
+
+QVariant GlobalSearchModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= rows.size())
+        return QVariant();
+
+    const Hit &hit = rows[index.row()];
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    case TitleRole:
+        return hit.title;
+    case DescriptionRole:
+        return hit.description;
+    case WorkspaceRole:
+        return hit.workspace;
+    case TaskIdRole:
+        return hit.taskId;
+    case CompletedRole:
+        return hit.completed;
+    case RankRole:
+        return hit.rank;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> GlobalSearchModel::roleNames() const
+{
+    return {
+        {TitleRole, "title"},
+        {DescriptionRole, "description"},
+        {WorkspaceRole, "workspace"},
+        {TaskIdRole, "taskId"},
+        {CompletedRole, "completed"},
+        {RankRole, "rank"},
+    };
+}
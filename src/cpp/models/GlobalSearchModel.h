@@ -0,0 +1,247 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QTimer>
+#include "TaskRecord.h"
+
+#include <memory>
+
+class TaskModel;
+
+
+/**
+ * @file GlobalSearchModel.h
+ * @brief Search across every workspace, loaded or not, with results streamed as they come
+ */
+
+/**
+ * @class GlobalSearchModel
+ * @brief Ranked list of the tasks of all workspaces matching a query
+ *
+ * A workspace is either a loaded TaskModel, searched through its own index (see
+ * TaskModel::findTasks()), or a TaskStore directory that is not loaded. Stored workspaces
+ * are searched on the global thread pool, all at once: each keeps an index of its tasks
+ * (a TextScanner over the pages read with TaskStore::read()), built on first use and
+ * rebuilt when the store's manifest changes, so later queries only scan. The index's
+ * scan arena is saved next to the manifest, so a later launch loads it and reads only
+ * the pages holding matches.
+ *
+ * Every workspace answers with its best MaxResults hits, in rank order. Answers are
+ * merged into the rows as they arrive: the current rows and the answers received since
+ * the last merge are combined with a k-way heap merge, and only the new hits are
+ * inserted, so a view shows the loaded workspaces' results at once and the slower stores'
+ * results slide into place. A new query drops the answers of the previous one.
+ *
+ * Example usage (QML):
+ * @code
+ * TextField { onTextChanged: taskController.globalSearch.search(text) }
+ * ListView {
+ *     model: taskController.globalSearch
+ *     delegate: Label { text: title + " (" + workspace + ")" }
+ * }
+ * @endcode
+ */
+class GlobalSearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /**
+     * @property query
+     * @brief The text searched for, trimmed
+     */
+    Q_PROPERTY(QString query READ query NOTIFY queryChanged)
+
+    /**
+     * @property searching
+     * @brief Whether workspaces are still answering the query
+     */
+    Q_PROPERTY(bool searching READ isSearching NOTIFY searchingChanged)
+
+    /**
+     * @property count
+     * @brief The number of results so far
+     */
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+
+    /**
+     * @brief Roles of the results
+     */
+    enum Roles
+    {
+        TitleRole = Qt::UserRole + 1,   ///< Task title
+        DescriptionRole,                ///< Task description
+        WorkspaceRole,                  ///< Name of the task's workspace
+        TaskIdRole,                     ///< Task id within its workspace
+        CompletedRole,                  ///< Completion status
+        RankRole                        ///< Relevance, higher first
+    };
+
+    /**
+     * @brief Most results kept, and most hits a workspace answers with
+     */
+    static constexpr int MaxResults = 200;
+
+    /**
+     * @brief A task matching the query
+     */
+    struct Hit
+    {
+        int rank = 0;               ///< Relevance, see rank()
+        QString title;              ///< Task title
+        QString description;        ///< Task description
+        QString workspace;          ///< Name of the workspace
+        quint64 taskId = 0;         ///< Task id within the workspace
+        bool completed = false;     ///< Completion status
+
+        /**
+         * @brief Whether this hit is listed before another: higher rank, then by title,
+         *        workspace and id
+         */
+        bool before(const Hit &other) const;
+    };
+
+    /**
+     * @brief Constructs a model without workspaces
+     * @param parent The parent QObject
+     */
+    explicit GlobalSearchModel(QObject *parent = nullptr);
+
+    /**
+     * @brief Drops running searches; their workers finish on their own
+     */
+    ~GlobalSearchModel() override;
+
+    /**
+     * @brief Adds a loaded workspace
+     * @param name Name shown with its results; replaces a workspace of the same name
+     * @param model The workspace's tasks
+     */
+    void addWorkspace(const QString &name, TaskModel *model);
+
+    /**
+     * @brief Adds a workspace that is searched through its store
+     * @param name Name shown with its results; replaces a workspace of the same name
+     * @param storeDirectory Directory of the workspace's TaskStore
+     * @return false if the directory holds no store
+     */
+    bool addWorkspace(const QString &name, const QString &storeDirectory);
+
+    /**
+     * @brief Adds every store directory directly below a directory, named after it
+     * @return Number of workspaces added
+     */
+    int addWorkspaces(const QString &directory);
+
+    /**
+     * @brief Removes a workspace and its results
+     */
+    void removeWorkspace(const QString &name);
+
+    /**
+     * @brief Gets the names of the workspaces, in the order they were added
+     */
+    QStringList workspaces() const;
+
+    QString query() const { return text; }
+    bool isSearching() const { return searching; }
+    int count() const { return int(rows.size()); }
+
+    /**
+     * @brief Starts searching all workspaces; results replace those of the previous query
+     * @param text The text to search for, compared case-insensitively; empty clears the results
+     */
+    Q_INVOKABLE void search(const QString &text);
+
+    /**
+     * @brief Gets a result
+     * @param row The zero-based row
+     * @return The hit, or a default one if row is invalid
+     */
+    Hit hit(int row) const { return rows.value(row); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * @brief Gets the relevance of a task for a query
+     * @param record The task
+     * @param needle The query, case-folded
+     * @return 0 if the task does not match; otherwise higher for a match at the start of
+     *         the title, at the start of a word of it, inside it, then in the description,
+     *         raised by priority and lowered for completed tasks
+     */
+    static int rank(const TaskRecord &record, const QString &needle);
+
+    /**
+     * @brief Merges lists of hits with a k-way heap merge
+     * @param lists Lists each in order, see Hit::before()
+     * @param limit Most hits returned
+     * @param sources If given, receives for each hit the index of its list
+     * @return The first limit hits of all lists, in order
+     */
+    static QList<Hit> merge(const QList<QList<Hit>> &lists, int limit, QList<int> *sources = nullptr);
+
+    /**
+     * @brief Gets the approximate memory held by the indexes of stored workspaces, in bytes
+     */
+    qint64 indexSize() const;
+
+    /**
+     * @brief Drops the indexes of stored workspaces not being searched
+     * @return Approximate number of bytes released
+     *
+     * An index is rebuilt by the next query that needs it.
+     */
+    qint64 releaseIndexes();
+
+signals:
+
+    void queryChanged();
+    void searchingChanged();
+    void countChanged();
+
+    /**
+     * @brief Emitted when a workspace has answered the current query
+     * @param workspace Name of the workspace
+     * @param hits Number of hits it answered with
+     */
+    void workspaceAnswered(const QString &workspace, int hits);
+
+    /**
+     * @brief Emitted when all workspaces have answered and the results are complete
+     */
+    void finished();
+
+private:
+
+    struct StoreIndex;
+
+    /**
+     * @brief A searched workspace
+     */
+    struct Workspace
+    {
+        QString name;                       ///< Name shown with its results
+        QPointer<TaskModel> model;          ///< Tasks of a loaded workspace
+        QString directory;                  ///< Store of a workspace that is not loaded
+        std::shared_ptr<StoreIndex> index;  ///< Index of the store, shared with running searches
+    };
+
+    QList<Workspace> spaces;            ///< Workspaces in the order they were added
+    QString text;                       ///< Current query
+    QList<Hit> rows;                    ///< Results so far, in order
+    QList<QList<Hit>> arrived;          ///< Answers not merged into the rows yet
+    QTimer mergeTimer;                  ///< Merges the answers of one event loop pass together
+    quint64 generation = 0;             ///< Incremented by every query; stale answers are dropped
+    int pending = 0;                    ///< Stored workspaces yet to answer the current query
+    bool searching = false;             ///< Set until the last answer is merged
+
+    static QList<Hit> searchStore(const QString &name, const QString &directory,
+                                  const std::shared_ptr<StoreIndex> &index, const QString &text);
+    static void sortHits(QList<Hit> &hits);
+    void flush();
+};
@@ -0,0 +1,182 @@
+#include "PasteImportModel.h"
+#include "TaskModel.h"
+
+#include <QClipboard>
+#include <QFutureWatcher>
+#include <QGuiApplication>
+#include <QtConcurrent/QtConcurrentRun>
+
+PasteImportModel::PasteImportModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void PasteImportModel::attach(TaskModel *taskModel)
+{
+    model = taskModel;
+}
+
+void PasteImportModel::setText(const QString &text)
+{
+    source = text;
+    const quint64 asked = ++generation;
+    const bool wasParsing = running;
+    running = true;
+
+    auto *watcher = new QFutureWatcher<QList<PasteParser::Entry>>(this);
+    connect(watcher, &QFutureWatcher<QList<PasteParser::Entry>>::finished, this, [this, watcher, asked]() {
+        watcher->deleteLater();
+        if (asked != generation)
+            return;
+
+        running = false;
+        source.clear();
+        adopt(watcher->result());
+        emit parsingChanged();
+        emit parsed();
+    });
+    watcher->setFuture(QtConcurrent::run([text, defaultPriority = priority]() {
+        return PasteParser::parse(text, defaultPriority);
+    }));
+    if (!wasParsing)
+        emit parsingChanged();
+}
+
+void PasteImportModel::pasteClipboard()
+{
+    setText(QGuiApplication::clipboard()->text());
+}
+
+bool PasteImportModel::clipboardHasList() const
+{
+    return PasteParser::isList(QGuiApplication::clipboard()->text());
+}
+
+bool PasteImportModel::removeEntry(int row)
+{
+    if (row < 0 || row >= entries.size())
+        return false;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    entries.removeAt(row);
+    endRemoveRows();
+    emit countChanged();
+    return true;
+}
+
+int PasteImportModel::commit()
+{
+    if (running || !model || entries.isEmpty())
+        return 0;
+
+    const QDateTime now = QDateTime::currentDateTime();
+    QList<TaskRecord> records;
+    records.reserve(entries.size());
+    for (const PasteParser::Entry &entry : std::as_const(entries))
+    {
+        TaskRecord record = TaskRecord(entry.title, entry.description, entry.priority, entry.completed, now)
+                                .withAssignee(entry.assignee);
+        if (entry.completed)
+            record = record.withCompletedAt(now);
+        records.append(record);
+    }
+
+    const int added = model->addTasks(records);
+    clear();
+    emit committed(added);
+    return added;
+}
+
+void PasteImportModel::clear()
+{
+    ++generation;
+    source.clear();
+    if (running)
+    {
+        running = false;
+        emit parsingChanged();
+    }
+    adopt({});
+}
+
+void PasteImportModel::setDefaultPriority(int value)
+{
+    if (value == priority || value < Task::Low || value > Task::High)
+        return;
+
+    priority = value;
+    emit defaultPriorityChanged();
+    if (running)
+    {
+        setText(source);
+        return;
+    }
+
+    for (PasteParser::Entry &entry : entries)
+    {
+        if (!entry.marked)
+            entry.priority = priority;
+    }
+    if (!entries.isEmpty())
+        emit dataChanged(index(0), index(count() - 1), {PriorityRole});
+}
+
+void PasteImportModel::adopt(const QList<PasteParser::Entry> &result)
+{
+    if (entries.isEmpty() && result.isEmpty())
+        return;
+
+    const int oldCount = count();
+    beginResetModel();
+    entries = result;
+    endResetModel();
+    if (oldCount != count())
+        emit countChanged();
+}
+
+int PasteImportModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return int(entries.size());
+}
+
+QVariant PasteImportModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= entries.size())
+        return QVariant();
+
+    const PasteParser::Entry &entry = entries[index.row()];
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    case TitleRole:
+        return entry.title;
+    case DescriptionRole:
+        return entry.description;
+    case PriorityRole:
+        return entry.priority;
+    case AssigneeRole:
+        return entry.assignee;
+    case TagsRole:
+        return entry.tags;
+    case CompletedRole:
+        return entry.completed;
+    case LineRole:
+        return entry.line;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> PasteImportModel::roleNames() const
+{
+    return {
+        {TitleRole, "title"},
+        {DescriptionRole, "description"},
+        {PriorityRole, "priority"},
+        {AssigneeRole, "assignee"},
+        {TagsRole, "tags"},
+        {CompletedRole, "completed"},
+        {LineRole, "line"},
+    };
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include "PasteParser.h"
+
+class TaskModel;
+
+
+/**
+ * @file PasteImportModel.h
+ * @brief Preview of tasks pasted as a list, added to a TaskModel in one insertion
+ */
+
+/**
+ * @class PasteImportModel
+ * @brief The tasks of a pasted list, shown before they are added
+ *
+ * Pasting a spreadsheet column or meeting notes into the add dialog should make one task
+ * per line. setText() or pasteClipboard() parse the text with PasteParser on the global
+ * thread pool, so a paste of thousands of lines never blocks the GUI thread; the rows of
+ * the preview are replaced in one reset when the parse is done, and a text pasted while
+ * another is parsed replaces it. A ListView shows the rows through delegates for the
+ * visible ones only, however long the list is.
+ *
+ * commit() adds the rows to the attached TaskModel with one TaskModel::addTasks() call:
+ * one row insertion for views and one autosave of the TaskStore for the whole list.
+ *
+ * Example usage (QML):
+ * @code
+ * ListView {
+ *     model: taskController.pasteImport
+ *     delegate: Label { text: title + (assignee ? " @" + assignee : "") }
+ * }
+ * Button { text: qsTr("Add %1 tasks").arg(taskController.pasteImport.count); onClicked: taskController.pasteImport.commit() }
+ * @endcode
+ */
+class PasteImportModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /**
+     * @property count
+     * @brief The number of tasks in the preview
+     */
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    /**
+     * @property parsing
+     * @brief Whether a pasted text is being parsed
+     */
+    Q_PROPERTY(bool parsing READ isParsing NOTIFY parsingChanged)
+
+    /**
+     * @property defaultPriority
+     * @brief Priority of the rows without a priority marker, medium by default
+     */
+    Q_PROPERTY(int defaultPriority READ defaultPriority WRITE setDefaultPriority NOTIFY defaultPriorityChanged)
+
+public:
+
+    /**
+     * @brief Roles of the previewed tasks
+     */
+    enum Roles
+    {
+        TitleRole = Qt::UserRole + 1,   ///< Title without markers
+        DescriptionRole,                ///< Description
+        PriorityRole,                   ///< Task::Priority
+        AssigneeRole,                   ///< Assignee, empty if none
+        TagsRole,                       ///< Tags, as a list of names
+        CompletedRole,                  ///< Whether the task is added as completed
+        LineRole                        ///< Line of the pasted text, from 1
+    };
+
+    /**
+     * @brief Constructs an empty preview
+     * @param parent The parent QObject
+     */
+    explicit PasteImportModel(QObject *parent = nullptr);
+
+    /**
+     * @brief Sets the model that commit() adds the tasks to
+     * @param model The tasks, or nullptr to detach
+     */
+    void attach(TaskModel *model);
+
+    /**
+     * @brief Parses a pasted text into the preview, on a worker thread
+     * @param text The text, one task per line; see PasteParser
+     */
+    Q_INVOKABLE void setText(const QString &text);
+
+    /**
+     * @brief Parses the text of the clipboard into the preview, see setText()
+     */
+    Q_INVOKABLE void pasteClipboard();
+
+    /**
+     * @brief Checks if the clipboard holds a list, i.e. more than one non-blank line
+     */
+    Q_INVOKABLE bool clipboardHasList() const;
+
+    /**
+     * @brief Drops a row from the preview
+     * @param row The row
+     * @return false if there is no such row
+     */
+    Q_INVOKABLE bool removeEntry(int row);
+
+    /**
+     * @brief Adds the previewed tasks to the attached model and empties the preview
+     * @return The number of tasks added; 0 while parsing, or without a model or rows
+     */
+    Q_INVOKABLE int commit();
+
+    /**
+     * @brief Empties the preview and drops a running parse
+     */
+    Q_INVOKABLE void clear();
+
+    int count() const { return int(entries.size()); }
+    bool isParsing() const { return running; }
+    int defaultPriority() const { return priority; }
+    void setDefaultPriority(int value);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+signals:
+
+    void countChanged();
+    void parsingChanged();
+    void defaultPriorityChanged();
+
+    /**
+     * @brief Emitted when a pasted text is parsed and its rows are in place
+     */
+    void parsed();
+
+    /**
+     * @brief Emitted after commit() added tasks
+     * @param count Number of tasks added
+     */
+    void committed(int count);
+
+private:
+
+    QPointer<TaskModel> model;              ///< Model the tasks are added to
+    QList<PasteParser::Entry> entries;      ///< Previewed tasks
+    QString source;                         ///< Text being parsed, parsed again for a new default priority
+    int priority = 1;                       ///< Priority of rows without a marker
+    quint64 generation = 0;                 ///< Incremented for every text; stale parses are dropped
+    bool running = false;                   ///< Set while a text is parsed
+
+    /**
+     * @brief Replaces the rows with a finished parse
+     */
+    void adopt(const QList<PasteParser::Entry> &result);
+};
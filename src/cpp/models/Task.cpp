@@ -1,4 +1,5 @@
 #include "Task.h"
+#include "Metrics.h"
 
 Task::Task(QObject *parent)
     : QObject(parent), completed(false), createdAt(QDateTime::currentDateTime()), priority(Medium)
@@ -10,22 +11,88 @@ Task::Task(const QString &title, const QString &description, QObject *parent)
 {
 }
 
+Task::Task(const TaskRecord &record, QObject *parent)
+    : QObject(parent), title(record.getTitle()), description(record.getDescription()), completed(record.getCompleted()),
+      createdAt(record.getDateTime().isValid() ? record.getDateTime() : QDateTime::currentDateTime()), priority(record.getPriority()), id(record.getId()),
+      completedAt(record.getCompleted() ? record.getCompletedAt() : QDateTime()), assignee(record.getAssignee().trimmed()),
+      estimate(qMax(0, record.getEstimate()))
+{
+    setDependencies(record.getDependencies());
+}
+
 void Task::setTitle(const QString &ttl)
 {
     if (title != ttl)
     {
         title = ttl;
+        cachedRecord = TaskRecord();
+        if (observer)
+            observer->taskChanged(this, TaskObserver::Title);
         emit titleChanged();
     }
 }
 
+QString Task::getDescription() const
+{
+    const bool cached = !cachedDescription.isNull();
+    Metrics::registry().hit(Metrics::FlatDescription, cached);
+    if (!cached)
+        cachedDescription = description.toString();
+    return cachedDescription;
+}
+
 void Task::setDescription(const QString &desc)
 {
-    if (description != desc)
-    {
-        description = desc;
-        emit descriptionChanged();
-    }
+    const QString current = getDescription();
+    if (current == desc)
+        return;
+
+    // Report only the span between the common prefix and suffix, so a full replace that
+    // changes one word is logged and re-rendered as that word.
+    const qsizetype shorter = qMin(current.size(), desc.size());
+    qsizetype prefix = 0;
+    while (prefix < shorter && current[prefix] == desc[prefix])
+        ++prefix;
+    qsizetype suffix = 0;
+    while (suffix < shorter - prefix && current[current.size() - 1 - suffix] == desc[desc.size() - 1 - suffix])
+        ++suffix;
+    // Never split a surrogate pair, so the span is valid text on its own.
+    if (prefix > 0 && desc[prefix - 1].isHighSurrogate())
+        --prefix;
+    if (suffix > 0 && desc[desc.size() - suffix].isLowSurrogate())
+        --suffix;
+
+    const qsizetype removed = current.size() - prefix - suffix;
+    const qsizetype added = desc.size() - prefix - suffix;
+    description.replace(prefix, removed, desc.mid(prefix, added));
+    cachedDescription = desc;
+    cachedRecord = TaskRecord();
+    if (observer)
+        observer->taskDescriptionEdited(this, int(prefix), int(removed), int(added));
+    emit descriptionEdited(int(prefix), int(removed), int(added));
+    emit descriptionChanged();
+}
+
+void Task::editDescription(int position, int removed, const QString &text)
+{
+    const qsizetype length = description.size();
+    position = qBound(0, position, int(length));
+    removed = qBound(0, removed, int(length) - position);
+    if (removed == 0 && text.isEmpty())
+        return;
+
+    description.replace(position, removed, text);
+    cachedDescription = QString();
+    cachedRecord = TaskRecord();
+    if (observer)
+        observer->taskDescriptionEdited(this, position, removed, int(text.size()));
+    emit descriptionEdited(position, removed, int(text.size()));
+    emit descriptionChanged();
+}
+
+QString Task::descriptionText(int position, int length) const
+{
+    return description.mid(position, length);
 }
 
 void Task::setCompleted(bool comp)
@@ -33,6 +100,10 @@ void Task::setCompleted(bool comp)
     if (completed != comp)
     {
         completed = comp;
+        completedAt = comp ? QDateTime::currentDateTime() : QDateTime();
+        cachedRecord = TaskRecord();
+        if (observer)
+            observer->taskChanged(this, TaskObserver::Completed);
         emit completedChanged();
     }
 }
@@ -42,10 +113,59 @@ void Task::setPriority(int prio)
     if (priority >= Low && priority <= High && priority != prio)
     {
         priority = prio;
+        cachedRecord = TaskRecord();
+        if (observer)
+            observer->taskChanged(this, TaskObserver::Priority);
         emit priorityChanged();
     }
 }
 
+void Task::setAssignee(const QString &name)
+{
+    const QString trimmed = name.trimmed();
+    if (assignee != trimmed)
+    {
+        assignee = trimmed;
+        cachedRecord = TaskRecord();
+        if (observer)
+            observer->taskChanged(this, TaskObserver::Assignee);
+        emit assigneeChanged();
+    }
+}
+
+void Task::setEstimate(int hours)
+{
+    hours = qMax(0, hours);
+    if (estimate != hours)
+    {
+        estimate = hours;
+        cachedRecord = TaskRecord();
+        if (observer)
+            observer->taskChanged(this, TaskObserver::Estimate);
+        emit estimateChanged();
+    }
+}
+
+void Task::setDependencies(const QList<quint64> &ids)
+{
+    QList<quint64> unique;
+    unique.reserve(ids.size());
+    for (quint64 other : ids)
+    {
+        if (other != 0 && other != id && !unique.contains(other))
+            unique.append(other);
+    }
+
+    if (dependencies != unique)
+    {
+        dependencies = unique;
+        cachedRecord = TaskRecord();
+        if (observer)
+            observer->taskChanged(this, TaskObserver::Dependencies);
+        emit dependenciesChanged();
+    }
+}
+
 bool Task::isValid() const
 {
     return !title.trimmed().isEmpty();
@@ -65,3 +185,16 @@ QString Task::priorityString() const
         return "Unknown";
     }
 }
+
+TaskRecord Task::record() const
+{
+    const bool cached = !cachedRecord.isNull();
+    Metrics::registry().hit(Metrics::RecordSnapshot, cached);
+    if (!cached)
+        cachedRecord = TaskRecord(title, getDescription(), priority, completed, createdAt, id)
+                           .withCompletedAt(completedAt)
+                           .withAssignee(assignee)
+                           .withEstimate(estimate)
+                           .withDependencies(dependencies);
+    return cachedRecord;
+}
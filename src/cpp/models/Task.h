@@ -3,6 +3,11 @@
 #include <QObject>
 #include <QString>
 #include <QDateTime>
+#include "TaskRecord.h"
+#include "TextRope.h"
+
+class TaskModel;
+class Task;
 
 
 /**
@@ -10,6 +15,52 @@
  * @brief Task entity class for task management applications
  */
 
+/**
+ * @class TaskObserver
+ * @brief Receives the changes of the tasks owned by a model through plain virtual calls
+ *
+ * The owning model registers itself with every task it adopts instead of connecting to
+ * each of the task's change signals: a task costs one pointer instead of a connection
+ * per property, and freeing a task has no connections to tear down. The observer is
+ * notified before the corresponding signal is emitted.
+ */
+class TaskObserver
+{
+public:
+
+    /**
+     * @enum Change
+     * @brief The property of a task that changed
+     */
+    enum Change
+    {
+        Title,        ///< title was set
+        Completed,    ///< completed (and completedAt) changed
+        Priority,     ///< priority was set
+        Assignee,     ///< assignee was set
+        Estimate,     ///< estimate was set
+        Dependencies  ///< dependencies were set
+    };
+
+    virtual ~TaskObserver() = default;
+
+    /**
+     * @brief Called when a property of an observed task changed
+     * @param task The task that changed
+     * @param change The property that changed
+     */
+    virtual void taskChanged(Task *task, Change change) = 0;
+
+    /**
+     * @brief Called when the description of an observed task was edited
+     * @param task The task whose description was edited
+     * @param position Offset at which the edit starts
+     * @param removed Number of characters removed
+     * @param added Number of characters inserted
+     */
+    virtual void taskDescriptionEdited(Task *task, int position, int removed, int added) = 0;
+};
+
 /**
  * @class Task
  * @brief Represents a single task with title, description, completion status, and priority
@@ -31,6 +82,7 @@
  * qDebug() << "Priority:" << task->priorityString();
  * @endcode
  */
+
 class Task : public QObject
 {
     Q_OBJECT
@@ -82,15 +134,75 @@ class Task : public QObject
      */
     Q_PROPERTY(int priority READ getPriority WRITE setPriority NOTIFY priorityChanged)
 
+    /**
+     * @property id
+     * @brief Stable identifier of the task
+     *
+     * Read-only property assigned by the TaskModel the task is inserted into. Unlike the
+     * row index, the id does not change when other tasks are added or removed.
+     * Tasks that were never inserted into a model have id 0.
+     */
+    Q_PROPERTY(quint64 id READ getId CONSTANT)
+
+    /**
+     * @property completedAt
+     * @brief Timestamp when the task was last completed
+     *
+     * Set by setCompleted(true) and cleared when the task is reopened. Invalid for
+     * pending tasks and for tasks created as completed without a timestamp.
+     */
+    Q_PROPERTY(QDateTime completedAt READ getCompletedAt NOTIFY completedChanged)
+
+    /**
+     * @property assignee
+     * @brief Name of the person the task is assigned to
+     *
+     * Empty for unassigned tasks. This property is read-write and emits assigneeChanged()
+     * when modified. In a model, the name is interned: tasks of the same person share it.
+     */
+    Q_PROPERTY(QString assignee READ getAssignee WRITE setAssignee NOTIFY assigneeChanged)
+
+    /**
+     * @property estimate
+     * @brief Estimated effort in hours
+     *
+     * 0 if the task is not estimated; scheduled as a milestone then. This property is
+     * read-write and emits estimateChanged() when modified.
+     */
+    Q_PROPERTY(int estimate READ getEstimate WRITE setEstimate NOTIFY estimateChanged)
+
+    /**
+     * @property dependencies
+     * @brief Ids of the tasks that must be finished before this one can start
+     *
+     * This property is read-write and emits dependenciesChanged() when modified.
+     */
+    Q_PROPERTY(QList<quint64> dependencies READ getDependencies WRITE setDependencies NOTIFY dependenciesChanged)
+
 
 private:
 
+    friend class TaskModel;
+
 
     QString title;        ///< Internal storage for task title
-    QString description;  ///< Internal storage for task description
+    TextRope description; ///< Internal storage for task description, chunked for incremental edits
     bool completed;       ///< Internal storage for completion status
     QDateTime createdAt;  ///< Internal storage for creation timestamp
     int priority;         ///< Internal storage for priority level
+    quint64 id = 0;       ///< Internal storage for the model-assigned identifier
+    QDateTime completedAt; ///< Internal storage for the completion timestamp
+    QString assignee;     ///< Internal storage for the assignee name
+    quint32 person = 0;   ///< Interned id of the assignee in the owning model; 0 if unassigned
+    int estimate = 0;     ///< Internal storage for the estimate in hours
+    QList<quint64> dependencies; ///< Internal storage for the ids of the prerequisite tasks
+
+    mutable TaskRecord cachedRecord; ///< Snapshot returned by record(); reset by every setter
+    mutable QString cachedDescription; ///< Flattened description; null until needed after an edit
+    QDateTime deletedAt;  ///< Time the task was moved to the trash; invalid while live
+    bool compacted = false; ///< Whether the model dropped the row of the deleted task
+    int row = -1;         ///< Row in the owning model; -1 while the task has none
+    TaskObserver *observer = nullptr; ///< The owning model, notified of every change; null while unowned
 
 public:
 
@@ -129,6 +241,16 @@ public:
      */
     Task(const QString &title, const QString &description = QString(), QObject *parent = nullptr);
 
+    /**
+     * @brief Constructor for creating a task from a record
+     * @param record The values for the new task
+     * @param parent The parent QObject, typically nullptr or the owning object
+     *
+     * Creates a task with all values taken from the record, including its id. If the
+     * record has no valid creation timestamp, createdAt is set to the current date/time.
+     */
+    explicit Task(const TaskRecord &record, QObject *parent = nullptr);
+
     // Getters
     /**
      * @brief Gets the task getTitle
@@ -143,8 +265,9 @@ public:
      * @return The current getDescription of the task
      *
      * This is the getter function for the getDescription Q_PROPERTY.
+     * The description is flattened from its rope on the first call after an edit.
      */
-    QString getDescription() const { return description; }
+    QString getDescription() const;
 
     /**
      * @brief Gets the completion status
@@ -163,6 +286,36 @@ public:
      */
     QDateTime getDateTime() const { return createdAt; }
 
+    /**
+     * @brief Gets the completion timestamp
+     * @return QDateTime when the task was last completed, invalid if pending or unknown
+     */
+    QDateTime getCompletedAt() const { return completedAt; }
+
+    /**
+     * @brief Gets the name of the assignee
+     * @return The assignee, empty if the task is unassigned
+     *
+     * This is the getter function for the assignee Q_PROPERTY.
+     */
+    QString getAssignee() const { return assignee; }
+
+    /**
+     * @brief Gets the estimated effort
+     * @return The estimate in hours, 0 if not estimated
+     *
+     * This is the getter function for the estimate Q_PROPERTY.
+     */
+    int getEstimate() const { return estimate; }
+
+    /**
+     * @brief Gets the prerequisites of the task
+     * @return Ids of the tasks that must be finished first, without duplicates
+     *
+     * This is the getter function for the dependencies Q_PROPERTY.
+     */
+    QList<quint64> getDependencies() const { return dependencies; }
+
     /**
      * @brief Gets the priority level as an integer
      * @return Priority level (0=Low, 1=Medium, 2=High)
@@ -172,6 +325,26 @@ public:
      */
     int getPriority() const { return priority; }
 
+    /**
+     * @brief Gets the stable task identifier
+     * @return The id assigned by the owning TaskModel, or 0 if not yet inserted
+     *
+     * This is the getter function for the id Q_PROPERTY.
+     */
+    quint64 getId() const { return id; }
+
+    /**
+     * @brief Gets the time the task was moved to the trash
+     * @return The deletion timestamp, invalid if the task is not deleted
+     */
+    QDateTime getDeletedAt() const { return deletedAt; }
+
+    /**
+     * @brief Checks whether the task is in the trash of its model
+     * @return true if the task was deleted and can still be restored
+     */
+    bool isDeleted() const { return deletedAt.isValid(); }
+
     // Setters
 
     /**
@@ -188,7 +361,9 @@ public:
      * @param description The new description for the task
      *
      * Updates the task description and emits descriptionChanged() if the value actually changes.
-     * Empty descriptions are allowed and common for simple tasks.
+     * Empty descriptions are allowed and common for simple tasks. Only the span between the
+     * text the old and new description start and end with is replaced and reported through
+     * descriptionEdited().
      */
     void setDescription(const QString &description);
 
@@ -211,6 +386,33 @@ public:
      */
     void setPriority(int priority);
 
+    /**
+     * @brief Sets the assignee
+     * @param assignee Name of the person the task is assigned to; empty to unassign
+     *
+     * Updates the assignee and emits assigneeChanged() if the value actually changes.
+     * Leading and trailing whitespace is removed.
+     */
+    void setAssignee(const QString &assignee);
+
+    /**
+     * @brief Sets the estimated effort
+     * @param hours Estimate in hours; negative values are treated as 0
+     *
+     * Updates the estimate and emits estimateChanged() if the value actually changes.
+     */
+    void setEstimate(int hours);
+
+    /**
+     * @brief Sets the prerequisites of the task
+     * @param dependencies Ids of the tasks that must be finished first
+     *
+     * Duplicates and the task's own id are dropped. Emits dependenciesChanged() if the
+     * list actually changes. Whether the ids form a cycle is checked by the scheduler
+     * (see ScheduleGraph), not here.
+     */
+    void setDependencies(const QList<quint64> &dependencies);
+
     // Utility methods
     /**
      * @brief Checks if the task has valid/meaningful content
@@ -231,6 +433,57 @@ public:
      */
     Q_INVOKABLE QString priorityString() const;
 
+    // Incremental description editing
+    /**
+     * @brief Replaces a range of the description
+     * @param position Offset of the range to replace (clamped to the description)
+     * @param removed Number of characters to remove (clamped to the end of the description)
+     * @param text The text to insert at position
+     *
+     * Applies the edit to the description rope without rebuilding the whole string and
+     * emits descriptionEdited() with the edited span, followed by descriptionChanged().
+     * Intended for editor views working on long descriptions.
+     */
+    Q_INVOKABLE void editDescription(int position, int removed, const QString &text);
+
+    /**
+     * @brief Gets a range of the description
+     * @param position Offset of the first character
+     * @param length Number of characters to return
+     * @return The requested range, clamped to the description
+     */
+    Q_INVOKABLE QString descriptionText(int position, int length) const;
+
+    /**
+     * @brief Gets the length of the description in UTF-16 units
+     */
+    Q_INVOKABLE int descriptionLength() const { return int(description.size()); }
+
+    /**
+     * @brief Gets the number of lines in the description
+     */
+    Q_INVOKABLE int descriptionLineCount() const { return description.lineCount(); }
+
+    /**
+     * @brief Gets the zero-based line containing a description offset, in O(log n)
+     */
+    Q_INVOKABLE int descriptionLineAt(int offset) const { return description.lineAt(offset); }
+
+    /**
+     * @brief Gets the description offset at which a line starts, in O(log n)
+     * @return The offset, or -1 if the line does not exist
+     */
+    Q_INVOKABLE int descriptionLineStart(int line) const { return int(description.lineStart(line)); }
+
+    /**
+     * @brief Gets an immutable snapshot of the task
+     * @return TaskRecord holding the current values of the task
+     *
+     * The snapshot is built on first use after a change and then shared, so repeated
+     * calls without intervening modifications return the same record in O(1).
+     */
+    TaskRecord record() const;
+
 signals:
 
     /**
@@ -251,6 +504,17 @@ signals:
      */
     void descriptionChanged();
 
+    /**
+     * @brief Emitted when a span of the description has been replaced
+     * @param position Offset at which the edit starts
+     * @param removed Number of characters removed at position
+     * @param added Number of characters inserted at position
+     *
+     * Emitted by editDescription() and setDescription() (with the span that differs)
+     * before descriptionChanged(), so listeners can update only the edited span.
+     */
+    void descriptionEdited(int position, int removed, int added);
+
     /**
      * @brief Emitted when the task completion status changes
      *
@@ -269,5 +533,29 @@ signals:
      */
     void priorityChanged();
 
+    /**
+     * @brief Emitted when the task is assigned to someone else
+     *
+     * This signal is emitted by setAssignee() when the assignee actually changes.
+     * Connected to the assignee Q_PROPERTY for automatic QML property updates.
+     */
+    void assigneeChanged();
+
+    /**
+     * @brief Emitted when the estimate of the task changes
+     *
+     * This signal is emitted by setEstimate() when the estimate actually changes.
+     * Connected to the estimate Q_PROPERTY for automatic QML property updates.
+     */
+    void estimateChanged();
+
+    /**
+     * @brief Emitted when the prerequisites of the task change
+     *
+     * This signal is emitted by setDependencies() when the list actually changes.
+     * Connected to the dependencies Q_PROPERTY for automatic QML property updates.
+     */
+    void dependenciesChanged();
+
 
 };
@@ -1,8 +1,33 @@
 #include "TaskModel.h"
+#include "Metrics.h"
+#include "TrashModel.h"
+
+#include <QDebug>
+#include <QMetaMethod>
+#include <QSet>
+
+#include <algorithm>
 
 TaskModel::TaskModel(QObject *parent)
-    : QAbstractListModel(parent)
+    : QAbstractListModel(parent), trashModel(new TrashModel(this))
+{
+    scanner.setTextSource([this](int row, QString &title, QString &description) {
+        title = tasks[row]->getTitle();
+        description = tasks[row]->getDescription();
+    });
+
+    compactionTimer.setSingleShot(true);
+    connect(&compactionTimer, &QTimer::timeout, this, [this]() {
+        compactTombstones();
+        // Yield to the event loop between batches
+        if (tombstones > 0)
+            compactionTimer.start(0);
+    });
+}
+
+TaskModel::~TaskModel()
 {
+    releaseTasks(false);
 }
 
 int TaskModel::rowCount(const QModelIndex &parent) const
@@ -16,8 +41,11 @@ QVariant TaskModel::data(const QModelIndex &index, int role) const
     if (!index.isValid() || index.row() >= tasks.size())
         return QVariant();
 
-    Task *task = tasks[index.row()];
+    return taskData(tasks[index.row()], role);
+}
 
+QVariant TaskModel::taskData(const Task *task, int role)
+{
     switch (role)
     {
     case TitleRole:
@@ -30,8 +58,22 @@ QVariant TaskModel::data(const QModelIndex &index, int role) const
         return task->getDateTime();
     case PriorityRole:
         return task->getPriority();
-    case TaskObjectRole:
-        return QVariant::fromValue(task);
+    case RecordRole:
+        return QVariant::fromValue(task->record());
+    case IdRole:
+        return task->getId();
+    case CompletedAtRole:
+        return task->getCompletedAt();
+    case DeletedRole:
+        return task->isDeleted();
+    case DeletedAtRole:
+        return task->getDeletedAt();
+    case AssigneeRole:
+        return task->getAssignee();
+    case EstimateRole:
+        return task->getEstimate();
+    case DependenciesRole:
+        return QVariant::fromValue(task->getDependencies());
     }
 
     return QVariant();
@@ -39,7 +81,7 @@ QVariant TaskModel::data(const QModelIndex &index, int role) const
 
 bool TaskModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (!index.isValid() || index.row() >= tasks.size())
+    if (!index.isValid() || index.row() >= tasks.size() || tasks[index.row()]->isDeleted())
         return false;
 
     Task *task = tasks[index.row()];
@@ -58,11 +100,20 @@ bool TaskModel::setData(const QModelIndex &index, const QVariant &value, int rol
     case PriorityRole:
         task->setPriority(value.toInt());
         break;
+    case AssigneeRole:
+        task->setAssignee(value.toString());
+        break;
+    case EstimateRole:
+        task->setEstimate(value.toInt());
+        break;
+    case DependenciesRole:
+        task->setDependencies(value.value<QList<quint64>>());
+        break;
     default:
         return false;
     }
 
-    emit dataChanged(index, index, {role});
+    // The task's change signal has already been turned into dataChanged() for this role.
     return true;
 }
 
@@ -74,7 +125,14 @@ QHash<int, QByteArray> TaskModel::roleNames() const
     roles[CompletedRole] = "completed";
     roles[CreatedAtRole] = "createdAt";
     roles[PriorityRole] = "priority";
-    roles[TaskObjectRole] = "taskObject";
+    roles[RecordRole] = "record";
+    roles[IdRole] = "taskId";
+    roles[CompletedAtRole] = "completedAt";
+    roles[DeletedRole] = "deleted";
+    roles[DeletedAtRole] = "deletedAt";
+    roles[AssigneeRole] = "assignee";
+    roles[EstimateRole] = "estimate";
+    roles[DependenciesRole] = "dependencies";
     return roles;
 }
 
@@ -93,71 +151,798 @@ bool TaskModel::addTask(const QString &title, const QString &description)
 
     beginInsertRows(QModelIndex(), tasks.size(), tasks.size());
 
-    Task *task = new Task(title.trimmed(), description, this);
-    connect(task, &Task::titleChanged, this, &TaskModel::onTaskChanged);
-    connect(task, &Task::descriptionChanged, this, &TaskModel::onTaskChanged);
-    connect(task, &Task::completedChanged, this, &TaskModel::onTaskChanged);
-    connect(task, &Task::priorityChanged, this, &TaskModel::onTaskChanged);
+    // Tasks are owned through the tasks list rather than as QObject children, so that
+    // teardown can free them in bulk.
+    Task *task = new Task(title.trimmed(), description);
+    attachTask(task);
 
+    task->row = int(tasks.size());
+    scanner.insert(tasks.size(), task->getTitle(), task->getDescription());
     tasks.append(task);
     endInsertRows();
 
+    indexAssignees({task});
     emit countChanged();
     return true;
 }
 
+int TaskModel::addTasks(const QList<TaskRecord> &records)
+{
+    Metrics::ScopedTimer timer(Metrics::registry().latency[Metrics::BulkInsert]);
+    QList<Task *> accepted;
+    accepted.reserve(records.size());
+    for (const TaskRecord &record : records)
+    {
+        if (!record.isValid())
+            continue;
+
+        Task *task = new Task(record);
+        task->setTitle(record.getTitle().trimmed());
+        accepted.append(task);
+    }
+
+    if (accepted.isEmpty())
+        return 0;
+
+    beginInsertRows(QModelIndex(), tasks.size(), tasks.size() + accepted.size() - 1);
+    tasks.reserve(tasks.size() + accepted.size());
+    for (Task *task : std::as_const(accepted))
+    {
+        attachTask(task);
+        task->row = int(tasks.size());
+        scanner.insert(tasks.size(), task->getTitle(), task->getDescription());
+        tasks.append(task);
+    }
+    endInsertRows();
+
+    indexAssignees(accepted);
+    emit countChanged();
+    return accepted.size();
+}
+
+bool TaskModel::addTaskSet(const QList<TaskRecord> &records)
+{
+    // Checked up front: addTasks() would skip an invalid record and renumber a taken id.
+    QSet<quint64> ids;
+    for (const TaskRecord &record : records)
+    {
+        if (!record.isValid())
+        {
+            qWarning() << "TaskModel::addTaskSet: task without a title";
+            return false;
+        }
+
+        const quint64 id = record.getId();
+        if (id != 0 && (tasksById.contains(id) || ids.contains(id)))
+        {
+            qWarning() << "TaskModel::addTaskSet: task id" << id << "is already taken";
+            return false;
+        }
+        ids.insert(id);
+    }
+
+    return records.isEmpty() || addTasks(records) == records.size();
+}
+
+quint64 TaskModel::reserveTaskIds(int count)
+{
+    const quint64 first = nextTaskId;
+    nextTaskId += quint64(qMax(0, count));
+    return first;
+}
+
+void TaskModel::attachTask(Task *task)
+{
+    if (task->id == 0 || tasksById.contains(task->id))
+        task->id = nextTaskId++;
+    else
+        nextTaskId = qMax(nextTaskId, task->id + 1);
+    task->cachedRecord = TaskRecord();
+    tasksById.insert(task->id, task);
+
+    // One pointer instead of a connection per property: nothing to tear down when the
+    // task is freed.
+    task->observer = this;
+}
+
+void TaskModel::indexAssignees(const QList<Task *> &added)
+{
+    if (added.size() == 1)
+    {
+        Task *task = added.first();
+        task->person = assigneeIndex.intern(task->assignee);
+        task->assignee = assigneeIndex.name(task->person);
+
+        AssigneeModel *view = assigneeModels.value(task->person);
+        const bool first = assigneeIndex.postings(task->person).isEmpty();
+        const int row = assigneeIndex.position(task->person, task->id);
+        if (view)
+            view->beginInsertRows(QModelIndex(), row, row);
+        assigneeIndex.insert(task->person, task->id, task->completed);
+        if (view)
+        {
+            view->endInsertRows();
+            emit view->countChanged();
+        }
+
+        notifyWorkload(task->person);
+        if (first && task->person != 0)
+            emit assigneesChanged();
+        return;
+    }
+
+    // Interning first tells which lists change, so each is reset once.
+    QList<quint32> people;
+    bool firsts = false;
+    for (Task *task : added)
+    {
+        task->person = assigneeIndex.intern(task->assignee);
+        task->assignee = assigneeIndex.name(task->person);
+        if (!people.contains(task->person))
+        {
+            people.append(task->person);
+            firsts = firsts || (task->person != 0 && assigneeIndex.postings(task->person).isEmpty());
+        }
+    }
+
+    for (quint32 person : std::as_const(people))
+    {
+        if (AssigneeModel *view = assigneeModels.value(person))
+            view->beginResetModel();
+    }
+    for (const Task *task : added)
+        assigneeIndex.insert(task->person, task->id, task->completed);
+    for (quint32 person : std::as_const(people))
+    {
+        if (AssigneeModel *view = assigneeModels.value(person))
+        {
+            view->endResetModel();
+            emit view->countChanged();
+        }
+        notifyWorkload(person);
+    }
+    if (firsts)
+        emit assigneesChanged();
+}
+
+void TaskModel::unindexAssignees(const QList<Task *> &removed)
+{
+    if (removed.size() == 1)
+    {
+        const Task *task = removed.first();
+        const QList<quint64> &ids = assigneeIndex.postings(task->person);
+        const int row = assigneeIndex.position(task->person, task->id);
+        if (row >= ids.size() || ids[row] != task->id)
+            return;
+
+        AssigneeModel *view = assigneeModels.value(task->person);
+        if (view)
+            view->beginRemoveRows(QModelIndex(), row, row);
+        assigneeIndex.remove(task->person, task->id, task->completed);
+        if (view)
+        {
+            view->endRemoveRows();
+            emit view->countChanged();
+        }
+
+        notifyWorkload(task->person);
+        if (task->person != 0 && ids.isEmpty())
+            emit assigneesChanged();
+        return;
+    }
+
+    QList<quint32> people;
+    for (const Task *task : removed)
+    {
+        if (!people.contains(task->person))
+            people.append(task->person);
+    }
+
+    for (quint32 person : std::as_const(people))
+    {
+        if (AssigneeModel *view = assigneeModels.value(person))
+            view->beginResetModel();
+    }
+    for (const Task *task : removed)
+        assigneeIndex.remove(task->person, task->id, task->completed);
+    bool lasts = false;
+    for (quint32 person : std::as_const(people))
+    {
+        if (AssigneeModel *view = assigneeModels.value(person))
+        {
+            view->endResetModel();
+            emit view->countChanged();
+        }
+        notifyWorkload(person);
+        lasts = lasts || (person != 0 && assigneeIndex.postings(person).isEmpty());
+    }
+    if (lasts)
+        emit assigneesChanged();
+}
+
+void TaskModel::notifyWorkload(quint32 person)
+{
+    if (AssigneeModel *view = assigneeModels.value(person))
+        emit view->workloadChanged();
+    emit workloadChanged(assigneeIndex.name(person));
+}
+
 bool TaskModel::removeTask(int index)
 {
-    if (index < 0 || index >= tasks.size())
+    if (index < 0 || index >= tasks.size() || tasks[index]->isDeleted())
         return false;
 
-    beginRemoveRows(QModelIndex(), index, index);
-    Task *task = tasks.takeAt(index);
-    task->deleteLater();
-    endRemoveRows();
+    moveToTrash({index});
+    return true;
+}
+
+void TaskModel::moveToTrash(const QList<int> &rows)
+{
+    if (rows.isEmpty())
+        return;
+
+    // The trash lists the latest deletion first, so new entries go to its top.
+    const QDateTime now = QDateTime::currentDateTime();
+    QList<Task *> trashed;
+    trashed.reserve(rows.size());
+    trashModel->beginInsertRows(QModelIndex(), 0, int(rows.size()) - 1);
+    deletedTasks.reserve(deletedTasks.size() + rows.size());
+    for (int row : rows)
+    {
+        Task *task = tasks[row];
+        task->deletedAt = now;
+        deletedTasks.append(task);
+        trashed.append(task);
+    }
+    tombstones += int(rows.size());
+    trashModel->endInsertRows();
 
+    // Tasks in the trash count for nobody.
+    unindexAssignees(trashed);
+
+    emitRangesChanged(rows, {DeletedRole, DeletedAtRole});
     emit countChanged();
+    emit trashModel->countChanged();
+
+    if (!deferCompaction)
+    {
+        compactTombstones(tombstones);
+        return;
+    }
+
+    // Restarted by every delete, so a burst of deletes is compacted once it is over.
+    compactionTimer.start(CompactionDelay);
+}
+
+bool TaskModel::isDeleted(int index) const
+{
+    return index >= 0 && index < tasks.size() && tasks[index]->isDeleted();
+}
+
+bool TaskModel::restoreTask(quint64 id)
+{
+    Task *task = tasksById.value(id);
+    if (!task || !task->isDeleted())
+        return false;
+
+    // Recent deletions are at the end of the list, and the most likely to be restored.
+    const qsizetype position = deletedTasks.lastIndexOf(task);
+    const int trashRow = int(deletedTasks.size() - 1 - position);
+    trashModel->beginRemoveRows(QModelIndex(), trashRow, trashRow);
+    deletedTasks.remove(position);
+    trashModel->endRemoveRows();
+
+    task->deletedAt = QDateTime();
+    if (!task->compacted)
+    {
+        // Still in its row: lifting the tombstone is a data change, like the delete was.
+        --tombstones;
+        indexAssignees({task});
+        emitRangesChanged({task->row}, {DeletedRole, DeletedAtRole});
+        emit countChanged();
+        emit trashModel->countChanged();
+        return true;
+    }
+
+    // Compacted away: reinsert as a live row at the end.
+    task->compacted = false;
+    beginInsertRows(QModelIndex(), tasks.size(), tasks.size());
+    task->row = int(tasks.size());
+    scanner.insert(tasks.size(), task->getTitle(), task->getDescription());
+    tasks.append(task);
+    endInsertRows();
+
+    indexAssignees({task});
+    emit countChanged();
+    emit trashModel->countChanged();
     return true;
 }
 
+int TaskModel::emptyTrash()
+{
+    QList<quint64> ids;
+    ids.reserve(deletedTasks.size());
+    for (const Task *task : std::as_const(deletedTasks))
+        ids.append(task->getId());
+    return removeTasks(ids);
+}
+
+int TaskModel::compactTombstones(int limit)
+{
+    int removed = 0;
+
+    // Remove runs of consecutive tombstones from the back so earlier rows keep their index.
+    for (int end = int(tasks.size()); end > 0 && tombstones > 0 && removed < limit;)
+    {
+        if (!tasks[end - 1]->isDeleted())
+        {
+            --end;
+            continue;
+        }
+
+        int first = end - 1;
+        while (first > 0 && tasks[first - 1]->isDeleted() && end - first < limit - removed)
+            --first;
+
+        const int count = end - first;
+        beginRemoveRows(QModelIndex(), first, end - 1);
+        for (int row = first; row < end; ++row)
+        {
+            tasks[row]->compacted = true;
+            tasks[row]->row = -1;
+        }
+        tasks.remove(first, count);
+        scanner.remove(first, count);
+        tombstones -= count;
+        renumberRows(first);
+        endRemoveRows();
+
+        removed += count;
+        end = first;
+    }
+
+    return removed;
+}
+
+void TaskModel::setCompactionDeferred(bool deferred)
+{
+    deferCompaction = deferred;
+    if (!deferred && tombstones > 0)
+    {
+        compactionTimer.stop();
+        compactTombstones(tombstones);
+    }
+}
+
+QList<int> TaskModel::rowsOfTasks(const QList<quint64> &ids) const
+{
+    QList<int> rows;
+    rows.reserve(ids.size());
+    for (quint64 id : ids)
+    {
+        // Compacted tasks are only in the trash and have no row.
+        const Task *task = tasksById.value(id);
+        if (task && task->row >= 0)
+            rows.append(task->row);
+    }
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
+}
+
+void TaskModel::renumberRows(int from)
+{
+    for (int row = from; row < tasks.size(); ++row)
+        tasks[row]->row = row;
+}
+
+void TaskModel::emitRangesChanged(const QList<int> &rows, const QList<int> &roles)
+{
+    for (qsizetype i = 0; i < rows.size();)
+    {
+        qsizetype end = i + 1;
+        while (end < rows.size() && rows[end] == rows[end - 1] + 1)
+            ++end;
+        emit dataChanged(createIndex(rows[i], 0), createIndex(rows[end - 1], 0), roles);
+        i = end;
+    }
+}
+
+int TaskModel::removeTasks(const QList<quint64> &ids)
+{
+    Metrics::ScopedTimer timer(Metrics::registry().latency[Metrics::BulkRemove]);
+    const QList<int> rows = rowsOfTasks(ids);
+
+    QList<Task *> released;
+    released.reserve(rows.size());
+    for (quint64 id : ids)
+    {
+        Task *task = tasksById.value(id);
+        if (task && task->compacted)
+        {
+            tasksById.remove(id);
+            released.append(task);
+        }
+    }
+
+    if (rows.isEmpty() && released.isEmpty())
+        return 0;
+
+    int purged = int(released.size());
+
+    QList<Task *> live;
+    for (int row : rows)
+    {
+        if (!tasks[row]->isDeleted())
+            live.append(tasks[row]);
+    }
+    unindexAssignees(live);
+
+    // Remove runs of consecutive rows from the back so earlier rows keep their index.
+    for (qsizetype end = rows.size(); end > 0;)
+    {
+        qsizetype begin = end - 1;
+        while (begin > 0 && rows[begin - 1] == rows[begin] - 1)
+            --begin;
+
+        const int first = rows[begin];
+        const int count = int(end - begin);
+        beginRemoveRows(QModelIndex(), first, first + count - 1);
+        for (int row = first; row < first + count; ++row)
+        {
+            Task *task = tasks[row];
+            tasksById.remove(task->getId());
+            if (task->isDeleted())
+            {
+                --tombstones;
+                ++purged;
+            }
+            released.append(task);
+        }
+        tasks.remove(first, count);
+        scanner.remove(first, count);
+        renumberRows(first);
+        endRemoveRows();
+
+        end = begin;
+    }
+
+    if (purged > 0)
+    {
+        // Purged tasks are no longer in tasksById; drop them from the trash in one pass.
+        trashModel->beginResetModel();
+        deletedTasks.removeIf([this](const Task *task) { return !tasksById.contains(task->getId()); });
+        trashModel->endResetModel();
+        emit trashModel->countChanged();
+    }
+    if (released.size() > purged)
+        emit countChanged();
+
+    qDeleteAll(released);
+
+    return int(released.size());
+}
+
+int TaskModel::trashTasks(const QList<quint64> &ids)
+{
+    QList<int> rows = rowsOfTasks(ids);
+    rows.removeIf([this](int row) { return tasks[row]->isDeleted(); });
+    moveToTrash(rows);
+    return int(rows.size());
+}
+
+int TaskModel::setTasksPriority(const QList<quint64> &ids, int priority)
+{
+    QList<int> changed;
+    batchUpdate = true;
+    for (int row : rowsOfTasks(ids))
+    {
+        Task *task = tasks[row];
+        const int previous = task->getPriority();
+        task->setPriority(priority);
+        if (task->getPriority() != previous)
+            changed.append(row);
+    }
+    batchUpdate = false;
+
+    emitRangesChanged(changed, {PriorityRole, RecordRole});
+    return changed.size();
+}
+
 void TaskModel::toggleCompleted(int index)
 {
-    if (index < 0 || index >= tasks.size())
+    if (index < 0 || index >= tasks.size() || tasks[index]->isDeleted())
         return;
 
     Task *task = tasks[index];
     task->setCompleted(!task->getCompleted());
 }
 
+bool TaskModel::editDescription(int index, int position, int removed, const QString &text)
+{
+    if (index < 0 || index >= tasks.size() || tasks[index]->isDeleted())
+        return false;
+
+    tasks[index]->editDescription(position, removed, text);
+    return true;
+}
+
 void TaskModel::clearCompleted()
 {
-    for (int i = tasks.size() - 1; i >= 0; --i)
+    QList<int> rows;
+    for (int row = 0; row < tasks.size(); ++row)
+    {
+        if (tasks[row]->getCompleted() && !tasks[row]->isDeleted())
+            rows.append(row);
+    }
+    moveToTrash(rows);
+}
+
+void TaskModel::clear()
+{
+    releaseTasks(true);
+}
+
+void TaskModel::releaseTasks(bool notifyViews)
+{
+    compactionTimer.stop();
+    if (tasks.isEmpty() && deletedTasks.isEmpty())
+        return;
+
+    // Views listen for resets; if none is connected, announcing one is wasted work.
+    const bool resetViews = notifyViews
+        && isSignalConnected(QMetaMethod::fromSignal(&QAbstractItemModel::modelAboutToBeReset));
+    if (resetViews)
+        beginResetModel();
+    if (notifyViews)
     {
-        if (tasks[i]->getCompleted())
+        trashModel->beginResetModel();
+        for (AssigneeModel *view : std::as_const(assigneeModels))
+            view->beginResetModel();
+    }
+    const QList<quint32> assigned = assigneeIndex.assigned();
+
+    QList<Task *> released;
+    released.swap(tasks);
+    for (Task *task : std::as_const(deletedTasks))
+    {
+        if (task->compacted)
+            released.append(task);
+    }
+    deletedTasks.clear();
+    tombstones = 0;
+    tasksById.clear();
+    scanner.clear();
+    assigneeIndex.clear();
+
+    // The model observes its tasks without connections, so there is nothing to disconnect.
+    qDeleteAll(released);
+
+    if (resetViews)
+        endResetModel();
+
+    if (notifyViews)
+    {
+        trashModel->endResetModel();
+        for (AssigneeModel *view : std::as_const(assigneeModels))
         {
-            removeTask(i);
+            view->endResetModel();
+            emit view->countChanged();
         }
+        emit countChanged();
+        emit trashModel->countChanged();
+        for (quint32 person : assigned)
+            notifyWorkload(person);
+        if (!assigned.isEmpty() && assigned != QList<quint32>{0})
+            emit assigneesChanged();
     }
 }
 
-Task *TaskModel::getTask(int index) const
+TaskRecord TaskModel::getTask(int index) const
+{
+    if (index < 0 || index >= tasks.size())
+        return TaskRecord();
+
+    return tasks[index]->record();
+}
+
+QList<TaskRecord> TaskModel::getTasks(const QList<int> &indices) const
+{
+    QList<TaskRecord> records;
+    records.reserve(indices.size());
+    for (int index : indices)
+        records.append(getTask(index));
+    return records;
+}
+
+TaskRecord TaskModel::getTaskById(quint64 id) const
+{
+    const Task *task = tasksById.value(id);
+    return task ? task->record() : TaskRecord();
+}
+
+const Task *TaskModel::taskById(quint64 id) const
+{
+    return tasksById.value(id);
+}
+
+quint64 TaskModel::taskId(int index) const
 {
     if (index < 0 || index >= tasks.size())
-        return nullptr;
+        return 0;
+
+    return tasks[index]->getId();
+}
+
+int TaskModel::indexOfTask(quint64 id) const
+{
+    Task *task = tasksById.value(id);
+    return task && !task->isDeleted() ? task->row : -1;
+}
+
+QString TaskModel::descriptionText(int index, int position, int length) const
+{
+    if (index < 0 || index >= tasks.size())
+        return QString();
+
+    return tasks[index]->descriptionText(position, length);
+}
+
+QList<int> TaskModel::findTasks(const QString &text) const
+{
+    Metrics::ScopedTimer timer(Metrics::registry().latency[Metrics::Search]);
+    QList<int> rows = scanner.find(text);
+    if (tombstones > 0)
+        rows.removeIf([this](int row) { return tasks[row]->isDeleted(); });
+    return rows;
+}
+
+QStringList TaskModel::assignees() const
+{
+    QStringList names;
+    for (quint32 person : assigneeIndex.assigned())
+    {
+        if (person != 0)
+            names.append(assigneeIndex.name(person));
+    }
+    return names;
+}
+
+AssigneeModel *TaskModel::assigneeTasks(const QString &assignee)
+{
+    const quint32 person = assigneeIndex.intern(assignee.trimmed());
+    AssigneeModel *&view = assigneeModels[person];
+    if (!view)
+    {
+        view = new AssigneeModel(this, person);
+        // Handed to QML through an invokable, which would otherwise take ownership.
+        QQmlEngine::setObjectOwnership(view, QQmlEngine::CppOwnership);
+    }
+    return view;
+}
 
-    return tasks[index];
+QList<quint64> TaskModel::tasksOfAssignee(const QString &assignee) const
+{
+    const qint64 person = assigneeIndex.find(assignee.trimmed());
+    return person >= 0 ? assigneeIndex.postings(quint32(person)) : QList<quint64>();
 }
 
-void TaskModel::onTaskChanged()
+int TaskModel::openTaskCount(const QString &assignee) const
 {
-    Task *task = qobject_cast<Task *>(sender());
-    if (!task)
+    const qint64 person = assigneeIndex.find(assignee.trimmed());
+    return person >= 0 ? assigneeIndex.workload(quint32(person)).open : 0;
+}
+
+int TaskModel::completedTaskCount(const QString &assignee) const
+{
+    const qint64 person = assigneeIndex.find(assignee.trimmed());
+    return person >= 0 ? assigneeIndex.workload(quint32(person)).completed : 0;
+}
+
+qint64 TaskModel::recordCacheSize() const
+{
+    qint64 bytes = 0;
+    for (const Task *task : tasks)
+    {
+        // The record shares its strings with the task, only the flattened description is extra.
+        if (!task->cachedRecord.isNull())
+            bytes += 64;
+        bytes += qint64(task->cachedDescription.capacity()) * qint64(sizeof(char16_t));
+    }
+    return bytes;
+}
+
+qint64 TaskModel::releaseRecordCache()
+{
+    const qint64 bytes = recordCacheSize();
+    for (Task *task : std::as_const(tasks))
+    {
+        task->cachedRecord = TaskRecord();
+        task->cachedDescription = QString();
+    }
+    return bytes;
+}
+
+qint64 TaskModel::releaseSearchIndex()
+{
+    const qint64 bytes = scanner.memoryUsage();
+    scanner.release();
+    return bytes;
+}
+
+void TaskModel::onTaskChanged(Task *task, int role)
+{
+    // The index follows every live task, batched or not; tasks in the trash are not in it.
+    if (!task->isDeleted() && role == CompletedRole)
+    {
+        assigneeIndex.setCompleted(task->person, task->completed);
+        notifyWorkload(task->person);
+    }
+    else if (!task->isDeleted() && role == AssigneeRole)
+    {
+        // Only the postings of the former and the new assignee change.
+        unindexAssignees({task});
+        indexAssignees({task});
+    }
+
+    if (batchUpdate)
         return;
 
-    int index = tasks.indexOf(task);
+    int index = task->row;
+    if (index >= 0)
+    {
+        if (role == TitleRole)
+            scanner.update(index, task->getTitle(), task->getDescription());
+
+        // Delegates bind the whole record, so it changes with every role.
+        QList<int> roles{role, RecordRole};
+        if (role == CompletedRole)
+            roles.append(CompletedAtRole);
+
+        QModelIndex modelIndex = createIndex(index, 0);
+        emit dataChanged(modelIndex, modelIndex, roles);
+    }
+}
+
+void TaskModel::taskChanged(Task *task, Change change)
+{
+    switch (change)
+    {
+    case Title:
+        onTaskChanged(task, TitleRole);
+        break;
+    case Completed:
+        onTaskChanged(task, CompletedRole);
+        break;
+    case Priority:
+        onTaskChanged(task, PriorityRole);
+        break;
+    case Assignee:
+        onTaskChanged(task, AssigneeRole);
+        break;
+    case Estimate:
+        onTaskChanged(task, EstimateRole);
+        break;
+    case Dependencies:
+        onTaskChanged(task, DependenciesRole);
+        break;
+    }
+}
+
+void TaskModel::taskDescriptionEdited(Task *task, int position, int removed, int added)
+{
+    onTaskDescriptionEdited(task, position, removed, added);
+}
+
+void TaskModel::onTaskDescriptionEdited(Task *task, int position, int removed, int added)
+{
+    int index = task->row;
     if (index >= 0)
     {
+        scanner.invalidate(index);
         QModelIndex modelIndex = createIndex(index, 0);
-        emit dataChanged(modelIndex, modelIndex);
+        emit dataChanged(modelIndex, modelIndex, {DescriptionRole, RecordRole});
+        emit descriptionEdited(index, position, removed, added);
     }
 }
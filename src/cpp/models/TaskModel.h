@@ -2,7 +2,12 @@
 
 #include <QAbstractListModel>
 #include <QQmlEngine>
+#include <QTimer>
+#include "AssigneeIndex.h"
+#include "AssigneeModel.h"
 #include "Task.h"
+#include "TextScanner.h"
+#include "TrashModel.h"
 
 
 /**
@@ -18,6 +23,18 @@
  * It supports adding, removing, toggling completion status, and clearing completed tasks.
  * The model is designed to work seamlessly with QML ListView and other Qt Quick components.
  *
+ * Deleting a task marks it with a tombstone (DeletedRole) and moves it to the trash
+ * (see trash()), from where it can be restored. The row stays in place and is compacted
+ * in the background, so a delete costs one dataChanged() instead of a row removal; views
+ * go through ActiveTaskModel, and rowCount() includes the tombstoned rows while count()
+ * does not. Callers that need rows to be the live tasks at all times turn this off with
+ * setCompactionDeferred(false). Permanent deletes (removeTasks(),
+ * emptyTrash()) remove rows and free tasks in one bulk pass.
+ *
+ * Live tasks are indexed by assignee (see AssigneeIndex): the tasks and open/completed
+ * counts of a person are available without a scan, and assigneeTasks() hands out a list
+ * model per person that the model keeps up to date row by row.
+ *
  * @note This class is QML_ELEMENT enabled and can be directly used in QML files.
  *
  * Example usage:
@@ -27,7 +44,7 @@
  * model->toggleCompleted(0);
  * @endcode
  */
-class TaskModel : public QAbstractListModel
+class TaskModel : public QAbstractListModel, private TaskObserver
 {
     Q_OBJECT
     QML_ELEMENT
@@ -41,12 +58,131 @@ class TaskModel : public QAbstractListModel
      */
     Q_PROPERTY(int count READ count NOTIFY countChanged)
 
+    /**
+     * @property trash
+     * @brief Deleted tasks that can be restored or purged
+     */
+    Q_PROPERTY(TrashModel *trash READ trash CONSTANT)
+
+    /**
+     * @property assignees
+     * @brief Names of the people with at least one live task, in order of first assignment
+     */
+    Q_PROPERTY(QStringList assignees READ assignees NOTIFY assigneesChanged)
+
 private:
+    friend class TrashModel;
+
+    QList<Task *> tasks; ///< Internal list of task pointers (owned, not QObject children)
+    QHash<quint64, Task *> tasksById; ///< Lookup of tasks by their stable id
+    quint64 nextTaskId = 1;           ///< Id handed to the next inserted task without one
+    TextScanner scanner; ///< Case-folded title/description of every task, row-aligned with tasks
+    bool batchUpdate = false; ///< Set while a bulk update announces its changes itself
+    QList<Task *> deletedTasks; ///< Tasks in the trash, oldest deletion first (owned)
+    int tombstones = 0;       ///< Deleted tasks that still occupy a row
+    bool deferCompaction = true; ///< Whether tombstoned rows are compacted in the background
+    QTimer compactionTimer;   ///< Compacts tombstones once deletes have settled
+    TrashModel *trashModel;   ///< List model over deletedTasks
+    AssigneeIndex assigneeIndex; ///< Live tasks and their counts by interned assignee
+    QHash<quint32, AssigneeModel *> assigneeModels; ///< Lists handed out by assigneeTasks(), by interned assignee
+
+    /**
+     * @brief Maps task ids to their current rows
+     * @return Ascending rows of the tasks that exist; unknown ids are skipped
+     *
+     * Looks each id up through tasksById and the row kept on the task, so the cost
+     * follows the number of ids rather than the number of rows.
+     */
+    QList<int> rowsOfTasks(const QList<quint64> &ids) const;
+
+    /**
+     * @brief Stores the current row on every task from a row on
+     * @param from First row whose task may have moved
+     *
+     * Called after rows were removed; rows before the first removed one keep their task.
+     */
+    void renumberRows(int from);
+
+    /**
+     * @brief Emits dataChanged() once per run of consecutive rows
+     * @param rows Ascending rows that changed
+     * @param roles The roles that changed
+     */
+    void emitRangesChanged(const QList<int> &rows, const QList<int> &roles);
+
+    /**
+     * @brief Destroys all tasks, including those in the trash, in one bulk pass
+     * @param notifyViews Whether attached views and listeners should be notified
+     *
+     * Tasks are detached from the model as a whole and the task objects are then freed
+     * back to back. The model observes its tasks through TaskObserver rather than signal
+     * connections, and tasks are not QObject children of the model, so no connections
+     * are torn down and no per-child bookkeeping or deferred deletion is involved. The
+     * model reset is only announced if a view is actually connected to the model.
+     */
+    void releaseTasks(bool notifyViews);
+
+    /**
+     * @brief Assigns an id to a newly created task and registers the model as its observer
+     * @param task The task that is about to be inserted into the tasks list
+     *
+     * Tasks keep a preassigned id (e.g. from a record) unless it is already taken.
+     */
+    void attachTask(Task *task);
+
+    /**
+     * @brief Tombstones live rows and moves their tasks to the trash
+     * @param rows Ascending rows of live tasks
+     *
+     * Emits dataChanged() for DeletedRole once per run of rows and countChanged() once,
+     * then schedules compaction.
+     */
+    void moveToTrash(const QList<int> &rows);
+
+    /**
+     * @brief Adds live tasks to the posting lists of their assignees
+     * @param added Tasks that are not indexed yet
+     *
+     * The assignee of each task is interned. Lists of the affected people get one row
+     * insertion for a single task and a reset for several.
+     */
+    void indexAssignees(const QList<Task *> &added);
+
+    /**
+     * @brief Removes tasks from the posting lists of their assignees
+     * @param removed Indexed tasks
+     *
+     * Lists of the affected people get one row removal for a single task and a reset
+     * for several.
+     */
+    void unindexAssignees(const QList<Task *> &removed);
 
-    QList<Task *> tasks; ///< Internal list of task pointers
+    /**
+     * @brief Emits the workload signals of a person
+     */
+    void notifyWorkload(quint32 person);
 
 public:
 
+    /**
+     * @brief Returns the value of a role for a task, for list models over the model's tasks
+     *
+     * Shared with TrashModel and AssigneeModel, so every list answers roles alike.
+     */
+    static QVariant taskData(const Task *task, int role);
+
+    /**
+     * @brief Maximum number of tombstoned rows removed by one compaction pass
+     */
+    static constexpr int CompactionBatchSize = 4096;
+
+    /**
+     * @brief Time after the last delete before deferred compaction starts, in milliseconds
+     *
+     * Gives an immediate undo the chance to find the row still in place.
+     */
+    static constexpr int CompactionDelay = 2000;
+
     /**
      * @enum TaskRoles
      * @brief Custom roles for accessing task data in the model
@@ -61,7 +197,14 @@ public:
         CompletedRole,                  ///< Role for accessing completion status (bool)
         CreatedAtRole,                  ///< Role for accessing creation timestamp (QDateTime)
         PriorityRole,                   ///< Role for accessing task priority (int/enum)
-        TaskObjectRole                  ///< Role for accessing the complete Task object (Task*)
+        RecordRole,                     ///< Role for accessing an immutable snapshot of the task (TaskRecord)
+        IdRole,                         ///< Role for accessing the stable task id (quint64)
+        CompletedAtRole,                ///< Role for accessing the completion timestamp (QDateTime)
+        DeletedRole,                    ///< Role for accessing whether the row is a tombstone (bool)
+        DeletedAtRole,                  ///< Role for accessing the deletion timestamp (QDateTime)
+        AssigneeRole,                   ///< Role for accessing the assignee name (QString)
+        EstimateRole,                   ///< Role for accessing the estimate in hours (int)
+        DependenciesRole                ///< Role for accessing the ids of the prerequisite tasks (QList<quint64>)
     };
 
     /**
@@ -71,9 +214,17 @@ public:
     explicit TaskModel(QObject *parent = nullptr);
 
     /**
-     * @brief Returns the number of rows (tasks) in the model
+     * @brief Destroys the model and all of its tasks
+     *
+     * Uses the bulk teardown path: no model or count notifications are emitted while
+     * the tasks are destroyed.
+     */
+    ~TaskModel() override;
+
+    /**
+     * @brief Returns the number of rows in the model
      * @param parent The parent model index (unused for list models)
-     * @return The number of tasks in the model
+     * @return The number of tasks in the model, including tombstoned rows
      */
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
 
@@ -95,16 +246,61 @@ public:
      * @return true if the data was successfully set, false otherwise
      *
      * Supports modification of editable task properties through their respective roles.
+     * Tombstoned rows cannot be modified.
      */
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
 
     /**
-     * @brief Returns the total number of tasks in the model
-     * @return The count of tasks currently stored in the model
+     * @brief Returns the number of live tasks in the model
+     * @return The count of tasks that are not in the trash
+     *
+     * This is the getter for the count Q_PROPERTY. Unlike rowCount(), tombstoned rows are
+     * not included.
+     */
+    int count() const { return int(tasks.size()) - tombstones; }
+
+    /**
+     * @brief Gets the trash of the model
+     *
+     * This is the getter for the trash Q_PROPERTY.
+     */
+    TrashModel *trash() const { return trashModel; }
+
+    /**
+     * @brief Gets the number of tombstoned rows awaiting compaction
+     */
+    int tombstoneCount() const { return tombstones; }
+
+    /**
+     * @brief Gets the names of the people with at least one live task
      *
-     * This is the getter for the count Q_PROPERTY.
+     * This is the getter for the assignees Q_PROPERTY.
+     */
+    QStringList assignees() const;
+
+    /**
+     * @brief Gets the list model of the live tasks of a person
+     * @param assignee The person; empty for the unassigned tasks
+     * @return The list, owned by the model and shared by all callers asking for the same person
+     */
+    Q_INVOKABLE AssigneeModel *assigneeTasks(const QString &assignee);
+
+    /**
+     * @brief Gets the ids of the live tasks of a person
+     * @param assignee The person; empty for the unassigned tasks
+     * @return Ascending task ids, from the person's posting list
+     */
+    Q_INVOKABLE QList<quint64> tasksOfAssignee(const QString &assignee) const;
+
+    /**
+     * @brief Gets the number of live tasks of a person that are not completed
+     */
+    Q_INVOKABLE int openTaskCount(const QString &assignee) const;
+
+    /**
+     * @brief Gets the number of live tasks of a person that are completed
      */
-    int count() const { return tasks.size(); }
+    Q_INVOKABLE int completedTaskCount(const QString &assignee) const;
 
     /**
      * @brief Returns the mapping of role names to role identifiers
@@ -133,14 +329,68 @@ public:
     Q_INVOKABLE bool addTask(const QString &title, const QString &description = QString());
 
     /**
-     * @brief Removes a task from the model at the specified index
-     * @param index The zero-based index of the task to remove
-     * @return true if the task was successfully removed, false if index is invalid
+     * @brief Moves the task at the specified index to the trash
+     * @param index The zero-based index of the task to delete
+     * @return true if the task was deleted, false if index is invalid or already deleted
      *
-     * @warning The Task object will be deleted and any pointers to it will become invalid.
+     * The row is tombstoned (dataChanged() for DeletedRole) and removed later by
+     * compactTombstones(), or right away if compaction is not deferred. The task can be
+     * restored with restoreTask().
      */
     Q_INVOKABLE bool removeTask(int index);
 
+    /**
+     * @brief Checks whether the row at the specified index is a tombstone
+     * @param index The zero-based index of the row
+     * @return true if the task of the row is in the trash, false otherwise
+     */
+    Q_INVOKABLE bool isDeleted(int index) const;
+
+    /**
+     * @brief Brings a task back from the trash
+     * @param id Stable id of the deleted task
+     * @return true if the task was restored, false if it is not in the trash
+     *
+     * The task keeps its id and values. If its tombstoned row is not compacted yet, the
+     * tombstone is lifted in place with dataChanged() for DeletedRole; otherwise a row is
+     * inserted at the end of the list.
+     */
+    Q_INVOKABLE bool restoreTask(quint64 id);
+
+    /**
+     * @brief Permanently deletes all tasks in the trash
+     * @return The number of tasks purged
+     *
+     * Same as removeTasks() with the ids of all deleted tasks.
+     */
+    Q_INVOKABLE int emptyTrash();
+
+    /**
+     * @brief Removes tombstoned rows, keeping their tasks in the trash
+     * @param limit Maximum number of rows to remove
+     * @return The number of rows removed
+     *
+     * Runs of consecutive tombstones are removed from the back with one row removal each.
+     * With deferred compaction, called in batches of CompactionBatchSize from the event
+     * loop after deletes; the passes continue until no tombstone is left.
+     */
+    int compactTombstones(int limit = CompactionBatchSize);
+
+    /**
+     * @brief Sets whether deletes leave tombstoned rows for background compaction
+     * @param deferred true to keep rows of deleted tasks until compaction
+     *
+     * On by default, so a delete costs one dataChanged() rather than a row removal. Turn it
+     * off for index-based callers that expect rows to be the live tasks right after a
+     * delete; turning it off compacts the remaining tombstones at once.
+     */
+    void setCompactionDeferred(bool deferred);
+
+    /**
+     * @brief Checks whether deletes leave tombstoned rows, see setCompactionDeferred()
+     */
+    bool isCompactionDeferred() const { return deferCompaction; }
+
     /**
      * @brief Toggles the completion status of a task at the specified index
      * @param index The zero-based index of the task to toggle
@@ -151,23 +401,229 @@ public:
     Q_INVOKABLE void toggleCompleted(int index);
 
     /**
-     * @brief Removes all completed tasks from the model
+     * @brief Permanently removes several tasks by id
+     * @param ids Stable ids of the tasks to remove; unknown ids are ignored
+     * @return The number of tasks removed
+     *
+     * Live tasks and tasks in the trash are both removed. Tasks in consecutive rows are
+     * removed with a single row-removal notification, the trash is updated with a single
+     * reset, countChanged() is emitted once, and the task objects are freed back to back.
      *
-     * This method iterates through all tasks and removes those marked as completed.
-     * The Task objects will be deleted and the model will be updated accordingly.
+     * @warning The Task objects are deleted and any pointers to them become invalid.
+     */
+    Q_INVOKABLE int removeTasks(const QList<quint64> &ids);
+
+    /**
+     * @brief Moves several tasks to the trash by id
+     * @param ids Stable ids of the tasks to delete; unknown ids and tasks already in the
+     *            trash are ignored
+     * @return The number of tasks moved to the trash
+     *
+     * Like removeTask() for each task, with dataChanged() emitted once per run of
+     * consecutive rows and countChanged() once. The tasks can be restored until the trash
+     * is emptied.
+     */
+    Q_INVOKABLE int trashTasks(const QList<quint64> &ids);
+
+    /**
+     * @brief Sets the priority of several tasks by id
+     * @param ids Stable ids of the tasks to change; unknown ids are ignored
+     * @param priority The new priority level
+     * @return The number of tasks whose priority changed
+     *
+     * dataChanged() is emitted once per run of consecutive changed rows instead of once
+     * per task.
+     */
+    Q_INVOKABLE int setTasksPriority(const QList<quint64> &ids, int priority);
+
+    /**
+     * @brief Replaces a range of a task's description
+     * @param index The zero-based index of the task to edit
+     * @param position Offset of the range to replace within the description
+     * @param removed Number of characters to remove
+     * @param text The text to insert at position
+     * @return true if the index was valid, false otherwise
+     *
+     * Forwards to Task::editDescription(). The model then emits dataChanged() for the
+     * description role only, plus descriptionEdited() carrying the edited span.
+     */
+    Q_INVOKABLE bool editDescription(int index, int position, int removed, const QString &text);
+
+    /**
+     * @brief Moves all completed tasks to the trash
+     *
+     * Like removeTask() for every completed task, with one dataChanged() per run of
+     * consecutive rows and a single countChanged().
      */
     Q_INVOKABLE void clearCompleted();
 
     /**
-     * @brief Retrieves a task object at the specified index
+     * @brief Removes all tasks from the model, including the trash
+     *
+     * Intended for closing a workspace. All tasks are destroyed in one bulk pass
+     * rather than one row at a time. Views are reset only if any are attached,
+     * and countChanged() is emitted once.
+     *
+     * @warning All Task objects are deleted and any pointers to them become invalid.
+     */
+    Q_INVOKABLE void clear();
+
+    /**
+     * @brief Adds several tasks to the model in one operation
+     * @param records The values of the tasks to add
+     * @return The number of tasks that were added
+     *
+     * Records with an empty title are skipped; titles are trimmed like in addTask().
+     * All accepted tasks are appended with a single row insertion, so views and
+     * listeners are notified once regardless of the number of tasks.
+     */
+    int addTasks(const QList<TaskRecord> &records);
+
+    /**
+     * @brief Adds a set of tasks that belong together, all or none
+     * @param records The values of the tasks to add
+     * @return true if all tasks were added; false, with the model unchanged, if a record has
+     *         an empty title or an id that is already taken
+     *
+     * Unlike addTasks(), ids given by the records are kept, so records can refer to each
+     * other as dependencies; see reserveTaskIds(). The tasks are appended with a single row
+     * insertion.
+     */
+    bool addTaskSet(const QList<TaskRecord> &records);
+
+    /**
+     * @brief Reserves ids for tasks that are added later
+     * @param count Number of ids
+     * @return The first of count consecutive ids that no task will be given otherwise
+     */
+    quint64 reserveTaskIds(int count);
+
+    /**
+     * @brief Retrieves a snapshot of the task at the specified index
      * @param index The zero-based index of the task to retrieve
-     * @return Pointer to the Task object, or nullptr if index is invalid
+     * @return TaskRecord with the task's current values, or a null record if index is invalid
+     *
+     * The record is an immutable value: it does not change when the task is modified
+     * later and remains valid after the task has been removed.
+     */
+    Q_INVOKABLE TaskRecord getTask(int index) const;
+
+    /**
+     * @brief Retrieves snapshots of several tasks at once
+     * @param indices The zero-based indices of the tasks to retrieve
+     * @return One TaskRecord per index, in the same order; null records for invalid indices
+     *
+     * Convenient together with the index-returning queries of TaskController, e.g.
+     * getTasks(controller->getTasksByPriority(Task::High)).
+     */
+    Q_INVOKABLE QList<TaskRecord> getTasks(const QList<int> &indices) const;
+
+    /**
+     * @brief Retrieves a snapshot of a task by its id
+     * @param id The stable id of the task
+     * @return TaskRecord with the task's current values, or a null record if no task has
+     *         this id; tasks in the trash are found as well
+     */
+    Q_INVOKABLE TaskRecord getTaskById(quint64 id) const;
+
+    /**
+     * @brief Gets a task by its id without taking a snapshot
+     * @param id The stable id of the task
+     * @return The task, or nullptr if no task has this id; tasks in the trash are found as well
      *
-     * @warning The returned pointer remains valid only while the task exists in the model.
-     * Do not store this pointer long-term as it may become invalid if the task is removed.
+     * For models layered on this one that read many fields of many tasks. The task stays
+     * owned by the model; change it through setData() so views are notified.
      */
-    Q_INVOKABLE Task *getTask(int index) const;
+    const Task *taskById(quint64 id) const;
 
+    /**
+     * @brief Gets the posting list of an interned person
+     * @param person Interned id of the assignee, as listed by the person's AssigneeModel
+     * @return Ascending ids of the person's live tasks
+     */
+    const QList<quint64> &assigneePostings(quint32 person) const { return assigneeIndex.postings(person); }
+
+    /**
+     * @brief Gets the position of a task in the posting list of an interned person
+     * @return The position of the task or, if it is not listed, the one it would be inserted at
+     */
+    int assigneePosition(quint32 person, quint64 id) const { return assigneeIndex.position(person, id); }
+
+    /**
+     * @brief Gets the name of an interned person; empty for the unassigned tasks
+     */
+    QString assigneeName(quint32 person) const { return assigneeIndex.name(person); }
+
+    /**
+     * @brief Gets the open and completed counts of an interned person
+     */
+    AssigneeIndex::Workload assigneeWorkload(quint32 person) const { return assigneeIndex.workload(person); }
+
+    /**
+     * @brief Gets the stable id of the task at the specified index
+     * @param index The zero-based index of the task
+     * @return The task id, or 0 if index is invalid
+     */
+    Q_INVOKABLE quint64 taskId(int index) const;
+
+    /**
+     * @brief Gets the current index of a task by its id
+     * @param id The stable id of the task
+     * @return The zero-based index of the task, or -1 if no live task has this id
+     */
+    Q_INVOKABLE int indexOfTask(quint64 id) const;
+
+    /**
+     * @brief Reads a range of a task's description without copying all of it
+     * @param index The zero-based index of the task
+     * @param position Offset of the first character
+     * @param length Number of characters to return
+     * @return The requested range, or an empty string if index is invalid
+     */
+    Q_INVOKABLE QString descriptionText(int index, int position, int length) const;
+
+    /**
+     * @brief Finds all tasks whose title or description contains the given text
+     * @param text The text to search for, compared case-insensitively
+     * @return Ascending list of zero-based indices of matching live tasks
+     *
+     * Scans pre-folded copies of all task texts (see TextScanner), so neither the
+     * tasks nor the search text are case-folded per comparison. Returns an empty
+     * list for an empty search text.
+     *
+     * @note The returned indices are valid at the time of the call but may become
+     * invalid if tasks are added/removed/reordered after this call.
+     */
+    Q_INVOKABLE QList<int> findTasks(const QString &text) const;
+
+    // Cache management, used by MemoryGovernor
+    /**
+     * @brief Gets the approximate memory held by cached task snapshots and flattened descriptions
+     * @return Size in bytes
+     */
+    qint64 recordCacheSize() const;
+
+    /**
+     * @brief Drops cached task snapshots and flattened descriptions
+     * @return Approximate number of bytes released
+     *
+     * Snapshots are rebuilt on the next getTask() or RecordRole access.
+     */
+    qint64 releaseRecordCache();
+
+    /**
+     * @brief Gets the approximate memory held by the search index
+     * @return Size in bytes
+     */
+    qint64 searchIndexSize() const { return scanner.memoryUsage(); }
+
+    /**
+     * @brief Drops the search index
+     * @return Approximate number of bytes released
+     *
+     * The index is rebuilt from the tasks at the next findTasks() call.
+     */
+    qint64 releaseSearchIndex();
 
 
 signals:
@@ -180,16 +636,73 @@ signals:
      */
     void countChanged();
 
+    /**
+     * @brief Emitted when a span of a task's description has been replaced
+     * @param index The zero-based index of the edited task
+     * @param position Offset at which the edit starts
+     * @param removed Number of characters removed at position
+     * @param added Number of characters inserted at position
+     *
+     * Accompanies the dataChanged() emission for DescriptionRole, so editor views
+     * can apply the edit without re-reading the whole description.
+     */
+    void descriptionEdited(int index, int position, int removed, int added);
+
+    /**
+     * @brief Emitted when a person gets a first live task or loses the last one
+     */
+    void assigneesChanged();
+
+    /**
+     * @brief Emitted when the open or completed count of a person changes
+     * @param assignee The person; empty for the unassigned tasks
+     */
+    void workloadChanged(const QString &assignee);
+
 private slots:
 
     /**
      * @brief Handles changes to individual task properties
+     * @param task The task that changed
+     * @param role The role corresponding to the changed property
      *
-     * This slot should be connected to Task objects' change signals to ensure
-     * the model emits appropriate dataChanged() signals when task properties
-     * are modified externally.
+     * Called through taskChanged() for every property of a task that changes, so the
+     * model emits dataChanged() for exactly the role that was modified externally.
+     * Title changes also refresh the task's entry in the text scanner; completion and
+     * assignee changes update the assignee index.
+     */
+    void onTaskChanged(Task *task, int role);
+
+    /**
+     * @brief Handles an edit of a task's description
+     * @param task The task whose description was edited
+     * @param position Offset at which the edit starts
+     * @param removed Number of characters removed
+     * @param added Number of characters inserted
+     *
+     * Marks the task's scanner entry stale instead of folding the whole description
+     * again, emits dataChanged() for DescriptionRole and forwards the edited span
+     * through descriptionEdited(). Called through taskDescriptionEdited().
+     */
+    void onTaskDescriptionEdited(Task *task, int position, int removed, int added);
+
+private:
+
+    /**
+     * @brief Maps the changed property to its role and forwards it to onTaskChanged()
+     * @param task The task that changed
+     * @param change The property that changed
+     */
+    void taskChanged(Task *task, Change change) override;
+
+    /**
+     * @brief Forwards the edit to onTaskDescriptionEdited()
+     * @param task The task whose description was edited
+     * @param position Offset at which the edit starts
+     * @param removed Number of characters removed
+     * @param added Number of characters inserted
      */
-    void onTaskChanged();
+    void taskDescriptionEdited(Task *task, int position, int removed, int added) override;
 
 
 };
@@ -0,0 +1,179 @@
+#include "TaskRecord.h"
+#include "Task.h"
+
+/**
+ * Shared payload of TaskRecord. Only ever accessed through const methods, so the
+ * shared data is never detached once a record has been constructed.
+ */
+class TaskRecordData : public QSharedData
+{
+public:
+    QString title;
+    QString description;
+    bool completed = false;
+    QDateTime createdAt;
+    int priority = Task::Medium;
+    quint64 id = 0;
+    QDateTime completedAt;
+    QString assignee;
+    int estimate = 0;
+    QList<quint64> dependencies;
+};
+
+TaskRecord::TaskRecord() = default;
+
+TaskRecord::TaskRecord(const QString &title, const QString &description, int priority,
+                       bool completed, const QDateTime &createdAt, quint64 id)
+    : d(new TaskRecordData)
+{
+    d->title = title;
+    d->description = description;
+    d->priority = priority;
+    d->completed = completed;
+    d->createdAt = createdAt;
+    d->id = id;
+}
+
+TaskRecord::TaskRecord(const TaskRecord &other) = default;
+TaskRecord::TaskRecord(TaskRecord &&other) noexcept = default;
+TaskRecord &TaskRecord::operator=(const TaskRecord &other) = default;
+TaskRecord &TaskRecord::operator=(TaskRecord &&other) noexcept = default;
+TaskRecord::~TaskRecord() = default;
+
+QString TaskRecord::getTitle() const
+{
+    return d ? d->title : QString();
+}
+
+QString TaskRecord::getDescription() const
+{
+    return d ? d->description : QString();
+}
+
+bool TaskRecord::getCompleted() const
+{
+    return d ? d->completed : false;
+}
+
+QDateTime TaskRecord::getDateTime() const
+{
+    return d ? d->createdAt : QDateTime();
+}
+
+int TaskRecord::getPriority() const
+{
+    return d ? d->priority : int(Task::Medium);
+}
+
+quint64 TaskRecord::getId() const
+{
+    return d ? d->id : 0;
+}
+
+QDateTime TaskRecord::getCompletedAt() const
+{
+    return d ? d->completedAt : QDateTime();
+}
+
+TaskRecord TaskRecord::withCompletedAt(const QDateTime &completedAt) const &
+{
+    return TaskRecord(*this).withCompletedAt(completedAt);
+}
+
+TaskRecord TaskRecord::withCompletedAt(const QDateTime &completedAt) &&
+{
+    // Non-const access detaches only if the data is still shared with another record.
+    if (d)
+        d->completedAt = completedAt;
+    return std::move(*this);
+}
+
+QString TaskRecord::getAssignee() const
+{
+    return d ? d->assignee : QString();
+}
+
+TaskRecord TaskRecord::withAssignee(const QString &assignee) const &
+{
+    return TaskRecord(*this).withAssignee(assignee);
+}
+
+TaskRecord TaskRecord::withAssignee(const QString &assignee) &&
+{
+    if (d)
+        d->assignee = assignee;
+    return std::move(*this);
+}
+
+int TaskRecord::getEstimate() const
+{
+    return d ? d->estimate : 0;
+}
+
+TaskRecord TaskRecord::withEstimate(int hours) const &
+{
+    return TaskRecord(*this).withEstimate(hours);
+}
+
+TaskRecord TaskRecord::withEstimate(int hours) &&
+{
+    if (d)
+        d->estimate = hours;
+    return std::move(*this);
+}
+
+QList<quint64> TaskRecord::getDependencies() const
+{
+    return d ? d->dependencies : QList<quint64>();
+}
+
+TaskRecord TaskRecord::withDependencies(const QList<quint64> &dependencies) const &
+{
+    return TaskRecord(*this).withDependencies(dependencies);
+}
+
+TaskRecord TaskRecord::withDependencies(const QList<quint64> &dependencies) &&
+{
+    if (d)
+        d->dependencies = dependencies;
+    return std::move(*this);
+}
+
+bool TaskRecord::isValid() const
+{
+    return !getTitle().trimmed().isEmpty();
+}
+
+QString TaskRecord::priorityString() const
+{
+    switch (getPriority())
+    {
+    case Task::Low:
+        return "Low";
+    case Task::Medium:
+        return "Medium";
+    case Task::High:
+        return "High";
+    default:
+        return "Unknown";
+    }
+}
+
+bool TaskRecord::operator==(const TaskRecord &other) const
+{
+    if (d == other.d)
+        return true;
+    if (!d || !other.d)
+        return false;
+
+    return d->title == other.d->title
+        && d->description == other.d->description
+        && d->completed == other.d->completed
+        && d->createdAt == other.d->createdAt
+        && d->priority == other.d->priority
+        && d->id == other.d->id
+        && d->completedAt == other.d->completedAt
+        && d->assignee == other.d->assignee
+        && d->estimate == other.d->estimate
+        && d->dependencies == other.d->dependencies;
+}
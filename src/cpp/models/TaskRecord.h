@@ -0,0 +1,238 @@
+#pragma once
+
+#include <QDateTime>
+#include <QList>
+#include <QMetaType>
+#include <QSharedDataPointer>
+#include <QString>
+
+
+/**
+ * @file TaskRecord.h
+ * @brief Immutable value-type snapshot of a task
+ */
+
+class TaskRecordData;
+
+/**
+ * @class TaskRecord
+ * @brief Immutable, implicitly shared snapshot of a task's data
+ *
+ * TaskRecord is the value-type counterpart of Task. It carries the same data (title,
+ * description, completion status, creation timestamp and priority) but has no QObject
+ * identity: it can be passed by value through TaskModel::data(), TaskModel::getTask(),
+ * the batch APIs and QML without tying the caller to the lifetime of a Task object.
+ *
+ * Records are implicitly shared and never modified after construction, so copying a
+ * record is O(1) (a reference count increment) and a record stays valid after the task
+ * it was taken from has been changed or removed. A default-constructed record is null.
+ *
+ * The class is a Q_GADGET, so QML can read its properties and call its invokable
+ * methods when it is delivered through a role or an invokable method.
+ *
+ * Example usage:
+ * @code
+ * TaskRecord record = model->getTask(0);
+ * if (!record.isNull())
+ *     qDebug() << record.getTitle() << record.priorityString();
+ * @endcode
+ */
+class TaskRecord
+{
+    Q_GADGET
+
+    /**
+     * @property title
+     * @brief The title/name of the task
+     */
+    Q_PROPERTY(QString title READ getTitle CONSTANT)
+
+    /**
+     * @property description
+     * @brief Detailed description of the task
+     */
+    Q_PROPERTY(QString description READ getDescription CONSTANT)
+
+    /**
+     * @property completed
+     * @brief Completion status of the task
+     */
+    Q_PROPERTY(bool completed READ getCompleted CONSTANT)
+
+    /**
+     * @property dateTime
+     * @brief Timestamp when the task was created
+     */
+    Q_PROPERTY(QDateTime dateTime READ getDateTime CONSTANT)
+
+    /**
+     * @property priority
+     * @brief Priority level of the task (0=Low, 1=Medium, 2=High)
+     */
+    Q_PROPERTY(int priority READ getPriority CONSTANT)
+
+    /**
+     * @property id
+     * @brief Stable identifier of the task (0 if the record does not belong to a model)
+     */
+    Q_PROPERTY(quint64 id READ getId CONSTANT)
+
+    /**
+     * @property completedAt
+     * @brief Timestamp when the task was last completed (invalid if pending or unknown)
+     */
+    Q_PROPERTY(QDateTime completedAt READ getCompletedAt CONSTANT)
+
+    /**
+     * @property assignee
+     * @brief Name of the person the task is assigned to (empty if unassigned)
+     */
+    Q_PROPERTY(QString assignee READ getAssignee CONSTANT)
+
+    /**
+     * @property estimate
+     * @brief Estimated effort in hours (0 if not estimated)
+     */
+    Q_PROPERTY(int estimate READ getEstimate CONSTANT)
+
+    /**
+     * @property dependencies
+     * @brief Ids of the tasks that must be finished before this one can start
+     */
+    Q_PROPERTY(QList<quint64> dependencies READ getDependencies CONSTANT)
+
+private:
+
+    QSharedDataPointer<TaskRecordData> d; ///< Shared, never-detached record data
+
+public:
+
+    /**
+     * @brief Constructs a null record
+     */
+    TaskRecord();
+
+    /**
+     * @brief Constructs a record with the given values
+     * @param title The title of the task
+     * @param description The description of the task (optional)
+     * @param priority Priority level (default: 1/Medium)
+     * @param completed Completion status (default: false)
+     * @param createdAt Creation timestamp (default: invalid, i.e. assigned on insertion)
+     * @param id Task identifier (default: 0, i.e. assigned on insertion)
+     */
+    explicit TaskRecord(const QString &title, const QString &description = QString(), int priority = 1,
+                        bool completed = false, const QDateTime &createdAt = QDateTime(), quint64 id = 0);
+
+    TaskRecord(const TaskRecord &other);
+    TaskRecord(TaskRecord &&other) noexcept;
+    TaskRecord &operator=(const TaskRecord &other);
+    TaskRecord &operator=(TaskRecord &&other) noexcept;
+    ~TaskRecord();
+
+    /**
+     * @brief Checks whether this is a null (default-constructed) record
+     */
+    Q_INVOKABLE bool isNull() const { return !d; }
+
+    /**
+     * @brief Gets the task title
+     */
+    QString getTitle() const;
+
+    /**
+     * @brief Gets the task description
+     */
+    QString getDescription() const;
+
+    /**
+     * @brief Gets the completion status
+     */
+    bool getCompleted() const;
+
+    /**
+     * @brief Gets the creation timestamp
+     */
+    QDateTime getDateTime() const;
+
+    /**
+     * @brief Gets the priority level (0=Low, 1=Medium, 2=High)
+     */
+    int getPriority() const;
+
+    /**
+     * @brief Gets the task identifier (0 if unassigned)
+     */
+    quint64 getId() const;
+
+    /**
+     * @brief Gets the completion timestamp (invalid if pending or unknown)
+     */
+    QDateTime getCompletedAt() const;
+
+    /**
+     * @brief Returns a copy of the record with a different completion timestamp
+     *
+     * Called on a temporary, the temporary's data is reused instead of copied.
+     */
+    TaskRecord withCompletedAt(const QDateTime &completedAt) const &;
+    TaskRecord withCompletedAt(const QDateTime &completedAt) &&;
+
+    /**
+     * @brief Gets the name of the assignee (empty if unassigned)
+     */
+    QString getAssignee() const;
+
+    /**
+     * @brief Returns a copy of the record with a different assignee
+     *
+     * Called on a temporary, the temporary's data is reused instead of copied.
+     */
+    TaskRecord withAssignee(const QString &assignee) const &;
+    TaskRecord withAssignee(const QString &assignee) &&;
+
+    /**
+     * @brief Gets the estimated effort in hours (0 if not estimated)
+     */
+    int getEstimate() const;
+
+    /**
+     * @brief Returns a copy of the record with a different estimate
+     *
+     * Called on a temporary, the temporary's data is reused instead of copied.
+     */
+    TaskRecord withEstimate(int hours) const &;
+    TaskRecord withEstimate(int hours) &&;
+
+    /**
+     * @brief Gets the ids of the tasks this one depends on
+     */
+    QList<quint64> getDependencies() const;
+
+    /**
+     * @brief Returns a copy of the record with different dependencies
+     *
+     * Called on a temporary, the temporary's data is reused instead of copied.
+     */
+    TaskRecord withDependencies(const QList<quint64> &dependencies) const &;
+    TaskRecord withDependencies(const QList<quint64> &dependencies) &&;
+
+    /**
+     * @brief Checks if the record has a non-empty title, like Task::isValid()
+     */
+    Q_INVOKABLE bool isValid() const;
+
+    /**
+     * @brief Gets the priority level as a human-readable string, like Task::priorityString()
+     */
+    Q_INVOKABLE QString priorityString() const;
+
+    /**
+     * @brief Compares two records by value
+     */
+    bool operator==(const TaskRecord &other) const;
+    bool operator!=(const TaskRecord &other) const { return !(*this == other); }
+};
+
+Q_DECLARE_TYPEINFO(TaskRecord, Q_RELOCATABLE_TYPE);
+Q_DECLARE_METATYPE(TaskRecord)
@@ -0,0 +1,274 @@
+#include "TaskTemplate.h"
+
+#include <QDataStream>
+#include <QDebug>
+
+/**
+ * Interns texts while a template is built: every distinct text is compiled once, and every
+ * distinct literal piece and placeholder name is stored once.
+ */
+class TaskTemplate::Compiler
+{
+public:
+
+    explicit Compiler(TaskTemplate &target)
+        : target(target)
+    {
+    }
+
+    qint32 text(const QString &source)
+    {
+        const auto it = textIds.constFind(source);
+        if (it != textIds.cend())
+            return *it;
+
+        QList<qint32> segments;
+        qsizetype position = 0;
+        while (position < source.size())
+        {
+            const qsizetype open = source.indexOf(QLatin1String("{{"), position);
+            const qsizetype close = open < 0 ? -1 : source.indexOf(QLatin1String("}}"), open + 2);
+            if (close < 0)
+            {
+                segments.append(literal(source.mid(position)));
+                break;
+            }
+
+            if (open > position)
+                segments.append(literal(source.mid(position, open - position)));
+            segments.append(-1 - variable(source.mid(open + 2, close - open - 2).trimmed()));
+            position = close + 2;
+        }
+
+        const qint32 id = qint32(target.texts.size());
+        target.texts.append(segments);
+        textIds.insert(source, id);
+        return id;
+    }
+
+    void add(qint32 parent, const Prototype &prototype)
+    {
+        Node node;
+        node.parent = parent;
+        node.title = text(prototype.title);
+        node.description = text(prototype.description);
+        node.assignee = text(prototype.assignee);
+        node.priority = prototype.priority;
+        node.estimate = prototype.estimate;
+        const qint32 index = qint32(target.nodes.size());
+        target.nodes.append(node);
+
+        for (const Prototype &child : prototype.children)
+            add(index, child);
+    }
+
+private:
+
+    TaskTemplate &target;
+    QHash<QString, qint32> textIds;
+    QHash<QString, qint32> stringIds;
+    QHash<QString, qint32> variableIds;
+
+    qint32 literal(const QString &piece)
+    {
+        const auto it = stringIds.constFind(piece);
+        if (it != stringIds.cend())
+            return *it;
+
+        const qint32 id = qint32(target.strings.size());
+        target.strings.append(piece);
+        stringIds.insert(piece, id);
+        return id;
+    }
+
+    qint32 variable(const QString &name)
+    {
+        const auto it = variableIds.constFind(name);
+        if (it != variableIds.cend())
+            return *it;
+
+        const qint32 id = qint32(target.names.size());
+        target.names.append(name);
+        variableIds.insert(name, id);
+        return id;
+    }
+};
+
+TaskTemplate::TaskTemplate(const QString &name, const QList<Prototype> &prototypes)
+    : label(name)
+{
+    Compiler compiler(*this);
+    for (const Prototype &prototype : prototypes)
+        compiler.add(-1, prototype);
+}
+
+TaskTemplate TaskTemplate::fromOutline(const QString &name, const QString &outline)
+{
+    TaskTemplate result;
+    result.label = name;
+    Compiler compiler(result);
+
+    // Indentation and node of the lines that can still get children
+    QList<QPair<int, qint32>> open;
+    const QStringList lines = outline.split(QLatin1Char('\n'));
+    for (const QString &line : lines)
+    {
+        const QString title = line.trimmed();
+        if (title.isEmpty())
+            continue;
+
+        int indent = 0;
+        for (QChar c : line)
+        {
+            if (c == QLatin1Char(' '))
+                indent += 1;
+            else if (c == QLatin1Char('\t'))
+                indent += 4;
+            else
+                break;
+        }
+        while (!open.isEmpty() && open.last().first >= indent)
+            open.removeLast();
+
+        Node node;
+        node.parent = open.isEmpty() ? -1 : open.last().second;
+        node.title = compiler.text(title);
+        node.description = compiler.text(QString());
+        node.assignee = node.description;
+        const qint32 index = qint32(result.nodes.size());
+        result.nodes.append(node);
+        open.append({indent, index});
+    }
+    return result;
+}
+
+QList<TaskTemplate::Prototype> TaskTemplate::prototypes() const
+{
+    // Nodes are in preorder, so children are attached from the last node up.
+    QList<Prototype> all(nodes.size());
+    for (qsizetype i = nodes.size() - 1; i >= 0; --i)
+    {
+        const Node &node = nodes[i];
+        Prototype &prototype = all[i];
+        prototype.title = source(node.title);
+        prototype.description = source(node.description);
+        prototype.assignee = source(node.assignee);
+        prototype.priority = node.priority;
+        prototype.estimate = node.estimate;
+        if (node.parent >= 0)
+            all[node.parent].children.prepend(prototype);
+    }
+
+    QList<Prototype> roots;
+    for (qsizetype i = 0; i < nodes.size(); ++i)
+    {
+        if (nodes[i].parent < 0)
+            roots.append(all[i]);
+    }
+    return roots;
+}
+
+bool TaskTemplate::instantiate(const QHash<QString, QString> &values, quint64 firstId, QList<TaskRecord> *records) const
+{
+    for (const QString &name : names)
+    {
+        if (!values.contains(name))
+        {
+            qWarning() << "TaskTemplate::instantiate: no value for" << name << "in" << label;
+            return false;
+        }
+    }
+
+    QStringList expanded;
+    expanded.reserve(texts.size());
+    for (qint32 text = 0; text < texts.size(); ++text)
+        expanded.append(expand(text, values));
+
+    QList<QList<quint64>> waitsFor(nodes.size());
+    for (qsizetype i = 0; i < nodes.size(); ++i)
+    {
+        if (nodes[i].parent >= 0)
+            waitsFor[nodes[i].parent].append(firstId + quint64(i));
+    }
+
+    records->reserve(records->size() + nodes.size());
+    for (qsizetype i = 0; i < nodes.size(); ++i)
+    {
+        const Node &node = nodes[i];
+        records->append(TaskRecord(expanded[node.title], expanded[node.description], node.priority, false,
+                                   QDateTime(), firstId + quint64(i))
+                            .withAssignee(expanded[node.assignee])
+                            .withEstimate(node.estimate)
+                            .withDependencies(waitsFor[i]));
+    }
+    return true;
+}
+
+QString TaskTemplate::expand(qint32 text, const QHash<QString, QString> &values) const
+{
+    QString result;
+    for (qint32 segment : texts[text])
+        result += segment >= 0 ? strings[segment] : values.value(names[-1 - segment]);
+    return result;
+}
+
+QString TaskTemplate::source(qint32 text) const
+{
+    QString result;
+    for (qint32 segment : texts[text])
+        result += segment >= 0 ? strings[segment] : QStringLiteral("{{%1}}").arg(names[-1 - segment]);
+    return result;
+}
+
+void TaskTemplate::write(QDataStream &out) const
+{
+    out << label << strings << names << qint32(texts.size());
+    for (const QList<qint32> &segments : texts)
+        out << segments;
+    out << qint32(nodes.size());
+    for (const Node &node : nodes)
+        out << node.parent << node.title << node.description << node.assignee << node.priority << node.estimate;
+}
+
+bool TaskTemplate::read(QDataStream &in)
+{
+    *this = TaskTemplate();
+    qint32 textCount = 0;
+    in >> label >> strings >> names >> textCount;
+    if (in.status() != QDataStream::Ok || textCount < 0)
+        return false;
+
+    texts.reserve(textCount);
+    for (qint32 i = 0; i < textCount && in.status() == QDataStream::Ok; ++i)
+    {
+        QList<qint32> segments;
+        in >> segments;
+        for (qint32 segment : std::as_const(segments))
+        {
+            if (segment >= strings.size() || -1 - segment >= names.size())
+                in.setStatus(QDataStream::ReadCorruptData);
+        }
+        texts.append(segments);
+    }
+
+    qint32 nodeCount = 0;
+    in >> nodeCount;
+    for (qint32 i = 0; i < nodeCount && in.status() == QDataStream::Ok; ++i)
+    {
+        Node node;
+        in >> node.parent >> node.title >> node.description >> node.assignee >> node.priority >> node.estimate;
+
+        // Parents come first; every text must exist.
+        const auto known = [this](qint32 text) { return text >= 0 && text < texts.size(); };
+        if (node.parent >= i || node.parent < -1 || !known(node.title) || !known(node.description) || !known(node.assignee))
+            in.setStatus(QDataStream::ReadCorruptData);
+        nodes.append(node);
+    }
+
+    if (in.status() != QDataStream::Ok || nodeCount < 0)
+    {
+        *this = TaskTemplate();
+        return false;
+    }
+    return true;
+}
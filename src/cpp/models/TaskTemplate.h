@@ -0,0 +1,157 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include "TaskRecord.h"
+
+class QDataStream;
+
+
+/**
+ * @file TaskTemplate.h
+ * @brief Trees of prototype tasks with placeholders, instantiated as sets of tasks
+ */
+
+/**
+ * @class TaskTemplate
+ * @brief A named tree of prototype tasks whose texts may contain {{placeholders}}
+ *
+ * A template describes a recurring set of tasks, like an onboarding checklist. Every
+ * prototype has a title, a description, a priority, an assignee and an estimate; titles,
+ * descriptions and assignees may contain placeholders like {{name}}, which are replaced
+ * by values when the template is instantiated. A prototype with children stands for a
+ * task that is finished after them: its task waits for the tasks of its children.
+ *
+ * Templates are kept in an interned form. Every distinct text is compiled once into
+ * segments, literal pieces and placeholders; literal pieces are stored once per template
+ * however often they occur, and prototypes refer to their texts by index. Instantiating
+ * expands every distinct text once, so a checklist of 200 items that repeats a handful of
+ * descriptions expands a handful of descriptions.
+ *
+ * instantiate() gives the tasks ids from a range the caller reserved (see
+ * TaskModel::reserveTaskIds()), so the dependencies between them are known before they
+ * are added, and the set can be added with one TaskModel::addTaskSet() call.
+ *
+ * Example usage:
+ * @code
+ * const TaskTemplate onboarding = TaskTemplate::fromOutline("Onboarding",
+ *     "Onboard {{name}}\n"
+ *     "    Set up a laptop for {{name}}\n"
+ *     "    Create accounts for {{name}}\n");
+ * QList<TaskRecord> records;
+ * if (onboarding.instantiate({{"name", "Ana"}}, model->reserveTaskIds(onboarding.size()), &records))
+ *     model->addTaskSet(records);
+ * @endcode
+ */
+class TaskTemplate
+{
+public:
+
+    /**
+     * @brief A prototype task and the prototypes it is finished after
+     */
+    struct Prototype
+    {
+        QString title;                  ///< Title, with placeholders
+        QString description;            ///< Description, with placeholders
+        int priority = 1;               ///< Task::Priority
+        QString assignee;               ///< Assignee, with placeholders
+        int estimate = 0;               ///< Estimate in hours
+        QList<Prototype> children;      ///< Prototypes whose tasks this one's task waits for
+    };
+
+    /**
+     * @brief Constructs an empty template without a name
+     */
+    TaskTemplate() = default;
+
+    /**
+     * @brief Constructs a template from trees of prototypes
+     * @param name The name of the template
+     * @param prototypes The roots of the trees, in order
+     */
+    TaskTemplate(const QString &name, const QList<Prototype> &prototypes);
+
+    /**
+     * @brief Constructs a template from an indented outline
+     * @param name The name of the template
+     * @param outline One prototype title per line, medium priority; a line indented more than
+     *        the line above it is a child of that line. Blank lines are skipped, a tab counts
+     *        as four spaces.
+     */
+    static TaskTemplate fromOutline(const QString &name, const QString &outline);
+
+    /**
+     * @brief Gets the name of the template
+     */
+    QString name() const { return label; }
+
+    /**
+     * @brief Gets the number of prototypes, i.e. of tasks an instance has
+     */
+    int size() const { return int(nodes.size()); }
+
+    bool isEmpty() const { return nodes.isEmpty(); }
+
+    /**
+     * @brief Gets the names of the placeholders, in the order they first appear
+     */
+    QStringList variables() const { return names; }
+
+    /**
+     * @brief Gets the number of distinct literal pieces stored for the template's texts
+     */
+    int internedCount() const { return int(strings.size()); }
+
+    /**
+     * @brief Gets the trees of prototypes, with their placeholders
+     */
+    QList<Prototype> prototypes() const;
+
+    /**
+     * @brief Expands the placeholders and builds the records of an instance
+     * @param values A value for every placeholder, by name
+     * @param firstId Id of the first task; the others get the following ids, in preorder
+     * @param records Receives the records, parents before their children
+     * @return false, with records unchanged, if a placeholder has no value
+     */
+    bool instantiate(const QHash<QString, QString> &values, quint64 firstId, QList<TaskRecord> *records) const;
+
+    /**
+     * @brief Writes the interned form
+     */
+    void write(QDataStream &out) const;
+
+    /**
+     * @brief Reads the interned form written by write()
+     * @return false if the data is truncated or inconsistent; the template is then empty
+     */
+    bool read(QDataStream &in);
+
+private:
+
+    class Compiler;
+
+    /**
+     * @brief A prototype in preorder
+     */
+    struct Node
+    {
+        qint32 parent = -1;         ///< Index of the parent node, -1 for a root
+        qint32 title = 0;           ///< Index of the title in texts
+        qint32 description = 0;     ///< Index of the description in texts
+        qint32 assignee = 0;        ///< Index of the assignee in texts
+        qint32 priority = 1;        ///< Task::Priority
+        qint32 estimate = 0;        ///< Estimate in hours
+    };
+
+    QString label;                  ///< Name of the template
+    QList<Node> nodes;              ///< Prototypes in preorder
+    QList<QList<qint32>> texts;     ///< Distinct texts as segments: an index in strings, or -1 - an index in names
+    QStringList strings;            ///< Distinct literal pieces
+    QStringList names;              ///< Placeholder names
+
+    QString expand(qint32 text, const QHash<QString, QString> &values) const;
+    QString source(qint32 text) const;
+};
@@ -0,0 +1,62 @@
+#include "TrashModel.h"
+#include "TaskModel.h"
+
+TrashModel::TrashModel(TaskModel *taskModel)
+    : QAbstractListModel(taskModel), model(taskModel)
+{
+}
+
+Task *TrashModel::taskAt(int row) const
+{
+    const QList<Task *> &deleted = model->deletedTasks;
+    if (row < 0 || row >= deleted.size())
+        return nullptr;
+
+    return deleted[deleted.size() - 1 - row];
+}
+
+int TrashModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return int(model->deletedTasks.size());
+}
+
+QVariant TrashModel::data(const QModelIndex &index, int role) const
+{
+    const Task *task = index.isValid() ? taskAt(index.row()) : nullptr;
+    return task ? TaskModel::taskData(task, role) : QVariant();
+}
+
+QHash<int, QByteArray> TrashModel::roleNames() const
+{
+    return model->roleNames();
+}
+
+quint64 TrashModel::taskId(int row) const
+{
+    const Task *task = taskAt(row);
+    return task ? task->getId() : 0;
+}
+
+TaskRecord TrashModel::getTask(int row) const
+{
+    const Task *task = taskAt(row);
+    return task ? task->record() : TaskRecord();
+}
+
+bool TrashModel::restore(int row)
+{
+    const quint64 id = taskId(row);
+    return id != 0 && model->restoreTask(id);
+}
+
+bool TrashModel::purge(int row)
+{
+    const quint64 id = taskId(row);
+    return id != 0 && model->removeTasks({id}) > 0;
+}
+
+int TrashModel::purgeAll()
+{
+    return model->emptyTrash();
+}
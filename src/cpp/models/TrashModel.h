@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include "TaskRecord.h"
+
+class Task;
+class TaskModel;
+
+
+/**
+ * @file TrashModel.h
+ * @brief List model of the deleted tasks of a TaskModel
+ */
+
+/**
+ * @class TrashModel
+ * @brief Read-only list of the tasks in a TaskModel's trash, latest deletion first
+ *
+ * Owned by its TaskModel (see TaskModel::trash()), which announces all row changes. The
+ * model exposes the same roles as TaskModel; DeletedAtRole tells when a task was deleted.
+ * Rows refer to the trash, not to the task list: use restore() and purge() rather than
+ * the row-based methods of TaskModel.
+ *
+ * Example usage (QML):
+ * @code
+ * ListView {
+ *     model: taskController.taskModel.trash
+ *     delegate: Button {
+ *         text: title
+ *         onClicked: taskController.taskModel.trash.restore(index)
+ *     }
+ * }
+ * @endcode
+ */
+class TrashModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /**
+     * @property count
+     * @brief The number of tasks in the trash
+     */
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+private:
+    friend class TaskModel;
+
+    TaskModel *model; ///< Owning model, whose trash is listed
+
+    /**
+     * @brief Constructs the trash of a model; called by TaskModel only
+     * @param model The owning model, also the QObject parent
+     */
+    explicit TrashModel(TaskModel *model);
+
+    /**
+     * @brief Gets the task shown in a row, or nullptr if row is invalid
+     */
+    Task *taskAt(int row) const;
+
+public:
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * @brief Returns the number of tasks in the trash
+     *
+     * This is the getter for the count Q_PROPERTY.
+     */
+    int count() const { return rowCount(); }
+
+    /**
+     * @brief Gets the stable id of the task in a row
+     * @param row The zero-based row in the trash
+     * @return The task id, or 0 if row is invalid
+     */
+    Q_INVOKABLE quint64 taskId(int row) const;
+
+    /**
+     * @brief Retrieves a snapshot of the task in a row
+     * @param row The zero-based row in the trash
+     * @return TaskRecord with the task's values, or a null record if row is invalid
+     */
+    Q_INVOKABLE TaskRecord getTask(int row) const;
+
+    /**
+     * @brief Restores the task in a row, see TaskModel::restoreTask()
+     * @param row The zero-based row in the trash
+     * @return true if the task was restored, false if row is invalid
+     */
+    Q_INVOKABLE bool restore(int row);
+
+    /**
+     * @brief Permanently deletes the task in a row
+     * @param row The zero-based row in the trash
+     * @return true if the task was deleted, false if row is invalid
+     */
+    Q_INVOKABLE bool purge(int row);
+
+    /**
+     * @brief Permanently deletes all tasks in the trash, see TaskModel::emptyTrash()
+     * @return The number of tasks deleted
+     */
+    Q_INVOKABLE int purgeAll();
+
+signals:
+
+    /**
+     * @brief Emitted when tasks are added to or removed from the trash
+     */
+    void countChanged();
+};
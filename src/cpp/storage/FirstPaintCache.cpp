@@ -0,0 +1,116 @@
+#include "FirstPaintCache.h"
+#include "TaskStore.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+
+namespace
+{
+
+constexpr quint32 CacheMagic = 0x544d4650; // "TMFP"
+constexpr quint32 FormatVersion = TaskStore::RecordVersion;
+
+}
+
+FirstPaintCache::FirstPaintCache(QObject *parent)
+    : QObject(parent), rows(new TaskModel(this))
+{
+}
+
+bool FirstPaintCache::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 start = 0;
+    qint32 firstRow = 0;
+    double offset = 0;
+    qint32 storedTotal = 0;
+    qint32 storedCompleted = 0;
+    quint32 count = 0;
+    in >> magic >> version >> storedTotal >> storedCompleted >> start >> firstRow >> offset >> count;
+    if (in.status() != QDataStream::Ok || magic != CacheMagic || version < 1 || version > FormatVersion || count > MaxRows
+        || (count > 0 && (firstRow < start || firstRow - start >= qint32(count))))
+    {
+        qWarning() << "FirstPaintCache::load: ignoring damaged cache" << fileName;
+        return false;
+    }
+
+    QList<TaskRecord> records;
+    records.reserve(count);
+    for (quint32 i = 0; i < count; ++i)
+        records.append(TaskStore::readRecord(in, version));
+    if (in.status() != QDataStream::Ok)
+    {
+        qWarning() << "FirstPaintCache::load: ignoring truncated cache" << fileName;
+        return false;
+    }
+
+    rows->clear();
+    rows->addTasks(records);
+    loadedStart = start;
+    loadedFirstRow = firstRow;
+    loadedOffset = offset;
+    total = storedTotal;
+    completed = storedCompleted;
+    active = true;
+    emit activeChanged();
+    return true;
+}
+
+void FirstPaintCache::release()
+{
+    if (!active)
+        return;
+
+    active = false;
+    emit activeChanged();
+    // Views have switched to the live model by now, so the reset is not seen.
+    rows->clear();
+}
+
+void FirstPaintCache::setViewport(int firstRow, qreal rowOffset, int visibleRows)
+{
+    viewFirstRow = qMax(0, firstRow);
+    viewOffset = rowOffset;
+    viewRows = visibleRows;
+}
+
+bool FirstPaintCache::save(const QString &fileName, const QAbstractItemModel *view, int totalTasks,
+                           int completedTasks) const
+{
+    const int rowCount = view->rowCount();
+    const int firstRow = qMin(viewFirstRow, qMax(0, rowCount - 1));
+
+    // One row above the top one, so a section header of the top row only shows if it did.
+    const int start = qMax(0, firstRow - 1);
+    const int wanted = viewRows > 0 ? viewRows + (firstRow - start) : MaxRows;
+    const int end = qMin(rowCount, start + qMin(wanted, MaxRows));
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "FirstPaintCache::save: cannot write" << fileName << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << CacheMagic << FormatVersion << qint32(totalTasks) << qint32(completedTasks) << qint32(start)
+        << qint32(rowCount ? firstRow : 0) << double(rowCount ? viewOffset : 0) << quint32(end - start);
+    for (int row = start; row < end; ++row)
+        TaskStore::writeRecord(out, view->data(view->index(row, 0), TaskModel::RecordRole).value<TaskRecord>());
+
+    if (out.status() != QDataStream::Ok || !file.commit())
+    {
+        qWarning() << "FirstPaintCache::save: cannot write" << fileName << file.errorString();
+        return false;
+    }
+    return true;
+}
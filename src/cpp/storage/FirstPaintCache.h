@@ -0,0 +1,163 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QObject>
+#include "TaskModel.h"
+
+
+/**
+ * @file FirstPaintCache.h
+ * @brief Small snapshot of the visible task list, shown while the full list loads
+ */
+
+/**
+ * @class FirstPaintCache
+ * @brief Remembers what the task list showed at exit so the next launch can show it at once
+ *
+ * On exit, save() writes the rows around the top of the view in display order, the task
+ * statistics and the scroll position within the top row, a few kilobytes. On the next
+ * launch load() reads them back before the window is created, so the first frame shows
+ * the list as it was left while the TaskStore is still reading. Once the live model is
+ * ready, release() switches the view back; views keep the scroll position by placing
+ * firstRow at the same offset in the live model.
+ *
+ * The cached rows are a static picture: they are not updated and cannot be edited.
+ *
+ * Example usage:
+ * @code
+ * cache->load(dataDir + "/firstpaint.cache");           // before loading the QML
+ * connect(store, &TaskStore::opened, cache, &FirstPaintCache::release);
+ * store->open(dataDir + "/tasks", false);
+ * // at exit
+ * cache->save(dataDir + "/firstpaint.cache", controller->activeTasks(), total, completed);
+ * @endcode
+ */
+class FirstPaintCache : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * @property active
+     * @brief Whether views should show the cached rows instead of the live model
+     */
+    Q_PROPERTY(bool active READ isActive NOTIFY activeChanged)
+
+    /**
+     * @property model
+     * @brief The cached rows, with the roles of TaskModel. Read-only (CONSTANT).
+     */
+    Q_PROPERTY(TaskModel *model READ model CONSTANT)
+
+    /**
+     * @property cachedRow
+     * @brief Row of model that was at the top of the view
+     */
+    Q_PROPERTY(int cachedRow READ cachedRow NOTIFY activeChanged)
+
+    /**
+     * @property firstRow
+     * @brief Row of the live view's model that was at the top of the view
+     */
+    Q_PROPERTY(int firstRow READ firstRow NOTIFY activeChanged)
+
+    /**
+     * @property rowOffset
+     * @brief Distance the view was scrolled past the top of firstRow, in pixels
+     */
+    Q_PROPERTY(qreal rowOffset READ rowOffset NOTIFY activeChanged)
+
+    /**
+     * @property totalTasks
+     * @brief Total number of tasks at exit
+     */
+    Q_PROPERTY(int totalTasks READ totalTasks NOTIFY activeChanged)
+
+    /**
+     * @property completedTasks
+     * @brief Number of completed tasks at exit
+     */
+    Q_PROPERTY(int completedTasks READ completedTasks NOTIFY activeChanged)
+
+    /**
+     * @property pendingTasks
+     * @brief Number of pending tasks at exit
+     */
+    Q_PROPERTY(int pendingTasks READ pendingTasks NOTIFY activeChanged)
+
+public:
+
+    /**
+     * @brief Maximum number of rows saved
+     */
+    static constexpr int MaxRows = 64;
+
+    /**
+     * @brief Constructs an inactive cache
+     * @param parent The parent QObject
+     */
+    explicit FirstPaintCache(QObject *parent = nullptr);
+
+    /**
+     * @brief Reads a cache file and activates the cache
+     * @param fileName Path of the file written by save()
+     * @return true if the file was read; a missing or damaged file leaves the cache inactive
+     */
+    bool load(const QString &fileName);
+
+    /**
+     * @brief Deactivates the cache and drops the cached rows
+     *
+     * The view position read by load() stays available to place the live view.
+     */
+    void release();
+
+    /**
+     * @brief Records the part of a view that is visible
+     * @param firstRow Row of the view's model at the top of the view
+     * @param rowOffset Distance the view is scrolled past the top of firstRow, in pixels
+     * @param visibleRows Number of rows visible from firstRow on
+     *
+     * Called by views as the user scrolls; save() uses the last values.
+     */
+    Q_INVOKABLE void setViewport(int firstRow, qreal rowOffset, int visibleRows);
+
+    /**
+     * @brief Writes the visible rows of a view's model and the statistics to a file
+     * @param fileName Path of the file; replaced atomically
+     * @param rows Model shown by the view, providing TaskModel::RecordRole
+     * @param total Total number of tasks
+     * @param completed Number of completed tasks
+     * @return true if the file was written
+     */
+    bool save(const QString &fileName, const QAbstractItemModel *rows, int total, int completed) const;
+
+    bool isActive() const { return active; }
+    TaskModel *model() const { return rows; }
+    int cachedRow() const { return active ? loadedFirstRow - loadedStart : -1; }
+    int firstRow() const { return loadedFirstRow; }
+    qreal rowOffset() const { return loadedOffset; }
+    int totalTasks() const { return total; }
+    int completedTasks() const { return completed; }
+    int pendingTasks() const { return total - completed; }
+
+signals:
+
+    /**
+     * @brief Emitted when the cache is loaded or released
+     */
+    void activeChanged();
+
+private:
+
+    TaskModel *rows;           ///< Cached rows
+    bool active = false;       ///< Whether views show rows
+    int loadedStart = 0;       ///< Live row of the first cached row
+    int loadedFirstRow = 0;    ///< Live row at the top of the view at exit
+    qreal loadedOffset = 0;    ///< Scroll offset within that row at exit
+    int total = 0;             ///< Total tasks at exit
+    int completed = 0;         ///< Completed tasks at exit
+
+    int viewFirstRow = 0;      ///< Current top row reported by setViewport()
+    qreal viewOffset = 0;      ///< Current offset reported by setViewport()
+    int viewRows = 0;          ///< Current visible row count reported by setViewport()
+};
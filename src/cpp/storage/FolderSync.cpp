@@ -0,0 +1,560 @@
+#include "FolderSync.h"
+#include "TaskModel.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QUuid>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace
+{
+
+constexpr quint32 CacheMagic = 0x544d4653; // "TMFS"
+constexpr quint32 FormatVersion = 1;
+constexpr int RescanDelayMs = 200;
+
+QByteArray contentHash(const QByteArray &content)
+{
+    return QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+}
+
+qint64 modificationTime(const QFileInfo &info)
+{
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+}
+
+FolderSync::FolderSync(QObject *parent)
+    : QObject(parent)
+{
+    writeTimer.setSingleShot(true);
+    writeTimer.setInterval(DefaultWriteDelay);
+    connect(&writeTimer, &QTimer::timeout, this, &FolderSync::flush);
+
+    scanTimer.setSingleShot(true);
+    scanTimer.setInterval(RescanDelayMs);
+    connect(&scanTimer, &QTimer::timeout, this, &FolderSync::scan);
+    connect(&watcher, &QFileSystemWatcher::directoryChanged, &scanTimer, qOverload<>(&QTimer::start));
+    connect(&checks, &QFutureWatcher<QList<Check>>::finished, this, &FolderSync::finish);
+}
+
+FolderSync::~FolderSync()
+{
+    checks.waitForFinished();
+    if (!root.isEmpty() && pendingCount() > 0)
+        flush();
+}
+
+void FolderSync::attach(TaskModel *taskModel)
+{
+    for (const QMetaObject::Connection &connection : std::as_const(connections))
+        disconnect(connection);
+    connections.clear();
+
+    model = taskModel;
+    if (!model)
+        return;
+
+    connections << connect(model, &TaskModel::rowsInserted, this, [this](const QModelIndex &, int first, int last) {
+        if (applying)
+            return;
+        for (int row = first; row <= last; ++row)
+        {
+            if (!model->isDeleted(row))
+                markDirty(model->taskId(row));
+        }
+    });
+    connections << connect(model, &TaskModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &, int first, int last) {
+        for (int row = first; row <= last; ++row)
+            markRemoved(model->taskId(row));
+    });
+    connections << connect(model, &TaskModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+        if (applying)
+            return;
+        const bool deleted = roles.contains(TaskModel::DeletedRole);
+        const bool stored = roles.isEmpty() || roles.contains(TaskModel::TitleRole) || roles.contains(TaskModel::DescriptionRole)
+                            || roles.contains(TaskModel::CompletedRole) || roles.contains(TaskModel::PriorityRole);
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+        {
+            const quint64 id = model->taskId(row);
+            if (model->isDeleted(row))
+                markRemoved(id);
+            else if (deleted || stored)
+                markDirty(id);
+        }
+    });
+    connections << connect(model, &TaskModel::modelReset, this, [this]() {
+        const QList<quint64> ids = pathOf.keys();
+        for (quint64 id : ids)
+        {
+            if (model->indexOfTask(id) < 0)
+                markRemoved(id);
+        }
+        for (int row = 0; row < model->rowCount(); ++row)
+        {
+            if (!model->isDeleted(row) && !pathOf.contains(model->taskId(row)))
+                markDirty(model->taskId(row));
+        }
+    });
+}
+
+bool FolderSync::open(const QString &directory, const QString &cacheFile)
+{
+    if (!model)
+    {
+        qWarning() << "FolderSync::open: no model attached";
+        return false;
+    }
+    if (!QDir().mkpath(directory))
+    {
+        qWarning() << "FolderSync::open: cannot create" << directory;
+        return false;
+    }
+
+    // A scan of the previous directory is dropped.
+    checks.waitForFinished();
+    busy = false;
+    rescanPending = false;
+
+    if (!root.isEmpty() && pendingCount() > 0)
+        flush();
+    root = QDir(directory).absolutePath();
+    cachePath = cacheFile;
+    files.clear();
+    pathOf.clear();
+    dirty.clear();
+    removed.clear();
+    loadCache();
+
+    importing = true;
+    return scan();
+}
+
+FolderSync::Check FolderSync::check(const QString &root, const QString &path, const Entry &cached, qint64 now)
+{
+    Check result;
+    result.path = path;
+    result.entry = cached;
+
+    const QFileInfo info(root + u'/' + path);
+    const qint64 mtime = modificationTime(info);
+    if (!cached.hash.isEmpty() && cached.size == info.size() && cached.mtime == mtime
+        && cached.checkedAt - mtime >= RacyWindowMs)
+        return result;
+
+    QFile file(info.filePath());
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "FolderSync: cannot read" << info.filePath() << file.errorString();
+        return result;
+    }
+    const QByteArray content = file.readAll();
+    const QByteArray hash = contentHash(content);
+
+    result.entry.mtime = mtime;
+    result.entry.size = content.size();
+    result.entry.checkedAt = now;
+    result.entry.hash = hash;
+    if (hash == cached.hash)
+        return result;
+
+    if (!TaskFile::parse(content, TaskFile::formatOf(path), result.file))
+    {
+        qWarning() << "FolderSync: not a task file" << info.filePath();
+        return result;
+    }
+    result.file.title = result.file.title.trimmed();
+    if (result.file.title.isEmpty())
+        result.file.title = info.completeBaseName();
+    result.entry.uid = result.file.uid;
+    result.changed = true;
+    return result;
+}
+
+bool FolderSync::scan()
+{
+    if (root.isEmpty() || !model)
+        return false;
+    if (busy)
+    {
+        rescanPending = true;
+        return true;
+    }
+
+    busy = true;
+    checks.setFuture(QtConcurrent::run(&FolderSync::run, root, files, QDateTime::currentMSecsSinceEpoch()));
+    return true;
+}
+
+void FolderSync::waitForScan()
+{
+    checks.waitForFinished();
+    finish();
+}
+
+void FolderSync::finish()
+{
+    if (!busy)
+        return;
+
+    busy = false;
+    applyScan(checks.result());
+
+    if (importing && model)
+    {
+        importing = false;
+
+        // Live tasks without a file get one.
+        for (int row = 0; row < model->rowCount(); ++row)
+        {
+            if (!model->isDeleted(row) && !pathOf.contains(model->taskId(row)))
+                dirty.insert(model->taskId(row));
+        }
+        flush();
+    }
+
+    if (rescanPending)
+    {
+        rescanPending = false;
+        scan();
+    }
+}
+
+QList<FolderSync::Check> FolderSync::run(const QString &root, const QHash<QString, Entry> &cached, qint64 now)
+{
+    QStringList paths;
+    QDirIterator it(root, {QStringLiteral("*.md"), QStringLiteral("*.ics")}, QDir::Files, QDirIterator::Subdirectories);
+    const QDir base(root);
+    while (it.hasNext())
+        paths.append(base.relativeFilePath(it.next()));
+
+    // Workers only read the snapshot of the cache; results are applied on the thread of the sync.
+    return QtConcurrent::blockingMapped<QList<Check>>(paths, [&root, &cached, now](const QString &path) {
+        return check(root, path, cached.value(path), now);
+    });
+}
+
+void FolderSync::applyScan(const QList<Check> &results)
+{
+    if (!model)
+        return;
+
+    QSet<QString> listed;
+    listed.reserve(results.size());
+    for (const Check &result : results)
+        listed.insert(result.path);
+
+    // Files that are gone, by the identifier inside them, for new files that are renames.
+    QHash<QString, QString> vanished;
+    for (auto entry = files.cbegin(); entry != files.cend(); ++entry)
+    {
+        if (!entry->uid.isEmpty() && !listed.contains(entry.key()))
+            vanished.insert(entry->uid, entry.key());
+    }
+
+    int parsed = 0;
+    for (const Check &result : results)
+    {
+        if (result.changed)
+        {
+            // A file that reappears under another name keeps its task.
+            if (!files.contains(result.path) && !result.file.uid.isEmpty())
+            {
+                const auto renamed = vanished.constFind(result.file.uid);
+                if (renamed != vanished.constEnd())
+                {
+                    const quint64 taskId = files.take(*renamed).taskId;
+                    files[result.path].taskId = taskId;
+                    vanished.erase(renamed);
+                }
+            }
+            ++parsed;
+        }
+        apply(result);
+    }
+
+    // Deleted files take their tasks to the trash.
+    applying = true;
+    for (auto entry = files.begin(); entry != files.end();)
+    {
+        if (listed.contains(entry.key()))
+        {
+            ++entry;
+            continue;
+        }
+        const int row = entry->taskId ? model->indexOfTask(entry->taskId) : -1;
+        if (row >= 0)
+            model->removeTask(row);
+        dirty.remove(entry->taskId);
+        pathOf.remove(entry->taskId);
+        entry = files.erase(entry);
+    }
+    applying = false;
+
+    watchDirectories();
+    saveCache();
+    emit scanned(parsed, int(files.size()));
+}
+
+void FolderSync::apply(const Check &result)
+{
+    Entry entry = result.entry;
+    entry.taskId = files.value(result.path).taskId;
+    if (!result.changed)
+    {
+        files.insert(result.path, entry);
+        return;
+    }
+
+    applying = true;
+    const TaskRecord record = result.file.toRecord();
+    const int row = entry.taskId ? model->indexOfTask(entry.taskId) : -1;
+    if (row >= 0 && !model->isDeleted(row))
+    {
+        // On conflict the file wins; the task's pending local edit is dropped.
+        const TaskRecord current = model->getTask(row);
+        const QModelIndex index = model->index(row);
+        if (current.getTitle() != record.getTitle())
+            model->setData(index, record.getTitle(), TaskModel::TitleRole);
+        if (current.getDescription() != record.getDescription())
+            model->setData(index, record.getDescription(), TaskModel::DescriptionRole);
+        if (current.getPriority() != record.getPriority())
+            model->setData(index, record.getPriority(), TaskModel::PriorityRole);
+        if (current.getCompleted() != record.getCompleted())
+            model->setData(index, record.getCompleted(), TaskModel::CompletedRole);
+        dirty.remove(entry.taskId);
+    }
+    else if (model->addTasks({record}) > 0)
+    {
+        entry.taskId = model->taskId(model->rowCount() - 1);
+    }
+    else
+    {
+        entry.taskId = 0;
+    }
+    applying = false;
+
+    files.insert(result.path, entry);
+    if (entry.taskId)
+        pathOf.insert(entry.taskId, result.path);
+}
+
+void FolderSync::markDirty(quint64 taskId)
+{
+    if (root.isEmpty())
+        return;
+
+    // A task restored before its file was removed keeps the file.
+    const auto it = removed.constFind(taskId);
+    if (it != removed.constEnd())
+    {
+        pathOf.insert(taskId, *it);
+        removed.erase(it);
+    }
+    dirty.insert(taskId);
+    if (!writeTimer.isActive())
+        writeTimer.start();
+}
+
+void FolderSync::markRemoved(quint64 taskId)
+{
+    dirty.remove(taskId);
+    const auto it = pathOf.constFind(taskId);
+    if (it == pathOf.constEnd())
+        return;
+
+    removed.insert(taskId, *it);
+    pathOf.erase(it);
+    if (!writeTimer.isActive())
+        writeTimer.start();
+}
+
+bool FolderSync::flush()
+{
+    writeTimer.stop();
+    if (root.isEmpty())
+        return false;
+
+    bool ok = true;
+    int count = 0;
+    for (auto it = removed.begin(); it != removed.end();)
+    {
+        QFile file(root + u'/' + *it);
+        if (file.exists() && !file.remove())
+        {
+            emit writeFailed(*it, file.errorString());
+            ok = false;
+            ++it;
+            continue;
+        }
+        files.remove(*it);
+        it = removed.erase(it);
+        ++count;
+    }
+
+    const QList<quint64> ids = dirty.values();
+    for (quint64 id : ids)
+    {
+        if (writeTask(id))
+        {
+            dirty.remove(id);
+            ++count;
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+
+    saveCache();
+    if (count > 0)
+        emit written(count);
+    return ok;
+}
+
+bool FolderSync::writeTask(quint64 taskId)
+{
+    const int row = model ? model->indexOfTask(taskId) : -1;
+    if (row < 0 || model->isDeleted(row))
+        return true;
+
+    QString path = pathOf.value(taskId);
+    Entry entry = files.value(path);
+    QByteArray original;
+    if (!path.isEmpty())
+    {
+        QFile file(root + u'/' + path);
+        if (file.open(QIODevice::ReadOnly))
+        {
+            // Changed on disk since the last scan: the file wins, the next scan imports it.
+            const QFileInfo info(file);
+            if (info.size() != entry.size || modificationTime(info) != entry.mtime)
+            {
+                scanTimer.start();
+                return true;
+            }
+            original = file.readAll();
+        }
+    }
+    if (entry.uid.isEmpty())
+        entry.uid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    if (path.isEmpty())
+        path = entry.uid + TaskFile::extension(format);
+
+    const QByteArray content = TaskFile::write(TaskFile::fromRecord(model->getTask(row), entry.uid), TaskFile::formatOf(path), original);
+    if (content != original)
+    {
+        QSaveFile file(root + u'/' + path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit())
+        {
+            emit writeFailed(path, file.errorString());
+            return false;
+        }
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    entry.mtime = modificationTime(QFileInfo(root + u'/' + path));
+    entry.size = content.size();
+    entry.checkedAt = now;
+    entry.hash = contentHash(content);
+    entry.taskId = taskId;
+    files.insert(path, entry);
+    pathOf.insert(taskId, path);
+    return true;
+}
+
+void FolderSync::watchDirectories()
+{
+    QStringList directories{root};
+    QDirIterator it(root, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        directories.append(it.next());
+
+    const QStringList watched = watcher.directories();
+    if (QSet<QString>(watched.cbegin(), watched.cend()) == QSet<QString>(directories.cbegin(), directories.cend()))
+        return;
+    if (!watched.isEmpty())
+        watcher.removePaths(watched);
+    watcher.addPaths(directories);
+}
+
+bool FolderSync::loadCache()
+{
+    if (cachePath.isEmpty())
+        return false;
+
+    QFile file(cachePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString directory;
+    quint32 count = 0;
+    in >> magic >> version >> directory >> count;
+    if (in.status() != QDataStream::Ok || magic != CacheMagic || version != FormatVersion || directory != root)
+        return false;
+
+    QHash<QString, Entry> entries;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString path;
+        Entry entry;
+        in >> path >> entry.mtime >> entry.size >> entry.checkedAt >> entry.hash >> entry.uid >> entry.taskId;
+        entries.insert(path, entry);
+    }
+    if (in.status() != QDataStream::Ok)
+    {
+        qWarning() << "FolderSync: ignoring damaged cache" << cachePath;
+        return false;
+    }
+
+    // Files of tasks the model no longer has are parsed and imported again.
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+    {
+        const int row = it->taskId ? model->indexOfTask(it->taskId) : -1;
+        if (row < 0 || model->isDeleted(row))
+        {
+            it->taskId = 0;
+            it->hash.clear();
+        }
+        else
+        {
+            pathOf.insert(it->taskId, it.key());
+        }
+    }
+    files = entries;
+    return true;
+}
+
+void FolderSync::saveCache() const
+{
+    if (cachePath.isEmpty())
+        return;
+
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "FolderSync: cannot write" << cachePath << file.errorString();
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << CacheMagic << FormatVersion << root << quint32(files.size());
+    for (auto it = files.cbegin(); it != files.cend(); ++it)
+        out << it.key() << it->mtime << it->size << it->checkedAt << it->hash << it->uid << it->taskId;
+
+    if (out.status() != QDataStream::Ok || !file.commit())
+        qWarning() << "FolderSync: cannot write" << cachePath << file.errorString();
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+#include "TaskFile.h"
+
+class TaskModel;
+
+
+/**
+ * @file FolderSync.h
+ * @brief Two-way sync between a TaskModel and a folder of one-file-per-task files
+ */
+
+/**
+ * @class FolderSync
+ * @brief Keeps a directory of .md and .ics task files and a model in step, both ways
+ *
+ * Every live task of the model has one file in the directory, and every task file in the
+ * directory (subdirectories included, hidden ones such as .git excluded) has one task.
+ * Files are mapped to tasks by id: the cache records the task id of each file along with
+ * the identifier inside it, so a renamed file keeps its task.
+ *
+ * scan() lists the directory and checks every file on the global thread pool, without
+ * blocking the caller; the results are applied to the model when the checks are done. A
+ * file whose mtime and size match the cache is skipped without being read, unless its
+ * mtime was too recent to be trusted when it was cached; otherwise it is read and hashed,
+ * and only a file whose hash changed is parsed. New files add tasks, changed files update
+ * their tasks, and deleted files move their tasks to the trash. When both sides changed,
+ * the file wins. The directory is rescanned when it changes, and on demand.
+ *
+ * Local edits mark their tasks; writeDelay() after the first one, each marked task is
+ * written to its own file with an atomic rename (QSaveFile) and deleted tasks' files are
+ * removed. Nothing else in the directory is touched. New tasks get a file named after a
+ * new identifier in newFileFormat().
+ *
+ * Example usage:
+ * @code
+ * FolderSync *sync = new FolderSync(this);
+ * sync->attach(model);
+ * sync->open(QDir::homePath() + "/notes/tasks", dataDir + "/folder-sync.cache");
+ * @endcode
+ */
+class FolderSync : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Default time from the first local edit to writing the files, in milliseconds
+     */
+    static constexpr int DefaultWriteDelay = 500;
+
+    /**
+     * @brief A file whose mtime is less than this before it was cached is hashed on every scan
+     *
+     * Covers file systems with coarse timestamps, where a file rewritten right after a
+     * scan can keep its mtime and size.
+     */
+    static constexpr qint64 RacyWindowMs = 2000;
+
+    /**
+     * @brief Constructs a sync without a directory
+     * @param parent The parent QObject
+     */
+    explicit FolderSync(QObject *parent = nullptr);
+
+    /**
+     * @brief Waits for a running scan, dropping its result, and writes pending local edits
+     */
+    ~FolderSync() override;
+
+    /**
+     * @brief Starts syncing a model
+     * @param model The model to keep in step; replaces any previously attached model
+     */
+    void attach(TaskModel *model);
+
+    /**
+     * @brief Opens a directory and syncs it with the model
+     * @param directory Path of the directory; created if it does not exist
+     * @param cacheFile Path of the file keeping the scan cache and the file-to-task map
+     *                  between sessions; without it every file is parsed on open
+     * @return true if the directory could be opened
+     *
+     * Starts the first scan. When it is applied, files of tasks that are no longer in the
+     * model are imported again and live tasks without a file get one.
+     */
+    bool open(const QString &directory, const QString &cacheFile = QString());
+
+    /**
+     * @brief Gets the directory, empty if none is open
+     */
+    QString directory() const { return root; }
+
+    /**
+     * @brief Starts a rescan; one requested while a scan runs starts when it ends
+     * @return false if no directory is open
+     *
+     * File changes are applied to the model when the scan is done; see scanned().
+     */
+    bool scan();
+
+    /**
+     * @brief Blocks until the running scan, if any, is applied
+     */
+    void waitForScan();
+
+    /**
+     * @brief Whether a scan is running
+     */
+    bool isScanning() const { return busy; }
+
+    /**
+     * @brief Writes the files of all locally edited tasks and saves the cache
+     * @return false if a file could not be written; its task stays marked
+     */
+    bool flush();
+
+    /**
+     * @brief Gets the format of files created for new tasks
+     */
+    TaskFile::Format newFileFormat() const { return format; }
+
+    /**
+     * @brief Sets the format of files created for new tasks (default Markdown)
+     */
+    void setNewFileFormat(TaskFile::Format newFormat) { format = newFormat; }
+
+    int writeDelay() const { return writeTimer.interval(); }
+
+    /**
+     * @brief Sets the time from the first local edit to writing the files
+     */
+    void setWriteDelay(int ms) { writeTimer.setInterval(ms); }
+
+    /**
+     * @brief Gets the number of task files
+     */
+    int fileCount() const { return int(files.size()); }
+
+    /**
+     * @brief Gets the number of tasks with unwritten local edits
+     */
+    int pendingCount() const { return int(dirty.size() + removed.size()); }
+
+    /**
+     * @brief Gets the path of a task's file, relative to directory(); empty if none
+     */
+    QString fileOf(quint64 taskId) const { return pathOf.value(taskId); }
+
+signals:
+
+    /**
+     * @brief Emitted after a scan was applied to the model
+     * @param parsed Number of new or changed files
+     * @param files Number of task files
+     */
+    void scanned(int parsed, int files);
+
+    /**
+     * @brief Emitted after local edits were written
+     * @param written Number of files written or removed
+     */
+    void written(int written);
+
+    /**
+     * @brief Emitted when a file could not be written or removed
+     */
+    void writeFailed(const QString &path, const QString &error);
+
+private:
+
+    /**
+     * @brief What the cache knows about a task file
+     */
+    struct Entry
+    {
+        qint64 mtime = 0;         ///< Modification time at the last check, ms since the epoch
+        qint64 size = -1;         ///< Size at the last check
+        qint64 checkedAt = 0;     ///< When the file was last read, ms since the epoch
+        QByteArray hash;          ///< Hash of the content at the last check
+        QString uid;              ///< Identifier inside the file
+        quint64 taskId = 0;       ///< Task of the file
+    };
+
+    /**
+     * @brief Result of checking one file on a worker thread
+     */
+    struct Check
+    {
+        QString path;             ///< Path relative to the directory
+        Entry entry;              ///< Updated cache entry
+        bool changed = false;     ///< Whether the content changed, i.e. file was parsed
+        TaskFile file;            ///< Parsed task, if changed
+    };
+
+    QPointer<TaskModel> model;            ///< Synced model
+    QList<QMetaObject::Connection> connections; ///< Connections to the model
+    QString root;                         ///< Directory, empty if none
+    QString cachePath;                    ///< Cache file, empty if none
+    QHash<QString, Entry> files;          ///< Task files by relative path
+    QHash<quint64, QString> pathOf;       ///< Relative path of each task's file
+    QSet<quint64> dirty;                  ///< Tasks whose files need writing
+    QHash<quint64, QString> removed;      ///< Files to delete, by the id of their deleted task
+    TaskFile::Format format = TaskFile::Markdown; ///< Format of new files
+    bool applying = false;                ///< Set while file changes are applied to the model
+    QTimer writeTimer;                    ///< Delays writing local edits
+    QTimer scanTimer;                     ///< Debounces rescans on directory changes
+    QFileSystemWatcher watcher;           ///< Watches the directory tree
+    QFutureWatcher<QList<Check>> checks;  ///< Running scan
+    bool busy = false;                    ///< Set from the start of a scan until it is applied
+    bool rescanPending = false;           ///< A scan was requested while one was running
+    bool importing = false;               ///< The running scan is the first one after open()
+
+    static QList<Check> run(const QString &root, const QHash<QString, Entry> &cached, qint64 now);
+    static Check check(const QString &root, const QString &path, const Entry &cached, qint64 now);
+    void finish();
+    void applyScan(const QList<Check> &results);
+    void apply(const Check &result);
+    void markDirty(quint64 taskId);
+    void markRemoved(quint64 taskId);
+    bool writeTask(quint64 taskId);
+    void watchDirectories();
+    bool loadCache();
+    void saveCache() const;
+};
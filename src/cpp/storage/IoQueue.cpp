@@ -0,0 +1,592 @@
+#include "IoQueue.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFuture>
+#include <QThread>
+#include <QThreadPool>
+#include <QVarLengthArray>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+#if defined(Q_OS_LINUX) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register) \
+    && defined(IORING_FEAT_RW_CUR_POS)
+#define IOQUEUE_HAVE_IO_URING
+#include <sys/mman.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+namespace
+{
+
+bool succeeded(const IoRequest &request)
+{
+    return request.result >= 0 && (request.op != IoRequest::Write || request.result == request.data.size());
+}
+
+#if defined(Q_OS_UNIX)
+
+/**
+ * Runs one request as blocking calls, retrying interrupted and partial transfers.
+ */
+void perform(IoRequest &request)
+{
+    qint64 done = 0;
+    switch (request.op)
+    {
+    case IoRequest::Write:
+        while (done < request.data.size())
+        {
+            const ssize_t n = ::pwrite(request.fd, request.data.constData() + done, size_t(request.data.size() - done),
+                                       off_t(request.offset + done));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                request.result = n < 0 ? -errno : -EIO;
+                return;
+            }
+            done += n;
+        }
+        break;
+    case IoRequest::Read:
+        request.data.resize(request.length);
+        while (done < request.length)
+        {
+            const ssize_t n = ::pread(request.fd, request.data.data() + done, size_t(request.length - done),
+                                      off_t(request.offset + done));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+            {
+                request.result = -errno;
+                request.data.clear();
+                return;
+            }
+            if (n == 0)
+                break;
+            done += n;
+        }
+        request.data.resize(done);
+        break;
+    case IoRequest::Sync:
+#if defined(Q_OS_LINUX)
+        if (::fdatasync(request.fd) != 0)
+#else
+        if (::fsync(request.fd) != 0)
+#endif
+        {
+            request.result = -errno;
+            return;
+        }
+        break;
+    }
+    request.result = done;
+}
+
+#else
+
+void perform(IoRequest &request)
+{
+    // Requests of one batch run one at a time here (see PoolEngine), so seeking is safe.
+    QFile file;
+    if (!file.open(request.fd, request.op == IoRequest::Read ? QIODevice::ReadOnly : QIODevice::ReadWrite,
+                   QFileDevice::DontCloseHandle))
+    {
+        request.result = -EBADF;
+        return;
+    }
+
+    switch (request.op)
+    {
+    case IoRequest::Write:
+        request.result = file.seek(request.offset) ? file.write(request.data) : -EIO;
+        if (request.result >= 0 && !file.flush())
+            request.result = -EIO;
+        break;
+    case IoRequest::Read:
+        request.data = file.seek(request.offset) ? file.read(request.length) : QByteArray();
+        request.result = file.error() == QFileDevice::NoError ? request.data.size() : -EIO;
+        break;
+    case IoRequest::Sync:
+        request.result = file.flush() ? 0 : -EIO;
+        break;
+    }
+}
+
+#endif
+
+/**
+ * Runs a chain of linked requests in order, cancelling the rest after a failure.
+ */
+void performChain(IoRequest *requests, int count)
+{
+    bool cancelled = false;
+    for (int i = 0; i < count; ++i)
+    {
+        if (cancelled)
+        {
+            requests[i].result = -ECANCELED;
+            continue;
+        }
+        perform(requests[i]);
+        cancelled = !succeeded(requests[i]);
+    }
+}
+
+}
+
+/**
+ * @brief Backend of an IoQueue
+ */
+class IoQueue::Engine
+{
+public:
+    virtual ~Engine() = default;
+    virtual Backend backend() const = 0;
+
+    /**
+     * Runs up to QueueDepth requests as one submission. Chains end within the batch.
+     */
+    virtual void submit(IoRequest *requests, int count) = 0;
+
+    /**
+     * Writes records back to back, then syncs; returns the bytes written or -1.
+     */
+    virtual qint64 append(int fd, qint64 offset, const QList<QByteArray> &records, bool sync, qint64 &submissions)
+    {
+        QByteArray data;
+        for (const QByteArray &record : records)
+            data.append(record);
+
+        IoRequest requests[2] = {IoRequest::write(fd, offset, data, sync), IoRequest::sync(fd)};
+        submit(requests, sync ? 2 : 1);
+        ++submissions;
+        return succeeded(requests[0]) && (!sync || succeeded(requests[1])) ? data.size() : -1;
+    }
+};
+
+/**
+ * @brief Blocking calls on a thread pool, one task per chain
+ */
+class IoQueue::PoolEngine : public IoQueue::Engine
+{
+public:
+    PoolEngine()
+    {
+#if defined(Q_OS_UNIX)
+        pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 8));
+#else
+        // perform() seeks a shared file position, so everything runs on the calling thread.
+        pool.setMaxThreadCount(1);
+#endif
+    }
+
+    Backend backend() const override { return ThreadPool; }
+
+    void submit(IoRequest *requests, int count) override
+    {
+        QVarLengthArray<QFuture<void>, 16> chains;
+        int start = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            if (requests[i].linked && i + 1 < count)
+                continue;
+
+            IoRequest *chain = requests + start;
+            const int length = i + 1 - start;
+            // The last chain runs on the calling thread, which would otherwise only wait.
+            if (i + 1 == count || pool.maxThreadCount() == 1)
+                performChain(chain, length);
+            else
+                chains.append(QtConcurrent::run(&pool, [chain, length]() { performChain(chain, length); }));
+            start = i + 1;
+        }
+        for (QFuture<void> &chain : chains)
+            chain.waitForFinished();
+    }
+
+private:
+    QThreadPool pool; ///< Workers running the chains
+};
+
+#ifdef IOQUEUE_HAVE_IO_URING
+
+/**
+ * @brief io_uring instance with its submission and completion rings mapped
+ */
+class IoQueue::RingEngine : public IoQueue::Engine
+{
+public:
+    ~RingEngine() override
+    {
+        if (buffers != MAP_FAILED)
+            ::munmap(buffers, size_t(JournalBuffers) * JournalBufferSize);
+        if (sqes != MAP_FAILED)
+            ::munmap(sqes, sqesSize);
+        if (ring != MAP_FAILED)
+            ::munmap(ring, ringSize);
+        if (ringFd >= 0)
+            ::close(ringFd);
+    }
+
+    /**
+     * Sets the ring up; returns an empty string or why io_uring cannot be used.
+     */
+    QString setup()
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ringFd = int(::syscall(__NR_io_uring_setup, unsigned(QueueDepth), &params));
+        if (ringFd < 0)
+            return QStringLiteral("io_uring_setup: ") + QString::fromLocal8Bit(std::strerror(errno));
+
+        // IORING_OP_READ/WRITE arrived with RW_CUR_POS in 5.6; a single mapping with 5.4.
+        const unsigned required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_RW_CUR_POS;
+        if ((params.features & required) != required)
+            return QStringLiteral("kernel older than 5.6");
+
+        ringSize = qMax(size_t(params.sq_off.array + params.sq_entries * sizeof(unsigned)),
+                        size_t(params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe)));
+        ring = ::mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = ::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (ring == MAP_FAILED || sqes == MAP_FAILED)
+            return QStringLiteral("mmap: ") + QString::fromLocal8Bit(std::strerror(errno));
+
+        char *base = static_cast<char *>(ring);
+        sqHead = reinterpret_cast<unsigned *>(base + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned *>(base + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned *>(base + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned *>(base + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned *>(base + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned *>(base + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned *>(base + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(base + params.cq_off.cqes);
+        sqLocalTail = *sqTail;
+
+        // Journal buffers are pinned once; without them append() uses plain writes.
+        buffers = ::mmap(nullptr, size_t(JournalBuffers) * JournalBufferSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buffers != MAP_FAILED)
+        {
+            iovec vectors[JournalBuffers];
+            for (int i = 0; i < JournalBuffers; ++i)
+                vectors[i] = {static_cast<char *>(buffers) + qsizetype(i) * JournalBufferSize, size_t(JournalBufferSize)};
+            registered = ::syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS, vectors, JournalBuffers) == 0;
+            if (!registered)
+                qWarning() << "IoQueue: cannot register journal buffers:" << std::strerror(errno);
+        }
+        return QString();
+    }
+
+    Backend backend() const override { return IoUring; }
+
+    void submit(IoRequest *requests, int count) override
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            IoRequest &request = requests[i];
+            io_uring_sqe *sqe = nextSqe();
+            sqe->fd = request.fd;
+            sqe->user_data = quint64(i);
+            sqe->flags = request.linked ? IOSQE_IO_LINK : 0;
+            switch (request.op)
+            {
+            case IoRequest::Write:
+                sqe->opcode = IORING_OP_WRITE;
+                sqe->addr = quint64(quintptr(request.data.constData()));
+                sqe->len = quint32(qMin<qint64>(request.data.size(), MaxTransfer));
+                sqe->off = quint64(request.offset);
+                break;
+            case IoRequest::Read:
+                request.data.resize(request.length);
+                sqe->opcode = IORING_OP_READ;
+                sqe->addr = quint64(quintptr(request.data.data()));
+                sqe->len = quint32(qMin<qint64>(request.length, MaxTransfer));
+                sqe->off = quint64(request.offset);
+                break;
+            case IoRequest::Sync:
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+                break;
+            }
+        }
+
+        QVarLengthArray<qint64, QueueDepth> results(count);
+        enter(count, results.data());
+
+        bool resync = false;
+        for (int i = 0; i < count; ++i)
+        {
+            IoRequest &request = requests[i];
+            request.result = results[i];
+            if (request.op == IoRequest::Read)
+                request.data.resize(request.result >= 0 ? request.result : 0);
+
+            // Regular files complete writes in full; finish a rare short one by hand.
+            if (request.op == IoRequest::Write && request.result >= 0 && request.result < request.data.size())
+            {
+                IoRequest rest = IoRequest::write(request.fd, request.offset + request.result,
+                                                  request.data.mid(request.result));
+                perform(rest);
+                request.result = rest.result < 0 ? rest.result : request.data.size();
+                resync = resync || request.linked;
+            }
+            else if (resync && request.op == IoRequest::Sync && request.result == 0)
+            {
+                perform(request);
+            }
+            if (!request.linked)
+                resync = false;
+        }
+    }
+
+    qint64 append(int fd, qint64 offset, const QList<QByteArray> &records, bool sync, qint64 &submissions) override
+    {
+        if (!registered)
+            return Engine::append(fd, offset, records, sync, submissions);
+
+        // Fill the registered buffers, write them as one chain and sync at the end of the
+        // group; groups larger than all buffers take several rounds.
+        qint64 written = 0;
+        qsizetype record = 0;
+        qsizetype within = 0;
+        do
+        {
+            int count = 0;
+            for (int buffer = 0; buffer < JournalBuffers && record < records.size(); ++buffer)
+            {
+                char *target = static_cast<char *>(buffers) + qsizetype(buffer) * JournalBufferSize;
+                qsizetype filled = 0;
+                while (filled < JournalBufferSize && record < records.size())
+                {
+                    const QByteArray &data = records.at(record);
+                    const qsizetype chunk = qMin(JournalBufferSize - filled, data.size() - within);
+                    std::memcpy(target + filled, data.constData() + within, size_t(chunk));
+                    filled += chunk;
+                    within += chunk;
+                    if (within == data.size())
+                    {
+                        ++record;
+                        within = 0;
+                    }
+                }
+                if (filled == 0)
+                    continue;
+
+                io_uring_sqe *sqe = nextSqe();
+                sqe->opcode = IORING_OP_WRITE_FIXED;
+                sqe->fd = fd;
+                sqe->flags = IOSQE_IO_LINK;
+                sqe->addr = quint64(quintptr(target));
+                sqe->len = quint32(filled);
+                sqe->off = quint64(offset + written);
+                sqe->buf_index = quint16(buffer);
+                sqe->user_data = quint64(count++);
+                written += filled;
+            }
+
+            if (sync && record == records.size())
+            {
+                io_uring_sqe *sqe = nextSqe();
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->fd = fd;
+                sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+                sqe->user_data = quint64(count++);
+            }
+            else if (count > 0)
+            {
+                sqeAt(sqLocalTail - 1)->flags = 0;
+            }
+            if (count == 0)
+                break;
+
+            QVarLengthArray<qint64, JournalBuffers + 1> results(count);
+            enter(count, results.data());
+            ++submissions;
+            for (int i = 0; i < count; ++i)
+            {
+                const io_uring_sqe *sqe = sqeAt(sqLocalTail - unsigned(count) + unsigned(i));
+                if (results[i] < 0 || (sqe->opcode == IORING_OP_WRITE_FIXED && results[i] != qint64(sqe->len)))
+                    return -1;
+            }
+        } while (record < records.size());
+        return written;
+    }
+
+private:
+    static constexpr qint64 MaxTransfer = 1 << 30; ///< Largest transfer per request
+
+    int ringFd = -1;                 ///< io_uring instance
+    void *ring = MAP_FAILED;         ///< Shared submission and completion rings
+    size_t ringSize = 0;             ///< Size of ring
+    void *sqes = MAP_FAILED;         ///< Submission queue entries
+    size_t sqesSize = 0;             ///< Size of sqes
+    void *buffers = MAP_FAILED;      ///< Journal buffers
+    bool registered = false;         ///< Whether buffers are registered with the ring
+
+    unsigned *sqHead = nullptr;      ///< Kernel's consumer position in the submission ring
+    unsigned *sqTail = nullptr;      ///< Our producer position in the submission ring
+    unsigned sqMask = 0;             ///< Index mask of the submission ring
+    unsigned *sqArray = nullptr;     ///< Indexes of the entries in the submission ring
+    unsigned sqLocalTail = 0;        ///< Tail including entries not yet published
+    unsigned *cqHead = nullptr;      ///< Our consumer position in the completion ring
+    unsigned *cqTail = nullptr;      ///< Kernel's producer position in the completion ring
+    unsigned cqMask = 0;             ///< Index mask of the completion ring
+    io_uring_cqe *cqes = nullptr;    ///< Completion queue entries
+
+    io_uring_sqe *sqeAt(unsigned position) const
+    {
+        return static_cast<io_uring_sqe *>(sqes) + (position & sqMask);
+    }
+
+    io_uring_sqe *nextSqe()
+    {
+        io_uring_sqe *sqe = sqeAt(sqLocalTail);
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray[sqLocalTail & sqMask] = sqLocalTail & sqMask;
+        ++sqLocalTail;
+        return sqe;
+    }
+
+    /**
+     * Publishes the last count entries, submits them and waits for all their completions
+     * with as few io_uring_enter() calls as possible. results is indexed by user_data.
+     */
+    void enter(int count, qint64 *results)
+    {
+        const unsigned first = sqLocalTail - unsigned(count);
+        __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+
+        int expected = count;
+        int submittedCount = 0;
+        int completed = 0;
+        while (completed < expected)
+        {
+            const int ret = int(::syscall(__NR_io_uring_enter, ringFd, unsigned(expected - submittedCount),
+                                          unsigned(expected - completed), IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                // Take back what the kernel has not consumed; nothing else reads the ring.
+                const int error = errno;
+                const unsigned consumed = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+                __atomic_store_n(sqTail, consumed, __ATOMIC_RELEASE);
+                sqLocalTail = consumed;
+                expected = int(consumed - first);
+                submittedCount = expected;
+                for (int i = expected; i < count; ++i)
+                    results[i] = -error;
+            }
+            else if (ret > 0)
+            {
+                submittedCount += ret;
+            }
+
+            unsigned head = *cqHead;
+            const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            while (head != tail)
+            {
+                const io_uring_cqe &cqe = cqes[head & cqMask];
+                if (cqe.user_data < quint64(count))
+                    results[cqe.user_data] = cqe.res;
+                ++head;
+                ++completed;
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        }
+    }
+};
+
+#endif
+
+IoQueue::IoQueue(Backend preferred)
+{
+#ifdef IOQUEUE_HAVE_IO_URING
+    if (preferred == IoUring)
+    {
+        auto ring = std::make_unique<RingEngine>();
+        reason = ring->setup();
+        if (reason.isEmpty())
+            engine = std::move(ring);
+    }
+    else
+    {
+        reason = QStringLiteral("thread pool requested");
+    }
+#else
+    Q_UNUSED(preferred)
+    reason = QStringLiteral("io_uring is only available on Linux");
+#endif
+    if (!engine)
+        engine = std::make_unique<PoolEngine>();
+}
+
+IoQueue::~IoQueue() = default;
+
+IoQueue::Backend IoQueue::backend() const
+{
+    return engine->backend();
+}
+
+bool IoQueue::run(QList<IoRequest> &requests)
+{
+    QMutexLocker locker(&mutex);
+    const int total = int(requests.size());
+    int start = 0;
+    while (start < total)
+    {
+        // A chain longer than one submission continues only if its last request succeeded.
+        if (start > 0 && requests[start - 1].linked && !succeeded(requests[start - 1]))
+        {
+            requests[start].result = -ECANCELED;
+            requests[start].data.clear();
+            ++start;
+            continue;
+        }
+
+        // End submissions at the end of a chain where possible.
+        int count = qMin(int(QueueDepth), total - start);
+        if (start + count < total)
+        {
+            int end = start + count;
+            while (end > start && requests[end - 1].linked)
+                --end;
+            if (end > start)
+                count = end - start;
+        }
+
+        engine->submit(requests.data() + start, count);
+        ++submitted;
+        start += count;
+    }
+
+    for (const IoRequest &request : std::as_const(requests))
+    {
+        if (!succeeded(request))
+            return false;
+    }
+    return true;
+}
+
+qint64 IoQueue::append(int fd, qint64 offset, const QList<QByteArray> &records, bool sync)
+{
+    QMutexLocker locker(&mutex);
+    return engine->append(fd, offset, records, sync, submitted);
+}
+
+bool IoQueue::isIoUringAvailable()
+{
+    static const bool available = IoQueue(IoUring).backend() == IoUring;
+    return available;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include <memory>
+
+
+/**
+ * @file IoQueue.h
+ * @brief Batched file I/O on io_uring, with a thread-pool fallback
+ */
+
+/**
+ * @struct IoRequest
+ * @brief One read, write or sync submitted to an IoQueue
+ */
+struct IoRequest
+{
+    /**
+     * @brief Operation of a request
+     */
+    enum Op
+    {
+        Read,   ///< Read length bytes at offset into data
+        Write,  ///< Write data at offset
+        Sync    ///< Flush the file's data to disk
+    };
+
+    Op op = Write;          ///< Operation
+    int fd = -1;            ///< Open file descriptor, e.g. QFile::handle()
+    qint64 offset = 0;      ///< File offset of Read and Write
+    qint64 length = 0;      ///< Number of bytes to Read
+    QByteArray data;        ///< Bytes to Write, or the bytes read
+    bool linked = false;    ///< Whether the next request only runs if this one succeeds
+    qint64 result = 0;      ///< Bytes transferred (0 for Sync), or a negative errno
+
+    static IoRequest read(int fd, qint64 offset, qint64 length) { return {Read, fd, offset, length, {}, false, 0}; }
+    static IoRequest write(int fd, qint64 offset, const QByteArray &data, bool linked = false) { return {Write, fd, offset, 0, data, linked, 0}; }
+    static IoRequest sync(int fd) { return {Sync, fd, 0, 0, {}, false, 0}; }
+};
+
+/**
+ * @class IoQueue
+ * @brief Runs batches of file requests with as few system calls as the platform allows
+ *
+ * On Linux kernels with io_uring (5.6 or later, and not disabled by policy), a batch of up
+ * to QueueDepth requests is submitted and reaped with a single io_uring_enter() call. A
+ * chain of linked requests runs in order and stops at the first failure, the remaining
+ * requests of the chain completing with -ECANCELED; a write linked to a sync therefore
+ * becomes durable in the same submission. append() writes journal records from buffers
+ * registered with the kernel once, so no pages have to be pinned per call, and commits a
+ * whole group of records with one linked sync; AuditLog appends its entries this way.
+ *
+ * Elsewhere, or if the ring cannot be set up, requests run as blocking calls on a small
+ * thread pool: chains run concurrently with each other, the requests of a chain in order
+ * with the same cancellation rule.
+ *
+ * An IoQueue may be shared between threads; batches are run one at a time.
+ *
+ * Example usage:
+ * @code
+ * IoQueue io;
+ * QList<IoRequest> batch;
+ * for (QFile *file : files)
+ * {
+ *     batch.append(IoRequest::write(file->handle(), 0, pages.value(file), true));
+ *     batch.append(IoRequest::sync(file->handle()));
+ * }
+ * if (!io.run(batch))
+ *     qWarning() << "write failed";
+ * @endcode
+ */
+class IoQueue
+{
+public:
+
+    /**
+     * @brief Mechanism running the requests
+     */
+    enum Backend
+    {
+        ThreadPool, ///< Blocking calls on worker threads
+        IoUring     ///< Linux io_uring
+    };
+
+    /**
+     * @brief Maximum number of requests per submission
+     */
+    static constexpr int QueueDepth = 256;
+
+    /**
+     * @brief Number of buffers registered for append()
+     */
+    static constexpr int JournalBuffers = 8;
+
+    /**
+     * @brief Size of each buffer registered for append(), in bytes
+     */
+    static constexpr int JournalBufferSize = 64 * 1024;
+
+    /**
+     * @brief Sets up a queue
+     * @param preferred Backend to use if available; IoUring falls back to ThreadPool
+     */
+    explicit IoQueue(Backend preferred = IoUring);
+    ~IoQueue();
+
+    IoQueue(const IoQueue &) = delete;
+    IoQueue &operator=(const IoQueue &) = delete;
+
+    /**
+     * @brief Gets the backend in use
+     */
+    Backend backend() const;
+
+    /**
+     * @brief Gets why io_uring is not in use, empty if it is
+     */
+    QString fallbackReason() const { return reason; }
+
+    /**
+     * @brief Runs a batch of requests and waits for all of them
+     * @param requests Requests to run; result and, for reads, data are filled in
+     * @return true if every request succeeded and transferred all its bytes
+     *
+     * Reads stop early at the end of the file; their data holds what was read.
+     */
+    bool run(QList<IoRequest> &requests);
+
+    /**
+     * @brief Appends journal records to a file as one group commit
+     * @param fd Open file descriptor
+     * @param offset File offset of the first record, normally the file size
+     * @param records Records to write back to back
+     * @param sync Whether to flush the file's data once all records are written
+     * @return Number of bytes written, or -1 if a write or the sync failed
+     */
+    qint64 append(int fd, qint64 offset, const QList<QByteArray> &records, bool sync = true);
+
+    /**
+     * @brief Gets the number of submissions made, io_uring_enter() calls or pool rounds
+     */
+    qint64 submissions() const { return submitted; }
+
+    /**
+     * @brief Whether io_uring can be used on this system
+     */
+    static bool isIoUringAvailable();
+
+private:
+
+    class Engine;
+    class PoolEngine;
+    class RingEngine;
+
+    std::unique_ptr<Engine> engine; ///< Backend implementation
+    QString reason;                 ///< Why io_uring is not in use
+    qint64 submitted = 0;           ///< Submissions made
+    QMutex mutex;                   ///< Serializes batches
+};
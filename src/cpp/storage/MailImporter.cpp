@@ -0,0 +1,684 @@
+#include "MailImporter.h"
+#include "TaskModel.h"
+#include "TextScanner.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringDecoder>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtEndian>
+
+#include <cctype>
+#include <cstring>
+
+namespace
+{
+
+constexpr int MaxNesting = 4;
+
+/**
+ * The headers a task needs; the others are skipped while parsing.
+ */
+struct Headers
+{
+    QByteArray messageId;
+    QByteArray subject;
+    QByteArray from;
+    QByteArray date;
+    QByteArray contentType;
+    QByteArray encoding;
+    QByteArray priority;
+    QByteArray importance;
+};
+
+enum TextKind
+{
+    NoText,
+    HtmlText,
+    PlainText
+};
+
+bool sameName(QByteArrayView name, const char *wanted)
+{
+    return qstrnicmp(name.data(), name.size(), wanted, qsizetype(std::strlen(wanted))) == 0;
+}
+
+QByteArray *field(Headers &headers, QByteArrayView name)
+{
+    if (sameName(name, "message-id"))
+        return &headers.messageId;
+    if (sameName(name, "subject"))
+        return &headers.subject;
+    if (sameName(name, "from"))
+        return &headers.from;
+    if (sameName(name, "date"))
+        return &headers.date;
+    if (sameName(name, "content-type"))
+        return &headers.contentType;
+    if (sameName(name, "content-transfer-encoding"))
+        return &headers.encoding;
+    if (sameName(name, "x-priority"))
+        return &headers.priority;
+    if (sameName(name, "importance"))
+        return &headers.importance;
+    return nullptr;
+}
+
+/**
+ * Reads a header block, unfolding continuation lines. Returns the offset of the body, or
+ * -1 if the data does not start with a header.
+ */
+qsizetype parseHeaders(const char *data, qsizetype length, Headers &headers)
+{
+    QByteArray *current = nullptr;
+    bool any = false;
+    qsizetype position = 0;
+    while (position < length)
+    {
+        const void *newline = std::memchr(data + position, '\n', size_t(length - position));
+        const qsizetype end = newline ? static_cast<const char *>(newline) - data : length;
+        const qsizetype next = newline ? end + 1 : length;
+        qsizetype lineEnd = end;
+        if (lineEnd > position && data[lineEnd - 1] == '\r')
+            --lineEnd;
+        if (lineEnd == position)
+            return next;
+
+        const QByteArrayView line(data + position, lineEnd - position);
+        if (line.front() == ' ' || line.front() == '\t')
+        {
+            if (current)
+            {
+                current->append(' ');
+                current->append(line.trimmed());
+            }
+        }
+        else
+        {
+            const qsizetype colon = line.indexOf(':');
+            if (colon <= 0)
+            {
+                if (!any)
+                    return -1;
+                current = nullptr;
+            }
+            else
+            {
+                any = true;
+                // Only the first occurrence of a header counts.
+                current = field(headers, line.first(colon).trimmed());
+                if (current && current->isEmpty())
+                    *current = line.sliced(colon + 1).trimmed().toByteArray();
+                else
+                    current = nullptr;
+            }
+        }
+        position = next;
+    }
+    return any ? length : -1;
+}
+
+QByteArray parameter(const QByteArray &value, const char *name)
+{
+    const QList<QByteArray> parts = value.split(';');
+    for (qsizetype i = 1; i < parts.size(); ++i)
+    {
+        const qsizetype equals = parts[i].indexOf('=');
+        if (equals <= 0 || !sameName(parts[i].left(equals).trimmed(), name))
+            continue;
+        QByteArray result = parts[i].mid(equals + 1).trimmed();
+        if (result.size() >= 2 && result.startsWith('"') && result.endsWith('"'))
+            result = result.mid(1, result.size() - 2);
+        return result;
+    }
+    return QByteArray();
+}
+
+QByteArray mediaType(const QByteArray &contentType)
+{
+    const qsizetype semicolon = contentType.indexOf(';');
+    const QByteArray type = (semicolon < 0 ? contentType : contentType.left(semicolon)).trimmed().toLower();
+    return type.isEmpty() ? QByteArrayLiteral("text/plain") : type;
+}
+
+QString decodeCharset(const QByteArray &bytes, const QByteArray &charset)
+{
+    if (!charset.isEmpty())
+    {
+        QStringDecoder decoder(charset.constData());
+        if (decoder.isValid())
+        {
+            QString text = decoder.decode(bytes);
+            if (!decoder.hasError())
+                return text;
+        }
+    }
+    QStringDecoder utf8(QStringDecoder::Utf8);
+    QString text = utf8.decode(bytes);
+    return utf8.hasError() ? QString::fromLatin1(bytes) : text;
+}
+
+QByteArray decodeQuotedPrintable(QByteArrayView input, bool header)
+{
+    QByteArray output;
+    output.reserve(input.size());
+    for (qsizetype i = 0; i < input.size(); ++i)
+    {
+        const char c = input[i];
+        if (c == '_' && header)
+        {
+            output.append(' ');
+        }
+        else if (c == '=' && i + 1 < input.size() && (input[i + 1] == '\n' || input[i + 1] == '\r'))
+        {
+            // Soft line break.
+            i += input[i + 1] == '\r' && i + 2 < input.size() && input[i + 2] == '\n' ? 2 : 1;
+        }
+        else if (c == '=' && i + 2 < input.size() && isxdigit(uchar(input[i + 1])) && isxdigit(uchar(input[i + 2])))
+        {
+            output.append(char(QByteArray::fromHex(input.sliced(i + 1, 2).toByteArray()).at(0)));
+            i += 2;
+        }
+        else
+        {
+            output.append(c);
+        }
+    }
+    return output;
+}
+
+/**
+ * Decodes the RFC 2047 words of a header value; the rest is taken as UTF-8.
+ */
+QString decodeHeader(const QByteArray &value)
+{
+    QString text;
+    qsizetype position = 0;
+    bool afterWord = false;
+    while (position < value.size())
+    {
+        const qsizetype start = value.indexOf("=?", position);
+        const qsizetype charsetEnd = start < 0 ? -1 : value.indexOf('?', start + 2);
+        const qsizetype end = charsetEnd < 0 || charsetEnd + 2 >= value.size() || value[charsetEnd + 2] != '?'
+                                  ? -1 : value.indexOf("?=", charsetEnd + 3);
+        if (end < 0)
+        {
+            text += decodeCharset(value.mid(position), QByteArray());
+            break;
+        }
+
+        // Whitespace between two encoded words is dropped.
+        const QByteArray between = value.mid(position, start - position);
+        if (!afterWord || !between.trimmed().isEmpty())
+            text += decodeCharset(between, QByteArray());
+
+        QByteArray charset = value.mid(start + 2, charsetEnd - start - 2);
+        const qsizetype language = charset.indexOf('*');
+        if (language >= 0)
+            charset.truncate(language);
+        const QByteArrayView payload = QByteArrayView(value).sliced(charsetEnd + 3, end - charsetEnd - 3);
+        const char encoding = value[charsetEnd + 1];
+        const QByteArray bytes = encoding == 'B' || encoding == 'b' ? QByteArray::fromBase64(payload.toByteArray())
+                                                                    : decodeQuotedPrintable(payload, true);
+        text += decodeCharset(bytes, charset);
+        position = end + 2;
+        afterWord = true;
+    }
+    return text.simplified();
+}
+
+QString stripHtml(const QString &html)
+{
+    QString text;
+    text.reserve(html.size());
+    bool inTag = false;
+    for (const QChar c : html)
+    {
+        if (c == u'<')
+            inTag = true;
+        else if (c == u'>' && inTag)
+            inTag = false;
+        else if (!inTag)
+            text += c;
+    }
+    text.replace(QLatin1String("&nbsp;"), QLatin1String(" "));
+    text.replace(QLatin1String("&lt;"), QLatin1String("<"));
+    text.replace(QLatin1String("&gt;"), QLatin1String(">"));
+    text.replace(QLatin1String("&quot;"), QLatin1String("\""));
+    text.replace(QLatin1String("&#39;"), QLatin1String("'"));
+    text.replace(QLatin1String("&amp;"), QLatin1String("&"));
+    return text;
+}
+
+/**
+ * Finds the first text of a body: a text/plain part if there is one, else a text/html part.
+ */
+TextKind extractText(const char *data, qsizetype length, const QByteArray &contentType, const QByteArray &encoding,
+                     int depth, QString &text)
+{
+    const QByteArray type = mediaType(contentType);
+    if (type.startsWith("multipart/"))
+    {
+        const QByteArray boundary = parameter(contentType, "boundary");
+        if (boundary.isEmpty() || depth >= MaxNesting)
+            return NoText;
+
+        const QByteArray delimiter = "\n--" + boundary;
+        QString html;
+        // The first delimiter may open the body, without a newline before it.
+        qsizetype position = length >= delimiter.size() - 1 && std::memcmp(data, delimiter.constData() + 1, size_t(delimiter.size() - 1)) == 0
+                                 ? 0 : TextScanner::indexOf(data, length, delimiter.constData(), delimiter.size());
+        while (position >= 0 && position < length)
+        {
+            const void *newline = std::memchr(data + position + 1, '\n', size_t(length - position - 1));
+            if (!newline)
+                break;
+            const qsizetype partStart = static_cast<const char *>(newline) - data + 1;
+            const qsizetype closing = position + (data[position] == '\n' ? delimiter.size() : delimiter.size() - 1);
+            if (closing + 1 < length && data[closing] == '-' && data[closing + 1] == '-')
+                break;
+
+            const qsizetype found = TextScanner::indexOf(data + partStart, length - partStart, delimiter.constData(), delimiter.size());
+            const qsizetype partEnd = found < 0 ? length : partStart + found;
+
+            Headers part;
+            const qsizetype body = parseHeaders(data + partStart, partEnd - partStart, part);
+            if (body >= 0)
+            {
+                QString partText;
+                const TextKind kind = extractText(data + partStart + body, partEnd - partStart - body, part.contentType, part.encoding, depth + 1, partText);
+                if (kind == PlainText)
+                {
+                    text = partText;
+                    return PlainText;
+                }
+                if (kind == HtmlText && html.isEmpty())
+                    html = partText;
+            }
+            position = found < 0 ? -1 : partEnd;
+        }
+        if (html.isEmpty())
+            return NoText;
+        text = html;
+        return HtmlText;
+    }
+
+    if (type != "text/plain" && type != "text/html")
+        return NoText;
+
+    // Only the start of the body is decoded; the description keeps a prefix of it anyway.
+    const QByteArrayView raw(data, qMin(length, MailImporter::MaxBodyBytes));
+    const QByteArray transfer = encoding.trimmed().toLower();
+    QByteArray bytes;
+    if (transfer == "base64")
+        bytes = QByteArray::fromBase64(raw.toByteArray());
+    else if (transfer == "quoted-printable")
+        bytes = decodeQuotedPrintable(raw, false);
+    else
+        bytes = raw.toByteArray();
+
+    text = decodeCharset(bytes, parameter(contentType, "charset"));
+    if (type == "text/html")
+    {
+        text = stripHtml(text);
+        return HtmlText;
+    }
+    return PlainText;
+}
+
+quint64 fnv1a(QByteArrayView bytes, quint64 hash = 14695981039346656037ULL)
+{
+    for (const char c : bytes)
+    {
+        hash ^= uchar(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+MailImporter::Message parseMapped(const QString &path)
+{
+    MailImporter::Message message;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "MailImporter: cannot read" << path << file.errorString();
+        return message;
+    }
+    const qint64 size = file.size();
+    if (const uchar *mapped = size > 0 ? file.map(0, size) : nullptr)
+    {
+        MailImporter::Message::parse(reinterpret_cast<const char *>(mapped), size, message);
+    }
+    else
+    {
+        const QByteArray content = file.readAll();
+        MailImporter::Message::parse(content.constData(), content.size(), message);
+    }
+    return message;
+}
+
+}
+
+bool MailImporter::Message::parse(const char *data, qsizetype length, Message &message)
+{
+    message = Message();
+
+    // The mbox envelope line is not a header.
+    if (length >= 5 && std::memcmp(data, "From ", 5) == 0)
+    {
+        const void *newline = std::memchr(data, '\n', size_t(length));
+        const qsizetype skip = newline ? static_cast<const char *>(newline) - data + 1 : length;
+        data += skip;
+        length -= skip;
+    }
+
+    Headers headers;
+    const qsizetype body = parseHeaders(data, length, headers);
+    if (body < 0)
+        return false;
+
+    message.subject = decodeHeader(headers.subject);
+    message.from = decodeHeader(headers.from);
+    message.date = QDateTime::fromString(QString::fromLatin1(headers.date), Qt::RFC2822Date);
+    message.key = !headers.messageId.isEmpty()
+                      ? fnv1a(headers.messageId)
+                      : fnv1a(headers.subject, fnv1a(headers.from, fnv1a(headers.date)));
+
+    const QByteArray importance = headers.importance.trimmed().toLower();
+    const QByteArray priority = headers.priority.trimmed();
+    const char urgency = priority.isEmpty() ? '3' : priority.front();
+    if (urgency == '1' || urgency == '2' || importance == "high")
+        message.priority = 2;
+    else if (urgency == '4' || urgency == '5' || importance == "low")
+        message.priority = 0;
+
+    QString text;
+    if (extractText(data + body, length - body, headers.contentType, headers.encoding, 0, text) != NoText)
+    {
+        text.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+        // mboxrd quotes body lines starting with "From ".
+        text.replace(QLatin1String("\n>From "), QLatin1String("\nFrom "));
+        text = text.trimmed();
+        if (text.size() > MaxDescriptionLength)
+            text.truncate(MaxDescriptionLength);
+        message.body = text;
+    }
+    return true;
+}
+
+TaskRecord MailImporter::Message::toRecord() const
+{
+    const QString title = subject.isEmpty() ? QStringLiteral("(no subject)") : subject;
+    QString description = body;
+    if (!from.isEmpty())
+        description = QStringLiteral("From: %1\n\n%2").arg(from, body).trimmed();
+    return TaskRecord(title, description, priority, false, date);
+}
+
+MailImporter::MailImporter(QObject *parent)
+    : QObject(parent), queued(QueuedBatches)
+{
+    connect(&watcher, &QFutureWatcher<bool>::finished, this, &MailImporter::finish);
+}
+
+MailImporter::~MailImporter()
+{
+    // A worker waiting for room in the queue wakes up to see the cancellation.
+    cancelled = true;
+    queued.release(QueuedBatches);
+    watcher.waitForFinished();
+}
+
+void MailImporter::attach(TaskModel *taskModel)
+{
+    model = taskModel;
+}
+
+bool MailImporter::setHistoryFile(const QString &path)
+{
+    historyPath = path;
+    QFile file(path);
+    if (!file.exists())
+        return true;
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "MailImporter: cannot read" << path << file.errorString();
+        return false;
+    }
+
+    const QByteArray keys = file.readAll();
+    seen.reserve(seen.size() + keys.size() / qsizetype(sizeof(quint64)));
+    for (qsizetype offset = 0; offset + qsizetype(sizeof(quint64)) <= keys.size(); offset += sizeof(quint64))
+        seen.insert(qFromLittleEndian<quint64>(keys.constData() + offset));
+    return true;
+}
+
+int MailImporter::import(const QString &path)
+{
+    return QFileInfo(path).isDir() ? importMaildir(path) : importMbox(path);
+}
+
+int MailImporter::importMbox(const QString &path)
+{
+    if (!model)
+    {
+        qWarning() << "MailImporter::importMbox: no model attached";
+        return -1;
+    }
+
+    int added = 0;
+    const bool read = readMbox(path, [this, &added](const QList<Message> &messages, qint64 done, qint64 total) {
+        added += insert(messages);
+        emit progress(done, total);
+        return true;
+    });
+    return read ? added : -1;
+}
+
+int MailImporter::importMaildir(const QString &directory)
+{
+    if (!model)
+    {
+        qWarning() << "MailImporter::importMaildir: no model attached";
+        return -1;
+    }
+
+    int added = 0;
+    const bool read = readMaildir(directory, [this, &added](const QList<Message> &messages, qint64 done, qint64 total) {
+        added += insert(messages);
+        emit progress(done, total);
+        return true;
+    });
+    return read ? added : -1;
+}
+
+bool MailImporter::start(const QString &path)
+{
+    if (!model)
+    {
+        qWarning() << "MailImporter::start: no model attached";
+        return false;
+    }
+    if (running)
+    {
+        qWarning() << "MailImporter::start: an import is running";
+        return false;
+    }
+
+    running = true;
+    backgroundAdded = 0;
+    const bool maildir = QFileInfo(path).isDir();
+    watcher.setFuture(QtConcurrent::run([this, path, maildir]() {
+        const Batch batch = [this](const QList<Message> &messages, qint64 done, qint64 total) {
+            queued.acquire();
+            if (cancelled)
+                return false;
+
+            // The model and the keys seen belong to the thread of the importer.
+            QMetaObject::invokeMethod(this, [this, messages, done, total]() {
+                if (model)
+                    backgroundAdded += insert(messages);
+                queued.release();
+                emit progress(done, total);
+            }, Qt::QueuedConnection);
+            return true;
+        };
+        return maildir ? readMaildir(path, batch) : readMbox(path, batch);
+    }));
+    emit importingChanged();
+    return true;
+}
+
+void MailImporter::finish()
+{
+    // Queued after the batches of the import, so all of them are in the model.
+    running = false;
+    emit importingChanged();
+    emit imported(watcher.result() ? backgroundAdded : -1);
+}
+
+bool MailImporter::readMbox(const QString &path, const Batch &batch)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "MailImporter: cannot read" << path << file.errorString();
+        return false;
+    }
+
+    static const char separator[] = "\nFrom ";
+    const qint64 size = file.size();
+    qint64 offset = 0;
+    qint64 window = WindowSize;
+    while (offset < size)
+    {
+        const qint64 length = qMin(window, size - offset);
+        const bool last = offset + length == size;
+        const uchar *mapped = file.map(offset, length);
+        if (!mapped)
+        {
+            qWarning() << "MailImporter: cannot map" << path << file.errorString();
+            return true;
+        }
+        const char *data = reinterpret_cast<const char *>(mapped);
+
+        // Split the window at "From " lines; the last message is complete only at the end of the file.
+        QList<QPair<qsizetype, qsizetype>> spans;
+        qsizetype start = 0;
+        if (offset == 0 && (length < 5 || std::memcmp(data, "From ", 5) != 0))
+        {
+            const qsizetype first = TextScanner::indexOf(data, length, separator, 6);
+            start = first < 0 ? length : first + 1;
+        }
+        qsizetype consumed = start;
+        while (start < length)
+        {
+            const qsizetype found = TextScanner::indexOf(data + start, length - start, separator, 6);
+            if (found < 0)
+            {
+                if (last)
+                {
+                    spans.append({start, length - start});
+                    consumed = length;
+                }
+                break;
+            }
+            spans.append({start, found + 1});
+            start += found + 1;
+            consumed = start;
+        }
+
+        if (spans.isEmpty() && !last)
+        {
+            // One message is larger than the window.
+            file.unmap(const_cast<uchar *>(mapped));
+            window *= 2;
+            continue;
+        }
+
+        for (qsizetype first = 0; first < spans.size(); first += BatchSize)
+        {
+            const QList<QPair<qsizetype, qsizetype>> part = spans.mid(first, BatchSize);
+            const QList<Message> messages = QtConcurrent::blockingMapped<QList<Message>>(part, [data](const QPair<qsizetype, qsizetype> &span) {
+                Message message;
+                Message::parse(data + span.first, span.second, message);
+                return message;
+            });
+            if (!batch(messages, offset + part.last().first + part.last().second, size))
+                return true;
+        }
+
+        file.unmap(const_cast<uchar *>(mapped));
+        offset += consumed;
+        window = WindowSize;
+        if (consumed == 0)
+            break;
+    }
+    return true;
+}
+
+bool MailImporter::readMaildir(const QString &directory, const Batch &batch)
+{
+    if (!QFileInfo(directory).isDir())
+    {
+        qWarning() << "MailImporter: not a directory" << directory;
+        return false;
+    }
+
+    // Messages live in cur and new; tmp holds deliveries in progress.
+    QStringList paths;
+    QDirIterator it(directory, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        const QString path = it.next();
+        const QString parent = it.fileInfo().dir().dirName();
+        if (parent == QLatin1String("cur") || parent == QLatin1String("new"))
+            paths.append(path);
+    }
+
+    for (qsizetype first = 0; first < paths.size(); first += BatchSize)
+    {
+        const QStringList part = paths.mid(first, BatchSize);
+        if (!batch(QtConcurrent::blockingMapped<QList<Message>>(part, parseMapped), first + part.size(), paths.size()))
+            break;
+    }
+    return true;
+}
+
+int MailImporter::insert(const QList<Message> &messages)
+{
+    QList<TaskRecord> records;
+    QByteArray keys;
+    records.reserve(messages.size());
+    for (const Message &message : messages)
+    {
+        if (!message.key)
+            continue;
+        if (seen.contains(message.key))
+        {
+            ++duplicates;
+            continue;
+        }
+        seen.insert(message.key);
+        records.append(message.toRecord());
+
+        const quint64 key = qToLittleEndian(message.key);
+        keys.append(reinterpret_cast<const char *>(&key), sizeof(key));
+    }
+    if (records.isEmpty())
+        return 0;
+
+    const int added = model->addTasks(records);
+    if (!historyPath.isEmpty())
+    {
+        QFile file(historyPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || file.write(keys) != keys.size())
+            qWarning() << "MailImporter: cannot write" << historyPath << file.errorString();
+    }
+    return added;
+}
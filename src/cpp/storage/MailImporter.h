@@ -0,0 +1,226 @@
+#pragma once
+
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QPointer>
+#include <QSemaphore>
+#include <QSet>
+#include "TaskRecord.h"
+
+#include <atomic>
+#include <functional>
+
+class TaskModel;
+
+
+/**
+ * @file MailImporter.h
+ * @brief Turns the emails of an mbox file or a Maildir folder into tasks
+ */
+
+/**
+ * @class MailImporter
+ * @brief Imports emails as tasks, skipping the ones it imported before
+ *
+ * An mbox file is memory-mapped one window of WindowSize bytes at a time. Message
+ * boundaries ("From " lines) are found with TextScanner's vectorized byte search, and the
+ * messages of a window are parsed in parallel on the global thread pool. A message that
+ * does not fit in a window grows the window. Maildir folders (the cur and new
+ * directories, Maildir++ subfolders included) are read BatchSize files at a time, each
+ * file mapped and parsed on the pool.
+ *
+ * Parsing stops as soon as it has what a task needs: the headers, and the first
+ * text/plain part of the body (or the first text/html one, without its tags), of which
+ * only the first MaxBodyBytes are decoded. Subject and sender are decoded from RFC 2047
+ * words, the body from quoted-printable or base64 and its charset.
+ *
+ * Every message is keyed by a 64-bit hash of its Message-ID (of its date, sender and
+ * subject if it has none). Keys already seen are skipped; the others are inserted into
+ * the model with one addTasks() call per batch and appended to the history file, so an
+ * archive imported twice yields its tasks once. Memory stays bounded by the window, the
+ * batch and eight bytes per key.
+ *
+ * import() runs on the calling thread, which blocks until it is done. start() reads and
+ * parses on a worker thread instead and hands each batch to the thread of the importer,
+ * where it is inserted into the model; at most QueuedBatches wait there, so a slow
+ * model holds the worker back rather than filling memory. progress() is emitted after
+ * every batch is inserted, on the thread of the importer either way.
+ *
+ * Example usage:
+ * @code
+ * MailImporter importer;
+ * importer.attach(model);
+ * importer.setHistoryFile(dataDir + "/mail-import.history");
+ * importer.import(QDir::homePath() + "/mail/inbox.mbox");
+ *
+ * // Without blocking the GUI thread
+ * connect(&importer, &MailImporter::imported, this, [](int added) { qDebug() << added; });
+ * importer.start(QDir::homePath() + "/mail/inbox.mbox");
+ * @endcode
+ */
+class MailImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Bytes of an mbox file mapped at a time
+     */
+    static constexpr qint64 WindowSize = 64 << 20;
+
+    /**
+     * @brief Messages parsed and inserted together
+     */
+    static constexpr int BatchSize = 4096;
+
+    /**
+     * @brief Parsed batches of start() that may wait for insertion at a time
+     */
+    static constexpr int QueuedBatches = 2;
+
+    /**
+     * @brief Bytes of a body decoded for the description
+     */
+    static constexpr qsizetype MaxBodyBytes = 16 << 10;
+
+    /**
+     * @brief Longest description, in characters
+     */
+    static constexpr int MaxDescriptionLength = 2000;
+
+    /**
+     * @brief What a task needs of an email
+     */
+    struct Message
+    {
+        quint64 key = 0;            ///< Deduplication key
+        QString subject;            ///< Decoded Subject
+        QString from;               ///< Decoded From
+        QDateTime date;             ///< Date, invalid if missing or malformed
+        QString body;               ///< Start of the first text part
+        int priority = 1;           ///< From X-Priority or Importance: 0=Low, 1=Medium, 2=High
+
+        /**
+         * @brief Decodes an email
+         * @param data The message, optionally starting with an mbox "From " line
+         * @param length Number of bytes
+         * @param message Receives the message
+         * @return false if the data has no header
+         */
+        static bool parse(const char *data, qsizetype length, Message &message);
+
+        /**
+         * @brief Gets the task of the message
+         */
+        TaskRecord toRecord() const;
+    };
+
+    /**
+     * @brief Constructs an importer without a model
+     * @param parent The parent QObject
+     */
+    explicit MailImporter(QObject *parent = nullptr);
+
+    /**
+     * @brief Stops a running start() and waits for its worker; batches not inserted yet are dropped
+     */
+    ~MailImporter() override;
+
+    /**
+     * @brief Sets the model receiving the tasks
+     */
+    void attach(TaskModel *model);
+
+    /**
+     * @brief Sets the file keeping the keys of imported messages between sessions
+     * @param path Path of the file; its keys are read now, new keys are appended
+     * @return false if the file exists but cannot be read
+     */
+    bool setHistoryFile(const QString &path);
+
+    /**
+     * @brief Imports a Maildir folder if the path is a directory, an mbox file otherwise
+     * @return Number of tasks added, or -1 if nothing could be read
+     */
+    int import(const QString &path);
+
+    /**
+     * @brief Imports an mbox file
+     * @return Number of tasks added, or -1 if the file cannot be read
+     */
+    int importMbox(const QString &path);
+
+    /**
+     * @brief Imports the messages of a Maildir folder and its Maildir++ subfolders
+     * @return Number of tasks added, or -1 if the folder does not exist
+     */
+    int importMaildir(const QString &directory);
+
+    /**
+     * @brief Starts importing a Maildir folder or an mbox file on a worker thread
+     * @return false if no model is attached or an import is running
+     *
+     * Like import(), but the calling thread only inserts the parsed batches, from its event
+     * loop; imported() reports the outcome.
+     */
+    bool start(const QString &path);
+
+    /**
+     * @brief Whether an import started with start() is running
+     */
+    bool isImporting() const { return running; }
+
+    /**
+     * @brief Gets the number of messages skipped as already imported, since construction
+     */
+    int duplicateCount() const { return duplicates; }
+
+    /**
+     * @brief Gets the number of distinct messages known
+     */
+    int knownCount() const { return int(seen.size()); }
+
+signals:
+
+    /**
+     * @brief Emitted after every batch
+     * @param done Bytes (mbox) or files (Maildir) processed
+     * @param total Size of the file or number of files
+     */
+    void progress(qint64 done, qint64 total);
+
+    /**
+     * @brief Emitted when start() begins or ends an import
+     */
+    void importingChanged();
+
+    /**
+     * @brief Emitted when an import started with start() is done and all its batches are inserted
+     * @param added Number of tasks added, or -1 if nothing could be read
+     */
+    void imported(int added);
+
+private:
+
+    /**
+     * @brief Receives a parsed batch with the progress after it; returns false to stop reading
+     */
+    using Batch = std::function<bool(const QList<Message> &messages, qint64 done, qint64 total)>;
+
+    QPointer<TaskModel> model;    ///< Model receiving the tasks
+    QSet<quint64> seen;           ///< Keys of imported messages
+    QString historyPath;          ///< File of the keys, empty if none
+    int duplicates = 0;           ///< Messages skipped as already imported
+    QFutureWatcher<bool> watcher; ///< Worker of start(); its result is whether the source could be read
+    QSemaphore queued;            ///< Room for batches waiting for insertion
+    std::atomic<bool> cancelled{false}; ///< Set when the importer is destroyed during start()
+    bool running = false;         ///< Set from start() until imported()
+    int backgroundAdded = 0;      ///< Tasks added by the running start()
+
+    static bool readMbox(const QString &path, const Batch &batch);
+    static bool readMaildir(const QString &directory, const Batch &batch);
+    void finish();
+    int insert(const QList<Message> &messages);
+};
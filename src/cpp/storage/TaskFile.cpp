@@ -0,0 +1,408 @@
+#include "TaskFile.h"
+
+#include <QList>
+#include <QStringList>
+#include <QTimeZone>
+
+namespace
+{
+
+constexpr int FoldWidth = 75; // RFC 5545 line length limit in octets, without the CRLF
+
+const char *const PriorityNames[] = {"low", "medium", "high"};
+
+// VTODO properties written by TaskFile; all others of an existing file are kept.
+bool isOwnProperty(const QByteArray &name)
+{
+    return name == "SUMMARY" || name == "DESCRIPTION" || name == "PRIORITY" || name == "STATUS"
+           || name == "COMPLETED" || name == "PERCENT-COMPLETE" || name == "UID" || name == "CREATED"
+           || name == "DTSTAMP" || name == "LAST-MODIFIED";
+}
+
+bool isOwnKey(const QString &key)
+{
+    return key == "uid" || key == "id" || key == "priority" || key == "completed" || key == "done"
+           || key == "status" || key == "created";
+}
+
+QString formatUtc(const QDateTime &time)
+{
+    return time.toUTC().toString(QStringLiteral("yyyyMMdd'T'HHmmss'Z'"));
+}
+
+QDateTime parseIcalTime(const QString &value)
+{
+    const bool utc = value.endsWith(u'Z');
+    QDateTime time = QDateTime::fromString(utc ? value.chopped(1) : value, QStringLiteral("yyyyMMdd'T'HHmmss"));
+    if (!time.isValid())
+        time = QDateTime(QDate::fromString(value, QStringLiteral("yyyyMMdd")), QTime(0, 0));
+    if (utc && time.isValid())
+        time.setTimeZone(QTimeZone::UTC);
+    return time;
+}
+
+QString unescapeText(const QString &value)
+{
+    QString text;
+    text.reserve(value.size());
+    for (qsizetype i = 0; i < value.size(); ++i)
+    {
+        const QChar c = value.at(i);
+        if (c != u'\\' || i + 1 == value.size())
+        {
+            text.append(c);
+            continue;
+        }
+        const QChar next = value.at(++i);
+        text.append(next == u'n' || next == u'N' ? QChar(u'\n') : next);
+    }
+    return text;
+}
+
+QString escapeText(const QString &text)
+{
+    QString value;
+    value.reserve(text.size());
+    for (const QChar c : text)
+    {
+        if (c == u'\\' || c == u';' || c == u',')
+            value.append(u'\\').append(c);
+        else if (c == u'\n')
+            value.append(QStringLiteral("\\n"));
+        else if (c != u'\r')
+            value.append(c);
+    }
+    return value;
+}
+
+// Splits a file into content lines, joining folded continuation lines.
+QList<QByteArray> unfold(const QByteArray &content)
+{
+    QList<QByteArray> lines;
+    for (QByteArray line : content.split('\n'))
+    {
+        if (line.endsWith('\r'))
+            line.chop(1);
+        if (!lines.isEmpty() && (line.startsWith(' ') || line.startsWith('\t')))
+            lines.last().append(line.constData() + 1, line.size() - 1);
+        else if (!line.isEmpty())
+            lines.append(line);
+    }
+    return lines;
+}
+
+// Appends a content line, folded at FoldWidth octets without splitting UTF-8 sequences.
+void appendFolded(QByteArray &out, const QByteArray &line)
+{
+    qsizetype start = 0;
+    int width = FoldWidth;
+    while (line.size() - start > width)
+    {
+        qsizetype end = start + width;
+        while (end > start && (quint8(line.at(end)) & 0xc0) == 0x80)
+            --end;
+        out.append(line.constData() + start, end - start).append("\r\n ");
+        start = end;
+        width = FoldWidth - 1;
+    }
+    out.append(line.constData() + start, line.size() - start).append("\r\n");
+}
+
+// Name of a content line, upper case, without parameters.
+QByteArray propertyName(const QByteArray &line)
+{
+    qsizetype end = 0;
+    while (end < line.size() && line.at(end) != ':' && line.at(end) != ';')
+        ++end;
+    return line.left(end).toUpper();
+}
+
+QString propertyValue(const QByteArray &line)
+{
+    const qsizetype colon = line.indexOf(':');
+    return colon < 0 ? QString() : QString::fromUtf8(line.mid(colon + 1));
+}
+
+bool parseIcal(const QByteArray &content, TaskFile &file)
+{
+    bool inTodo = false;
+    bool found = false;
+    for (const QByteArray &line : unfold(content))
+    {
+        const QByteArray name = propertyName(line);
+        const QString value = propertyValue(line);
+        if (name == "BEGIN" && value.compare(QLatin1String("VTODO"), Qt::CaseInsensitive) == 0 && !found)
+        {
+            inTodo = true;
+            found = true;
+            continue;
+        }
+        if (!inTodo)
+            continue;
+        if (name == "END" && value.compare(QLatin1String("VTODO"), Qt::CaseInsensitive) == 0)
+            break;
+
+        if (name == "UID")
+            file.uid = value.trimmed();
+        else if (name == "SUMMARY")
+            file.title = unescapeText(value);
+        else if (name == "DESCRIPTION")
+            file.description = unescapeText(value);
+        else if (name == "PRIORITY")
+        {
+            const int priority = value.trimmed().toInt();
+            file.priority = priority >= 1 && priority <= 4 ? 2 : priority >= 6 && priority <= 9 ? 0 : 1;
+        }
+        else if (name == "STATUS")
+            file.completed = value.trimmed().compare(QLatin1String("COMPLETED"), Qt::CaseInsensitive) == 0;
+        else if (name == "COMPLETED")
+        {
+            file.completedAt = parseIcalTime(value.trimmed());
+            file.completed = true;
+        }
+        else if (name == "CREATED")
+            file.created = parseIcalTime(value.trimmed());
+    }
+    return found;
+}
+
+QByteArray writeIcal(const TaskFile &file, const QByteArray &original)
+{
+    QList<QByteArray> todo;
+    todo.append("UID:" + file.uid.toUtf8());
+    todo.append("DTSTAMP:" + formatUtc(QDateTime::currentDateTimeUtc()).toUtf8());
+    if (file.created.isValid())
+        todo.append("CREATED:" + formatUtc(file.created).toUtf8());
+    todo.append("LAST-MODIFIED:" + formatUtc(QDateTime::currentDateTimeUtc()).toUtf8());
+    todo.append("SUMMARY:" + escapeText(file.title).toUtf8());
+    if (!file.description.isEmpty())
+        todo.append("DESCRIPTION:" + escapeText(file.description).toUtf8());
+    todo.append("PRIORITY:" + QByteArray(file.priority >= 2 ? "1" : file.priority <= 0 ? "9" : "5"));
+    todo.append(file.completed ? "STATUS:COMPLETED" : "STATUS:NEEDS-ACTION");
+    if (file.completed)
+    {
+        todo.append("PERCENT-COMPLETE:100");
+        if (file.completedAt.isValid())
+            todo.append("COMPLETED:" + formatUtc(file.completedAt).toUtf8());
+    }
+
+    QByteArray out;
+    const QList<QByteArray> lines = unfold(original);
+    bool found = false;
+    if (!lines.isEmpty())
+    {
+        bool inTodo = false;
+        for (const QByteArray &line : lines)
+        {
+            const QByteArray name = propertyName(line);
+            const QByteArray value = propertyValue(line).trimmed().toUpper().toUtf8();
+            if (name == "BEGIN" && value == "VTODO" && !found)
+            {
+                inTodo = true;
+                found = true;
+                appendFolded(out, line);
+                for (const QByteArray &own : std::as_const(todo))
+                    appendFolded(out, own);
+                continue;
+            }
+            if (inTodo && name == "END" && value == "VTODO")
+                inTodo = false;
+            else if (inTodo && isOwnProperty(name))
+                continue;
+            appendFolded(out, line);
+        }
+    }
+    if (found)
+        return out;
+
+    out.clear();
+    appendFolded(out, "BEGIN:VCALENDAR");
+    appendFolded(out, "VERSION:2.0");
+    appendFolded(out, "PRODID:-//Kinuy-Lab//TaskManager//EN");
+    appendFolded(out, "BEGIN:VTODO");
+    for (const QByteArray &own : std::as_const(todo))
+        appendFolded(out, own);
+    appendFolded(out, "END:VTODO");
+    appendFolded(out, "END:VCALENDAR");
+    return out;
+}
+
+// Splits a Markdown file into its front matter lines and its body.
+void splitFrontMatter(const QString &text, QStringList &frontMatter, QString &body)
+{
+    frontMatter.clear();
+    body = text;
+    if (!text.startsWith(QLatin1String("---")))
+        return;
+
+    QStringList lines = text.split(u'\n');
+    for (qsizetype i = 1; i < lines.size(); ++i)
+    {
+        if (lines.at(i).trimmed() == QLatin1String("---"))
+        {
+            frontMatter = lines.mid(1, i - 1);
+            body = lines.mid(i + 1).join(u'\n');
+            return;
+        }
+    }
+}
+
+bool parseMarkdown(const QByteArray &content, TaskFile &file)
+{
+    QString text = QString::fromUtf8(content);
+    text.remove(u'\r');
+
+    QStringList frontMatter;
+    QString body;
+    splitFrontMatter(text, frontMatter, body);
+    for (const QString &line : std::as_const(frontMatter))
+    {
+        const qsizetype colon = line.indexOf(u':');
+        if (colon < 0)
+            continue;
+        const QString key = line.left(colon).trimmed().toLower();
+        const QString value = line.mid(colon + 1).trimmed().remove(u'"');
+
+        if (key == "uid" || key == "id")
+            file.uid = value;
+        else if (key == "priority")
+        {
+            bool numeric = false;
+            const int number = value.toInt(&numeric);
+            if (numeric)
+                file.priority = qBound(0, number, 2);
+            else
+                file.priority = value.compare(QLatin1String("high"), Qt::CaseInsensitive) == 0  ? 2
+                                : value.compare(QLatin1String("low"), Qt::CaseInsensitive) == 0 ? 0
+                                                                                                  : 1;
+        }
+        else if (key == "completed" || key == "done")
+        {
+            file.completedAt = QDateTime::fromString(value, Qt::ISODate);
+            file.completed = file.completedAt.isValid() || value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0;
+        }
+        else if (key == "status")
+            file.completed = value.compare(QLatin1String("done"), Qt::CaseInsensitive) == 0
+                             || value.compare(QLatin1String("completed"), Qt::CaseInsensitive) == 0;
+        else if (key == "created")
+            file.created = QDateTime::fromString(value, Qt::ISODate);
+    }
+
+    // The first heading is the title; what follows it is the description.
+    QStringList lines = body.split(u'\n');
+    for (qsizetype i = 0; i < lines.size(); ++i)
+    {
+        const QString line = lines.at(i).trimmed();
+        if (line.isEmpty())
+            continue;
+        if (line.startsWith(u'#'))
+        {
+            qsizetype level = 0;
+            while (level < line.size() && line.at(level) == u'#')
+                ++level;
+            file.title = line.mid(level).trimmed();
+            lines = lines.mid(i + 1);
+        }
+        break;
+    }
+    file.description = lines.join(u'\n').trimmed();
+    return true;
+}
+
+QByteArray writeMarkdown(const TaskFile &file, const QByteArray &original)
+{
+    QString text = QString::fromUtf8(original);
+    text.remove(u'\r');
+    QStringList frontMatter;
+    QString body;
+    splitFrontMatter(text, frontMatter, body);
+
+    QStringList lines;
+    lines << QStringLiteral("---");
+    lines << QStringLiteral("uid: ") + file.uid;
+    lines << QStringLiteral("priority: ") + QLatin1String(PriorityNames[qBound(0, file.priority, 2)]);
+    if (file.completed)
+        lines << QStringLiteral("completed: ")
+                     + (file.completedAt.isValid() ? file.completedAt.toUTC().toString(Qt::ISODate) : QStringLiteral("true"));
+    if (file.created.isValid())
+        lines << QStringLiteral("created: ") + file.created.toUTC().toString(Qt::ISODate);
+    for (const QString &line : std::as_const(frontMatter))
+    {
+        const qsizetype colon = line.indexOf(u':');
+        if (colon < 0 || !isOwnKey(line.left(colon).trimmed().toLower()))
+            lines << line;
+    }
+    lines << QStringLiteral("---") << QString() << QStringLiteral("# ") + file.title;
+    if (!file.description.isEmpty())
+        lines << QString() << file.description;
+    return (lines.join(u'\n') + u'\n').toUtf8();
+}
+
+}
+
+TaskFile::Format TaskFile::formatOf(const QString &fileName)
+{
+    if (fileName.endsWith(QLatin1String(".md"), Qt::CaseInsensitive))
+        return Markdown;
+    if (fileName.endsWith(QLatin1String(".ics"), Qt::CaseInsensitive))
+        return ICalendar;
+    return Unknown;
+}
+
+QString TaskFile::extension(Format format)
+{
+    switch (format)
+    {
+    case Markdown:
+        return QStringLiteral(".md");
+    case ICalendar:
+        return QStringLiteral(".ics");
+    default:
+        return QString();
+    }
+}
+
+bool TaskFile::parse(const QByteArray &content, Format format, TaskFile &file)
+{
+    file = TaskFile();
+    switch (format)
+    {
+    case Markdown:
+        return parseMarkdown(content, file);
+    case ICalendar:
+        return parseIcal(content, file);
+    default:
+        return false;
+    }
+}
+
+QByteArray TaskFile::write(const TaskFile &file, Format format, const QByteArray &original)
+{
+    switch (format)
+    {
+    case Markdown:
+        return writeMarkdown(file, original);
+    case ICalendar:
+        return writeIcal(file, original);
+    default:
+        return QByteArray();
+    }
+}
+
+TaskFile TaskFile::fromRecord(const TaskRecord &record, const QString &uid)
+{
+    TaskFile file;
+    file.uid = uid;
+    file.title = record.getTitle();
+    file.description = record.getDescription();
+    file.priority = record.getPriority();
+    file.completed = record.getCompleted();
+    file.created = record.getDateTime();
+    file.completedAt = record.getCompletedAt();
+    return file;
+}
+
+TaskRecord TaskFile::toRecord() const
+{
+    return TaskRecord(title, description, priority, completed, created).withCompletedAt(completed ? completedAt : QDateTime());
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include "TaskRecord.h"
+
+
+/**
+ * @file TaskFile.h
+ * @brief One task per file: Markdown with front matter, or an iCalendar VTODO
+ */
+
+/**
+ * @struct TaskFile
+ * @brief The task stored in a .md or .ics file, and its encoding
+ *
+ * Markdown files carry the task's metadata in a front matter block and the title as the
+ * first heading; the rest of the file is the description:
+ * @code
+ * ---
+ * uid: 6f1c0f0e-5d7e-4b7a-9a53-2f3f0c7d9a11
+ * priority: high
+ * completed: 2024-03-01T09:30:00Z
+ * created: 2024-02-27T17:02:11Z
+ * ---
+ *
+ * # Renew the passport
+ *
+ * Photos are in the drawer.
+ * @endcode
+ *
+ * iCalendar files (RFC 5545, as kept by vdir tools) hold one VTODO; SUMMARY, DESCRIPTION,
+ * PRIORITY (1-4 high, 5 or unset medium, 6-9 low), STATUS, COMPLETED and CREATED are
+ * mapped to the task.
+ *
+ * write() updates an existing file in place where it can: front matter keys and VTODO
+ * properties the task does not use are kept, so files shared with other tools lose
+ * nothing when a task is edited here.
+ */
+struct TaskFile
+{
+    /**
+     * @brief Encoding of a file
+     */
+    enum Format
+    {
+        Unknown,    ///< Not a task file
+        Markdown,   ///< .md
+        ICalendar   ///< .ics
+    };
+
+    QString uid;                ///< Identifier in the file, empty if it has none
+    QString title;              ///< Task title
+    QString description;        ///< Task description
+    int priority = 1;           ///< 0=Low, 1=Medium, 2=High
+    bool completed = false;     ///< Completion status
+    QDateTime created;          ///< Creation time, invalid if unknown
+    QDateTime completedAt;      ///< Completion time, invalid if unknown
+
+    /**
+     * @brief Gets the format of a file from its extension
+     */
+    static Format formatOf(const QString &fileName);
+
+    /**
+     * @brief Gets the extension, with the dot, of files of a format
+     */
+    static QString extension(Format format);
+
+    /**
+     * @brief Decodes a file
+     * @param content Bytes of the file
+     * @param format Encoding of the file
+     * @param file Receives the task
+     * @return false if the content is not a task of that format
+     *
+     * A Markdown file without a heading gets an empty title; the caller falls back to the
+     * file name.
+     */
+    static bool parse(const QByteArray &content, Format format, TaskFile &file);
+
+    /**
+     * @brief Encodes a task, updating the content of an existing file
+     * @param file The task
+     * @param format Encoding of the file
+     * @param original Current content of the file, empty for a new file
+     * @return The new content of the file
+     */
+    static QByteArray write(const TaskFile &file, Format format, const QByteArray &original = QByteArray());
+
+    /**
+     * @brief Gets the task of a record, with an identifier
+     */
+    static TaskFile fromRecord(const TaskRecord &record, const QString &uid);
+
+    /**
+     * @brief Gets a record with the values of the task, without an id
+     */
+    TaskRecord toRecord() const;
+};
@@ -0,0 +1,648 @@
+#include "TaskStore.h"
+#include "Metrics.h"
+#include "TaskModel.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+constexpr quint32 ManifestMagic = 0x544d4d46; // "TMMF"
+constexpr quint32 PageMagic = 0x544d5047;     // "TMPG"
+constexpr quint32 FormatVersion = TaskStore::RecordVersion;
+
+QString pageFile(quint32 pageId, quint64 generation)
+{
+    return QStringLiteral("%1-%2.page").arg(pageId).arg(generation);
+}
+
+}
+
+TaskStore::TaskStore(QObject *parent)
+    : QObject(parent), io(std::make_shared<IoQueue>())
+{
+    autosaveTimer.setSingleShot(true);
+    connect(&autosaveTimer, &QTimer::timeout, this, [this]() { save(); });
+    connect(&watcher, &QFutureWatcher<SaveResult>::finished, this, [this]() {
+        // A save(true) may already have taken the result.
+        if (running)
+            finishSave(watcher.result());
+    });
+    connect(&loader, &QFutureWatcher<Snapshot>::finished, this, [this]() {
+        // A later open() may already have taken the result.
+        if (loading)
+            emit opened(adopt(loader.result()));
+    });
+}
+
+TaskStore::~TaskStore()
+{
+    if (running)
+        watcher.waitForFinished();
+    if (loading)
+        loader.waitForFinished();
+}
+
+void TaskStore::attach(TaskModel *taskModel)
+{
+    for (const QMetaObject::Connection &connection : std::as_const(connections))
+        disconnect(connection);
+    connections.clear();
+
+    model = taskModel;
+    rebuildPages();
+    if (!model)
+        return;
+
+    connections << connect(model, &TaskModel::rowsInserted, this, [this](const QModelIndex &, int first, int last) {
+        for (int row = first; row <= last; ++row)
+        {
+            const quint64 id = model->taskId(row);
+            // Tasks loaded by open() are already on their pages.
+            if (!model->isDeleted(row) && !(adopting && pageOf.contains(id)))
+                insertTask(id);
+        }
+    });
+    connections << connect(model, &TaskModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &, int first, int last) {
+        for (int row = first; row <= last; ++row)
+            removeTask(model->taskId(row));
+    });
+    connections << connect(model, &TaskModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+        const bool deleted = roles.contains(TaskModel::DeletedRole);
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+        {
+            const quint64 id = model->taskId(row);
+            if (deleted && model->isDeleted(row))
+                removeTask(id);
+            else if (deleted && !pageOf.contains(id))
+                insertTask(id);
+            else if (pageOf.contains(id))
+                markDirty(pageOf.value(id));
+        }
+    });
+    connections << connect(model, &TaskModel::modelReset, this, &TaskStore::rebuildPages);
+}
+
+bool TaskStore::open(const QString &directory, bool wait)
+{
+    if (running)
+    {
+        watcher.waitForFinished();
+        finishSave(watcher.result());
+    }
+    if (loading)
+    {
+        loading = false;
+        loader.waitForFinished();
+    }
+
+    if (!QDir().mkpath(directory))
+    {
+        qWarning() << "TaskStore::open: cannot create" << directory;
+        return false;
+    }
+
+    if (wait)
+        return adopt(load(directory, *io));
+
+    loading = true;
+    const std::shared_ptr<IoQueue> queue = io;
+    loader.setFuture(QtConcurrent::run([directory, queue]() { return load(directory, *queue); }));
+    return true;
+}
+
+bool TaskStore::adopt(const Snapshot &snapshot)
+{
+    loading = false;
+    if (!snapshot.error.isEmpty())
+    {
+        qWarning() << "TaskStore::open:" << snapshot.error;
+        return false;
+    }
+
+    path = snapshot.directory;
+    generation = snapshot.generation;
+    nextPageId = qMax<quint32>(snapshot.nextPageId, 1);
+    pages = snapshot.pages;
+    pageOf.clear();
+    dirty.clear();
+    dirtyPages = 0;
+    for (const Page &page : std::as_const(pages))
+    {
+        for (quint64 id : page.tasks)
+            pageOf.insert(id, page.id);
+    }
+    rebuildIndex();
+
+    if (model && model->rowCount() == 0)
+    {
+        adopting = true;
+        emit adoptingChanged(true);
+        model->addTasks(snapshot.records);
+        adopting = false;
+        emit adoptingChanged(false);
+    }
+    else if (model)
+    {
+        rebuildPages();
+    }
+    return true;
+}
+
+void TaskStore::setAutosaveInterval(int ms)
+{
+    autosaveMs = ms;
+    if (ms < 0)
+        autosaveTimer.stop();
+    else if (autosaveTimer.isActive())
+        autosaveTimer.start(ms);
+}
+
+void TaskStore::insertTask(quint64 id)
+{
+    if (pages.isEmpty() || pages.constLast().tasks.size() >= PageSize)
+    {
+        Page page;
+        page.id = nextPageId++;
+        pageIndex.insert(page.id, pages.size());
+        pages.append(page);
+    }
+
+    Page &page = pages.last();
+    page.tasks.append(id);
+    pageOf.insert(id, page.id);
+    markDirty(page.id);
+}
+
+void TaskStore::removeTask(quint64 id)
+{
+    const auto it = pageOf.constFind(id);
+    if (it == pageOf.constEnd())
+        return;
+
+    const quint32 pageId = *it;
+    pageOf.erase(it);
+    pages[pageIndex.value(pageId)].tasks.removeOne(id);
+    markDirty(pageId);
+}
+
+void TaskStore::markDirty(quint32 pageId)
+{
+    if (dirty.size() <= qsizetype(pageId))
+        dirty.resize(qMax<qsizetype>(qsizetype(pageId) + 1, dirty.size() * 2));
+    if (!isDirty(pageId))
+    {
+        dirty.setBit(pageId);
+        ++dirtyPages;
+    }
+
+    // Not restarted by later changes, so a steady stream of edits is still saved.
+    if (autosaveMs >= 0 && !path.isEmpty() && !running && !autosaveTimer.isActive())
+        autosaveTimer.start(autosaveMs);
+}
+
+void TaskStore::rebuildPages()
+{
+    // Emptied pages keep their id so their files are dropped at the next save.
+    for (Page &page : pages)
+    {
+        page.tasks.clear();
+        markDirty(page.id);
+    }
+    pageOf.clear();
+
+    if (!model)
+        return;
+    for (int row = 0; row < model->rowCount(); ++row)
+    {
+        if (!model->isDeleted(row))
+            insertTask(model->taskId(row));
+    }
+}
+
+void TaskStore::rebuildIndex()
+{
+    pageIndex.clear();
+    pageIndex.reserve(pages.size());
+    for (qsizetype i = 0; i < pages.size(); ++i)
+        pageIndex.insert(pages.at(i).id, i);
+}
+
+bool TaskStore::save(bool wait)
+{
+    autosaveTimer.stop();
+    if (running)
+    {
+        if (!wait)
+        {
+            saveAgain = true;
+            return true;
+        }
+        watcher.waitForFinished();
+        finishSave(watcher.result());
+    }
+    return startSave(wait);
+}
+
+bool TaskStore::startSave(bool wait)
+{
+    if (path.isEmpty() || !model)
+        return false;
+    if (dirtyPages == 0)
+        return true;
+
+    job = SaveJob();
+    job.directory = path;
+    job.io = io;
+    job.generation = generation + 1;
+
+    QByteArray entries;
+    QDataStream manifest(&entries, QIODevice::WriteOnly);
+    manifest.setVersion(QDataStream::Qt_6_0);
+    quint32 written = 0;
+    for (const Page &page : std::as_const(pages))
+    {
+        if (page.tasks.isEmpty())
+        {
+            if (page.file)
+            {
+                job.dropped.append(page.id);
+                job.obsolete.append(pageFile(page.id, page.file));
+            }
+            continue;
+        }
+
+        quint64 file = page.file;
+        quint32 count = quint32(page.tasks.size());
+        if (isDirty(page.id) || file == 0)
+        {
+            QByteArray tasks;
+            QDataStream out(&tasks, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_6_0);
+            count = 0;
+            for (quint64 id : page.tasks)
+            {
+                const TaskRecord record = model->getTaskById(id);
+                if (record.isNull())
+                    continue;
+                writeRecord(out, record);
+                ++count;
+            }
+
+            QByteArray data;
+            QDataStream header(&data, QIODevice::WriteOnly);
+            header.setVersion(QDataStream::Qt_6_0);
+            header << PageMagic << FormatVersion << count;
+            data.append(tasks);
+
+            job.pages.append({page.id, data});
+            if (file)
+                job.obsolete.append(pageFile(page.id, file));
+            file = job.generation;
+        }
+        manifest << page.id << file << count;
+        ++written;
+    }
+
+    QDataStream header(&job.manifest, QIODevice::WriteOnly);
+    header.setVersion(QDataStream::Qt_6_0);
+    header << ManifestMagic << FormatVersion << job.generation << nextPageId << written;
+    job.manifest.append(entries);
+
+    dirty.fill(false);
+    dirtyPages = 0;
+    running = true;
+
+    if (wait)
+        return finishSave(write(job));
+
+    const SaveJob copy = job;
+    watcher.setFuture(QtConcurrent::run([copy]() { return write(copy); }));
+    return true;
+}
+
+bool TaskStore::finishSave(const SaveResult &result)
+{
+    running = false;
+    const bool ok = result.error.isEmpty();
+    if (ok)
+    {
+        generation = job.generation;
+        savedBytes = result.bytes;
+        for (const auto &page : std::as_const(job.pages))
+        {
+            const auto it = pageIndex.constFind(page.first);
+            if (it != pageIndex.constEnd())
+                pages[*it].file = job.generation;
+        }
+        for (quint32 pageId : std::as_const(job.dropped))
+        {
+            const auto it = pageIndex.constFind(pageId);
+            if (it != pageIndex.constEnd())
+                pages[*it].file = 0;
+        }
+
+        // Forget pages that are empty on disk and in memory; the last one takes new tasks.
+        const quint32 last = pages.isEmpty() ? 0 : pages.constLast().id;
+        pages.removeIf([this, last](const Page &page) {
+            if (page.id == last || !page.tasks.isEmpty() || page.file != 0)
+                return false;
+            if (isDirty(page.id))
+            {
+                dirty.clearBit(page.id);
+                --dirtyPages;
+            }
+            return true;
+        });
+        rebuildIndex();
+        emit saved(int(job.pages.size()), result.bytes);
+    }
+    else
+    {
+        qWarning() << "TaskStore::save:" << result.error;
+        for (const auto &page : std::as_const(job.pages))
+        {
+            if (pageIndex.contains(page.first))
+                markDirty(page.first);
+        }
+        for (quint32 pageId : std::as_const(job.dropped))
+        {
+            if (pageIndex.contains(pageId))
+                markDirty(pageId);
+        }
+        emit saveFailed(result.error);
+    }
+    job = SaveJob();
+
+    if (saveAgain)
+    {
+        saveAgain = false;
+        startSave(false);
+    }
+    else if (dirtyPages > 0 && autosaveMs >= 0 && !autosaveTimer.isActive())
+    {
+        autosaveTimer.start(autosaveMs);
+    }
+    return ok;
+}
+
+TaskStore::SaveResult TaskStore::write(const SaveJob &job)
+{
+    Metrics::Registry &metrics = Metrics::registry();
+    Metrics::ScopedTimer timer(metrics.storageWrite);
+
+    // Page files are new, so they are written in place: every page and its sync go to the
+    // queue as one batch, a single submission with io_uring.
+    SaveResult result;
+    std::vector<std::unique_ptr<QFile>> files;
+    QList<IoRequest> requests;
+    files.reserve(size_t(job.pages.size()));
+    requests.reserve(job.pages.size() * 2);
+    for (const auto &page : job.pages)
+    {
+        auto file = std::make_unique<QFile>(job.directory + QLatin1Char('/') + pageFile(page.first, job.generation));
+        if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            result.error = file->fileName() + QStringLiteral(": ") + file->errorString();
+            break;
+        }
+        requests.append(IoRequest::write(file->handle(), 0, page.second, true));
+        requests.append(IoRequest::sync(file->handle()));
+        files.push_back(std::move(file));
+    }
+
+    if (result.error.isEmpty() && !job.io->run(requests))
+    {
+        for (qsizetype i = 0; i < requests.size(); ++i)
+        {
+            if (requests.at(i).result < 0 && requests.at(i).result != -ECANCELED)
+            {
+                result.error = files[size_t(i / 2)]->fileName() + QStringLiteral(": ") + qt_error_string(int(-requests.at(i).result));
+                break;
+            }
+        }
+    }
+    for (const auto &file : files)
+        file->close();
+
+    // The manifest must never name a file that is not complete, so it goes last.
+    if (result.error.isEmpty())
+    {
+        QSaveFile manifest(job.directory + QStringLiteral("/manifest"));
+        if (!manifest.open(QIODevice::WriteOnly) || manifest.write(job.manifest) != job.manifest.size()
+            || !manifest.commit())
+        {
+            result.error = manifest.fileName() + QStringLiteral(": ") + manifest.errorString();
+        }
+    }
+
+    if (!result.error.isEmpty())
+    {
+        for (const auto &file : files)
+            file->remove();
+        return result;
+    }
+
+    for (const IoRequest &request : std::as_const(requests))
+        result.bytes += request.data.size();
+    result.bytes += job.manifest.size();
+    for (const QString &name : job.obsolete)
+        QFile::remove(job.directory + QLatin1Char('/') + name);
+    metrics.storageBytes.add(quint64(result.bytes));
+    return result;
+}
+
+void TaskStore::writeRecord(QDataStream &out, const TaskRecord &record)
+{
+    out << record.getId() << record.getTitle() << record.getDescription() << qint32(record.getPriority())
+        << record.getCompleted() << record.getDateTime().toMSecsSinceEpoch()
+        << (record.getCompletedAt().isValid() ? record.getCompletedAt().toMSecsSinceEpoch() : qint64(0))
+        << record.getAssignee() << qint32(record.getEstimate()) << record.getDependencies();
+}
+
+TaskRecord TaskStore::readRecord(QDataStream &in, quint32 version)
+{
+    quint64 id = 0;
+    QString title;
+    QString description;
+    qint32 priority = 0;
+    bool completed = false;
+    qint64 created = 0;
+    qint64 completedAt = 0;
+    QString assignee;
+    qint32 estimate = 0;
+    QList<quint64> dependencies;
+    in >> id >> title >> description >> priority >> completed >> created >> completedAt;
+    // Version 1 predates assignees, version 2 estimates and dependencies.
+    if (version >= 2)
+        in >> assignee;
+    if (version >= 3)
+        in >> estimate >> dependencies;
+    return TaskRecord(title, description, priority, completed, QDateTime::fromMSecsSinceEpoch(created), id)
+        .withCompletedAt(completedAt ? QDateTime::fromMSecsSinceEpoch(completedAt) : QDateTime())
+        .withAssignee(assignee)
+        .withEstimate(estimate)
+        .withDependencies(dependencies);
+}
+
+TaskStore::Snapshot TaskStore::load(const QString &directory, IoQueue &io, const QList<int> *rows)
+{
+    // A missing manifest is an empty store.
+    Snapshot snapshot;
+    snapshot.directory = directory;
+    QFile manifest(directory + QStringLiteral("/manifest"));
+    if (!manifest.exists())
+        return snapshot;
+    if (!manifest.open(QIODevice::ReadOnly))
+    {
+        snapshot.error = manifest.fileName() + QStringLiteral(": ") + manifest.errorString();
+        return snapshot;
+    }
+
+    QDataStream in(&manifest);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    in >> magic >> version >> snapshot.generation >> snapshot.nextPageId >> count;
+    if (in.status() != QDataStream::Ok || magic != ManifestMagic || version < 1 || version > FormatVersion)
+    {
+        snapshot.error = manifest.fileName() + QStringLiteral(": not a task store manifest");
+        return snapshot;
+    }
+
+    QList<quint32> counts;
+    qsizetype total = 0;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        Page page;
+        quint32 tasks = 0;
+        in >> page.id >> page.file >> tasks;
+        snapshot.nextPageId = qMax(snapshot.nextPageId, page.id + 1);
+        snapshot.pages.append(page);
+        counts.append(tasks);
+        total += tasks;
+    }
+    if (in.status() != QDataStream::Ok || std::any_of(counts.cbegin(), counts.cend(), [](quint32 tasks) { return tasks > PageSize; }))
+    {
+        snapshot.error = manifest.fileName() + QStringLiteral(": damaged");
+        return snapshot;
+    }
+
+    // Only the pages holding requested rows are read, if rows are requested.
+    QList<qsizetype> selected;
+    QList<qsizetype> firstRows;
+    selected.reserve(snapshot.pages.size());
+    firstRows.reserve(snapshot.pages.size());
+    qsizetype first = 0;
+    qsizetype wanted = 0;
+    for (qsizetype i = 0; i < snapshot.pages.size(); ++i)
+    {
+        const qsizetype end = first + counts.at(i);
+        bool read = !rows;
+        for (; rows && wanted < rows->size() && rows->at(wanted) < end; ++wanted)
+            read = read || rows->at(wanted) >= first;
+        if (read)
+        {
+            selected.append(i);
+            firstRows.append(first);
+        }
+        first = end;
+    }
+
+    // All pages are read in one batch.
+    std::vector<std::unique_ptr<QFile>> files;
+    QList<IoRequest> requests;
+    files.reserve(size_t(selected.size()));
+    requests.reserve(selected.size());
+    for (qsizetype i : std::as_const(selected))
+    {
+        const Page &entry = snapshot.pages.at(i);
+        auto page = std::make_unique<QFile>(directory + QLatin1Char('/') + pageFile(entry.id, entry.file));
+        if (!page->open(QIODevice::ReadOnly))
+        {
+            snapshot.error = page->fileName() + QStringLiteral(": ") + page->errorString();
+            return snapshot;
+        }
+        requests.append(IoRequest::read(page->handle(), 0, page->size()));
+        files.push_back(std::move(page));
+    }
+    if (!io.run(requests))
+    {
+        for (qsizetype i = 0; i < requests.size(); ++i)
+        {
+            if (requests.at(i).result < 0)
+            {
+                snapshot.error = files[size_t(i)]->fileName() + QStringLiteral(": ") + qt_error_string(int(-requests.at(i).result));
+                return snapshot;
+            }
+        }
+    }
+
+    snapshot.records.reserve(rows ? rows->size() : total);
+    wanted = 0;
+    for (qsizetype i = 0; i < selected.size(); ++i)
+    {
+        Page &entry = snapshot.pages[selected.at(i)];
+        QDataStream pageIn(requests.at(i).data);
+        pageIn.setVersion(QDataStream::Qt_6_0);
+        quint32 pageCount = 0;
+        pageIn >> magic >> version >> pageCount;
+        if (magic != PageMagic || version < 1 || version > FormatVersion || pageCount != counts.at(selected.at(i)))
+        {
+            snapshot.error = files[size_t(i)]->fileName() + QStringLiteral(": does not match the manifest");
+            return snapshot;
+        }
+
+        entry.tasks.reserve(pageCount);
+        for (quint32 j = 0; j < pageCount; ++j)
+        {
+            const TaskRecord record = readRecord(pageIn, version);
+            entry.tasks.append(record.getId());
+            if (!rows)
+            {
+                snapshot.records.append(record);
+                continue;
+            }
+
+            const qsizetype row = firstRows.at(i) + j;
+            while (wanted < rows->size() && rows->at(wanted) < row)
+                ++wanted;
+            if (wanted < rows->size() && rows->at(wanted) == row)
+                snapshot.records.append(record);
+        }
+        if (pageIn.status() != QDataStream::Ok)
+        {
+            snapshot.error = files[size_t(i)]->fileName() + QStringLiteral(": truncated");
+            return snapshot;
+        }
+    }
+    return snapshot;
+}
+
+QList<TaskRecord> TaskStore::read(const QString &directory, QString *error)
+{
+    IoQueue io;
+    const Snapshot snapshot = load(directory, io);
+    if (error)
+        *error = snapshot.error;
+    return snapshot.error.isEmpty() ? snapshot.records : QList<TaskRecord>();
+}
+
+QList<TaskRecord> TaskStore::read(const QString &directory, const QList<int> &rows, QString *error)
+{
+    IoQueue io;
+    const Snapshot snapshot = load(directory, io, &rows);
+    if (error)
+        *error = snapshot.error;
+    return snapshot.error.isEmpty() ? snapshot.records : QList<TaskRecord>();
+}
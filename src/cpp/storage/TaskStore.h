@@ -0,0 +1,306 @@
+#pragma once
+
+#include <QBitArray>
+#include <QDataStream>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include "IoQueue.h"
+#include "TaskRecord.h"
+
+#include <memory>
+
+class TaskModel;
+
+
+/**
+ * @file TaskStore.h
+ * @brief Paged on-disk snapshot of a task list with incremental autosave
+ */
+
+/**
+ * @class TaskStore
+ * @brief Persists the live tasks of a TaskModel in fixed-size pages, rewriting only dirty pages
+ *
+ * The task list is split into pages of up to PageSize tasks in row order. New tasks are
+ * appended to the last page, removed tasks leave a shorter page behind, so a change never
+ * moves tasks between pages. Model mutations (observed through the model's row and data
+ * signals) set the bit of the affected page in a dirty bitmap.
+ *
+ * Saving is copy-on-write: each dirty page is written to a new file named after the
+ * save generation, then a manifest listing the current file of every page replaces the
+ * previous one with an atomic rename. Files of the previous generation are deleted only
+ * after the swap, so a crash at any point leaves either the old or the new snapshot
+ * intact. Saving after toggling one task of a million therefore writes one page and the
+ * manifest, a few tens of kilobytes.
+ *
+ * Autosave runs autosaveInterval() after the first change; pages are encoded on the GUI
+ * thread and written on a worker thread. Page writes with their syncs, and the page reads
+ * of open(), each go to an IoQueue as one batch. Tasks in the trash are not persisted.
+ *
+ * Directory layout:
+ * @code
+ * <directory>/manifest           generation, then id, file generation and size of every page
+ * <directory>/<page>-<gen>.page  tasks of one page
+ * @endcode
+ *
+ * Example usage:
+ * @code
+ * TaskStore *store = new TaskStore(this);
+ * store->attach(model);
+ * store->open(dataDir + "/tasks");   // loads the stored tasks into the empty model
+ * model->toggleCompleted(0);         // marks one page dirty; autosave writes it
+ * @endcode
+ */
+class TaskStore : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Maximum number of tasks per page
+     */
+    static constexpr int PageSize = 512;
+
+    /**
+     * @brief Default time from the first unsaved change to the autosave, in milliseconds
+     */
+    static constexpr int DefaultAutosaveInterval = 1000;
+
+    /**
+     * @brief Constructs a store without a directory
+     * @param parent The parent QObject
+     */
+    explicit TaskStore(QObject *parent = nullptr);
+
+    /**
+     * @brief Waits for a running save; does not save pending changes
+     *
+     * Call save(true) while the model is still alive to write them.
+     */
+    ~TaskStore() override;
+
+    /**
+     * @brief Starts tracking the changes of a model
+     * @param model The model to observe; replaces any previously attached model
+     *
+     * All tasks of the model are assigned to pages and marked dirty.
+     */
+    void attach(TaskModel *model);
+
+    /**
+     * @brief Opens a store directory
+     * @param directory Path of the directory; created if it does not exist
+     * @param wait Whether to read the store before returning; otherwise it is read on a
+     *             worker thread and opened() reports the result
+     * @return true if the directory could be read or, without wait, the read was started
+     *
+     * If the attached model is empty once the store has been read, the stored tasks are
+     * loaded into it with their ids and pages are clean afterwards. Otherwise the model's
+     * tasks replace the stored ones at the next save.
+     */
+    bool open(const QString &directory, bool wait = true);
+
+    /**
+     * @brief Whether an open() without wait is still reading the store
+     */
+    bool isLoading() const { return loading; }
+
+    /**
+     * @brief Gets the directory of the store, empty if none is open
+     */
+    QString directory() const { return path; }
+
+    /**
+     * @brief Writes all dirty pages and the manifest
+     * @param wait Whether to block until the files are written
+     * @return false if nothing could be started or, with wait, the save failed
+     *
+     * A save requested while one is running starts once it has finished.
+     */
+    bool save(bool wait = false);
+
+    /**
+     * @brief Gets the time from the first unsaved change to the autosave, in milliseconds
+     */
+    int autosaveInterval() const { return autosaveMs; }
+
+    /**
+     * @brief Sets the autosave delay; a negative value disables autosave
+     */
+    void setAutosaveInterval(int ms);
+
+    /**
+     * @brief Gets the number of pages, including empty ones not written yet
+     */
+    int pageCount() const { return int(pages.size()); }
+
+    /**
+     * @brief Gets the number of pages with unsaved changes
+     */
+    int dirtyPageCount() const { return dirtyPages; }
+
+    /**
+     * @brief Whether a save is being written
+     */
+    bool isSaving() const { return running; }
+
+    /**
+     * @brief Gets the number of bytes written by the last successful save
+     */
+    qint64 lastSaveBytes() const { return savedBytes; }
+
+    /**
+     * @brief Reads all tasks of a store directory in order
+     * @param directory Path of the directory
+     * @param error Receives a description of the problem, empty on success
+     * @return The stored tasks; empty if the store does not exist or is damaged
+     */
+    static QList<TaskRecord> read(const QString &directory, QString *error = nullptr);
+
+    /**
+     * @brief Reads some tasks of a store directory, reading only the pages they are on
+     * @param directory Path of the directory
+     * @param rows Ascending rows of the tasks, numbered like the list read() returns
+     * @param error Receives a description of the problem, empty on success
+     * @return The tasks at those rows in order, without rows past the end of the store;
+     *         empty if the store does not exist or is damaged
+     */
+    static QList<TaskRecord> read(const QString &directory, const QList<int> &rows, QString *error = nullptr);
+
+    /**
+     * @brief Version of the record encoding written by writeRecord()
+     *
+     * Version 2 added the assignee, version 3 the estimate and the dependencies. Files
+     * record the version they were written with.
+     */
+    static constexpr quint32 RecordVersion = 3;
+
+    /**
+     * @brief Writes a task in the encoding of page files, version RecordVersion
+     */
+    static void writeRecord(QDataStream &out, const TaskRecord &record);
+
+    /**
+     * @brief Reads a task written by writeRecord(); check the stream's status afterwards
+     * @param in The stream
+     * @param version The encoding version of the file, from 1 to RecordVersion
+     */
+    static TaskRecord readRecord(QDataStream &in, quint32 version = RecordVersion);
+
+signals:
+
+    /**
+     * @brief Emitted when an open() without wait has finished
+     * @param ok Whether the store could be read; on success the stored tasks are in the model
+     */
+    void opened(bool ok);
+
+    /**
+     * @brief Emitted around loading the stored tasks into the model
+     * @param adopting true before the tasks are added, false once they are in the model
+     *
+     * Lets observers of the model tell stored tasks from new ones, see AuditLog::setSuspended().
+     */
+    void adoptingChanged(bool adopting);
+
+    /**
+     * @brief Emitted after a save has completed
+     * @param pages Number of pages written
+     * @param bytes Number of bytes written, including the manifest
+     */
+    void saved(int pages, qint64 bytes);
+
+    /**
+     * @brief Emitted when a save failed; the affected pages stay dirty
+     */
+    void saveFailed(const QString &error);
+
+private:
+
+    /**
+     * @brief A run of consecutive tasks
+     */
+    struct Page
+    {
+        quint32 id = 0;          ///< Stable page id, part of its file name
+        QList<quint64> tasks;    ///< Task ids in row order
+        quint64 file = 0;        ///< Generation of the page's file in the manifest on disk, 0 if none
+    };
+
+    /**
+     * @brief Everything a worker needs to write one save
+     */
+    struct SaveJob
+    {
+        QString directory;                     ///< Store directory
+        std::shared_ptr<IoQueue> io;           ///< Queue writing the files
+        quint64 generation = 0;                ///< Generation of the files written
+        QList<QPair<quint32, QByteArray>> pages; ///< Encoded dirty pages by id
+        QByteArray manifest;                   ///< Encoded manifest
+        QList<quint32> dropped;                ///< Empty pages left out of the manifest
+        QStringList obsolete;                  ///< Files to delete after the manifest swap
+    };
+
+    /**
+     * @brief Contents of a store directory as read by load()
+     */
+    struct Snapshot
+    {
+        QString directory;                     ///< Store directory
+        quint64 generation = 0;                ///< Generation of the manifest
+        quint32 nextPageId = 1;                ///< Id of the next new page
+        QList<Page> pages;                     ///< Pages with their task ids and files; ids only of the pages read
+        QList<TaskRecord> records;             ///< Tasks of all pages in order, or of the requested rows
+        QString error;                         ///< Empty on success
+    };
+
+    /**
+     * @brief Outcome of a SaveJob
+     */
+    struct SaveResult
+    {
+        qint64 bytes = 0;  ///< Bytes written
+        QString error;     ///< Empty on success
+    };
+
+    QString path;                          ///< Store directory, empty if not open
+    std::shared_ptr<IoQueue> io;           ///< Queue for page reads and writes, shared with workers
+    quint64 generation = 0;                ///< Generation of the manifest on disk
+    QList<Page> pages;                     ///< Pages in row order
+    QHash<quint32, qsizetype> pageIndex;   ///< Position of each page in pages
+    QHash<quint64, quint32> pageOf;        ///< Page of each stored task
+    quint32 nextPageId = 1;                ///< Id of the next new page
+    QBitArray dirty;                       ///< Dirty bit of each page, by page id
+    int dirtyPages = 0;                    ///< Number of set bits in dirty
+    bool adopting = false;                 ///< Set while open() loads stored tasks into the model
+    bool loading = false;                  ///< Whether loader reads a store for open()
+    QFutureWatcher<Snapshot> loader;       ///< Completion of an open() without wait
+
+    QTimer autosaveTimer;                  ///< Fires autosaveMs after the first unsaved change
+    int autosaveMs = DefaultAutosaveInterval; ///< Autosave delay, negative if disabled
+    bool running = false;                  ///< Whether a SaveJob is being written
+    bool saveAgain = false;                ///< Whether save() was called during a running save
+    SaveJob job;                           ///< Job being written, kept to apply its result
+    QFutureWatcher<SaveResult> watcher;    ///< Completion of the running job
+    qint64 savedBytes = 0;                 ///< Bytes written by the last successful save
+
+    QPointer<TaskModel> model;             ///< Observed model
+    QList<QMetaObject::Connection> connections; ///< Connections to the observed model
+
+    void insertTask(quint64 id);
+    void removeTask(quint64 id);
+    void markDirty(quint32 pageId);
+    bool isDirty(quint32 pageId) const { return qsizetype(pageId) < dirty.size() && dirty.testBit(pageId); }
+    void rebuildPages();
+    void rebuildIndex();
+    bool startSave(bool wait);
+    bool finishSave(const SaveResult &result);
+    bool adopt(const Snapshot &snapshot);
+
+    static SaveResult write(const SaveJob &job);
+    static Snapshot load(const QString &directory, IoQueue &io, const QList<int> *rows = nullptr);
+};
@@ -0,0 +1,140 @@
+#include "TemplateLibrary.h"
+#include "TaskModel.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+namespace
+{
+
+constexpr quint32 LibraryMagic = 0x544d544c; // "TMTL"
+constexpr quint32 LibraryVersion = 1;
+
+}
+
+TemplateLibrary::TemplateLibrary(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void TemplateLibrary::attach(TaskModel *taskModel)
+{
+    model = taskModel;
+}
+
+bool TemplateLibrary::open(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.exists())
+    {
+        path = fileName;
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "TemplateLibrary::open: cannot open" << fileName << file.errorString();
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || magic != LibraryMagic || version < 1 || version > LibraryVersion || count < 0)
+    {
+        qWarning() << "TemplateLibrary::open:" << fileName << "is not a template library";
+        return false;
+    }
+
+    QMap<QString, TaskTemplate> loaded;
+    for (qint32 i = 0; i < count; ++i)
+    {
+        TaskTemplate taskTemplate;
+        if (!taskTemplate.read(in))
+        {
+            qWarning() << "TemplateLibrary::open: corrupt template in" << fileName;
+            return false;
+        }
+        loaded.insert(taskTemplate.name(), taskTemplate);
+    }
+
+    path = fileName;
+    templates = loaded;
+    emit templatesChanged();
+    return true;
+}
+
+bool TemplateLibrary::addTemplate(const TaskTemplate &taskTemplate)
+{
+    if (taskTemplate.name().trimmed().isEmpty() || taskTemplate.isEmpty())
+        return false;
+
+    templates.insert(taskTemplate.name(), taskTemplate);
+    save();
+    emit templatesChanged();
+    return true;
+}
+
+bool TemplateLibrary::addOutline(const QString &name, const QString &outline)
+{
+    return addTemplate(TaskTemplate::fromOutline(name.trimmed(), outline));
+}
+
+bool TemplateLibrary::removeTemplate(const QString &name)
+{
+    if (templates.remove(name) == 0)
+        return false;
+
+    save();
+    emit templatesChanged();
+    return true;
+}
+
+int TemplateLibrary::instantiate(const QString &name, const QVariantMap &values)
+{
+    const auto it = templates.constFind(name);
+    if (it == templates.cend() || !model)
+        return -1;
+
+    QHash<QString, QString> strings;
+    for (auto value = values.cbegin(); value != values.cend(); ++value)
+        strings.insert(value.key(), value.value().toString());
+
+    // Ids first, so the tasks can wait for each other before any of them exists.
+    QList<TaskRecord> records;
+    const quint64 firstId = model->reserveTaskIds(it->size());
+    if (!it->instantiate(strings, firstId, &records) || !model->addTaskSet(records))
+        return -1;
+
+    emit instantiated(name, firstId, int(records.size()));
+    return int(records.size());
+}
+
+bool TemplateLibrary::save() const
+{
+    if (path.isEmpty())
+        return true;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "TemplateLibrary::save: cannot write" << path << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << LibraryMagic << LibraryVersion << qint32(templates.size());
+    for (const TaskTemplate &taskTemplate : templates)
+        taskTemplate.write(out);
+    if (out.status() != QDataStream::Ok || !file.commit())
+    {
+        qWarning() << "TemplateLibrary::save: cannot write" << path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <QMap>
+#include <QObject>
+#include <QPointer>
+#include <QVariantMap>
+#include "TaskTemplate.h"
+
+class TaskModel;
+
+
+/**
+ * @file TemplateLibrary.h
+ * @brief Named task templates, stored in a file and instantiated into a TaskModel
+ */
+
+/**
+ * @class TemplateLibrary
+ * @brief The task templates of the user and their instantiation as sets of tasks
+ *
+ * The library keeps TaskTemplate values by name. Once open()ed, it is read from a file and
+ * written back whole after every change, in the templates' interned form; a library holds
+ * a few templates, so this is a small write.
+ *
+ * instantiate() expands a template into an attached TaskModel in one transaction: the ids
+ * of the tasks are reserved first so their dependencies are known, then all tasks are
+ * added with TaskModel::addTaskSet(). That is one row insertion for views, one entry per
+ * task in the AuditLog's buffer and one autosave of the TaskStore, however many tasks the
+ * template has; and if one task cannot be created, none is.
+ *
+ * Example usage:
+ * @code
+ * library->attach(model);
+ * library->open(dataDir + "/templates.lib");
+ * library->addOutline("Onboarding", "Onboard {{name}}\n    Set up a laptop for {{name}}\n");
+ * library->instantiate("Onboarding", {{"name", "Ana"}});     // 2 tasks
+ * @endcode
+ */
+class TemplateLibrary : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * @property names
+     * @brief The names of the templates, sorted
+     */
+    Q_PROPERTY(QStringList names READ names NOTIFY templatesChanged)
+
+public:
+
+    /**
+     * @brief Constructs an empty library that is not stored
+     * @param parent The parent QObject
+     */
+    explicit TemplateLibrary(QObject *parent = nullptr);
+
+    /**
+     * @brief Sets the model that templates are instantiated into
+     * @param model The tasks, or nullptr to detach
+     */
+    void attach(TaskModel *model);
+
+    /**
+     * @brief Reads the templates from a file and stores later changes there
+     * @param fileName The file; a missing file is an empty library
+     * @return false if the file cannot be read or is not a library; the templates are then
+     *         kept and not stored
+     */
+    bool open(const QString &fileName);
+
+    /**
+     * @brief Adds a template, replacing one of the same name
+     * @return false if the template has no name or no prototypes
+     */
+    bool addTemplate(const TaskTemplate &taskTemplate);
+
+    /**
+     * @brief Adds a template from an indented outline, see TaskTemplate::fromOutline()
+     * @return false if the name or the outline is empty
+     */
+    Q_INVOKABLE bool addOutline(const QString &name, const QString &outline);
+
+    /**
+     * @brief Removes a template
+     * @return false if there is no template of that name
+     */
+    Q_INVOKABLE bool removeTemplate(const QString &name);
+
+    QStringList names() const { return templates.keys(); }
+
+    /**
+     * @brief Gets a template by name
+     * @return The template, empty if there is none of that name
+     */
+    TaskTemplate find(const QString &name) const { return templates.value(name); }
+
+    /**
+     * @brief Gets the placeholders of a template that need a value to instantiate it
+     */
+    Q_INVOKABLE QStringList variables(const QString &name) const { return templates.value(name).variables(); }
+
+    /**
+     * @brief Adds the tasks of a template to the attached model, all or none
+     * @param name The template
+     * @param values A value for every placeholder of the template, converted to text
+     * @return The number of tasks added, or -1 if nothing was added
+     */
+    Q_INVOKABLE int instantiate(const QString &name, const QVariantMap &values);
+
+signals:
+
+    void templatesChanged();
+
+    /**
+     * @brief Emitted after a template was instantiated
+     * @param name The template
+     * @param firstId Id of the first task added; the others follow
+     * @param count Number of tasks added
+     */
+    void instantiated(const QString &name, quint64 firstId, int count);
+
+private:
+
+    QPointer<TaskModel> model;                  ///< Model templates are instantiated into
+    QMap<QString, TaskTemplate> templates;      ///< Templates by name
+    QString path;                               ///< File of the library, empty until opened
+
+    /**
+     * @brief Writes all templates to the library file, if opened
+     */
+    bool save() const;
+};
@@ -0,0 +1,557 @@
+#include "TodoScanner.h"
+#include "GitIgnore.h"
+#include "TaskModel.h"
+#include "TextScanner.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+constexpr quint32 CacheMagic = 0x544d5444; // "TMTD"
+constexpr quint32 FormatVersion = 1;
+constexpr qsizetype BinaryProbeLength = 8000;
+
+// Stand-ins for the hash of files that are not searched, so they are not read again.
+const QByteArray SkippedLarge = QByteArrayLiteral("large");
+const QByteArray SkippedBinary = QByteArrayLiteral("binary");
+
+// Where a marker is; its task's description starts out as this.
+QString location(const QString &path, int line)
+{
+    return QStringLiteral("%1:%2").arg(path).arg(line);
+}
+
+struct Directory
+{
+    QString path;           // Relative to the root, empty for the root
+    GitIgnore ignore;       // Rules of the directory and its parents
+};
+
+struct Listing
+{
+    QFileInfoList files;
+    QList<Directory> directories;
+};
+
+Listing listDirectory(const QString &root, const Directory &directory)
+{
+    Listing listing;
+    const QString absolute = directory.path.isEmpty() ? root : root + u'/' + directory.path;
+    const QString prefix = directory.path.isEmpty() ? QString() : directory.path + u'/';
+    GitIgnore ignore = directory.ignore;
+    ignore.load(absolute + QStringLiteral("/.gitignore"), directory.path);
+
+    // Symbolic links are not followed, so the walk cannot loop.
+    const QFileInfoList entries = QDir(absolute).entryInfoList(QDir::Dirs | QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+    for (const QFileInfo &info : entries)
+    {
+        const QString path = prefix + info.fileName();
+        if (info.isDir())
+        {
+            if (info.fileName() != QLatin1String(".git") && !ignore.isIgnored(path, true))
+                listing.directories.append({path, ignore});
+        }
+        else if (!ignore.isIgnored(path, false))
+        {
+            listing.files.append(info);
+        }
+    }
+    return listing;
+}
+
+/**
+ * Walks the tree breadth-first, listing the directories of each level in parallel.
+ */
+QFileInfoList walk(const QString &root)
+{
+    Directory top;
+    top.ignore.load(root + QStringLiteral("/.git/info/exclude"));
+
+    QFileInfoList files;
+    QList<Directory> level{top};
+    while (!level.isEmpty())
+    {
+        const QList<Listing> listings = QtConcurrent::blockingMapped<QList<Listing>>(level, [&root](const Directory &directory) {
+            return listDirectory(root, directory);
+        });
+        level.clear();
+        for (const Listing &listing : listings)
+        {
+            files.append(listing.files);
+            level.append(listing.directories);
+        }
+    }
+    return files;
+}
+
+bool isIdentifier(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+/**
+ * Checks that a word found at offset is a whole word inside a comment: something on its
+ * line before it opens a comment, or the line continues a block comment with '*'.
+ */
+bool isMarker(const char *content, qsizetype length, qsizetype offset, qsizetype wordLength)
+{
+    if (offset > 0 && isIdentifier(content[offset - 1]))
+        return false;
+    if (offset + wordLength < length && isIdentifier(content[offset + wordLength]))
+        return false;
+
+    qsizetype lineStart = offset;
+    while (lineStart > 0 && content[lineStart - 1] != '\n')
+        --lineStart;
+    const QByteArrayView prefix(content + lineStart, offset - lineStart);
+    if (prefix.trimmed().startsWith('*'))
+        return true;
+
+    static const char *const openers[] = {"//", "/*", "#", "--", ";", "%"};
+    for (const char *opener : openers)
+    {
+        if (prefix.contains(opener))
+            return true;
+    }
+    return false;
+}
+
+}
+
+TodoScanner::TodoScanner(QObject *parent)
+    : QObject(parent)
+{
+    rescanTimer.setSingleShot(true);
+    rescanTimer.setInterval(DefaultRescanInterval);
+    connect(&rescanTimer, &QTimer::timeout, this, &TodoScanner::scan);
+    connect(&watcher, &QFutureWatcher<Result>::finished, this, &TodoScanner::finish);
+}
+
+TodoScanner::~TodoScanner()
+{
+    watcher.waitForFinished();
+}
+
+void TodoScanner::attach(TaskModel *taskModel)
+{
+    model = taskModel;
+}
+
+bool TodoScanner::open(const QString &directory, const QString &cacheFile)
+{
+    if (!model)
+    {
+        qWarning() << "TodoScanner::open: no model attached";
+        return false;
+    }
+    if (!QFileInfo(directory).isDir())
+    {
+        qWarning() << "TodoScanner::open: not a directory" << directory;
+        return false;
+    }
+
+    // A scan of the previous tree is dropped.
+    watcher.waitForFinished();
+    busy = false;
+    rescanPending = false;
+
+    root = QDir(directory).absolutePath();
+    cachePath = cacheFile;
+    files.clear();
+    loadCache();
+    return scan();
+}
+
+bool TodoScanner::scan()
+{
+    if (root.isEmpty() || !model)
+        return false;
+    if (busy)
+    {
+        rescanPending = true;
+        return true;
+    }
+
+    rescanTimer.stop();
+    busy = true;
+    watcher.setFuture(QtConcurrent::run(&TodoScanner::run, root, files, QDateTime::currentMSecsSinceEpoch()));
+    emit scanningChanged();
+    return true;
+}
+
+void TodoScanner::waitForScan()
+{
+    watcher.waitForFinished();
+    finish();
+}
+
+void TodoScanner::finish()
+{
+    if (!busy)
+        return;
+
+    busy = false;
+    apply(watcher.result());
+    emit scanningChanged();
+
+    if (rescanPending)
+    {
+        rescanPending = false;
+        scan();
+    }
+    else if (rescanTimer.interval() > 0)
+    {
+        rescanTimer.start();
+    }
+}
+
+void TodoScanner::setRescanInterval(int ms)
+{
+    rescanTimer.setInterval(ms);
+    if (ms <= 0)
+        rescanTimer.stop();
+    else if (!busy && !root.isEmpty())
+        rescanTimer.start();
+}
+
+int TodoScanner::fileCount() const
+{
+    return int(std::count_if(files.cbegin(), files.cend(), [](const Entry &entry) { return !entry.markers.isEmpty(); }));
+}
+
+int TodoScanner::markerCount() const
+{
+    int count = 0;
+    for (const Entry &entry : files)
+        count += int(entry.markers.size());
+    return count;
+}
+
+TodoScanner::Result TodoScanner::run(const QString &root, const QHash<QString, Entry> &cached, qint64 now)
+{
+    const QFileInfoList infos = walk(root);
+
+    Result result;
+    result.checks = QtConcurrent::blockingMapped<QList<Check>>(infos, [&root, &cached, now](const QFileInfo &info) {
+        return check(root, info, cached.value(info.filePath().mid(root.size() + 1)), now);
+    });
+    for (const Check &file : std::as_const(result.checks))
+    {
+        if (file.changed)
+            ++result.searched;
+    }
+    return result;
+}
+
+TodoScanner::Check TodoScanner::check(const QString &root, const QFileInfo &info, const Entry &cached, qint64 now)
+{
+    Check result;
+    result.path = info.filePath().mid(root.size() + 1);
+    result.entry = cached;
+
+    const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+    if (!cached.hash.isEmpty() && cached.size == info.size() && cached.mtime == mtime
+        && cached.checkedAt - mtime >= RacyWindowMs)
+        return result;
+
+    result.entry.mtime = mtime;
+    result.entry.size = info.size();
+    result.entry.checkedAt = now;
+    result.entry.markers.clear();
+    if (info.size() > MaxFileSize)
+    {
+        result.entry.hash = SkippedLarge;
+        result.changed = cached.hash != SkippedLarge;
+        return result;
+    }
+
+    QFile file(info.filePath());
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "TodoScanner: cannot read" << info.filePath() << file.errorString();
+        result.entry = cached;
+        return result;
+    }
+
+    // Files are mapped rather than read; the kernel pages in only what the search touches.
+    QByteArray buffer;
+    const char *content = "";
+    qsizetype length = file.size();
+    if (length > 0)
+    {
+        if (const uchar *mapped = file.map(0, length))
+        {
+            content = reinterpret_cast<const char *>(mapped);
+        }
+        else
+        {
+            buffer = file.readAll();
+            content = buffer.constData();
+            length = buffer.size();
+        }
+    }
+    result.entry.size = length;
+
+    if (std::memchr(content, 0, size_t(qMin(length, BinaryProbeLength))))
+    {
+        result.entry.hash = SkippedBinary;
+        result.changed = cached.hash != SkippedBinary;
+        return result;
+    }
+
+    result.entry.hash = QCryptographicHash::hash(QByteArrayView(content, length), QCryptographicHash::Sha1);
+    if (result.entry.hash == cached.hash)
+    {
+        result.entry.markers = cached.markers;
+        return result;
+    }
+
+    result.entry.markers = findMarkers(content, length);
+    result.changed = true;
+    return result;
+}
+
+QList<TodoScanner::Marker> TodoScanner::findMarkers(const char *content, qsizetype length)
+{
+    static const QByteArray words[] = {QByteArrayLiteral("TODO"), QByteArrayLiteral("FIXME")};
+
+    QList<QPair<qsizetype, qsizetype>> hits;
+    for (const QByteArray &word : words)
+    {
+        for (qsizetype from = 0; from < length;)
+        {
+            qsizetype hit = TextScanner::indexOf(content + from, length - from, word.constData(), word.size());
+            if (hit < 0)
+                break;
+            hit += from;
+            if (isMarker(content, length, hit, word.size()))
+                hits.append({hit, word.size()});
+            from = hit + word.size();
+        }
+    }
+    std::sort(hits.begin(), hits.end());
+
+    QList<Marker> markers;
+    markers.reserve(hits.size());
+    int line = 1;
+    qsizetype counted = 0;
+    for (const auto &hit : std::as_const(hits))
+    {
+        line += int(std::count(content + counted, content + hit.first, '\n'));
+        counted = hit.first;
+
+        const void *newline = std::memchr(content + hit.first, '\n', size_t(length - hit.first));
+        const qsizetype end = newline ? static_cast<const char *>(newline) - content : length;
+        QString title = QString::fromUtf8(content + hit.first, end - hit.first).trimmed();
+        for (const QLatin1String closer : {QLatin1String("*/"), QLatin1String("-->")})
+        {
+            if (title.endsWith(closer))
+                title = title.chopped(closer.size()).trimmed();
+        }
+        if (title.size() > MaxTitleLength)
+            title.truncate(MaxTitleLength);
+
+        markers.append({title, line, 0});
+    }
+    return markers;
+}
+
+void TodoScanner::apply(const Result &result)
+{
+    if (!model)
+        return;
+
+    QSet<QString> present;
+    QList<quint64> purged;
+    QList<TaskRecord> records;
+    QList<QPair<QString, int>> recordMarkers;   // File and marker index of each new record
+    int updated = 0;
+
+    for (const Check &check : result.checks)
+    {
+        present.insert(check.path);
+        if (!check.changed)
+        {
+            files.insert(check.path, check.entry);
+            continue;
+        }
+
+        // Markers are matched to the previous ones by title, in order, so duplicates pair up
+        // first with first; the leftovers were removed.
+        const QList<Marker> previous = files.value(check.path).markers;
+        QHash<QString, QList<int>> unmatched;
+        for (int i = 0; i < previous.size(); ++i)
+            unmatched[previous[i].title].append(i);
+
+        Entry entry = check.entry;
+        for (int i = 0; i < entry.markers.size(); ++i)
+        {
+            Marker &marker = entry.markers[i];
+            auto match = unmatched.find(marker.title);
+            if (match != unmatched.end() && !match->isEmpty())
+            {
+                const Marker &old = previous[match->takeFirst()];
+                if (old.taskId && taskExists(old.taskId))
+                {
+                    // The marker keeps the location; the description follows it only
+                    // while the user has not written one of their own.
+                    marker.taskId = old.taskId;
+                    const int row = model->indexOfTask(old.taskId);
+                    if (old.line != marker.line && row >= 0
+                        && model->getTask(row).getDescription() == location(check.path, old.line))
+                    {
+                        model->setData(model->index(row), location(check.path, marker.line), TaskModel::DescriptionRole);
+                        ++updated;
+                    }
+                    continue;
+                }
+            }
+
+            // The id is given up front, so a record the model rejects leaves only its own
+            // marker without a task.
+            records.append(TaskRecord(marker.title, location(check.path, marker.line),
+                                      marker.title.startsWith(QLatin1String("FIXME")) ? Task::High : Task::Medium,
+                                      false, QDateTime(), model->reserveTaskIds(1)));
+            recordMarkers.append({check.path, i});
+        }
+        for (const QList<int> &indexes : std::as_const(unmatched))
+        {
+            for (int i : indexes)
+            {
+                if (previous[i].taskId)
+                    purged.append(previous[i].taskId);
+            }
+        }
+        files.insert(check.path, entry);
+    }
+
+    // Files that are gone, or now ignored, take their tasks with them.
+    for (auto it = files.begin(); it != files.end();)
+    {
+        if (present.contains(it.key()))
+        {
+            ++it;
+            continue;
+        }
+        for (const Marker &marker : std::as_const(it->markers))
+        {
+            if (marker.taskId)
+                purged.append(marker.taskId);
+        }
+        it = files.erase(it);
+    }
+
+    const int removed = purged.isEmpty() ? 0 : model->removeTasks(purged);
+    const int added = records.isEmpty() ? 0 : model->addTasks(records);
+    for (int i = 0; i < records.size(); ++i)
+    {
+        if (model->indexOfTask(records[i].getId()) >= 0)
+            files[recordMarkers[i].first].markers[recordMarkers[i].second].taskId = records[i].getId();
+    }
+
+    saveCache();
+    emit scanned(int(result.checks.size()), result.searched, added, updated, removed);
+}
+
+bool TodoScanner::taskExists(quint64 taskId) const
+{
+    // Tasks in the trash count: the user deleted them, and their markers stay quiet.
+    return model->getTaskById(taskId).getId() == taskId;
+}
+
+bool TodoScanner::loadCache()
+{
+    if (cachePath.isEmpty())
+        return false;
+
+    QFile file(cachePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString directory;
+    quint32 count = 0;
+    in >> magic >> version >> directory >> count;
+    if (in.status() != QDataStream::Ok || magic != CacheMagic || version != FormatVersion || directory != root)
+        return false;
+
+    QHash<QString, Entry> entries;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString path;
+        Entry entry;
+        quint32 markers = 0;
+        in >> path >> entry.mtime >> entry.size >> entry.checkedAt >> entry.hash >> markers;
+        for (quint32 m = 0; m < markers && in.status() == QDataStream::Ok; ++m)
+        {
+            Marker marker;
+            qint32 line = 0;
+            in >> marker.title >> line >> marker.taskId;
+            marker.line = line;
+            entry.markers.append(marker);
+        }
+        entries.insert(path, entry);
+    }
+    if (in.status() != QDataStream::Ok)
+    {
+        qWarning() << "TodoScanner: ignoring damaged cache" << cachePath;
+        return false;
+    }
+
+    // Files with markers whose tasks the model no longer has are searched again.
+    for (Entry &entry : entries)
+    {
+        for (Marker &marker : entry.markers)
+        {
+            if (marker.taskId && !taskExists(marker.taskId))
+            {
+                marker.taskId = 0;
+                entry.hash.clear();
+            }
+        }
+    }
+    files = entries;
+    return true;
+}
+
+void TodoScanner::saveCache() const
+{
+    if (cachePath.isEmpty())
+        return;
+
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "TodoScanner: cannot write" << cachePath << file.errorString();
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << CacheMagic << FormatVersion << root << quint32(files.size());
+    for (auto it = files.cbegin(); it != files.cend(); ++it)
+    {
+        out << it.key() << it->mtime << it->size << it->checkedAt << it->hash << quint32(it->markers.size());
+        for (const Marker &marker : it->markers)
+            out << marker.title << qint32(marker.line) << marker.taskId;
+    }
+
+    if (out.status() != QDataStream::Ok || !file.commit())
+        qWarning() << "TodoScanner: cannot write" << cachePath << file.errorString();
+}
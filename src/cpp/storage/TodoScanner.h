@@ -0,0 +1,223 @@
+#pragma once
+
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+class TaskModel;
+
+
+/**
+ * @file TodoScanner.h
+ * @brief Turns TODO and FIXME comments of a source tree into tasks
+ */
+
+/**
+ * @class TodoScanner
+ * @brief Scans a source tree for TODO and FIXME markers and keeps one task per marker
+ *
+ * A scan runs on the global thread pool. The tree is walked one level at a time, the
+ * directories of a level being listed in parallel; ignored paths (.gitignore files,
+ * .git/info/exclude, and .git itself) are skipped without descending into them. Every
+ * file whose mtime and size differ from the cache is memory-mapped, hashed, and, if its
+ * hash changed, searched with TextScanner's vectorized byte search. Binary files (a NUL
+ * in the first 8000 bytes, as git decides) and files over MaxFileSize are skipped.
+ *
+ * A marker is a TODO or FIXME word inside a comment. Its task is titled with the rest of
+ * the line ("FIXME(ana): overflow when empty"), described with its location
+ * ("src/parser.cpp:42"), and FIXMEs get high priority. The results are applied to the
+ * model as a diff, file by file: markers are matched to the previous scan's by title, so
+ * a marker that only moved keeps its task, a new marker adds a task, and a removed one
+ * purges its task. Unchanged files and markers touch no rows. The location is kept with
+ * the marker (see markers()); a moved marker rewrites its task's description only while
+ * that still reads as the old location, so descriptions the user wrote are left alone.
+ *
+ * A task the user deletes keeps its marker quiet until the marker's text changes.
+ *
+ * Example usage:
+ * @code
+ * TodoScanner *todos = new TodoScanner(this);
+ * todos->attach(model);
+ * todos->open(QDir::homePath() + "/src/project", dataDir + "/todo-scan.cache");
+ * @endcode
+ */
+class TodoScanner : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool scanning READ isScanning NOTIFY scanningChanged)
+
+public:
+
+    /**
+     * @brief Files larger than this are not searched, in bytes
+     */
+    static constexpr qint64 MaxFileSize = 8 << 20;
+
+    /**
+     * @brief Default time between the end of a scan and the next one, in milliseconds
+     */
+    static constexpr int DefaultRescanInterval = 30000;
+
+    /**
+     * @brief A file whose mtime is less than this before it was cached is hashed on every scan
+     */
+    static constexpr qint64 RacyWindowMs = 2000;
+
+    /**
+     * @brief Longest task title taken from a marker line, in characters
+     */
+    static constexpr int MaxTitleLength = 200;
+
+    /**
+     * @brief A marker found in a file
+     */
+    struct Marker
+    {
+        QString title;            ///< Marker word and the rest of its line
+        int line = 0;             ///< 1-based line number
+        quint64 taskId = 0;       ///< Task of the marker, 0 if it has none yet
+    };
+
+    /**
+     * @brief Constructs a scanner without a tree
+     * @param parent The parent QObject
+     */
+    explicit TodoScanner(QObject *parent = nullptr);
+
+    /**
+     * @brief Waits for a running scan; its result is dropped
+     */
+    ~TodoScanner() override;
+
+    /**
+     * @brief Sets the model receiving the markers' tasks
+     */
+    void attach(TaskModel *model);
+
+    /**
+     * @brief Opens a source tree and starts scanning it
+     * @param directory Root of the tree
+     * @param cacheFile Path of the file keeping the scan cache and the marker-to-task map
+     *                  between sessions; without it every file is searched on open
+     * @return false if the directory does not exist or no model is attached
+     *
+     * Markers whose tasks are no longer in the model, not even in the trash, get new ones.
+     */
+    bool open(const QString &directory, const QString &cacheFile = QString());
+
+    /**
+     * @brief Gets the root of the tree, empty if none is open
+     */
+    QString directory() const { return root; }
+
+    /**
+     * @brief Starts a scan; one requested while a scan runs starts when it ends
+     * @return false if no tree is open
+     */
+    Q_INVOKABLE bool scan();
+
+    /**
+     * @brief Blocks until the running scan, if any, is applied
+     */
+    void waitForScan();
+
+    bool isScanning() const { return busy; }
+
+    int rescanInterval() const { return rescanTimer.interval(); }
+
+    /**
+     * @brief Sets the time from the end of a scan to the next one; 0 scans on demand only
+     */
+    void setRescanInterval(int ms);
+
+    /**
+     * @brief Gets the number of files with markers
+     */
+    int fileCount() const;
+
+    /**
+     * @brief Gets the number of markers
+     */
+    int markerCount() const;
+
+    /**
+     * @brief Gets the markers of a file, in line order
+     * @param path Path relative to directory()
+     */
+    QList<Marker> markers(const QString &path) const { return files.value(path).markers; }
+
+    /**
+     * @brief Finds the markers of a file's content
+     * @param content The bytes of the file
+     * @param length Number of bytes
+     * @return Markers in line order, without tasks
+     */
+    static QList<Marker> findMarkers(const char *content, qsizetype length);
+
+signals:
+
+    void scanningChanged();
+
+    /**
+     * @brief Emitted after a scan was applied to the model
+     * @param files Number of files in the tree, ignored ones excluded
+     * @param searched Number of files searched, i.e. new or changed
+     * @param added Number of tasks added
+     * @param updated Number of tasks whose description was moved to a new location
+     * @param removed Number of tasks purged
+     */
+    void scanned(int files, int searched, int added, int updated, int removed);
+
+private:
+
+    /**
+     * @brief What the cache knows about a file
+     */
+    struct Entry
+    {
+        qint64 mtime = 0;         ///< Modification time at the last check, ms since the epoch
+        qint64 size = -1;         ///< Size at the last check
+        qint64 checkedAt = 0;     ///< When the file was last read, ms since the epoch
+        QByteArray hash;          ///< Hash of the content at the last check
+        QList<Marker> markers;    ///< Markers at the last check
+    };
+
+    /**
+     * @brief Result of checking one file on a worker thread
+     */
+    struct Check
+    {
+        QString path;             ///< Path relative to the root
+        Entry entry;              ///< Updated cache entry; markers are the new ones if changed
+        bool changed = false;     ///< Whether the content changed, i.e. the file was searched
+    };
+
+    /**
+     * @brief Result of a whole scan
+     */
+    struct Result
+    {
+        QList<Check> checks;      ///< One per file of the tree
+        int searched = 0;         ///< Number of files searched
+    };
+
+    QPointer<TaskModel> model;            ///< Model receiving the tasks
+    QString root;                         ///< Root of the tree, empty if none
+    QString cachePath;                    ///< Cache file, empty if none
+    QHash<QString, Entry> files;          ///< Files of the tree by relative path
+    QFutureWatcher<Result> watcher;       ///< Running scan
+    QTimer rescanTimer;                   ///< Starts the next periodic scan
+    bool busy = false;                    ///< Set from the start of a scan until it is applied
+    bool rescanPending = false;           ///< A scan was requested while one was running
+
+    static Result run(const QString &root, const QHash<QString, Entry> &cached, qint64 now);
+    static Check check(const QString &root, const QFileInfo &info, const Entry &cached, qint64 now);
+    void finish();
+    void apply(const Result &result);
+    bool taskExists(quint64 taskId) const;
+    bool loadCache();
+    void saveCache() const;
+};
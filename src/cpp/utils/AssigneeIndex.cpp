@@ -0,0 +1,106 @@
+#include "AssigneeIndex.h"
+
+#include <algorithm>
+
+AssigneeIndex::AssigneeIndex()
+{
+    intern(QString());
+}
+
+quint32 AssigneeIndex::intern(const QString &name)
+{
+    // The empty name is interned by the constructor, so names is never empty here.
+    if (name.isEmpty() && !names.isEmpty())
+        return 0;
+
+    const auto it = ids.constFind(name);
+    if (it != ids.constEnd())
+        return *it;
+
+    const quint32 person = quint32(names.size());
+    names.append(name);
+    ids.insert(name, person);
+    lists.append(QList<quint64>());
+    loads.append(Workload());
+    return person;
+}
+
+qint64 AssigneeIndex::find(const QString &name) const
+{
+    const auto it = ids.constFind(name);
+    return it != ids.constEnd() ? qint64(*it) : -1;
+}
+
+int AssigneeIndex::position(quint32 person, quint64 taskId) const
+{
+    const QList<quint64> &list = postings(person);
+    return int(std::lower_bound(list.cbegin(), list.cend(), taskId) - list.cbegin());
+}
+
+int AssigneeIndex::insert(quint32 person, quint64 taskId, bool completed)
+{
+    if (person >= quint32(lists.size()))
+        return -1;
+
+    // Ids grow with every new task, so this is an append unless a task is restored.
+    QList<quint64> &list = lists[person];
+    const int at = position(person, taskId);
+    list.insert(at, taskId);
+    if (completed)
+        ++loads[person].completed;
+    else
+        ++loads[person].open;
+    return at;
+}
+
+int AssigneeIndex::remove(quint32 person, quint64 taskId, bool completed)
+{
+    if (person >= quint32(lists.size()))
+        return -1;
+
+    QList<quint64> &list = lists[person];
+    const int at = position(person, taskId);
+    if (at >= list.size() || list[at] != taskId)
+        return -1;
+
+    list.remove(at);
+    if (completed)
+        --loads[person].completed;
+    else
+        --loads[person].open;
+    return at;
+}
+
+void AssigneeIndex::setCompleted(quint32 person, bool completed)
+{
+    if (person >= quint32(loads.size()))
+        return;
+
+    Workload &load = loads[person];
+    load.open += completed ? -1 : 1;
+    load.completed += completed ? 1 : -1;
+}
+
+const QList<quint64> &AssigneeIndex::postings(quint32 person) const
+{
+    static const QList<quint64> none;
+    return person < quint32(lists.size()) ? lists[person] : none;
+}
+
+QList<quint32> AssigneeIndex::assigned() const
+{
+    QList<quint32> people;
+    for (quint32 person = 0; person < quint32(lists.size()); ++person)
+    {
+        if (!lists[person].isEmpty())
+            people.append(person);
+    }
+    return people;
+}
+
+void AssigneeIndex::clear()
+{
+    for (QList<quint64> &list : lists)
+        list = QList<quint64>();
+    loads.fill(Workload());
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+
+/**
+ * @file AssigneeIndex.h
+ * @brief Interned assignee names with a posting list and workload counts per person
+ */
+
+/**
+ * @class AssigneeIndex
+ * @brief Keeps, for every assignee, the ids of their tasks and how many are open or done
+ *
+ * Names are interned into a person table: each distinct name gets a small id once, and
+ * all tasks of a person share one copy of the name. Id 0 is the empty name, i.e.
+ * unassigned tasks, which are indexed like everyone else's.
+ *
+ * Every person has a posting list, the ascending ids of their tasks, and a count of open
+ * and completed tasks. Both are maintained incrementally by the owner: adding, removing
+ * or completing a task touches the posting list and counts of one person, reassigning
+ * it those of two. Finding "my tasks" is then a lookup instead of a scan of all tasks.
+ *
+ * Interned ids stay valid until the index is destroyed, also after clear() and after
+ * the last task of a person is gone, so they can be held on to (see AssigneeModel).
+ *
+ * Example usage:
+ * @code
+ * AssigneeIndex index;
+ * const quint32 ana = index.intern("Ana");
+ * index.insert(ana, 7, false);
+ * index.insert(ana, 3, true);
+ * index.postings(ana);             // {3, 7}
+ * index.workload(ana).open;        // 1
+ * @endcode
+ */
+class AssigneeIndex
+{
+public:
+
+    /**
+     * @brief Numbers of tasks of a person by status
+     */
+    struct Workload
+    {
+        int open = 0;       ///< Tasks not completed
+        int completed = 0;  ///< Completed tasks
+
+        int total() const { return open + completed; }
+    };
+
+    /**
+     * @brief Constructs an index knowing only the empty name
+     */
+    AssigneeIndex();
+
+    /**
+     * @brief Gets the id of a name, adding the name to the person table if needed
+     * @param name The assignee, compared exactly; 0 for an empty name
+     */
+    quint32 intern(const QString &name);
+
+    /**
+     * @brief Gets the id of a known name
+     * @return The id, or -1 if the name was never interned
+     */
+    qint64 find(const QString &name) const;
+
+    /**
+     * @brief Gets the interned copy of a name
+     * @return The name, or an empty string if person is unknown
+     */
+    QString name(quint32 person) const { return names.value(person); }
+
+    /**
+     * @brief Gets the number of interned names, including the empty one
+     */
+    int personCount() const { return int(names.size()); }
+
+    /**
+     * @brief Gets the position of a task in the posting list of a person
+     * @return The position of the task or, if it is not listed, the one it would be inserted at
+     */
+    int position(quint32 person, quint64 taskId) const;
+
+    /**
+     * @brief Adds a task to the posting list of a person
+     * @param person An interned id
+     * @param taskId The task, not listed yet
+     * @param completed Whether it counts as completed or as open
+     * @return The position it was inserted at
+     */
+    int insert(quint32 person, quint64 taskId, bool completed);
+
+    /**
+     * @brief Removes a task from the posting list of a person
+     * @param completed Whether it counted as completed or as open
+     * @return The position it was removed from, or -1 if it was not listed
+     */
+    int remove(quint32 person, quint64 taskId, bool completed);
+
+    /**
+     * @brief Moves a task of a person from open to completed or back
+     */
+    void setCompleted(quint32 person, bool completed);
+
+    /**
+     * @brief Gets the ascending ids of the tasks of a person
+     */
+    const QList<quint64> &postings(quint32 person) const;
+
+    /**
+     * @brief Gets the counts of the tasks of a person
+     */
+    Workload workload(quint32 person) const { return person < quint32(loads.size()) ? loads[person] : Workload(); }
+
+    /**
+     * @brief Gets the ids of the people with at least one task, in the order they were interned
+     */
+    QList<quint32> assigned() const;
+
+    /**
+     * @brief Empties all posting lists and counts; the person table is kept
+     */
+    void clear();
+
+private:
+
+    QList<QString> names;               ///< Interned names by id
+    QHash<QString, quint32> ids;        ///< Reverse lookup of interned names
+    QList<QList<quint64>> lists;        ///< Posting list by id
+    QList<Workload> loads;              ///< Counts by id
+};
@@ -0,0 +1,204 @@
+#include "GitIgnore.h"
+
+#include <QFile>
+
+namespace
+{
+
+/**
+ * Matches one character against the class starting at pattern[position] == '['.
+ * Returns the index past the closing ']', or -1 if the class is not terminated, in which
+ * case the '[' is an ordinary character.
+ */
+qsizetype matchClass(QStringView pattern, qsizetype position, QChar c, bool &matched)
+{
+    qsizetype i = position + 1;
+    bool negated = false;
+    if (i < pattern.size() && (pattern[i] == u'!' || pattern[i] == u'^'))
+    {
+        negated = true;
+        ++i;
+    }
+
+    bool found = false;
+    for (bool first = true; i < pattern.size() && (first || pattern[i] != u']'); first = false, ++i)
+    {
+        QChar low = pattern[i];
+        if (low == u'\\' && i + 1 < pattern.size())
+            low = pattern[++i];
+        QChar high = low;
+        if (i + 2 < pattern.size() && pattern[i + 1] == u'-' && pattern[i + 2] != u']')
+        {
+            i += 2;
+            if (pattern[i] == u'\\' && i + 1 < pattern.size())
+                ++i;
+            high = pattern[i];
+        }
+        if (c >= low && c <= high)
+            found = true;
+    }
+    if (i >= pattern.size())
+        return -1;
+
+    matched = found != negated;
+    return i + 1;
+}
+
+bool matchFrom(QStringView pattern, qsizetype p, QStringView path, qsizetype s)
+{
+    while (p < pattern.size())
+    {
+        const QChar c = pattern[p];
+        if (c == u'*')
+        {
+            if (p + 1 < pattern.size() && pattern[p + 1] == u'*')
+            {
+                p += 2;
+                if (p < pattern.size() && pattern[p] == u'/')
+                {
+                    // "**/" matches zero or more whole directories.
+                    ++p;
+                    if (matchFrom(pattern, p, path, s))
+                        return true;
+                    for (qsizetype i = s; i < path.size(); ++i)
+                    {
+                        if (path[i] == u'/' && matchFrom(pattern, p, path, i + 1))
+                            return true;
+                    }
+                    return false;
+                }
+                // Any other "**" matches across directories.
+                for (qsizetype i = s; i <= path.size(); ++i)
+                {
+                    if (matchFrom(pattern, p, path, i))
+                        return true;
+                }
+                return false;
+            }
+
+            ++p;
+            for (qsizetype i = s;; ++i)
+            {
+                if (matchFrom(pattern, p, path, i))
+                    return true;
+                if (i == path.size() || path[i] == u'/')
+                    return false;
+            }
+        }
+
+        if (s == path.size())
+            return false;
+        if (c == u'?')
+        {
+            if (path[s] == u'/')
+                return false;
+            ++p;
+            ++s;
+            continue;
+        }
+        if (c == u'[')
+        {
+            bool matched = false;
+            const qsizetype next = matchClass(pattern, p, path[s], matched);
+            if (next >= 0)
+            {
+                if (!matched || path[s] == u'/')
+                    return false;
+                p = next;
+                ++s;
+                continue;
+            }
+        }
+
+        QChar literal = c;
+        if (c == u'\\' && p + 1 < pattern.size())
+            literal = pattern[++p];
+        if (path[s] != literal)
+            return false;
+        ++p;
+        ++s;
+    }
+    return s == path.size();
+}
+
+}
+
+int GitIgnore::addRules(const QByteArray &content, const QString &base)
+{
+    const QString prefix = base.isEmpty() || base.endsWith(u'/') ? base : base + u'/';
+    int added = 0;
+    for (const QByteArray &bytes : content.split('\n'))
+    {
+        QString line = QString::fromUtf8(bytes);
+        if (line.endsWith(u'\r'))
+            line.chop(1);
+        if (line.isEmpty() || line.startsWith(u'#'))
+            continue;
+
+        // Trailing spaces are dropped unless escaped.
+        while (line.endsWith(u' ') && !line.endsWith(QLatin1String("\\ ")))
+            line.chop(1);
+
+        Rule rule;
+        rule.base = prefix;
+        if (line.startsWith(u'!'))
+        {
+            rule.negated = true;
+            line.remove(0, 1);
+        }
+        if (line.endsWith(u'/'))
+        {
+            rule.directoryOnly = true;
+            line.chop(1);
+        }
+        if (line.startsWith(u'/'))
+        {
+            rule.anchored = true;
+            line.remove(0, 1);
+        }
+        else
+        {
+            rule.anchored = line.contains(u'/');
+        }
+        if (line.isEmpty())
+            continue;
+
+        rule.pattern = line;
+        rules.append(rule);
+        ++added;
+    }
+    return added;
+}
+
+bool GitIgnore::load(const QString &path, const QString &base)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    addRules(file.readAll(), base);
+    return true;
+}
+
+bool GitIgnore::isIgnored(const QString &path, bool isDirectory) const
+{
+    const QStringView name = QStringView(path).mid(path.lastIndexOf(u'/') + 1);
+    for (auto rule = rules.crbegin(); rule != rules.crend(); ++rule)
+    {
+        if (rule->directoryOnly && !isDirectory)
+            continue;
+        if (!rule->base.isEmpty() && !path.startsWith(rule->base))
+            continue;
+
+        const bool match = rule->anchored ? matches(rule->pattern, QStringView(path).mid(rule->base.size()))
+                                          : matches(rule->pattern, name);
+        if (match)
+            return !rule->negated;
+    }
+    return false;
+}
+
+bool GitIgnore::matches(QStringView pattern, QStringView path)
+{
+    return matchFrom(pattern, 0, path, 0);
+}
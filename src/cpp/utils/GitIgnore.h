@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+
+/**
+ * @file GitIgnore.h
+ * @brief Matcher for .gitignore patterns
+ */
+
+/**
+ * @class GitIgnore
+ * @brief Decides which paths of a source tree git would ignore
+ *
+ * Rules are read from .gitignore files (and .git/info/exclude) and apply below the
+ * directory they were read from. Rules added later take precedence, so a walk that adds
+ * each directory's .gitignore to a copy of its parent's matcher gets git's precedence:
+ * deeper files override shallower ones, and within a file the last matching line wins.
+ *
+ * Supported syntax: comments, `!` negation, a trailing `/` for directories only, a leading
+ * or inner `/` anchoring the pattern to its directory, `*`, `?`, `[...]` classes, `**` for
+ * any number of directories, and `\` escapes. As in git, a file inside an ignored
+ * directory cannot be re-included; callers are expected not to descend into one.
+ *
+ * Example usage:
+ * @code
+ * GitIgnore ignore;
+ * ignore.addRules("build/\n*.o\n!keep.o\n");
+ * ignore.isIgnored("src/main.o", false);  // true
+ * ignore.isIgnored("src/keep.o", false);  // false
+ * ignore.isIgnored("build", true);        // true
+ * @endcode
+ */
+class GitIgnore
+{
+public:
+
+    /**
+     * @brief Adds the rules of a .gitignore file
+     * @param content Content of the file
+     * @param base Directory of the file, relative to the root of the tree; empty for the root
+     * @return Number of rules added
+     */
+    int addRules(const QByteArray &content, const QString &base = QString());
+
+    /**
+     * @brief Reads a .gitignore file and adds its rules
+     * @param path Path of the file
+     * @param base Directory of the file, relative to the root of the tree
+     * @return false if the file does not exist or cannot be read
+     */
+    bool load(const QString &path, const QString &base = QString());
+
+    /**
+     * @brief Checks whether a path is ignored
+     * @param path Path relative to the root of the tree, with '/' separators
+     * @param isDirectory Whether the path is a directory
+     */
+    bool isIgnored(const QString &path, bool isDirectory) const;
+
+    /**
+     * @brief Gets the number of rules
+     */
+    int size() const { return int(rules.size()); }
+
+    /**
+     * @brief Matches a glob against a whole path
+     * @param pattern The glob; `*`, `?` and classes stop at '/', `**` does not
+     * @param path The path to match
+     */
+    static bool matches(QStringView pattern, QStringView path);
+
+private:
+
+    /**
+     * @brief One line of a .gitignore file
+     */
+    struct Rule
+    {
+        QString pattern;            ///< Glob without the negation, anchor and trailing slash
+        QString base;               ///< Directory the rule applies below, with a trailing '/'; empty for the root
+        bool negated = false;       ///< Re-includes what earlier rules ignored
+        bool directoryOnly = false; ///< Matches directories only
+        bool anchored = false;      ///< Matches the path below base rather than the last component
+    };
+
+    QList<Rule> rules;              ///< Rules in increasing precedence
+};
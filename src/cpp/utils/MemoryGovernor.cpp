@@ -0,0 +1,233 @@
+#include "MemoryGovernor.h"
+
+#include <QFile>
+
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#endif
+
+MemoryGovernor::MemoryGovernor(QObject *parent)
+    : QObject(parent), pressurePath(QStringLiteral("/proc/pressure/memory"))
+{
+    connect(&timer, &QTimer::timeout, this, &MemoryGovernor::sample);
+}
+
+void MemoryGovernor::registerCache(const QString &name, CachePriority priority, QObject *owner,
+                                   std::function<qint64()> size, std::function<qint64()> release)
+{
+    unregisterCache(name);
+
+    Cache cache;
+    cache.info.name = name;
+    cache.info.priority = priority;
+    cache.owner = owner;
+    cache.size = std::move(size);
+    cache.release = std::move(release);
+    cache.info.bytes = owner ? cache.size() : 0;
+
+    // Keep the registry sorted by priority, in registration order within a priority.
+    const auto position = std::upper_bound(registry.begin(), registry.end(), priority,
+                                           [](CachePriority value, const Cache &other) { return value < other.info.priority; });
+    registry.insert(position, std::move(cache));
+
+    if (owner)
+        connect(owner, &QObject::destroyed, this, [this, name]() { unregisterCache(name); });
+}
+
+void MemoryGovernor::unregisterCache(const QString &name)
+{
+    registry.removeIf([&name](const Cache &cache) { return cache.info.name == name; });
+}
+
+QList<MemoryGovernor::CacheInfo> MemoryGovernor::caches() const
+{
+    QList<CacheInfo> result;
+    result.reserve(registry.size());
+    for (const Cache &cache : registry)
+        result.append(cache.info);
+    return result;
+}
+
+void MemoryGovernor::measure()
+{
+    for (Cache &cache : registry)
+        cache.info.bytes = cache.owner ? cache.size() : 0;
+    sinceMeasured.start();
+}
+
+void MemoryGovernor::start(int interval)
+{
+    timer.start(interval);
+}
+
+void MemoryGovernor::stop()
+{
+    timer.stop();
+}
+
+void MemoryGovernor::setResidentBudget(qint64 bytes)
+{
+    bytes = qMax<qint64>(0, bytes);
+    if (budget != bytes)
+    {
+        budget = bytes;
+        emit residentBudgetChanged();
+    }
+}
+
+void MemoryGovernor::sample()
+{
+    const PressureSample pressure = readPressure(pressurePath);
+    resident = readResidentBytes();
+
+    Level level = Normal;
+    if (pressure.valid)
+    {
+        if (pressure.fullAvg10 >= 10.0)
+            level = Critical;
+        else if (pressure.fullAvg10 >= 2.0 || pressure.someAvg10 >= 30.0)
+            level = High;
+        else if (pressure.someAvg10 >= 10.0)
+            level = Elevated;
+    }
+
+    const qint64 excess = budget > 0 && resident > budget ? resident - budget : 0;
+    if (excess > 0)
+        level = qMax(level, resident > budget + budget / 2 ? High : Elevated);
+
+    if (level != currentLevel)
+    {
+        currentLevel = level;
+        emit levelChanged();
+    }
+
+    if (level == Normal)
+    {
+        shedLevel = Normal;
+    }
+    else if (level > shedLevel || !sinceShed.isValid() || sinceShed.elapsed() >= RepeatInterval)
+    {
+        // Shed once per raised level; while the level holds, only every RepeatInterval so
+        // caches rebuilt in between are not thrown away on every sample.
+        const CachePriority maxPriority = level == Critical ? Expensive : level == High ? Rebuildable : Disposable;
+        qint64 released = shed(maxPriority);
+        if (released < excess)
+            released += shed(Expensive, excess - released);
+
+        shedLevel = level;
+        sinceShed.start();
+    }
+
+    // Sizing a cache can walk all of it, so sizes are refreshed less often than sampled.
+    if (!sinceMeasured.isValid() || sinceMeasured.elapsed() >= MeasureInterval)
+        measure();
+
+    emit sampled();
+}
+
+qint64 MemoryGovernor::shed(CachePriority maxPriority, qint64 target)
+{
+    qint64 released = 0;
+    for (Cache &cache : registry)
+    {
+        if (cache.info.priority > maxPriority || (target >= 0 && released >= target))
+            break;
+        if (!cache.owner)
+            continue;
+
+        const qint64 bytes = cache.release();
+        if (bytes <= 0)
+            continue;
+
+        ++cache.info.shedCount;
+        cache.info.shedBytes += bytes;
+        cache.info.bytes = cache.size();
+        released += bytes;
+        emit cacheShed(cache.info.name, bytes);
+    }
+
+    totalShed += released;
+    untrimmed += released;
+    if (untrimmed >= TrimThreshold)
+        trim();
+    return released;
+}
+
+void MemoryGovernor::trim()
+{
+    untrimmed = 0;
+#if defined(__GLIBC__)
+    const qint64 before = readResidentBytes();
+    malloc_trim(0);
+    const qint64 after = readResidentBytes();
+    ++trims;
+    emit trimmed(before >= 0 && after >= 0 ? qMax<qint64>(0, before - after) : 0);
+#endif
+}
+
+MemoryGovernor::PressureSample MemoryGovernor::readPressure(const QString &path)
+{
+    // Format: "some avg10=1.23 avg60=0.50 avg300=0.10 total=12345"
+    //         "full avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+    PressureSample sample;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return sample;
+
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines)
+    {
+        const QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.size() < 2 || !fields.at(1).startsWith("avg10="))
+            continue;
+
+        bool ok = false;
+        const double value = fields.at(1).mid(6).toDouble(&ok);
+        if (!ok)
+            continue;
+
+        if (fields.at(0) == "some")
+        {
+            sample.someAvg10 = value;
+            sample.valid = true;
+        }
+        else if (fields.at(0) == "full")
+        {
+            sample.fullAvg10 = value;
+        }
+    }
+    return sample;
+}
+
+qint64 MemoryGovernor::readResidentBytes()
+{
+#if defined(Q_OS_LINUX)
+    // Second field of statm: resident pages
+    QFile file(QStringLiteral("/proc/self/statm"));
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+
+    const QList<QByteArray> fields = file.readAll().split(' ');
+    bool ok = false;
+    const qint64 pages = fields.value(1).toLongLong(&ok);
+    return ok ? pages * qint64(sysconf(_SC_PAGESIZE)) : -1;
+#elif defined(Q_OS_MACOS)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+        return -1;
+    return qint64(info.resident_size);
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+
+#include <functional>
+
+
+/**
+ * @file MemoryGovernor.h
+ * @brief Sheds caches when the system or the process runs short of memory
+ */
+
+/**
+ * @class MemoryGovernor
+ * @brief Watches memory pressure and releases registered caches in priority order
+ *
+ * Subsystems register their caches with a priority, a function reporting the cache's
+ * current size and a function releasing it. The governor periodically samples:
+ * - the system's memory pressure from Linux PSI (/proc/pressure/memory, avg10 of the
+ *   "some" and "full" lines)
+ * - the resident set size of the process, compared against an optional budget
+ *
+ * and derives a pressure level. When the level rises (or stays raised for
+ * RepeatInterval), caches are released in ascending priority order: Disposable caches
+ * at Elevated, Rebuildable ones at High and all of them at Critical. If the process is
+ * over its budget, caches are released in the same order until the excess is covered.
+ * After large releases the allocator is asked to return free memory to the system
+ * (malloc_trim on glibc).
+ *
+ * Every release is counted per cache and reported through cacheShed(), every trim
+ * through trimmed(). caches() returns the size of every cache for metrics as last
+ * measured: on registration, after shedding and every MeasureInterval, so reading it
+ * does not walk the caches. Without PSI (other platforms, old kernels) only the
+ * resident-set budget applies.
+ *
+ * Example usage:
+ * @code
+ * MemoryGovernor *governor = new MemoryGovernor(this);
+ * governor->registerCache("search.index", MemoryGovernor::Rebuildable, model,
+ *                         [model]() { return model->searchIndexSize(); },
+ *                         [model]() { return model->releaseSearchIndex(); });
+ * governor->setResidentBudget(512 * 1024 * 1024);
+ * governor->start();
+ * @endcode
+ */
+class MemoryGovernor : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * @property level
+     * @brief The pressure level of the latest sample
+     */
+    Q_PROPERTY(Level level READ level NOTIFY levelChanged)
+
+    /**
+     * @property residentBytes
+     * @brief Resident set size of the process at the latest sample, or -1 if unknown
+     */
+    Q_PROPERTY(qint64 residentBytes READ residentBytes NOTIFY sampled)
+
+    /**
+     * @property residentBudget
+     * @brief Resident set size above which caches are shed; 0 disables the budget
+     */
+    Q_PROPERTY(qint64 residentBudget READ residentBudget WRITE setResidentBudget NOTIFY residentBudgetChanged)
+
+    /**
+     * @property shedBytes
+     * @brief Total bytes released by shedding caches
+     */
+    Q_PROPERTY(qint64 shedBytes READ shedBytes NOTIFY cacheShed)
+
+    /**
+     * @property trimCount
+     * @brief Number of times free memory was returned to the system
+     */
+    Q_PROPERTY(int trimCount READ trimCount NOTIFY trimmed)
+
+public:
+
+    /**
+     * @enum Level
+     * @brief Memory pressure levels, from PSI and the resident-set budget
+     */
+    enum Level
+    {
+        Normal = 0, ///< No pressure
+        Elevated,   ///< Some tasks stall on memory (some avg10 >= 10%) or over budget
+        High,       ///< Heavy stalls (some avg10 >= 30% or full avg10 >= 2%) or 1.5x over budget
+        Critical    ///< The system is thrashing (full avg10 >= 10%)
+    };
+    Q_ENUM(Level)
+
+    /**
+     * @enum CachePriority
+     * @brief Order in which caches are shed; lower priorities go first
+     */
+    enum CachePriority
+    {
+        Disposable = 0, ///< Cheap to rebuild, e.g. derived snapshots
+        Rebuildable,    ///< Rebuilt on demand at noticeable cost, e.g. search indexes
+        Expensive       ///< Costly to rebuild; only shed at Critical
+    };
+    Q_ENUM(CachePriority)
+
+    /**
+     * @struct PressureSample
+     * @brief Parsed content of a PSI file
+     */
+    struct PressureSample
+    {
+        bool valid = false;    ///< Whether the file could be read and parsed
+        double someAvg10 = 0;  ///< Share of time (%) some tasks stalled on memory over 10 s
+        double fullAvg10 = 0;  ///< Share of time (%) all tasks stalled on memory over 10 s
+    };
+
+    /**
+     * @struct CacheInfo
+     * @brief State of a registered cache, for metrics
+     */
+    struct CacheInfo
+    {
+        QString name;           ///< Name given at registration
+        CachePriority priority; ///< Shedding priority
+        qint64 bytes = 0;       ///< Approximate size at the last measurement
+        int shedCount = 0;      ///< Number of times the cache was shed
+        qint64 shedBytes = 0;   ///< Total bytes released by shedding it
+    };
+
+    /**
+     * @brief Default sampling interval in milliseconds
+     */
+    static constexpr int DefaultInterval = 2000;
+
+    /**
+     * @brief Minimum time in milliseconds before caches are shed again at an unchanged level
+     */
+    static constexpr int RepeatInterval = 30000;
+
+    /**
+     * @brief Minimum time in milliseconds between two measurements of the cache sizes by sample()
+     */
+    static constexpr int MeasureInterval = 30000;
+
+    /**
+     * @brief Released bytes after which free memory is returned to the system
+     */
+    static constexpr qint64 TrimThreshold = 8 * 1024 * 1024;
+
+    /**
+     * @brief Constructs an idle governor; call start() to begin sampling
+     * @param parent The parent QObject
+     */
+    explicit MemoryGovernor(QObject *parent = nullptr);
+
+    /**
+     * @brief Registers a cache
+     * @param name Unique name of the cache, used in metrics
+     * @param priority Shedding priority
+     * @param owner Object owning the cache; the cache is unregistered when it is destroyed
+     * @param size Returns the approximate current size of the cache in bytes
+     * @param release Releases the cache and returns the approximate number of bytes freed
+     */
+    void registerCache(const QString &name, CachePriority priority, QObject *owner,
+                       std::function<qint64()> size, std::function<qint64()> release);
+
+    /**
+     * @brief Unregisters a cache
+     */
+    void unregisterCache(const QString &name);
+
+    /**
+     * @brief Gets the state of all registered caches, with their last measured sizes
+     */
+    QList<CacheInfo> caches() const;
+
+    /**
+     * @brief Measures the size of every cache now
+     */
+    void measure();
+
+    /**
+     * @brief Starts periodic sampling
+     * @param interval Sampling interval in milliseconds
+     */
+    void start(int interval = DefaultInterval);
+
+    /**
+     * @brief Stops periodic sampling
+     */
+    void stop();
+
+    /**
+     * @brief Samples memory pressure now and sheds caches if needed
+     */
+    Q_INVOKABLE void sample();
+
+    /**
+     * @brief Sheds caches in priority order
+     * @param maxPriority Highest priority to shed
+     * @param target Stop once at least this many bytes were released; -1 for no limit
+     * @return Approximate number of bytes released
+     */
+    qint64 shed(CachePriority maxPriority, qint64 target = -1);
+
+    Level level() const { return currentLevel; }
+    qint64 residentBytes() const { return resident; }
+    qint64 residentBudget() const { return budget; }
+    void setResidentBudget(qint64 bytes);
+    qint64 shedBytes() const { return totalShed; }
+    int trimCount() const { return trims; }
+
+    /**
+     * @brief Sets the PSI file to read; defaults to /proc/pressure/memory
+     */
+    void setPressurePath(const QString &path) { pressurePath = path; }
+
+    /**
+     * @brief Parses a PSI file
+     */
+    static PressureSample readPressure(const QString &path);
+
+    /**
+     * @brief Reads the resident set size of the current process
+     * @return Size in bytes, or -1 if it cannot be determined on this platform
+     */
+    static qint64 readResidentBytes();
+
+signals:
+
+    /**
+     * @brief Emitted after every sample
+     */
+    void sampled();
+
+    /**
+     * @brief Emitted when the pressure level changes
+     */
+    void levelChanged();
+
+    /**
+     * @brief Emitted when the resident-set budget changes
+     */
+    void residentBudgetChanged();
+
+    /**
+     * @brief Emitted after a cache has been shed
+     * @param name Name of the cache
+     * @param bytes Approximate number of bytes released
+     */
+    void cacheShed(const QString &name, qint64 bytes);
+
+    /**
+     * @brief Emitted after free memory has been returned to the system
+     * @param bytes Decrease of the resident set size, 0 if unknown
+     */
+    void trimmed(qint64 bytes);
+
+private:
+
+    struct Cache
+    {
+        CacheInfo info;
+        QPointer<QObject> owner;
+        std::function<qint64()> size;
+        std::function<qint64()> release;
+    };
+
+    QList<Cache> registry;          ///< Registered caches, sorted by priority
+    QTimer timer;                   ///< Sampling timer
+    QString pressurePath;           ///< PSI file
+    Level currentLevel = Normal;    ///< Level of the latest sample
+    Level shedLevel = Normal;       ///< Level at which caches were last shed
+    QElapsedTimer sinceShed;        ///< Time since caches were last shed
+    QElapsedTimer sinceMeasured;    ///< Time since the cache sizes were last measured
+    qint64 resident = -1;           ///< Resident set size of the latest sample
+    qint64 budget = 0;              ///< Resident set budget, 0 if disabled
+    qint64 totalShed = 0;           ///< Total bytes released
+    qint64 untrimmed = 0;           ///< Bytes released since the last trim
+    int trims = 0;                  ///< Number of trims
+
+    void trim();
+};
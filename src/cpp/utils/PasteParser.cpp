@@ -0,0 +1,265 @@
+#include "PasteParser.h"
+
+namespace
+{
+
+/**
+ * Gets the priority a marker word sets, or -1 if the word is no priority marker.
+ */
+int priorityMarker(const QString &word)
+{
+    if (!word.startsWith(QLatin1Char('!')))
+        return -1;
+    if (word == QLatin1String("!") || word.compare(QLatin1String("!low"), Qt::CaseInsensitive) == 0)
+        return 0;
+    if (word == QLatin1String("!!") || word.compare(QLatin1String("!medium"), Qt::CaseInsensitive) == 0
+        || word.compare(QLatin1String("!med"), Qt::CaseInsensitive) == 0)
+        return 1;
+    if (word == QLatin1String("!!!") || word.compare(QLatin1String("!high"), Qt::CaseInsensitive) == 0)
+        return 2;
+    return -1;
+}
+
+/**
+ * Checks if a word is a marker with the given sigil and a name of letters, digits, '-', '_'
+ * and '.' after it.
+ */
+bool isNameMarker(const QString &word, QChar sigil)
+{
+    if (word.size() < 2 || word.front() != sigil)
+        return false;
+    for (qsizetype i = 1; i < word.size(); ++i)
+    {
+        const QChar c = word[i];
+        if (!c.isLetterOrNumber() && c != QLatin1Char('-') && c != QLatin1Char('_') && c != QLatin1Char('.'))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Gets the length of the list marker a title starts with, 0 if none.
+ */
+qsizetype listMarkerLength(const QString &title)
+{
+    if (title.size() >= 2 && title[1] == QLatin1Char(' '))
+    {
+        const QChar c = title[0];
+        if (c == QLatin1Char('-') || c == QLatin1Char('*') || c == QLatin1Char('+') || c == QChar(0x2022))
+            return 2;
+    }
+
+    qsizetype digits = 0;
+    while (digits < title.size() && title[digits].isDigit())
+        ++digits;
+    if (digits > 0 && digits + 1 < title.size()
+        && (title[digits] == QLatin1Char('.') || title[digits] == QLatin1Char(')'))
+        && title[digits + 1] == QLatin1Char(' '))
+        return digits + 2;
+    return 0;
+}
+
+}
+
+QList<PasteParser::Entry> PasteParser::parse(const QString &text, int defaultPriority)
+{
+    QList<int> lines;
+    const QList<QStringList> rows = tokenize(text, &lines);
+
+    QList<Entry> entries;
+    entries.reserve(rows.size());
+    for (qsizetype i = 0; i < rows.size(); ++i)
+    {
+        Entry parsed = entry(rows[i], defaultPriority);
+        if (parsed.title.isEmpty())
+            continue;
+        parsed.line = lines[i];
+        entries.append(parsed);
+    }
+    return entries;
+}
+
+bool PasteParser::isList(const QString &text)
+{
+    int filled = 0;
+    bool blank = true;
+    for (QChar c : text)
+    {
+        if (c == QLatin1Char('\n') || c == QLatin1Char('\r'))
+        {
+            blank = true;
+        }
+        else if (blank && !c.isSpace())
+        {
+            blank = false;
+            if (++filled > 1)
+                return true;
+        }
+    }
+    return false;
+}
+
+QList<QStringList> PasteParser::tokenize(const QString &text, QList<int> *lines)
+{
+    QList<QStringList> rows;
+    QStringList cells;
+    QString cell;
+    bool fresh = true;      // Nothing of the current cell was read yet
+    bool unclosed = false;  // No quote left that could close a quoted cell
+    int line = 1;
+    int rowLine = 1;
+
+    auto endRow = [&]() {
+        cells.append(cell);
+        for (const QString &filled : std::as_const(cells))
+        {
+            if (!filled.trimmed().isEmpty())
+            {
+                rows.append(cells);
+                lines->append(rowLine);
+                break;
+            }
+        }
+        cells.clear();
+        cell.clear();
+        fresh = true;
+    };
+
+    const qsizetype n = text.size();
+    qsizetype i = 0;
+    while (i < n)
+    {
+        const QChar c = text[i];
+        if (fresh && !unclosed && c == QLatin1Char('"'))
+        {
+            // A quoted cell ends at a lone quote that ends the cell too; otherwise the
+            // quote is text, like in a title that starts with a quotation.
+            QString quoted;
+            int breaks = 0;
+            qsizetype j = i + 1;
+            bool closed = false;
+            while (j < n)
+            {
+                const QChar q = text[j];
+                if (q == QLatin1Char('"'))
+                {
+                    if (j + 1 < n && text[j + 1] == QLatin1Char('"'))
+                    {
+                        quoted += q;
+                        j += 2;
+                        continue;
+                    }
+                    closed = true;
+                    ++j;
+                    break;
+                }
+                if (q == QLatin1Char('\n') || (q == QLatin1Char('\r') && (j + 1 == n || text[j + 1] != QLatin1Char('\n'))))
+                    ++breaks;
+                quoted += q;
+                ++j;
+            }
+
+            unclosed = !closed;
+            if (closed && (j == n || text[j] == QLatin1Char('\t') || text[j] == QLatin1Char('\n') || text[j] == QLatin1Char('\r')))
+            {
+                cell = quoted;
+                line += breaks;
+                fresh = false;
+                i = j;
+                continue;
+            }
+        }
+
+        if (c == QLatin1Char('\t'))
+        {
+            cells.append(cell);
+            cell.clear();
+            fresh = true;
+        }
+        else if (c == QLatin1Char('\n') || c == QLatin1Char('\r'))
+        {
+            if (c == QLatin1Char('\r') && i + 1 < n && text[i + 1] == QLatin1Char('\n'))
+                ++i;
+            endRow();
+            rowLine = ++line;
+        }
+        else
+        {
+            cell += c;
+            fresh = false;
+        }
+        ++i;
+    }
+    if (!cell.isEmpty() || !cells.isEmpty())
+        endRow();
+    return rows;
+}
+
+PasteParser::Entry PasteParser::entry(const QStringList &cells, int defaultPriority)
+{
+    Entry result;
+    result.priority = defaultPriority;
+
+    qsizetype first = 0;
+    while (first < cells.size() && cells[first].trimmed().isEmpty())
+        ++first;
+    if (first == cells.size())
+        return result;
+
+    QString title = cells[first].simplified();
+    title.remove(0, listMarkerLength(title));
+    if (title.startsWith(QLatin1String("[ ] ")))
+    {
+        title.remove(0, 4);
+    }
+    else if (title.startsWith(QLatin1String("[x] "), Qt::CaseInsensitive))
+    {
+        title.remove(0, 4);
+        result.completed = true;
+    }
+
+    int priority = -1;
+    QStringList kept;
+    const QStringList words = title.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    for (const QString &word : words)
+    {
+        const int marked = priorityMarker(word);
+        if (marked >= 0)
+            priority = marked;
+        else if (isNameMarker(word, QLatin1Char('#')))
+            result.tags.append(word.mid(1));
+        else if (isNameMarker(word, QLatin1Char('@')))
+            result.assignee = word.mid(1);
+        else
+            kept.append(word);
+    }
+
+    if (kept.isEmpty())
+    {
+        // Only markers: the line is the title, as written.
+        result.title = title;
+        result.tags.clear();
+        result.assignee.clear();
+    }
+    else
+    {
+        result.title = kept.join(QLatin1Char(' '));
+        if (priority >= 0)
+        {
+            result.priority = priority;
+            result.marked = true;
+        }
+    }
+
+    QStringList details;
+    for (qsizetype i = first + 1; i < cells.size(); ++i)
+    {
+        const QString detail = cells[i].trimmed();
+        if (!detail.isEmpty())
+            details.append(detail);
+    }
+    if (!result.tags.isEmpty())
+        details.append(QLatin1Char('#') + result.tags.join(QLatin1String(" #")));
+    result.description = details.join(QLatin1Char('\n'));
+    return result;
+}
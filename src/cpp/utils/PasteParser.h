@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QList>
+#include <QStringList>
+
+
+/**
+ * @file PasteParser.h
+ * @brief Splits pasted text into task entries with inline markers
+ */
+
+/**
+ * @class PasteParser
+ * @brief Turns a pasted list, one task per line, into task entries
+ *
+ * Pasted text comes from spreadsheets, notes and mails, so the parser accepts what those
+ * produce:
+ * - Lines end with "\n", "\r\n" or "\r"; blank lines are skipped.
+ * - Tab-separated cells, as copied from a spreadsheet: the first non-empty cell is the
+ *   title, the others make up the description, one per line. A cell in double quotes may
+ *   span lines and contain tabs, with "" for a quote, as spreadsheets write cells with
+ *   line breaks.
+ * - List markers at the start of a line are dropped: "- ", "* ", "+ ", "• ", "1. ", "1) ".
+ *   A checkbox "[ ]" after them is dropped too; "[x]" marks the task completed.
+ *
+ * The title may contain inline markers, words that are taken out of it:
+ * - "!", "!!" and "!!!" set the priority to low, medium and high, as do "!low", "!medium"
+ *   and "!high";
+ * - "#tag" adds a tag; tasks have no tag field, so tags are appended to the description
+ *   and are found by search;
+ * - "@name" sets the assignee.
+ *
+ * A line that is only markers keeps its text as the title, so "#1" or "@home" alone still
+ * make a task.
+ *
+ * The parser is stateless and safe to run on a worker thread.
+ *
+ * Example usage:
+ * @code
+ * const QList<PasteParser::Entry> entries = PasteParser::parse(
+ *     "- Book flights !!! @ana #travel\n"
+ *     "- [x] Renew passport\n");
+ * entries[0].title;      // "Book flights"
+ * entries[0].priority;   // Task::High
+ * entries[1].completed;  // true
+ * @endcode
+ */
+class PasteParser
+{
+public:
+
+    /**
+     * @brief A task parsed from one line, or from one row of cells
+     */
+    struct Entry
+    {
+        QString title;              ///< Title without markers
+        QString description;        ///< Further cells, then the tags
+        int priority = 1;           ///< Task::Priority, the default one if no marker was given
+        bool marked = false;        ///< Whether the priority was given by a marker
+        QString assignee;           ///< Name of the last @ marker
+        QStringList tags;           ///< Names of the # markers, without the #
+        bool completed = false;     ///< Whether the line had a checked box
+        int line = 0;               ///< Line of the text the entry starts on, from 1
+    };
+
+    /**
+     * @brief Parses pasted text
+     * @param text The text
+     * @param defaultPriority Priority of entries without a priority marker
+     * @return The entries in the order of the text
+     */
+    static QList<Entry> parse(const QString &text, int defaultPriority = 1);
+
+    /**
+     * @brief Checks if a text holds more than one non-blank line, i.e. is a list to paste
+     */
+    static bool isList(const QString &text);
+
+private:
+
+    /**
+     * @brief Splits text into rows of cells, honouring quoted cells
+     * @param lines Receives the line each row starts on
+     */
+    static QList<QStringList> tokenize(const QString &text, QList<int> *lines);
+
+    /**
+     * @brief Builds an entry from the cells of a row
+     */
+    static Entry entry(const QStringList &cells, int defaultPriority);
+};
@@ -0,0 +1,352 @@
+#include "ScheduleGraph.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+void ScheduleGraph::addTask(quint64 id, qint64 duration)
+{
+    if (nodes.contains(id))
+    {
+        setDuration(id, duration);
+        return;
+    }
+
+    Node &node = nodes[id];
+    node.duration = qMax<qint64>(0, duration);
+    node.finish = node.duration;
+    node.tail = node.duration;
+    countFinish(node.finish, 1);
+    forwardDirty.insert(id);
+    backwardDirty.insert(id);
+
+    // Tasks that named this one before it existed can now be connected.
+    const QList<quint64> dependents = waiting.take(id);
+    for (quint64 dependent : dependents)
+    {
+        if (!link(id, dependent))
+            qWarning() << "ScheduleGraph::addTask: ignoring dependency of" << dependent << "on" << id << "closing a cycle";
+    }
+}
+
+void ScheduleGraph::removeTask(quint64 id)
+{
+    const auto it = nodes.constFind(id);
+    if (it == nodes.constEnd())
+        return;
+
+    const Node node = *it;
+    for (quint64 pred : node.preds)
+    {
+        nodes[pred].succs.removeOne(id);
+        backwardDirty.insert(pred);
+    }
+    for (quint64 succ : node.succs)
+    {
+        nodes[succ].preds.removeOne(id);
+        forwardDirty.insert(succ);
+        waiting[id].append(succ);
+    }
+    for (quint64 dependency : node.declared)
+    {
+        auto list = waiting.find(dependency);
+        if (list != waiting.end())
+        {
+            list->removeOne(id);
+            if (list->isEmpty())
+                waiting.erase(list);
+        }
+    }
+
+    countFinish(node.finish, -1);
+    forwardDirty.remove(id);
+    backwardDirty.remove(id);
+    nodes.remove(id);
+}
+
+void ScheduleGraph::clear()
+{
+    nodes.clear();
+    waiting.clear();
+    forwardDirty.clear();
+    backwardDirty.clear();
+    finishes.clear();
+    recomputed = 0;
+}
+
+void ScheduleGraph::setDuration(quint64 id, qint64 duration)
+{
+    const auto it = nodes.find(id);
+    duration = qMax<qint64>(0, duration);
+    if (it == nodes.end() || it->duration == duration)
+        return;
+
+    // The finish moves in the forward pass, the tail in the backward pass.
+    it->duration = duration;
+    forwardDirty.insert(id);
+    backwardDirty.insert(id);
+}
+
+bool ScheduleGraph::setDependencies(quint64 id, const QList<quint64> &dependencies)
+{
+    if (!nodes.contains(id))
+        return false;
+
+    QList<quint64> declared;
+    declared.reserve(dependencies.size());
+    for (quint64 dependency : dependencies)
+    {
+        if (dependency != id && !declared.contains(dependency))
+            declared.append(dependency);
+    }
+
+    const QList<quint64> previous = nodes[id].declared;
+    for (quint64 dependency : previous)
+    {
+        if (declared.contains(dependency))
+            continue;
+        if (nodes[id].preds.contains(dependency))
+        {
+            unlink(dependency, id);
+        }
+        else
+        {
+            auto list = waiting.find(dependency);
+            if (list != waiting.end())
+            {
+                list->removeOne(id);
+                if (list->isEmpty())
+                    waiting.erase(list);
+            }
+        }
+    }
+    nodes[id].declared = declared;
+
+    // Only edges that are new, or were ignored before, are connected; the others stay.
+    bool ok = true;
+    for (quint64 dependency : std::as_const(declared))
+    {
+        if (!nodes.contains(dependency))
+        {
+            QList<quint64> &list = waiting[dependency];
+            if (!list.contains(id))
+                list.append(id);
+        }
+        else if (!nodes[id].preds.contains(dependency) && !link(dependency, id))
+        {
+            qWarning() << "ScheduleGraph::setDependencies: ignoring dependency of" << id << "on" << dependency << "closing a cycle";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool ScheduleGraph::wouldCycle(quint64 id, quint64 dependency) const
+{
+    if (id == dependency)
+        return true;
+
+    // The new edge dependency -> id closes a cycle if id already leads to dependency.
+    QSet<quint64> seen{id};
+    QList<quint64> stack{id};
+    while (!stack.isEmpty())
+    {
+        const quint64 current = stack.takeLast();
+        for (quint64 succ : nodes.value(current).succs)
+        {
+            if (succ == dependency)
+                return true;
+            if (!seen.contains(succ))
+            {
+                seen.insert(succ);
+                stack.append(succ);
+            }
+        }
+    }
+    return false;
+}
+
+QList<quint64> ScheduleGraph::predecessors(quint64 id) const
+{
+    return nodes.value(id).preds;
+}
+
+QList<quint64> ScheduleGraph::successors(quint64 id) const
+{
+    return nodes.value(id).succs;
+}
+
+bool ScheduleGraph::link(quint64 from, quint64 to)
+{
+    if (wouldCycle(to, from))
+        return false;
+
+    nodes[from].succs.append(to);
+    nodes[to].preds.append(from);
+    forwardDirty.insert(to);
+    backwardDirty.insert(from);
+    return true;
+}
+
+void ScheduleGraph::unlink(quint64 from, quint64 to)
+{
+    nodes[from].succs.removeOne(to);
+    nodes[to].preds.removeOne(from);
+    forwardDirty.insert(to);
+    backwardDirty.insert(from);
+}
+
+QList<quint64> ScheduleGraph::order(const QSet<quint64> &seeds, bool forward) const
+{
+    // Reverse postorder of a depth-first walk is a topological order of what it reaches.
+    struct Frame
+    {
+        quint64 id;
+        qsizetype next;
+    };
+
+    QSet<quint64> seen;
+    QList<quint64> postorder;
+    QList<Frame> stack;
+    for (quint64 seed : seeds)
+    {
+        if (seen.contains(seed))
+            continue;
+        seen.insert(seed);
+        stack.append({seed, 0});
+        while (!stack.isEmpty())
+        {
+            const qsizetype top = stack.size() - 1;
+            const Node &node = *nodes.constFind(stack[top].id);
+            const QList<quint64> &edges = forward ? node.succs : node.preds;
+            if (stack[top].next < edges.size())
+            {
+                const quint64 next = edges[stack[top].next++];
+                if (!seen.contains(next))
+                {
+                    seen.insert(next);
+                    stack.append({next, 0});
+                }
+            }
+            else
+            {
+                postorder.append(stack[top].id);
+                stack.removeLast();
+            }
+        }
+    }
+
+    std::reverse(postorder.begin(), postorder.end());
+    return postorder;
+}
+
+QList<quint64> ScheduleGraph::update()
+{
+    recomputed = 0;
+    if (forwardDirty.isEmpty() && backwardDirty.isEmpty())
+        return {};
+
+    QSet<quint64> changed;
+
+    // Earliest starts: dependents of the marked tasks, prerequisites first.
+    QSet<quint64> moved;
+    for (quint64 id : order(forwardDirty, true))
+    {
+        Node &node = nodes[id];
+        const bool marked = forwardDirty.contains(id);
+        if (!marked && std::none_of(node.preds.cbegin(), node.preds.cend(), [&moved](quint64 pred) { return moved.contains(pred); }))
+            continue;
+
+        ++recomputed;
+        qint64 start = 0;
+        for (quint64 pred : std::as_const(node.preds))
+            start = qMax(start, nodes.value(pred).finish);
+
+        const qint64 finish = start + node.duration;
+        if (start != node.start)
+            changed.insert(id);
+        if (finish != node.finish)
+        {
+            countFinish(node.finish, -1);
+            countFinish(finish, 1);
+            moved.insert(id);
+            changed.insert(id);
+        }
+        node.start = start;
+        node.finish = finish;
+    }
+    forwardDirty.clear();
+
+    // Tails: prerequisites of the marked tasks, dependents first.
+    QSet<quint64> grown;
+    for (quint64 id : order(backwardDirty, false))
+    {
+        Node &node = nodes[id];
+        const bool marked = backwardDirty.contains(id);
+        if (!marked && std::none_of(node.succs.cbegin(), node.succs.cend(), [&grown](quint64 succ) { return grown.contains(succ); }))
+            continue;
+
+        ++recomputed;
+        qint64 tail = 0;
+        for (quint64 succ : std::as_const(node.succs))
+            tail = qMax(tail, nodes.value(succ).tail);
+        tail += node.duration;
+
+        if (tail != node.tail)
+        {
+            node.tail = tail;
+            grown.insert(id);
+            changed.insert(id);
+        }
+    }
+    backwardDirty.clear();
+
+    return QList<quint64>(changed.cbegin(), changed.cend());
+}
+
+ScheduleGraph::Times ScheduleGraph::times(quint64 id)
+{
+    update();
+    const auto it = nodes.constFind(id);
+    if (it == nodes.constEnd())
+        return Times();
+
+    Times result;
+    result.earliestStart = it->start;
+    result.earliestFinish = it->finish;
+    result.latestStart = projectEnd() - it->tail;
+    result.latestFinish = result.latestStart + it->duration;
+    result.slack = result.latestStart - result.earliestStart;
+    return result;
+}
+
+qint64 ScheduleGraph::projectEnd()
+{
+    update();
+    return finishes.isEmpty() ? 0 : finishes.lastKey();
+}
+
+QList<quint64> ScheduleGraph::criticalPath()
+{
+    const qint64 end = projectEnd();
+    QList<quint64> path;
+    for (auto it = nodes.constBegin(); it != nodes.constEnd(); ++it)
+    {
+        if (end - it->tail == it->start)
+            path.append(it.key());
+    }
+    std::sort(path.begin(), path.end(), [this](quint64 a, quint64 b) {
+        const qint64 startA = nodes.value(a).start;
+        const qint64 startB = nodes.value(b).start;
+        return startA != startB ? startA < startB : a < b;
+    });
+    return path;
+}
+
+void ScheduleGraph::countFinish(qint64 finish, int delta)
+{
+    int &count = finishes[finish];
+    count += delta;
+    if (count <= 0)
+        finishes.remove(finish);
+}
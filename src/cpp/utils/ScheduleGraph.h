@@ -0,0 +1,203 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+
+
+/**
+ * @file ScheduleGraph.h
+ * @brief Dependency graph of tasks with incrementally maintained critical path times
+ */
+
+/**
+ * @class ScheduleGraph
+ * @brief Earliest and latest start times of tasks with durations and prerequisites
+ *
+ * Every task is a node with a duration; a dependency of task B on task A is an edge A -> B
+ * and means B starts when A is finished. The graph keeps, per task:
+ *
+ * - the earliest start, the latest finish of all its prerequisites (0 without any), and
+ * - the tail, the length of the longest chain from the task's start to the end of the
+ *   project through the task and its dependents.
+ *
+ * The project ends with the latest earliest finish. The latest start of a task is the
+ * project end minus its tail, its slack the difference of latest and earliest start, and
+ * the tasks without slack form the critical path.
+ *
+ * Edits do not recompute the whole project. A changed duration or changed prerequisites
+ * mark the task; update() then walks the dependents of marked tasks for earliest starts
+ * and their prerequisites for tails, each in topological order of that subgraph, and
+ * recomputes a task only if it is marked or one of the tasks it reads has moved. Since latest starts are stored
+ * relative to the project end, a project end that moves changes no stored value. Queries
+ * call update() themselves, so several edits in a row are recomputed once.
+ *
+ * Dependencies may name tasks that are not in the graph (yet); those edges are kept aside
+ * and connected when the task is added. An edge that would close a cycle is ignored with
+ * a warning until the dependencies of its task are set again.
+ *
+ * Durations are plain numbers; TaskModel estimates are in hours.
+ *
+ * Example usage:
+ * @code
+ * ScheduleGraph graph;
+ * graph.addTask(1, 8);
+ * graph.addTask(2, 4);
+ * graph.addTask(3, 2);
+ * graph.setDependencies(3, {1, 2});
+ * graph.times(3).earliestStart;    // 8
+ * graph.times(2).slack;            // 4
+ * graph.criticalPath();            // {1, 3}
+ * @endcode
+ */
+class ScheduleGraph
+{
+public:
+
+    /**
+     * @brief Schedule of one task
+     */
+    struct Times
+    {
+        qint64 earliestStart = 0;   ///< Earliest start, when all prerequisites are finished
+        qint64 earliestFinish = 0;  ///< Earliest start plus duration
+        qint64 latestStart = 0;     ///< Latest start that does not delay the project
+        qint64 latestFinish = 0;    ///< Latest start plus duration
+        qint64 slack = 0;           ///< Latest minus earliest start; 0 on the critical path
+
+        bool critical() const { return slack == 0; }
+    };
+
+    /**
+     * @brief Adds a task without prerequisites
+     * @param id The task, not in the graph yet
+     * @param duration Its duration, 0 for a milestone
+     *
+     * Dependencies of other tasks on id that were waiting for it are connected.
+     */
+    void addTask(quint64 id, qint64 duration);
+
+    /**
+     * @brief Removes a task; dependencies of other tasks on it wait for it to come back
+     */
+    void removeTask(quint64 id);
+
+    /**
+     * @brief Checks whether a task is in the graph
+     */
+    bool contains(quint64 id) const { return nodes.contains(id); }
+
+    /**
+     * @brief Gets the number of tasks in the graph
+     */
+    int size() const { return int(nodes.size()); }
+
+    /**
+     * @brief Removes all tasks
+     */
+    void clear();
+
+    /**
+     * @brief Changes the duration of a task
+     */
+    void setDuration(quint64 id, qint64 duration);
+
+    /**
+     * @brief Replaces the prerequisites of a task
+     * @param id A task in the graph
+     * @param dependencies Ids of the tasks that must be finished first
+     * @return false if the task is unknown or an edge was ignored because it closes a cycle
+     */
+    bool setDependencies(quint64 id, const QList<quint64> &dependencies);
+
+    /**
+     * @brief Checks whether making a task depend on another one would close a cycle
+     * @param id The dependent task
+     * @param dependency The prerequisite
+     */
+    bool wouldCycle(quint64 id, quint64 dependency) const;
+
+    /**
+     * @brief Gets the prerequisites of a task that are in the graph and connected
+     */
+    QList<quint64> predecessors(quint64 id) const;
+
+    /**
+     * @brief Gets the tasks that depend on a task
+     */
+    QList<quint64> successors(quint64 id) const;
+
+    /**
+     * @brief Recomputes the times of the tasks affected by the edits since the last call
+     * @return Ids of the tasks whose earliest start or tail changed
+     */
+    QList<quint64> update();
+
+    /**
+     * @brief Gets the schedule of a task, updating first
+     * @return The times, all 0 if the task is unknown
+     */
+    Times times(quint64 id);
+
+    /**
+     * @brief Gets the end of the project, the latest earliest finish of all tasks, updating first
+     */
+    qint64 projectEnd();
+
+    /**
+     * @brief Gets the tasks without slack ordered by earliest start, updating first
+     */
+    QList<quint64> criticalPath();
+
+    /**
+     * @brief Gets the number of values the last update() recomputed
+     *
+     * Earliest starts and tails are counted separately, so a task counts twice if both
+     * were recomputed. Meant for tests and diagnostics.
+     */
+    int lastUpdateSize() const { return recomputed; }
+
+private:
+
+    struct Node
+    {
+        qint64 duration = 0;        ///< Duration of the task
+        QList<quint64> declared;    ///< Prerequisites as set, connected or not
+        QList<quint64> preds;       ///< Connected prerequisites
+        QList<quint64> succs;       ///< Connected dependents
+        qint64 start = 0;           ///< Earliest start
+        qint64 finish = 0;          ///< Earliest finish as counted in finishes; start plus duration after update()
+        qint64 tail = 0;            ///< Longest chain from the start of the task to the project end
+    };
+
+    QHash<quint64, Node> nodes;                 ///< Tasks by id
+    QHash<quint64, QList<quint64>> waiting;     ///< Dependents by the missing prerequisite they name
+    QSet<quint64> forwardDirty;                 ///< Tasks whose earliest start must be recomputed
+    QSet<quint64> backwardDirty;                ///< Tasks whose tail must be recomputed
+    QMap<qint64, int> finishes;                 ///< Number of tasks by earliest finish, for the project end
+    int recomputed = 0;                         ///< Values recomputed by the last update()
+
+    /**
+     * @brief Connects an edge, unless it closes a cycle
+     * @return false if the edge was ignored
+     */
+    bool link(quint64 from, quint64 to);
+
+    /**
+     * @brief Disconnects an edge
+     */
+    void unlink(quint64 from, quint64 to);
+
+    /**
+     * @brief Orders the tasks reachable from seeds topologically
+     * @param seeds Start of the walk
+     * @param forward Whether to walk to dependents or to prerequisites
+     */
+    QList<quint64> order(const QSet<quint64> &seeds, bool forward) const;
+
+    /**
+     * @brief Adds delta to the number of tasks finishing at finish
+     */
+    void countFinish(qint64 finish, int delta);
+};
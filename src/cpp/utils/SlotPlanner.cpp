@@ -0,0 +1,522 @@
+#include "SlotPlanner.h"
+
+#include <QElapsedTimer>
+#include <QSet>
+
+#include <algorithm>
+#include <queue>
+
+namespace
+{
+
+/**
+ * Free time by window. Every leaf of the segment tree is one window with its free pieces;
+ * every node keeps the longest free piece and the total free time of the windows below it.
+ */
+class FreeIndex
+{
+public:
+
+    explicit FreeIndex(const QList<SlotPlanner::Window> &windows)
+        : count(int(windows.size()))
+    {
+        while (size < count)
+            size <<= 1;
+        longest.fill(0, 2 * size);
+        freeTime.fill(0, 2 * size);
+        pieces.resize(count);
+        ends.reserve(count);
+        for (int leaf = 0; leaf < count; ++leaf)
+        {
+            pieces[leaf].append(windows[leaf]);
+            ends.append(windows[leaf].end);
+            longest[size + leaf] = windows[leaf].end - windows[leaf].start;
+            freeTime[size + leaf] = longest[size + leaf];
+        }
+        for (int node = size - 1; node > 0; --node)
+            pull(node);
+    }
+
+    /**
+     * Takes time for a task at or after ready: the earliest piece it fits in, or else the
+     * earliest pieces that add up to its duration. Empty if not enough time is left.
+     */
+    QList<SlotPlanner::Slot> take(quint64 id, qint64 ready, qint64 duration)
+    {
+        QList<SlotPlanner::Slot> taken;
+        SlotPlanner::Window found;
+        if (next(ready, duration, &found))
+        {
+            taken.append({id, found.start, found.start + duration});
+        }
+        else if (freeAfter(ready) >= duration)
+        {
+            qint64 remaining = duration;
+            while (remaining > 0 && next(ready, 1, &found))
+            {
+                const qint64 end = std::min(found.end, found.start + remaining);
+                taken.append({id, found.start, end});
+                remaining -= end - found.start;
+                ready = end;
+            }
+        }
+
+        for (const SlotPlanner::Slot &slot : std::as_const(taken))
+            take(slot.start, slot.end);
+        return taken;
+    }
+
+    /**
+     * Marks free time from start to end as taken; it must lie within one free piece.
+     */
+    void take(qint64 start, qint64 end)
+    {
+        const int leaf = leafAfter(start);
+        if (leaf >= count)
+            return;
+
+        QList<SlotPlanner::Window> &free = pieces[leaf];
+        for (int i = 0; i < free.size(); ++i)
+        {
+            const SlotPlanner::Window piece = free[i];
+            if (piece.start > start || piece.end < end)
+                continue;
+
+            free.remove(i);
+            if (end < piece.end)
+                free.insert(i, SlotPlanner::Window{end, piece.end});
+            if (piece.start < start)
+                free.insert(i, SlotPlanner::Window{piece.start, start});
+            update(leaf);
+            return;
+        }
+    }
+
+private:
+
+    int count = 0;                                      // Windows
+    int size = 1;                                       // Leaves of the tree, a power of two
+    QList<qint64> longest;                              // Longest free piece by node
+    QList<qint64> freeTime;                             // Total free time by node
+    QList<QList<SlotPlanner::Window>> pieces;           // Free pieces by window, in order
+    QList<qint64> ends;                                 // End by window
+
+    void pull(int node)
+    {
+        longest[node] = std::max(longest[2 * node], longest[2 * node + 1]);
+        freeTime[node] = freeTime[2 * node] + freeTime[2 * node + 1];
+    }
+
+    void update(int leaf)
+    {
+        qint64 length = 0;
+        qint64 sum = 0;
+        for (const SlotPlanner::Window &piece : std::as_const(pieces[leaf]))
+        {
+            length = std::max(length, piece.end - piece.start);
+            sum += piece.end - piece.start;
+        }
+        int node = size + leaf;
+        longest[node] = length;
+        freeTime[node] = sum;
+        for (node >>= 1; node > 0; node >>= 1)
+            pull(node);
+    }
+
+    // First window ending after time
+    int leafAfter(qint64 time) const
+    {
+        return int(std::upper_bound(ends.cbegin(), ends.cend(), time) - ends.cbegin());
+    }
+
+    // First window from "from" on with a free piece of at least duration
+    int firstFit(int node, int low, int high, int from, qint64 duration) const
+    {
+        if (high < from || low >= count || longest[node] < duration)
+            return -1;
+        if (low == high)
+            return low;
+
+        const int middle = (low + high) / 2;
+        const int found = firstFit(2 * node, low, middle, from, duration);
+        return found >= 0 ? found : firstFit(2 * node + 1, middle + 1, high, from, duration);
+    }
+
+    // Earliest free time of at least duration at or after ready, up to the end of its piece
+    bool next(qint64 ready, qint64 duration, SlotPlanner::Window *found) const
+    {
+        for (int leaf = leafAfter(ready); (leaf = firstFit(1, 0, size - 1, leaf, duration)) >= 0; ++leaf)
+        {
+            // Only the window of ready can have a long enough piece that starts too early.
+            for (const SlotPlanner::Window &piece : pieces[leaf])
+            {
+                const qint64 start = std::max(piece.start, ready);
+                if (start + duration <= piece.end)
+                {
+                    *found = {start, piece.end};
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Total free time at or after ready
+    qint64 freeAfter(qint64 ready) const
+    {
+        const int first = leafAfter(ready);
+        qint64 sum = 0;
+        for (int low = size + first, high = size + count; low < high; low >>= 1, high >>= 1)
+        {
+            if (low & 1)
+                sum += freeTime[low++];
+            if (high & 1)
+                sum += freeTime[--high];
+        }
+        if (first < count)
+        {
+            for (const SlotPlanner::Window &piece : pieces[first])
+                sum -= std::max(qint64(0), std::min(piece.end, ready) - piece.start);
+        }
+        return sum;
+    }
+};
+
+}
+
+bool SlotPlanner::Item::operator==(const Item &other) const
+{
+    return id == other.id && duration == other.duration && priority == other.priority
+           && dependencies == other.dependencies;
+}
+
+void SlotPlanner::setWindows(const QList<Window> &windows)
+{
+    QList<Window> sorted;
+    for (const Window &window : windows)
+    {
+        if (window.start < window.end)
+            sorted.append(window);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Window &a, const Window &b) { return a.start < b.start; });
+
+    free.clear();
+    for (const Window &window : std::as_const(sorted))
+    {
+        if (!free.isEmpty() && window.start <= free.last().end)
+            free.last().end = std::max(free.last().end, window.end);
+        else
+            free.append(window);
+    }
+    reset();
+}
+
+void SlotPlanner::reset()
+{
+    items.clear();
+    sequence.clear();
+    placed.clear();
+    all.clear();
+    total = 0;
+    replanned = 0;
+}
+
+const QList<SlotPlanner::Slot> &SlotPlanner::plan(const QList<Item> &list)
+{
+    QHash<quint64, Item> next;
+    next.reserve(list.size());
+    for (const Item &item : list)
+    {
+        if (item.id != 0 && item.duration > 0)
+            next.insert(item.id, item);
+    }
+
+    // The tasks before the first change keep their slots; the rest is planned again
+    // in the free time they leave.
+    const int kept = keptPrefix(next);
+    FreeIndex base(free);
+    QHash<quint64, QList<Slot>> keptSlots;
+    QHash<quint64, qint64> keptFinishes;    // -1 for unplaced tasks
+    qint64 keptCost = 0;
+    for (int i = 0; i < kept; ++i)
+    {
+        const quint64 id = sequence[i];
+        const QList<Slot> taken = placed.value(id);
+        for (const Slot &slot : taken)
+            base.take(slot.start, slot.end);
+        if (!taken.isEmpty())
+            keptSlots.insert(id, taken);
+
+        const qint64 finish = taken.isEmpty() ? -1 : taken.last().end;
+        keptFinishes.insert(id, finish);
+        keptCost += itemCost(next.value(id), finish);
+    }
+
+    QList<quint64> rest = suffixOrder(next, kept);
+    const qint64 origin = free.isEmpty() ? 0 : free.first().start;
+    auto replay = [&](QHash<quint64, QList<Slot>> &slotsById, QHash<quint64, qint64> &finishes) {
+        FreeIndex index = base;
+        qint64 cost = 0;
+        for (quint64 id : std::as_const(rest))
+        {
+            const Item &item = *next.constFind(id);
+            qint64 ready = origin;
+            bool blocked = false;
+            for (quint64 dependency : item.dependencies)
+            {
+                if (dependency == id || !next.contains(dependency))
+                    continue;
+
+                // Not placed yet means a cycle, and an unplaced prerequisite blocks too.
+                const qint64 finish = finishes.value(dependency, -1);
+                if (finish < 0)
+                {
+                    blocked = true;
+                    break;
+                }
+                ready = std::max(ready, finish);
+            }
+
+            const QList<Slot> taken = blocked ? QList<Slot>() : index.take(id, ready, item.duration);
+            const qint64 finish = taken.isEmpty() ? -1 : taken.last().end;
+            if (!taken.isEmpty())
+                slotsById.insert(id, taken);
+            finishes.insert(id, finish);
+            cost += itemCost(item, finish);
+        }
+        return cost;
+    };
+
+    QHash<quint64, QList<Slot>> best;
+    QHash<quint64, qint64> bestFinishes = keptFinishes;
+    qint64 bestCost = replay(best, bestFinishes);
+
+    // Local search: swap neighbours of the order while that lowers the cost.
+    if (budget > 0 && rest.size() > 1)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        bool improved = true;
+        for (int pass = 0; improved && pass < MaxSearchPasses && !timer.hasExpired(budget); ++pass)
+        {
+            improved = false;
+            for (int i = 1; i < rest.size() && !timer.hasExpired(budget); ++i)
+            {
+                const Item &first = *next.constFind(rest[i - 1]);
+                const Item &second = *next.constFind(rest[i]);
+                if (first.dependencies.contains(second.id) || second.dependencies.contains(first.id))
+                    continue;
+
+                const QList<Slot> firstSlots = best.value(first.id);
+                const QList<Slot> secondSlots = best.value(second.id);
+                if (firstSlots.isEmpty() && secondSlots.isEmpty())
+                    continue;
+
+                // Back to back in one piece each, a swap only exchanges their finishes, and
+                // the order already puts the one that costs more per minute first.
+                if (firstSlots.size() == 1 && secondSlots.size() == 1
+                    && firstSlots.first().end == secondSlots.first().start
+                    && weight(second.priority) * first.duration <= weight(first.priority) * second.duration)
+                    continue;
+
+                std::swap(rest[i - 1], rest[i]);
+                QHash<quint64, QList<Slot>> tried;
+                QHash<quint64, qint64> triedFinishes = keptFinishes;
+                const qint64 cost = replay(tried, triedFinishes);
+                if (cost < bestCost)
+                {
+                    best = tried;
+                    bestFinishes = triedFinishes;
+                    bestCost = cost;
+                    improved = true;
+                }
+                else
+                {
+                    std::swap(rest[i - 1], rest[i]);
+                }
+            }
+        }
+    }
+
+    sequence = sequence.mid(0, kept) + rest;
+    placed = keptSlots;
+    placed.insert(best);
+    items = next;
+    total = keptCost + bestCost;
+    replanned = int(rest.size());
+
+    all.clear();
+    for (const QList<Slot> &taken : std::as_const(placed))
+        all.append(taken);
+    std::sort(all.begin(), all.end(), [](const Slot &a, const Slot &b) {
+        return a.start < b.start || (a.start == b.start && a.taskId < b.taskId);
+    });
+    return all;
+}
+
+QList<quint64> SlotPlanner::unplaced() const
+{
+    QList<quint64> ids;
+    for (quint64 id : sequence)
+    {
+        if (!placed.contains(id))
+            ids.append(id);
+    }
+    return ids;
+}
+
+qint64 SlotPlanner::finish(quint64 id) const
+{
+    const QList<Slot> taken = placed.value(id);
+    return taken.isEmpty() ? 0 : taken.last().end;
+}
+
+qint64 SlotPlanner::weight(int priority)
+{
+    return priority <= 0 ? 1 : priority == 1 ? 10 : 100;
+}
+
+QList<SlotPlanner::Window> SlotPlanner::workingHours(const QDateTime &from, int days, QTime dayStart, QTime dayEnd)
+{
+    QList<Window> windows;
+    for (int day = 0; day < days; ++day)
+    {
+        const QDate date = from.date().addDays(day);
+        if (date.dayOfWeek() > 5)
+            continue;
+
+        const QDateTime start = std::max(QDateTime(date, dayStart), from);
+        const QDateTime end(date, dayEnd);
+        if (start < end)
+            windows.append({toMinutes(start), toMinutes(end)});
+    }
+    return windows;
+}
+
+bool SlotPlanner::before(const Item &a, const Item &b)
+{
+    if (a.priority != b.priority)
+        return a.priority > b.priority;
+    if (a.duration != b.duration)
+        return a.duration < b.duration;
+    return a.id < b.id;
+}
+
+int SlotPlanner::keptPrefix(const QHash<quint64, Item> &next) const
+{
+    int kept = int(sequence.size());
+    QHash<quint64, int> position;
+    position.reserve(sequence.size());
+    for (int i = 0; i < sequence.size(); ++i)
+    {
+        position.insert(sequence[i], i);
+        const auto it = next.constFind(sequence[i]);
+        if (it == next.cend() || *it != items.value(sequence[i]))
+            kept = std::min(kept, i);
+    }
+
+    // A new or changed task may now be taken before tasks it used to follow, though not
+    // before its prerequisites.
+    QSet<quint64> changed;
+    for (const Item &item : next)
+    {
+        const auto it = items.constFind(item.id);
+        if (it != items.cend() && *it == item)
+            continue;
+
+        changed.insert(item.id);
+        int taken = 0;
+        for (quint64 dependency : item.dependencies)
+            taken = std::max(taken, position.value(dependency, -1) + 1);
+        while (taken < kept && !before(item, items.value(sequence[taken])))
+            ++taken;
+        kept = std::min(kept, taken);
+    }
+
+    // Tasks that waited for a task that was not there before are placed again too.
+    if (!changed.isEmpty())
+    {
+        for (const Item &item : next)
+        {
+            const int at = position.value(item.id, -1);
+            if (at < 0 || at >= kept)
+                continue;
+            for (quint64 dependency : item.dependencies)
+            {
+                if (changed.contains(dependency))
+                {
+                    kept = at;
+                    break;
+                }
+            }
+        }
+    }
+    return kept;
+}
+
+QList<quint64> SlotPlanner::suffixOrder(const QHash<quint64, Item> &next, int kept) const
+{
+    const QSet<quint64> done(sequence.cbegin(), sequence.cbegin() + kept);
+    QHash<quint64, int> waiting;
+    QHash<quint64, QList<quint64>> dependents;
+    for (const Item &item : next)
+    {
+        if (done.contains(item.id))
+            continue;
+
+        int count = 0;
+        for (quint64 dependency : item.dependencies)
+        {
+            if (dependency != item.id && next.contains(dependency) && !done.contains(dependency))
+            {
+                dependents[dependency].append(item.id);
+                ++count;
+            }
+        }
+        waiting.insert(item.id, count);
+    }
+
+    // Kahn's algorithm, taking the ready task that comes first by priority.
+    auto later = [&next](quint64 a, quint64 b) { return before(*next.constFind(b), *next.constFind(a)); };
+    std::priority_queue<quint64, std::vector<quint64>, decltype(later)> ready(later);
+    for (auto it = waiting.cbegin(); it != waiting.cend(); ++it)
+    {
+        if (it.value() == 0)
+            ready.push(it.key());
+    }
+
+    QList<quint64> order;
+    order.reserve(waiting.size());
+    while (!ready.empty())
+    {
+        const quint64 id = ready.top();
+        ready.pop();
+        order.append(id);
+        for (quint64 dependent : dependents.value(id))
+        {
+            if (--waiting[dependent] == 0)
+                ready.push(dependent);
+        }
+    }
+
+    // Tasks on a cycle are never ready; they are tried last and stay unplaced.
+    if (order.size() < waiting.size())
+    {
+        QList<quint64> cyclic;
+        for (auto it = waiting.cbegin(); it != waiting.cend(); ++it)
+        {
+            if (it.value() > 0)
+                cyclic.append(it.key());
+        }
+        std::sort(cyclic.begin(), cyclic.end());
+        order.append(cyclic);
+    }
+    return order;
+}
+
+qint64 SlotPlanner::itemCost(const Item &item, qint64 finish) const
+{
+    const qint64 origin = free.isEmpty() ? 0 : free.first().start;
+    const qint64 span = free.isEmpty() ? 0 : free.last().end - origin;
+    return weight(item.priority) * (finish < 0 ? 2 * span : finish - origin);
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+
+
+/**
+ * @file SlotPlanner.h
+ * @brief Placement of tasks with estimates and priorities into free calendar time
+ */
+
+/**
+ * @class SlotPlanner
+ * @brief Heuristic scheduler packing tasks into free time windows
+ *
+ * The planner is given the free time of a calendar as windows (see setWindows(), e.g.
+ * the working hours of a week from workingHours()) and a list of tasks, each with a
+ * duration, a priority and the tasks it waits for. plan() places every task into free
+ * time, with times in minutes since the epoch:
+ *
+ * - Tasks are taken greedily in priority order, higher first, then shorter first, then by
+ *   id; a task is only taken once all of its prerequisites are placed.
+ * - A task goes into the earliest free time where it fits in one piece, at or after the
+ *   finish of its prerequisites. Free time is indexed by a segment tree over the windows
+ *   that keeps the longest free piece and the total free time of every range, so this is
+ *   a descent of the tree rather than a walk over the calendar.
+ * - A task that fits nowhere in one piece is split over the earliest free pieces, if
+ *   enough free time is left; otherwise it is unplaced, and so are its dependents.
+ *
+ * A local search then improves the greedy plan: adjacent tasks of the order that do not
+ * depend on each other are swapped when that lowers the cost, the sum of the finishes
+ * weighted by priority (see weight()). It stops after a few passes or when the search
+ * budget is spent, so it only ever makes a plan better.
+ *
+ * Planning is incremental. plan() compares the tasks with those of the previous call;
+ * the tasks of the previous order before the first one that changed, was added or
+ * removed, or would now be taken earlier, keep their places, and only the rest of the
+ * order is planned again. A change to a low priority task thus replans a short tail.
+ *
+ * The planner holds no Qt objects and is cheap to copy, so it can be handed to a worker
+ * thread and the copy with the new plan taken back; see AgendaModel.
+ *
+ * Example usage:
+ * @code
+ * SlotPlanner planner;
+ * planner.setWindows(SlotPlanner::workingHours(QDateTime::currentDateTime(), 7, QTime(9, 0), QTime(17, 0)));
+ * planner.plan({{1, 120, 2, {}}, {2, 60, 1, {1}}});
+ * for (const SlotPlanner::Slot &slot : planner.slots())
+ *     qDebug() << slot.taskId << SlotPlanner::toDateTime(slot.start);
+ * @endcode
+ */
+class SlotPlanner
+{
+public:
+
+    /**
+     * @brief Free time from start up to, but not including, end, in minutes since the epoch
+     */
+    struct Window
+    {
+        qint64 start = 0;   ///< First free minute
+        qint64 end = 0;     ///< First minute after the window
+    };
+
+    /**
+     * @brief A task to place
+     */
+    struct Item
+    {
+        quint64 id = 0;                 ///< Task id
+        qint64 duration = 0;            ///< Minutes of work; items without any are ignored
+        int priority = 0;               ///< Task::Priority, higher first
+        QList<quint64> dependencies;    ///< Tasks to finish first; ids not planned are ignored
+
+        bool operator==(const Item &other) const;
+        bool operator!=(const Item &other) const { return !(*this == other); }
+    };
+
+    /**
+     * @brief Time given to a task; a split task has several
+     */
+    struct Slot
+    {
+        quint64 taskId = 0;     ///< Task placed
+        qint64 start = 0;       ///< First minute
+        qint64 end = 0;         ///< First minute after the slot
+    };
+
+    /**
+     * @brief Default time the local search may take per plan, in milliseconds
+     */
+    static constexpr int DefaultSearchBudget = 20;
+
+    /**
+     * @brief Most passes of the local search over the order
+     */
+    static constexpr int MaxSearchPasses = 4;
+
+    /**
+     * @brief Replaces the free time; the next plan() starts over
+     * @param windows Windows in any order; overlapping ones are merged, empty ones dropped
+     */
+    void setWindows(const QList<Window> &windows);
+
+    /**
+     * @brief Gets the free time, merged and in order
+     */
+    QList<Window> windows() const { return free; }
+
+    /**
+     * @brief Sets the time the local search may take per plan
+     * @param msecs Milliseconds; 0 keeps the greedy plan
+     */
+    void setSearchBudget(int msecs) { budget = msecs; }
+
+    /**
+     * @brief Places tasks into the free time, replanning only what changed since the last call
+     * @param items All tasks to place
+     * @return The slots, see slots()
+     */
+    const QList<Slot> &plan(const QList<Item> &items);
+
+    /**
+     * @brief Drops the plan; the next plan() starts over
+     */
+    void reset();
+
+    /**
+     * @brief Gets the slots of the plan, ordered by start
+     */
+    const QList<Slot> &slots() const { return all; }
+
+    /**
+     * @brief Gets the tasks in the order they were placed
+     */
+    QList<quint64> order() const { return sequence; }
+
+    /**
+     * @brief Gets the tasks that could not be placed, in the order they were tried
+     */
+    QList<quint64> unplaced() const;
+
+    /**
+     * @brief Gets the slots of a task, ordered by start
+     * @return The slots, empty if the task is not placed
+     */
+    QList<Slot> slotsOf(quint64 id) const { return placed.value(id); }
+
+    /**
+     * @brief Gets the end of the last slot of a task
+     * @return Minutes since the epoch, or 0 if the task is not placed
+     */
+    qint64 finish(quint64 id) const;
+
+    /**
+     * @brief Gets the cost of the plan, the weighted finishes of its tasks
+     *
+     * A task finishing m minutes after the first window costs weight() * m; an unplaced
+     * task costs as if it finished twice the length of the calendar later.
+     */
+    qint64 cost() const { return total; }
+
+    /**
+     * @brief Gets the number of tasks the last plan() placed again
+     */
+    int lastPlanSize() const { return replanned; }
+
+    /**
+     * @brief Gets the weight of a priority in the cost: 1, 10 and 100 from Low to High
+     */
+    static qint64 weight(int priority);
+
+    /**
+     * @brief Gets working hours on weekdays
+     * @param from Start of the first window; earlier hours of that day are skipped
+     * @param days Number of calendar days from the day of from
+     * @param dayStart Start of the working hours of a day
+     * @param dayEnd End of the working hours of a day
+     */
+    static QList<Window> workingHours(const QDateTime &from, int days, QTime dayStart, QTime dayEnd);
+
+    /**
+     * @brief Converts a time to minutes since the epoch, rounded down
+     */
+    static qint64 toMinutes(const QDateTime &time) { return time.toSecsSinceEpoch() / 60; }
+
+    /**
+     * @brief Converts minutes since the epoch to a local time
+     */
+    static QDateTime toDateTime(qint64 minutes) { return QDateTime::fromSecsSinceEpoch(minutes * 60); }
+
+private:
+
+    QList<Window> free;                     ///< Free time, merged and in order
+    QHash<quint64, Item> items;             ///< Tasks of the last plan
+    QList<quint64> sequence;                ///< Order the tasks were placed in, unplaced included
+    QHash<quint64, QList<Slot>> placed;     ///< Slots by task
+    QList<Slot> all;                        ///< Slots of all tasks by start
+    qint64 total = 0;                       ///< Cost of the plan
+    int budget = DefaultSearchBudget;       ///< Milliseconds of local search per plan
+    int replanned = 0;                      ///< Tasks placed by the last plan()
+
+    static bool before(const Item &a, const Item &b);
+    int keptPrefix(const QHash<quint64, Item> &next) const;
+    QList<quint64> suffixOrder(const QHash<quint64, Item> &next, int kept) const;
+    qint64 itemCost(const Item &item, qint64 finish) const;
+};
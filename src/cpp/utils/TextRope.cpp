@@ -0,0 +1,334 @@
+#include "TextRope.h"
+
+#include <utility>
+
+struct TextRope::Node
+{
+    QString chunk;             ///< Text stored in this node
+    qsizetype chunkBreaks = 0; ///< Line breaks in chunk
+    qsizetype length = 0;      ///< Units in the whole subtree
+    qsizetype breaks = 0;      ///< Line breaks in the whole subtree
+    quint32 priority = 0;      ///< Heap priority of the treap
+    Node *left = nullptr;
+    Node *right = nullptr;
+};
+
+TextRope::TextRope(const QString &text)
+{
+    root = build(text);
+}
+
+TextRope::TextRope(TextRope &&other) noexcept
+    : root(std::exchange(other.root, nullptr)), seed(other.seed)
+{
+}
+
+TextRope &TextRope::operator=(TextRope &&other) noexcept
+{
+    if (this != &other)
+    {
+        destroy(root);
+        root = std::exchange(other.root, nullptr);
+        seed = other.seed;
+    }
+    return *this;
+}
+
+TextRope::~TextRope()
+{
+    destroy(root);
+}
+
+quint32 TextRope::nextPriority()
+{
+    // xorshift32: cheap and good enough to keep the treap balanced
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+TextRope::Node *TextRope::createNode(const QString &chunk)
+{
+    Node *node = new Node;
+    node->chunk = chunk;
+    node->chunkBreaks = chunk.count(QChar(u'\n'));
+    node->priority = nextPriority();
+    update(node);
+    return node;
+}
+
+TextRope::Node *TextRope::build(const QString &text)
+{
+    Node *result = nullptr;
+    for (qsizetype offset = 0; offset < text.size(); offset += MaxChunkSize)
+        result = merge(result, createNode(text.mid(offset, MaxChunkSize)));
+    return result;
+}
+
+void TextRope::destroy(Node *node)
+{
+    if (!node)
+        return;
+
+    destroy(node->left);
+    destroy(node->right);
+    delete node;
+}
+
+qsizetype TextRope::lengthOf(const Node *node)
+{
+    return node ? node->length : 0;
+}
+
+qsizetype TextRope::breaksOf(const Node *node)
+{
+    return node ? node->breaks : 0;
+}
+
+void TextRope::update(Node *node)
+{
+    node->length = lengthOf(node->left) + node->chunk.size() + lengthOf(node->right);
+    node->breaks = breaksOf(node->left) + node->chunkBreaks + breaksOf(node->right);
+}
+
+TextRope::Node *TextRope::merge(Node *left, Node *right)
+{
+    if (!left)
+        return right;
+    if (!right)
+        return left;
+
+    if (left->priority > right->priority)
+    {
+        left->right = merge(left->right, right);
+        update(left);
+        return left;
+    }
+
+    right->left = merge(left, right->left);
+    update(right);
+    return right;
+}
+
+void TextRope::split(Node *node, qsizetype position, Node *&left, Node *&right)
+{
+    if (!node)
+    {
+        left = right = nullptr;
+        return;
+    }
+
+    const qsizetype leftLength = lengthOf(node->left);
+    if (position <= leftLength)
+    {
+        split(node->left, position, left, node->left);
+        update(node);
+        right = node;
+        return;
+    }
+
+    const qsizetype chunkEnd = leftLength + node->chunk.size();
+    if (position >= chunkEnd)
+    {
+        split(node->right, position - chunkEnd, node->right, right);
+        update(node);
+        left = node;
+        return;
+    }
+
+    // The split point lies inside this node's chunk: cut the chunk in two.
+    const qsizetype cut = position - leftLength;
+    Node *tail = createNode(node->chunk.mid(cut));
+    node->chunk.truncate(cut);
+    node->chunkBreaks -= tail->chunkBreaks;
+
+    Node *rest = node->right;
+    node->right = nullptr;
+    update(node);
+
+    left = node;
+    right = merge(tail, rest);
+}
+
+bool TextRope::replaceInPlace(qsizetype position, qsizetype removed, const QString &text)
+{
+    // Walk down to the chunk containing the range, remembering the path so the
+    // cached subtree sizes can be fixed up afterwards.
+    Node *path[128];
+    int depth = 0;
+    Node *node = root;
+    qsizetype offset = position;
+    while (node && depth < 128)
+    {
+        path[depth++] = node;
+        const qsizetype leftLength = lengthOf(node->left);
+        if (offset < leftLength)
+        {
+            node = node->left;
+            continue;
+        }
+
+        offset -= leftLength;
+        if (offset <= node->chunk.size() && (offset < node->chunk.size() || !node->right))
+            break;
+
+        offset -= node->chunk.size();
+        node = node->right;
+    }
+
+    if (!node || depth >= 128)
+        return false;
+    if (offset + removed > node->chunk.size())
+        return false;
+    if (node->chunk.size() - removed + text.size() > 2 * MaxChunkSize)
+        return false;
+
+    const qsizetype removedBreaks = QStringView(node->chunk).mid(offset, removed).count(QChar(u'\n'));
+    node->chunk.replace(offset, removed, text);
+    node->chunkBreaks += text.count(QChar(u'\n')) - removedBreaks;
+
+    while (depth > 0)
+        update(path[--depth]);
+    return true;
+}
+
+void TextRope::replace(qsizetype position, qsizetype removed, const QString &text)
+{
+    const qsizetype length = size();
+    position = qBound<qsizetype>(0, position, length);
+    removed = qBound<qsizetype>(0, removed, length - position);
+    if (removed == 0 && text.isEmpty())
+        return;
+
+    if (root && replaceInPlace(position, removed, text))
+        return;
+
+    Node *before = nullptr;
+    Node *rest = nullptr;
+    Node *cut = nullptr;
+    Node *after = nullptr;
+    split(root, position, before, rest);
+    split(rest, removed, cut, after);
+    destroy(cut);
+
+    root = merge(merge(before, build(text)), after);
+}
+
+void TextRope::assign(const QString &text)
+{
+    destroy(root);
+    root = build(text);
+}
+
+qsizetype TextRope::size() const
+{
+    return lengthOf(root);
+}
+
+int TextRope::lineCount() const
+{
+    return int(breaksOf(root)) + 1;
+}
+
+void TextRope::appendTo(const Node *node, QString &out, qsizetype from, qsizetype to)
+{
+    // Appends the units in [from, to) of the subtree rooted at node.
+    if (!node || from >= to)
+        return;
+
+    const qsizetype leftLength = lengthOf(node->left);
+    const qsizetype chunkEnd = leftLength + node->chunk.size();
+
+    if (from < leftLength)
+        appendTo(node->left, out, from, qMin(to, leftLength));
+
+    const qsizetype chunkFrom = qMax(from, leftLength);
+    const qsizetype chunkTo = qMin(to, chunkEnd);
+    if (chunkFrom < chunkTo)
+        out += QStringView(node->chunk).mid(chunkFrom - leftLength, chunkTo - chunkFrom);
+
+    if (to > chunkEnd)
+        appendTo(node->right, out, qMax(from, chunkEnd) - chunkEnd, to - chunkEnd);
+}
+
+QString TextRope::toString() const
+{
+    return mid(0, size());
+}
+
+QString TextRope::mid(qsizetype position, qsizetype length) const
+{
+    const qsizetype total = size();
+    position = qBound<qsizetype>(0, position, total);
+    length = qBound<qsizetype>(0, length, total - position);
+
+    QString out;
+    out.reserve(length);
+    appendTo(root, out, position, position + length);
+    return out;
+}
+
+int TextRope::lineAt(qsizetype offset) const
+{
+    offset = qBound<qsizetype>(0, offset, size());
+
+    qsizetype lines = 0;
+    const Node *node = root;
+    while (node)
+    {
+        const qsizetype leftLength = lengthOf(node->left);
+        if (offset <= leftLength)
+        {
+            node = node->left;
+            continue;
+        }
+
+        lines += breaksOf(node->left);
+        offset -= leftLength;
+        if (offset <= node->chunk.size())
+            return int(lines + QStringView(node->chunk).left(offset).count(QChar(u'\n')));
+
+        lines += node->chunkBreaks;
+        offset -= node->chunk.size();
+        node = node->right;
+    }
+    return int(lines);
+}
+
+qsizetype TextRope::lineStart(int line) const
+{
+    if (line == 0)
+        return 0;
+    if (line < 0 || line > breaksOf(root))
+        return -1;
+
+    // Find the line-th line break; the line starts right after it.
+    qsizetype remaining = line;
+    qsizetype offset = 0;
+    const Node *node = root;
+    while (node)
+    {
+        const qsizetype leftBreaks = breaksOf(node->left);
+        if (remaining <= leftBreaks)
+        {
+            node = node->left;
+            continue;
+        }
+
+        remaining -= leftBreaks;
+        offset += lengthOf(node->left);
+        if (remaining <= node->chunkBreaks)
+        {
+            qsizetype index = -1;
+            for (qsizetype i = 0; i < remaining; ++i)
+                index = node->chunk.indexOf(QChar(u'\n'), index + 1);
+            return offset + index + 1;
+        }
+
+        remaining -= node->chunkBreaks;
+        offset += node->chunk.size();
+        node = node->right;
+    }
+    return -1;
+}
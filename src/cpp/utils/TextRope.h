@@ -0,0 +1,131 @@
+#pragma once
+
+#include <QString>
+
+
+/**
+ * @file TextRope.h
+ * @brief Rope data structure for long, incrementally edited texts
+ */
+
+/**
+ * @class TextRope
+ * @brief Stores a text as a balanced tree of chunks for cheap range edits
+ *
+ * TextRope keeps a text in chunks of at most MaxChunkSize UTF-16 units, arranged as an
+ * implicit treap ordered by position. Every node caches the length and the number of
+ * line breaks of its subtree, which makes the following operations O(log n) plus the
+ * size of one chunk:
+ * - replace() of a range (the common single-keystroke edit touches one chunk in place)
+ * - lineAt() and lineStart() for mapping between offsets and lines
+ * - mid() for reading a range
+ *
+ * Converting the whole rope back into a QString with toString() is O(n).
+ *
+ * Example usage:
+ * @code
+ * TextRope rope("first line\nsecond line");
+ * rope.replace(0, 5, "1st");     // "1st line\nsecond line"
+ * int line = rope.lineAt(12);    // 1
+ * qsizetype start = rope.lineStart(1); // 9
+ * @endcode
+ */
+class TextRope
+{
+private:
+
+    struct Node;
+
+    Node *root = nullptr;     ///< Root of the treap, nullptr for an empty rope
+    quint32 seed = 0x9e3779b9; ///< State of the priority generator
+
+    quint32 nextPriority();
+    Node *createNode(const QString &chunk);
+    Node *build(const QString &text);
+
+    static qsizetype lengthOf(const Node *node);
+    static qsizetype breaksOf(const Node *node);
+    static void destroy(Node *node);
+    static void update(Node *node);
+    static Node *merge(Node *left, Node *right);
+    void split(Node *node, qsizetype position, Node *&left, Node *&right);
+    bool replaceInPlace(qsizetype position, qsizetype removed, const QString &text);
+    static void appendTo(const Node *node, QString &out, qsizetype from, qsizetype to);
+
+public:
+
+    /**
+     * @brief Maximum number of UTF-16 units stored in one chunk
+     */
+    static constexpr qsizetype MaxChunkSize = 1024;
+
+    /**
+     * @brief Constructs an empty rope
+     */
+    TextRope() = default;
+
+    /**
+     * @brief Constructs a rope holding the given text
+     */
+    explicit TextRope(const QString &text);
+
+    TextRope(const TextRope &other) = delete;
+    TextRope &operator=(const TextRope &other) = delete;
+    TextRope(TextRope &&other) noexcept;
+    TextRope &operator=(TextRope &&other) noexcept;
+    ~TextRope();
+
+    /**
+     * @brief Returns the length of the text in UTF-16 units
+     */
+    qsizetype size() const;
+
+    /**
+     * @brief Checks whether the text is empty
+     */
+    bool isEmpty() const { return size() == 0; }
+
+    /**
+     * @brief Returns the number of lines (line breaks + 1)
+     */
+    int lineCount() const;
+
+    /**
+     * @brief Returns the whole text as a QString
+     */
+    QString toString() const;
+
+    /**
+     * @brief Returns a range of the text
+     * @param position Offset of the first unit to return
+     * @param length Number of units to return; clamped to the end of the text
+     */
+    QString mid(qsizetype position, qsizetype length) const;
+
+    /**
+     * @brief Replaces a range of the text
+     * @param position Offset of the range to replace; clamped to the text
+     * @param removed Number of units to remove; clamped to the end of the text
+     * @param text The text to insert at position
+     */
+    void replace(qsizetype position, qsizetype removed, const QString &text);
+
+    /**
+     * @brief Replaces the whole text
+     */
+    void assign(const QString &text);
+
+    /**
+     * @brief Returns the zero-based line containing an offset
+     * @param offset Offset into the text; clamped to the text
+     * @return The number of line breaks before the offset
+     */
+    int lineAt(qsizetype offset) const;
+
+    /**
+     * @brief Returns the offset at which a line starts
+     * @param line Zero-based line number
+     * @return The offset of the first unit of the line, or -1 if the line does not exist
+     */
+    qsizetype lineStart(int line) const;
+};
@@ -0,0 +1,556 @@
+#include "TextScanner.h"
+#include "Metrics.h"
+
+#include <QDataStream>
+#include <QThreadPool>
+#include <QtAlgorithms>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTSCANNER_HAVE_SSE2 1
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TEXTSCANNER_HAVE_AVX2 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define TEXTSCANNER_HAVE_NEON 1
+#endif
+
+namespace {
+
+using IndexOfFunction = qsizetype (*)(const char16_t *, qsizetype, const char16_t *, qsizetype);
+
+/**
+ * Verifies a candidate whose first and last units already matched the needle.
+ */
+inline bool matchesAt(const char16_t *candidate, const char16_t *needle, qsizetype needleLength)
+{
+    return std::memcmp(candidate, needle, size_t(needleLength) * sizeof(char16_t)) == 0;
+}
+
+qsizetype indexOfScalar(const char16_t *haystack, qsizetype length,
+                        const char16_t *needle, qsizetype needleLength, qsizetype from)
+{
+    const char16_t first = needle[0];
+    const char16_t last = needle[needleLength - 1];
+    for (qsizetype i = from; i + needleLength <= length; ++i)
+    {
+        if (haystack[i] == first && haystack[i + needleLength - 1] == last
+            && matchesAt(haystack + i, needle, needleLength))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+qsizetype indexOfPortable(const char16_t *haystack, qsizetype length,
+                          const char16_t *needle, qsizetype needleLength)
+{
+    return indexOfScalar(haystack, length, needle, needleLength, 0);
+}
+
+#ifdef TEXTSCANNER_HAVE_SSE2
+qsizetype indexOfSse2(const char16_t *haystack, qsizetype length,
+                      const char16_t *needle, qsizetype needleLength)
+{
+    const __m128i first = _mm_set1_epi16(short(needle[0]));
+    const __m128i last = _mm_set1_epi16(short(needle[needleLength - 1]));
+
+    qsizetype i = 0;
+    for (; i + needleLength - 1 + 8 <= length; i += 8)
+    {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i + needleLength - 1));
+        const __m128i hits = _mm_and_si128(_mm_cmpeq_epi16(blockFirst, first), _mm_cmpeq_epi16(blockLast, last));
+
+        // movemask yields two bits per 16-bit lane; keep one of them.
+        unsigned mask = unsigned(_mm_movemask_epi8(hits)) & 0x5555u;
+        while (mask)
+        {
+            const qsizetype candidate = i + qCountTrailingZeroBits(mask) / 2;
+            if (matchesAt(haystack + candidate, needle, needleLength))
+                return candidate;
+            mask &= mask - 1;
+        }
+    }
+    return indexOfScalar(haystack, length, needle, needleLength, i);
+}
+#endif
+
+#ifdef TEXTSCANNER_HAVE_AVX2
+__attribute__((target("avx2")))
+qsizetype indexOfAvx2(const char16_t *haystack, qsizetype length,
+                      const char16_t *needle, qsizetype needleLength)
+{
+    const __m256i first = _mm256_set1_epi16(short(needle[0]));
+    const __m256i last = _mm256_set1_epi16(short(needle[needleLength - 1]));
+
+    qsizetype i = 0;
+    for (; i + needleLength - 1 + 16 <= length; i += 16)
+    {
+        const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i));
+        const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i + needleLength - 1));
+        const __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi16(blockFirst, first), _mm256_cmpeq_epi16(blockLast, last));
+
+        quint32 mask = quint32(_mm256_movemask_epi8(hits)) & 0x55555555u;
+        while (mask)
+        {
+            const qsizetype candidate = i + qCountTrailingZeroBits(mask) / 2;
+            if (matchesAt(haystack + candidate, needle, needleLength))
+                return candidate;
+            mask &= mask - 1;
+        }
+    }
+    return indexOfScalar(haystack, length, needle, needleLength, i);
+}
+#endif
+
+#ifdef TEXTSCANNER_HAVE_NEON
+qsizetype indexOfNeon(const char16_t *haystack, qsizetype length,
+                      const char16_t *needle, qsizetype needleLength)
+{
+    const uint16x8_t first = vdupq_n_u16(needle[0]);
+    const uint16x8_t last = vdupq_n_u16(needle[needleLength - 1]);
+
+    qsizetype i = 0;
+    for (; i + needleLength - 1 + 8 <= length; i += 8)
+    {
+        const uint16x8_t blockFirst = vld1q_u16(reinterpret_cast<const uint16_t *>(haystack + i));
+        const uint16x8_t blockLast = vld1q_u16(reinterpret_cast<const uint16_t *>(haystack + i + needleLength - 1));
+        const uint16x8_t hits = vandq_u16(vceqq_u16(blockFirst, first), vceqq_u16(blockLast, last));
+        if (vmaxvq_u16(hits) == 0)
+            continue;
+
+        for (qsizetype lane = 0; lane < 8; ++lane)
+        {
+            const qsizetype candidate = i + lane;
+            if (haystack[candidate] == needle[0]
+                && haystack[candidate + needleLength - 1] == needle[needleLength - 1]
+                && matchesAt(haystack + candidate, needle, needleLength))
+            {
+                return candidate;
+            }
+        }
+    }
+    return indexOfScalar(haystack, length, needle, needleLength, i);
+}
+#endif
+
+using ByteIndexOfFunction = qsizetype (*)(const char *, qsizetype, const char *, qsizetype);
+
+qsizetype byteIndexOfScalar(const char *haystack, qsizetype length,
+                            const char *needle, qsizetype needleLength, qsizetype from)
+{
+    const char first = needle[0];
+    const char last = needle[needleLength - 1];
+    for (qsizetype i = from; i + needleLength <= length; ++i)
+    {
+        if (haystack[i] == first && haystack[i + needleLength - 1] == last
+            && std::memcmp(haystack + i, needle, size_t(needleLength)) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+qsizetype byteIndexOfPortable(const char *haystack, qsizetype length,
+                              const char *needle, qsizetype needleLength)
+{
+    // memchr is vectorized by the C library; it skips to each first-byte candidate.
+    const char first = needle[0];
+    const char last = needle[needleLength - 1];
+    qsizetype i = 0;
+    while (i + needleLength <= length)
+    {
+        const void *hit = std::memchr(haystack + i, first, size_t(length - needleLength + 1 - i));
+        if (!hit)
+            return -1;
+        i = static_cast<const char *>(hit) - haystack;
+        if (haystack[i + needleLength - 1] == last && std::memcmp(haystack + i, needle, size_t(needleLength)) == 0)
+            return i;
+        ++i;
+    }
+    return -1;
+}
+
+#ifdef TEXTSCANNER_HAVE_SSE2
+qsizetype byteIndexOfSse2(const char *haystack, qsizetype length,
+                          const char *needle, qsizetype needleLength)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needleLength - 1]);
+
+    qsizetype i = 0;
+    for (; i + needleLength - 1 + 16 <= length; i += 16)
+    {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i + needleLength - 1));
+        const __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last));
+
+        unsigned mask = unsigned(_mm_movemask_epi8(hits));
+        while (mask)
+        {
+            const qsizetype candidate = i + qCountTrailingZeroBits(mask);
+            if (std::memcmp(haystack + candidate, needle, size_t(needleLength)) == 0)
+                return candidate;
+            mask &= mask - 1;
+        }
+    }
+    return byteIndexOfScalar(haystack, length, needle, needleLength, i);
+}
+#endif
+
+#ifdef TEXTSCANNER_HAVE_AVX2
+__attribute__((target("avx2")))
+qsizetype byteIndexOfAvx2(const char *haystack, qsizetype length,
+                          const char *needle, qsizetype needleLength)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needleLength - 1]);
+
+    qsizetype i = 0;
+    for (; i + needleLength - 1 + 32 <= length; i += 32)
+    {
+        const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i));
+        const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i + needleLength - 1));
+        const __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last));
+
+        quint32 mask = quint32(_mm256_movemask_epi8(hits));
+        while (mask)
+        {
+            const qsizetype candidate = i + qCountTrailingZeroBits(mask);
+            if (std::memcmp(haystack + candidate, needle, size_t(needleLength)) == 0)
+                return candidate;
+            mask &= mask - 1;
+        }
+    }
+    return byteIndexOfScalar(haystack, length, needle, needleLength, i);
+}
+#endif
+
+#ifdef TEXTSCANNER_HAVE_NEON
+qsizetype byteIndexOfNeon(const char *haystack, qsizetype length,
+                          const char *needle, qsizetype needleLength)
+{
+    const uint8x16_t first = vdupq_n_u8(uint8_t(needle[0]));
+    const uint8x16_t last = vdupq_n_u8(uint8_t(needle[needleLength - 1]));
+
+    qsizetype i = 0;
+    for (; i + needleLength - 1 + 16 <= length; i += 16)
+    {
+        const uint8x16_t blockFirst = vld1q_u8(reinterpret_cast<const uint8_t *>(haystack + i));
+        const uint8x16_t blockLast = vld1q_u8(reinterpret_cast<const uint8_t *>(haystack + i + needleLength - 1));
+        const uint8x16_t hits = vandq_u8(vceqq_u8(blockFirst, first), vceqq_u8(blockLast, last));
+        if (vmaxvq_u8(hits) == 0)
+            continue;
+
+        for (qsizetype lane = 0; lane < 16; ++lane)
+        {
+            const qsizetype candidate = i + lane;
+            if (haystack[candidate] == needle[0]
+                && haystack[candidate + needleLength - 1] == needle[needleLength - 1]
+                && std::memcmp(haystack + candidate, needle, size_t(needleLength)) == 0)
+            {
+                return candidate;
+            }
+        }
+    }
+    return byteIndexOfScalar(haystack, length, needle, needleLength, i);
+}
+#endif
+
+ByteIndexOfFunction resolveByteIndexOf()
+{
+#ifdef TEXTSCANNER_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        return byteIndexOfAvx2;
+#endif
+#if defined(TEXTSCANNER_HAVE_SSE2)
+    return byteIndexOfSse2;
+#elif defined(TEXTSCANNER_HAVE_NEON)
+    return byteIndexOfNeon;
+#else
+    return byteIndexOfPortable;
+#endif
+}
+
+IndexOfFunction resolveIndexOf()
+{
+#ifdef TEXTSCANNER_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        return indexOfAvx2;
+#endif
+#if defined(TEXTSCANNER_HAVE_SSE2)
+    return indexOfSse2;
+#elif defined(TEXTSCANNER_HAVE_NEON)
+    return indexOfNeon;
+#else
+    return indexOfPortable;
+#endif
+}
+
+} // namespace
+
+qsizetype TextScanner::indexOf(const char16_t *haystack, qsizetype length,
+                               const char16_t *needle, qsizetype needleLength)
+{
+    static const IndexOfFunction implementation = resolveIndexOf();
+
+    if (needleLength <= 0 || needleLength > length)
+        return -1;
+    return implementation(haystack, length, needle, needleLength);
+}
+
+qsizetype TextScanner::indexOf(const char *haystack, qsizetype length,
+                               const char *needle, qsizetype needleLength)
+{
+    static const ByteIndexOfFunction implementation = resolveByteIndexOf();
+
+    if (needleLength <= 0 || needleLength > length)
+        return -1;
+    return implementation(haystack, length, needle, needleLength);
+}
+
+QString TextScanner::foldRow(const QString &title, const QString &description)
+{
+    QString row;
+    row.reserve(title.size() + description.size() + 1);
+    row += title.toCaseFolded();
+    row += QChar(u'\0');
+    row += description.toCaseFolded();
+    return row;
+}
+
+void TextScanner::insert(int row, const QString &title, const QString &description)
+{
+    folded.insert(row, foldRow(title, description));
+    arenaDirty = true;
+}
+
+void TextScanner::update(int row, const QString &title, const QString &description)
+{
+    if (row < 0 || row >= folded.size())
+        return;
+
+    folded[row] = foldRow(title, description);
+    arenaDirty = true;
+}
+
+void TextScanner::invalidate(int row)
+{
+    if (row < 0 || row >= folded.size())
+        return;
+
+    folded[row] = QString();
+    arenaDirty = true;
+}
+
+void TextScanner::remove(int row, int count)
+{
+    if (row < 0 || count <= 0 || row + count > folded.size())
+        return;
+
+    folded.remove(row, count);
+    arenaDirty = true;
+}
+
+void TextScanner::clear()
+{
+    folded.clear();
+    arena.clear();
+    rowStarts.clear();
+    arenaDirty = true;
+}
+
+void TextScanner::release()
+{
+    for (QString &row : folded)
+        row = QString();
+    arena = QList<char16_t>();
+    rowStarts = QList<qsizetype>();
+    arenaDirty = true;
+}
+
+void TextScanner::saveArena(QDataStream &out) const
+{
+    rebuildArena();
+
+    out << quint16(0xfeff) << quint32(folded.size());
+    for (qsizetype start : std::as_const(rowStarts))
+        out << qint64(start);
+    out.writeRawData(reinterpret_cast<const char *>(arena.constData()), int(arena.size() * qsizetype(sizeof(char16_t))));
+}
+
+bool TextScanner::loadArena(QDataStream &in)
+{
+    clear();
+
+    quint16 byteOrder = 0;
+    quint32 rows = 0;
+    in >> byteOrder >> rows;
+    if (in.status() != QDataStream::Ok || byteOrder != 0xfeff)
+        return false;
+
+    QList<qsizetype> starts;
+    starts.reserve(qsizetype(rows) + 1);
+    for (quint32 i = 0; i <= rows && in.status() == QDataStream::Ok; ++i)
+    {
+        qint64 start = 0;
+        in >> start;
+        starts.append(qsizetype(start));
+    }
+    if (in.status() != QDataStream::Ok || starts.constFirst() != 0)
+        return false;
+
+    // Every row ends with its NUL, so the rows must be non-empty and ascending.
+    for (quint32 i = 0; i < rows; ++i)
+    {
+        if (starts[i + 1] <= starts[i])
+            return false;
+    }
+
+    const qsizetype length = starts.constLast();
+    QList<char16_t> units(length);
+    const qint64 bytes = qint64(length) * qint64(sizeof(char16_t));
+    if (in.readRawData(reinterpret_cast<char *>(units.data()), int(bytes)) != bytes)
+        return false;
+
+    folded.reserve(rows);
+    for (quint32 i = 0; i < rows; ++i)
+    {
+        const qsizetype end = starts[i + 1] - 1;
+        if (units[end] != u'\0')
+        {
+            folded.clear();
+            return false;
+        }
+        folded.append(QString(reinterpret_cast<const QChar *>(units.constData() + starts[i]), end - starts[i]));
+    }
+
+    arena = std::move(units);
+    rowStarts = std::move(starts);
+    arenaDirty = false;
+    return true;
+}
+
+qint64 TextScanner::memoryUsage() const
+{
+    qint64 bytes = qint64(folded.capacity()) * qint64(sizeof(QString));
+    for (const QString &row : folded)
+        bytes += qint64(row.capacity()) * qint64(sizeof(char16_t));
+    bytes += qint64(arena.capacity()) * qint64(sizeof(char16_t));
+    bytes += qint64(rowStarts.capacity()) * qint64(sizeof(qsizetype));
+    return bytes;
+}
+
+void TextScanner::rebuildArena() const
+{
+    if (!arenaDirty)
+        return;
+
+    // Folded rows always contain the title/description separator, so a null
+    // string can only be a row invalidated since the last scan.
+    for (int i = 0; i < folded.size(); ++i)
+    {
+        if (!folded[i].isNull())
+            continue;
+
+        QString title;
+        QString description;
+        if (source)
+            source(i, title, description);
+        folded[i] = foldRow(title, description);
+    }
+
+    qsizetype total = 0;
+    for (const QString &row : folded)
+        total += row.size() + 1;
+
+    arena.resize(total);
+    rowStarts.resize(folded.size() + 1);
+
+    char16_t *out = arena.data();
+    qsizetype offset = 0;
+    for (int i = 0; i < folded.size(); ++i)
+    {
+        const QString &row = folded[i];
+        rowStarts[i] = offset;
+        std::memcpy(out + offset, row.constData(), size_t(row.size()) * sizeof(char16_t));
+        offset += row.size();
+        out[offset++] = u'\0';
+    }
+    rowStarts[folded.size()] = offset;
+
+    arenaDirty = false;
+}
+
+QList<int> TextScanner::scanRows(const QString &needle, int firstRow, int endRow) const
+{
+    QList<int> rows;
+    const char16_t *data = arena.constData();
+    const char16_t *pattern = reinterpret_cast<const char16_t *>(needle.constData());
+
+    qsizetype position = rowStarts[firstRow];
+    const qsizetype end = rowStarts[endRow];
+    while (position < end)
+    {
+        qsizetype hit = indexOf(data + position, end - position, pattern, needle.size());
+        if (hit < 0)
+            break;
+        hit += position;
+
+        // The row containing the hit is the last row starting at or before it.
+        const auto next = std::upper_bound(rowStarts.cbegin() + firstRow, rowStarts.cbegin() + endRow + 1, hit);
+        const int row = int(next - rowStarts.cbegin()) - 1;
+        rows.append(row);
+        position = rowStarts[row + 1];
+    }
+    return rows;
+}
+
+QList<int> TextScanner::find(const QString &text) const
+{
+    const QString needle = text.toCaseFolded();
+    if (needle.isEmpty() || needle.contains(QChar(u'\0')) || folded.isEmpty())
+        return {};
+
+    Metrics::registry().hit(Metrics::SearchArena, !arenaDirty);
+    rebuildArena();
+
+    // The chunks run on the global pool, so a pool limited to one thread scans serially.
+    const int threads = QThreadPool::globalInstance()->maxThreadCount();
+    if (arena.size() < ParallelThreshold || threads < 2)
+        return scanRows(needle, 0, folded.size());
+
+    // Split at row boundaries into chunks of roughly equal arena size.
+    QList<QPair<int, int>> chunks;
+    const qsizetype target = arena.size() / threads + 1;
+    int first = 0;
+    while (first < folded.size())
+    {
+        const auto boundary = std::lower_bound(rowStarts.cbegin() + first + 1, rowStarts.cend(), rowStarts[first] + target);
+        const int end = qMin(int(boundary - rowStarts.cbegin()), folded.size());
+        chunks.append({first, end});
+        first = end;
+    }
+
+    const QList<QList<int>> parts = QtConcurrent::blockingMapped<QList<QList<int>>>(
+        chunks, [this, &needle](const QPair<int, int> &chunk) {
+            return scanRows(needle, chunk.first, chunk.second);
+        });
+
+    QList<int> rows;
+    for (const QList<int> &part : parts)
+        rows.append(part);
+    return rows;
+}
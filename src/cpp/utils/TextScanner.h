@@ -0,0 +1,200 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+
+#include <functional>
+
+class QDataStream;
+
+
+/**
+ * @file TextScanner.h
+ * @brief Case-insensitive substring scan engine for task text
+ */
+
+/**
+ * @class TextScanner
+ * @brief Keeps case-folded copies of task text and scans them for substrings
+ *
+ * TextScanner is the search fallback used by TaskModel when no index applies. Instead of
+ * calling QString::contains() with Qt::CaseInsensitive for every task (which folds both
+ * strings on every comparison), it folds each task's title and description once, when
+ * the task changes, and stores the result row by row.
+ *
+ * For a search, the folded rows are packed into one contiguous arena separated by NUL
+ * characters. The arena is then scanned with a first-and-last character filter: the
+ * first and last UTF-16 units of the needle are compared against 8 (SSE2), 16 (AVX2) or
+ * 8 (NEON) positions per instruction and only the surviving candidates are verified.
+ * Because the arena spans many short rows, a single vector compare tests several tasks
+ * at once. Large arenas are split at row boundaries and scanned in parallel chunks on the
+ * global thread pool; when that pool is limited to one thread the scan stays on the caller.
+ *
+ * Rows are addressed by their model row, so the owner must mirror inserts, removals and
+ * updates of its rows into the scanner. Rows that change often (e.g. long descriptions
+ * being typed into) can instead be invalidated; they are re-read through the text
+ * source and folded again only when the next search needs them.
+ *
+ * Example usage:
+ * @code
+ * TextScanner scanner;
+ * scanner.insert(0, "Buy groceries", "Milk, bread, and eggs");
+ * scanner.insert(1, "Code review", "Review pull requests");
+ * QList<int> rows = scanner.find("BREAD"); // {0}
+ * @endcode
+ */
+class TextScanner
+{
+public:
+
+    /**
+     * @brief Callback that provides the current title and description of a row
+     */
+    using TextSource = std::function<void(int row, QString &title, QString &description)>;
+
+private:
+
+    mutable QList<QString> folded;      ///< Case-folded "title\0description" per row; null if stale
+    TextSource source;                  ///< Provider for the text of stale rows
+
+    mutable QList<char16_t> arena;      ///< All folded rows, each terminated by a NUL
+    mutable QList<qsizetype> rowStarts; ///< Offset of each row in the arena, plus the end offset
+    mutable bool arenaDirty = true;     ///< Whether the arena must be rebuilt before the next scan
+
+    /**
+     * @brief Packs the folded rows into the scan arena if it is out of date
+     */
+    void rebuildArena() const;
+
+    /**
+     * @brief Scans a range of rows of the arena
+     * @param needle The case-folded text to search for
+     * @param firstRow The first row to scan
+     * @param endRow One past the last row to scan
+     * @return Rows in [firstRow, endRow) containing the needle, in ascending order
+     */
+    QList<int> scanRows(const QString &needle, int firstRow, int endRow) const;
+
+    /**
+     * @brief Folds a title and description into a single scannable row
+     */
+    static QString foldRow(const QString &title, const QString &description);
+
+public:
+
+    /**
+     * @brief Minimum arena size (in UTF-16 units) before a scan is split across threads
+     */
+    static constexpr qsizetype ParallelThreshold = 1 << 20;
+
+    /**
+     * @brief Inserts a row at the given position
+     * @param row The row the text belongs to; subsequent rows shift down by one
+     * @param title The task title
+     * @param description The task description
+     */
+    void insert(int row, const QString &title, const QString &description);
+
+    /**
+     * @brief Replaces the text of an existing row
+     * @param row The row to update
+     * @param title The new task title
+     * @param description The new task description
+     */
+    void update(int row, const QString &title, const QString &description);
+
+    /**
+     * @brief Marks a row as stale without folding its text yet
+     * @param row The row whose text changed
+     *
+     * The row is re-read through the text source at the next search.
+     */
+    void invalidate(int row);
+
+    /**
+     * @brief Sets the callback used to re-read stale rows
+     */
+    void setTextSource(TextSource textSource) { source = std::move(textSource); }
+
+    /**
+     * @brief Removes rows; subsequent rows shift up
+     * @param row The first row to remove
+     * @param count The number of rows to remove
+     */
+    void remove(int row, int count = 1);
+
+    /**
+     * @brief Removes all rows
+     */
+    void clear();
+
+    /**
+     * @brief Drops all folded rows and the scan arena to give memory back
+     *
+     * Every row becomes stale and is re-read through the text source at the next search.
+     */
+    void release();
+
+    /**
+     * @brief Writes the scan arena to a stream, packing it first if needed
+     *
+     * Lets an owner keep the folded text of rows that do not change between runs, e.g.
+     * next to a stored task list, and restore it with loadArena(). The text is written in
+     * host byte order, so the data is a local cache rather than an exchange format.
+     */
+    void saveArena(QDataStream &out) const;
+
+    /**
+     * @brief Replaces all rows with an arena written by saveArena()
+     * @return false if the data is damaged or from another byte order; the scanner is empty then
+     *
+     * The rows are taken over as they were folded; nothing is folded again.
+     */
+    bool loadArena(QDataStream &in);
+
+    /**
+     * @brief Returns the approximate heap memory held by folded rows and the arena, in bytes
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief Returns the number of rows in the scanner
+     */
+    int size() const { return folded.size(); }
+
+    /**
+     * @brief Finds all rows whose title or description contains the given text
+     * @param text The text to search for, compared case-insensitively
+     * @return Ascending list of matching rows; empty if the text is empty
+     *
+     * A match never spans the title and the description of a row, nor two rows.
+     */
+    QList<int> find(const QString &text) const;
+
+    /**
+     * @brief Finds the first occurrence of a needle in a UTF-16 buffer
+     * @param haystack Pointer to the buffer to search
+     * @param length Number of UTF-16 units in the haystack
+     * @param needle Pointer to the text to search for
+     * @param needleLength Number of UTF-16 units in the needle (must be > 0)
+     * @return Offset of the first match, or -1 if there is none
+     *
+     * Exact (case-sensitive) search using the widest vector unit available at runtime.
+     */
+    static qsizetype indexOf(const char16_t *haystack, qsizetype length,
+                             const char16_t *needle, qsizetype needleLength);
+
+    /**
+     * @brief Finds the first occurrence of a needle in a byte buffer
+     * @param haystack Pointer to the buffer to search, e.g. a memory-mapped file
+     * @param length Number of bytes in the haystack
+     * @param needle Pointer to the bytes to search for
+     * @param needleLength Number of bytes in the needle (must be > 0)
+     * @return Offset of the first match, or -1 if there is none
+     *
+     * Same first-and-last filter as the UTF-16 search, over 16 (SSE2, NEON) or 32 (AVX2)
+     * bytes per instruction.
+     */
+    static qsizetype indexOf(const char *haystack, qsizetype length,
+                             const char *needle, qsizetype needleLength);
+};
@@ -2,11 +2,26 @@
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include <QQuickStyle>
+#include <QQuickWindow>
+#include <QCommandLineParser>
 #include <QIcon>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <QEventLoop>
 
 #include "Task.h"
 #include "TaskModel.h"
 #include "TaskController.h"
+#include "InputRecorder.h"
+#include "InputReplayer.h"
+#include "FolderSync.h"
+#include "TodoScanner.h"
+#include "MailImporter.h"
+#include "JournalShipper.h"
+#include "StandbyReplica.h"
 
 using namespace Qt::StringLiterals;
 
@@ -24,6 +39,26 @@ int main(int argc, char *argv[])
     app.setApplicationVersion("1.0.0");
     app.setOrganizationName("Kinuy-Lab");
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({"record", "Record the window's input to <file> on exit.", "file"});
+    parser.addOption({"replay", "Replay the input recorded in <file> against a generated dataset, then exit.", "file"});
+    parser.addOption({"seed", "Seed of the dataset generated for --replay.", "seed", "1"});
+    parser.addOption({"tasks", "Number of tasks generated for --replay.", "count", "1000"});
+    parser.addOption({"report", "Write the --replay frame report to <file> instead of stdout.", "file"});
+    parser.addOption({"ship", "Stream the task journal to standbys on local socket <name>.", "name"});
+    parser.addOption({"sync-dir", "Keep the tasks in step with a folder of one .md or .ics file per task.", "directory"});
+    parser.addOption({"scan-todos", "Keep a task for each TODO and FIXME comment of the source tree in <directory>.", "directory"});
+    parser.addOption({"import-mail", "Add a task for each email of the mbox file or Maildir folder <path> not imported before.", "path"});
+    parser.addOption({"workspaces", "Also search the task stores in the subdirectories of <directory> from the search field.", "directory"});
+    parser.addOption({"standby", "Follow the primary shipping on local socket <name> and take over when it dies.", "name"});
+    parser.process(app);
+    const bool replay = parser.isSet("replay");
+
+    // Offscreen replays render in software so frame times do not depend on the GPU driver.
+    if (replay && QGuiApplication::platformName() == "offscreen")
+        QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+
     // Set the Qt Quick Controls style BEFORE creating QQmlApplicationEngine
     QQuickStyle::setStyle("Material");  // or "Basic", "Fusion", "Universal"
 
@@ -38,8 +73,110 @@ int main(int argc, char *argv[])
     TaskController taskController;
     engine.rootContext()->setContextProperty("taskController", &taskController);
 
-    // Load sample data for demo
-    taskController.loadSampleData();
+    // Opt-in OpenMetrics endpoint on localhost, e.g. TASKMANAGER_METRICS_PORT=9464; started
+    // first so a standby's replication lag can be scraped while it waits.
+    bool metricsPortSet = false;
+    const int metricsPort = qEnvironmentVariableIntValue("TASKMANAGER_METRICS_PORT", &metricsPortSet);
+    if (metricsPortSet && metricsPort > 0 && metricsPort <= 65535 && taskController.enableMetrics(quint16(metricsPort)))
+        qDebug() << "Metrics served on http://127.0.0.1:" << metricsPort << "/metrics";
+
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+
+    // A standby keeps its own copy of the journal, applies it as it arrives and only shows
+    // a window once the primary is gone; then it carries on as the primary, from its copy.
+    const bool standby = !replay && parser.isSet("standby");
+    if (standby)
+    {
+        dataDir += "/standby";
+        QDir().mkpath(dataDir);
+
+        StandbyReplica replica;
+        replica.setJournalFile(dataDir + "/history.log");
+        QEventLoop following;
+        QObject::connect(&replica, &StandbyReplica::primaryLost, &following, &QEventLoop::quit);
+        replica.follow(parser.value("standby"));
+        qDebug() << "Standing by for" << parser.value("standby");
+        following.exec();
+
+        taskController.taskModel()->addTasks(replica.tasks());
+        qDebug() << "Took over with" << replica.taskCount() << "tasks after" << replica.detectionTime() << "ms";
+    }
+
+    // Persist the tasks and their history across sessions; replays never touch the user's data.
+    // The stored tasks are read in the background while the window shows the rows cached at
+    // the end of the last session.
+    const bool persistent = !replay && QDir().mkpath(dataDir);
+    FolderSync folderSync;
+    TodoScanner todoScanner;
+    MailImporter mailImporter;
+    if (persistent)
+    {
+        const QString cacheFile = dataDir + "/firstpaint.cache";
+        TaskStore *store = taskController.taskStore();
+        FirstPaintCache *firstPaint = taskController.firstPaint();
+        firstPaint->load(cacheFile);
+        taskController.templates()->open(dataDir + "/templates.lib");
+
+        const QString syncDir = parser.value("sync-dir");
+        const QString todoDir = parser.value("scan-todos");
+        const QString mailPath = parser.value("import-mail");
+        const auto loaded = [&taskController, &folderSync, &todoScanner, &mailImporter, firstPaint, standby, syncDir, todoDir, mailPath, dataDir]() {
+            // Opened over the stored tasks, so the log only starts a session if it does not
+            // describe them already.
+            taskController.auditLog()->open(dataDir + "/history.log");
+            // The folder's tasks are merged in once the stored ones are there, so files and
+            // tasks are matched against the complete list.
+            if (!syncDir.isEmpty())
+            {
+                folderSync.attach(taskController.taskModel());
+                folderSync.open(syncDir, dataDir + "/folder-sync.cache");
+            }
+            if (!todoDir.isEmpty())
+            {
+                todoScanner.attach(taskController.taskModel());
+                todoScanner.open(todoDir, dataDir + "/todo-scan.cache");
+            }
+            if (!mailPath.isEmpty())
+            {
+                // Parsed on a worker; the batches are inserted here between events.
+                mailImporter.attach(taskController.taskModel());
+                mailImporter.setHistoryFile(dataDir + "/mail-import.history");
+                QObject::connect(&mailImporter, &MailImporter::imported, &mailImporter, [&mailImporter, mailPath](int added) {
+                    qDebug() << "Imported" << added << "emails from" << mailPath << "skipping" << mailImporter.duplicateCount() << "seen before";
+                });
+                mailImporter.start(mailPath);
+            }
+            if (taskController.totalTasks() == 0 && !standby && syncDir.isEmpty() && todoDir.isEmpty() && mailPath.isEmpty())
+                taskController.loadSampleData();
+            firstPaint->release();
+        };
+        QObject::connect(store, &TaskStore::opened, &taskController, loaded);
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, &taskController, [&taskController, store, firstPaint, cacheFile]() {
+            // Until the tasks are loaded, the cache of the last session is still what was shown.
+            if (!store->isLoading())
+                firstPaint->save(cacheFile, taskController.activeTasks(), taskController.totalTasks(), taskController.completedTasks());
+        });
+        if (!store->open(dataDir + "/tasks", false))
+            loaded();
+    }
+
+    if (parser.isSet("workspaces"))
+    {
+        const int workspaces = taskController.globalSearch()->addWorkspaces(parser.value("workspaces"));
+        qDebug() << "Searching" << workspaces << "workspaces of" << parser.value("workspaces");
+    }
+
+    // Hot standby support: a promoted standby serves its former primary's socket in turn.
+    JournalShipper shipper(taskController.auditLog());
+    const QString shipName = parser.isSet("ship") ? parser.value("ship") : parser.value("standby");
+    if (!replay && !shipName.isEmpty() && shipper.listen(shipName))
+        qDebug() << "Journal shipped on" << shipName;
+
+    // Load sample data for demo, or the seeded dataset the replay was recorded against
+    if (replay)
+        taskController.taskModel()->addTasks(InputReplayer::seededTasks(parser.value("seed").toUInt(), parser.value("tasks").toInt()));
+    else if (!persistent)
+        taskController.loadSampleData();
 
     QObject::connect(
         &engine,
@@ -54,5 +191,53 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    QQuickWindow *window = qobject_cast<QQuickWindow *>(engine.rootObjects().constFirst());
+
+    InputRecorder recorder;
+    if (parser.isSet("record") && window)
+    {
+        recorder.attach(window);
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, &recorder, [&recorder, &parser]() {
+            if (!recorder.recording().save(parser.value("record")))
+                qWarning() << "Could not write the input recording to" << parser.value("record");
+        });
+    }
+
+    InputReplayer replayer(window);
+    if (replay)
+    {
+        QString error;
+        const InputRecording recording = InputRecording::load(parser.value("replay"), &error);
+        if (!error.isEmpty() || !window)
+        {
+            qWarning() << "Cannot replay" << parser.value("replay") << error;
+            return 1;
+        }
+
+        replayer.setRecording(recording);
+        QObject::connect(&replayer, &InputReplayer::finished, &app, [&](const FrameReport &report) {
+            QJsonObject result = report.toJson();
+            result["suite"] = "ui_replay";
+            result["recording"] = parser.value("replay");
+            result["seed"] = parser.value("seed").toInt();
+            result["tasks"] = taskController.totalTasks();
+            const QByteArray json = QJsonDocument(result).toJson();
+
+            bool written = true;
+            if (parser.isSet("report"))
+            {
+                QFile file(parser.value("report"));
+                written = file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(json) == json.size();
+            }
+            else
+            {
+                QTextStream(stdout) << json;
+            }
+            QCoreApplication::exit(written ? 0 : 1);
+        });
+        // Start once the window shows its first frame.
+        QObject::connect(window, &QQuickWindow::frameSwapped, &replayer, &InputReplayer::start, Qt::SingleShotConnection);
+    }
+
     return app.exec();
 }
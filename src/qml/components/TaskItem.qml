@@ -7,7 +7,8 @@ import TaskManager 1.0
 Rectangle {
     id: root
 
-    property Task task: null
+    // Task object or TaskRecord value; anything exposing the task properties works
+    property var task: null
 
     signal toggleCompleted()
     signal deleteRequested()
@@ -102,6 +103,13 @@ Rectangle {
                     font.pixelSize: theme.fontSizeSmall
                     color: theme.textDisabled
                 }
+
+                Label {
+                    text: task && task.assignee ? qsTr("@%1").arg(task.assignee) : ""
+                    visible: text.length > 0
+                    font.pixelSize: theme.fontSizeSmall
+                    color: theme.textSecondary
+                }
             }
         }
 
@@ -14,20 +14,36 @@ Dialog {
     width: 400
     height: 400
 
+    // A pasted list of several lines makes one task per line; it is parsed on the pool and
+    // previewed here before all rows are added in one insertion.
+    readonly property var pasteImport: taskController.pasteImport
+    property bool pasting: false
+
     AppTheme {
         id: theme
     }
 
+    function pasteList() {
+        pasteImport.defaultPriority = priorityComboBox.currentValue
+        pasteImport.pasteClipboard()
+        pasting = true
+    }
+
     onOpened: {
         titleField.text = ""
         descriptionField.text = ""
+        assigneeField.text = ""
         priorityComboBox.currentIndex = 1  // Medium priority default
+        pasting = false
         titleField.forceActiveFocus()
     }
 
+    onClosed: pasteImport.clear()
+
     ColumnLayout {
         anchors.fill: parent
         spacing: theme.spacingMedium
+        visible: !root.pasting
 
         Label {
             text: qsTr("Task Title:")
@@ -52,6 +68,13 @@ Dialog {
                     acceptButton.clicked()
                 }
             }
+
+            Keys.onPressed: (event) => {
+                if (event.matches(StandardKey.Paste) && root.pasteImport.clipboardHasList()) {
+                    root.pasteList()
+                    event.accepted = true
+                }
+            }
         }
 
         Label {
@@ -120,29 +143,140 @@ Dialog {
                 Layout.fillWidth: true
             }
         }
+
+        RowLayout {
+            Layout.fillWidth: true
+
+            Label {
+                text: qsTr("Assignee:")
+                font.pixelSize: theme.fontSizeMedium
+            }
+
+            TextField {
+                id: assigneeField
+                Layout.fillWidth: true
+                placeholderText: qsTr("Unassigned")
+                font.pixelSize: theme.fontSizeMedium
+
+                background: Rectangle {
+                    color: theme.surfaceColor
+                    border.color: assigneeField.activeFocus ? theme.primaryColor : theme.textDisabled
+                    border.width: assigneeField.activeFocus ? 2 : 1
+                    radius: theme.borderRadius
+                }
+            }
+        }
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        spacing: theme.spacing
+        visible: root.pasting
+
+        RowLayout {
+            Layout.fillWidth: true
+
+            Label {
+                text: root.pasteImport.parsing
+                      ? qsTr("Reading the pasted list...")
+                      : qsTr("%1 tasks from the pasted list").arg(root.pasteImport.count)
+                font.pixelSize: theme.fontSizeMedium
+                Layout.fillWidth: true
+            }
+
+            BusyIndicator {
+                running: root.pasteImport.parsing
+                Layout.preferredHeight: 24
+                Layout.preferredWidth: 24
+            }
+        }
+
+        Label {
+            text: qsTr("Markers: ! !! !!! for priority, #tag, @assignee, [x] for done")
+            font.pixelSize: theme.fontSizeSmall
+            color: theme.textSecondary
+        }
+
+        // Only the visible rows get delegates, so a paste of thousands of lines stays cheap.
+        ListView {
+            id: previewList
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            model: root.pasteImport
+            ScrollBar.vertical: ScrollBar {}
+
+            delegate: RowLayout {
+                width: ListView.view.width
+                spacing: theme.spacing
+
+                Rectangle {
+                    Layout.preferredWidth: 8
+                    Layout.preferredHeight: 8
+                    radius: 4
+                    color: model.priority === Task.High ? theme.priorityHigh
+                         : model.priority === Task.Medium ? theme.priorityMedium : theme.priorityLow
+                }
+
+                Label {
+                    text: model.title
+                    font.pixelSize: theme.fontSizeMedium
+                    font.strikeout: model.completed
+                    elide: Text.ElideRight
+                    Layout.fillWidth: true
+                }
+
+                Label {
+                    text: (model.assignee ? "@" + model.assignee + " " : "")
+                          + (model.tags.length > 0 ? "#" + model.tags.join(" #") : "")
+                    font.pixelSize: theme.fontSizeSmall
+                    color: theme.textSecondary
+                    visible: text.length > 0
+                }
+
+                ToolButton {
+                    text: "\u2715"
+                    onClicked: root.pasteImport.removeEntry(index)
+                }
+            }
+        }
     }
 
     footer: DialogButtonBox {
         CustomButton {
             id: acceptButton
-            text: qsTr("Add Task")
+            text: root.pasting ? qsTr("Add %1 Tasks").arg(root.pasteImport.count) : qsTr("Add Task")
             primary: true
-            enabled: titleField.text.trim().length > 0
+            enabled: root.pasting
+                     ? !root.pasteImport.parsing && root.pasteImport.count > 0
+                     : titleField.text.trim().length > 0
             opacity: enabled ? 1.0 : 0.6
 
             DialogButtonBox.buttonRole: DialogButtonBox.AcceptRole
 
             onClicked: {
-                if (taskController.createTask(
+                if (root.pasting) {
+                    if (root.pasteImport.commit() > 0) {
+                        root.close()
+                    }
+                } else if (taskController.createTask(
                     titleField.text.trim(),
                     descriptionField.text.trim(),
-                    priorityComboBox.currentValue
+                    priorityComboBox.currentValue,
+                    assigneeField.text.trim()
                 )) {
                     root.close()
                 }
             }
         }
 
+        CustomButton {
+            text: qsTr("Paste List")
+            visible: !root.pasting
+            DialogButtonBox.buttonRole: DialogButtonBox.ActionRole
+            onClicked: root.pasteList()
+        }
+
         CustomButton {
             text: qsTr("Cancel")
             DialogButtonBox.buttonRole: DialogButtonBox.RejectRole
@@ -0,0 +1,103 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import "../components"
+import "../styles"
+
+Page {
+    id: root
+
+    // Pending tasks placed into the working hours of the week; replanned on the pool as tasks change.
+    readonly property var agenda: taskController.agenda
+
+    AppTheme {
+        id: theme
+    }
+
+    header: ToolBar {
+        RowLayout {
+            anchors.fill: parent
+            anchors.margins: theme.spacing
+            spacing: theme.spacing
+
+            Label {
+                text: qsTr("Week")
+                font.pixelSize: theme.fontSizeXLarge
+                font.bold: true
+            }
+
+            Label {
+                text: root.agenda.unplacedCount > 0
+                      ? qsTr("%1 tasks do not fit this week").arg(root.agenda.unplacedCount)
+                      : ""
+                font.pixelSize: theme.fontSizeMedium
+                color: theme.textSecondary
+                Layout.fillWidth: true
+            }
+
+            BusyIndicator {
+                running: root.agenda.planning
+                Layout.preferredHeight: 24
+                Layout.preferredWidth: 24
+            }
+
+            CustomButton {
+                text: qsTr("Plan my week")
+                onClicked: root.agenda.planWeek()
+            }
+        }
+    }
+
+    ListView {
+        id: slots
+        anchors.fill: parent
+        anchors.margins: theme.spacingMedium
+        clip: true
+        model: root.agenda
+        spacing: theme.spacing / 2
+        ScrollBar.vertical: ScrollBar {}
+
+        section.property: "day"
+        section.delegate: Label {
+            width: ListView.view.width
+            topPadding: theme.spacing
+            text: Qt.formatDate(Date.fromLocaleDateString(Qt.locale(), section, "yyyy-MM-dd"), "dddd d MMMM")
+            font.pixelSize: theme.fontSizeMedium
+            font.bold: true
+        }
+
+        delegate: RowLayout {
+            width: ListView.view.width
+            spacing: theme.spacing
+
+            Label {
+                text: Qt.formatTime(model.start, "hh:mm") + " - " + Qt.formatTime(model.end, "hh:mm")
+                font.pixelSize: theme.fontSizeSmall
+                color: theme.textSecondary
+                Layout.preferredWidth: 100
+            }
+
+            Rectangle {
+                width: 4
+                Layout.fillHeight: true
+                color: model.priority === 2 ? theme.error : model.priority === 1 ? theme.primaryColor : theme.textDisabled
+            }
+
+            Label {
+                text: model.parts > 1 ? qsTr("%1 (%2/%3)").arg(model.title).arg(model.part + 1).arg(model.parts) : model.title
+                elide: Text.ElideRight
+                font.pixelSize: theme.fontSizeMedium
+                color: theme.textPrimary
+                Layout.fillWidth: true
+            }
+        }
+
+        Label {
+            anchors.centerIn: parent
+            visible: slots.count === 0
+            text: root.agenda.planning ? qsTr("Planning...") : qsTr("Plan your week to place the pending tasks with estimates.")
+            font.pixelSize: theme.fontSizeMedium
+            color: theme.textSecondary
+        }
+    }
+}
@@ -0,0 +1,267 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import "../components"
+import "../styles"
+
+Page {
+    id: root
+
+    // Schedule of the live tasks; times are in hours from the start of the project.
+    readonly property var gantt: taskController.gantt
+    property real hourWidth: 12
+    readonly property int rowHeight: 32
+    readonly property int labelWidth: 180
+    // Hours between two ticks of the time axis, so that labels do not overlap.
+    readonly property int tickHours: [1, 2, 4, 8, 24, 48, 168].find(h => h * hourWidth >= 60) || 336
+    readonly property real tickWidth: tickHours * hourWidth
+
+    // The task being planned, kept by id since rows move when tasks come and go.
+    property var selectedId: 0
+    property string selectedTitle: ""
+
+    function select(id, title, estimate) {
+        selectedId = id
+        selectedTitle = title
+        estimateBox.value = estimate
+    }
+
+    AppTheme {
+        id: theme
+    }
+
+    header: ToolBar {
+        RowLayout {
+            anchors.fill: parent
+            anchors.margins: theme.spacing
+            spacing: theme.spacing
+
+            Label {
+                text: qsTr("Plan")
+                font.pixelSize: theme.fontSizeXLarge
+                font.bold: true
+            }
+
+            Label {
+                text: qsTr("Project: %1 h").arg(root.gantt.projectEnd)
+                font.pixelSize: theme.fontSizeMedium
+                color: theme.textSecondary
+                Layout.fillWidth: true
+            }
+
+            Label {
+                text: qsTr("Zoom")
+                font.pixelSize: theme.fontSizeSmall
+            }
+
+            Slider {
+                from: 1
+                to: 48
+                value: root.hourWidth
+                onMoved: root.hourWidth = value
+                Layout.preferredWidth: 120
+            }
+        }
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: theme.spacingMedium
+        spacing: theme.spacing
+
+        // Editing the selected task: its estimate and the tasks it waits for.
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: theme.spacing
+            enabled: root.selectedId !== 0 && root.gantt.count > 0 && root.gantt.rowOfTask(root.selectedId) >= 0
+
+            Label {
+                text: root.selectedId !== 0 ? root.selectedTitle : qsTr("Select a bar to plan its task")
+                elide: Text.ElideRight
+                font.pixelSize: theme.fontSizeMedium
+                Layout.preferredWidth: root.labelWidth
+            }
+
+            Label {
+                text: qsTr("Estimate (h):")
+                font.pixelSize: theme.fontSizeSmall
+            }
+
+            SpinBox {
+                id: estimateBox
+                from: 0
+                to: 10000
+                editable: true
+                onValueModified: root.gantt.setEstimate(root.selectedId, value)
+            }
+
+            Label {
+                text: qsTr("Waits for:")
+                font.pixelSize: theme.fontSizeSmall
+            }
+
+            ComboBox {
+                id: dependencyBox
+                model: root.gantt
+                textRole: "title"
+                valueRole: "taskId"
+                Layout.preferredWidth: 200
+            }
+
+            CustomButton {
+                text: qsTr("Add")
+                enabled: dependencyBox.currentIndex >= 0 && dependencyBox.currentValue !== root.selectedId
+                onClicked: root.gantt.addDependency(root.selectedId, dependencyBox.currentValue)
+            }
+
+            CustomButton {
+                text: qsTr("Remove")
+                onClicked: root.gantt.removeDependency(root.selectedId, dependencyBox.currentValue)
+            }
+
+            Item {
+                Layout.fillWidth: true
+            }
+        }
+
+        // Time axis: only the ticks inside the visible window exist.
+        Item {
+            Layout.fillWidth: true
+            Layout.preferredHeight: theme.fontSizeMedium + theme.spacing
+            clip: true
+
+            Repeater {
+                model: Math.ceil((parent.width - root.labelWidth) / root.tickWidth) + 1
+
+                Label {
+                    readonly property int tick: Math.floor(Math.max(0, chart.contentX) / root.tickWidth) + index
+                    x: root.labelWidth + tick * root.tickWidth - chart.contentX
+                    visible: x >= root.labelWidth
+                    text: root.tickHours % 24 === 0 ? qsTr("d%1").arg(tick * root.tickHours / 24) : qsTr("%1h").arg(tick * root.tickHours)
+                    font.pixelSize: theme.fontSizeSmall
+                    color: theme.textSecondary
+                }
+            }
+        }
+
+        // Rows are virtualized by the ListView; bars and links outside the visible time window are hidden.
+        ListView {
+            id: chart
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            model: root.gantt
+            flickableDirection: Flickable.HorizontalAndVerticalFlick
+            boundsBehavior: Flickable.StopAtBounds
+            contentWidth: root.labelWidth + Math.max(width, (root.gantt.projectEnd + root.tickHours) * root.hourWidth)
+            ScrollBar.horizontal: ScrollBar {}
+            ScrollBar.vertical: ScrollBar {}
+
+            readonly property real windowStart: contentX + root.labelWidth
+            readonly property real windowEnd: contentX + width
+
+            delegate: Item {
+                id: row
+
+                readonly property int rowIndex: index
+
+                width: chart.contentWidth
+                height: root.rowHeight
+
+                Rectangle {
+                    anchors.fill: parent
+                    color: model.taskId === root.selectedId ? theme.primaryLight : "transparent"
+                }
+
+                // Slack: how far the task can slip without delaying the project.
+                Rectangle {
+                    x: root.labelWidth + model.earliestFinish * root.hourWidth
+                    width: model.slack * root.hourWidth
+                    height: 4
+                    anchors.verticalCenter: parent.verticalCenter
+                    visible: model.slack > 0 && x + width >= chart.windowStart && x <= chart.windowEnd
+                    color: theme.textDisabled
+                }
+
+                Rectangle {
+                    id: bar
+                    x: root.labelWidth + model.earliestStart * root.hourWidth
+                    width: Math.max(3, model.estimate * root.hourWidth)
+                    height: root.rowHeight - theme.spacing
+                    anchors.verticalCenter: parent.verticalCenter
+                    visible: x + width >= chart.windowStart && x <= chart.windowEnd
+                    radius: theme.borderRadius
+                    color: model.critical ? theme.error : theme.primaryColor
+                    opacity: model.completed ? 0.5 : 1.0
+
+                    MouseArea {
+                        anchors.fill: parent
+                        onClicked: root.select(model.taskId, model.title, model.estimate)
+                    }
+                }
+
+                // Links from where each prerequisite finishes to where this task starts.
+                Repeater {
+                    model: links
+
+                    Item {
+                        // Depends on the row count, so it follows rows moving up or down.
+                        readonly property int predRow: chart.count >= 0 ? root.gantt.rowOfTask(modelData.taskId) : -1
+                        readonly property real fromX: root.labelWidth + modelData.finish * root.hourWidth
+                        readonly property real fromY: (predRow - row.rowIndex) * root.rowHeight + root.rowHeight / 2
+                        visible: predRow >= 0 && bar.x >= chart.windowStart && fromX <= chart.windowEnd
+
+                        Rectangle {
+                            x: parent.fromX
+                            y: parent.fromY
+                            width: Math.max(1, bar.x - parent.fromX)
+                            height: 1
+                            color: theme.textSecondary
+                        }
+
+                        Rectangle {
+                            x: bar.x
+                            y: Math.min(parent.fromY, root.rowHeight / 2)
+                            width: 1
+                            height: Math.abs(parent.fromY - root.rowHeight / 2)
+                            color: theme.textSecondary
+                        }
+                    }
+                }
+
+                // The title stays at the left edge while the chart scrolls in time.
+                Rectangle {
+                    x: chart.contentX
+                    width: root.labelWidth
+                    height: parent.height
+                    color: theme.surfaceColor
+
+                    Label {
+                        anchors.fill: parent
+                        anchors.rightMargin: theme.spacing
+                        verticalAlignment: Text.AlignVCenter
+                        text: model.title
+                        elide: Text.ElideRight
+                        font.pixelSize: theme.fontSizeMedium
+                        font.bold: model.critical
+                        font.strikeout: model.completed
+                        color: theme.textPrimary
+                    }
+
+                    MouseArea {
+                        anchors.fill: parent
+                        onClicked: root.select(model.taskId, model.title, model.estimate)
+                    }
+                }
+            }
+
+            Label {
+                anchors.centerIn: parent
+                visible: chart.count === 0
+                text: qsTr("No tasks to plan yet.")
+                font.pixelSize: theme.fontSizeMedium
+                color: theme.textSecondary
+            }
+        }
+    }
+}
@@ -8,6 +8,12 @@ import "../styles"
 Page {
     id: root
 
+    // Until the stored tasks are loaded, the page shows the rows and statistics of the last
+    // session as a read-only picture.
+    readonly property var firstPaint: taskController.firstPaint
+    readonly property bool cached: firstPaint.active
+    readonly property var stats: cached ? firstPaint : taskController
+
     AppTheme {
         id: theme
     }
@@ -29,11 +35,68 @@ Page {
                 Layout.fillWidth: true
             }
 
+            // Searches every workspace; results stream in while stored ones answer.
+            TextField {
+                id: searchField
+                placeholderText: qsTr("Search everywhere")
+                Layout.preferredWidth: 240
+                onTextChanged: taskController.globalSearch.search(text)
+                Keys.onEscapePressed: clear()
+
+                Popup {
+                    y: searchField.height
+                    width: Math.max(searchField.width, 360)
+                    height: Math.min(400, searchResults.contentHeight + searchHint.implicitHeight + theme.spacingMedium * 2)
+                    visible: searchField.activeFocus && taskController.globalSearch.query.length > 0
+                    closePolicy: Popup.NoAutoClose
+
+                    ColumnLayout {
+                        anchors.fill: parent
+                        spacing: theme.spacing
+
+                        ListView {
+                            id: searchResults
+                            Layout.fillWidth: true
+                            Layout.fillHeight: true
+                            clip: true
+                            model: taskController.globalSearch
+
+                            delegate: Column {
+                                width: ListView.view.width
+
+                                Label {
+                                    width: parent.width
+                                    text: model.title
+                                    elide: Text.ElideRight
+                                    font.strikeout: model.completed
+                                    color: model.completed ? theme.textDisabled : theme.textPrimary
+                                }
+
+                                Label {
+                                    text: model.workspace
+                                    font.pixelSize: theme.fontSizeSmall
+                                    color: theme.textSecondary
+                                }
+                            }
+                        }
+
+                        Label {
+                            id: searchHint
+                            text: taskController.globalSearch.searching ? qsTr("Searching…")
+                                  : taskController.globalSearch.count === 0 ? qsTr("No matches") : ""
+                            visible: text.length > 0
+                            font.pixelSize: theme.fontSizeSmall
+                            color: theme.textSecondary
+                        }
+                    }
+                }
+            }
+
             Label {
                 text: qsTr("Total: %1 | Completed: %2 | Pending: %3")
-                     .arg(taskController.totalTasks)
-                     .arg(taskController.completedTasks)
-                     .arg(taskController.pendingTasks)
+                     .arg(root.stats.totalTasks)
+                     .arg(root.stats.completedTasks)
+                     .arg(root.stats.pendingTasks)
                 font.pixelSize: theme.fontSizeMedium
                 color: theme.textSecondary
             }
@@ -51,24 +114,49 @@ Page {
 
             CustomButton {
                 text: qsTr("Add Task")
+                enabled: !root.cached
                 onClicked: addTaskDialog.open()
                 primary: true
             }
 
             CustomButton {
                 text: qsTr("Clear Completed")
-                enabled: taskController.completedTasks > 0
+                enabled: !root.cached && taskController.completedTasks > 0
                 onClicked: taskController.clearCompletedTasks()
                 // Optional: Add visual feedback for disabled state
                 opacity: enabled ? 1.0 : 0.6
             }
 
+            CustomButton {
+                text: qsTr("Undo Delete (%1)").arg(taskController.taskModel.trash.count)
+                enabled: taskController.taskModel.trash.count > 0
+                onClicked: taskController.taskModel.trash.restore(0)
+                opacity: enabled ? 1.0 : 0.6
+            }
+
             Item {
                 Layout.fillWidth: true
             }
 
+            // "My tasks": the per-person list is kept up to date by the model's assignee index.
+            ComboBox {
+                id: assigneeFilter
+                enabled: !root.cached
+                model: [qsTr("Everyone")].concat(taskController.taskModel.assignees)
+                readonly property var tasks: currentIndex > 0 ? taskController.taskModel.assigneeTasks(currentText) : null
+                onTasksChanged: if (!root.cached) listView.model = tasks ? tasks : taskController.activeTasks
+            }
+
+            Label {
+                visible: assigneeFilter.tasks !== null
+                text: assigneeFilter.tasks ? qsTr("%1 open, %2 done").arg(assigneeFilter.tasks.openCount).arg(assigneeFilter.tasks.completedCount) : ""
+                font.pixelSize: theme.fontSizeSmall
+                color: theme.textSecondary
+            }
+
             CustomButton {
                 text: qsTr("Load Sample Data")
+                enabled: !root.cached
                 onClicked: taskController.loadSampleData()
             }
         }
@@ -79,19 +167,75 @@ Page {
 
             ListView {
                 id: listView
-                model: taskController.taskModel
                 spacing: theme.spacing
 
+                // Places the top of row at offset pixels above the top of the view.
+                function positionAt(row, offset) {
+                    if (row < 0 || row >= count)
+                        return
+                    forceLayout()
+                    positionViewAtIndex(row, ListView.Beginning)
+                    const item = itemAtIndex(row)
+                    if (item)
+                        contentY = Math.max(originY, Math.min(item.y + offset, originY + contentHeight - height))
+                }
+
+                // Tells the first-paint cache which rows to save for the next launch.
+                function reportViewport() {
+                    let row = -1
+                    for (let y = contentY; row < 0 && y < contentY + height; y += theme.spacing)
+                        row = indexAt(0, y)
+                    const item = row >= 0 ? itemAtIndex(row) : null
+                    if (!item)
+                        return
+                    let last = indexAt(0, contentY + height - 1)
+                    if (last < 0)
+                        last = Math.min(count - 1, row + Math.ceil(height / Math.max(1, item.height)))
+                    root.firstPaint.setViewport(row, contentY - item.y, last - row + 1)
+                }
+
+                Component.onCompleted: {
+                    if (root.cached) {
+                        model = root.firstPaint.model
+                        positionAt(root.firstPaint.cachedRow, root.firstPaint.rowOffset)
+                    } else {
+                        // Deleted tasks stay in the model until compacted; the proxy hides them.
+                        model = taskController.activeTasks
+                    }
+                }
+
+                // Swap in the live rows at the cached position, within the same frame.
+                Connections {
+                    target: root.firstPaint
+                    function onActiveChanged() {
+                        if (root.cached)
+                            return
+                        listView.model = assigneeFilter.tasks ? assigneeFilter.tasks : taskController.activeTasks
+                        listView.positionAt(root.firstPaint.firstRow, root.firstPaint.rowOffset)
+                    }
+                }
+
+                Timer {
+                    id: viewportTimer
+                    interval: 250
+                    onTriggered: listView.reportViewport()
+                }
+                onContentYChanged: if (!root.cached) viewportTimer.restart()
+                onHeightChanged: if (!root.cached) viewportTimer.restart()
+                onCountChanged: if (!root.cached) viewportTimer.restart()
+
                 delegate: TaskItem {
                     width: listView.width
-                    task: model.taskObject
+                    task: model.record
+                    enabled: !root.cached
 
+                    // Both the live task list and the per-person lists map their rows back.
                     onToggleCompleted: {
-                        taskController.toggleTask(index)
+                        taskController.toggleTask(listView.model.sourceRow(index))
                     }
 
                     onDeleteRequested: {
-                        taskController.deleteTask(index)
+                        taskController.deleteTask(listView.model.sourceRow(index))
                     }
                 }
 
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include <memory>
+
+#include "PerfCounters.h"
+
+
+/**
+ * @file BenchmarkHarness.h
+ * @brief Minimal timing harness shared by the TaskManager benchmarks
+ */
+
+/**
+ * @class BenchmarkHarness
+ * @brief Times named benchmark regions and reports them as JSON
+ *
+ * Each call to run() measures one region with a monotonic clock and records the total
+ * wall time together with the number of operations performed inside the region, so
+ * results can be compared per operation across dataset sizes.
+ *
+ * With enableCounters(), hardware counters (see PerfCounters) are read around each
+ * region as well and reported under "counters" in the region's result. They count the
+ * calling thread only, so while they are enabled the global thread pool is limited to one
+ * thread: QtConcurrent work such as the parallel search scan then runs on the calling
+ * thread and is counted, so its wall times are not comparable to runs without counters.
+ * Where counters are unavailable the report says why and contains wall times only.
+ *
+ * Example usage:
+ * @code
+ * BenchmarkHarness harness("task_model");
+ * harness.run("bulk_insert", 100000, [&] { ... });
+ * harness.write(QString()); // print to stdout
+ * @endcode
+ */
+class BenchmarkHarness
+{
+private:
+
+    QString suite;        ///< Name of the benchmark suite
+    QJsonArray results;   ///< One object per measured region
+    std::unique_ptr<PerfCounters> counters; ///< Hardware counters, if enabled
+
+public:
+
+    /**
+     * @brief Constructs a harness for the named suite
+     */
+    explicit BenchmarkHarness(const QString &suite) : suite(suite) {}
+
+    /**
+     * @brief Reads hardware counters around every following region
+     * @return true if at least one counter is available
+     *
+     * Counters follow the calling thread; call from the thread that runs the regions.
+     * If counters are available, the global thread pool is limited to one thread so that
+     * regions keep their work on that thread.
+     */
+    bool enableCounters()
+    {
+        if (!counters)
+            counters = std::make_unique<PerfCounters>();
+        if (counters->isAvailable())
+            QThreadPool::globalInstance()->setMaxThreadCount(1);
+        return counters->isAvailable();
+    }
+
+    /**
+     * @brief Measures a benchmark region
+     * @param name Name of the region as it appears in the report
+     * @param operations Number of operations performed by the region
+     * @param region Callable executing the measured work
+     */
+    template <typename Region>
+    void run(const QString &name, qint64 operations, Region &&region)
+    {
+        const bool counting = counters && counters->isAvailable();
+        if (counting)
+            counters->start();
+
+        QElapsedTimer timer;
+        timer.start();
+        region();
+        const qint64 elapsed = timer.nsecsElapsed();
+        const QJsonObject counts = counting ? counters->stop(operations) : QJsonObject();
+
+        QJsonObject result;
+        result["name"] = name;
+        result["operations"] = operations;
+        result["totalNs"] = elapsed;
+        result["nsPerOperation"] = operations > 0 ? double(elapsed) / double(operations) : 0.0;
+        if (!counts.isEmpty())
+            result["counters"] = counts;
+        results.append(result);
+    }
+
+    /**
+     * @brief Writes the collected results as a JSON document
+     * @param path Output file, or an empty string for stdout
+     * @return true if the report was written
+     */
+    bool write(const QString &path) const
+    {
+        QJsonObject report;
+        report["suite"] = suite;
+        report["results"] = results;
+        if (counters)
+        {
+            QJsonObject info;
+            info["available"] = counters->isAvailable();
+            if (counters->isAvailable())
+            {
+                info["events"] = QJsonArray::fromStringList(counters->names());
+                info["scope"] = QStringLiteral("calling thread");
+                info["globalPoolThreads"] = QThreadPool::globalInstance()->maxThreadCount();
+            }
+            else
+            {
+                info["reason"] = counters->reason();
+            }
+            report["counters"] = info;
+        }
+        const QByteArray json = QJsonDocument(report).toJson();
+
+        if (path.isEmpty())
+        {
+            QTextStream(stdout) << json;
+            return true;
+        }
+
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+        return file.write(json) == json.size();
+    }
+};
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+#if defined(Q_OS_LINUX)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+
+/**
+ * @file PerfCounters.h
+ * @brief Hardware performance counters for benchmark regions
+ */
+
+/**
+ * @class PerfCounters
+ * @brief Reads CPU counters around a benchmark region with Linux perf_event_open
+ *
+ * Opens one counter per event for the calling thread only. Work a region hands to other
+ * threads, such as QtConcurrent calls on the global thread pool, is not in the values:
+ * inherited counters would only add a worker's counts once the worker thread exits, and
+ * pool threads outlive the region, so they would be missed or land in a later region.
+ * BenchmarkHarness therefore limits the global pool to one thread while counters are
+ * enabled, which keeps QtConcurrent work such as the parallel search scan on the calling
+ * thread. Work on other pools (IoQueue's workers) still reports the calling thread's
+ * share only; compare wall times there.
+ *
+ * Each counter is opened separately: events the CPU or the virtual machine does not
+ * support are left out instead of disabling all of them. When the kernel multiplexes
+ * counters, values are scaled by the fraction of time they were running.
+ *
+ * Without perf_event_open (other systems, a restrictive perf_event_paranoid setting or a
+ * container without the syscall), isAvailable() is false, reason() tells why, and
+ * stop() returns an empty object.
+ */
+class PerfCounters
+{
+private:
+
+    struct Counter
+    {
+        QString name;          ///< Name in the report
+        int fd = -1;           ///< perf event file descriptor
+        quint64 enabled = 0;   ///< Time enabled before the region
+        quint64 running = 0;   ///< Time running before the region
+    };
+
+    QList<Counter> counters;  ///< Counters that could be opened
+    QString failure;          ///< Why no counter could be opened
+
+#if defined(Q_OS_LINUX)
+    // Layout of a read() with PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING
+    struct Reading
+    {
+        quint64 value = 0;
+        quint64 enabled = 0;
+        quint64 running = 0;
+    };
+
+    static bool readCounter(int fd, Reading &reading)
+    {
+        return read(fd, &reading, sizeof(reading)) == qint64(sizeof(reading));
+    }
+
+    static int openCounter(quint32 type, quint64 config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    }
+
+    static constexpr quint64 cacheEvent(quint64 cache, quint64 op, quint64 result)
+    {
+        return cache | (op << 8) | (result << 16);
+    }
+#endif
+
+public:
+
+    /**
+     * @brief Opens the counters; check isAvailable() for the outcome
+     */
+    PerfCounters()
+    {
+#if defined(Q_OS_LINUX)
+        const struct
+        {
+            const char *name;
+            quint32 type;
+            quint64 config;
+        } events[] = {
+            {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {"l1dMisses", PERF_TYPE_HW_CACHE,
+             cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+            {"llcMisses", PERF_TYPE_HW_CACHE,
+             cacheEvent(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+            {"branchMisses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+
+        for (const auto &event : events)
+        {
+            const int fd = openCounter(event.type, event.config);
+            if (fd >= 0)
+                counters.append({QString::fromLatin1(event.name), fd});
+            else if (failure.isEmpty())
+                failure = QString::fromLocal8Bit(std::strerror(errno));
+        }
+        if (!counters.isEmpty())
+            failure.clear();
+        else if (failure.isEmpty())
+            failure = QStringLiteral("no counters");
+#else
+        failure = QStringLiteral("perf_event_open is only available on Linux");
+#endif
+    }
+
+    ~PerfCounters()
+    {
+#if defined(Q_OS_LINUX)
+        for (const Counter &counter : std::as_const(counters))
+            close(counter.fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /**
+     * @brief Whether at least one counter could be opened
+     */
+    bool isAvailable() const { return !counters.isEmpty(); }
+
+    /**
+     * @brief Gets why no counter is available, empty if some are
+     */
+    QString reason() const { return failure; }
+
+    /**
+     * @brief Gets the names of the available counters
+     */
+    QStringList names() const
+    {
+        QStringList result;
+        for (const Counter &counter : counters)
+            result.append(counter.name);
+        return result;
+    }
+
+    /**
+     * @brief Resets and starts all counters
+     */
+    void start()
+    {
+#if defined(Q_OS_LINUX)
+        // Reset clears the values only; the times keep running, so remember them.
+        for (Counter &counter : counters)
+        {
+            Reading reading;
+            if (readCounter(counter.fd, reading))
+            {
+                counter.enabled = reading.enabled;
+                counter.running = reading.running;
+            }
+            ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+        }
+        for (const Counter &counter : std::as_const(counters))
+            ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    /**
+     * @brief Stops all counters and reports their values
+     * @param operations Number of operations of the region, for per-operation values
+     * @return Object with one value per counter and a "perOperation" object; empty if
+     *         no counter is available
+     */
+    QJsonObject stop(qint64 operations)
+    {
+        QJsonObject totals;
+#if defined(Q_OS_LINUX)
+        for (const Counter &counter : std::as_const(counters))
+            ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+
+        QJsonObject perOperation;
+        for (const Counter &counter : std::as_const(counters))
+        {
+            Reading reading;
+            if (!readCounter(counter.fd, reading))
+                continue;
+
+            const quint64 enabled = reading.enabled - counter.enabled;
+            const quint64 running = reading.running - counter.running;
+            if (running == 0)
+                continue; // never scheduled in this region
+
+            const double value = running < enabled ? double(reading.value) * double(enabled) / double(running)
+                                                   : double(reading.value);
+            totals[counter.name] = qint64(value);
+            if (operations > 0)
+                perOperation[counter.name] = value / double(operations);
+        }
+
+        if (totals.contains("cycles") && totals.contains("instructions") && totals["cycles"].toDouble() > 0)
+            totals["ipc"] = totals["instructions"].toDouble() / totals["cycles"].toDouble();
+        if (!perOperation.isEmpty())
+            totals["perOperation"] = perOperation;
+#else
+        Q_UNUSED(operations)
+#endif
+        return totals;
+    }
+};
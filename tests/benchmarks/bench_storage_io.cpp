@@ -0,0 +1,99 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTemporaryDir>
+#include "BenchmarkHarness.h"
+#include "storage/IoQueue.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * Runs the storage regions on one backend: page files written with a linked sync each,
+ * the same files read back, and journal records appended in synced groups.
+ */
+static bool runBackend(BenchmarkHarness &harness, IoQueue::Backend backend, const QString &directory, int pageCount,
+                       int recordCount, int groupSize)
+{
+    IoQueue io(backend);
+    const QString prefix = backend == IoQueue::IoUring ? "io_uring/" : "thread_pool/";
+    const QByteArray page(16 * 1024, 'p');
+    bool ok = true;
+
+    std::vector<std::unique_ptr<QFile>> files;
+    for (int i = 0; i < pageCount; ++i)
+    {
+        files.push_back(std::make_unique<QFile>(QString("%1/%2%3.page").arg(directory, prefix.chopped(1)).arg(i)));
+        if (!files.back()->open(QIODevice::ReadWrite | QIODevice::Truncate))
+            return false;
+    }
+
+    QList<IoRequest> writes;
+    for (const auto &file : files)
+    {
+        writes.append(IoRequest::write(file->handle(), 0, page, true));
+        writes.append(IoRequest::sync(file->handle()));
+    }
+    harness.run(prefix + "page_writes", pageCount, [&] { ok = io.run(writes) && ok; });
+
+    QList<IoRequest> reads;
+    for (const auto &file : files)
+        reads.append(IoRequest::read(file->handle(), 0, page.size()));
+    harness.run(prefix + "page_reads", pageCount, [&] { ok = io.run(reads) && ok; });
+
+    QFile journal(QString("%1/%2.journal").arg(directory, prefix.chopped(1)));
+    if (!journal.open(QIODevice::ReadWrite | QIODevice::Truncate))
+        return false;
+    QList<QByteArray> group;
+    for (int i = 0; i < groupSize; ++i)
+        group.append(QByteArray(96, 'j').append('\n'));
+    harness.run(prefix + "journal_group_commit", recordCount, [&] {
+        qint64 offset = 0;
+        for (int written = 0; written < recordCount; written += groupSize)
+        {
+            const qint64 bytes = io.append(journal.handle(), offset, group);
+            ok = bytes >= 0 && ok;
+            offset += qMax<qint64>(bytes, 0);
+        }
+    });
+
+    for (const auto &file : files)
+        file->remove();
+    journal.remove();
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({{"p", "pages"}, "Number of 16 KiB page files per batch.", "count", "256"});
+    parser.addOption({{"r", "records"}, "Number of journal records appended.", "count", "16384"});
+    parser.addOption({{"g", "group"}, "Journal records per group commit.", "count", "64"});
+    parser.addOption({{"d", "dir"}, "Directory to write in; a temporary one by default. Use a disk-backed file system, syncs on tmpfs are free.", "path"});
+    parser.addOption({{"o", "output"}, "Write the JSON report to <file> instead of stdout.", "file"});
+    parser.addOption({{"c", "counters"}, "Read hardware performance counters around each benchmark (Linux)."});
+    parser.process(app);
+
+    QTemporaryDir temporary;
+    const QString directory = parser.isSet("dir") ? parser.value("dir") : temporary.path();
+    const int pageCount = parser.value("pages").toInt();
+    const int recordCount = parser.value("records").toInt();
+    const int groupSize = qMax(1, parser.value("group").toInt());
+
+    BenchmarkHarness harness("storage_io");
+    if (parser.isSet("counters") && !harness.enableCounters())
+        qWarning("Hardware counters unavailable; reporting wall times only");
+
+    bool ok = runBackend(harness, IoQueue::ThreadPool, directory, pageCount, recordCount, groupSize);
+    if (IoQueue::isIoUringAvailable())
+        ok = runBackend(harness, IoQueue::IoUring, directory, pageCount, recordCount, groupSize) && ok;
+    else
+        qWarning() << "io_uring unavailable, reporting the thread pool only:" << IoQueue(IoQueue::IoUring).fallbackReason();
+
+    if (!ok)
+        qWarning("Some storage requests failed; see the data directory's file system");
+    return harness.write(parser.value("output")) && ok ? 0 : 1;
+}
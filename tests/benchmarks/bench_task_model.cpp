@@ -0,0 +1,80 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QSignalSpy>
+#include "BenchmarkHarness.h"
+#include "models/TaskModel.h"
+
+/**
+ * Fills a model with generated tasks.
+ */
+static void populate(TaskModel *model, int taskCount)
+{
+    for (int i = 0; i < taskCount; ++i)
+        model->addTask(QString("Task %1").arg(i), QString("Generated description for task %1").arg(i));
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({{"n", "tasks"}, "Number of tasks per benchmark.", "count", "100000"});
+    parser.addOption({{"o", "output"}, "Write the JSON report to <file> instead of stdout.", "file"});
+    parser.addOption({{"c", "counters"}, "Read hardware performance counters around each benchmark (Linux)."});
+    parser.process(app);
+
+    const int taskCount = parser.value("tasks").toInt();
+    BenchmarkHarness harness("task_model");
+    if (parser.isSet("counters") && !harness.enableCounters())
+        qWarning("Hardware counters unavailable; reporting wall times only");
+
+    {
+        TaskModel model;
+        harness.run("bulk_insert", taskCount, [&] { populate(&model, taskCount); });
+        harness.run("statistics_scan", taskCount, [&] {
+            int completed = 0;
+            for (int row = 0; row < model.count(); ++row)
+                completed += model.data(model.index(row), TaskModel::CompletedRole).toBool() ? 1 : 0;
+            return completed;
+        });
+        harness.run("search_unindexed", taskCount, [&] { model.findTasks("description for task 4"); });
+    }
+
+    // Baseline for the shutdown regions: the same tasks as QObject children of an owner,
+    // each wired to it with one connection per property, freed by child destruction
+    {
+        QObject owner;
+        auto *parent = new QObject;
+        int changes = 0;
+        for (int i = 0; i < taskCount; ++i)
+        {
+            auto *task = new Task(QString("Task %1").arg(i), QString("Generated description for task %1").arg(i), parent);
+            QObject::connect(task, &Task::titleChanged, &owner, [&changes] { ++changes; });
+            QObject::connect(task, &Task::descriptionEdited, &owner, [&changes] { ++changes; });
+            QObject::connect(task, &Task::completedChanged, &owner, [&changes] { ++changes; });
+            QObject::connect(task, &Task::priorityChanged, &owner, [&changes] { ++changes; });
+            QObject::connect(task, &Task::assigneeChanged, &owner, [&changes] { ++changes; });
+            QObject::connect(task, &Task::estimateChanged, &owner, [&changes] { ++changes; });
+            QObject::connect(task, &Task::dependenciesChanged, &owner, [&changes] { ++changes; });
+        }
+        harness.run("shutdown_baseline", taskCount, [&] { delete parent; });
+    }
+
+    // Shutdown: destroying the model with no views attached
+    {
+        auto *model = new TaskModel;
+        populate(model, taskCount);
+        harness.run("shutdown_destroy", taskCount, [&] { delete model; });
+    }
+
+    // Workspace close: clearing a model that still has a listener attached
+    {
+        TaskModel model;
+        populate(&model, taskCount);
+        QSignalSpy resetSpy(&model, &TaskModel::modelAboutToBeReset);
+        harness.run("shutdown_clear", taskCount, [&] { model.clear(); });
+    }
+
+    return harness.write(parser.value("output")) ? 0 : 1;
+}
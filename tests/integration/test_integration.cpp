@@ -41,6 +41,8 @@ void TestIntegration::init()
 {
     engine = new QQmlApplicationEngine(this);
     taskController = new TaskController(this);
+    // The workflow reads rows by index right after deleting
+    taskController->taskModel()->setCompactionDeferred(false);
     engine->rootContext()->setContextProperty("taskController", taskController);
 }
 
@@ -92,11 +94,11 @@ void TestIntegration::testFullApplicationWorkflow()
     QCOMPARE(taskController->completedTasks(), 0);
 
     // 5. Verify remaining task
-    Task *remainingTask = taskController->taskModel()->getTask(0);
-    QVERIFY(remainingTask != nullptr);
-    QCOMPARE(remainingTask->getTitle(), "Integration Test Task 3");
-    QCOMPARE(remainingTask->getPriority(), Task::Low);
-    QVERIFY(!remainingTask->getCompleted());
+    TaskRecord remainingTask = taskController->taskModel()->getTask(0);
+    QVERIFY(!remainingTask.isNull());
+    QCOMPARE(remainingTask.getTitle(), "Integration Test Task 3");
+    QCOMPARE(remainingTask.getPriority(), Task::Low);
+    QVERIFY(!remainingTask.getCompleted());
 }
 
 QTEST_MAIN(TestIntegration)
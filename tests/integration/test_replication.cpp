@@ -0,0 +1,228 @@
+#include <QTest>
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QProcess>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include "history/AuditLog.h"
+#include "history/JournalShipper.h"
+#include "history/StandbyReplica.h"
+#include "metrics/Metrics.h"
+#include "models/TaskModel.h"
+
+#include <cstdio>
+
+namespace
+{
+
+constexpr int PrimaryTasks = 2000;
+
+QString socketName(const QString &test)
+{
+    return QString("test-replication-%1-%2").arg(QCoreApplication::applicationPid()).arg(test);
+}
+
+/**
+ * Child process acting as the primary: ships the journal of a model that keeps changing
+ * until the process is killed.
+ */
+int runPrimary(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+    JournalShipper shipper(&audit);
+    if (!shipper.listen(QString::fromLocal8Bit(argv[2])))
+        return 1;
+
+    QList<TaskRecord> records;
+    for (int i = 0; i < PrimaryTasks; ++i)
+        records.append(TaskRecord(QString("Task %1").arg(i), QString("Description %1").arg(i), i % 3));
+    model.addTasks(records);
+
+    int next = 0;
+    QTimer changes;
+    QObject::connect(&changes, &QTimer::timeout, &model, [&model, &next]() {
+        model.toggleCompleted(next++ % PrimaryTasks);
+    });
+    changes.start(5);
+
+    fputs("ready\n", stdout);
+    fflush(stdout);
+    return app.exec();
+}
+
+}
+
+class TestReplication : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QList<TaskRecord> liveTasks(const TaskModel &model);
+
+private slots:
+    // Shipping tests
+    void testFollowLiveModel();
+    void testReset();
+
+    // Takeover tests
+    void testSilentPrimary();
+    void testTakeoverFromDeadPrimary();
+};
+
+QList<TaskRecord> TestReplication::liveTasks(const TaskModel &model)
+{
+    QList<TaskRecord> tasks;
+    for (int i = 0; i < model.rowCount(); ++i)
+    {
+        if (!model.isDeleted(i))
+            tasks.append(model.getTask(i));
+    }
+    return tasks;
+}
+
+void TestReplication::testFollowLiveModel()
+{
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+    model.addTask("Before the standby", "Shipped with the initial log");
+
+    JournalShipper shipper(&audit);
+    QVERIFY(shipper.listen(socketName("follow")));
+
+    QTemporaryDir dir;
+    StandbyReplica replica;
+    QVERIFY(replica.setJournalFile(dir.filePath("history.log")));
+    replica.follow(socketName("follow"));
+    QTRY_COMPARE(replica.state(), StandbyReplica::Following);
+    QTRY_COMPARE(shipper.standbyCount(), 1);
+    QTRY_COMPARE(replica.taskCount(), 1);
+
+    // Every kind of change is applied as it arrives
+    const quint64 entriesBefore = Metrics::registry().replicationEntries.value();
+    model.addTask("Second");
+    model.addTask("Third", "To be edited");
+    model.toggleCompleted(0);
+    model.setData(model.index(1), "Renamed", TaskModel::TitleRole);
+    model.editDescription(2, 0, 2, "Now");
+    model.removeTask(1);
+
+    QTRY_COMPARE(replica.tasks(), liveTasks(model));
+    QTRY_COMPARE(replica.lagBytes(), qint64(0));
+    QCOMPARE(replica.journal(), audit.data());
+    QVERIFY(Metrics::registry().replicationEntries.value() > entriesBefore);
+    QVERIFY(Metrics::registry().replicationLag.count() > 0);
+    QVERIFY(Metrics::registry().render().contains("taskmanager_replication_applied_entries_total"));
+
+    // The mirrored journal is a complete audit log
+    shipper.close();
+    QTRY_COMPARE(replica.state(), StandbyReplica::TakenOver);
+    AuditLog promoted;
+    QVERIFY(promoted.open(dir.filePath("history.log")));
+    QCOMPARE(promoted.data(), audit.data());
+}
+
+void TestReplication::testReset()
+{
+    QTemporaryDir dir;
+    {
+        TaskModel model;
+        AuditLog audit;
+        audit.attach(&model);
+        QVERIFY(audit.open(dir.filePath("previous.log")));
+        model.addTask("From the file");
+    }
+
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+    model.addTask("In memory");
+    JournalShipper shipper(&audit);
+    QVERIFY(shipper.listen(socketName("reset")));
+
+    StandbyReplica replica;
+    replica.follow(socketName("reset"));
+    QTRY_COMPARE(replica.taskCount(), 1);
+
+    // Reopening the log replaces the standby's copy
+    QVERIFY(audit.open(dir.filePath("previous.log")));
+    QTRY_COMPARE(replica.journal(), audit.data());
+    QCOMPARE(replica.tasks(), liveTasks(model));
+    QCOMPARE(replica.state(), StandbyReplica::Following);
+}
+
+void TestReplication::testSilentPrimary()
+{
+    // A primary that accepts the standby but never sends anything, as if it hung
+    QLocalServer hung;
+    QLocalServer::removeServer(socketName("silent"));
+    QVERIFY(hung.listen(socketName("silent")));
+
+    StandbyReplica replica;
+    replica.setTakeoverTimeout(200);
+    QSignalSpy lost(&replica, &StandbyReplica::primaryLost);
+    replica.follow(socketName("silent"));
+    QTRY_COMPARE(replica.state(), StandbyReplica::Following);
+
+    QTRY_COMPARE_WITH_TIMEOUT(lost.count(), 1, 2000);
+    QCOMPARE(replica.state(), StandbyReplica::TakenOver);
+    QVERIFY(replica.detectionTime() >= 200);
+}
+
+void TestReplication::testTakeoverFromDeadPrimary()
+{
+    const QString name = socketName("takeover");
+
+    // The standby can start first and waits for the primary
+    StandbyReplica replica;
+    QSignalSpy lost(&replica, &StandbyReplica::primaryLost);
+    replica.follow(name);
+    QCOMPARE(replica.state(), StandbyReplica::Waiting);
+
+    QProcess primary;
+    primary.start(QCoreApplication::applicationFilePath(), {"--primary", name});
+    QVERIFY(primary.waitForStarted());
+    QVERIFY(primary.waitForReadyRead(10000));
+    QCOMPARE(primary.readLine().trimmed(), "ready");
+
+    QTRY_COMPARE_WITH_TIMEOUT(replica.state(), StandbyReplica::Following, 5000);
+    QTRY_COMPARE_WITH_TIMEOUT(replica.taskCount(), PrimaryTasks, 10000);
+
+    // The primary keeps changing tasks; the standby keeps up
+    const qint64 applied = replica.appliedEntries();
+    QTRY_VERIFY_WITH_TIMEOUT(replica.appliedEntries() > applied + 10, 5000);
+    QVERIFY(replica.lagBytes() < 64 * 1024);
+    QVERIFY(Metrics::registry().replicationLag.count() > 0);
+
+    // Killing the primary is noticed well within a second
+    QElapsedTimer takeover;
+    takeover.start();
+    primary.kill();
+    QTRY_COMPARE_WITH_TIMEOUT(lost.count(), 1, 1000);
+    QVERIFY(takeover.elapsed() < 1000);
+    primary.waitForFinished();
+
+    // The replicated tasks are ready to be promoted
+    TaskModel promoted;
+    promoted.addTasks(replica.tasks());
+    QCOMPARE(promoted.rowCount(), PrimaryTasks);
+    QCOMPARE(promoted.getTask(0).getTitle(), "Task 0");
+    QCOMPARE(promoted.getTask(PrimaryTasks - 1).getDescription(), QString("Description %1").arg(PrimaryTasks - 1));
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 3 && qstrcmp(argv[1], "--primary") == 0)
+        return runPrimary(argc, argv);
+
+    QCoreApplication app(argc, argv);
+    TestReplication test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_replication.moc"
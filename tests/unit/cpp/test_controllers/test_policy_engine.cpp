@@ -0,0 +1,148 @@
+#include <QTest>
+#include <QSignalSpy>
+#include "controllers/PolicyEngine.h"
+#include "models/TaskModel.h"
+
+class TestPolicyEngine : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QDateTime daysAgo(int days) { return QDateTime::currentDateTime().addDays(-days); }
+    static QStringList titles(const TaskModel &model);
+
+private slots:
+    // Rule tests
+    void testRetention();
+    void testAging();
+    void testBatching();
+
+    // Index tests
+    void testIndexFollowsModel();
+};
+
+QStringList TestPolicyEngine::titles(const TaskModel &model)
+{
+    QStringList result;
+    for (int i = 0; i < model.rowCount(); ++i)
+    {
+        if (!model.isDeleted(i))
+            result.append(model.getTask(i).getTitle());
+    }
+    return result;
+}
+
+void TestPolicyEngine::testRetention()
+{
+    TaskModel model;
+    model.addTasks({
+        TaskRecord("Done long ago", QString(), Task::Low, true, daysAgo(400)).withCompletedAt(daysAgo(200)),
+        TaskRecord("Done recently", QString(), Task::High, true, daysAgo(400)).withCompletedAt(daysAgo(10)),
+        TaskRecord("Old but pending", QString(), Task::Medium, false, daysAgo(400)),
+        TaskRecord("Done, unknown time", QString(), Task::Medium, true, daysAgo(300)),
+    });
+
+    PolicyEngine engine(&model);
+    engine.addRetentionRule(180);
+
+    QSignalSpy spy(&engine, &PolicyEngine::runFinished);
+    engine.run();
+    QVERIFY(engine.isRunning());
+    QVERIFY(spy.wait());
+
+    QCOMPARE(titles(model), QStringList({"Done recently", "Old but pending"}));
+    QCOMPARE(model.trash()->count(), 2); // restorable until the trash is emptied
+    const PolicyReport report = engine.lastReport();
+    QCOMPARE(report.deleted, 2);
+    QCOMPARE(report.reprioritized, 0);
+    QCOMPARE(report.examined, 2);
+    QCOMPARE(report.perRule.value("delete-completed-after-180d"), 2);
+    QVERIFY(!engine.isRunning());
+}
+
+void TestPolicyEngine::testAging()
+{
+    TaskModel model;
+    model.addTasks({
+        TaskRecord("Old low", QString(), Task::Low, false, daysAgo(20)),
+        TaskRecord("New low", QString(), Task::Low, false, daysAgo(5)),
+        TaskRecord("Old medium", QString(), Task::Medium, false, daysAgo(20)),
+        TaskRecord("Old low, done", QString(), Task::Low, true, daysAgo(20)),
+    });
+
+    PolicyEngine engine(&model);
+    engine.addAgingRule(Task::Low, Task::Medium, 14);
+
+    QSignalSpy changed(&model, &TaskModel::dataChanged);
+    QSignalSpy finished(&engine, &PolicyEngine::runFinished);
+    engine.run();
+    QVERIFY(finished.wait());
+
+    QCOMPARE(model.getTask(0).getPriority(), int(Task::Medium));
+    QCOMPARE(model.getTask(1).getPriority(), int(Task::Low));
+    QCOMPARE(model.getTask(2).getPriority(), int(Task::Medium));
+    QCOMPARE(model.getTask(3).getPriority(), int(Task::Low));
+    QCOMPARE(engine.lastReport().reprioritized, 1);
+    QCOMPARE(changed.count(), 1);
+
+    // Aged tasks moved to another index bucket and are not visited again
+    engine.run();
+    QVERIFY(finished.wait());
+    QCOMPARE(engine.lastReport().examined, 0);
+}
+
+void TestPolicyEngine::testBatching()
+{
+    TaskModel model;
+    QList<TaskRecord> records;
+    for (int i = 0; i < 100; ++i)
+    {
+        const bool old = i % 2 == 0;
+        records.append(TaskRecord(QString("Task %1").arg(i), QString(), Task::Low, true, daysAgo(400))
+                           .withCompletedAt(daysAgo(old ? 200 : 1)));
+    }
+    model.addTasks(records);
+
+    PolicyEngine engine(&model);
+    engine.setBatchSize(16);
+    engine.addRetentionRule(180);
+
+    QSignalSpy changed(&model, &TaskModel::dataChanged);
+    QSignalSpy finished(&engine, &PolicyEngine::runFinished);
+    engine.run();
+    QVERIFY(finished.wait());
+
+    QCOMPARE(model.count(), 50);
+    QCOMPARE(engine.lastReport().deleted, 50);
+    QVERIFY(engine.lastReport().batches >= 50 / 16);
+    QCOMPARE(changed.count(), 50); // no two old tasks are adjacent
+    QCOMPARE(model.trash()->count(), 50);
+    QCOMPARE(engine.indexedCount(), 50);
+}
+
+void TestPolicyEngine::testIndexFollowsModel()
+{
+    TaskModel model;
+    PolicyEngine engine(&model);
+    engine.addRetentionRule(0);
+
+    model.addTask("First");
+    model.addTask("Second");
+    QCOMPARE(engine.indexedCount(), 2);
+
+    model.removeTask(0);
+    QCOMPARE(engine.indexedCount(), 1);
+
+    // Completing the task moves it into the completed index, where a 0-day rule sees it.
+    // The deleted task's row is still there until compaction.
+    model.toggleCompleted(1);
+    QSignalSpy finished(&engine, &PolicyEngine::runFinished);
+    QTest::qSleep(2);
+    engine.run();
+    QVERIFY(finished.wait());
+    QCOMPARE(model.count(), 0);
+    QCOMPARE(engine.indexedCount(), 0);
+}
+
+QTEST_MAIN(TestPolicyEngine)
+#include "test_policy_engine.moc"
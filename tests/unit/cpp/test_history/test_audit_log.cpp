@@ -0,0 +1,219 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include "history/AuditLog.h"
+#include "models/TaskModel.h"
+
+class TestAuditLog : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Recording tests
+    void testRecordsModelChanges();
+    void testDescriptionDeltas();
+    void testReplacedDescription();
+    void testActors();
+
+    // Persistence tests
+    void testReopenFile();
+    void testReopenSameTasks();
+    void testTruncatedTail();
+};
+
+void TestAuditLog::testRecordsModelChanges()
+{
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+
+    model.addTask("Write report", "Quarterly numbers");
+    const quint64 id = model.taskId(0);
+    model.setData(model.index(0), "Write annual report", TaskModel::TitleRole);
+    model.setData(model.index(0), 2, TaskModel::PriorityRole);
+    model.toggleCompleted(0);
+    model.removeTask(0);
+
+    const QList<AuditEntry> history = audit.history(id);
+    QCOMPARE(history.size(), 5);
+    QCOMPARE(history[0].field, int(AuditLog::Created));
+    QCOMPARE(history[0].value.value<TaskRecord>().getTitle(), "Write report");
+    QCOMPARE(history[0].value.value<TaskRecord>().getDescription(), "Quarterly numbers");
+    QCOMPARE(history[1].field, int(AuditLog::Title));
+    QCOMPARE(history[1].value.toString(), "Write annual report");
+    QCOMPARE(history[2].field, int(AuditLog::Priority));
+    QCOMPARE(history[2].value.toInt(), 2);
+    QCOMPARE(history[3].field, int(AuditLog::Completed));
+    QCOMPARE(history[3].value.toBool(), true);
+    QCOMPARE(history[4].field, int(AuditLog::Removed));
+    QCOMPARE(history[4].taskId, id);
+    QVERIFY(history[4].timestamp >= history[0].timestamp);
+
+    QVERIFY(audit.history(id + 1).isEmpty());
+}
+
+void TestAuditLog::testDescriptionDeltas()
+{
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+
+    const QString description = QString("lorem ipsum ").repeated(1000);
+    model.addTask("Notes", description);
+    const quint64 id = model.taskId(0);
+    const qsizetype afterCreate = audit.sizeInBytes();
+
+    model.editDescription(0, 6, 5, "dolor");
+
+    const QList<AuditEntry> history = audit.history(id);
+    QCOMPARE(history.size(), 2);
+    QCOMPARE(history[1].field, int(AuditLog::Description));
+    QCOMPARE(history[1].position, 6);
+    QCOMPARE(history[1].removed, 5);
+    QCOMPARE(history[1].value.toString(), "dolor");
+
+    // The edit is stored as a delta, not as a copy of the description
+    QVERIFY(audit.sizeInBytes() - afterCreate < 32);
+
+    // Replaying the deltas yields the current description
+    QString replayed = history[0].value.value<TaskRecord>().getDescription();
+    replayed.replace(history[1].position, history[1].removed, history[1].value.toString());
+    QCOMPARE(replayed, model.getTask(0).getDescription());
+}
+
+void TestAuditLog::testReplacedDescription()
+{
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+
+    const QString description = QString("lorem ipsum ").repeated(1000);
+    model.addTask("Notes", description);
+    const qsizetype afterCreate = audit.sizeInBytes();
+
+    // A full replace is stored as the span that differs
+    model.setData(model.index(0), QString(description).replace(6, 5, "dolor"), TaskModel::DescriptionRole);
+    const QList<AuditEntry> history = audit.history(model.taskId(0));
+    QCOMPARE(history.size(), 2);
+    QCOMPARE(history[1].position, 6);
+    QCOMPARE(history[1].removed, 5);
+    QCOMPARE(history[1].value.toString(), "dolor");
+    QVERIFY(audit.sizeInBytes() - afterCreate < 32);
+}
+
+void TestAuditLog::testActors()
+{
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+
+    audit.setActor("alice");
+    model.addTask("Shared task");
+    audit.setActor("bob");
+    model.toggleCompleted(0);
+    audit.setActor("alice");
+    model.toggleCompleted(0);
+
+    const QList<AuditEntry> history = audit.history(model.taskId(0));
+    QCOMPARE(history.size(), 3);
+    QCOMPARE(history[0].actor, "alice");
+    QCOMPARE(history[1].actor, "bob");
+    QCOMPARE(history[2].actor, "alice");
+    QCOMPARE(audit.entryCount(), 4); // session start + 3 changes
+}
+
+void TestAuditLog::testReopenFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("audit.log");
+
+    quint64 id = 0;
+    {
+        TaskModel model;
+        AuditLog audit;
+        QVERIFY(audit.open(path));
+        audit.attach(&model);
+        audit.setActor("alice");
+        model.addTask("Persisted", "Before");
+        id = model.taskId(0);
+        model.editDescription(0, 0, 6, "After");
+    }
+
+    AuditLog audit;
+    QVERIFY(audit.open(path));
+    const QList<AuditEntry> history = audit.history(id);
+    QCOMPARE(history.size(), 2);
+    QCOMPARE(history[0].actor, "alice");
+    QCOMPARE(history[1].value.toString(), "After");
+
+    // New entries are appended after the loaded ones, which stay in the file
+    QCOMPARE(audit.bufferedBytes(), 0);
+    audit.recordRemoved(id);
+    QCOMPARE(audit.history(id).size(), 3);
+    audit.flush();
+    QCOMPARE(audit.bufferedBytes(), 0);
+    QCOMPARE(audit.history(id).size(), 3);
+    QCOMPARE(audit.read(0, audit.sizeInBytes()).size(), audit.sizeInBytes());
+}
+
+void TestAuditLog::testReopenSameTasks()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("audit.log");
+
+    TaskModel model;
+    {
+        AuditLog audit;
+        QVERIFY(audit.open(path));
+        audit.attach(&model);
+        model.addTask("Kept");
+        model.addTask("Removed");
+        model.removeTask(1);
+    }
+
+    // Loading the stored tasks while suspended and reopening over them logs nothing
+    TaskModel stored;
+    AuditLog audit;
+    audit.attach(&stored);
+    audit.setSuspended(true);
+    stored.addTasks({model.getTask(0)});
+    audit.setSuspended(false);
+    QVERIFY(audit.open(path));
+    const int entries = audit.entryCount();
+    QCOMPARE(audit.history(model.taskId(0)).size(), 1);
+
+    // A model that differs from the log starts a new session
+    stored.addTask("New");
+    TaskModel other;
+    audit.attach(&other);
+    QCOMPARE(audit.entryCount(), entries + 2);
+}
+
+void TestAuditLog::testTruncatedTail()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("audit.log");
+
+    {
+        AuditLog audit;
+        QVERIFY(audit.open(path));
+        audit.recordChange(7, AuditLog::Title, "Complete entry");
+        audit.recordChange(7, AuditLog::Title, "Entry cut off by a crash");
+    }
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.resize(file.size() - 4));
+    }
+
+    AuditLog audit;
+    QVERIFY(audit.open(path));
+    const QList<AuditEntry> history = audit.history(7);
+    QCOMPARE(history.size(), 1);
+    QCOMPARE(history[0].value.toString(), "Complete entry");
+}
+
+QTEST_MAIN(TestAuditLog)
+#include "test_audit_log.moc"
@@ -0,0 +1,201 @@
+#include <QTest>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+
+#include <limits>
+
+#include "history/AuditLog.h"
+#include "history/HistoryModel.h"
+#include "history/TaskHistory.h"
+#include "models/TaskModel.h"
+
+class TestTaskHistory : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QList<TaskRecord> liveTasks(const TaskModel &model);
+
+private slots:
+    // Replay tests
+    void testStateAtPastTime();
+    void testCheckpointsMatchFullReplay();
+    void testSessionStartsEmpty();
+    void testReplayFromFile();
+
+    // Model tests
+    void testHistoryModel();
+};
+
+QList<TaskRecord> TestTaskHistory::liveTasks(const TaskModel &model)
+{
+    QList<TaskRecord> tasks;
+    for (int i = 0; i < model.rowCount(); ++i)
+    {
+        if (!model.isDeleted(i))
+            tasks.append(model.getTask(i));
+    }
+    return tasks;
+}
+
+void TestTaskHistory::testStateAtPastTime()
+{
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+    TaskHistory history(&audit);
+    history.setCheckpointInterval(4);
+
+    model.addTask("First", "Original description");
+    model.addTask("Second");
+    model.addTask("Third");
+    QTest::qSleep(5);
+    const QDateTime before = QDateTime::currentDateTime();
+    QTest::qSleep(5);
+
+    model.toggleCompleted(0);
+    model.editDescription(0, 0, 8, "Edited");
+    model.removeTask(1);
+    model.addTask("Fourth");
+
+    QTRY_VERIFY(history.checkpointCount() > 0);
+
+    const QList<TaskRecord> past = history.stateAt(before).result();
+    QCOMPARE(past.size(), 3);
+    QCOMPARE(past[0].getTitle(), "First");
+    QCOMPARE(past[0].getDescription(), "Original description");
+    QCOMPARE(past[0].getCompleted(), false);
+    QCOMPARE(past[1].getTitle(), "Second");
+    QCOMPARE(past[2].getTitle(), "Third");
+
+    const QList<TaskRecord> now = history.stateAt(QDateTime()).result();
+    QCOMPARE(now, liveTasks(model));
+    QCOMPARE(now[0].getDescription(), "Edited description");
+}
+
+void TestTaskHistory::testCheckpointsMatchFullReplay()
+{
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+    TaskHistory history(&audit);
+    history.setCheckpointInterval(8);
+
+    QRandomGenerator random(42);
+    for (int i = 0; i < 500; ++i)
+    {
+        const int count = model.count();
+        switch (count < 5 ? 0 : random.bounded(5))
+        {
+        case 0:
+            model.addTask(QString("Task %1").arg(i), QString("Description %1").arg(i));
+            break;
+        case 1:
+            model.removeTask(random.bounded(count));
+            break;
+        case 2:
+            model.toggleCompleted(random.bounded(count));
+            break;
+        case 3:
+            model.setData(model.index(random.bounded(count)), QString("Renamed %1").arg(i), TaskModel::TitleRole);
+            break;
+        default:
+            model.editDescription(random.bounded(count), random.bounded(4), random.bounded(3), "x");
+            break;
+        }
+    }
+
+    QTRY_VERIFY(history.checkpointCount() > 1);
+
+    const QList<TaskRecord> fromCheckpoint = history.stateAt(QDateTime()).result();
+    const QList<TaskRecord> fromStart = TaskHistory::replay(TaskHistory::Checkpoint(), audit.data(),
+                                                            std::numeric_limits<qint64>::max()).constLast().tasks;
+    QCOMPARE(fromCheckpoint, fromStart);
+    QCOMPARE(fromCheckpoint, liveTasks(model));
+}
+
+void TestTaskHistory::testSessionStartsEmpty()
+{
+    AuditLog audit;
+    TaskHistory history(&audit);
+
+    {
+        TaskModel previous;
+        audit.attach(&previous);
+        previous.addTask("From the previous session");
+    }
+
+    TaskModel current;
+    current.addTask("Already loaded");
+    audit.attach(&current);
+    current.addTask("Added later");
+
+    const QList<TaskRecord> state = history.stateAt(QDateTime()).result();
+    QCOMPARE(state, liveTasks(current));
+}
+
+void TestTaskHistory::testReplayFromFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+    QVERIFY(audit.open(dir.filePath("history.log")));
+
+    model.addTask("First", "Written from the file");
+    model.addTask("Second");
+    audit.flush();
+    const TaskHistory::Checkpoint written = TaskHistory::replay(TaskHistory::Checkpoint(), audit.view(),
+                                                                std::numeric_limits<qint64>::max()).constLast();
+    QCOMPARE(written.offset, audit.sizeInBytes());
+
+    // Still in memory
+    model.editDescription(0, 0, 7, "Read");
+    model.addTask("Third");
+    const AuditLog::View view = audit.view();
+    QVERIFY(view.persisted > 0);
+    QVERIFY(!view.tail.isEmpty());
+
+    const qint64 now = std::numeric_limits<qint64>::max();
+    const QList<TaskRecord> fromStart = TaskHistory::replay(TaskHistory::Checkpoint(), view, now).constLast().tasks;
+    QCOMPARE(fromStart, TaskHistory::replay(TaskHistory::Checkpoint(), audit.data(), now).constLast().tasks);
+    QCOMPARE(fromStart, liveTasks(model));
+    QCOMPARE(fromStart[0].getDescription(), "Read from the file");
+
+    // Starting from a checkpoint at the end of the file reads only the tail.
+    QCOMPARE(TaskHistory::replay(written, view, now).constLast().tasks, fromStart);
+}
+
+void TestTaskHistory::testHistoryModel()
+{
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+    TaskHistory history(&audit);
+    HistoryModel past(&history);
+
+    model.addTask("Kept");
+    model.addTask("Removed later");
+    QTest::qSleep(5);
+    const QDateTime before = QDateTime::currentDateTime();
+    QTest::qSleep(5);
+    model.removeTask(1);
+
+    past.showAt(before);
+    QVERIFY(past.isLoading());
+    QTRY_VERIFY(!past.isLoading());
+
+    QCOMPARE(past.rowCount(), 2);
+    QCOMPARE(past.timestamp(), before);
+    QCOMPARE(past.data(past.index(1), TaskModel::TitleRole).toString(), "Removed later");
+    QCOMPARE(past.getTask(0).getTitle(), "Kept");
+    QVERIFY(past.getTask(2).isNull());
+
+    // The live model is unaffected
+    QCOMPARE(model.count(), 1);
+}
+
+QTEST_MAIN(TestTaskHistory)
+#include "test_task_history.moc"
@@ -0,0 +1,183 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QWheelEvent>
+#include "metrics/InputRecorder.h"
+#include "metrics/InputReplayer.h"
+
+class TestInputReplay : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    // Recording tests
+    void testRoundTrip();
+    void testCapture();
+
+    // Replay tests
+    void testSeededTasks();
+    void testReplay();
+};
+
+void TestInputReplay::initTestCase()
+{
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+}
+
+void TestInputReplay::testRoundTrip()
+{
+    InputRecording recording;
+    recording.windowSize = QSize(640, 480);
+
+    InputEvent wheel;
+    wheel.type = InputEvent::Wheel;
+    wheel.time = 40;
+    wheel.position = QPointF(10.5, 20);
+    wheel.angleDelta = QPoint(0, -120);
+    wheel.pixelDelta = QPoint(0, -30);
+    wheel.phase = Qt::ScrollUpdate;
+
+    InputEvent key;
+    key.type = InputEvent::KeyPress;
+    key.time = 10;
+    key.key = Qt::Key_A;
+    key.text = "a";
+    key.modifiers = Qt::ShiftModifier;
+
+    recording.events = {wheel, key};
+
+    QTemporaryDir dir;
+    const QString path = dir.filePath("input.json");
+    QVERIFY(recording.save(path));
+
+    QString error;
+    const InputRecording loaded = InputRecording::load(path, &error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QCOMPARE(loaded.windowSize, QSize(640, 480));
+    QCOMPARE(loaded.events.size(), 2);
+
+    // Loading sorts by time.
+    QCOMPARE(loaded.events.at(0).type, InputEvent::KeyPress);
+    QCOMPARE(loaded.events.at(0).key, int(Qt::Key_A));
+    QCOMPARE(loaded.events.at(0).text, QString("a"));
+    QCOMPARE(loaded.events.at(0).modifiers, Qt::KeyboardModifiers(Qt::ShiftModifier));
+    QCOMPARE(loaded.events.at(1).position, QPointF(10.5, 20));
+    QCOMPARE(loaded.events.at(1).angleDelta, QPoint(0, -120));
+    QCOMPARE(loaded.events.at(1).pixelDelta, QPoint(0, -30));
+    QCOMPARE(loaded.events.at(1).phase, Qt::ScrollUpdate);
+    QCOMPARE(loaded.duration(), qint64(40));
+
+    QVERIFY(InputRecording::load(dir.filePath("missing.json"), &error).events.isEmpty());
+    QVERIFY(!error.isEmpty());
+}
+
+void TestInputReplay::testCapture()
+{
+    QWindow window;
+    window.resize(100, 100);
+
+    InputRecorder recorder;
+    recorder.attach(&window);
+    QCOMPARE(recorder.recording().windowSize, QSize(100, 100));
+
+    QMouseEvent hover(QEvent::MouseMove, QPointF(5, 5), QPointF(5, 5), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+    QMouseEvent press(QEvent::MouseButtonPress, QPointF(5, 5), QPointF(5, 5), Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
+    QMouseEvent drag(QEvent::MouseMove, QPointF(5, 50), QPointF(5, 50), Qt::NoButton, Qt::LeftButton, Qt::NoModifier);
+    QWheelEvent wheel(QPointF(1, 2), QPointF(1, 2), QPoint(), QPoint(0, 120), Qt::NoButton, Qt::NoModifier, Qt::NoScrollPhase, false);
+    QCoreApplication::sendEvent(&window, &hover);
+    QCoreApplication::sendEvent(&window, &press);
+    QCoreApplication::sendEvent(&window, &drag);
+    QCoreApplication::sendEvent(&window, &wheel);
+
+    recorder.detach();
+    QCoreApplication::sendEvent(&window, &press);
+
+    // Hover moves and events after detach() are not recorded.
+    const QList<InputEvent> &events = recorder.recording().events;
+    QCOMPARE(events.size(), 3);
+    QCOMPARE(events.at(0).type, InputEvent::Press);
+    QCOMPARE(events.at(0).button, Qt::LeftButton);
+    QCOMPARE(events.at(1).type, InputEvent::Move);
+    QCOMPARE(events.at(1).position, QPointF(5, 50));
+    QCOMPARE(events.at(2).type, InputEvent::Wheel);
+    QCOMPARE(events.at(2).angleDelta, QPoint(0, 120));
+}
+
+void TestInputReplay::testSeededTasks()
+{
+    const QList<TaskRecord> first = InputReplayer::seededTasks(42, 200);
+    QCOMPARE(first.size(), 200);
+    QCOMPARE(InputReplayer::seededTasks(42, 200), first);
+    QVERIFY(InputReplayer::seededTasks(43, 200) != first);
+
+    int completed = 0;
+    for (const TaskRecord &task : first)
+    {
+        QVERIFY(task.isValid());
+        QVERIFY(task.getPriority() >= 0 && task.getPriority() <= 2);
+        completed += task.getCompleted() ? 1 : 0;
+    }
+    QVERIFY(completed > 0 && completed < first.size());
+}
+
+void TestInputReplay::testReplay()
+{
+    QQmlEngine engine;
+    QQmlComponent component(&engine);
+    component.setData("import QtQuick\n"
+                      "Window {\n"
+                      "    width: 200; height: 200; visible: true\n"
+                      "    ListView {\n"
+                      "        anchors.fill: parent; model: 500\n"
+                      "        delegate: Rectangle { width: 200; height: 20 }\n"
+                      "    }\n"
+                      "}\n",
+                      QUrl());
+    std::unique_ptr<QObject> root(component.create());
+    QVERIFY2(root, qPrintable(component.errorString()));
+    auto *window = qobject_cast<QQuickWindow *>(root.get());
+    QVERIFY(window);
+    QVERIFY(QTest::qWaitForWindowExposed(window));
+
+    InputRecording recording;
+    recording.windowSize = QSize(200, 200);
+    for (int i = 0; i < 20; ++i)
+    {
+        InputEvent wheel;
+        wheel.type = InputEvent::Wheel;
+        wheel.time = i * 10;
+        wheel.position = QPointF(100, 100);
+        wheel.angleDelta = QPoint(0, -120);
+        recording.events.append(wheel);
+    }
+
+    InputReplayer replayer(window);
+    replayer.setRecording(recording);
+    replayer.setDelegateType("QQuickRectangle");
+    replayer.setSettleTime(200);
+
+    QSignalSpy spy(&replayer, &InputReplayer::finished);
+    replayer.start();
+    QVERIFY(replayer.isRunning());
+    QVERIFY(spy.wait(10000));
+    QVERIFY(!replayer.isRunning());
+
+    const FrameReport report = replayer.report();
+    QCOMPARE(report.events, 20);
+    QVERIFY(report.frames > 0);
+    QVERIFY(report.p50Ms <= report.p90Ms && report.p90Ms <= report.p99Ms && report.p99Ms <= report.maxMs);
+
+    // Twenty wheel notches over 20 px rows scroll delegates out of view and new ones in.
+    const QQuickItem *list = window->contentItem()->childItems().value(0);
+    QVERIFY(list);
+    QVERIFY(list->property("contentY").toReal() > 0);
+    QVERIFY(report.delegatesCreated > 0);
+    QVERIFY(report.delegatesDestroyed > 0);
+}
+
+QTEST_MAIN(TestInputReplay)
+#include "test_input_replay.moc"
@@ -0,0 +1,153 @@
+#include <QTest>
+#include <QTcpSocket>
+#include "metrics/Metrics.h"
+#include "metrics/MetricsServer.h"
+#include "metrics/ModelMetrics.h"
+#include "models/TaskModel.h"
+
+class TestMetrics : public QObject
+{
+    Q_OBJECT
+
+private:
+    static qint64 tasks(bool completed, int priority)
+    {
+        return Metrics::registry().tasks[completed ? 1 : 0][size_t(priority)].value();
+    }
+
+private slots:
+    // Registry tests
+    void testHistogram();
+    void testRender();
+
+    // Model tests
+    void testModelCounts();
+
+    // Server tests
+    void testRespond();
+    void testScrape();
+};
+
+void TestMetrics::testHistogram()
+{
+    Metrics::Histogram histogram;
+    histogram.observe(10'000);          // 10 µs: first bucket
+    histogram.observe(3'000'000);       // 3 ms: <= 5 ms
+    histogram.observe(10'000'000'000);  // 10 s: +Inf
+
+    QCOMPARE(histogram.count(), quint64(3));
+    QCOMPARE(histogram.sumNs(), quint64(10'003'010'000));
+    QCOMPARE(histogram.bucket(0), quint64(1));
+    QCOMPARE(histogram.bucket(6), quint64(1));
+    QCOMPARE(histogram.bucket(int(Metrics::Histogram::BoundsNs.size())), quint64(1));
+}
+
+void TestMetrics::testRender()
+{
+    Metrics::Registry &metrics = Metrics::registry();
+    metrics.storageWrite.observe(2'000'000);
+    metrics.memory.gauge("test.cache")->set(4096);
+    QCOMPARE(metrics.memory.gauge("test.cache"), metrics.memory.gauge("test.cache"));
+    metrics.cacheSheds.counter("cache=\"test.cache\",level=\"high\"")->add(2);
+
+    const QByteArray text = metrics.render();
+    QVERIFY(text.endsWith("# EOF\n"));
+    QVERIFY(text.contains("# TYPE taskmanager_mutations counter\n"));
+    QVERIFY(text.contains("taskmanager_mutations_total{kind=\"insert\"} "));
+    QVERIFY(text.contains("taskmanager_tasks{status=\"pending\",priority=\"high\"} "));
+    QVERIFY(text.contains("taskmanager_storage_write_duration_seconds_bucket{le=\"+Inf\"} "));
+    QVERIFY(text.contains("taskmanager_operation_duration_seconds_count{operation=\"search\"} "));
+    QVERIFY(text.contains("taskmanager_memory_bytes{subsystem=\"test.cache\"} 4096\n"));
+    QVERIFY(text.contains("taskmanager_memory_sheds_total{cache=\"test.cache\",level=\"high\"} 2\n"));
+    QVERIFY(text.contains("taskmanager_malloc_trimmed_bytes_total "));
+
+    // Buckets are cumulative: the 2 ms write is in every bucket from 2.5 ms on.
+    const qsizetype bucket = text.indexOf("taskmanager_storage_write_duration_seconds_bucket{le=\"0.0025\"} ");
+    QVERIFY(bucket >= 0);
+    const qsizetype value = text.indexOf(' ', bucket) + 1;
+    QVERIFY(text.mid(value, text.indexOf('\n', value) - value).toULongLong() >= 1);
+}
+
+void TestMetrics::testModelCounts()
+{
+    const qint64 pendingHigh = tasks(false, Task::High);
+    const qint64 pendingLow = tasks(false, Task::Low);
+    const qint64 completedLow = tasks(true, Task::Low);
+    const quint64 inserts = Metrics::registry().mutations[Metrics::Insert].value();
+    const quint64 removes = Metrics::registry().mutations[Metrics::Remove].value();
+
+    TaskModel model;
+    model.addTasks({TaskRecord("Before", QString(), Task::High)});
+
+    {
+        ModelMetrics counts(&model);
+        QCOMPARE(counts.countedTasks(), 1);
+        QCOMPARE(tasks(false, Task::High), pendingHigh + 1);
+
+        model.addTasks({TaskRecord("A", QString(), Task::Low), TaskRecord("B", QString(), Task::High)});
+        QCOMPARE(tasks(false, Task::High), pendingHigh + 2);
+        QCOMPARE(Metrics::registry().mutations[Metrics::Insert].value(), inserts + 2);
+
+        model.toggleCompleted(1);
+        QCOMPARE(tasks(true, Task::Low), completedLow + 1);
+
+        model.setTasksPriority({model.taskId(2)}, Task::Low);
+        QCOMPARE(tasks(false, Task::High), pendingHigh + 1);
+        QCOMPARE(tasks(false, Task::Low), pendingLow + 1);
+
+        model.removeTasks({model.taskId(1)});
+        QCOMPARE(tasks(true, Task::Low), completedLow);
+        QCOMPARE(Metrics::registry().mutations[Metrics::Remove].value(), removes + 1);
+        QCOMPARE(counts.countedTasks(), 2);
+    }
+
+    // The observer withdraws its counts when it goes away.
+    QCOMPARE(tasks(false, Task::High), pendingHigh);
+    QCOMPARE(tasks(false, Task::Low), pendingLow);
+}
+
+void TestMetrics::testRespond()
+{
+    const QByteArray ok = MetricsServer::respond("GET /metrics HTTP/1.1\r\nHost: localhost");
+    QVERIFY(ok.startsWith("HTTP/1.1 200 OK\r\n"));
+    QVERIFY(ok.contains("Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"));
+    QVERIFY(ok.endsWith("# EOF\n"));
+
+    const QByteArray head = MetricsServer::respond("HEAD /metrics?x=1 HTTP/1.1");
+    QVERIFY(head.startsWith("HTTP/1.1 200 OK\r\n"));
+    QVERIFY(head.endsWith("\r\n\r\n"));
+
+    QVERIFY(MetricsServer::respond("GET / HTTP/1.1").startsWith("HTTP/1.1 404"));
+    QVERIFY(MetricsServer::respond("POST /metrics HTTP/1.1").startsWith("HTTP/1.1 405"));
+    QVERIFY(MetricsServer::respond("garbage").startsWith("HTTP/1.1 400"));
+}
+
+void TestMetrics::testScrape()
+{
+    MetricsServer server;
+    QVERIFY(server.listen(0));
+    QVERIFY(server.port() != 0);
+
+    // The server answers from its own thread; this thread's event loop is never entered.
+    QTcpSocket socket;
+    socket.connectToHost(QHostAddress::LocalHost, server.port());
+    QVERIFY(socket.waitForConnected(5000));
+    socket.write("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    QVERIFY(socket.waitForBytesWritten(5000));
+
+    QByteArray reply;
+    while (socket.waitForReadyRead(5000))
+        reply += socket.readAll();
+    reply += socket.readAll();
+
+    QVERIFY(reply.startsWith("HTTP/1.1 200 OK\r\n"));
+    QVERIFY(reply.endsWith("# EOF\n"));
+    QCOMPARE(server.scrapes(), quint64(1));
+
+    server.close();
+    QVERIFY(!server.isListening());
+    QCOMPARE(server.port(), quint16(0));
+}
+
+QTEST_MAIN(TestMetrics)
+#include "test_metrics.moc"
@@ -0,0 +1,160 @@
+#include <QTest>
+#include <QSignalSpy>
+#include "models/AgendaModel.h"
+#include "models/TaskModel.h"
+
+class TestAgenda : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QList<TaskRecord> tasks();
+    static QList<SlotPlanner::Window> days(int count);
+
+private slots:
+    // Planning tests
+    void testPlan();
+    void testPendingTasksOnly();
+
+    // Replanning tests
+    void testReplanOnEdit();
+    void testTitleChange();
+    void testClear();
+};
+
+QList<TaskRecord> TestAgenda::tasks()
+{
+    // Review (High, 1h), Write (Medium, 3h) after Review, Cleanup (Low, 2h)
+    return {TaskRecord("Write", QString(), 1, false, QDateTime(), 1).withEstimate(3).withDependencies({2}),
+            TaskRecord("Review", QString(), 2, false, QDateTime(), 2).withEstimate(1),
+            TaskRecord("Cleanup", QString(), 0, false, QDateTime(), 3).withEstimate(2)};
+}
+
+QList<SlotPlanner::Window> TestAgenda::days(int count)
+{
+    // Working hours from 9 to 17 from Monday 19 October 2026 on
+    const qint64 monday = SlotPlanner::toMinutes(QDateTime(QDate(2026, 10, 19), QTime(9, 0)));
+    QList<SlotPlanner::Window> windows;
+    for (int day = 0; day < count; ++day)
+        windows.append({monday + day * 1440, monday + day * 1440 + 480});
+    return windows;
+}
+
+void TestAgenda::testPlan()
+{
+    TaskModel model;
+    model.addTasks(tasks());
+    AgendaModel agenda;
+    agenda.attach(&model);
+    QCOMPARE(agenda.count(), 0);
+
+    QSignalSpy planned(&agenda, &AgendaModel::planned);
+    agenda.setWindows(days(1));
+    QVERIFY(agenda.isPlanning());
+    QVERIFY(planned.wait());
+    QVERIFY(!agenda.isPlanning());
+
+    QCOMPARE(agenda.count(), 3);
+    QCOMPARE(agenda.data(agenda.index(0), AgendaModel::TitleRole).toString(), "Review");
+    QCOMPARE(agenda.data(agenda.index(0), AgendaModel::StartRole).toDateTime(), QDateTime(QDate(2026, 10, 19), QTime(9, 0)));
+    QCOMPARE(agenda.data(agenda.index(1), AgendaModel::TitleRole).toString(), "Write");
+    QCOMPARE(agenda.data(agenda.index(1), AgendaModel::EndRole).toDateTime(), QDateTime(QDate(2026, 10, 19), QTime(13, 0)));
+    QCOMPARE(agenda.data(agenda.index(2), AgendaModel::DayRole).toString(), "2026-10-19");
+    QCOMPARE(agenda.data(agenda.index(2), AgendaModel::PartsRole).toInt(), 1);
+    QCOMPARE(agenda.unplacedCount(), 0);
+}
+
+void TestAgenda::testPendingTasksOnly()
+{
+    TaskModel model;
+    QList<TaskRecord> records = tasks();
+    records.append(TaskRecord("Done", QString(), 2, true, QDateTime(), 4).withEstimate(1));
+    records.append(TaskRecord("Someday", QString(), 2, false, QDateTime(), 5));
+    model.addTasks(records);
+    QVERIFY(model.removeTask(2));
+
+    AgendaModel agenda;
+    agenda.attach(&model);
+    QSignalSpy planned(&agenda, &AgendaModel::planned);
+    agenda.setWindows(days(1));
+    QVERIFY(planned.wait());
+
+    // Completed, unestimated and deleted tasks are not planned
+    QCOMPARE(agenda.count(), 2);
+    QCOMPARE(agenda.data(agenda.index(0), AgendaModel::TaskIdRole).toULongLong(), quint64(2));
+    QCOMPARE(agenda.data(agenda.index(1), AgendaModel::TaskIdRole).toULongLong(), quint64(1));
+}
+
+void TestAgenda::testReplanOnEdit()
+{
+    TaskModel model;
+    model.addTasks(tasks());
+    AgendaModel agenda;
+    agenda.attach(&model);
+    QSignalSpy planned(&agenda, &AgendaModel::planned);
+    agenda.setWindows(days(2));
+    QVERIFY(planned.wait());
+
+    // Cleanup grows longer than a day and is split over both days
+    QSignalSpy removed(&agenda, &AgendaModel::rowsRemoved);
+    QVERIFY(model.setData(model.index(2), 10, TaskModel::EstimateRole));
+    QVERIFY(planned.wait());
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(agenda.count(), 4);
+    QCOMPARE(agenda.data(agenda.index(2), AgendaModel::PartsRole).toInt(), 2);
+    QCOMPARE(agenda.data(agenda.index(3), AgendaModel::PartRole).toInt(), 1);
+    QCOMPARE(agenda.data(agenda.index(3), AgendaModel::EndRole).toDateTime(), QDateTime(QDate(2026, 10, 20), QTime(15, 0)));
+
+    // Completing Review lets Write start at once
+    model.toggleCompleted(1);
+    QVERIFY(planned.wait());
+    QCOMPARE(agenda.data(agenda.index(0), AgendaModel::TitleRole).toString(), "Write");
+    QCOMPARE(agenda.count(), 3);
+
+    // Several edits in a row are planned together
+    planned.clear();
+    QVERIFY(model.setData(model.index(0), 0, TaskModel::PriorityRole));
+    QVERIFY(model.setData(model.index(2), 2, TaskModel::PriorityRole));
+    QVERIFY(planned.wait());
+    QCOMPARE(planned.count(), 1);
+    QCOMPARE(agenda.data(agenda.index(0), AgendaModel::TitleRole).toString(), "Cleanup");
+}
+
+void TestAgenda::testTitleChange()
+{
+    TaskModel model;
+    model.addTasks(tasks());
+    AgendaModel agenda;
+    agenda.attach(&model);
+    QSignalSpy planned(&agenda, &AgendaModel::planned);
+    agenda.setWindows(days(1));
+    QVERIFY(planned.wait());
+
+    QSignalSpy changed(&agenda, &AgendaModel::dataChanged);
+    QVERIFY(model.setData(model.index(1), "Code review", TaskModel::TitleRole));
+    QCOMPARE(changed.count(), 1);
+    QVERIFY(!agenda.isPlanning());
+    QCOMPARE(agenda.data(agenda.index(0), AgendaModel::TitleRole).toString(), "Code review");
+}
+
+void TestAgenda::testClear()
+{
+    TaskModel model;
+    model.addTasks(tasks());
+    AgendaModel agenda;
+    agenda.attach(&model);
+    QSignalSpy planned(&agenda, &AgendaModel::planned);
+    agenda.setWindows(days(1));
+    QVERIFY(planned.wait());
+
+    agenda.clear();
+    QCOMPARE(agenda.count(), 0);
+
+    // Without free time, edits do not plan
+    QVERIFY(model.setData(model.index(2), 4, TaskModel::EstimateRole));
+    QVERIFY(!agenda.isPlanning());
+    QCOMPARE(agenda.count(), 0);
+}
+
+QTEST_MAIN(TestAgenda)
+#include "test_agenda.moc"
@@ -0,0 +1,227 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "models/AssigneeModel.h"
+#include "models/TaskModel.h"
+#include "storage/TaskStore.h"
+#include "history/AuditLog.h"
+#include "utils/AssigneeIndex.h"
+
+class TestAssignees : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QStringList titles(const QAbstractItemModel &model);
+
+private slots:
+    // Index tests
+    void testIndex();
+
+    // Model tests
+    void testAssigneeTasks();
+    void testReassign();
+    void testTrashAndRestore();
+    void testWorkload();
+
+    // Persistence tests
+    void testStoreRoundTrip();
+    void testAuditLog();
+};
+
+QStringList TestAssignees::titles(const QAbstractItemModel &model)
+{
+    QStringList result;
+    for (int row = 0; row < model.rowCount(); ++row)
+        result.append(model.data(model.index(row, 0), TaskModel::TitleRole).toString());
+    return result;
+}
+
+void TestAssignees::testIndex()
+{
+    AssigneeIndex index;
+    QCOMPARE(index.intern(QString()), quint32(0));
+    const quint32 ana = index.intern("Ana");
+    QCOMPARE(index.intern("Ana"), ana);
+    QCOMPARE(index.find("Ana"), qint64(ana));
+    QCOMPARE(index.find("Bo"), qint64(-1));
+    QCOMPARE(index.personCount(), 2);
+
+    QCOMPARE(index.insert(ana, 7, false), 0);
+    QCOMPARE(index.insert(ana, 3, true), 0);
+    QCOMPARE(index.insert(ana, 9, false), 2);
+    QCOMPARE(index.postings(ana), QList<quint64>({3, 7, 9}));
+    QCOMPARE(index.workload(ana).open, 2);
+    QCOMPARE(index.workload(ana).completed, 1);
+
+    index.setCompleted(ana, true);
+    QCOMPARE(index.workload(ana).open, 1);
+    QCOMPARE(index.remove(ana, 7, true), 1);
+    QCOMPARE(index.remove(ana, 7, true), -1);
+    QCOMPARE(index.workload(ana).total(), 2);
+    QCOMPARE(index.assigned(), QList<quint32>({ana}));
+
+    // Ids outlive the tasks of a person
+    index.clear();
+    QVERIFY(index.postings(ana).isEmpty());
+    QVERIFY(index.assigned().isEmpty());
+    QCOMPARE(index.intern("Ana"), ana);
+}
+
+void TestAssignees::testAssigneeTasks()
+{
+    TaskModel model;
+    QSignalSpy assignees(&model, &TaskModel::assigneesChanged);
+    model.addTasks({TaskRecord("Plan").withAssignee("Ana"), TaskRecord("Build").withAssignee("Bo"),
+                    TaskRecord("Ship").withAssignee(" Ana "), TaskRecord("Relax")});
+
+    QCOMPARE(assignees.count(), 1);
+    QCOMPARE(model.assignees(), QStringList({"Ana", "Bo"}));
+    QCOMPARE(model.data(model.index(2), TaskModel::AssigneeRole).toString(), "Ana");
+    QCOMPARE(model.tasksOfAssignee("Ana"), QList<quint64>({model.taskId(0), model.taskId(2)}));
+    QCOMPARE(model.tasksOfAssignee("Nobody"), QList<quint64>());
+
+    AssigneeModel *ana = model.assigneeTasks("Ana");
+    QCOMPARE(model.assigneeTasks("Ana"), ana);
+    QCOMPARE(ana->assignee(), "Ana");
+    QCOMPARE(titles(*ana), QStringList({"Plan", "Ship"}));
+    QCOMPARE(ana->sourceRow(1), 2);
+    QCOMPARE(ana->getTask(0).getTitle(), "Plan");
+    QCOMPARE(titles(*model.assigneeTasks(QString())), QStringList({"Relax"}));
+
+    // A new task of the person is one inserted row
+    QSignalSpy inserted(ana, &AssigneeModel::rowsInserted);
+    QSignalSpy reset(ana, &AssigneeModel::modelReset);
+    model.addTask("Review");
+    model.setData(model.index(4), "Ana", TaskModel::AssigneeRole);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(reset.count(), 0);
+    QCOMPARE(titles(*ana), QStringList({"Plan", "Ship", "Review"}));
+
+    // Changes of listed tasks are forwarded
+    QSignalSpy changed(ana, &AssigneeModel::dataChanged);
+    model.setData(model.index(2), "Ship it", TaskModel::TitleRole);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(changed.at(0).at(0).value<QModelIndex>().row(), 1);
+    model.setData(model.index(1), "Build it", TaskModel::TitleRole);
+    QCOMPARE(changed.count(), 1);
+}
+
+void TestAssignees::testReassign()
+{
+    TaskModel model;
+    model.addTasks({TaskRecord("Plan").withAssignee("Ana"), TaskRecord("Build").withAssignee("Bo"),
+                    TaskRecord("Test").withAssignee("Cy")});
+    AssigneeModel *ana = model.assigneeTasks("Ana");
+    AssigneeModel *bo = model.assigneeTasks("Bo");
+    AssigneeModel *cy = model.assigneeTasks("Cy");
+
+    QSignalSpy anaRemoved(ana, &AssigneeModel::rowsRemoved);
+    QSignalSpy boInserted(bo, &AssigneeModel::rowsInserted);
+    QSignalSpy boReset(bo, &AssigneeModel::modelReset);
+    QSignalSpy cyCount(cy, &AssigneeModel::countChanged);
+    QSignalSpy cyWorkload(cy, &AssigneeModel::workloadChanged);
+    QSignalSpy assignees(&model, &TaskModel::assigneesChanged);
+
+    // Only the former and the new assignee's lists change
+    QVERIFY(model.setData(model.index(0), "Bo", TaskModel::AssigneeRole));
+    QCOMPARE(anaRemoved.count(), 1);
+    QCOMPARE(boInserted.count(), 1);
+    QCOMPARE(boReset.count(), 0);
+    QCOMPARE(cyCount.count(), 0);
+    QCOMPARE(cyWorkload.count(), 0);
+    QCOMPARE(ana->count(), 0);
+    QCOMPARE(titles(*bo), QStringList({"Plan", "Build"}));
+
+    // Ana has no tasks left
+    QCOMPARE(assignees.count(), 1);
+    QCOMPARE(model.assignees(), QStringList({"Bo", "Cy"}));
+}
+
+void TestAssignees::testTrashAndRestore()
+{
+    TaskModel model;
+    model.addTasks({TaskRecord("Plan").withAssignee("Ana"), TaskRecord("Ship").withAssignee("Ana")});
+    AssigneeModel *ana = model.assigneeTasks("Ana");
+    const quint64 id = model.taskId(0);
+
+    // Tasks in the trash are not anyone's workload
+    QVERIFY(model.removeTask(0));
+    QCOMPARE(titles(*ana), QStringList({"Ship"}));
+    QCOMPARE(model.openTaskCount("Ana"), 1);
+
+    QVERIFY(model.restoreTask(id));
+    QCOMPARE(titles(*ana), QStringList({"Plan", "Ship"}));
+    QCOMPARE(model.openTaskCount("Ana"), 2);
+
+    model.clear();
+    QCOMPARE(ana->count(), 0);
+    QVERIFY(model.assignees().isEmpty());
+}
+
+void TestAssignees::testWorkload()
+{
+    TaskModel model;
+    model.addTasks({TaskRecord("Plan").withAssignee("Ana"), TaskRecord("Ship").withAssignee("Ana"),
+                    TaskRecord("Build").withAssignee("Bo")});
+    AssigneeModel *ana = model.assigneeTasks("Ana");
+    QSignalSpy workload(ana, &AssigneeModel::workloadChanged);
+    QSignalSpy named(&model, &TaskModel::workloadChanged);
+
+    model.toggleCompleted(1);
+    QCOMPARE(workload.count(), 1);
+    QCOMPARE(named.count(), 1);
+    QCOMPARE(named.at(0).at(0).toString(), "Ana");
+    QCOMPARE(ana->openCount(), 1);
+    QCOMPARE(ana->completedCount(), 1);
+    QCOMPARE(model.completedTaskCount("Ana"), 1);
+    QCOMPARE(model.openTaskCount("Bo"), 1);
+
+    // Reassigning a completed task moves it to the other person's completed count
+    model.setData(model.index(1), "Bo", TaskModel::AssigneeRole);
+    QCOMPARE(ana->completedCount(), 0);
+    QCOMPARE(model.completedTaskCount("Bo"), 1);
+    QCOMPARE(model.openTaskCount("Bo"), 1);
+}
+
+void TestAssignees::testStoreRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    {
+        TaskModel model;
+        TaskStore store;
+        store.attach(&model);
+        QVERIFY(store.open(dir.path()));
+        model.addTasks({TaskRecord("Plan").withAssignee("Ana"), TaskRecord("Relax")});
+        QVERIFY(store.save(true));
+    }
+
+    TaskModel model;
+    TaskStore store;
+    store.attach(&model);
+    QVERIFY(store.open(dir.path()));
+    QCOMPARE(model.getTask(0).getAssignee(), "Ana");
+    QVERIFY(model.getTask(1).getAssignee().isEmpty());
+    QCOMPARE(titles(*model.assigneeTasks("Ana")), QStringList({"Plan"}));
+}
+
+void TestAssignees::testAuditLog()
+{
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+
+    model.addTask("Plan");
+    const quint64 id = model.taskId(0);
+    model.setData(model.index(0), "Ana", TaskModel::AssigneeRole);
+
+    const QList<AuditEntry> history = audit.history(id);
+    QCOMPARE(history.size(), 2);
+    QCOMPARE(history[1].field, int(AuditLog::Assignee));
+    QCOMPARE(history[1].value.toString(), "Ana");
+}
+
+QTEST_MAIN(TestAssignees)
+#include "test_assignees.moc"
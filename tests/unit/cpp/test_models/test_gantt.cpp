@@ -0,0 +1,197 @@
+#include <QTest>
+#include <QRegularExpression>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "models/GanttModel.h"
+#include "models/TaskModel.h"
+#include "storage/TaskStore.h"
+#include "history/AuditLog.h"
+
+class TestGantt : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QList<TaskRecord> plan();
+    static qint64 start(const GanttModel &gantt, quint64 id);
+
+private slots:
+    // Schedule tests
+    void testSchedule();
+    void testEditEstimate();
+    void testDependencies();
+    void testTrashAndRestore();
+
+    // Persistence tests
+    void testStoreRoundTrip();
+    void testAuditLog();
+};
+
+QList<TaskRecord> TestGantt::plan()
+{
+    // Design (8h) and Research (4h) before Build (2h); Docs (5h) on its own.
+    return {TaskRecord("Design", QString(), 1, false, QDateTime(), 1).withEstimate(8),
+            TaskRecord("Research", QString(), 1, false, QDateTime(), 2).withEstimate(4),
+            TaskRecord("Build", QString(), 1, false, QDateTime(), 3).withEstimate(2).withDependencies({1, 2}),
+            TaskRecord("Docs", QString(), 1, false, QDateTime(), 4).withEstimate(5)};
+}
+
+qint64 TestGantt::start(const GanttModel &gantt, quint64 id)
+{
+    return gantt.data(gantt.index(gantt.rowOfTask(id)), GanttModel::EarliestStartRole).toLongLong();
+}
+
+void TestGantt::testSchedule()
+{
+    TaskModel model;
+    model.addTasks(plan());
+    GanttModel gantt;
+    gantt.attach(&model);
+
+    QCOMPARE(gantt.count(), 4);
+    QCOMPARE(gantt.projectEnd(), qint64(10));
+    QCOMPARE(gantt.taskId(2), quint64(3));
+    QCOMPARE(gantt.data(gantt.index(2), GanttModel::TitleRole).toString(), "Build");
+    QCOMPARE(start(gantt, 3), qint64(8));
+    QCOMPARE(gantt.data(gantt.index(1), GanttModel::SlackRole).toLongLong(), qint64(4));
+    QVERIFY(gantt.data(gantt.index(0), GanttModel::CriticalRole).toBool());
+    QVERIFY(!gantt.data(gantt.index(3), GanttModel::CriticalRole).toBool());
+    QCOMPARE(gantt.criticalPath(), QList<quint64>({1, 3}));
+
+    const QVariantList links = gantt.data(gantt.index(2), GanttModel::LinksRole).toList();
+    QCOMPARE(links.size(), 2);
+    QCOMPARE(links[0].toMap().value("taskId").toULongLong(), quint64(1));
+    QCOMPARE(links[0].toMap().value("finish").toLongLong(), qint64(8));
+
+    // New tasks are appended
+    QSignalSpy inserted(&gantt, &GanttModel::rowsInserted);
+    model.addTask("Release");
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(gantt.count(), 5);
+}
+
+void TestGantt::testEditEstimate()
+{
+    TaskModel model;
+    model.addTasks(plan());
+    GanttModel gantt;
+    gantt.attach(&model);
+
+    // Docs has slack: only its own row changes
+    QSignalSpy changed(&gantt, &GanttModel::dataChanged);
+    QSignalSpy end(&gantt, &GanttModel::projectEndChanged);
+    QVERIFY(gantt.setEstimate(4, 7));
+    QCOMPARE(end.count(), 0);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(changed.at(0).at(0).value<QModelIndex>().row(), 3);
+    QCOMPARE(model.getTask(3).getEstimate(), 7);
+
+    // Research becomes longer than Design and moves the end of the project
+    changed.clear();
+    QVERIFY(gantt.setEstimate(2, 10));
+    QCOMPARE(end.count(), 1);
+    QCOMPARE(gantt.projectEnd(), qint64(12));
+    QCOMPARE(start(gantt, 3), qint64(10));
+    QCOMPARE(gantt.criticalPath(), QList<quint64>({2, 3}));
+    QCOMPARE(gantt.data(gantt.index(0), GanttModel::SlackRole).toLongLong(), qint64(2));
+
+    QVERIFY(!gantt.setEstimate(99, 1));
+}
+
+void TestGantt::testDependencies()
+{
+    TaskModel model;
+    model.addTasks(plan());
+    GanttModel gantt;
+    gantt.attach(&model);
+
+    QVERIFY(gantt.addDependency(4, 3));
+    QCOMPARE(model.getTask(3).getDependencies(), QList<quint64>({3}));
+    QCOMPARE(start(gantt, 4), qint64(10));
+    QCOMPARE(gantt.projectEnd(), qint64(15));
+
+    // Design cannot wait for Docs, which waits for it through Build
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("cannot wait for"));
+    QVERIFY(!gantt.addDependency(1, 4));
+    QVERIFY(model.getTask(0).getDependencies().isEmpty());
+
+    QVERIFY(gantt.removeDependency(4, 3));
+    QVERIFY(!gantt.removeDependency(4, 3));
+    QCOMPARE(start(gantt, 4), qint64(0));
+    QCOMPARE(gantt.projectEnd(), qint64(10));
+}
+
+void TestGantt::testTrashAndRestore()
+{
+    TaskModel model;
+    model.addTasks(plan());
+    GanttModel gantt;
+    gantt.attach(&model);
+
+    // Tasks in the trash are not scheduled; Build then only waits for Research
+    QVERIFY(model.removeTask(0));
+    QCOMPARE(gantt.count(), 3);
+    QCOMPARE(gantt.rowOfTask(1), -1);
+    QCOMPARE(start(gantt, 3), qint64(4));
+
+    QVERIFY(model.restoreTask(1));
+    QCOMPARE(gantt.count(), 4);
+    QCOMPARE(gantt.rowOfTask(1), 0);
+    QCOMPARE(start(gantt, 3), qint64(8));
+
+    model.clear();
+    QCOMPARE(gantt.count(), 0);
+    QCOMPARE(gantt.projectEnd(), qint64(0));
+}
+
+void TestGantt::testStoreRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    {
+        TaskModel model;
+        TaskStore store;
+        store.attach(&model);
+        QVERIFY(store.open(dir.path()));
+        model.addTasks(plan());
+        QVERIFY(store.save(true));
+    }
+
+    TaskModel model;
+    TaskStore store;
+    store.attach(&model);
+    GanttModel gantt;
+    gantt.attach(&model);
+    QVERIFY(store.open(dir.path()));
+    QCOMPARE(model.getTask(2).getEstimate(), 2);
+    QCOMPARE(model.getTask(2).getDependencies(), QList<quint64>({1, 2}));
+    QCOMPARE(gantt.projectEnd(), qint64(10));
+}
+
+void TestGantt::testAuditLog()
+{
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+    model.addTasks(plan());
+
+    model.setData(model.index(3), 6, TaskModel::EstimateRole);
+    model.setData(model.index(3), QVariant::fromValue(QList<quint64>{1}), TaskModel::DependenciesRole);
+
+    // Creation, initial estimate, then the two changes
+    const QList<AuditEntry> history = audit.history(4);
+    QCOMPARE(history.size(), 4);
+    QCOMPARE(history[1].field, int(AuditLog::Estimate));
+    QCOMPARE(history[1].value.toInt(), 5);
+    QCOMPARE(history[2].value.toInt(), 6);
+    QCOMPARE(history[3].field, int(AuditLog::Dependencies));
+    QCOMPARE(history[3].value.value<QList<quint64>>(), QList<quint64>({1}));
+
+    const QList<AuditEntry> build = audit.history(3);
+    QCOMPARE(build.size(), 3);
+    QCOMPARE(build[2].value.value<QList<quint64>>(), QList<quint64>({1, 2}));
+}
+
+QTEST_MAIN(TestGantt)
+#include "test_gantt.moc"
@@ -0,0 +1,225 @@
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "models/GlobalSearchModel.h"
+#include "models/TaskModel.h"
+#include "storage/TaskStore.h"
+
+class TestGlobalSearch : public QObject
+{
+    Q_OBJECT
+
+private:
+    static void writeStore(const QString &directory, const QList<TaskRecord> &records);
+    static GlobalSearchModel::Hit hit(int rank, const QString &title, const QString &workspace);
+    static QStringList titles(const GlobalSearchModel &search);
+
+private slots:
+    // Building block tests
+    void testMerge();
+    void testRank();
+
+    // Search tests
+    void testLoadedAndStoredWorkspaces();
+    void testNewQueryDropsStaleAnswers();
+    void testIndexFollowsStore();
+    void testSavedArena();
+};
+
+void TestGlobalSearch::writeStore(const QString &directory, const QList<TaskRecord> &records)
+{
+    QDir().mkpath(directory);
+    TaskModel model;
+    TaskStore store;
+    store.attach(&model);
+    QVERIFY(store.open(directory));
+    model.addTasks(records);
+    QVERIFY(store.save(true));
+}
+
+GlobalSearchModel::Hit TestGlobalSearch::hit(int rank, const QString &title, const QString &workspace)
+{
+    GlobalSearchModel::Hit hit;
+    hit.rank = rank;
+    hit.title = title;
+    hit.workspace = workspace;
+    return hit;
+}
+
+QStringList TestGlobalSearch::titles(const GlobalSearchModel &search)
+{
+    QStringList titles;
+    for (int row = 0; row < search.rowCount(); ++row)
+        titles.append(search.data(search.index(row), GlobalSearchModel::TitleRole).toString());
+    return titles;
+}
+
+void TestGlobalSearch::testMerge()
+{
+    const QList<QList<GlobalSearchModel::Hit>> lists = {
+        {hit(300, "a", "one"), hit(100, "d", "one")},
+        {},
+        {hit(300, "b", "three"), hit(200, "c", "three"), hit(50, "e", "three")},
+    };
+
+    QList<int> sources;
+    const QList<GlobalSearchModel::Hit> merged = GlobalSearchModel::merge(lists, 4, &sources);
+    QCOMPARE(merged.size(), 4);
+    QCOMPARE(merged[0].title, "a");
+    QCOMPARE(merged[1].title, "b");
+    QCOMPARE(merged[2].title, "c");
+    QCOMPARE(merged[3].title, "d");
+    QCOMPARE(sources, QList<int>({0, 2, 2, 0}));
+
+    // Equal ranks are ordered by title, then workspace
+    const QList<GlobalSearchModel::Hit> ties = GlobalSearchModel::merge({{hit(1, "x", "b")}, {hit(1, "X", "a")}}, 10);
+    QCOMPARE(ties[0].workspace, "a");
+}
+
+void TestGlobalSearch::testRank()
+{
+    const QString needle = QStringLiteral("Report").toCaseFolded();
+    const int prefix = GlobalSearchModel::rank(TaskRecord("Report numbers", ""), needle);
+    const int word = GlobalSearchModel::rank(TaskRecord("Send report", ""), needle);
+    const int inside = GlobalSearchModel::rank(TaskRecord("Misreported", ""), needle);
+    const int description = GlobalSearchModel::rank(TaskRecord("Numbers", "for the report"), needle);
+    QVERIFY(prefix > word);
+    QVERIFY(word > inside);
+    QVERIFY(inside > description);
+    QVERIFY(description > 0);
+    QCOMPARE(GlobalSearchModel::rank(TaskRecord("Unrelated", "text"), needle), 0);
+
+    // Priority raises, completion lowers
+    QVERIFY(GlobalSearchModel::rank(TaskRecord("Send report", "", 2), needle) > word);
+    QVERIFY(GlobalSearchModel::rank(TaskRecord("Send report", "", 1, true), needle) < word);
+}
+
+void TestGlobalSearch::testLoadedAndStoredWorkspaces()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeStore(dir.filePath("home"), {TaskRecord("Report taxes", ""), TaskRecord("Paint fence", "")});
+    writeStore(dir.filePath("work"), {TaskRecord("Quarterly report", "", 2), TaskRecord("Fix build", "see report")});
+    QDir(dir.path()).mkdir("not-a-store");
+
+    TaskModel loaded;
+    loaded.addTasks({TaskRecord("Report bug", "", 0), TaskRecord("Walk dog", "")});
+
+    GlobalSearchModel search;
+    search.addWorkspace("Tasks", &loaded);
+    QCOMPARE(search.addWorkspaces(dir.path()), 2);
+    QCOMPARE(search.workspaces(), QStringList({"Tasks", "home", "work"}));
+
+    QSignalSpy finished(&search, &GlobalSearchModel::finished);
+    QSignalSpy answered(&search, &GlobalSearchModel::workspaceAnswered);
+    search.search("  report ");
+    QCOMPARE(search.query(), "report");
+
+    // The loaded workspace answers at once, the stores later
+    QVERIFY(search.isSearching());
+    QCOMPARE(titles(search), QStringList({"Report bug"}));
+
+    QVERIFY(finished.wait());
+    QVERIFY(!search.isSearching());
+    QCOMPARE(answered.size(), 3);
+    QCOMPARE(titles(search), QStringList({"Report taxes", "Report bug", "Quarterly report", "Fix build"}));
+    QCOMPARE(search.data(search.index(0), GlobalSearchModel::WorkspaceRole).toString(), "home");
+    QCOMPARE(search.data(search.index(2), GlobalSearchModel::WorkspaceRole).toString(), "work");
+    QVERIFY(search.indexSize() > 0);
+
+    // Removing a workspace drops its results
+    search.removeWorkspace("work");
+    QCOMPARE(titles(search), QStringList({"Report taxes", "Report bug"}));
+
+    search.search("");
+    QCOMPARE(search.count(), 0);
+    QVERIFY(!search.isSearching());
+}
+
+void TestGlobalSearch::testNewQueryDropsStaleAnswers()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeStore(dir.filePath("store"), {TaskRecord("Apples", ""), TaskRecord("Pears", "")});
+
+    GlobalSearchModel search;
+    QVERIFY(search.addWorkspace("store", dir.filePath("store")));
+    QVERIFY(!search.addWorkspace("missing", dir.filePath("missing")));
+
+    QSignalSpy finished(&search, &GlobalSearchModel::finished);
+    search.search("apples");
+    search.search("pears");
+    QVERIFY(finished.wait());
+    QTest::qWait(50);
+    QCOMPARE(finished.size(), 1);
+    QCOMPARE(titles(search), QStringList({"Pears"}));
+}
+
+void TestGlobalSearch::testIndexFollowsStore()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString store = dir.filePath("store");
+    writeStore(store, {TaskRecord("Old plan", "")});
+
+    GlobalSearchModel search;
+    QVERIFY(search.addWorkspace("store", store));
+    QSignalSpy finished(&search, &GlobalSearchModel::finished);
+    search.search("plan");
+    QVERIFY(finished.wait());
+    QCOMPARE(titles(search), QStringList({"Old plan"}));
+
+    // A save rewrites the manifest, and the next query rebuilds the index
+    writeStore(store, {TaskRecord("New plan", "")});
+    search.search("plan");
+    QVERIFY(finished.wait());
+    QCOMPARE(titles(search), QStringList({"New plan", "Old plan"}));
+
+    // Released indexes are rebuilt on demand
+    QVERIFY(search.releaseIndexes() > 0);
+    QCOMPARE(search.indexSize(), qint64(0));
+    search.search("new");
+    QVERIFY(finished.wait());
+    QCOMPARE(titles(search), QStringList({"New plan"}));
+}
+
+void TestGlobalSearch::testSavedArena()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString store = dir.filePath("store");
+    QList<TaskRecord> records;
+    for (int i = 0; i < 1200; ++i)
+        records.append(TaskRecord(QString("Task %1").arg(i), i == 700 ? "Find the needle" : ""));
+    writeStore(store, records);
+
+    {
+        GlobalSearchModel search;
+        QVERIFY(search.addWorkspace("store", store));
+        QSignalSpy finished(&search, &GlobalSearchModel::finished);
+        search.search("needle");
+        QVERIFY(finished.wait());
+        QCOMPARE(titles(search), QStringList({"Task 700"}));
+    }
+    QVERIFY(QFile::exists(store + "/search.arena"));
+
+    // A later launch loads the arena and reads only the page of the match.
+    GlobalSearchModel search;
+    QVERIFY(search.addWorkspace("store", store));
+    QSignalSpy finished(&search, &GlobalSearchModel::finished);
+    search.search("needle");
+    QVERIFY(finished.wait());
+    QCOMPARE(titles(search), QStringList({"Task 700"}));
+    QCOMPARE(search.data(search.index(0), GlobalSearchModel::DescriptionRole).toString(), "Find the needle");
+
+    // The arena is ignored once the store is saved again.
+    writeStore(store, {TaskRecord("Another needle", "")});
+    search.search("needle");
+    QVERIFY(finished.wait());
+    QCOMPARE(titles(search), QStringList({"Another needle", "Task 700"}));
+}
+
+QTEST_MAIN(TestGlobalSearch)
+#include "test_global_search.moc"
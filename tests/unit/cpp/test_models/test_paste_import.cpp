@@ -0,0 +1,119 @@
+#include <QTest>
+#include <QSignalSpy>
+#include "models/PasteImportModel.h"
+#include "models/TaskModel.h"
+
+class TestPasteImport : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Preview tests
+    void testPreview();
+    void testLaterTextWins();
+    void testDefaultPriority();
+
+    // Commit tests
+    void testCommitIsOneInsert();
+    void testCommitWhileParsing();
+};
+
+void TestPasteImport::testPreview()
+{
+    PasteImportModel preview;
+    QSignalSpy parsed(&preview, &PasteImportModel::parsed);
+    preview.setText("- Book flights !!! @ana #travel\n- [x] Renew passport\n");
+    QVERIFY(preview.isParsing());
+    QVERIFY(parsed.wait());
+    QVERIFY(!preview.isParsing());
+
+    QCOMPARE(preview.count(), 2);
+    QCOMPARE(preview.data(preview.index(0), PasteImportModel::TitleRole).toString(), QString("Book flights"));
+    QCOMPARE(preview.data(preview.index(0), PasteImportModel::PriorityRole).toInt(), int(Task::High));
+    QCOMPARE(preview.data(preview.index(0), PasteImportModel::AssigneeRole).toString(), QString("ana"));
+    QCOMPARE(preview.data(preview.index(0), PasteImportModel::TagsRole).toStringList(), QStringList({"travel"}));
+    QVERIFY(preview.data(preview.index(1), PasteImportModel::CompletedRole).toBool());
+    QCOMPARE(preview.data(preview.index(1), PasteImportModel::LineRole).toInt(), 2);
+
+    QVERIFY(preview.removeEntry(0));
+    QVERIFY(!preview.removeEntry(1));
+    QCOMPARE(preview.count(), 1);
+
+    preview.clear();
+    QCOMPARE(preview.count(), 0);
+}
+
+void TestPasteImport::testLaterTextWins()
+{
+    PasteImportModel preview;
+    QSignalSpy parsed(&preview, &PasteImportModel::parsed);
+    preview.setText("First\nSecond\n");
+    preview.setText("Third\n");
+    QVERIFY(parsed.wait());
+    QTest::qWait(20);
+
+    // The first parse is dropped
+    QCOMPARE(parsed.count(), 1);
+    QCOMPARE(preview.count(), 1);
+    QCOMPARE(preview.data(preview.index(0), PasteImportModel::TitleRole).toString(), QString("Third"));
+}
+
+void TestPasteImport::testDefaultPriority()
+{
+    PasteImportModel preview;
+    QSignalSpy parsed(&preview, &PasteImportModel::parsed);
+    preview.setText("Marked !\nUnmarked\n");
+    QVERIFY(parsed.wait());
+    QCOMPARE(preview.data(preview.index(1), PasteImportModel::PriorityRole).toInt(), int(Task::Medium));
+
+    QSignalSpy changed(&preview, &PasteImportModel::dataChanged);
+    preview.setDefaultPriority(Task::High);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(preview.data(preview.index(0), PasteImportModel::PriorityRole).toInt(), int(Task::Low));
+    QCOMPARE(preview.data(preview.index(1), PasteImportModel::PriorityRole).toInt(), int(Task::High));
+}
+
+void TestPasteImport::testCommitIsOneInsert()
+{
+    TaskModel model;
+    PasteImportModel preview;
+    preview.attach(&model);
+
+    QString text;
+    for (int i = 0; i < 5000; ++i)
+        text += QStringLiteral("Item %1\t%2 @ana\n").arg(i).arg(i % 7);
+    QSignalSpy parsed(&preview, &PasteImportModel::parsed);
+    preview.setText(text);
+    QVERIFY(parsed.wait(5000));
+    QCOMPARE(preview.count(), 5000);
+
+    QSignalSpy inserted(&model, &TaskModel::rowsInserted);
+    QSignalSpy committed(&preview, &PasteImportModel::committed);
+    QCOMPARE(preview.commit(), 5000);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(committed.count(), 1);
+    QCOMPARE(model.rowCount(), 5000);
+    QCOMPARE(model.getTask(4999).getTitle(), QString("Item 4999"));
+    QCOMPARE(model.getTask(4999).getDescription(), QString("1 @ana"));
+    QCOMPARE(preview.count(), 0);
+}
+
+void TestPasteImport::testCommitWhileParsing()
+{
+    TaskModel model;
+    PasteImportModel preview;
+    preview.attach(&model);
+
+    QSignalSpy parsed(&preview, &PasteImportModel::parsed);
+    preview.setText("Done? [x] no\n- [x] Done\n");
+    QCOMPARE(preview.commit(), 0);
+    QVERIFY(parsed.wait());
+
+    QCOMPARE(preview.commit(), 2);
+    QVERIFY(!model.getTask(0).getCompleted());
+    QVERIFY(model.getTask(1).getCompleted());
+    QVERIFY(model.getTask(1).getCompletedAt().isValid());
+}
+
+QTEST_MAIN(TestPasteImport)
+#include "test_paste_import.moc"
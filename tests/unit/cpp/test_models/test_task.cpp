@@ -1,6 +1,7 @@
 #include <QTest>
 #include <QSignalSpy>
 #include "models/Task.h"
+#include "models/TaskModel.h"
 
 class TestTask : public QObject
 {
@@ -21,6 +22,7 @@ private slots:
     // Property validation tests
     void testSetTitle();
     void testSetDescription();
+    void testEditDescription();
     void testSetCompleted();
     void testSetPriority();
 
@@ -29,6 +31,13 @@ private slots:
     void testPriorityString();
     void testPriorityStringData();
 
+    // Record tests
+    void testRecordSnapshot();
+    void testRecordIsSharedUntilChanged();
+    void testTaskFromRecord();
+    void testModelRefreshesRecord();
+    void testBatchPriorityFollowsRows();
+
 private:
     Task *task;
 };
@@ -134,10 +143,43 @@ void TestTask::testSetDescription()
     task->setDescription("Test Description");
     QCOMPARE(task->getDescription(), "Test Description");
 
+    // Only the span that differs is reported as edited
+    QSignalSpy editedSpy(task, &Task::descriptionEdited);
+    task->setDescription("Test the Description");
+    QCOMPARE(task->getDescription(), "Test the Description");
+    QCOMPARE(editedSpy.count(), 1);
+    QCOMPARE(editedSpy.first().at(0).toInt(), 5);
+    QCOMPARE(editedSpy.first().at(1).toInt(), 0);
+    QCOMPARE(editedSpy.first().at(2).toInt(), 4);
+
     task->setDescription("");
     QCOMPARE(task->getDescription(), "");
 }
 
+void TestTask::testEditDescription()
+{
+    task->setDescription("Step one\nStep two");
+    QSignalSpy editedSpy(task, &Task::descriptionEdited);
+    QSignalSpy changedSpy(task, &Task::descriptionChanged);
+
+    task->editDescription(5, 3, "1");
+    QCOMPARE(task->getDescription(), "Step 1\nStep two");
+    QCOMPARE(editedSpy.count(), 1);
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(editedSpy.first().at(0).toInt(), 5);
+    QCOMPARE(editedSpy.first().at(1).toInt(), 3);
+    QCOMPARE(editedSpy.first().at(2).toInt(), 1);
+
+    QCOMPARE(task->descriptionLineCount(), 2);
+    QCOMPARE(task->descriptionLineStart(1), 7);
+    QCOMPARE(task->descriptionLineAt(9), 1);
+    QCOMPARE(task->descriptionText(7, 4), "Step");
+
+    // Empty edits are ignored
+    task->editDescription(0, 0, "");
+    QCOMPARE(editedSpy.count(), 1);
+}
+
 void TestTask::testSetCompleted()
 {
     task->setCompleted(true);
@@ -200,5 +242,87 @@ void TestTask::testPriorityStringData()
     QTest::newRow("High") << static_cast<int>(Task::High) << "High";
 }
 
+void TestTask::testRecordSnapshot()
+{
+    task->setTitle("Snapshot Title");
+    task->setPriority(Task::High);
+
+    TaskRecord record = task->record();
+    QVERIFY(!record.isNull());
+    QCOMPARE(record.getTitle(), "Snapshot Title");
+    QCOMPARE(record.getPriority(), Task::High);
+    QCOMPARE(record.getDateTime(), task->getDateTime());
+    QCOMPARE(record.priorityString(), "High");
+
+    // The record is a value and does not follow later modifications
+    task->setTitle("Changed Title");
+    QCOMPARE(record.getTitle(), "Snapshot Title");
+    QCOMPARE(task->record().getTitle(), "Changed Title");
+
+    QVERIFY(TaskRecord().isNull());
+    QVERIFY(!TaskRecord().isValid());
+}
+
+void TestTask::testRecordIsSharedUntilChanged()
+{
+    task->setTitle("Shared");
+
+    TaskRecord first = task->record();
+    TaskRecord second = task->record();
+    QCOMPARE(first, second);
+
+    task->setCompleted(true);
+    QVERIFY(task->record() != first);
+    QVERIFY(task->record().getCompleted());
+}
+
+void TestTask::testTaskFromRecord()
+{
+    const QDateTime created = QDateTime::currentDateTime().addDays(-3);
+    Task restored(TaskRecord("Restored", "From record", Task::Low, true, created));
+
+    QCOMPARE(restored.getTitle(), "Restored");
+    QCOMPARE(restored.getDescription(), "From record");
+    QCOMPARE(restored.getPriority(), Task::Low);
+    QCOMPARE(restored.getCompleted(), true);
+    QCOMPARE(restored.getDateTime(), created);
+
+    Task stamped(TaskRecord("Stamped"));
+    QVERIFY(stamped.getDateTime().isValid());
+}
+
+void TestTask::testModelRefreshesRecord()
+{
+    TaskModel model;
+    model.addTask("Record", "Shown by delegates");
+    QSignalSpy changed(&model, &TaskModel::dataChanged);
+
+    QVERIFY(model.setData(model.index(0), "Renamed", TaskModel::TitleRole));
+    model.toggleCompleted(0);
+    QCOMPARE(changed.count(), 2);
+    for (const QList<QVariant> &arguments : std::as_const(changed))
+        QVERIFY(arguments.at(2).value<QList<int>>().contains(TaskModel::RecordRole));
+    QCOMPARE(model.data(model.index(0), TaskModel::RecordRole).value<TaskRecord>().getTitle(), "Renamed");
+}
+
+void TestTask::testBatchPriorityFollowsRows()
+{
+    TaskModel model;
+    for (int i = 0; i < 6; ++i)
+        model.addTask(QString("Task %1").arg(i));
+    const quint64 last = model.taskId(5);
+    const quint64 fourth = model.taskId(3);
+    QCOMPARE(model.removeTasks({model.taskId(0), model.taskId(2)}), 2);
+    QCOMPARE(model.indexOfTask(last), 3);
+    QCOMPARE(model.indexOfTask(fourth), 1);
+
+    QSignalSpy changed(&model, &TaskModel::dataChanged);
+    QCOMPARE(model.setTasksPriority({last, fourth, last}, Task::High), 2);
+    QCOMPARE(changed.count(), 2);
+    QCOMPARE(changed.at(0).at(0).toModelIndex().row(), 1);
+    QVERIFY(changed.at(0).at(2).value<QList<int>>().contains(TaskModel::RecordRole));
+    QCOMPARE(model.getTask(3).getPriority(), int(Task::High));
+}
+
 QTEST_MAIN(TestTask)
 #include "test_task.moc"
@@ -0,0 +1,194 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include "models/TaskModel.h"
+#include "models/TaskTemplate.h"
+#include "storage/TemplateLibrary.h"
+
+class TestTaskTemplate : public QObject
+{
+    Q_OBJECT
+
+private:
+    static TaskTemplate onboarding();
+    static TaskTemplate checklist(int items);
+
+private slots:
+    // Template tests
+    void testInterning();
+    void testInstantiate();
+    void testMissingValue();
+    void testOutline();
+
+    // Library tests
+    void testLibraryInstantiate();
+    void testAllOrNone();
+    void testSaveAndOpen();
+};
+
+TaskTemplate TestTaskTemplate::onboarding()
+{
+    TaskTemplate::Prototype laptop{"Set up a laptop for {{name}}", "Ask {{team}} for the model", 2, "it", 2, {}};
+    TaskTemplate::Prototype accounts{"Create accounts for {{name}}", "Mail, chat and {{team}} repositories", 1, "it", 1, {}};
+    TaskTemplate::Prototype root{"Onboard {{name}}", QString(), 1, "{{manager}}", 0, {laptop, accounts}};
+    return TaskTemplate("Onboarding", {root});
+}
+
+TaskTemplate TestTaskTemplate::checklist(int items)
+{
+    // Release items sharing a handful of descriptions
+    QList<TaskTemplate::Prototype> prototypes;
+    for (int i = 0; i < items; ++i)
+        prototypes.append({QStringLiteral("Check %1 for {{release}}").arg(i), QStringLiteral("Area %1").arg(i % 4), 1, QString(), 0, {}});
+    return TaskTemplate("Release", prototypes);
+}
+
+void TestTaskTemplate::testInterning()
+{
+    const TaskTemplate release = checklist(200);
+    QCOMPARE(release.size(), 200);
+    QCOMPARE(release.variables(), QStringList({"release"}));
+
+    // 200 distinct title prefixes and 4 shared descriptions
+    QCOMPARE(release.internedCount(), 204);
+
+    const QList<TaskTemplate::Prototype> prototypes = release.prototypes();
+    QCOMPARE(prototypes.size(), 200);
+    QCOMPARE(prototypes[7].title, QString("Check 7 for {{release}}"));
+    QCOMPARE(prototypes[7].description, QString("Area 3"));
+}
+
+void TestTaskTemplate::testInstantiate()
+{
+    const TaskTemplate plan = onboarding();
+    QCOMPARE(plan.variables(), QStringList({"name", "manager", "team"}));
+
+    QList<TaskRecord> records;
+    QVERIFY(plan.instantiate({{"name", "Ana"}, {"manager", "Lee"}, {"team", "Platform"}}, 10, &records));
+    QCOMPARE(records.size(), 3);
+
+    // Preorder ids; the root waits for its children
+    QCOMPARE(records[0].getId(), quint64(10));
+    QCOMPARE(records[0].getTitle(), QString("Onboard Ana"));
+    QCOMPARE(records[0].getAssignee(), QString("Lee"));
+    QCOMPARE(records[0].getDependencies(), QList<quint64>({11, 12}));
+    QCOMPARE(records[1].getTitle(), QString("Set up a laptop for Ana"));
+    QCOMPARE(records[1].getDescription(), QString("Ask Platform for the model"));
+    QCOMPARE(records[1].getPriority(), 2);
+    QCOMPARE(records[1].getEstimate(), 2);
+    QVERIFY(records[1].getDependencies().isEmpty());
+    QCOMPARE(records[2].getId(), quint64(12));
+}
+
+void TestTaskTemplate::testMissingValue()
+{
+    QList<TaskRecord> records;
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("no value for"));
+    QVERIFY(!onboarding().instantiate({{"name", "Ana"}}, 1, &records));
+    QVERIFY(records.isEmpty());
+}
+
+void TestTaskTemplate::testOutline()
+{
+    const TaskTemplate plan = TaskTemplate::fromOutline("Trip",
+        "Plan the trip to {{city}}\n"
+        "    Book travel\n"
+        "\tBook a hotel\n"
+        "        Compare prices\n"
+        "\n"
+        "Pack\n");
+    QCOMPARE(plan.size(), 5);
+
+    const QList<TaskTemplate::Prototype> roots = plan.prototypes();
+    QCOMPARE(roots.size(), 2);
+    QCOMPARE(roots[0].children.size(), 2);
+    QCOMPARE(roots[0].children[1].title, QString("Book a hotel"));
+    QCOMPARE(roots[0].children[1].children.size(), 1);
+    QCOMPARE(roots[1].title, QString("Pack"));
+    QVERIFY(roots[1].children.isEmpty());
+}
+
+void TestTaskTemplate::testLibraryInstantiate()
+{
+    TaskModel model;
+    model.addTask("Existing");
+    TemplateLibrary library;
+    library.attach(&model);
+    QVERIFY(library.addTemplate(checklist(200)));
+
+    QSignalSpy inserted(&model, &TaskModel::rowsInserted);
+    QSignalSpy instantiated(&library, &TemplateLibrary::instantiated);
+    QCOMPARE(library.instantiate("Release", {{"release", "2.0"}}), 200);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(model.rowCount(), 201);
+    QCOMPARE(model.data(model.index(200), TaskModel::TitleRole).toString(), QString("Check 199 for 2.0"));
+
+    // The reserved ids are not handed out again
+    QCOMPARE(instantiated.count(), 1);
+    const quint64 firstId = instantiated.first().at(1).toULongLong();
+    QCOMPARE(model.getTask(1).getId(), firstId);
+    QVERIFY(model.addTask("After"));
+    QCOMPARE(model.getTask(201).getId(), firstId + 200);
+
+    QCOMPARE(library.instantiate("Unknown", {}), -1);
+}
+
+void TestTaskTemplate::testAllOrNone()
+{
+    TaskModel model;
+    TemplateLibrary library;
+    library.attach(&model);
+    QVERIFY(library.addOutline("Review", "Review {{change}}\n    {{test}}\n"));
+
+    // The second task would have an empty title, so neither is added
+    QSignalSpy inserted(&model, &TaskModel::rowsInserted);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("without a title"));
+    QCOMPARE(library.instantiate("Review", {{"change", "the parser"}, {"test", ""}}), -1);
+    QCOMPARE(inserted.count(), 0);
+    QCOMPARE(model.rowCount(), 0);
+
+    QCOMPARE(library.instantiate("Review", {{"change", "the parser"}, {"test", "Run the tests"}}), 2);
+    QCOMPARE(model.rowCount(), 2);
+}
+
+void TestTaskTemplate::testSaveAndOpen()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString file = dir.filePath("templates.lib");
+
+    {
+        TemplateLibrary library;
+        QVERIFY(library.open(file));
+        QVERIFY(library.names().isEmpty());
+        QVERIFY(library.addTemplate(onboarding()));
+        QVERIFY(library.addTemplate(checklist(20)));
+        QVERIFY(library.removeTemplate("Release"));
+        QVERIFY(library.addOutline("Trip", "Pack\n    Socks\n"));
+    }
+
+    TemplateLibrary library;
+    QSignalSpy changed(&library, &TemplateLibrary::templatesChanged);
+    QVERIFY(library.open(file));
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(library.names(), QStringList({"Onboarding", "Trip"}));
+    QCOMPARE(library.variables("Onboarding"), QStringList({"name", "manager", "team"}));
+
+    const TaskTemplate plan = library.find("Onboarding");
+    QCOMPARE(plan.size(), 3);
+    QCOMPARE(plan.internedCount(), onboarding().internedCount());
+    QCOMPARE(plan.prototypes().first().children.first().description, QString("Ask {{team}} for the model"));
+
+    // A file that is not a library is refused
+    QFile other(dir.filePath("other.lib"));
+    QVERIFY(other.open(QIODevice::WriteOnly));
+    other.write("not a library");
+    other.close();
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("is not a template library"));
+    QVERIFY(!library.open(other.fileName()));
+    QCOMPARE(library.names().size(), 2);
+}
+
+QTEST_MAIN(TestTaskTemplate)
+#include "test_task_template.moc"
@@ -0,0 +1,243 @@
+#include <QTest>
+#include <QSignalSpy>
+#include "models/ActiveTaskModel.h"
+#include "models/TaskModel.h"
+#include "models/TrashModel.h"
+#include "history/AuditLog.h"
+
+class TestTrash : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QStringList titles(const QAbstractItemModel &model);
+
+private slots:
+    // Delete tests
+    void testDeleteRemovesRow();
+    void testDeleteTombstones();
+    void testClearCompleted();
+
+    // Restore tests
+    void testRestore();
+    void testRestoreCompacted();
+
+    // Compaction and purge tests
+    void testCompaction();
+    void testPurge();
+    void testAuditLog();
+};
+
+QStringList TestTrash::titles(const QAbstractItemModel &model)
+{
+    QStringList result;
+    for (int row = 0; row < model.rowCount(); ++row)
+        result.append(model.data(model.index(row, 0), TaskModel::TitleRole).toString());
+    return result;
+}
+
+void TestTrash::testDeleteRemovesRow()
+{
+    TaskModel model;
+    model.setCompactionDeferred(false);
+    model.addTasks({TaskRecord("First"), TaskRecord("Second"), TaskRecord("Third")});
+
+    QSignalSpy removed(&model, &TaskModel::rowsRemoved);
+    QVERIFY(model.removeTask(1));
+
+    // Without deferred compaction, rows are the live tasks.
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.tombstoneCount(), 0);
+    QCOMPARE(model.getTask(1).getTitle(), "Third");
+    QCOMPARE(model.trash()->count(), 1);
+
+    // Turning deferral off compacts what is left
+    model.setCompactionDeferred(true);
+    QVERIFY(model.removeTask(0));
+    QCOMPARE(model.tombstoneCount(), 1);
+    model.setCompactionDeferred(false);
+    QCOMPARE(model.tombstoneCount(), 0);
+    QCOMPARE(titles(model), QStringList({"Third"}));
+}
+
+void TestTrash::testDeleteTombstones()
+{
+    TaskModel model;
+    ActiveTaskModel active(&model);
+    model.addTasks({TaskRecord("First"), TaskRecord("Second"), TaskRecord("Third")});
+
+    QSignalSpy removed(&model, &TaskModel::rowsRemoved);
+    QSignalSpy changed(&model, &TaskModel::dataChanged);
+    QSignalSpy count(&model, &TaskModel::countChanged);
+    QVERIFY(model.removeTask(1));
+    QVERIFY(!model.removeTask(1));
+
+    // The row stays as a tombstone; only the proxy drops it.
+    QCOMPARE(removed.count(), 0);
+    QCOMPARE(changed.count(), 1);
+    QVERIFY(changed.at(0).at(2).value<QList<int>>().contains(TaskModel::DeletedRole));
+    QCOMPARE(count.count(), 1);
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.count(), 2);
+    QCOMPARE(model.tombstoneCount(), 1);
+    QVERIFY(model.isDeleted(1));
+    QVERIFY(model.data(model.index(1), TaskModel::DeletedAtRole).toDateTime().isValid());
+    QCOMPARE(titles(active), QStringList({"First", "Third"}));
+    QCOMPARE(active.sourceRow(1), 2);
+
+    // Tombstones are read-only and not found
+    QVERIFY(!model.setData(model.index(1), "Renamed", TaskModel::TitleRole));
+    model.toggleCompleted(1);
+    QVERIFY(!model.getTask(1).getCompleted());
+    QCOMPARE(model.findTasks("second"), QList<int>());
+    QCOMPARE(model.indexOfTask(model.taskId(1)), -1);
+
+    QCOMPARE(model.trash()->count(), 1);
+    QCOMPARE(model.trash()->getTask(0).getTitle(), "Second");
+}
+
+void TestTrash::testClearCompleted()
+{
+    TaskModel model;
+    model.addTasks({TaskRecord("A", QString(), Task::Low, true), TaskRecord("B", QString(), Task::Low, true),
+                    TaskRecord("C"), TaskRecord("D", QString(), Task::Low, true)});
+
+    QSignalSpy changed(&model, &TaskModel::dataChanged);
+    QSignalSpy count(&model, &TaskModel::countChanged);
+    model.clearCompleted();
+
+    // One notification per run of rows: A-B and D
+    QCOMPARE(changed.count(), 2);
+    QCOMPARE(count.count(), 1);
+    QCOMPARE(model.count(), 1);
+
+    // Latest deletion first; the batch was deleted in row order.
+    QCOMPARE(titles(*model.trash()), QStringList({"D", "B", "A"}));
+}
+
+void TestTrash::testRestore()
+{
+    TaskModel model;
+    model.addTasks({TaskRecord("First"), TaskRecord("Second"), TaskRecord("Third")});
+    const quint64 id = model.taskId(0);
+    model.removeTask(0);
+
+    QSignalSpy inserted(&model, &TaskModel::rowsInserted);
+    QSignalSpy removed(&model, &TaskModel::rowsRemoved);
+    QSignalSpy changed(&model, &TaskModel::dataChanged);
+    QVERIFY(model.restoreTask(id));
+    QVERIFY(!model.restoreTask(id));
+
+    // A tombstone still in place is lifted where it is
+    QCOMPARE(inserted.count(), 0);
+    QCOMPARE(removed.count(), 0);
+    QCOMPARE(changed.count(), 1);
+    QVERIFY(changed.at(0).at(2).value<QList<int>>().contains(TaskModel::DeletedRole));
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.tombstoneCount(), 0);
+    QCOMPARE(titles(model), QStringList({"First", "Second", "Third"}));
+    QCOMPARE(model.taskId(0), id);
+    QVERIFY(!model.isDeleted(0));
+    QCOMPARE(model.trash()->count(), 0);
+    QCOMPARE(model.findTasks("first"), QList<int>({0}));
+}
+
+void TestTrash::testRestoreCompacted()
+{
+    TaskModel model;
+    model.addTasks({TaskRecord("First"), TaskRecord("Second")});
+    model.removeTask(0);
+    QCOMPARE(model.compactTombstones(), 1);
+    QCOMPARE(titles(model), QStringList({"Second"}));
+
+    QVERIFY(model.trash()->restore(0));
+    QCOMPARE(titles(model), QStringList({"Second", "First"}));
+    QCOMPARE(model.count(), 2);
+}
+
+void TestTrash::testCompaction()
+{
+    TaskModel model;
+    QList<TaskRecord> records;
+    for (int i = 0; i < 100; ++i)
+        records.append(TaskRecord(QString("Task %1").arg(i)));
+    model.addTasks(records);
+
+    // Two runs of ten tombstones
+    for (int row = 10; row < 20; ++row)
+        model.removeTask(row);
+    for (int row = 50; row < 60; ++row)
+        model.removeTask(row);
+
+    QSignalSpy removed(&model, &TaskModel::rowsRemoved);
+    QSignalSpy count(&model, &TaskModel::countChanged);
+    QCOMPARE(model.compactTombstones(15), 15);
+    QCOMPARE(removed.count(), 2);
+    QCOMPARE(model.tombstoneCount(), 5);
+
+    // The rest goes in the background
+    QTRY_COMPARE_WITH_TIMEOUT(model.tombstoneCount(), 0, TaskModel::CompactionDelay + 2000);
+    QCOMPARE(model.rowCount(), 80);
+    QCOMPARE(count.count(), 0);
+    QCOMPARE(model.trash()->count(), 20);
+    QCOMPARE(model.getTask(10).getTitle(), "Task 20");
+    QCOMPARE(model.findTasks("task 2"), QList<int>({2, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19}));
+}
+
+void TestTrash::testPurge()
+{
+    TaskModel model;
+    model.addTasks({TaskRecord("A"), TaskRecord("B"), TaskRecord("C"), TaskRecord("D")});
+    model.removeTask(0);
+    model.removeTask(1);
+    model.removeTask(3);
+    model.compactTombstones(1); // D is compacted, A and B are still rows
+
+    QSignalSpy removed(&model, &TaskModel::rowsRemoved);
+    QSignalSpy reset(model.trash(), &TrashModel::modelReset);
+    QSignalSpy count(&model, &TaskModel::countChanged);
+    QCOMPARE(model.emptyTrash(), 3);
+
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(reset.count(), 1);
+    QCOMPARE(count.count(), 0); // no live task was removed
+    QCOMPARE(titles(model), QStringList({"C"}));
+    QCOMPARE(model.tombstoneCount(), 0);
+    QCOMPARE(model.trash()->count(), 0);
+
+    // removeTasks() deletes live tasks and trash entries alike
+    model.addTask("E");
+    model.removeTask(1);
+    QCOMPARE(model.removeTasks({model.taskId(0), model.taskId(1)}), 2);
+    QCOMPARE(model.rowCount(), 0);
+    QCOMPARE(model.trash()->count(), 0);
+}
+
+void TestTrash::testAuditLog()
+{
+    TaskModel model;
+    AuditLog audit;
+    audit.attach(&model);
+
+    model.addTask("Draft");
+    const quint64 id = model.taskId(0);
+    model.removeTask(0);
+    model.compactTombstones();
+    model.restoreTask(id);
+    model.removeTask(0);
+    model.emptyTrash();
+
+    // Compaction and purging a deleted task are not changes of the task list.
+    const QList<AuditEntry> history = audit.history(id);
+    QCOMPARE(history.size(), 4);
+    QCOMPARE(history[0].field, int(AuditLog::Created));
+    QCOMPARE(history[1].field, int(AuditLog::Removed));
+    QCOMPARE(history[2].field, int(AuditLog::Restored));
+    QCOMPARE(history[2].value.value<TaskRecord>().getTitle(), "Draft");
+    QVERIFY(history[2].appended);
+    QCOMPARE(history[3].field, int(AuditLog::Removed));
+}
+
+QTEST_MAIN(TestTrash)
+#include "test_trash.moc"
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTest>
+#include "models/TaskModel.h"
+
+
+/**
+ * @file FileTestHelpers.h
+ * @brief Helpers shared by the tests that sync tasks with files on disk
+ */
+
+/**
+ * @brief Writes a file, creating its directory, and backdates its modification time
+ * @param path Path of the file
+ * @param content Bytes of the file
+ * @param ageSeconds How long ago the file was modified
+ *
+ * Fails the calling test if the file cannot be written.
+ */
+inline void writeFile(const QString &path, const QByteArray &content, int ageSeconds = 60)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(file.write(content), content.size());
+    // Old enough for the cache to trust mtime and size.
+    QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(-ageSeconds), QFileDevice::FileModificationTime));
+}
+
+/**
+ * @brief Finds the row of a live task by its title
+ * @return The first matching row, or -1 if none
+ */
+inline int rowOf(const TaskModel &model, const QString &title)
+{
+    for (int row = 0; row < model.rowCount(); ++row)
+    {
+        if (!model.isDeleted(row) && model.getTask(row).getTitle() == title)
+            return row;
+    }
+    return -1;
+}
@@ -0,0 +1,118 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "models/ActiveTaskModel.h"
+#include "models/TaskModel.h"
+#include "storage/FirstPaintCache.h"
+
+class TestFirstPaintCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRoundTrip();
+    void testTopOfList();
+    void testRelease();
+    void testMissingOrDamaged();
+};
+
+void TestFirstPaintCache::testRoundTrip()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("firstpaint.cache");
+
+    TaskModel model;
+    ActiveTaskModel active(&model);
+    QList<TaskRecord> records;
+    for (int i = 0; i < 500; ++i)
+        records.append(TaskRecord(QString("Task %1").arg(i), QString(), Task::Low, i % 5 == 0));
+    model.addTasks(records);
+    model.removeTask(0);
+
+    FirstPaintCache saved;
+    saved.setViewport(100, 12.5, 8);
+    QVERIFY(saved.save(fileName, &active, 499, 99));
+
+    // The visible rows and the one above them, in display order
+    FirstPaintCache cache;
+    QSignalSpy activeChanged(&cache, &FirstPaintCache::activeChanged);
+    QVERIFY(cache.load(fileName));
+    QCOMPARE(activeChanged.count(), 1);
+    QVERIFY(cache.isActive());
+    QCOMPARE(cache.model()->rowCount(), 9);
+    QCOMPARE(cache.model()->getTask(0).getTitle(), "Task 100");
+    QCOMPARE(cache.model()->getTask(1).getTitle(), "Task 101");
+    QVERIFY(cache.model()->getTask(0).getCompleted());
+    QCOMPARE(cache.cachedRow(), 1);
+    QCOMPARE(cache.firstRow(), 100);
+    QCOMPARE(cache.rowOffset(), 12.5);
+    QCOMPARE(cache.totalTasks(), 499);
+    QCOMPARE(cache.completedTasks(), 99);
+    QCOMPARE(cache.pendingTasks(), 400);
+}
+
+void TestFirstPaintCache::testTopOfList()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("firstpaint.cache");
+
+    TaskModel model;
+    QList<TaskRecord> records;
+    for (int i = 0; i < 200; ++i)
+        records.append(TaskRecord(QString("Task %1").arg(i)));
+    model.addTasks(records);
+
+    // Without a reported viewport the top MaxRows rows are saved
+    FirstPaintCache saved;
+    QVERIFY(saved.save(fileName, &model, 200, 0));
+
+    FirstPaintCache cache;
+    QVERIFY(cache.load(fileName));
+    QCOMPARE(cache.model()->rowCount(), FirstPaintCache::MaxRows);
+    QCOMPARE(cache.cachedRow(), 0);
+    QCOMPARE(cache.firstRow(), 0);
+    QCOMPARE(cache.rowOffset(), 0.0);
+}
+
+void TestFirstPaintCache::testRelease()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("firstpaint.cache");
+    TaskModel model;
+    model.addTasks({TaskRecord("First"), TaskRecord("Second"), TaskRecord("Third")});
+    FirstPaintCache saved;
+    saved.setViewport(2, 0, 1);
+    saved.save(fileName, &model, 3, 0);
+
+    FirstPaintCache cache;
+    cache.load(fileName);
+    QSignalSpy activeChanged(&cache, &FirstPaintCache::activeChanged);
+    cache.release();
+    cache.release();
+
+    // The view position outlives the rows
+    QCOMPARE(activeChanged.count(), 1);
+    QVERIFY(!cache.isActive());
+    QCOMPARE(cache.model()->rowCount(), 0);
+    QCOMPARE(cache.firstRow(), 2);
+}
+
+void TestFirstPaintCache::testMissingOrDamaged()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("firstpaint.cache");
+
+    FirstPaintCache cache;
+    QVERIFY(!cache.load(fileName));
+    QVERIFY(!cache.isActive());
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("not a cache");
+    file.close();
+    QVERIFY(!cache.load(fileName));
+    QVERIFY(!cache.isActive());
+}
+
+QTEST_MAIN(TestFirstPaintCache)
+#include "test_first_paint_cache.moc"
@@ -0,0 +1,307 @@
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTimeZone>
+#include "models/TaskModel.h"
+#include "storage/FolderSync.h"
+#include "FileTestHelpers.h"
+
+class TestFolderSync : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QByteArray readFile(const QString &path);
+    static int rescan(FolderSync &sync);
+
+private slots:
+    // File format tests
+    void testParseMarkdown();
+    void testParseICalendar();
+    void testWriteKeepsForeignFields();
+
+    // Sync tests
+    void testImport();
+    void testRescanOnlyChanged();
+    void testRemoteDeleteAndRename();
+    void testLocalEdits();
+    void testCacheAcrossSessions();
+};
+
+QByteArray TestFolderSync::readFile(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+int TestFolderSync::rescan(FolderSync &sync)
+{
+    QSignalSpy scanned(&sync, &FolderSync::scanned);
+    sync.scan();
+    sync.waitForScan();
+    return scanned.isEmpty() ? -1 : scanned.last().at(0).toInt();
+}
+
+void TestFolderSync::testParseMarkdown()
+{
+    TaskFile file;
+    QVERIFY(TaskFile::parse("---\nuid: abc\npriority: high\ncompleted: 2024-03-01T09:30:00Z\ntags: [home]\n---\n\n"
+                            "# Renew the passport\n\nPhotos are in the drawer.\nSecond line.\n",
+                            TaskFile::Markdown, file));
+    QCOMPARE(file.uid, "abc");
+    QCOMPARE(file.title, "Renew the passport");
+    QCOMPARE(file.description, "Photos are in the drawer.\nSecond line.");
+    QCOMPARE(file.priority, 2);
+    QVERIFY(file.completed);
+    QCOMPARE(file.completedAt, QDateTime(QDate(2024, 3, 1), QTime(9, 30), QTimeZone::UTC));
+
+    // Plain notes without front matter or heading
+    QVERIFY(TaskFile::parse("just some text\n", TaskFile::Markdown, file));
+    QVERIFY(file.title.isEmpty());
+    QCOMPARE(file.description, "just some text");
+    QCOMPARE(file.priority, 1);
+    QVERIFY(!file.completed);
+}
+
+void TestFolderSync::testParseICalendar()
+{
+    TaskFile file;
+    QVERIFY(TaskFile::parse("BEGIN:VCALENDAR\r\nVERSION:2.0\r\nBEGIN:VTODO\r\nUID:todo-1@example.com\r\n"
+                            "SUMMARY:Call\\, then write\r\nDESCRIPTION:First line\\nsecond line that is folded\r\n"
+                            "  across two lines\r\nPRIORITY:9\r\nSTATUS:COMPLETED\r\nCOMPLETED:20240301T093000Z\r\n"
+                            "END:VTODO\r\nEND:VCALENDAR\r\n",
+                            TaskFile::ICalendar, file));
+    QCOMPARE(file.uid, "todo-1@example.com");
+    QCOMPARE(file.title, "Call, then write");
+    QCOMPARE(file.description, "First line\nsecond line that is folded across two lines");
+    QCOMPARE(file.priority, 0);
+    QVERIFY(file.completed);
+    QCOMPARE(file.completedAt, QDateTime(QDate(2024, 3, 1), QTime(9, 30), QTimeZone::UTC));
+
+    QVERIFY(!TaskFile::parse("BEGIN:VCALENDAR\r\nEND:VCALENDAR\r\n", TaskFile::ICalendar, file));
+}
+
+void TestFolderSync::testWriteKeepsForeignFields()
+{
+    TaskFile task;
+    task.uid = "todo-1";
+    task.title = QString(100, u'x');
+    task.description = "a;b,c\nd";
+    task.priority = 2;
+
+    // Foreign VTODO properties survive, long lines are folded, the result reads back
+    const QByteArray original = "BEGIN:VCALENDAR\r\nVERSION:2.0\r\nBEGIN:VTODO\r\nUID:todo-1\r\nSUMMARY:Old\r\n"
+                                "DUE:20240401T000000Z\r\nCATEGORIES:home\r\nEND:VTODO\r\nEND:VCALENDAR\r\n";
+    const QByteArray ics = TaskFile::write(task, TaskFile::ICalendar, original);
+    QVERIFY(ics.contains("DUE:20240401T000000Z\r\n"));
+    QVERIFY(ics.contains("CATEGORIES:home\r\n"));
+    QVERIFY(!ics.contains("SUMMARY:Old"));
+    for (const QByteArray &line : ics.split('\n'))
+        QVERIFY(line.size() <= 76);
+    TaskFile read;
+    QVERIFY(TaskFile::parse(ics, TaskFile::ICalendar, read));
+    QCOMPARE(read.title, task.title);
+    QCOMPARE(read.description, task.description);
+    QCOMPARE(read.priority, 2);
+
+    // Foreign front matter keys survive
+    const QByteArray markdown = TaskFile::write(task, TaskFile::Markdown, "---\nuid: todo-1\ntags: [home]\n---\n# Old\n");
+    QVERIFY(markdown.contains("tags: [home]\n"));
+    QVERIFY(TaskFile::parse(markdown, TaskFile::Markdown, read));
+    QCOMPARE(read.uid, "todo-1");
+    QCOMPARE(read.title, task.title);
+    QCOMPARE(read.description, task.description);
+}
+
+void TestFolderSync::testImport()
+{
+    QTemporaryDir dir;
+    QVERIFY(QDir(dir.path()).mkpath("projects"));
+    writeFile(dir.filePath("a.md"), "---\nuid: a\npriority: low\n---\n# Alpha\n\nFirst\n");
+    writeFile(dir.filePath("projects/b.ics"), "BEGIN:VCALENDAR\r\nBEGIN:VTODO\r\nUID:b\r\nSUMMARY:Beta\r\nEND:VTODO\r\nEND:VCALENDAR\r\n");
+    writeFile(dir.filePath("Untitled note.md"), "no heading here\n");
+    writeFile(dir.filePath("readme.txt"), "not a task\n");
+    QVERIFY(QDir(dir.path()).mkpath(".git"));
+    writeFile(dir.filePath(".git/hidden.md"), "# Hidden\n");
+
+    TaskModel model;
+    FolderSync sync;
+    sync.attach(&model);
+    QSignalSpy written(&sync, &FolderSync::written);
+    QVERIFY(sync.open(dir.path()));
+
+    // Files are checked on the thread pool and applied once all are done
+    QVERIFY(sync.isScanning());
+    QCOMPARE(model.rowCount(), 0);
+    sync.waitForScan();
+    QVERIFY(!sync.isScanning());
+
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(sync.fileCount(), 3);
+    QVERIFY(rowOf(model, "Alpha") >= 0);
+    QCOMPARE(model.getTask(rowOf(model, "Alpha")).getPriority(), 0);
+    QCOMPARE(model.getTask(rowOf(model, "Alpha")).getDescription(), "First");
+    QVERIFY(rowOf(model, "Beta") >= 0);
+    QVERIFY(rowOf(model, "Untitled note") >= 0);
+    QCOMPARE(sync.fileOf(model.taskId(rowOf(model, "Beta"))), "projects/b.ics");
+
+    // Importing is not a local edit
+    QCOMPARE(sync.pendingCount(), 0);
+    QCOMPARE(written.count(), 0);
+    QCOMPARE(readFile(dir.filePath("Untitled note.md")), "no heading here\n");
+}
+
+void TestFolderSync::testRescanOnlyChanged()
+{
+    QTemporaryDir dir;
+    for (int i = 0; i < 50; ++i)
+        writeFile(dir.filePath(QString("task%1.md").arg(i)), QString("# Task %1\n").arg(i).toUtf8());
+
+    TaskModel model;
+    FolderSync sync;
+    sync.attach(&model);
+    QSignalSpy scanned(&sync, &FolderSync::scanned);
+    QVERIFY(sync.open(dir.path()));
+    sync.waitForScan();
+    QCOMPARE(scanned.last().at(0).toInt(), 50);
+
+    // Nothing changed: nothing parsed
+    QCOMPARE(rescan(sync), 0);
+
+    // Touched without a change: read and hashed, not parsed
+    writeFile(dir.filePath("task3.md"), "# Task 3\n", 30);
+    QCOMPARE(rescan(sync), 0);
+
+    // Changed: only that file is parsed and its task updated
+    writeFile(dir.filePath("task7.md"), "---\npriority: high\n---\n# Task 7 edited\n", 20);
+    QCOMPARE(rescan(sync), 1);
+    QCOMPARE(model.rowCount(), 50);
+    const int row = rowOf(model, "Task 7 edited");
+    QVERIFY(row >= 0);
+    QCOMPARE(model.getTask(row).getPriority(), 2);
+    QCOMPARE(sync.pendingCount(), 0);
+
+    // New file: a new task
+    writeFile(dir.filePath("new.md"), "# Brand new\n");
+    QCOMPARE(rescan(sync), 1);
+    QCOMPARE(model.rowCount(), 51);
+}
+
+void TestFolderSync::testRemoteDeleteAndRename()
+{
+    QTemporaryDir dir;
+    writeFile(dir.filePath("keep.md"), "---\nuid: keep\n---\n# Keep\n");
+    writeFile(dir.filePath("drop.md"), "---\nuid: drop\n---\n# Drop\n");
+
+    TaskModel model;
+    FolderSync sync;
+    sync.attach(&model);
+    QVERIFY(sync.open(dir.path()));
+    sync.waitForScan();
+    const quint64 keep = model.taskId(rowOf(model, "Keep"));
+
+    // A deleted file sends its task to the trash
+    QVERIFY(QFile::remove(dir.filePath("drop.md")));
+    rescan(sync);
+    QCOMPARE(rowOf(model, "Drop"), -1);
+    QCOMPARE(sync.fileCount(), 1);
+
+    // A renamed file keeps its task
+    QVERIFY(QFile::rename(dir.filePath("keep.md"), dir.filePath("renamed.md")));
+    rescan(sync);
+    QCOMPARE(model.taskId(rowOf(model, "Keep")), keep);
+    QCOMPARE(sync.fileOf(keep), "renamed.md");
+    QCOMPARE(sync.fileCount(), 1);
+}
+
+void TestFolderSync::testLocalEdits()
+{
+    QTemporaryDir dir;
+    writeFile(dir.filePath("a.md"), "---\nuid: a\nowner: sam\n---\n# Alpha\n");
+    writeFile(dir.filePath("b.ics"), "BEGIN:VCALENDAR\r\nBEGIN:VTODO\r\nUID:b\r\nSUMMARY:Beta\r\nDUE:20240401\r\nEND:VTODO\r\nEND:VCALENDAR\r\n");
+    const QDateTime untouched = QFileInfo(dir.filePath("b.ics")).lastModified();
+
+    TaskModel model;
+    FolderSync sync;
+    sync.attach(&model);
+    sync.setWriteDelay(10);
+    QVERIFY(sync.open(dir.path()));
+    sync.waitForScan();
+
+    // An edit rewrites only that task's file, keeping its foreign fields
+    QSignalSpy written(&sync, &FolderSync::written);
+    model.setData(model.index(rowOf(model, "Alpha")), "Alpha renamed", TaskModel::TitleRole);
+    QCOMPARE(sync.pendingCount(), 1);
+    QTRY_COMPARE(written.count(), 1);
+    QVERIFY(readFile(dir.filePath("a.md")).contains("# Alpha renamed"));
+    QVERIFY(readFile(dir.filePath("a.md")).contains("owner: sam"));
+    QCOMPARE(QFileInfo(dir.filePath("b.ics")).lastModified(), untouched);
+
+    // A new task gets a file in the default format
+    sync.setNewFileFormat(TaskFile::ICalendar);
+    model.addTask("Gamma", "Third");
+    QTRY_COMPARE(written.count(), 2);
+    const quint64 gamma = model.taskId(rowOf(model, "Gamma"));
+    QVERIFY(sync.fileOf(gamma).endsWith(".ics"));
+    TaskFile file;
+    QVERIFY(TaskFile::parse(readFile(dir.filePath(sync.fileOf(gamma))), TaskFile::ICalendar, file));
+    QCOMPARE(file.title, "Gamma");
+    QCOMPARE(file.description, "Third");
+
+    // Completing a task in the ics file keeps its due date
+    model.toggleCompleted(rowOf(model, "Beta"));
+    QTRY_COMPARE(written.count(), 3);
+    QVERIFY(readFile(dir.filePath("b.ics")).contains("STATUS:COMPLETED"));
+    QVERIFY(readFile(dir.filePath("b.ics")).contains("DUE:20240401"));
+
+    // Deleting a task removes its file; our own writes are not parsed back
+    model.removeTask(rowOf(model, "Alpha"));
+    QTRY_COMPARE(written.count(), 4);
+    QVERIFY(!QFile::exists(dir.filePath("a.md")));
+    QCOMPARE(rescan(sync), 0);
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files).size(), 2);
+}
+
+void TestFolderSync::testCacheAcrossSessions()
+{
+    QTemporaryDir dir;
+    QTemporaryDir data;
+    const QString cache = data.filePath("folder-sync.cache");
+    for (int i = 0; i < 10; ++i)
+        writeFile(dir.filePath(QString("task%1.md").arg(i)), QString("# Task %1\n").arg(i).toUtf8());
+
+    TaskModel model;
+    {
+        FolderSync sync;
+        sync.attach(&model);
+        QVERIFY(sync.open(dir.path(), cache));
+        sync.waitForScan();
+        QCOMPARE(model.rowCount(), 10);
+    }
+
+    // Same tasks, e.g. restored by the TaskStore: nothing is parsed or duplicated
+    {
+        FolderSync sync;
+        sync.attach(&model);
+        QSignalSpy scanned(&sync, &FolderSync::scanned);
+        QVERIFY(sync.open(dir.path(), cache));
+        sync.waitForScan();
+        QCOMPARE(scanned.count(), 1);
+        QCOMPARE(scanned.at(0).at(0).toInt(), 0);
+        QCOMPARE(model.rowCount(), 10);
+    }
+
+    // Tasks the model lost are imported again
+    TaskModel empty;
+    FolderSync sync;
+    sync.attach(&empty);
+    QVERIFY(sync.open(dir.path(), cache));
+    sync.waitForScan();
+    QCOMPARE(empty.rowCount(), 10);
+}
+
+QTEST_MAIN(TestFolderSync)
+#include "test_folder_sync.moc"
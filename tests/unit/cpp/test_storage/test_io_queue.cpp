@@ -0,0 +1,136 @@
+#include <QTest>
+#include <QFile>
+#include <QTemporaryDir>
+#include "storage/IoQueue.h"
+
+#include <cerrno>
+
+class TestIoQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testWriteAndRead_data();
+    void testWriteAndRead();
+    void testLinkedFailure_data();
+    void testLinkedFailure();
+    void testAppend_data();
+    void testAppend();
+    void testFallback();
+};
+
+static void addBackends()
+{
+    QTest::addColumn<int>("backend");
+    QTest::newRow("thread_pool") << int(IoQueue::ThreadPool);
+    QTest::newRow("io_uring") << int(IoQueue::IoUring);
+}
+
+/**
+ * Creates the queue of a data row, skipping io_uring rows where it is unavailable.
+ */
+#define CREATE_QUEUE(io)                                                                   \
+    QFETCH(int, backend);                                                                  \
+    if (backend == IoQueue::IoUring && !IoQueue::isIoUringAvailable())                     \
+        QSKIP("io_uring is not available");                                                \
+    IoQueue io(IoQueue::Backend(backend));                                                 \
+    QCOMPARE(int(io.backend()), backend)
+
+void TestIoQueue::testWriteAndRead_data()
+{
+    addBackends();
+}
+
+void TestIoQueue::testWriteAndRead()
+{
+    CREATE_QUEUE(io);
+    QTemporaryDir dir;
+    QFile file(dir.filePath("data"));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+
+    // More requests than fit one submission
+    QList<IoRequest> writes;
+    for (int i = 0; i < IoQueue::QueueDepth; ++i)
+    {
+        writes.append(IoRequest::write(file.handle(), i * 64, QByteArray(64, char('a' + i % 26)), true));
+        writes.append(IoRequest::sync(file.handle()));
+    }
+    QVERIFY(io.run(writes));
+    QCOMPARE(writes.at(0).result, 64);
+    QCOMPARE(writes.at(1).result, 0);
+    QCOMPARE(io.submissions(), 2);
+    QCOMPARE(file.size(), IoQueue::QueueDepth * 64);
+
+    // Reads stop at the end of the file
+    QList<IoRequest> reads({IoRequest::read(file.handle(), 0, 64), IoRequest::read(file.handle(), 25 * 64, 64),
+                            IoRequest::read(file.handle(), file.size() - 10, 64)});
+    QVERIFY(io.run(reads));
+    QCOMPARE(reads.at(0).data, QByteArray(64, 'a'));
+    QCOMPARE(reads.at(1).data, QByteArray(64, 'z'));
+    QCOMPARE(reads.at(2).data.size(), 10);
+}
+
+void TestIoQueue::testLinkedFailure_data()
+{
+    addBackends();
+}
+
+void TestIoQueue::testLinkedFailure()
+{
+    CREATE_QUEUE(io);
+    QTemporaryDir dir;
+    QFile writable(dir.filePath("data"));
+    QVERIFY(writable.open(QIODevice::ReadWrite));
+    QFile readOnly(writable.fileName());
+    QVERIFY(readOnly.open(QIODevice::ReadOnly));
+
+    // The failed write cancels its chain only
+    QList<IoRequest> requests({IoRequest::write(readOnly.handle(), 0, "lost", true), IoRequest::sync(readOnly.handle()),
+                               IoRequest::write(writable.handle(), 0, "kept")});
+    QVERIFY(!io.run(requests));
+    QVERIFY(requests.at(0).result < 0);
+    QCOMPARE(requests.at(1).result, -ECANCELED);
+    QCOMPARE(requests.at(2).result, 4);
+    QCOMPARE(writable.readAll(), QByteArray("kept"));
+}
+
+void TestIoQueue::testAppend_data()
+{
+    addBackends();
+}
+
+void TestIoQueue::testAppend()
+{
+    CREATE_QUEUE(io);
+    QTemporaryDir dir;
+    QFile file(dir.filePath("journal"));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+
+    // Larger than all registered buffers together
+    QList<QByteArray> records;
+    QByteArray expected;
+    for (int i = 0; i < 20000; ++i)
+    {
+        records.append(QByteArray::number(i).leftJustified(39, '.').append('\n'));
+        expected.append(records.constLast());
+    }
+    QVERIFY(expected.size() > IoQueue::JournalBuffers * IoQueue::JournalBufferSize);
+
+    QCOMPARE(io.append(file.handle(), 0, records), qint64(expected.size()));
+    QCOMPARE(io.append(file.handle(), expected.size(), {"tail\n"}, false), 5);
+    QCOMPARE(file.readAll(), expected + "tail\n");
+}
+
+void TestIoQueue::testFallback()
+{
+    IoQueue io(IoQueue::ThreadPool);
+    QCOMPARE(io.backend(), IoQueue::ThreadPool);
+    QVERIFY(!io.fallbackReason().isEmpty());
+
+    IoQueue preferred;
+    QCOMPARE(preferred.backend() == IoQueue::IoUring, IoQueue::isIoUringAvailable());
+    QCOMPARE(preferred.fallbackReason().isEmpty(), IoQueue::isIoUringAvailable());
+}
+
+QTEST_MAIN(TestIoQueue)
+#include "test_io_queue.moc"
@@ -0,0 +1,228 @@
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTimeZone>
+#include "models/TaskModel.h"
+#include "storage/MailImporter.h"
+#include "FileTestHelpers.h"
+
+class TestMailImporter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Parsing tests
+    void testParseHeaders();
+    void testMultipartPrefersPlainText();
+    void testNoHeaders();
+
+    // Import tests
+    void testImportMbox();
+    void testImportMaildir();
+    void testStartOnWorker();
+};
+
+void TestMailImporter::testParseHeaders()
+{
+    const QByteArray mail =
+        "From alice@example.com Mon Mar  4 09:30:00 2024\r\n"
+        "Received: from mx.example.com\r\n"
+        "Subject: =?UTF-8?B?UmVuZXcgdGhlIHBhc3Nwb3J0?=\r\n"
+        " =?ISO-8859-1?Q?_f=FCr_Anna?= soon\r\n"
+        "From: =?utf-8?q?Jos=C3=A9?= <jose@example.com>\r\n"
+        "Date: Mon, 04 Mar 2024 09:30:00 +0000\r\n"
+        "Message-ID: <1@example.com>\r\n"
+        "X-Priority: 1 (Highest)\r\n"
+        "\r\n"
+        "Photos are in the drawer.\r\n";
+
+    MailImporter::Message message;
+    QVERIFY(MailImporter::Message::parse(mail.constData(), mail.size(), message));
+    QCOMPARE(message.subject, QString::fromUtf8("Renew the passport für Anna soon"));
+    QCOMPARE(message.from, QString::fromUtf8("José <jose@example.com>"));
+    QCOMPARE(message.date, QDateTime(QDate(2024, 3, 4), QTime(9, 30), QTimeZone::UTC));
+    QCOMPARE(message.body, "Photos are in the drawer.");
+    QCOMPARE(message.priority, 2);
+    QVERIFY(message.key != 0);
+
+    const TaskRecord record = message.toRecord();
+    QCOMPARE(record.getTitle(), message.subject);
+    QCOMPARE(record.getDescription(), QString::fromUtf8("From: José <jose@example.com>\n\nPhotos are in the drawer."));
+    QCOMPARE(record.getPriority(), 2);
+
+    // The key follows the Message-ID, not the content
+    MailImporter::Message copy;
+    const QByteArray resent = QByteArray(mail).replace("drawer", "attic");
+    QVERIFY(MailImporter::Message::parse(resent.constData(), resent.size(), copy));
+    QCOMPARE(copy.key, message.key);
+}
+
+void TestMailImporter::testMultipartPrefersPlainText()
+{
+    const QByteArray mail =
+        "Subject: Quarterly report\n"
+        "Importance: low\n"
+        "Content-Type: multipart/mixed; boundary=\"outer\"\n"
+        "\n"
+        "This is a multi-part message in MIME format.\n"
+        "--outer\n"
+        "Content-Type: multipart/alternative; boundary=inner\n"
+        "\n"
+        "--inner\n"
+        "Content-Type: text/html; charset=utf-8\n"
+        "\n"
+        "<p>Numbers &amp; charts</p>\n"
+        "--inner\n"
+        "Content-Type: text/plain; charset=iso-8859-1\n"
+        "Content-Transfer-Encoding: quoted-printable\n"
+        "\n"
+        "Numbers and charts, s=E9e attachment. A long line that is wrapped with a so=\n"
+        "ft break.\n"
+        "--inner--\n"
+        "--outer\n"
+        "Content-Type: application/pdf\n"
+        "Content-Transfer-Encoding: base64\n"
+        "\n"
+        "JVBERi0xLjQK\n"
+        "--outer--\n";
+
+    MailImporter::Message message;
+    QVERIFY(MailImporter::Message::parse(mail.constData(), mail.size(), message));
+    QCOMPARE(message.subject, "Quarterly report");
+    QCOMPARE(message.body, QString::fromUtf8("Numbers and charts, sée attachment. A long line that is wrapped with a soft break."));
+    QCOMPARE(message.priority, 0);
+
+    // Without a plain part the HTML one is used, without its tags
+    const QByteArray html =
+        "Subject: Newsletter\n"
+        "Content-Type: multipart/alternative; boundary=b\n"
+        "\n"
+        "--b\n"
+        "Content-Type: text/html\n"
+        "Content-Transfer-Encoding: base64\n"
+        "\n"
+        + QByteArray("<h1>Hello</h1><p>Sale &lt;today&gt;</p>").toBase64() + "\n"
+        "--b--\n";
+    QVERIFY(MailImporter::Message::parse(html.constData(), html.size(), message));
+    QCOMPARE(message.body, "HelloSale <today>");
+}
+
+void TestMailImporter::testNoHeaders()
+{
+    const QByteArray text = "just some text\nwithout headers\n";
+    MailImporter::Message message;
+    QVERIFY(!MailImporter::Message::parse(text.constData(), text.size(), message));
+    QCOMPARE(message.key, quint64(0));
+}
+
+void TestMailImporter::testImportMbox()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString mbox = dir.filePath("inbox.mbox");
+    writeFile(mbox,
+              "From a@example.com Mon Mar  4 09:30:00 2024\n"
+              "Subject: First\n"
+              "Message-ID: <1@example.com>\n"
+              "\n"
+              "Body one\n"
+              ">From the start, quoted\n"
+              "\n"
+              "From b@example.com Mon Mar  4 09:31:00 2024\n"
+              "Subject: Second\n"
+              "Message-ID: <2@example.com>\n"
+              "\n"
+              "Body two\n"
+              "\n"
+              "From a@example.com Mon Mar  4 09:32:00 2024\n"
+              "Subject: First, delivered twice\n"
+              "Message-ID: <1@example.com>\n"
+              "\n"
+              "Body one again\n");
+
+    TaskModel model;
+    MailImporter importer;
+    importer.attach(&model);
+    QVERIFY(importer.setHistoryFile(dir.filePath("history")));
+    QSignalSpy progress(&importer, &MailImporter::progress);
+    QCOMPARE(importer.import(mbox), 2);
+    QCOMPARE(importer.duplicateCount(), 1);
+    QCOMPARE(model.rowCount(), 2);
+    QVERIFY(!progress.isEmpty());
+    QCOMPARE(progress.last()[0].toLongLong(), QFileInfo(mbox).size());
+
+    const int first = rowOf(model, "First");
+    QVERIFY(first >= 0);
+    QCOMPARE(model.getTask(first).getDescription(), "Body one\nFrom the start, quoted");
+    QVERIFY(rowOf(model, "Second") >= 0);
+
+    // The history keeps a second session from importing the same messages
+    MailImporter again;
+    again.attach(&model);
+    QVERIFY(again.setHistoryFile(dir.filePath("history")));
+    QCOMPARE(again.knownCount(), 2);
+    QCOMPARE(again.import(mbox), 0);
+    QCOMPARE(model.rowCount(), 2);
+
+    QCOMPARE(importer.import(dir.filePath("missing.mbox")), -1);
+}
+
+void TestMailImporter::testImportMaildir()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString maildir = dir.filePath("Mail");
+    writeFile(maildir + "/cur/1700000000.1.host:2,S", "Subject: Read one\nMessage-ID: <r@x>\n\nbody\n");
+    writeFile(maildir + "/new/1700000001.2.host", "Subject: New one\nMessage-ID: <n@x>\n\nbody\n");
+    writeFile(maildir + "/tmp/1700000002.3.host", "Subject: Still arriving\nMessage-ID: <t@x>\n\nbody\n");
+    writeFile(maildir + "/.Work/cur/1700000003.4.host:2,", "Subject: Work one\nMessage-ID: <w@x>\n\nbody\n");
+    writeFile(maildir + "/.Work/new/1700000004.5.host", "Subject: New one\nMessage-ID: <n@x>\n\ncopy\n");
+
+    TaskModel model;
+    MailImporter importer;
+    importer.attach(&model);
+    QCOMPARE(importer.import(maildir), 3);
+    QCOMPARE(importer.duplicateCount(), 1);
+    QVERIFY(rowOf(model, "Read one") >= 0);
+    QVERIFY(rowOf(model, "New one") >= 0);
+    QVERIFY(rowOf(model, "Work one") >= 0);
+    QCOMPARE(rowOf(model, "Still arriving"), -1);
+}
+
+void TestMailImporter::testStartOnWorker()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QByteArray mails;
+    for (int i = 0; i < 3 * MailImporter::BatchSize; ++i)
+        mails += QStringLiteral("From a@example.com Mon Mar  4 09:30:00 2024\nSubject: Mail %1\nMessage-ID: <%1@example.com>\n\nBody\n\n").arg(i).toUtf8();
+    const QString mbox = dir.filePath("inbox.mbox");
+    writeFile(mbox, mails);
+
+    TaskModel model;
+    MailImporter importer;
+    importer.attach(&model);
+    QSignalSpy imported(&importer, &MailImporter::imported);
+    QSignalSpy progress(&importer, &MailImporter::progress);
+    QVERIFY(importer.start(mbox));
+    QVERIFY(importer.isImporting());
+    QVERIFY(!importer.start(mbox));
+
+    // Batches are inserted from the event loop, each followed by its progress
+    QVERIFY(imported.wait(10000));
+    QCOMPARE(imported.at(0).at(0).toInt(), 3 * MailImporter::BatchSize);
+    QVERIFY(!importer.isImporting());
+    QCOMPARE(progress.count(), 3);
+    QCOMPARE(progress.last().at(0).toLongLong(), QFileInfo(mbox).size());
+    QCOMPARE(model.rowCount(), 3 * MailImporter::BatchSize);
+
+    // A missing file is reported through imported() too
+    QVERIFY(importer.start(dir.filePath("missing.mbox")));
+    QVERIFY(imported.wait());
+    QCOMPARE(imported.at(1).at(0).toInt(), -1);
+}
+
+QTEST_MAIN(TestMailImporter)
+#include "test_mail_importer.moc"
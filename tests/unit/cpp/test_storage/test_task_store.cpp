@@ -0,0 +1,268 @@
+#include <QTest>
+#include <QDir>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "models/TaskModel.h"
+#include "storage/TaskStore.h"
+
+class TestTaskStore : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QList<TaskRecord> numberedTasks(int count);
+    static QStringList pageFiles(const QString &directory);
+
+private slots:
+    // Round trip tests
+    void testRoundTrip();
+    void testOpenNonEmptyModel();
+    void testOpenAsync();
+    void testReadRows();
+
+    // Incremental save tests
+    void testSingleDirtyPage();
+    void testCopyOnWrite();
+    void testDeleteAndCompact();
+    void testAutosave();
+};
+
+QList<TaskRecord> TestTaskStore::numberedTasks(int count)
+{
+    QList<TaskRecord> records;
+    records.reserve(count);
+    for (int i = 0; i < count; ++i)
+        records.append(TaskRecord(QString("Task %1").arg(i), QString("Description %1").arg(i), i % 3));
+    return records;
+}
+
+QStringList TestTaskStore::pageFiles(const QString &directory)
+{
+    return QDir(directory).entryList({"*.page"}, QDir::Files, QDir::Name);
+}
+
+void TestTaskStore::testReadRows()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    {
+        TaskModel model;
+        TaskStore store;
+        store.attach(&model);
+        QVERIFY(store.open(dir.path()));
+        model.addTasks(numberedTasks(1200));
+        QVERIFY(store.save(true));
+    }
+
+    // Rows on the first and last page, and one past the end
+    QString error;
+    const QList<TaskRecord> records = TaskStore::read(dir.path(), {3, 511, 1100, 5000}, &error);
+    QVERIFY(error.isEmpty());
+    QCOMPARE(records.size(), 3);
+    QCOMPARE(records[0].getTitle(), "Task 3");
+    QCOMPARE(records[1].getTitle(), "Task 511");
+    QCOMPARE(records[2].getTitle(), "Task 1100");
+
+    QVERIFY(TaskStore::read(dir.path(), QList<int>(), &error).isEmpty());
+    QVERIFY(error.isEmpty());
+}
+
+void TestTaskStore::testRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QList<quint64> ids;
+    {
+        TaskModel model;
+        TaskStore store;
+        store.attach(&model);
+        QVERIFY(store.open(dir.path()));
+
+        model.addTasks(numberedTasks(1200));
+        model.toggleCompleted(7);
+        for (int row = 0; row < model.rowCount(); ++row)
+            ids.append(model.taskId(row));
+
+        QCOMPARE(store.pageCount(), 3);
+        QVERIFY(store.save(true));
+        QCOMPARE(store.dirtyPageCount(), 0);
+    }
+
+    TaskModel model;
+    TaskStore store;
+    store.attach(&model);
+    QVERIFY(store.open(dir.path()));
+
+    // Loading is not a change
+    QCOMPARE(store.dirtyPageCount(), 0);
+    QCOMPARE(store.pageCount(), 3);
+    QCOMPARE(model.rowCount(), 1200);
+    for (int row = 0; row < model.rowCount(); ++row)
+        QCOMPARE(model.taskId(row), ids.at(row));
+    QCOMPARE(model.getTask(5).getTitle(), "Task 5");
+    QCOMPARE(model.getTask(5).getDescription(), "Description 5");
+    QCOMPARE(model.getTask(5).getPriority(), 2);
+    QVERIFY(model.getTask(7).getCompleted());
+    QVERIFY(model.getTask(7).getCompletedAt().isValid());
+
+    QCOMPARE(TaskStore::read(dir.path()).size(), 1200);
+}
+
+void TestTaskStore::testOpenNonEmptyModel()
+{
+    QTemporaryDir dir;
+    {
+        TaskModel model;
+        TaskStore store;
+        store.attach(&model);
+        store.open(dir.path());
+        model.addTasks(numberedTasks(10));
+        store.save(true);
+    }
+
+    // The model's tasks replace the stored ones
+    TaskModel model;
+    model.addTask("Only");
+    TaskStore store;
+    store.attach(&model);
+    QVERIFY(store.open(dir.path()));
+    QCOMPARE(model.rowCount(), 1);
+    QVERIFY(store.save(true));
+
+    const QList<TaskRecord> stored = TaskStore::read(dir.path());
+    QCOMPARE(stored.size(), 1);
+    QCOMPARE(stored.at(0).getTitle(), "Only");
+    QCOMPARE(pageFiles(dir.path()).size(), 1);
+}
+
+void TestTaskStore::testOpenAsync()
+{
+    QTemporaryDir dir;
+    {
+        TaskModel model;
+        TaskStore store;
+        store.attach(&model);
+        store.open(dir.path());
+        model.addTasks(numberedTasks(1000));
+        store.save(true);
+    }
+
+    TaskModel model;
+    TaskStore store;
+    store.attach(&model);
+    QSignalSpy opened(&store, &TaskStore::opened);
+    QVERIFY(store.open(dir.path(), false));
+    QVERIFY(store.isLoading());
+    QVERIFY(store.directory().isEmpty());
+
+    QTRY_COMPARE(opened.count(), 1);
+    QVERIFY(opened.at(0).at(0).toBool());
+    QVERIFY(!store.isLoading());
+    QCOMPARE(store.directory(), dir.path());
+    QCOMPARE(model.rowCount(), 1000);
+    QCOMPARE(store.dirtyPageCount(), 0);
+}
+
+void TestTaskStore::testSingleDirtyPage()
+{
+    QTemporaryDir dir;
+    TaskModel model;
+    TaskStore store;
+    store.attach(&model);
+    store.open(dir.path());
+    model.addTasks(numberedTasks(20 * TaskStore::PageSize));
+    QVERIFY(store.save(true));
+    const qint64 fullBytes = store.lastSaveBytes();
+
+    QSignalSpy saved(&store, &TaskStore::saved);
+    model.toggleCompleted(3 * TaskStore::PageSize + 1);
+    QCOMPARE(store.dirtyPageCount(), 1);
+    QVERIFY(store.save(true));
+
+    // One page and the manifest
+    QCOMPARE(saved.count(), 1);
+    QCOMPARE(saved.at(0).at(0).toInt(), 1);
+    QVERIFY(store.lastSaveBytes() < fullBytes / 10);
+
+    // Nothing to do without changes
+    QVERIFY(store.save(true));
+    QCOMPARE(saved.count(), 1);
+}
+
+void TestTaskStore::testCopyOnWrite()
+{
+    QTemporaryDir dir;
+    TaskModel model;
+    TaskStore store;
+    store.attach(&model);
+    store.open(dir.path());
+    model.addTasks(numberedTasks(2 * TaskStore::PageSize));
+    store.save(true);
+    QCOMPARE(pageFiles(dir.path()), QStringList({"1-1.page", "2-1.page"}));
+
+    // The rewritten page gets a new file; the old one goes after the manifest swap.
+    model.setData(model.index(TaskStore::PageSize), "Renamed", TaskModel::TitleRole);
+    store.save(true);
+    QCOMPARE(pageFiles(dir.path()), QStringList({"1-1.page", "2-2.page"}));
+    QCOMPARE(TaskStore::read(dir.path()).at(TaskStore::PageSize).getTitle(), "Renamed");
+
+    // A damaged manifest is reported, not read as an empty store
+    QFile manifest(dir.filePath("manifest"));
+    QVERIFY(manifest.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    manifest.write("garbage");
+    manifest.close();
+    QString error;
+    QVERIFY(TaskStore::read(dir.path(), &error).isEmpty());
+    QVERIFY(!error.isEmpty());
+}
+
+void TestTaskStore::testDeleteAndCompact()
+{
+    QTemporaryDir dir;
+    TaskModel model;
+    TaskStore store;
+    store.attach(&model);
+    store.open(dir.path());
+    model.addTasks(numberedTasks(3 * TaskStore::PageSize));
+    store.save(true);
+
+    // Deleting the whole middle page drops its file
+    for (int row = TaskStore::PageSize; row < 2 * TaskStore::PageSize; ++row)
+        model.removeTask(row);
+    QCOMPARE(store.dirtyPageCount(), 1);
+    store.save(true);
+    QCOMPARE(pageFiles(dir.path()), QStringList({"1-1.page", "3-1.page"}));
+    QCOMPARE(TaskStore::read(dir.path()).size(), 2 * TaskStore::PageSize);
+
+    // Compaction and restoring a task only touch the pages of the tasks involved
+    const quint64 id = model.taskId(TaskStore::PageSize);
+    model.compactTombstones();
+    QCOMPARE(store.dirtyPageCount(), 0);
+    QVERIFY(model.restoreTask(id));
+    QCOMPARE(store.dirtyPageCount(), 1);
+    store.save(true);
+
+    const QList<TaskRecord> stored = TaskStore::read(dir.path());
+    QCOMPARE(stored.size(), 2 * TaskStore::PageSize + 1);
+    QCOMPARE(stored.constLast().getId(), id);
+}
+
+void TestTaskStore::testAutosave()
+{
+    QTemporaryDir dir;
+    TaskModel model;
+    TaskStore store;
+    store.attach(&model);
+    store.setAutosaveInterval(10);
+    store.open(dir.path());
+
+    QSignalSpy saved(&store, &TaskStore::saved);
+    model.addTask("Autosaved");
+    QTRY_COMPARE(saved.count(), 1);
+    QVERIFY(!store.isSaving());
+    QCOMPARE(TaskStore::read(dir.path()).size(), 1);
+}
+
+QTEST_MAIN(TestTaskStore)
+#include "test_task_store.moc"
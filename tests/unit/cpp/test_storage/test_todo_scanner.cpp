@@ -0,0 +1,256 @@
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "models/TaskModel.h"
+#include "storage/TodoScanner.h"
+#include "utils/GitIgnore.h"
+#include "FileTestHelpers.h"
+
+class TestTodoScanner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Building block tests
+    void testGitIgnore();
+    void testFindMarkers();
+
+    // Scan tests
+    void testScanTree();
+    void testRescanAppliesDiff();
+    void testEditedDescriptionKept();
+    void testCacheAcrossSessions();
+};
+
+void TestTodoScanner::testGitIgnore()
+{
+    GitIgnore ignore;
+    QCOMPARE(ignore.addRules("# comment\n\nbuild/\n*.o\n!keep.o\n/top.txt\ndocs/**/*.tmp\n**/cache\nfile[0-9].log\n"), 7);
+
+    QVERIFY(ignore.isIgnored("build", true));
+    QVERIFY(!ignore.isIgnored("build", false));
+    QVERIFY(ignore.isIgnored("src/build", true));
+    QVERIFY(ignore.isIgnored("src/main.o", false));
+    QVERIFY(!ignore.isIgnored("src/keep.o", false));
+    QVERIFY(ignore.isIgnored("top.txt", false));
+    QVERIFY(!ignore.isIgnored("src/top.txt", false));
+    QVERIFY(ignore.isIgnored("docs/a.tmp", false));
+    QVERIFY(ignore.isIgnored("docs/a/b/c.tmp", false));
+    QVERIFY(!ignore.isIgnored("src/a.tmp", false));
+    QVERIFY(ignore.isIgnored("cache", true));
+    QVERIFY(ignore.isIgnored("a/b/cache", false));
+    QVERIFY(ignore.isIgnored("file7.log", false));
+    QVERIFY(!ignore.isIgnored("filex.log", false));
+
+    // Nested rules apply below their directory and take precedence
+    ignore.addRules("!*.o\n/local\n", "src");
+    QVERIFY(!ignore.isIgnored("src/main.o", false));
+    QVERIFY(ignore.isIgnored("lib/main.o", false));
+    QVERIFY(ignore.isIgnored("src/local", false));
+    QVERIFY(!ignore.isIgnored("local", false));
+}
+
+void TestTodoScanner::testFindMarkers()
+{
+    const QByteArray content =
+        "int main()\n"                                  // 1
+        "{\n"                                           // 2
+        "    // TODO: handle arguments\n"               // 3
+        "    const char *s = \"TODO not a comment\";\n" // 4
+        "    /* FIXME(ana): leaks */\n"                 // 5
+        "    int TODOS = 0; // TODO_LIST is a name\n"   // 6
+        "    /*\n"                                      // 7
+        "     * TODO split this up\n"                   // 8
+        "     */\n"                                     // 9
+        "}\n"                                           // 10
+        "# TODO\n";                                     // 11
+
+    const QList<TodoScanner::Marker> markers = TodoScanner::findMarkers(content.constData(), content.size());
+    QCOMPARE(markers.size(), 4);
+    QCOMPARE(markers[0].title, "TODO: handle arguments");
+    QCOMPARE(markers[0].line, 3);
+    QCOMPARE(markers[1].title, "FIXME(ana): leaks");
+    QCOMPARE(markers[1].line, 5);
+    QCOMPARE(markers[2].title, "TODO split this up");
+    QCOMPARE(markers[2].line, 8);
+    QCOMPARE(markers[3].title, "TODO");
+    QCOMPARE(markers[3].line, 11);
+}
+
+void TestTodoScanner::testScanTree()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.filePath(".gitignore"), "build/\n*.gen.cpp\n");
+    writeFile(dir.filePath("src/main.cpp"), "// TODO: parse flags\nint main() { return 0; } // FIXME exit code\n");
+    writeFile(dir.filePath("src/util.gen.cpp"), "// TODO generated\n");
+    writeFile(dir.filePath("src/lib/.gitignore"), "!*.gen.cpp\n");
+    writeFile(dir.filePath("src/lib/keep.gen.cpp"), "// TODO kept\n");
+    writeFile(dir.filePath("build/out.cpp"), "// TODO ignored\n");
+    writeFile(dir.filePath(".git/HEAD"), "# TODO not source\n");
+    writeFile(dir.filePath("image.bin"), QByteArray("\x89PNG\0\0// TODO binary\n", 21));
+
+    TaskModel model;
+    TodoScanner scanner;
+    scanner.attach(&model);
+    QSignalSpy scanned(&scanner, &TodoScanner::scanned);
+    QVERIFY(scanner.open(dir.path()));
+    QVERIFY(scanner.isScanning());
+    scanner.waitForScan();
+    QVERIFY(!scanner.isScanning());
+
+    QCOMPARE(scanned.size(), 1);
+    QCOMPARE(scanned[0][2].toInt(), 3);
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(scanner.markerCount(), 3);
+    QCOMPARE(scanner.fileCount(), 2);
+
+    const int parse = rowOf(model, "TODO: parse flags");
+    QVERIFY(parse >= 0);
+    QCOMPARE(model.getTask(parse).getDescription(), "src/main.cpp:1");
+    QCOMPARE(model.getTask(parse).getPriority(), 1);
+    const int exitCode = rowOf(model, "FIXME exit code");
+    QVERIFY(exitCode >= 0);
+    QCOMPARE(model.getTask(exitCode).getDescription(), "src/main.cpp:2");
+    QCOMPARE(model.getTask(exitCode).getPriority(), 2);
+    QVERIFY(rowOf(model, "TODO kept") >= 0);
+}
+
+void TestTodoScanner::testRescanAppliesDiff()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.filePath("a.cpp"), "// TODO one\n// TODO two\n// TODO two\n");
+    writeFile(dir.filePath("b.py"), "# FIXME untouched\n");
+
+    TaskModel model;
+    TodoScanner scanner;
+    scanner.attach(&model);
+    QVERIFY(scanner.open(dir.path()));
+    scanner.waitForScan();
+    QCOMPARE(model.rowCount(), 4);
+    const quint64 one = model.taskId(rowOf(model, "TODO one"));
+    const quint64 untouched = model.taskId(rowOf(model, "FIXME untouched"));
+
+    // Lines shift, one duplicate goes away, a marker is added
+    writeFile(dir.filePath("a.cpp"), "#include <x>\n\n// TODO one\n// TODO two\n// TODO three\n", 30);
+
+    QSignalSpy inserted(&model, &TaskModel::rowsInserted);
+    QSignalSpy removed(&model, &TaskModel::rowsRemoved);
+    QSignalSpy changed(&model, &TaskModel::dataChanged);
+    QSignalSpy scanned(&scanner, &TodoScanner::scanned);
+    QVERIFY(scanner.scan());
+    scanner.waitForScan();
+
+    QCOMPARE(scanned.size(), 1);
+    QCOMPARE(scanned[0][0].toInt(), 2);   // files
+    QCOMPARE(scanned[0][1].toInt(), 1);   // searched: b.py was not read
+    QCOMPARE(scanned[0][2].toInt(), 1);   // added
+    QCOMPARE(scanned[0][3].toInt(), 2);   // updated: "one" and the first "two" moved
+    QCOMPARE(scanned[0][4].toInt(), 1);   // removed
+    QCOMPARE(inserted.size(), 1);
+    QCOMPARE(removed.size(), 1);
+    QCOMPARE(changed.size(), 2);
+    for (const QList<QVariant> &signal : std::as_const(changed))
+        QCOMPARE(signal[2].value<QList<int>>(), QList<int>({TaskModel::DescriptionRole}));
+
+    QCOMPARE(model.rowCount(), 4);
+    QCOMPARE(model.getTaskById(one).getDescription(), "a.cpp:3");
+    QCOMPARE(model.getTaskById(untouched).getDescription(), "b.py:1");
+    QCOMPARE(model.getTask(rowOf(model, "TODO three")).getDescription(), "a.cpp:5");
+
+    // A deleted file takes its tasks along; a deleted task keeps its marker quiet
+    model.removeTask(model.indexOfTask(untouched));
+    QVERIFY(QFile::remove(dir.filePath("a.cpp")));
+    writeFile(dir.filePath("b.py"), "\n# FIXME untouched\n", 20);
+    QVERIFY(scanner.scan());
+    scanner.waitForScan();
+    QCOMPARE(rowOf(model, "TODO one"), -1);
+    QCOMPARE(rowOf(model, "FIXME untouched"), -1);
+    QCOMPARE(scanner.markerCount(), 1);
+}
+
+void TestTodoScanner::testEditedDescriptionKept()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.filePath("a.cpp"), "// TODO edited\n// TODO generated\n");
+
+    TaskModel model;
+    TodoScanner scanner;
+    scanner.attach(&model);
+    QVERIFY(scanner.open(dir.path()));
+    scanner.waitForScan();
+    const quint64 edited = model.taskId(rowOf(model, "TODO edited"));
+    const quint64 generated = model.taskId(rowOf(model, "TODO generated"));
+    const QList<TodoScanner::Marker> before = scanner.markers("a.cpp");
+    QCOMPARE(before.size(), 2);
+    QCOMPARE(before[0].taskId, edited);
+    QCOMPARE(before[1].taskId, generated);
+
+    QVERIFY(model.setData(model.index(model.indexOfTask(edited)), "Check the bounds first", TaskModel::DescriptionRole));
+    writeFile(dir.filePath("a.cpp"), "\n\n// TODO edited\n// TODO generated\n", 30);
+
+    QSignalSpy scanned(&scanner, &TodoScanner::scanned);
+    QVERIFY(scanner.scan());
+    scanner.waitForScan();
+
+    QCOMPARE(scanned.size(), 1);
+    QCOMPARE(scanned[0][2].toInt(), 0);   // added
+    QCOMPARE(scanned[0][3].toInt(), 1);   // updated: only the generated description
+    QCOMPARE(model.getTaskById(edited).getDescription(), "Check the bounds first");
+    QCOMPARE(model.getTaskById(generated).getDescription(), "a.cpp:4");
+
+    // The markers still know where they are, and the edited one keeps its task
+    const QList<TodoScanner::Marker> after = scanner.markers("a.cpp");
+    QCOMPARE(after[0].line, 3);
+    QCOMPARE(after[0].taskId, edited);
+    QCOMPARE(after[1].taskId, generated);
+    QCOMPARE(model.rowCount(), 2);
+}
+
+void TestTodoScanner::testCacheAcrossSessions()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString cache = dir.filePath("todo.cache");
+    QDir(dir.path()).mkdir("tree");
+    const QString tree = dir.filePath("tree");
+    writeFile(tree + "/a.cpp", "// TODO first\n");
+    writeFile(tree + "/b.cpp", "// TODO second\n");
+
+    TaskModel model;
+    {
+        TodoScanner scanner;
+        scanner.attach(&model);
+        QVERIFY(scanner.open(tree, cache));
+        scanner.waitForScan();
+        QCOMPARE(model.rowCount(), 2);
+    }
+
+    // Same model: nothing is searched again and no task is duplicated
+    {
+        TodoScanner scanner;
+        scanner.attach(&model);
+        QSignalSpy scanned(&scanner, &TodoScanner::scanned);
+        QVERIFY(scanner.open(tree, cache));
+        scanner.waitForScan();
+        QCOMPARE(scanned[0][1].toInt(), 0);
+        QCOMPARE(scanned[0][2].toInt(), 0);
+        QCOMPARE(model.rowCount(), 2);
+    }
+
+    // A model without the tasks gets them back
+    TaskModel fresh;
+    TodoScanner scanner;
+    scanner.attach(&fresh);
+    QVERIFY(scanner.open(tree, cache));
+    scanner.waitForScan();
+    QCOMPARE(fresh.rowCount(), 2);
+    QVERIFY(rowOf(fresh, "TODO second") >= 0);
+}
+
+QTEST_MAIN(TestTodoScanner)
+#include "test_todo_scanner.moc"
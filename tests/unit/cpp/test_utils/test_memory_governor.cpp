@@ -0,0 +1,182 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryFile>
+#include "utils/MemoryGovernor.h"
+#include "models/TaskModel.h"
+
+class TestMemoryGovernor : public QObject
+{
+    Q_OBJECT
+
+private:
+    static void writePressure(QTemporaryFile &file, double some, double full);
+
+private slots:
+    // Sampling tests
+    void testReadPressure();
+    void testReadResidentBytes();
+    void testPressureLevels();
+
+    // Shedding tests
+    void testShedOrder();
+    void testOwnerDestroyed();
+    void testMeasuredSizes();
+    void testModelCaches();
+};
+
+void TestMemoryGovernor::writePressure(QTemporaryFile &file, double some, double full)
+{
+    QVERIFY(file.isOpen() || file.open());
+    file.resize(0);
+    file.seek(0);
+    file.write(QString("some avg10=%1 avg60=0.00 avg300=0.00 total=100\n"
+                       "full avg10=%2 avg60=0.00 avg300=0.00 total=10\n").arg(some, 0, 'f', 2).arg(full, 0, 'f', 2).toUtf8());
+    file.flush();
+}
+
+void TestMemoryGovernor::testReadPressure()
+{
+    QTemporaryFile file;
+    writePressure(file, 12.5, 1.25);
+
+    const MemoryGovernor::PressureSample sample = MemoryGovernor::readPressure(file.fileName());
+    QVERIFY(sample.valid);
+    QCOMPARE(sample.someAvg10, 12.5);
+    QCOMPARE(sample.fullAvg10, 1.25);
+
+    QVERIFY(!MemoryGovernor::readPressure("/nonexistent/pressure").valid);
+}
+
+void TestMemoryGovernor::testReadResidentBytes()
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+    QVERIFY(MemoryGovernor::readResidentBytes() > 0);
+#else
+    QSKIP("Resident set size is not available on this platform");
+#endif
+}
+
+void TestMemoryGovernor::testPressureLevels()
+{
+    QTemporaryFile file;
+    MemoryGovernor governor;
+    governor.setPressurePath(file.fileName());
+
+    int disposable = 0;
+    int rebuildable = 0;
+    governor.registerCache("disposable", MemoryGovernor::Disposable, this,
+                           []() { return qint64(100); }, [&disposable]() { ++disposable; return qint64(100); });
+    governor.registerCache("rebuildable", MemoryGovernor::Rebuildable, this,
+                           []() { return qint64(100); }, [&rebuildable]() { ++rebuildable; return qint64(100); });
+
+    writePressure(file, 1.0, 0.0);
+    governor.sample();
+    QCOMPARE(governor.level(), MemoryGovernor::Normal);
+    QCOMPARE(disposable, 0);
+
+    writePressure(file, 15.0, 0.0);
+    governor.sample();
+    QCOMPARE(governor.level(), MemoryGovernor::Elevated);
+    QCOMPARE(disposable, 1);
+    QCOMPARE(rebuildable, 0);
+
+    // Unchanged level: not shed again before RepeatInterval
+    governor.sample();
+    QCOMPARE(disposable, 1);
+
+    writePressure(file, 50.0, 12.0);
+    governor.sample();
+    QCOMPARE(governor.level(), MemoryGovernor::Critical);
+    QCOMPARE(disposable, 2);
+    QCOMPARE(rebuildable, 1);
+    QCOMPARE(governor.shedBytes(), qint64(300));
+}
+
+void TestMemoryGovernor::testShedOrder()
+{
+    MemoryGovernor governor;
+    QStringList order;
+    const auto add = [&](const QString &name, MemoryGovernor::CachePriority priority) {
+        governor.registerCache(name, priority, this, []() { return qint64(10); },
+                               [&order, name]() { order.append(name); return qint64(10); });
+    };
+    add("expensive", MemoryGovernor::Expensive);
+    add("rebuildable", MemoryGovernor::Rebuildable);
+    add("disposable", MemoryGovernor::Disposable);
+
+    QSignalSpy spy(&governor, &MemoryGovernor::cacheShed);
+    QCOMPARE(governor.shed(MemoryGovernor::Rebuildable), qint64(20));
+    QCOMPARE(order, QStringList({"disposable", "rebuildable"}));
+    QCOMPARE(spy.count(), 2);
+
+    order.clear();
+    QCOMPARE(governor.shed(MemoryGovernor::Expensive, 15), qint64(20));
+    QCOMPARE(order, QStringList({"disposable", "rebuildable"}));
+
+    const QList<MemoryGovernor::CacheInfo> caches = governor.caches();
+    QCOMPARE(caches.size(), 3);
+    QCOMPARE(caches[0].name, "disposable");
+    QCOMPARE(caches[0].shedCount, 2);
+    QCOMPARE(caches[0].bytes, qint64(10));
+    QCOMPARE(caches[2].shedCount, 0);
+}
+
+void TestMemoryGovernor::testOwnerDestroyed()
+{
+    MemoryGovernor governor;
+    QObject *owner = new QObject;
+    governor.registerCache("owned", MemoryGovernor::Disposable, owner,
+                           []() { return qint64(1); }, []() { return qint64(1); });
+    QCOMPARE(governor.caches().size(), 1);
+
+    delete owner;
+    QVERIFY(governor.caches().isEmpty());
+    QCOMPARE(governor.shed(MemoryGovernor::Expensive), qint64(0));
+}
+
+void TestMemoryGovernor::testMeasuredSizes()
+{
+    MemoryGovernor governor;
+    int measured = 0;
+    qint64 size = 100;
+    governor.registerCache("measured", MemoryGovernor::Disposable, this,
+                           [&]() { ++measured; return size; }, [&]() { size = 10; return qint64(90); });
+    QCOMPARE(measured, 1);
+
+    // Reading the sizes does not measure the caches again.
+    size = 200;
+    QCOMPARE(governor.caches().constFirst().bytes, qint64(100));
+    QCOMPARE(measured, 1);
+
+    governor.measure();
+    QCOMPARE(governor.caches().constFirst().bytes, qint64(200));
+
+    // Shedding measures what is left.
+    governor.shed(MemoryGovernor::Disposable);
+    QCOMPARE(governor.caches().constFirst().bytes, qint64(10));
+    QCOMPARE(measured, 3);
+}
+
+void TestMemoryGovernor::testModelCaches()
+{
+    TaskModel model;
+    for (int i = 0; i < 100; ++i)
+        model.addTask(QString("Task %1").arg(i), QString("Description %1").arg(i));
+
+    QCOMPARE(model.findTasks("task 42"), QList<int>({42}));
+    const qint64 indexSize = model.searchIndexSize();
+    QVERIFY(indexSize > 0);
+    QCOMPARE(model.releaseSearchIndex(), indexSize);
+    QVERIFY(model.searchIndexSize() < indexSize / 2);
+
+    // The index is rebuilt on demand
+    QCOMPARE(model.findTasks("description 7"), QList<int>({7, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79}));
+
+    model.getTask(0);
+    QVERIFY(model.recordCacheSize() > 0);
+    model.releaseRecordCache();
+    QCOMPARE(model.getTask(0).getTitle(), "Task 0");
+}
+
+QTEST_MAIN(TestMemoryGovernor)
+#include "test_memory_governor.moc"
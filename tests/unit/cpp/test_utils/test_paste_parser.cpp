@@ -0,0 +1,129 @@
+#include <QTest>
+#include "utils/PasteParser.h"
+
+class TestPasteParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Line tests
+    void testOneTaskPerLine();
+    void testListMarkers();
+    void testIsList();
+
+    // Marker tests
+    void testPriorityMarkers();
+    void testTagsAndAssignee();
+    void testOnlyMarkers();
+
+    // Spreadsheet tests
+    void testCells();
+    void testQuotedCells();
+};
+
+void TestPasteParser::testOneTaskPerLine()
+{
+    const QList<PasteParser::Entry> entries = PasteParser::parse("Buy milk\r\n\r\n  Call Bob  \rWrite   report\n");
+    QCOMPARE(entries.size(), 3);
+    QCOMPARE(entries[0].title, QString("Buy milk"));
+    QCOMPARE(entries[1].title, QString("Call Bob"));
+    QCOMPARE(entries[1].line, 3);
+    QCOMPARE(entries[2].title, QString("Write report"));
+    QCOMPARE(entries[2].line, 4);
+    QCOMPARE(entries[2].priority, 1);
+    QVERIFY(PasteParser::parse("\n \n\t\n").isEmpty());
+}
+
+void TestPasteParser::testListMarkers()
+{
+    const QList<PasteParser::Entry> entries = PasteParser::parse(
+        "- Agenda\n* Notes\n• Minutes\n12. Budget\n3) Travel\n- [ ] Open item\n- [x] Done item\n-5 degrees\n");
+    QCOMPARE(entries.size(), 8);
+    QCOMPARE(entries[0].title, QString("Agenda"));
+    QCOMPARE(entries[1].title, QString("Notes"));
+    QCOMPARE(entries[2].title, QString("Minutes"));
+    QCOMPARE(entries[3].title, QString("Budget"));
+    QCOMPARE(entries[4].title, QString("Travel"));
+    QCOMPARE(entries[5].title, QString("Open item"));
+    QVERIFY(!entries[5].completed);
+    QCOMPARE(entries[6].title, QString("Done item"));
+    QVERIFY(entries[6].completed);
+    QCOMPARE(entries[7].title, QString("-5 degrees"));
+}
+
+void TestPasteParser::testIsList()
+{
+    QVERIFY(!PasteParser::isList("One line"));
+    QVERIFY(!PasteParser::isList("One line\n\n   \n"));
+    QVERIFY(PasteParser::isList("One\nTwo"));
+    QVERIFY(PasteParser::isList("One\r\n  Two"));
+}
+
+void TestPasteParser::testPriorityMarkers()
+{
+    const QList<PasteParser::Entry> entries = PasteParser::parse(
+        "Fix login !!!\n! Water plants\nPlan offsite !!\nShip it !HIGH\nNo marker\nWow! Great\n", 0);
+    QCOMPARE(entries.size(), 6);
+    QCOMPARE(entries[0].title, QString("Fix login"));
+    QCOMPARE(entries[0].priority, 2);
+    QVERIFY(entries[0].marked);
+    QCOMPARE(entries[1].priority, 0);
+    QCOMPARE(entries[2].priority, 1);
+    QCOMPARE(entries[3].priority, 2);
+    QCOMPARE(entries[4].priority, 0);
+    QVERIFY(!entries[4].marked);
+    QCOMPARE(entries[5].title, QString("Wow! Great"));
+}
+
+void TestPasteParser::testTagsAndAssignee()
+{
+    const QList<PasteParser::Entry> entries = PasteParser::parse("Book flights #travel @ana #q3 mail bob@example.com\n");
+    QCOMPARE(entries.size(), 1);
+    QCOMPARE(entries[0].title, QString("Book flights mail bob@example.com"));
+    QCOMPARE(entries[0].assignee, QString("ana"));
+    QCOMPARE(entries[0].tags, QStringList({"travel", "q3"}));
+    QCOMPARE(entries[0].description, QString("#travel #q3"));
+}
+
+void TestPasteParser::testOnlyMarkers()
+{
+    const QList<PasteParser::Entry> entries = PasteParser::parse("#1\n@home !!!\n", 0);
+    QCOMPARE(entries.size(), 2);
+    QCOMPARE(entries[0].title, QString("#1"));
+    QVERIFY(entries[0].tags.isEmpty());
+    QCOMPARE(entries[1].title, QString("@home !!!"));
+    QVERIFY(entries[1].assignee.isEmpty());
+    QCOMPARE(entries[1].priority, 0);
+}
+
+void TestPasteParser::testCells()
+{
+    const QList<PasteParser::Entry> entries = PasteParser::parse("Review budget\tFinance\t\tQ3 numbers\n\tOnly in column B\n");
+    QCOMPARE(entries.size(), 2);
+    QCOMPARE(entries[0].title, QString("Review budget"));
+    QCOMPARE(entries[0].description, QString("Finance\nQ3 numbers"));
+    QCOMPARE(entries[1].title, QString("Only in column B"));
+    QVERIFY(entries[1].description.isEmpty());
+}
+
+void TestPasteParser::testQuotedCells()
+{
+    const QList<PasteParser::Entry> entries = PasteParser::parse(
+        "\"Call the \"\"new\"\" vendor\"\t\"Ask about\nshipping\ttimes\"\n"
+        "\"Quoted\" at the start\n"
+        "Last line\n");
+    QCOMPARE(entries.size(), 3);
+    QCOMPARE(entries[0].title, QString("Call the \"new\" vendor"));
+    QCOMPARE(entries[0].description, QString("Ask about\nshipping\ttimes"));
+    QCOMPARE(entries[1].title, QString("\"Quoted\" at the start"));
+    QCOMPARE(entries[1].line, 3);
+    QCOMPARE(entries[2].line, 4);
+
+    // An unclosed quote is text
+    const QList<PasteParser::Entry> unclosed = PasteParser::parse("\"Open\nSecond\n");
+    QCOMPARE(unclosed.size(), 2);
+    QCOMPARE(unclosed[0].title, QString("\"Open"));
+}
+
+QTEST_MAIN(TestPasteParser)
+#include "test_paste_parser.moc"
@@ -0,0 +1,214 @@
+#include <QTest>
+#include <QRegularExpression>
+#include "utils/ScheduleGraph.h"
+
+class TestScheduleGraph : public QObject
+{
+    Q_OBJECT
+
+private:
+    static void diamond(ScheduleGraph &graph);
+    static void chain(ScheduleGraph &graph, int length);
+
+private slots:
+    // Critical path tests
+    void testTimes();
+    void testCriticalPath();
+    void testMilestones();
+
+    // Incremental update tests
+    void testUnaffectedTasks();
+    void testCutoff();
+    void testBatchedEdits();
+
+    // Edge tests
+    void testCycles();
+    void testWaitingDependencies();
+    void testRemoveTask();
+};
+
+void TestScheduleGraph::diamond(ScheduleGraph &graph)
+{
+    // 1 (8h) and 2 (4h) before 3 (2h); 4 (5h) on its own.
+    graph.addTask(1, 8);
+    graph.addTask(2, 4);
+    graph.addTask(3, 2);
+    graph.addTask(4, 5);
+    QVERIFY(graph.setDependencies(3, {1, 2}));
+}
+
+void TestScheduleGraph::chain(ScheduleGraph &graph, int length)
+{
+    for (int id = 1; id <= length; ++id)
+    {
+        graph.addTask(id, 1);
+        if (id > 1)
+            graph.setDependencies(id, {quint64(id - 1)});
+    }
+}
+
+void TestScheduleGraph::testTimes()
+{
+    ScheduleGraph graph;
+    diamond(graph);
+
+    QCOMPARE(graph.projectEnd(), qint64(10));
+    QCOMPARE(graph.times(3).earliestStart, qint64(8));
+    QCOMPARE(graph.times(3).earliestFinish, qint64(10));
+    QCOMPARE(graph.times(2).earliestStart, qint64(0));
+    QCOMPARE(graph.times(2).latestStart, qint64(4));
+    QCOMPARE(graph.times(2).latestFinish, qint64(8));
+    QCOMPARE(graph.times(2).slack, qint64(4));
+    QCOMPARE(graph.times(4).slack, qint64(5));
+    QCOMPARE(graph.times(99).earliestFinish, qint64(0));
+    QCOMPARE(graph.predecessors(3), QList<quint64>({1, 2}));
+    QCOMPARE(graph.successors(1), QList<quint64>({3}));
+}
+
+void TestScheduleGraph::testCriticalPath()
+{
+    ScheduleGraph graph;
+    diamond(graph);
+    QCOMPARE(graph.criticalPath(), QList<quint64>({1, 3}));
+    QVERIFY(graph.times(1).critical());
+    QVERIFY(!graph.times(2).critical());
+
+    // A longer independent task becomes the whole critical path
+    graph.setDuration(4, 12);
+    QCOMPARE(graph.projectEnd(), qint64(12));
+    QCOMPARE(graph.criticalPath(), QList<quint64>({4}));
+    QCOMPARE(graph.times(1).slack, qint64(2));
+    QCOMPARE(graph.times(3).latestStart, qint64(10));
+}
+
+void TestScheduleGraph::testMilestones()
+{
+    ScheduleGraph graph;
+    graph.addTask(1, 6);
+    graph.addTask(2, 0);
+    graph.addTask(3, -4);
+    graph.setDependencies(2, {1});
+
+    QCOMPARE(graph.times(2).earliestStart, qint64(6));
+    QCOMPARE(graph.times(2).earliestFinish, qint64(6));
+    QCOMPARE(graph.times(3).earliestFinish, qint64(0));
+    QCOMPARE(graph.criticalPath(), QList<quint64>({1, 2}));
+}
+
+void TestScheduleGraph::testUnaffectedTasks()
+{
+    ScheduleGraph graph;
+    chain(graph, 100);
+    graph.addTask(1000, 1);
+    QCOMPARE(graph.projectEnd(), qint64(100));
+
+    // An independent task is recomputed alone, once forward and once backward
+    graph.setDuration(1000, 2);
+    const QList<quint64> changed = graph.update();
+    QCOMPARE(changed, QList<quint64>({1000}));
+    QCOMPARE(graph.lastUpdateSize(), 2);
+    QCOMPARE(graph.times(1000).slack, qint64(98));
+
+    // Nothing to do without edits
+    QVERIFY(graph.update().isEmpty());
+    QCOMPARE(graph.lastUpdateSize(), 0);
+}
+
+void TestScheduleGraph::testCutoff()
+{
+    ScheduleGraph graph;
+    chain(graph, 100);
+    graph.addTask(500, 1);
+    graph.setDependencies(60, {59, 500});
+    QCOMPARE(graph.times(60).earliestStart, qint64(59));
+
+    // Task 60 still waits for 59, so its dependents are not recomputed
+    graph.setDuration(500, 10);
+    graph.update();
+    QCOMPARE(graph.lastUpdateSize(), 3);
+    QCOMPARE(graph.times(60).earliestStart, qint64(59));
+    QCOMPARE(graph.times(61).earliestStart, qint64(60));
+    QCOMPARE(graph.times(500).slack, qint64(49));
+
+    // Now it is later than 59 and moves the rest of the chain
+    graph.setDuration(500, 70);
+    QCOMPARE(graph.times(60).earliestStart, qint64(70));
+    QCOMPARE(graph.projectEnd(), qint64(111));
+    QCOMPARE(graph.criticalPath().first(), quint64(500));
+    QCOMPARE(graph.times(1).slack, qint64(11));
+}
+
+void TestScheduleGraph::testBatchedEdits()
+{
+    ScheduleGraph graph;
+    chain(graph, 50);
+    graph.update();
+
+    // Several edits before a query are recomputed together
+    for (quint64 id = 1; id <= 50; ++id)
+        graph.setDuration(id, 2);
+    QCOMPARE(graph.update().size(), 50);
+    QCOMPARE(graph.lastUpdateSize(), 100);
+    QCOMPARE(graph.projectEnd(), qint64(100));
+}
+
+void TestScheduleGraph::testCycles()
+{
+    ScheduleGraph graph;
+    diamond(graph);
+
+    QVERIFY(graph.wouldCycle(1, 3));
+    QVERIFY(graph.wouldCycle(1, 1));
+    QVERIFY(!graph.wouldCycle(3, 4));
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("closing a cycle"));
+    QVERIFY(!graph.setDependencies(1, {3, 4}));
+    QCOMPARE(graph.predecessors(1), QList<quint64>({4}));
+    QCOMPARE(graph.times(1).earliestStart, qint64(5));
+    QCOMPARE(graph.projectEnd(), qint64(15));
+
+    // Once the other direction is gone, setting the dependencies again connects the edge
+    graph.setDependencies(3, {2});
+    QVERIFY(graph.setDependencies(1, {3, 4}));
+    QCOMPARE(graph.times(1).earliestStart, qint64(6));
+}
+
+void TestScheduleGraph::testWaitingDependencies()
+{
+    ScheduleGraph graph;
+    graph.addTask(7, 3);
+    QVERIFY(graph.setDependencies(7, {8}));
+    QCOMPARE(graph.times(7).earliestStart, qint64(0));
+    QVERIFY(graph.predecessors(7).isEmpty());
+
+    graph.addTask(8, 5);
+    QCOMPARE(graph.times(7).earliestStart, qint64(5));
+    QCOMPARE(graph.projectEnd(), qint64(8));
+}
+
+void TestScheduleGraph::testRemoveTask()
+{
+    ScheduleGraph graph;
+    diamond(graph);
+    graph.update();
+
+    graph.removeTask(1);
+    QVERIFY(!graph.contains(1));
+    QCOMPARE(graph.size(), 3);
+    QCOMPARE(graph.times(3).earliestStart, qint64(4));
+    QCOMPARE(graph.projectEnd(), qint64(6));
+    QCOMPARE(graph.criticalPath(), QList<quint64>({2, 3}));
+
+    // Dependents wait for a removed task to come back
+    graph.addTask(1, 1);
+    QCOMPARE(graph.times(3).earliestStart, qint64(4));
+    graph.setDuration(1, 9);
+    QCOMPARE(graph.times(3).earliestStart, qint64(9));
+
+    graph.clear();
+    QCOMPARE(graph.size(), 0);
+    QCOMPARE(graph.projectEnd(), qint64(0));
+}
+
+QTEST_MAIN(TestScheduleGraph)
+#include "test_schedule_graph.moc"
@@ -0,0 +1,247 @@
+#include <QTest>
+#include "utils/SlotPlanner.h"
+
+class TestSlotPlanner : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QList<SlotPlanner::Item> backlog(int size);
+    static QList<SlotPlanner::Window> week();
+
+private slots:
+    // Greedy placement tests
+    void testPriorityOrder();
+    void testDependencies();
+    void testSplitAndUnplaced();
+    void testCycles();
+    void testLocalSearch();
+
+    // Incremental planning tests
+    void testUnchanged();
+    void testIncremental();
+
+    // Calendar tests
+    void testWorkingHours();
+    void testLargeBacklog();
+};
+
+QList<SlotPlanner::Item> TestSlotPlanner::backlog(int size)
+{
+    QList<SlotPlanner::Item> items;
+    for (int id = 1; id <= size; ++id)
+        items.append({quint64(id), 30, id % 3, {}});
+    return items;
+}
+
+QList<SlotPlanner::Window> TestSlotPlanner::week()
+{
+    // Five days of eight hours, in minutes
+    QList<SlotPlanner::Window> windows;
+    for (int day = 0; day < 5; ++day)
+        windows.append({day * 1440 + 540, day * 1440 + 1020});
+    return windows;
+}
+
+void TestSlotPlanner::testPriorityOrder()
+{
+    SlotPlanner planner;
+    planner.setWindows({{0, 480}, {1440, 1920}});
+    planner.plan({{1, 120, 0, {}}, {2, 60, 2, {}}, {3, 120, 1, {}}});
+
+    QCOMPARE(planner.order(), QList<quint64>({2, 3, 1}));
+    QCOMPARE(planner.slots().size(), 3);
+    QCOMPARE(planner.slots()[0].taskId, quint64(2));
+    QCOMPARE(planner.slots()[1].start, qint64(60));
+    QCOMPARE(planner.finish(1), qint64(300));
+    QCOMPARE(planner.cost(), qint64(100 * 60 + 10 * 180 + 300));
+    QVERIFY(planner.unplaced().isEmpty());
+}
+
+void TestSlotPlanner::testDependencies()
+{
+    SlotPlanner planner;
+    planner.setWindows({{0, 480}});
+
+    // The urgent task waits for its prerequisite; unknown prerequisites are ignored
+    planner.plan({{1, 60, 0, {}}, {2, 60, 2, {1, 99}}});
+    QCOMPARE(planner.order(), QList<quint64>({1, 2}));
+    QCOMPARE(planner.slotsOf(2).first().start, qint64(60));
+}
+
+void TestSlotPlanner::testSplitAndUnplaced()
+{
+    SlotPlanner planner;
+    planner.setWindows({{1440, 1560}, {0, 120}});
+    QCOMPARE(planner.windows().first().start, qint64(0));
+
+    // Three hours fit in no window: the task takes the first two in turn
+    planner.plan({{1, 180, 1, {}}, {2, 120, 0, {}}, {3, 30, 0, {2}}});
+    const QList<SlotPlanner::Slot> parts = planner.slotsOf(1);
+    QCOMPARE(parts.size(), 2);
+    QCOMPARE(parts[0].end, qint64(120));
+    QCOMPARE(parts[1].start, qint64(1440));
+    QCOMPARE(parts[1].end, qint64(1500));
+
+    // Only an hour is left: the next task does not fit, nor does its dependent
+    QCOMPARE(planner.unplaced(), QList<quint64>({2, 3}));
+    QCOMPARE(planner.finish(2), qint64(0));
+}
+
+void TestSlotPlanner::testCycles()
+{
+    SlotPlanner planner;
+    planner.setWindows({{0, 480}});
+    planner.plan({{1, 60, 2, {2}}, {2, 60, 2, {1}}, {3, 60, 0, {}}});
+    QCOMPARE(planner.slotsOf(3).first().start, qint64(0));
+    QCOMPARE(planner.unplaced(), QList<quint64>({1, 2}));
+}
+
+void TestSlotPlanner::testLocalSearch()
+{
+    const QList<SlotPlanner::Window> windows{{0, 240}, {1440, 1920}};
+    const QList<SlotPlanner::Item> items{{1, 180, 1, {}}, {2, 240, 1, {}}, {3, 240, 1, {}}};
+
+    // Shortest first leaves an hour unused on the first day
+    SlotPlanner greedy;
+    greedy.setWindows(windows);
+    greedy.setSearchBudget(0);
+    greedy.plan(items);
+    QCOMPARE(greedy.slotsOf(2).first().start, qint64(1440));
+    QCOMPARE(greedy.cost(), qint64(10 * (180 + 1680 + 1920)));
+
+    // Swapping the first two fills the first day
+    SlotPlanner planner;
+    planner.setWindows(windows);
+    planner.plan(items);
+    QCOMPARE(planner.order(), QList<quint64>({2, 1, 3}));
+    QCOMPARE(planner.slotsOf(2).first().start, qint64(0));
+    QCOMPARE(planner.slotsOf(1).first().start, qint64(1440));
+    QCOMPARE(planner.cost(), qint64(10 * (240 + 1620 + 1860)));
+}
+
+void TestSlotPlanner::testUnchanged()
+{
+    SlotPlanner planner;
+    planner.setWindows(week());
+    planner.plan(backlog(300));
+    QCOMPARE(planner.lastPlanSize(), 300);
+    QCOMPARE(planner.slots().size(), 80);
+    QCOMPARE(planner.unplaced().size(), 220);
+
+    const QList<SlotPlanner::Slot> slots = planner.slots();
+    planner.plan(backlog(300));
+    QCOMPARE(planner.lastPlanSize(), 0);
+    QCOMPARE(planner.slots().size(), slots.size());
+
+    // New free time starts over
+    planner.setWindows(week());
+    planner.plan(backlog(300));
+    QCOMPARE(planner.lastPlanSize(), 300);
+}
+
+void TestSlotPlanner::testIncremental()
+{
+    SlotPlanner planner;
+    planner.setWindows(week());
+    planner.setSearchBudget(0);
+    QList<SlotPlanner::Item> items = backlog(300);
+    planner.plan(items);
+
+    // The last low priority task only gets longer: it alone is placed again
+    items.last().duration = 60;
+    planner.plan(items);
+    QCOMPARE(planner.lastPlanSize(), 1);
+
+    items.append({301, 90, 0, {}});
+    planner.plan(items);
+    QCOMPARE(planner.lastPlanSize(), 1);
+
+    // A low priority task becoming urgent is placed before the other low ones
+    items[2].priority = 2;
+    planner.plan(items);
+    QVERIFY(planner.lastPlanSize() > 1);
+    QVERIFY(planner.lastPlanSize() < 301);
+
+    // The incremental plan is the plan from scratch
+    SlotPlanner fresh;
+    fresh.setWindows(week());
+    fresh.setSearchBudget(0);
+    fresh.plan(items);
+    QCOMPARE(planner.order(), fresh.order());
+    QCOMPARE(planner.cost(), fresh.cost());
+
+    // A task waiting for a new one is placed again after it
+    items.append({302, 30, 2, {}});
+    items[1].dependencies = {302};
+    planner.plan(items);
+    QVERIFY(planner.finish(302) <= planner.slotsOf(2).first().start);
+
+    // Removing the first task of the order places all others again
+    const quint64 first = planner.order().first();
+    for (int i = 0; i < items.size(); ++i)
+    {
+        if (items[i].id == first)
+            items.removeAt(i);
+    }
+    planner.plan(items);
+    QCOMPARE(planner.lastPlanSize(), int(items.size()));
+}
+
+void TestSlotPlanner::testWorkingHours()
+{
+    // From Friday afternoon over the weekend to Monday
+    const QDateTime friday(QDate(2026, 10, 23), QTime(13, 0));
+    const QList<SlotPlanner::Window> windows = SlotPlanner::workingHours(friday, 4, QTime(9, 0), QTime(17, 0));
+    QCOMPARE(windows.size(), 2);
+    QCOMPARE(windows[0].start, SlotPlanner::toMinutes(friday));
+    QCOMPARE(windows[0].end - windows[0].start, qint64(240));
+    QCOMPARE(SlotPlanner::toDateTime(windows[1].start), QDateTime(QDate(2026, 10, 26), QTime(9, 0)));
+}
+
+void TestSlotPlanner::testLargeBacklog()
+{
+    // Four weeks of working hours for 3000 tasks of mixed sizes and chains of prerequisites
+    QList<SlotPlanner::Window> windows;
+    for (int day = 0; day < 28; ++day)
+        windows.append({day * 1440 + 540, day * 1440 + 1020});
+    QList<SlotPlanner::Item> items;
+    for (int id = 1; id <= 3000; ++id)
+    {
+        SlotPlanner::Item item{quint64(id), 15 + (id * 37) % 600, (id * 7) % 3, {}};
+        if (id % 5 == 0)
+            item.dependencies = {quint64(id - 3)};
+        items.append(item);
+    }
+
+    SlotPlanner planner;
+    planner.setWindows(windows);
+    planner.plan(items);
+    QCOMPARE(planner.order().size(), 3000);
+    QVERIFY(!planner.slots().isEmpty());
+
+    // Slots do not overlap, lie in the free time, and follow their prerequisites
+    const QList<SlotPlanner::Slot> &slots = planner.slots();
+    for (int i = 1; i < slots.size(); ++i)
+        QVERIFY(slots[i - 1].end <= slots[i].start);
+    int window = 0;
+    for (const SlotPlanner::Slot &slot : slots)
+    {
+        while (windows[window].end <= slot.start)
+            ++window;
+        QVERIFY(windows[window].start <= slot.start && slot.end <= windows[window].end);
+    }
+    for (const SlotPlanner::Item &item : items)
+    {
+        const QList<SlotPlanner::Slot> parts = planner.slotsOf(item.id);
+        qint64 length = 0;
+        for (const SlotPlanner::Slot &part : parts)
+            length += part.end - part.start;
+        QVERIFY(parts.isEmpty() || length == item.duration);
+        for (quint64 dependency : item.dependencies)
+            QVERIFY(parts.isEmpty() || (planner.finish(dependency) > 0 && planner.finish(dependency) <= parts.first().start));
+    }
+}
+
+QTEST_MAIN(TestSlotPlanner)
+#include "test_slot_planner.moc"
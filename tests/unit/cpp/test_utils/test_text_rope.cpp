@@ -0,0 +1,132 @@
+#include <QTest>
+#include "utils/TextRope.h"
+
+class TestTextRope : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Construction tests
+    void testEmptyRope();
+    void testConstructFromLongText();
+
+    // Editing tests
+    void testReplace();
+    void testReplaceAcrossChunks();
+    void testReplaceClampsRange();
+
+    // Lookup tests
+    void testLineAt();
+    void testLineStart();
+    void testMid();
+};
+
+void TestTextRope::testEmptyRope()
+{
+    TextRope rope;
+    QVERIFY(rope.isEmpty());
+    QCOMPARE(rope.size(), 0);
+    QCOMPARE(rope.lineCount(), 1);
+    QCOMPARE(rope.toString(), QString());
+    QCOMPARE(rope.lineStart(0), 0);
+    QCOMPARE(rope.lineStart(1), -1);
+}
+
+void TestTextRope::testConstructFromLongText()
+{
+    const QString text = QString("0123456789\n").repeated(1000);
+    TextRope rope(text);
+
+    QCOMPARE(rope.size(), text.size());
+    QCOMPARE(rope.lineCount(), 1001);
+    QCOMPARE(rope.toString(), text);
+}
+
+void TestTextRope::testReplace()
+{
+    TextRope rope("first line\nsecond line");
+
+    rope.replace(0, 5, "1st");
+    QCOMPARE(rope.toString(), "1st line\nsecond line");
+
+    rope.replace(rope.size(), 0, "\nthird line");
+    QCOMPARE(rope.toString(), "1st line\nsecond line\nthird line");
+    QCOMPARE(rope.lineCount(), 3);
+
+    rope.replace(8, 1, " ");
+    QCOMPARE(rope.toString(), "1st line second line\nthird line");
+    QCOMPARE(rope.lineCount(), 2);
+}
+
+void TestTextRope::testReplaceAcrossChunks()
+{
+    QString reference = QString("abcdefghij").repeated(500);
+    TextRope rope(reference);
+
+    // Ranges spanning several chunks take the split/merge path
+    rope.replace(900, 2500, "XYZ");
+    reference.replace(900, 2500, "XYZ");
+    QCOMPARE(rope.toString(), reference);
+
+    const QString block = QString("line\n").repeated(600);
+    rope.replace(10, 0, block);
+    reference.insert(10, block);
+    QCOMPARE(rope.toString(), reference);
+    QCOMPARE(rope.lineCount(), 601);
+
+    // Keystroke-sized edits after fragmentation
+    for (int i = 0; i < 200; ++i)
+    {
+        rope.replace(i * 7, 1, "#");
+        reference.replace(i * 7, 1, "#");
+    }
+    QCOMPARE(rope.toString(), reference);
+}
+
+void TestTextRope::testReplaceClampsRange()
+{
+    TextRope rope("abc");
+    rope.replace(2, 100, "Z");
+    QCOMPARE(rope.toString(), "abZ");
+
+    rope.replace(-5, 1, "Y");
+    QCOMPARE(rope.toString(), "YbZ");
+}
+
+void TestTextRope::testLineAt()
+{
+    TextRope rope("ab\ncd\n\nef");
+    QCOMPARE(rope.lineAt(0), 0);
+    QCOMPARE(rope.lineAt(2), 0);
+    QCOMPARE(rope.lineAt(3), 1);
+    QCOMPARE(rope.lineAt(6), 2);
+    QCOMPARE(rope.lineAt(7), 3);
+    QCOMPARE(rope.lineAt(100), 3);
+}
+
+void TestTextRope::testLineStart()
+{
+    TextRope rope("ab\ncd\n\nef");
+    QCOMPARE(rope.lineStart(0), 0);
+    QCOMPARE(rope.lineStart(1), 3);
+    QCOMPARE(rope.lineStart(2), 6);
+    QCOMPARE(rope.lineStart(3), 7);
+    QCOMPARE(rope.lineStart(4), -1);
+
+    // Lines beyond the first chunk
+    TextRope longRope(QString("0123456789\n").repeated(1000));
+    QCOMPARE(longRope.lineStart(500), 5500);
+    QCOMPARE(longRope.lineAt(5500), 500);
+}
+
+void TestTextRope::testMid()
+{
+    const QString text = QString("0123456789").repeated(300);
+    TextRope rope(text);
+    QCOMPARE(rope.mid(1020, 10), text.mid(1020, 10));
+    QCOMPARE(rope.mid(2995, 100), text.mid(2995));
+    QCOMPARE(rope.mid(5000, 10), QString());
+}
+
+QTEST_MAIN(TestTextRope)
+#include "test_text_rope.moc"
@@ -0,0 +1,165 @@
+#include <QTest>
+#include <QDataStream>
+#include "utils/TextScanner.h"
+
+class TestTextScanner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    // Search tests
+    void testFindIsCaseInsensitive();
+    void testFindMatchesDescription();
+    void testFindEmptyText();
+    void testMatchDoesNotSpanRows();
+
+    // Row maintenance tests
+    void testInsertUpdateRemove();
+    void testSaveAndLoadArena();
+
+    // Kernel tests
+    void testIndexOfMatchesScalarSearch();
+    void testByteIndexOfMatchesScalarSearch();
+    void testParallelScan();
+
+private:
+    TextScanner *scanner;
+};
+
+void TestTextScanner::init()
+{
+    scanner = new TextScanner;
+    scanner->insert(0, "Buy groceries", "Milk, bread, and eggs");
+    scanner->insert(1, "Code review", "Review pull requests");
+    scanner->insert(2, "Documentation", "Write project documentation");
+}
+
+void TestTextScanner::cleanup()
+{
+    delete scanner;
+    scanner = nullptr;
+}
+
+void TestTextScanner::testFindIsCaseInsensitive()
+{
+    QCOMPARE(scanner->find("BUY"), QList<int>({0}));
+    QCOMPARE(scanner->find("review"), QList<int>({1}));
+    QCOMPARE(scanner->find("DoCuMeNtAtIoN"), QList<int>({2}));
+}
+
+void TestTextScanner::testFindMatchesDescription()
+{
+    QCOMPARE(scanner->find("bread"), QList<int>({0}));
+    QCOMPARE(scanner->find("e"), QList<int>({0, 1, 2}));
+    QVERIFY(scanner->find("nothing like this").isEmpty());
+}
+
+void TestTextScanner::testFindEmptyText()
+{
+    QVERIFY(scanner->find("").isEmpty());
+}
+
+void TestTextScanner::testMatchDoesNotSpanRows()
+{
+    // "eggs" ends row 0 and "Code" starts row 1; "eggscode" must not match
+    QVERIFY(scanner->find("eggscode").isEmpty());
+
+    // Title and description are separate fields as well
+    QVERIFY(scanner->find("reviewreview").isEmpty());
+}
+
+void TestTextScanner::testSaveAndLoadArena()
+{
+    QByteArray data;
+    {
+        QDataStream out(&data, QIODevice::WriteOnly);
+        scanner->saveArena(out);
+    }
+
+    TextScanner loaded;
+    QDataStream in(data);
+    QVERIFY(loaded.loadArena(in));
+    QCOMPARE(loaded.size(), 3);
+    QCOMPARE(loaded.find("BREAD"), QList<int>({0}));
+    QVERIFY(loaded.find("eggscode").isEmpty());
+
+    // Loaded rows can be changed like folded ones.
+    loaded.insert(3, "Groceries again", "");
+    QCOMPARE(loaded.find("groceries"), QList<int>({0, 3}));
+
+    data.chop(2);
+    QDataStream truncated(data);
+    QVERIFY(!loaded.loadArena(truncated));
+    QCOMPARE(loaded.size(), 0);
+}
+
+void TestTextScanner::testInsertUpdateRemove()
+{
+    scanner->insert(1, "Inserted task", "");
+    QCOMPARE(scanner->size(), 4);
+    QCOMPARE(scanner->find("review"), QList<int>({2}));
+
+    scanner->update(2, "Renamed", "");
+    QVERIFY(scanner->find("review").isEmpty());
+
+    scanner->remove(0);
+    QCOMPARE(scanner->find("inserted"), QList<int>({0}));
+    QCOMPARE(scanner->find("documentation"), QList<int>({2}));
+
+    scanner->clear();
+    QCOMPARE(scanner->size(), 0);
+    QVERIFY(scanner->find("documentation").isEmpty());
+}
+
+void TestTextScanner::testIndexOfMatchesScalarSearch()
+{
+    // Exercise vector bodies and scalar tails with needles of varying length
+    const QString haystack = QString("abcabdabeabcabdabeabcxyzabc").repeated(5) + "needle";
+    const QStringList needles = {"a", "ab", "abd", "xyzabc", "needle", "eedl", "abcx", "missing"};
+
+    for (const QString &needle : needles)
+    {
+        const qsizetype expected = haystack.indexOf(needle);
+        const qsizetype actual = TextScanner::indexOf(
+            reinterpret_cast<const char16_t *>(haystack.constData()), haystack.size(),
+            reinterpret_cast<const char16_t *>(needle.constData()), needle.size());
+        QCOMPARE(actual, expected);
+    }
+}
+
+void TestTextScanner::testByteIndexOfMatchesScalarSearch()
+{
+    // Byte lanes are twice as many per vector; cover bodies, tails and a needle at the very end
+    const QByteArray haystack = QByteArray("abcabdabeabcabdabeabcxyzabc// TOD").repeated(7) + "TODO: needle";
+    const QList<QByteArray> needles = {"a", "ab", "abd", "xyzabc", "TODO", "FIXME", "needle", "e", "abcx", "missing"};
+
+    for (const QByteArray &needle : needles)
+    {
+        const qsizetype expected = haystack.indexOf(needle);
+        const qsizetype actual = TextScanner::indexOf(haystack.constData(), haystack.size(), needle.constData(), needle.size());
+        QCOMPARE(actual, expected);
+    }
+}
+
+void TestTextScanner::testParallelScan()
+{
+    // Enough text to exceed the parallel threshold
+    const QString filler = QString("x").repeated(1024);
+    const int rows = int(TextScanner::ParallelThreshold / filler.size()) + 64;
+
+    TextScanner large;
+    for (int i = 0; i < rows; ++i)
+        large.insert(i, QString("Task %1").arg(i), i % 1000 == 7 ? filler + "Marker" : filler);
+
+    const QList<int> matches = large.find("MARKER");
+    QList<int> expected;
+    for (int i = 7; i < rows; i += 1000)
+        expected.append(i);
+    QCOMPARE(matches, expected);
+}
+
+QTEST_MAIN(TestTextScanner)
+#include "test_text_scanner.moc"